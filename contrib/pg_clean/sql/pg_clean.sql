@@ -0,0 +1,36 @@
+--
+-- Resolve partially finished 2PC transactions of several gids at once
+--
+create extension pg_clean;
+
+create table pgc_t (a int, b int) distribute by shard(a);
+insert into pgc_t select i, i from generate_series(1, 10) i;
+
+-- prepare on all nodes, then roll back on one datanode each
+begin;
+delete from pgc_t where a <= 5;
+prepare transaction 'pgc_abort_1';
+begin;
+update pgc_t set b = b + 100 where a > 5;
+prepare transaction 'pgc_abort_2';
+
+set xc_maintenance_mode = on;
+execute direct on (datanode_1) 'rollback prepared ''pgc_abort_1''';
+execute direct on (datanode_2) 'rollback prepared ''pgc_abort_2''';
+set xc_maintenance_mode = off;
+
+-- transactions prepared in the last 3 seconds are left alone
+select pg_sleep(4);
+
+select gid, global_transaction_status
+  from pg_clean_check_txn(1) where gid like 'pgc%' order by gid;
+select gid, global_transaction_status, operation, operation_status
+  from pg_clean_execute(3) where gid like 'pgc%' order by gid;
+select gid from pg_clean_check_txn(1) where gid like 'pgc%';
+
+-- nothing of them is left behind
+select count(*) from pg_prepared_xacts where gid like 'pgc%';
+select count(*), sum(b) from pgc_t;
+
+drop table pgc_t;
+drop extension pg_clean;
@@ -229,6 +229,16 @@ fill_val(Form_pg_attribute att,
 
 #endif
 
+/*
+ * Return the size of a varlena datum, whatever its header format.  This is
+ * an out-of-line version of VARSIZE_ANY(), for JIT compiled code.
+ */
+size_t
+varsize_any(void *p)
+{
+    return VARSIZE_ANY(p);
+}
+
 /*
  * heap_compute_data_size
  *        Determine size of the data area of a tuple to be constructed
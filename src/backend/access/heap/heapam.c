@@ -81,6 +81,7 @@
 #include "pgxc/pgxc.h"
 #endif
 #ifdef _SHARDING_
+#include "storage/extentmapping.h"
 #include "utils/guc.h"
 #endif
 #ifdef __OPENTENBASE__
@@ -97,18 +98,28 @@
 
 /* GUC variable */
 bool        synchronize_seqscans = true;
+#ifdef _SHARDING_
+bool        enable_shard_pruned_scan = true;
+#endif
 
 
 static HeapScanDesc heap_beginscan_internal(Relation relation,
                         Snapshot snapshot,
                         int nkeys, ScanKey key,
                         ParallelHeapScanDesc parallel_scan,
+                        Bitmapset *shards,
                         bool allow_strat,
                         bool allow_sync,
                         bool allow_pagemode,
                         bool is_bitmapscan,
                         bool is_samplescan,
                         bool temp_snap);
+#ifdef _SHARDING_
+static void heap_shardscan_init(HeapScanDesc scan);
+static BlockNumber heap_shardscan_nextpage(HeapScanDesc scan, BlockNumber page,
+                        bool backward);
+static BlockNumber heap_shardscan_skipextent(HeapScanDesc scan, bool backward);
+#endif
 static void heap_parallelscan_startblock_init(HeapScanDesc scan);
 static BlockNumber heap_parallelscan_nextpage(HeapScanDesc scan);
 static HeapTuple heap_prepare_insert(Relation relation, HeapTuple tup,
@@ -291,11 +302,27 @@ initscan(HeapScanDesc scan, ScanKey key, bool keep_startblock)
         scan->rs_strategy = NULL;
     }
 
+#ifdef _SHARDING_
+    if (scan->rs_shards != NULL)
+        heap_shardscan_init(scan);
+#endif
+
     if (scan->rs_parallel != NULL)
     {
         /* For parallel scan, believe whatever ParallelHeapScanDesc says. */
         scan->rs_syncscan = scan->rs_parallel->phs_syncscan;
     }
+#ifdef _SHARDING_
+    else if (scan->rs_shards != NULL)
+    {
+        /*
+         * A shard-pruned scan visits extents in shard order, so there is no
+         * meaningful position to share with other scanners.
+         */
+        scan->rs_syncscan = false;
+        scan->rs_startblock = 0;
+    }
+#endif
     else if (keep_startblock)
     {
         /*
@@ -352,6 +379,9 @@ heap_setscanlimits(HeapScanDesc scan, BlockNumber startBlk, BlockNumber numBlks)
 {
     Assert(!scan->rs_inited);    /* else too late to change */
     Assert(!scan->rs_syncscan); /* else rs_startblock is significant */
+#ifdef _SHARDING_
+    Assert(scan->rs_shards == NULL);    /* else pages come from rs_extents */
+#endif
 
     /* Check startBlk is valid (but allow case of zero blocks...) */
     Assert(startBlk == 0 || startBlk < scan->rs_nblocks);
@@ -360,6 +390,163 @@ heap_setscanlimits(HeapScanDesc scan, BlockNumber startBlk, BlockNumber numBlks)
     scan->rs_numblocks = numBlks;
 }
 
+#ifdef _SHARDING_
+/*
+ * heap_shardscan_init - collect the extents a shard-pruned scan will visit
+ *
+ * The extents are read from the scan lists hanging off the ESA anchors of
+ * the requested shards, so the cost is proportional to the data owned by
+ * those shards rather than to the size of the relation.  If the extent map
+ * cannot be trusted, we quietly fall back to scanning every block; callers
+ * still filter tuples by shard, so this only costs performance.
+ */
+static void
+heap_shardscan_init(HeapScanDesc scan)
+{
+    MemoryContext oldcxt;
+
+    if (scan->rs_extents != NULL)
+    {
+        pfree(scan->rs_extents);
+        scan->rs_extents = NULL;
+    }
+    scan->rs_nextents = 0;
+    scan->rs_cextent = 0;
+
+    if (scan->rs_nblocks == 0)
+        return;
+
+    /* the list must live as long as the scan descriptor, rescans included */
+    oldcxt = MemoryContextSwitchTo(GetMemoryChunkContext(scan));
+    scan->rs_extents = GetShardScanExtents(scan->rs_rd, scan->rs_shards,
+                                           scan->rs_nblocks,
+                                           &scan->rs_nextents);
+    MemoryContextSwitchTo(oldcxt);
+
+    if (scan->rs_extents == NULL)
+    {
+        bms_free(scan->rs_shards);
+        scan->rs_shards = NULL;
+    }
+}
+
+/*
+ * heap_shardscan_nextpage - page following "page" in a shard-pruned scan
+ *
+ * Pages are visited extent by extent in rs_extents order.  Passing
+ * InvalidBlockNumber as "page" returns the first page to visit in the given
+ * direction.  Returns InvalidBlockNumber when the scan is exhausted.
+ */
+static BlockNumber
+heap_shardscan_nextpage(HeapScanDesc scan, BlockNumber page, bool backward)
+{
+    BlockNumber start;
+    BlockNumber end;
+
+    if (page == InvalidBlockNumber)
+    {
+        if (scan->rs_nextents == 0)
+            return InvalidBlockNumber;
+
+        scan->rs_cextent = backward ? scan->rs_nextents - 1 : 0;
+        start = scan->rs_extents[scan->rs_cextent] * PAGES_PER_EXTENTS;
+        end = Min(start + PAGES_PER_EXTENTS, scan->rs_nblocks);
+
+        return backward ? end - 1 : start;
+    }
+
+    start = scan->rs_extents[scan->rs_cextent] * PAGES_PER_EXTENTS;
+    end = Min(start + PAGES_PER_EXTENTS, scan->rs_nblocks);
+    Assert(page >= start && page < end);
+
+    if (backward ? page > start : page + 1 < end)
+        return backward ? page - 1 : page + 1;
+
+    return heap_shardscan_skipextent(scan, backward);
+}
+
+/*
+ * heap_shardscan_skipextent - first page of the next extent to visit
+ *
+ * Used both when the current extent is exhausted and when the rest of it is
+ * known to be uninteresting.  Returns InvalidBlockNumber at end of scan.
+ */
+static BlockNumber
+heap_shardscan_skipextent(HeapScanDesc scan, bool backward)
+{
+    BlockNumber start;
+
+    if (backward)
+    {
+        if (scan->rs_cextent == 0)
+            return InvalidBlockNumber;
+        scan->rs_cextent--;
+    }
+    else
+    {
+        if (scan->rs_cextent + 1 >= scan->rs_nextents)
+            return InvalidBlockNumber;
+        scan->rs_cextent++;
+    }
+
+    start = scan->rs_extents[scan->rs_cextent] * PAGES_PER_EXTENTS;
+    if (backward)
+        return Min(start + PAGES_PER_EXTENTS, scan->rs_nblocks) - 1;
+    return start;
+}
+#endif
+
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+/*
+ * heap_page_prefetch_committs - resolve commit timestamps for a page
+ *
+ * Collect the xmin/xmax of the tuples on the page whose global timestamp is
+ * not stored yet and resolve them in one pass, so that the per-tuple
+ * visibility checks find them in the backend commit-ts cache.
+ */
+static void
+heap_page_prefetch_committs(Page dp, OffsetNumber lines)
+{
+    TransactionId xids[MaxHeapTuplesPerPage * 2];
+    int            nxids = 0;
+    OffsetNumber lineoff;
+    ItemId        lpp;
+
+    for (lineoff = FirstOffsetNumber, lpp = PageGetItemId(dp, lineoff);
+         lineoff <= lines;
+         lineoff++, lpp++)
+    {
+        HeapTupleHeader tuple;
+        TransactionId    xid;
+
+        if (!ItemIdIsNormal(lpp))
+            continue;
+
+        tuple = (HeapTupleHeader) PageGetItem(dp, lpp);
+
+        if (!HeapTupleHeaderXminInvalid(tuple) &&
+            !HEAP_XMIN_TIMESTAMP_IS_UPDATED(tuple->t_infomask2))
+        {
+            xid = HeapTupleHeaderGetRawXmin(tuple);
+            if (TransactionIdIsNormal(xid) &&
+                (nxids == 0 || xids[nxids - 1] != xid))
+                xids[nxids++] = xid;
+        }
+
+        if (!(tuple->t_infomask & (HEAP_XMAX_INVALID | HEAP_XMAX_IS_MULTI)) &&
+            !HEAP_XMAX_TIMESTAMP_IS_UPDATED(tuple->t_infomask2))
+        {
+            xid = HeapTupleHeaderGetRawXmax(tuple);
+            if (TransactionIdIsNormal(xid) &&
+                (nxids == 0 || xids[nxids - 1] != xid))
+                xids[nxids++] = xid;
+        }
+    }
+
+    TransactionIdPrefetchCommitTsData(xids, nxids);
+}
+#endif
+
 /*
  * heapgetpage - subroutine for heapgettup()
  *
@@ -449,6 +636,14 @@ heapgetpage(HeapScanDesc scan, BlockNumber page)
     all_visible = PageIsAllVisible(dp) && !snapshot->takenDuringRecovery;
 #endif
 
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+    if (!all_visible)
+    {
+        heap_page_prefetch_committs(dp, lines);
+        HeapTupleHintBatchBegin(buffer);
+    }
+#endif
+
     for (lineoff = FirstOffsetNumber, lpp = PageGetItemId(dp, lineoff);
          lineoff <= lines;
          lineoff++, lpp++)
@@ -489,6 +684,13 @@ heapgetpage(HeapScanDesc scan, BlockNumber page)
         }
     }
 
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+    if (!all_visible)
+    {
+        HeapTupleHintBatchEnd();
+    }
+#endif
+
     LockBuffer(buffer, BUFFER_LOCK_UNLOCK);
 
     Assert(ntup <= MaxHeapTuplesPerPage);
@@ -565,6 +767,20 @@ heapgettup(HeapScanDesc scan,
                     return;
                 }
             }
+#ifdef _SHARDING_
+            else if (scan->rs_shards != NULL)
+            {
+                page = heap_shardscan_nextpage(scan, InvalidBlockNumber, false);
+
+                /* None of the requested shards owns an extent to visit. */
+                if (page == InvalidBlockNumber)
+                {
+                    Assert(!BufferIsValid(scan->rs_cbuf));
+                    tuple->t_data = NULL;
+                    return;
+                }
+            }
+#endif
             else
                 page = scan->rs_startblock; /* first page */
             heapgetpage(scan, page);
@@ -612,6 +828,20 @@ heapgettup(HeapScanDesc scan,
              * forward scanners.
              */
             scan->rs_syncscan = false;
+#ifdef _SHARDING_
+            if (scan->rs_shards != NULL)
+            {
+                /* start from last page of the last extent */
+                page = heap_shardscan_nextpage(scan, InvalidBlockNumber, true);
+                if (page == InvalidBlockNumber)
+                {
+                    Assert(!BufferIsValid(scan->rs_cbuf));
+                    tuple->t_data = NULL;
+                    return;
+                }
+            }
+            else
+#endif
             /* start from last page of the scan */
             if (scan->rs_startblock > 0)
                 page = scan->rs_startblock - 1;
@@ -737,6 +967,14 @@ heapgettup(HeapScanDesc scan,
         /*
          * advance to next/prior page and detect end of scan
          */
+#ifdef _SHARDING_
+        if (scan->rs_shards != NULL)
+        {
+            page = heap_shardscan_nextpage(scan, page, backward);
+            finished = (page == InvalidBlockNumber);
+        }
+        else
+#endif
         if (backward)
         {
             finished = (page == scan->rs_startblock) ||
@@ -802,6 +1040,12 @@ get_next_page:
             {
                 to_skip = true;
             }
+            else if(scan->rs_shards != NULL
+                && !bms_is_member(PageGetShardId(dp), scan->rs_shards))
+            {
+                /* the extent was handed to another shard after we listed it */
+                to_skip = true;
+            }
             else if(IS_PGXC_DATANODE
                 && IsConnFromApp()
                 && g_ShardVisibleMode != SHARD_VISIBLE_MODE_ALL
@@ -822,7 +1066,12 @@ get_next_page:
 
             if(to_skip)
             {
-                if (scan->rs_parallel != NULL)
+                if (scan->rs_shards != NULL)
+                {
+                    page = heap_shardscan_skipextent(scan, backward);
+                    finished = (page == InvalidBlockNumber);
+                }
+                else if (scan->rs_parallel != NULL)
                 {
                     page = heap_parallelscan_nextpage(scan);
                     finished = (page == InvalidBlockNumber);
@@ -947,6 +1196,20 @@ heapgettup_pagemode(HeapScanDesc scan,
                     return;
                 }
             }
+#ifdef _SHARDING_
+            else if (scan->rs_shards != NULL)
+            {
+                page = heap_shardscan_nextpage(scan, InvalidBlockNumber, false);
+
+                /* None of the requested shards owns an extent to visit. */
+                if (page == InvalidBlockNumber)
+                {
+                    Assert(!BufferIsValid(scan->rs_cbuf));
+                    tuple->t_data = NULL;
+                    return;
+                }
+            }
+#endif
             else
                 page = scan->rs_startblock; /* first page */
             heapgetpage(scan, page);
@@ -991,6 +1254,20 @@ heapgettup_pagemode(HeapScanDesc scan,
              * forward scanners.
              */
             scan->rs_syncscan = false;
+#ifdef _SHARDING_
+            if (scan->rs_shards != NULL)
+            {
+                /* start from last page of the last extent */
+                page = heap_shardscan_nextpage(scan, InvalidBlockNumber, true);
+                if (page == InvalidBlockNumber)
+                {
+                    Assert(!BufferIsValid(scan->rs_cbuf));
+                    tuple->t_data = NULL;
+                    return;
+                }
+            }
+            else
+#endif
             /* start from last page of the scan */
             if (scan->rs_startblock > 0)
                 page = scan->rs_startblock - 1;
@@ -1105,6 +1382,14 @@ heapgettup_pagemode(HeapScanDesc scan,
          * if we get here, it means we've exhausted the items on this page and
          * it's time to move to the next.
          */
+#ifdef _SHARDING_
+        if (scan->rs_shards != NULL)
+        {
+            page = heap_shardscan_nextpage(scan, page, backward);
+            finished = (page == InvalidBlockNumber);
+        }
+        else
+#endif
         if (backward)
         {
             finished = (page == scan->rs_startblock) ||
@@ -1168,6 +1453,12 @@ get_next_page:
             {
                 to_skip = true;
             }
+            else if(scan->rs_shards != NULL
+                && !bms_is_member(PageGetShardId(dp), scan->rs_shards))
+            {
+                /* the extent was handed to another shard after we listed it */
+                to_skip = true;
+            }
             else if(IS_PGXC_DATANODE
                 && IsConnFromApp()
                 && g_ShardVisibleMode != SHARD_VISIBLE_MODE_ALL
@@ -1188,7 +1479,12 @@ get_next_page:
 
             if(to_skip)
             {
-                if (scan->rs_parallel != NULL)
+                if (scan->rs_shards != NULL)
+                {
+                    page = heap_shardscan_skipextent(scan, backward);
+                    finished = (page == InvalidBlockNumber);
+                }
+                else if (scan->rs_parallel != NULL)
                 {
                     page = heap_parallelscan_nextpage(scan);
                     finished = (page == InvalidBlockNumber);
@@ -1593,17 +1889,40 @@ HeapScanDesc
 heap_beginscan(Relation relation, Snapshot snapshot,
                int nkeys, ScanKey key)
 {
-    return heap_beginscan_internal(relation, snapshot, nkeys, key, NULL,
+    return heap_beginscan_internal(relation, snapshot, nkeys, key, NULL, NULL,
                                    true, true, true, false, false, false);
 }
 
+#ifdef _SHARDING_
+/* ----------------
+ *        heap_beginscan_shards - begin a scan restricted to some shards
+ *
+ *        Only the extents owned by the shards in "shards" are read.  Tuples
+ *        of other shards are never returned, but callers that care must still
+ *        not rely on that for correctness: when the relation has no extent
+ *        map, when enable_shard_pruned_scan is off, or when the extent map is
+ *        found inconsistent, this degrades to an ordinary full scan.
+ * ----------------
+ */
+HeapScanDesc
+heap_beginscan_shards(Relation relation, Snapshot snapshot,
+                      int nkeys, ScanKey key, Bitmapset *shards)
+{
+    if (!enable_shard_pruned_scan || !RelationHasExtent(relation))
+        shards = NULL;
+
+    return heap_beginscan_internal(relation, snapshot, nkeys, key, NULL, shards,
+                                   true, false, true, false, false, false);
+}
+#endif
+
 HeapScanDesc
 heap_beginscan_catalog(Relation relation, int nkeys, ScanKey key)
 {
     Oid            relid = RelationGetRelid(relation);
     Snapshot    snapshot = RegisterSnapshot(GetCatalogSnapshot(relid));
 
-    return heap_beginscan_internal(relation, snapshot, nkeys, key, NULL,
+    return heap_beginscan_internal(relation, snapshot, nkeys, key, NULL, NULL,
                                    true, true, true, false, false, true);
 }
 
@@ -1612,7 +1931,7 @@ heap_beginscan_strat(Relation relation, Snapshot snapshot,
                      int nkeys, ScanKey key,
                      bool allow_strat, bool allow_sync)
 {
-    return heap_beginscan_internal(relation, snapshot, nkeys, key, NULL,
+    return heap_beginscan_internal(relation, snapshot, nkeys, key, NULL, NULL,
                                    allow_strat, allow_sync, true,
                                    false, false, false);
 }
@@ -1621,7 +1940,7 @@ HeapScanDesc
 heap_beginscan_bm(Relation relation, Snapshot snapshot,
                   int nkeys, ScanKey key)
 {
-    return heap_beginscan_internal(relation, snapshot, nkeys, key, NULL,
+    return heap_beginscan_internal(relation, snapshot, nkeys, key, NULL, NULL,
                                    false, false, true, true, false, false);
 }
 
@@ -1630,7 +1949,7 @@ heap_beginscan_sampling(Relation relation, Snapshot snapshot,
                         int nkeys, ScanKey key,
                         bool allow_strat, bool allow_sync, bool allow_pagemode)
 {
-    return heap_beginscan_internal(relation, snapshot, nkeys, key, NULL,
+    return heap_beginscan_internal(relation, snapshot, nkeys, key, NULL, NULL,
                                    allow_strat, allow_sync, allow_pagemode,
                                    false, true, false);
 }
@@ -1639,6 +1958,7 @@ static HeapScanDesc
 heap_beginscan_internal(Relation relation, Snapshot snapshot,
                         int nkeys, ScanKey key,
                         ParallelHeapScanDesc parallel_scan,
+                        Bitmapset *shards,
                         bool allow_strat,
                         bool allow_sync,
                         bool allow_pagemode,
@@ -1672,6 +1992,13 @@ heap_beginscan_internal(Relation relation, Snapshot snapshot,
     scan->rs_allow_sync = allow_sync;
     scan->rs_temp_snap = temp_snap;
     scan->rs_parallel = parallel_scan;
+#ifdef _SHARDING_
+    Assert(shards == NULL || parallel_scan == NULL);
+    scan->rs_shards = bms_copy(shards);
+    scan->rs_extents = NULL;
+    scan->rs_nextents = 0;
+    scan->rs_cextent = 0;
+#endif
 
     /*
      * we can use page-at-a-time mode if it's an MVCC-safe snapshot
@@ -1865,6 +2192,13 @@ heap_endscan(HeapScanDesc scan)
     if (scan->rs_temp_snap)
         UnregisterSnapshot(scan->rs_snapshot);
 
+#ifdef _SHARDING_
+    if (scan->rs_shards)
+        bms_free(scan->rs_shards);
+    if (scan->rs_extents)
+        pfree(scan->rs_extents);
+#endif
+
     pfree(scan);
 }
 
@@ -1934,7 +2268,7 @@ heap_beginscan_parallel(Relation relation, ParallelHeapScanDesc parallel_scan)
     snapshot = RestoreSnapshot(parallel_scan->phs_snapshot_data);
     RegisterSnapshot(snapshot);
 
-    return heap_beginscan_internal(relation, snapshot, 0, NULL, parallel_scan,
+    return heap_beginscan_internal(relation, snapshot, 0, NULL, parallel_scan, NULL,
                                    true, true, true, false, false, true);
 }
 
@@ -223,6 +223,7 @@ RelationAddExtraBlocks(Relation relation, BulkInsertState bistate, ShardID sid)
         BlockNumber nblocks;
         int extent_off;
         ExtentID next_extent;
+        int nextents;
     
         nblocks = RelationGetNumberOfBlocks(relation);
         extent_off = nblocks % PAGES_PER_EXTENTS;
@@ -251,10 +252,15 @@ RelationAddExtraBlocks(Relation relation, BulkInsertState bistate, ShardID sid)
             next_extent++;
         }
 
-        /* init extent info */
-        ExtendExtentForShard(relation, sid, next_extent, MAX_FREESPACE, false);
-        
-        extraBlocks = PAGES_PER_EXTENTS;
+        /*
+         * init extent info.  Backends waiting for the extension lock are
+         * likely to need an extent too, so add one more for each of them.
+         */
+        lockWaiters = RelationExtensionLockWaiterCount(relation);
+        nextents = ExtendExtentsForShard(relation, sid, next_extent,
+                                        1 + Max(lockWaiters, 0));
+
+        extraBlocks = nextents * PAGES_PER_EXTENTS;
     }
     if(extraBlocks <= 0)
         elog(PANIC, "extraBlocks cannot be zero");
@@ -539,6 +545,34 @@ RelationExtendHeapForRedo(RelFileNode rnode, ExtentID eid, ShardID sid)
     
     smgrclose(smgr);
 }
+
+/*
+ * RelationPreextendShard
+ *
+ *    Give a shard that has no extent in the relation its first one, ahead of
+ *    its first row.  Returns whether an extent was added.
+ */
+bool
+RelationPreextendShard(Relation relation, ShardID sid)
+{
+    bool        extended = false;
+
+    if (!RelationHasExtent(relation) || !ShardIDIsValid(sid))
+        return false;
+
+    LockRelationForExtension(relation, ExclusiveLock);
+
+    /* recheck under the lock, an insert may have beaten us to it */
+    if (!ExtentIdIsValid(GetShardScanHead(relation, sid)))
+    {
+        RelationAddExtraBlocks(relation, NULL, sid);
+        extended = true;
+    }
+
+    UnlockRelationForExtension(relation, ExclusiveLock);
+
+    return extended;
+}
 #endif
 
 /*
@@ -182,6 +182,7 @@ btbuild(Relation heap, Relation index, IndexInfo *indexInfo)
     IndexBuildResult *result;
     double        reltuples;
     BTBuildState buildstate;
+    int            nworkers;
 
     buildstate.isUnique = indexInfo->ii_Unique;
     buildstate.haveDead = false;
@@ -203,36 +204,48 @@ btbuild(Relation heap, Relation index, IndexInfo *indexInfo)
         elog(ERROR, "index \"%s\" already contains data",
              RelationGetRelationName(index));
 
-    buildstate.spool = _bt_spoolinit(heap, index, indexInfo->ii_Unique, false);
-
     /*
-     * If building a unique index, put dead tuples in a second spool to keep
-     * them out of the uniqueness check.
+     * Big tables are scanned and sorted by parallel workers, and the index
+     * loaded from the merge of their sorted output.
      */
-    if (indexInfo->ii_Unique)
-        buildstate.spool2 = _bt_spoolinit(heap, index, false, true);
+    nworkers = _bt_parallel_build_workers(heap, index, indexInfo);
+    if (nworkers > 0)
+        reltuples = _bt_parallel_build(heap, index, indexInfo, nworkers,
+                                       &buildstate.indtuples);
+    else
+    {
+        buildstate.spool = _bt_spoolinit(heap, index, indexInfo->ii_Unique,
+                                         false);
 
-    /* do the heap scan */
-    reltuples = IndexBuildHeapScan(heap, index, indexInfo, true,
-                                   btbuildCallback, (void *) &buildstate);
+        /*
+         * If building a unique index, put dead tuples in a second spool to
+         * keep them out of the uniqueness check.
+         */
+        if (indexInfo->ii_Unique)
+            buildstate.spool2 = _bt_spoolinit(heap, index, false, true);
 
-    /* okay, all heap tuples are indexed */
-    if (buildstate.spool2 && !buildstate.haveDead)
-    {
-        /* spool2 turns out to be unnecessary */
-        _bt_spooldestroy(buildstate.spool2);
-        buildstate.spool2 = NULL;
-    }
+        /* do the heap scan */
+        reltuples = IndexBuildHeapScan(heap, index, indexInfo, true,
+                                       btbuildCallback, (void *) &buildstate);
 
-    /*
-     * Finish the build by (1) completing the sort of the spool file, (2)
-     * inserting the sorted tuples into btree pages and (3) building the upper
-     * levels.
-     */
-    _bt_leafbuild(buildstate.spool, buildstate.spool2);
-    _bt_spooldestroy(buildstate.spool);
-    if (buildstate.spool2)
-        _bt_spooldestroy(buildstate.spool2);
+        /* okay, all heap tuples are indexed */
+        if (buildstate.spool2 && !buildstate.haveDead)
+        {
+            /* spool2 turns out to be unnecessary */
+            _bt_spooldestroy(buildstate.spool2);
+            buildstate.spool2 = NULL;
+        }
+
+        /*
+         * Finish the build by (1) completing the sort of the spool file, (2)
+         * inserting the sorted tuples into btree pages and (3) building the
+         * upper levels.
+         */
+        _bt_leafbuild(buildstate.spool, buildstate.spool2);
+        _bt_spooldestroy(buildstate.spool);
+        if (buildstate.spool2)
+            _bt_spooldestroy(buildstate.spool2);
+    }
 
 #ifdef BTREE_BUILD_STATS
     if (log_btree_build_stats)
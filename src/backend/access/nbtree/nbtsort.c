@@ -55,6 +55,12 @@
  * This code isn't concerned about the FSM at all. The caller is responsible
  * for initializing that.
  *
+ * Builds of big tables may use parallel workers, see _bt_parallel_build.
+ * The leader and the workers each scan chunks of the heap and sort what they
+ * read; the workers stream their sorted tuples to the leader through shared
+ * memory queues, and the leader merges them with its own sorted tuples while
+ * it loads the leaf pages.
+ *
  * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
  *
@@ -69,13 +75,22 @@
 
 #include "postgres.h"
 
+#include "access/heapam.h"
 #include "access/nbtree.h"
+#include "access/parallel.h"
+#include "access/xact.h"
 #include "access/xlog.h"
 #include "access/xloginsert.h"
+#include "catalog/catalog.h"
+#include "catalog/index.h"
 #include "miscadmin.h"
+#include "optimizer/paths.h"
+#include "storage/shm_mq.h"
 #include "storage/smgr.h"
+#include "storage/spin.h"
 #include "tcop/tcopprot.h"
 #include "utils/rel.h"
+#include "utils/snapmgr.h"
 #include "utils/sortsupport.h"
 #include "utils/tuplesort.h"
 #ifdef _MLS_
@@ -84,6 +99,19 @@
 #endif
 
 
+/* Magic numbers for parallel btree build state sharing */
+#define PARALLEL_KEY_BTREE_SHARED        UINT64CONST(0xB000000000000001)
+#define PARALLEL_KEY_TUPLE_QUEUE        UINT64CONST(0xB000000000000002)
+
+/* Size of the queue through which each worker sends its sorted tuples */
+#define BT_PARALLEL_QUEUE_SIZE            65536
+
+/* Chunks per participant the heap is divided into for a parallel build */
+#define BT_PARALLEL_CHUNKS_PER_PARTICIPANT    8
+
+/* Smallest share of maintenance_work_mem (kB) worth starting a worker for */
+#define BT_PARALLEL_MIN_SORT_MEM        (32 * 1024)
+
 /*
  * Status record for spooling/sorting phase.  (Note we may have two of
  * these due to the special requirements for uniqueness-checking with
@@ -121,6 +149,50 @@ typedef struct BTPageState
     struct BTPageState *btps_next;    /* link to parent level, if any */
 } BTPageState;
 
+/*
+ * State shared by the participants of a parallel btree build.  The heap is
+ * handed out chunkblocks blocks at a time, so that participants running
+ * ahead take over more of the scan.
+ */
+typedef struct BTShared
+{
+    Oid            heaprelid;
+    Oid            indexrelid;
+    bool        isunique;
+    int            sortmem;        /* sort memory of each participant, in kB */
+    BlockNumber nblocks;        /* number of heap blocks to scan */
+    BlockNumber chunkblocks;    /* number of blocks handed out at a time */
+
+    /* mutex protects remaining fields */
+    slock_t        mutex;
+    BlockNumber nextblock;        /* first block not handed out yet */
+    double        reltuples;        /* heap tuples scanned by the workers */
+    double        indtuples;        /* index tuples spooled by the workers */
+    bool        brokenHotChain; /* did a worker find a broken HOT chain? */
+} BTShared;
+
+/*
+ * Spools of one participant of a parallel btree build.
+ */
+typedef struct BTParallelSpools
+{
+    BTSpool    *spool;
+    BTSpool    *spool2;            /* dead tuples of a unique index, or NULL */
+    bool        haveDead;
+    double        indtuples;
+} BTParallelSpools;
+
+/*
+ * Sorted streams merged by the leader of a parallel btree build: its own
+ * sorted spool is stream 0, and the tuple queue of worker i is stream i + 1.
+ */
+typedef struct BTMergeStreams
+{
+    Tuplesortstate *leadersort;
+    int            nqueues;
+    shm_mq_handle **queues;
+} BTMergeStreams;
+
 /*
  * Overall status record for index writing phase.
  */
@@ -145,6 +217,18 @@ static void _bt_buildadd(BTWriteState *wstate, BTPageState *state,
 static void _bt_uppershutdown(BTWriteState *wstate, BTPageState *state);
 static void _bt_load(BTWriteState *wstate,
          BTSpool *btspool, BTSpool *btspool2);
+static BTSpool *_bt_spoolcreate(Relation heap, Relation index,
+                bool isunique, int btKbytes);
+static void _bt_leafload(BTSpool *btspool, BTSpool *btspool2);
+static void _bt_parallel_callback(Relation index, HeapTuple htup,
+                      Datum *values, bool *isnull,
+                      bool tupleIsAlive, void *state);
+static double _bt_parallel_scan(BTShared *btshared, Relation heap,
+                  Relation index, IndexInfo *indexInfo,
+                  BTParallelSpools *spools);
+static void _bt_parallel_send(shm_mq_handle *mqh, Tuplesortstate *sortstate);
+static IndexTuple _bt_parallel_receive(shm_mq_handle *mqh);
+static IndexTuple _bt_parallel_next(void *arg, int stream);
 
 
 /*
@@ -158,13 +242,8 @@ static void _bt_load(BTWriteState *wstate,
 BTSpool *
 _bt_spoolinit(Relation heap, Relation index, bool isunique, bool isdead)
 {
-    BTSpool    *btspool = (BTSpool *) palloc0(sizeof(BTSpool));
     int            btKbytes;
 
-    btspool->heap = heap;
-    btspool->index = index;
-    btspool->isunique = isunique;
-
     /*
      * We size the sort area as maintenance_work_mem rather than work_mem to
      * speed index creation.  This should be OK since a single backend can't
@@ -174,6 +253,21 @@ _bt_spoolinit(Relation heap, Relation index, bool isunique, bool isdead)
      * work_mem.
      */
     btKbytes = isdead ? work_mem : maintenance_work_mem;
+
+    return _bt_spoolcreate(heap, index, isunique, btKbytes);
+}
+
+/*
+ * create a spool structure sorting in btKbytes of memory
+ */
+static BTSpool *
+_bt_spoolcreate(Relation heap, Relation index, bool isunique, int btKbytes)
+{
+    BTSpool    *btspool = (BTSpool *) palloc0(sizeof(BTSpool));
+
+    btspool->heap = heap;
+    btspool->index = index;
+    btspool->isunique = isunique;
     btspool->sortstate = tuplesort_begin_index_btree(heap, index, isunique,
                                                      btKbytes, false);
 
@@ -207,8 +301,6 @@ _bt_spool(BTSpool *btspool, ItemPointer self, Datum *values, bool *isnull)
 void
 _bt_leafbuild(BTSpool *btspool, BTSpool *btspool2)
 {
-    BTWriteState wstate;
-
 #ifdef BTREE_BUILD_STATS
     if (log_btree_build_stats)
     {
@@ -221,6 +313,17 @@ _bt_leafbuild(BTSpool *btspool, BTSpool *btspool2)
     if (btspool2)
         tuplesort_performsort(btspool2->sortstate);
 
+    _bt_leafload(btspool, btspool2);
+}
+
+/*
+ * create an entire btree from spools whose tuples are already sorted.
+ */
+static void
+_bt_leafload(BTSpool *btspool, BTSpool *btspool2)
+{
+    BTWriteState wstate;
+
     wstate.heap = btspool->heap;
     wstate.index = btspool->index;
 
@@ -844,3 +947,433 @@ _bt_load(BTWriteState *wstate, BTSpool *btspool, BTSpool *btspool2)
         smgrimmedsync(wstate->index->rd_smgr, MAIN_FORKNUM);
     }
 }
+
+/*
+ * Parallel btree build
+ */
+
+/*
+ * _bt_parallel_build_workers() -- decide how many workers to use for
+ *        building the index, 0 meaning that it is built without workers.
+ *
+ * Like for a parallel sequential scan, one worker is used once the heap
+ * reaches min_parallel_table_scan_size and one more each time it triples,
+ * unless the heap's parallel_workers option says otherwise.  The result is
+ * capped by max_parallel_maintenance_workers, and by the number of
+ * participants among which maintenance_work_mem can be divided without
+ * leaving each too small a share.
+ *
+ * Only plain indexes built while holding off writers are built in parallel:
+ * workers could not evaluate index expressions or predicates that are not
+ * parallel safe, and concurrent builds need their own snapshots.
+ */
+int
+_bt_parallel_build_workers(Relation heap, Relation index, IndexInfo *indexInfo)
+{
+    BlockNumber heap_pages;
+    int            nworkers;
+
+    if (max_parallel_maintenance_workers <= 0 ||
+        indexInfo->ii_Concurrent ||
+        indexInfo->ii_Expressions != NIL ||
+        indexInfo->ii_Predicate != NIL ||
+        IsBootstrapProcessingMode() ||
+        IsInParallelMode() ||
+        !ActiveSnapshotSet() ||
+        RelationUsesLocalBuffers(heap) ||
+        IsSystemRelation(heap))
+        return 0;
+
+    heap_pages = RelationGetNumberOfBlocks(heap);
+
+    nworkers = RelationGetParallelWorkers(heap, -1);
+    if (nworkers < 0)
+    {
+        BlockNumber threshold = Max(min_parallel_table_scan_size, 1);
+
+        if (heap_pages < threshold)
+            return 0;
+
+        nworkers = 1;
+        while (heap_pages >= threshold * 3 &&
+               nworkers < max_parallel_maintenance_workers)
+        {
+            nworkers++;
+            threshold *= 3;
+            if (threshold > MaxBlockNumber / 3)
+                break;
+        }
+    }
+
+    nworkers = Min(nworkers, max_parallel_maintenance_workers);
+
+    while (nworkers > 0 &&
+           maintenance_work_mem / (nworkers + 1) < BT_PARALLEL_MIN_SORT_MEM)
+        nworkers--;
+
+    return nworkers;
+}
+
+/*
+ * _bt_parallel_build() -- build the index with the help of nworkers
+ *        parallel workers.
+ *
+ * The leader scans and sorts its share of the heap like the workers.  Each
+ * worker then sends the leader the dead tuples it spooled for a unique
+ * index, followed by its other tuples, sorted; the leader sorts the dead
+ * tuples of everyone together, and loads the index from the merge of its
+ * own sorted tuples with those of the workers.  A unique index has its
+ * uniqueness checked by each participant's sort and by the final merge.
+ *
+ * Returns the number of heap tuples scanned, and the number of index tuples
+ * in *indtuples.
+ */
+double
+_bt_parallel_build(Relation heap, Relation index, IndexInfo *indexInfo,
+                   int nworkers, double *indtuples)
+{
+    ParallelContext *pcxt;
+    BTShared   *btshared;
+    char       *mqspace;
+    shm_mq_handle **queues;
+    BTParallelSpools spools;
+    BTMergeStreams streams;
+    BTSpool    *mergespool;
+    IndexTuple    itup;
+    Datum        values[INDEX_MAX_KEYS];
+    bool        isnull[INDEX_MAX_KEYS];
+    double        reltuples;
+    int            i;
+
+    Assert(nworkers > 0);
+
+    EnterParallelMode();
+    pcxt = CreateParallelContext("postgres", "_bt_parallel_build_main",
+                                 nworkers);
+
+    /* Estimate space for the shared state and the tuple queues. */
+    shm_toc_estimate_chunk(&pcxt->estimator, sizeof(BTShared));
+    shm_toc_estimate_chunk(&pcxt->estimator,
+                           mul_size(BT_PARALLEL_QUEUE_SIZE, pcxt->nworkers));
+    shm_toc_estimate_keys(&pcxt->estimator, 2);
+
+    InitializeParallelDSM(pcxt);
+
+    btshared = (BTShared *) shm_toc_allocate(pcxt->toc, sizeof(BTShared));
+    btshared->heaprelid = RelationGetRelid(heap);
+    btshared->indexrelid = RelationGetRelid(index);
+    btshared->isunique = indexInfo->ii_Unique;
+    btshared->sortmem = maintenance_work_mem / (nworkers + 1);
+    btshared->nblocks = RelationGetNumberOfBlocks(heap);
+    btshared->chunkblocks =
+        Max(btshared->nblocks /
+            ((nworkers + 1) * BT_PARALLEL_CHUNKS_PER_PARTICIPANT), 1);
+    SpinLockInit(&btshared->mutex);
+    btshared->nextblock = 0;
+    btshared->reltuples = 0;
+    btshared->indtuples = 0;
+    btshared->brokenHotChain = false;
+    shm_toc_insert(pcxt->toc, PARALLEL_KEY_BTREE_SHARED, btshared);
+
+    /* Create the tuple queues, and become the receiver for each. */
+    mqspace = shm_toc_allocate(pcxt->toc,
+                               mul_size(BT_PARALLEL_QUEUE_SIZE,
+                                        pcxt->nworkers));
+    queues = (shm_mq_handle **)
+        palloc(pcxt->nworkers * sizeof(shm_mq_handle *));
+    for (i = 0; i < pcxt->nworkers; i++)
+    {
+        shm_mq       *mq;
+
+        mq = shm_mq_create(mqspace + ((Size) i) * BT_PARALLEL_QUEUE_SIZE,
+                           (Size) BT_PARALLEL_QUEUE_SIZE);
+        shm_mq_set_receiver(mq, MyProc);
+        queues[i] = shm_mq_attach(mq, pcxt->seg, NULL);
+    }
+    shm_toc_insert(pcxt->toc, PARALLEL_KEY_TUPLE_QUEUE, mqspace);
+
+    LaunchParallelWorkers(pcxt);
+    for (i = 0; i < pcxt->nworkers_launched; i++)
+        shm_mq_set_handle(queues[i], pcxt->worker[i].bgwhandle);
+
+    /* Take part in the scan, until the whole heap has been handed out. */
+    reltuples = _bt_parallel_scan(btshared, heap, index, indexInfo, &spools);
+
+    /*
+     * Collect the dead tuples of the workers, so that they are sorted and
+     * merged into the index together with the leader's.
+     */
+    for (i = 0; i < pcxt->nworkers_launched; i++)
+    {
+        while ((itup = _bt_parallel_receive(queues[i])) != NULL)
+        {
+            Assert(spools.spool2 != NULL);
+            index_deform_tuple(itup, RelationGetDescr(index), values, isnull);
+            _bt_spool(spools.spool2, &itup->t_tid, values, isnull);
+            spools.haveDead = true;
+        }
+    }
+
+    if (spools.spool2 && !spools.haveDead)
+    {
+        /* spool2 turns out to be unnecessary */
+        _bt_spooldestroy(spools.spool2);
+        spools.spool2 = NULL;
+    }
+
+    tuplesort_performsort(spools.spool->sortstate);
+    if (spools.spool2)
+        tuplesort_performsort(spools.spool2->sortstate);
+
+    /* Load the index from the merge of everyone's sorted tuples. */
+    streams.leadersort = spools.spool->sortstate;
+    streams.nqueues = pcxt->nworkers_launched;
+    streams.queues = queues;
+
+    mergespool = (BTSpool *) palloc0(sizeof(BTSpool));
+    mergespool->heap = heap;
+    mergespool->index = index;
+    mergespool->isunique = indexInfo->ii_Unique;
+    mergespool->sortstate =
+        tuplesort_begin_index_merge(heap, index, indexInfo->ii_Unique,
+                                    streams.nqueues + 1,
+                                    _bt_parallel_next, (void *) &streams,
+                                    btshared->sortmem);
+
+    _bt_leafload(mergespool, spools.spool2);
+
+    _bt_spooldestroy(mergespool);
+    _bt_spooldestroy(spools.spool);
+    if (spools.spool2)
+        _bt_spooldestroy(spools.spool2);
+
+    for (i = 0; i < pcxt->nworkers_launched; i++)
+        shm_mq_detach(shm_mq_get_queue(queues[i]));
+    pfree(queues);
+
+    WaitForParallelWorkersToFinish(pcxt);
+
+    /* Add up what the workers scanned. */
+    reltuples += btshared->reltuples;
+    *indtuples = spools.indtuples + btshared->indtuples;
+    if (btshared->brokenHotChain)
+        indexInfo->ii_BrokenHotChain = true;
+
+    DestroyParallelContext(pcxt);
+    ExitParallelMode();
+
+    return reltuples;
+}
+
+/*
+ * _bt_parallel_build_main() -- entry point of the workers of a parallel
+ *        btree build.
+ */
+void
+_bt_parallel_build_main(dsm_segment *seg, shm_toc *toc)
+{
+    BTShared   *btshared;
+    char       *mqspace;
+    shm_mq       *mq;
+    shm_mq_handle *mqh;
+    Relation    heapRel;
+    Relation    indexRel;
+    IndexInfo  *indexInfo;
+    BTParallelSpools spools;
+    double        reltuples;
+
+    btshared = shm_toc_lookup(toc, PARALLEL_KEY_BTREE_SHARED, false);
+
+    /* Become the sender of our tuple queue. */
+    mqspace = shm_toc_lookup(toc, PARALLEL_KEY_TUPLE_QUEUE, false);
+    mq = (shm_mq *) (mqspace + ParallelWorkerNumber * BT_PARALLEL_QUEUE_SIZE);
+    shm_mq_set_sender(mq, MyProc);
+    mqh = shm_mq_attach(mq, seg, NULL);
+
+    /* The leader holds the same locks, shared with us by group locking. */
+    heapRel = heap_open(btshared->heaprelid, ShareLock);
+    indexRel = index_open(btshared->indexrelid, RowExclusiveLock);
+    indexInfo = BuildIndexInfo(indexRel);
+
+    reltuples = _bt_parallel_scan(btshared, heapRel, indexRel, indexInfo,
+                                  &spools);
+
+    SpinLockAcquire(&btshared->mutex);
+    btshared->reltuples += reltuples;
+    btshared->indtuples += spools.indtuples;
+    if (indexInfo->ii_BrokenHotChain)
+        btshared->brokenHotChain = true;
+    SpinLockRelease(&btshared->mutex);
+
+    /* Send the dead tuples first, then the others, each sorted. */
+    if (spools.spool2 && spools.haveDead)
+    {
+        tuplesort_performsort(spools.spool2->sortstate);
+        _bt_parallel_send(mqh, spools.spool2->sortstate);
+    }
+    else
+        _bt_parallel_send(mqh, NULL);
+
+    tuplesort_performsort(spools.spool->sortstate);
+    _bt_parallel_send(mqh, spools.spool->sortstate);
+
+    shm_mq_detach(mq);
+
+    _bt_spooldestroy(spools.spool);
+    if (spools.spool2)
+        _bt_spooldestroy(spools.spool2);
+
+    index_close(indexRel, RowExclusiveLock);
+    heap_close(heapRel, ShareLock);
+}
+
+/*
+ * Per-tuple callback from IndexBuildHeapRangeScan, for the participants of
+ * a parallel build.
+ */
+static void
+_bt_parallel_callback(Relation index,
+                      HeapTuple htup,
+                      Datum *values,
+                      bool *isnull,
+                      bool tupleIsAlive,
+                      void *state)
+{
+    BTParallelSpools *spools = (BTParallelSpools *) state;
+
+    if (tupleIsAlive || spools->spool2 == NULL)
+        _bt_spool(spools->spool, &htup->t_self, values, isnull);
+    else
+    {
+        /* dead tuples are put into spool2 */
+        spools->haveDead = true;
+        _bt_spool(spools->spool2, &htup->t_self, values, isnull);
+    }
+
+    spools->indtuples += 1;
+}
+
+/*
+ * Spool the chunks of the heap handed out to this participant, until there
+ * are no more.  Returns the number of heap tuples scanned.
+ */
+static double
+_bt_parallel_scan(BTShared *btshared, Relation heap, Relation index,
+                  IndexInfo *indexInfo, BTParallelSpools *spools)
+{
+    double        reltuples = 0;
+
+    spools->spool = _bt_spoolcreate(heap, index, btshared->isunique,
+                                    btshared->sortmem);
+
+    /*
+     * If building a unique index, put dead tuples in a second spool to keep
+     * them out of the uniqueness check.
+     */
+    spools->spool2 = NULL;
+    if (btshared->isunique)
+        spools->spool2 = _bt_spoolcreate(heap, index, false, work_mem);
+    spools->haveDead = false;
+    spools->indtuples = 0;
+
+    for (;;)
+    {
+        BlockNumber startblock;
+        BlockNumber numblocks;
+
+        SpinLockAcquire(&btshared->mutex);
+        startblock = btshared->nextblock;
+        numblocks = Min(btshared->chunkblocks,
+                        btshared->nblocks - startblock);
+        btshared->nextblock += numblocks;
+        SpinLockRelease(&btshared->mutex);
+
+        if (numblocks == 0)
+            break;
+
+        /* synchronized scans would not stay within the chunk */
+        reltuples += IndexBuildHeapRangeScan(heap, index, indexInfo,
+                                             false, false,
+                                             startblock, numblocks,
+                                             _bt_parallel_callback,
+                                             (void *) spools);
+    }
+
+    return reltuples;
+}
+
+/*
+ * Send the sorted tuples of a worker's spool to the leader, followed by an
+ * empty message marking their end.  A NULL sortstate only sends the end.
+ */
+static void
+_bt_parallel_send(shm_mq_handle *mqh, Tuplesortstate *sortstate)
+{
+    IndexTuple    itup;
+
+    if (sortstate != NULL)
+    {
+        while ((itup = tuplesort_getindextuple(sortstate, true)) != NULL)
+        {
+            /* if the leader went away, it is already reporting an error */
+            if (shm_mq_send(mqh, IndexTupleSize(itup), itup,
+                            false) != SHM_MQ_SUCCESS)
+                return;
+        }
+    }
+
+    (void) shm_mq_send(mqh, 0, NULL, false);
+}
+
+/*
+ * Receive the next tuple a worker sent, or NULL once the worker has marked
+ * the end of its tuples.  The tuple is only valid until the next call.
+ */
+static IndexTuple
+_bt_parallel_receive(shm_mq_handle *mqh)
+{
+    shm_mq_result res;
+    Size        nbytes;
+    void       *data;
+
+    res = shm_mq_receive(mqh, &nbytes, &data, false);
+    if (res == SHM_MQ_DETACHED)
+    {
+        /* a worker that never started has nothing to send */
+        if (shm_mq_get_sender(shm_mq_get_queue(mqh)) == NULL)
+            return NULL;
+
+        /*
+         * A worker that gave up before sending all its tuples has reported
+         * why; rethrow its error.
+         */
+        HandleParallelMessages();
+        ereport(ERROR,
+                (errcode(ERRCODE_INTERNAL_ERROR),
+                 errmsg("lost connection to parallel worker")));
+    }
+
+    Assert(res == SHM_MQ_SUCCESS);
+
+    if (nbytes == 0)
+        return NULL;
+
+    return (IndexTuple) data;
+}
+
+/*
+ * Fetch the next tuple of one of the streams merged by the leader; see
+ * TuplesortIndexStream.
+ */
+static IndexTuple
+_bt_parallel_next(void *arg, int stream)
+{
+    BTMergeStreams *streams = (BTMergeStreams *) arg;
+
+    if (stream == 0)
+        return tuplesort_getindextuple(streams->leadersort, true);
+
+    Assert(stream <= streams->nqueues);
+
+    return _bt_parallel_receive(streams->queues[stream - 1]);
+}
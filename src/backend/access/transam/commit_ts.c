@@ -117,6 +117,38 @@ typedef struct CommitTimestampShared
 
 CommitTimestampShared *commitTsShared;
 
+/*
+ * Per-backend cache of recently resolved commit timestamps, so that MVCC
+ * checks on freshly loaded data do not go to the commit-ts partition locks
+ * for every tuple.  Only transactions with a valid global timestamp are
+ * cached, as those never change.  The cache is direct-mapped on the xid and
+ * is reset once its oldest xid falls commit_ts_cache_horizon behind
+ * RecentXmin, long before the xid could be reused after a wraparound, or
+ * behind the oldest xid of the truncated commit-ts log.
+ */
+#define COMMIT_TS_CACHE_SIZE    4096    /* keep this a power of 2 */
+#define COMMIT_TS_CACHE_MASK    (COMMIT_TS_CACHE_SIZE - 1)
+
+typedef struct CommitTsCacheEntry
+{
+    TransactionId    xid;
+    RepOriginId        nodeid;
+    TimestampTz        global_timestamp;
+} CommitTsCacheEntry;
+
+static CommitTsCacheEntry CommitTsCache[COMMIT_TS_CACHE_SIZE];
+static TransactionId CommitTsCacheOldestXid = InvalidTransactionId;
+static uint64 CommitTsCacheResets = 0;
+
+/* GUC variable, developer option */
+int            commit_ts_cache_horizon = 0x40000000;
+
+static inline void CommitTsCacheCheckHorizon(void);
+static inline bool CommitTsCacheLookup(TransactionId xid, TimestampTz *gts,
+                                       RepOriginId *nodeid);
+static inline void CommitTsCacheInsert(TransactionId xid, TimestampTz gts,
+                                       RepOriginId nodeid);
+
 
 /* GUC variable */
 bool        track_commit_timestamp = true;
@@ -336,11 +368,13 @@ TransactionIdSetCommitTs(TransactionId xid, TimestampTz gts, TimestampTz ts,
 	entry.time = ts;
 	entry.nodeid = nodeid;
 
+	LruPageChangeBegin(CommitTsCtl->shared[partitionno], slotno);
 	LruTlogDisableMemoryProtection(CommitTsCtl->shared[partitionno]->page_buffer[slotno]);
 	memcpy(CommitTsCtl->shared[partitionno]->page_buffer[slotno] +
 		   SizeOfCommitTimestampEntry * entryno,
 		   &entry, SizeOfCommitTimestampEntry);
 	LruTlogEnableMemoryProtection(CommitTsCtl->shared[partitionno]->page_buffer[slotno]);
+	LruPageChangeEnd(CommitTsCtl->shared[partitionno], slotno);
 
 #ifdef __OPENTENBASE__
     /*
@@ -398,19 +432,31 @@ TransactionIdGetCommitTsData(TransactionId xid, TimestampTz *gts,
         return true;
     }
 
+    if (CommitTsCacheLookup(xid, gts, nodeid))
+    {
+        return true;
+    }
+
     //elog(DEBUG8, "Get committs xid %d.", xid);
     partitionno = PagenoMappingPartitionno(CommitTsCtl, pageno);
 
-    partitionLock = GetPartitionLock(CommitTsCtl, partitionno);
-    
-    /* lock is acquired by SimpleLruReadPage_ReadOnly */
-    slotno = LruReadPage_ReadOnly(CommitTsCtl, partitionno, pageno, xid);
-    memcpy(&entry,
-           CommitTsCtl->shared[partitionno]->page_buffer[slotno] +
-           SizeOfCommitTimestampEntry * entryno,
-           SizeOfCommitTimestampEntry);
+    /* try to copy the entry from a resident page without any lock first */
+    if (!LruReadPage_Optimistic(CommitTsCtl, partitionno, pageno,
+                                SizeOfCommitTimestampEntry * entryno,
+                                (char *) &entry, SizeOfCommitTimestampEntry))
+    {
+        partitionLock = GetPartitionLock(CommitTsCtl, partitionno);
+
+        /* lock is acquired by SimpleLruReadPage_ReadOnly */
+        slotno = LruReadPage_ReadOnly(CommitTsCtl, partitionno, pageno, xid);
+        memcpy(&entry,
+               CommitTsCtl->shared[partitionno]->page_buffer[slotno] +
+               SizeOfCommitTimestampEntry * entryno,
+               SizeOfCommitTimestampEntry);
+
+        LWLockRelease(partitionLock);
+    }
 
-    
     *gts = entry.global_timestamp;
     
     if (nodeid)
@@ -419,10 +465,153 @@ TransactionIdGetCommitTsData(TransactionId xid, TimestampTz *gts,
     }
     
     //elog(DEBUG8, "Get committs xid %d time " INT64_FORMAT, xid, *ts);
-    LWLockRelease(partitionLock);
+
+    if (*gts != 0)
+    {
+        CommitTsCacheInsert(xid, entry.global_timestamp, entry.nodeid);
+    }
     return *gts != 0;
 }
 
+/*
+ * Resolve the commit timestamps of a set of transactions into the backend
+ * cache, e.g. all the xids found on a heap page before checking visibility
+ * of its tuples.  The xids are sorted so that those on the same commit-ts
+ * page are read under a single acquisition of the partition lock.
+ *
+ * xids is sorted in place.  Transactions without a global timestamp yet are
+ * simply left out of the cache.
+ */
+void
+TransactionIdPrefetchCommitTsData(TransactionId *xids, int nxids)
+{
+    int            i;
+    int            j;
+    int            pageno;
+    int            entryno;
+    int            slotno;
+    int            partitionno;
+    LWLock       *partitionLock;
+    CommitTimestampEntry entry;
+    TimestampTz gts;
+
+    if (nxids <= 0)
+        return;
+
+    if (nxids > 1)
+        qsort(xids, nxids, sizeof(TransactionId), xidComparator);
+
+    i = 0;
+    while (i < nxids)
+    {
+        /* skip duplicates, special and already cached xids */
+        if ((i > 0 && xids[i] == xids[i - 1]) ||
+            !TransactionIdIsNormal(xids[i]) ||
+            CommitTsCacheLookup(xids[i], &gts, NULL))
+        {
+            i++;
+            continue;
+        }
+
+        pageno = TransactionIdToCTsPage(xids[i]);
+        partitionno = PagenoMappingPartitionno(CommitTsCtl, pageno);
+        partitionLock = GetPartitionLock(CommitTsCtl, partitionno);
+
+        /* lock is acquired by LruReadPage_ReadOnly */
+        slotno = LruReadPage_ReadOnly(CommitTsCtl, partitionno, pageno, xids[i]);
+
+        for (j = i; j < nxids && TransactionIdToCTsPage(xids[j]) == pageno; j++)
+        {
+            if (j > i && xids[j] == xids[j - 1])
+                continue;
+
+            entryno = TransactionIdToCTsEntry(xids[j]);
+            memcpy(&entry,
+                   CommitTsCtl->shared[partitionno]->page_buffer[slotno] +
+                   SizeOfCommitTimestampEntry * entryno,
+                   SizeOfCommitTimestampEntry);
+
+            if (entry.global_timestamp != 0)
+            {
+                CommitTsCacheInsert(xids[j], entry.global_timestamp, entry.nodeid);
+            }
+        }
+
+        LWLockRelease(partitionLock);
+        i = j;
+    }
+}
+
+/*
+ * Forget everything once the oldest cached xid falls far enough behind,
+ * the xid may be reused after a wraparound, or once the commit-ts log was
+ * truncated past it.
+ *
+ * oldestCommitTsXid is read without CommitTsLock, a stale value only delays
+ * the reset until the next call.
+ */
+static inline void
+CommitTsCacheCheckHorizon(void)
+{
+    TransactionId oldestCommitTsXid;
+
+    if (!TransactionIdIsValid(CommitTsCacheOldestXid))
+        return;
+
+    oldestCommitTsXid = ShmemVariableCache->oldestCommitTsXid;
+
+    if ((TransactionIdIsNormal(RecentXmin) &&
+         RecentXmin - CommitTsCacheOldestXid > (TransactionId) commit_ts_cache_horizon) ||
+        (TransactionIdIsNormal(oldestCommitTsXid) &&
+         TransactionIdPrecedes(CommitTsCacheOldestXid, oldestCommitTsXid)))
+    {
+        MemSet(CommitTsCache, 0, sizeof(CommitTsCache));
+        CommitTsCacheOldestXid = InvalidTransactionId;
+        CommitTsCacheResets++;
+    }
+}
+
+static inline bool
+CommitTsCacheLookup(TransactionId xid, TimestampTz *gts, RepOriginId *nodeid)
+{
+    CommitTsCacheEntry *entry;
+
+    CommitTsCacheCheckHorizon();
+
+    entry = &CommitTsCache[xid & COMMIT_TS_CACHE_MASK];
+    if (entry->xid != xid)
+        return false;
+
+    *gts = entry->global_timestamp;
+    if (nodeid)
+        *nodeid = entry->nodeid;
+    return true;
+}
+
+static inline void
+CommitTsCacheInsert(TransactionId xid, TimestampTz gts, RepOriginId nodeid)
+{
+    CommitTsCacheEntry *entry;
+
+    CommitTsCacheCheckHorizon();
+
+    /* would only make the next lookup reset the cache */
+    if (TransactionIdIsNormal(ShmemVariableCache->oldestCommitTsXid) &&
+        TransactionIdPrecedes(xid, ShmemVariableCache->oldestCommitTsXid))
+        return;
+
+    if (!TransactionIdIsValid(CommitTsCacheOldestXid) ||
+        TransactionIdPrecedes(xid, CommitTsCacheOldestXid))
+    {
+        CommitTsCacheOldestXid = xid;
+    }
+
+    entry = &CommitTsCache[xid & COMMIT_TS_CACHE_MASK];
+    entry->xid = xid;
+    entry->nodeid = nodeid;
+    entry->global_timestamp = gts;
+}
+
 
 bool
 TransactionIdGetLocalCommitTsData(TransactionId xid, TimestampTz *ts, 
@@ -453,16 +642,22 @@ TransactionIdGetLocalCommitTsData(TransactionId xid, TimestampTz *ts,
     //elog(DEBUG8, "Get committs xid %d.", xid);
     partitionno = PagenoMappingPartitionno(CommitTsCtl, pageno);
 
-    partitionLock = GetPartitionLock(CommitTsCtl, partitionno);
-    
-    /* lock is acquired by SimpleLruReadPage_ReadOnly */
-    slotno = LruReadPage_ReadOnly(CommitTsCtl, partitionno, pageno, xid);
-    memcpy(&entry,
-           CommitTsCtl->shared[partitionno]->page_buffer[slotno] +
-           SizeOfCommitTimestampEntry * entryno,
-           SizeOfCommitTimestampEntry);
+    if (!LruReadPage_Optimistic(CommitTsCtl, partitionno, pageno,
+                                SizeOfCommitTimestampEntry * entryno,
+                                (char *) &entry, SizeOfCommitTimestampEntry))
+    {
+        partitionLock = GetPartitionLock(CommitTsCtl, partitionno);
+
+        /* lock is acquired by SimpleLruReadPage_ReadOnly */
+        slotno = LruReadPage_ReadOnly(CommitTsCtl, partitionno, pageno, xid);
+        memcpy(&entry,
+               CommitTsCtl->shared[partitionno]->page_buffer[slotno] +
+               SizeOfCommitTimestampEntry * entryno,
+               SizeOfCommitTimestampEntry);
+
+        LWLockRelease(partitionLock);
+    }
 
-    
     *ts = entry.time;
     
     if (nodeid)
@@ -471,7 +666,6 @@ TransactionIdGetLocalCommitTsData(TransactionId xid, TimestampTz *ts,
     }
     
     //elog(DEBUG8, "Get committs xid %d time " INT64_FORMAT, xid, *ts);
-    LWLockRelease(partitionLock);
     return *ts != 0;
 }
 
@@ -536,6 +730,50 @@ pg_xact_commit_timestamp(PG_FUNCTION_ARGS)
     PG_RETURN_TIMESTAMPTZ(ts);
 }
 
+/*
+ * pg_commit_ts_cache_stats
+ *
+ * SQL-callable view of the commit timestamp cache of this backend: number
+ * of cached xids, the oldest of them and how often the cache was reset.
+ */
+Datum
+pg_commit_ts_cache_stats(PG_FUNCTION_ARGS)
+{
+    Datum        values[3];
+    bool        nulls[3];
+    TupleDesc    tupdesc;
+    HeapTuple    htup;
+    int            entries = 0;
+    int            i;
+
+    CommitTsCacheCheckHorizon();
+
+    for (i = 0; i < COMMIT_TS_CACHE_SIZE; i++)
+    {
+        if (TransactionIdIsValid(CommitTsCache[i].xid))
+            entries++;
+    }
+
+    tupdesc = CreateTemplateTupleDesc(3, false);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 1, "entries",
+                       INT4OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 2, "oldest_xid",
+                       XIDOID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 3, "resets",
+                       INT8OID, -1, 0);
+    tupdesc = BlessTupleDesc(tupdesc);
+
+    memset(nulls, 0, sizeof(nulls));
+    values[0] = Int32GetDatum(entries);
+    values[1] = TransactionIdGetDatum(CommitTsCacheOldestXid);
+    nulls[1] = !TransactionIdIsValid(CommitTsCacheOldestXid);
+    values[2] = Int64GetDatum((int64) CommitTsCacheResets);
+
+    htup = heap_form_tuple(tupdesc, values, nulls);
+
+    PG_RETURN_DATUM(HeapTupleGetDatum(htup));
+}
+
 Datum
 pg_xact_local_commit_timestamp(PG_FUNCTION_ARGS)
 {
@@ -910,10 +1148,12 @@ TrimCommitTs(void)
         
         byteptr = CommitTsCtl->shared[partitionno]->page_buffer[slotno] + byteno;
         
+        LruPageChangeBegin(CommitTsCtl->shared[partitionno], slotno);
 		LruTlogDisableMemoryProtection(CommitTsCtl->shared[partitionno]->page_buffer[slotno]);
         /* Zero the rest of the page */
         MemSet(byteptr, 0, BLCKSZ - byteno);
 		LruTlogEnableMemoryProtection(CommitTsCtl->shared[partitionno]->page_buffer[slotno]);
+        LruPageChangeEnd(CommitTsCtl->shared[partitionno], slotno);
 
         elog(DEBUG10, "zero out the remaining page starting from byteno %d len BLCKSZ -byteno %d entryno %d sizeofentry %lu",
             byteno, BLCKSZ - byteno, entryno, SizeOfCommitTimestampEntry);
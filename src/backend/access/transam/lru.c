@@ -226,6 +226,7 @@ LruShmemSize(int nslots, int nlsns)
     sz += MAXALIGN(nslots * sizeof(bool));    /* page_dirty[] */
     sz += MAXALIGN(nslots * sizeof(int));    /* page_number[] */
     sz += MAXALIGN(nslots * sizeof(int));    /* page_lru_count[] */
+    sz += MAXALIGN(nslots * sizeof(pg_atomic_uint32));    /* page_seq[] */
     sz += MAXALIGN((nslots + 1) * sizeof(LWLockPadded));    /* buffer_locks[] */
 
     if (nlsns > 0)
@@ -461,6 +462,8 @@ LruInit(LruCtl ctl, const char *name, int nslots, int nlsns, int nbufs,
             offset += MAXALIGN(nslots * sizeof(int));
             shared->page_lru_count = (int *) (ptr + offset);
             offset += MAXALIGN(nslots * sizeof(int));
+            shared->page_seq = (pg_atomic_uint32 *) (ptr + offset);
+            offset += MAXALIGN(nslots * sizeof(pg_atomic_uint32));
 
             if (nlsns > 0)
             {
@@ -493,6 +496,7 @@ LruInit(LruCtl ctl, const char *name, int nslots, int nlsns, int nbufs,
                 shared->page_status[slotno] = LRU_PAGE_EMPTY;
                 shared->page_dirty[slotno] = false;
                 shared->page_lru_count[slotno] = 0;
+                pg_atomic_init_u32(&shared->page_seq[slotno], 0);
                 ptr += BLCKSZ;
             }
             LWLockInitialize(&shared->buffer_locks[slotno].lock,
@@ -547,6 +551,8 @@ LruZeroPage(LruCtl ctl, int partitionno, int pageno)
             !shared->page_dirty[slotno]) ||
            shared->page_number[slotno] == pageno);
 
+    LruPageChangeBegin(shared, slotno);
+
     if(shared->page_number[slotno] != pageno || 
         shared->page_status[slotno] == LRU_PAGE_EMPTY){
         
@@ -567,6 +573,8 @@ LruZeroPage(LruCtl ctl, int partitionno, int pageno)
     MemSet(shared->page_buffer[slotno], 0, BLCKSZ);
 	LruTlogEnableMemoryProtection(shared->page_buffer[slotno]);
 
+    LruPageChangeEnd(shared, slotno);
+
     /* Set the LSNs for this new page to zero */
     LruZeroLSNs(ctl, partitionno, slotno);
 
@@ -651,7 +659,9 @@ LruWaitIO(LruCtl ctl, int partitionno, int slotno)
                 INIT_LRUBUFTAG(tag, pageno);
                 hash = LruBufTableHashCode(&tag);
                 LruBufTableDelete(&tag, hash);        
+                LruPageChangeBegin(shared, slotno);
                 shared->page_status[slotno] = LRU_PAGE_EMPTY;
+                LruPageChangeEnd(shared, slotno);
             }
             else                /* write_in_progress */
             {
@@ -757,6 +767,8 @@ LruReadPage(LruCtl ctl, int partitionno, int pageno, bool write_ok,
             Assert(lookupno == slotno);
         }
 #endif
+        /* the change ends once the read-in is done, see below */
+        LruPageChangeBegin(shared, slotno);
         shared->page_number[slotno] = pageno;
         shared->page_status[slotno] = LRU_PAGE_READ_IN_PROGRESS;
         shared->page_dirty[slotno] = false;
@@ -784,6 +796,7 @@ LruReadPage(LruCtl ctl, int partitionno, int pageno, bool write_ok,
 
         
         shared->page_status[slotno] = ok ? LRU_PAGE_VALID : LRU_PAGE_EMPTY;
+        LruPageChangeEnd(shared, slotno);
         
         
         LWLockRelease(&shared->buffer_locks[slotno].lock);
@@ -884,6 +897,56 @@ LruReadPage_ReadOnly(LruCtl ctl, int partitionno, int pageno, TransactionId xid)
     return LruReadPage(ctl, partitionno, pageno, true, xid);
 }
 
+/*
+ * Copy len bytes at offset of a page without taking the control lock.
+ *
+ * This only succeeds if the page is already resident and valid, and no one
+ * replaced it or modified its content while we were copying, as told by the
+ * slot's sequence counter.  The slots of the partition are searched linearly,
+ * there are only a few of them, which also avoids the shared hash table.
+ * Returns false if the caller has to fall back to LruReadPage_ReadOnly().
+ */
+bool
+LruReadPage_Optimistic(LruCtl ctl, int partitionno, int pageno,
+                       int offset, char *dest, Size len)
+{
+    LruShared    shared = ctl->shared[partitionno];
+    int            slotno;
+
+    Assert(offset >= 0 && offset + len <= BLCKSZ);
+
+    for (slotno = 0; slotno < shared->num_slots; slotno++)
+    {
+        uint32        seq;
+        LruPageStatus status;
+
+        if (((volatile int *) shared->page_number)[slotno] != pageno)
+            continue;
+
+        seq = pg_atomic_read_u32(&shared->page_seq[slotno]);
+        if (seq & 1)
+            return false;
+        pg_read_barrier();
+
+        status = ((volatile LruPageStatus *) shared->page_status)[slotno];
+        if (((volatile int *) shared->page_number)[slotno] != pageno ||
+            (status != LRU_PAGE_VALID && status != LRU_PAGE_WRITE_IN_PROGRESS))
+            return false;
+
+        memcpy(dest, shared->page_buffer[slotno] + offset, len);
+
+        pg_read_barrier();
+        if (pg_atomic_read_u32(&shared->page_seq[slotno]) != seq)
+            return false;
+
+        /* See comments for LruRecentlyUsed macro */
+        LruRecentlyUsed(shared, slotno);
+        return true;
+    }
+
+    return false;
+}
+
 /*
  * Write a page from a shared buffer, if necessary.
  * Does nothing if the specified slot is not dirty.
@@ -1707,7 +1770,9 @@ restart:;
             oldPartitionno = BufHashPartition(oldHash);
             Assert(oldPartitionno == partitionno);
             LruBufTableDelete(&oldTag, oldHash);
+            LruPageChangeBegin(shared, slotno);
             shared->page_status[slotno] = LRU_PAGE_EMPTY;
+            LruPageChangeEnd(shared, slotno);
             elog(DEBUG10, "truncate pageno %d partition %d slotno %d cutoffpage %d.", oldPageno, partitionno, slotno, cutoffPage);
             continue;
         }
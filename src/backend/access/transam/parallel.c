@@ -17,11 +17,13 @@
 
 #include "postgres.h"
 
+#include "access/nbtree.h"
 #include "access/parallel.h"
 #include "access/xact.h"
 #include "access/xlog.h"
 #include "catalog/namespace.h"
 #include "commands/async.h"
+#include "commands/vacuum.h"
 #include "executor/execParallel.h"
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
@@ -133,7 +135,15 @@ static const struct
 {
     {
         "ParallelQueryMain", ParallelQueryMain
+    },
+    {
+        "_bt_parallel_build_main", _bt_parallel_build_main
+    },
+#ifdef __OPENTENBASE__
+    {
+        "analyze_parallel_sample_main", analyze_parallel_sample_main
     }
+#endif
 };
 
 /* Private functions. */
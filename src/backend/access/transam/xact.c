@@ -104,6 +104,7 @@
 #include "commands/extension.h"
 #include "tcop/utility.h"
 #include "utils/relcryptmap.h"
+#include "utils/tqual.h"
 #endif
 
 #ifdef __TWO_PHASE_TESTS__
@@ -259,6 +260,8 @@ typedef struct TransactionStateData
     bool        prevXactReadOnly;    /* entry-time xact r/o state */
     bool        startedInRecovery;    /* did we start in recovery? */
     bool        didLogXid;        /* has xid been included in WAL record? */
+    bool        assigned;        /* has toplevel XID been included in WAL
+                                 * record? */
     int            parallelModeLevel;    /* Enter/ExitParallelMode counter */
     struct TransactionStateData *parent;    /* back link to parent */
 #ifdef XCP
@@ -311,6 +314,7 @@ static TransactionStateData TopTransactionStateData = {
     false,                        /* entry-time xact r/o state */
     false,                        /* startedInRecovery */
     false,                        /* didLogXid */
+    false,                        /* assigned */
     0,                            /* parallelMode */
     NULL,                        /* link to parent state block */
 #ifdef XCP
@@ -674,6 +678,52 @@ MarkCurrentTransactionIdLoggedIfAny(void)
 }
 
 
+/*
+ *    IsSubTransactionAssignmentPending
+ *
+ * With wal_level=logical, the first WAL record of a subtransaction also
+ * carries the XID of its toplevel transaction, so that logical decoding
+ * knows the subtransaction as such as soon as it sees a change of it.  Is
+ * the current subtransaction still to be logged that way?
+ */
+bool
+IsSubTransactionAssignmentPending(void)
+{
+    /* wal_level has to be logical */
+    if (!XLogLogicalInfoActive())
+        return false;
+
+    /* we need to be in a transaction state */
+    if (!IsTransactionState())
+        return false;
+
+    /* it has to be a subtransaction */
+    if (!IsSubTransaction())
+        return false;
+
+    /* the subtransaction has to have a XID assigned */
+    if (!TransactionIdIsValid(GetCurrentTransactionIdIfAny()))
+        return false;
+
+    /* and it should not be already 'assigned' */
+    return !CurrentTransactionState->assigned;
+}
+
+/*
+ *    MarkSubTransactionAssigned
+ *
+ * Remember that the toplevel XID of the current subtransaction has been
+ * included in a WAL record.
+ */
+void
+MarkSubTransactionAssigned(void)
+{
+    Assert(IsSubTransactionAssignmentPending());
+
+    CurrentTransactionState->assigned = true;
+}
+
+
 /*
  *    GetStableLatestTransactionId
  *
@@ -3988,6 +4038,9 @@ AbortTransaction(void)
     /* Clean up buffer I/O and buffer context locks, too */
     AbortBufferIO();
     UnlockBuffers();
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+    AtAbort_HeapTupleHintBatch();
+#endif
 
     /* Reset WAL record construction state */
     XLogResetInsertion();
@@ -6351,6 +6404,9 @@ AbortSubTransaction(void)
     pgstat_progress_end_command();
     AbortBufferIO();
     UnlockBuffers();
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+    AtAbort_HeapTupleHintBatch();
+#endif
 
     /* Reset WAL record construction state */
     XLogResetInsertion();
@@ -95,10 +95,14 @@ static char *hdr_scratch = NULL;
 
 #define SizeOfXlogOrigin    (sizeof(RepOriginId) + sizeof(char))
 
+/* Size of the toplevel XID, when the record includes it */
+#define SizeOfXLogTransactionId    (sizeof(TransactionId) + sizeof(char))
+
 #define HEADER_SCRATCH_SIZE \
     (SizeOfXLogRecord + \
      MaxSizeOfXLogRecordBlockHeader * (XLR_MAX_BLOCK_ID + 1) + \
-     SizeOfXLogRecordDataHeaderLong + SizeOfXlogOrigin)
+     SizeOfXLogRecordDataHeaderLong + SizeOfXlogOrigin + \
+     SizeOfXLogTransactionId)
 
 /*
  * An array of XLogRecData structs, to hold registered data.
@@ -114,7 +118,7 @@ static MemoryContext xloginsert_cxt;
 
 static XLogRecData *XLogRecordAssemble(RmgrId rmid, uint8 info,
                    XLogRecPtr RedoRecPtr, bool doPageWrites,
-                   XLogRecPtr *fpw_lsn);
+                   XLogRecPtr *fpw_lsn, bool *topxid_included);
 static bool XLogCompressBackupBlock(char *page, uint16 hole_offset,
                         uint16 hole_length, char *dest, uint16 *dlen);
 
@@ -421,6 +425,7 @@ XLogRecPtr
 XLogInsert(RmgrId rmid, uint8 info)
 {
     XLogRecPtr    EndPos;
+    bool        topxid_included = false;
 
     /* XLogBeginInsert() must have been called. */
     if (!begininsert_called)
@@ -463,11 +468,18 @@ XLogInsert(RmgrId rmid, uint8 info)
         GetFullPageWriteInfo(&RedoRecPtr, &doPageWrites);
 
         rdt = XLogRecordAssemble(rmid, info, RedoRecPtr, doPageWrites,
-                                 &fpw_lsn);
+                                 &fpw_lsn, &topxid_included);
 
         EndPos = XLogInsertRecord(rdt, fpw_lsn, curinsert_flags);
     } while (EndPos == InvalidXLogRecPtr);
 
+    /*
+     * Logical decoding now knows the toplevel transaction of the current
+     * subtransaction.
+     */
+    if (topxid_included)
+        MarkSubTransactionAssigned();
+
     XLogResetInsertion();
 
     return EndPos;
@@ -488,7 +500,7 @@ XLogInsert(RmgrId rmid, uint8 info)
 static XLogRecData *
 XLogRecordAssemble(RmgrId rmid, uint8 info,
                    XLogRecPtr RedoRecPtr, bool doPageWrites,
-                   XLogRecPtr *fpw_lsn)
+                   XLogRecPtr *fpw_lsn, bool *topxid_included)
 {// #lizard forgives
     XLogRecData *rdt;
     uint32        total_len = 0;
@@ -769,6 +781,18 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
         scratch += sizeof(replorigin_session_origin);
     }
 
+    /* followed by toplevel XID, if not already included in previous record */
+    *topxid_included = false;
+    if (IsSubTransactionAssignmentPending())
+    {
+        TransactionId xid = GetTopTransactionIdIfAny();
+
+        *(scratch++) = (char) XLR_BLOCK_ID_TOPLEVEL_XID;
+        memcpy(scratch, &xid, sizeof(TransactionId));
+        scratch += sizeof(TransactionId);
+        *topxid_included = true;
+    }
+
     /* followed by main data, if any */
     if (mainrdata_len > 0)
     {
@@ -39,6 +39,7 @@
 #include "access/htup_details.h"
 #include "access/skey.h"
 #include "access/sysattr.h"
+#include "access/xact.h"
 #include "catalog/catalog.h"
 #include "catalog/dependency.h"
 #include "catalog/indexing.h"
@@ -76,6 +77,7 @@
 #include "commands/proclang.h"
 #include "commands/tablespace.h"
 #include "executor/spi.h"
+#include "funcapi.h"
 #include "foreign/foreign.h"
 #include "lib/stringinfo.h"
 #include "libpq/libpq-be.h"
@@ -94,6 +96,7 @@
 #include "utils/fmgroids.h"
 #include "utils/formatting.h"
 #include "utils/guc.h"
+#include "utils/hsearch.h"
 #include "utils/inval.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
@@ -104,6 +107,7 @@
 bool enable_audit = false;
 bool enable_audit_warning = false;
 bool enable_audit_depend = false;
+bool enable_audit_policy_cache = true;
 
 static bool use_object_missok = true;
 
@@ -268,6 +272,51 @@ typedef struct AuditHitFindObjectContext
 
 static AuditResultInfo * gAuditResultInfo = NULL;
 
+/*
+ * Audit policies compiled from pg_audit_o/d/u/s.
+ *
+ * Every configure row with action_ison is turned into one hash entry, so
+ * deciding whether an action hits an audit is one hash probe instead of an
+ * index scan on the catalog. The cache is marked invalid by syscache
+ * invalidation on any of the four catalogs and rebuilt on next use.
+ */
+typedef enum AuditPolicyKind
+{
+    AuditPolicy_Object = 0,                                /* AUDIT xxx ON xxx, pg_audit_o */
+    AuditPolicy_ObjectDefault,                            /* AUDIT xxx ON DEFAULT, pg_audit_d */
+    AuditPolicy_User,                                    /* AUDIT xxx BY xxx, pg_audit_u */
+    AuditPolicy_Statement,                                /* AUDIT xxx, pg_audit_s */
+    AuditPolicy_NumKinds
+} AuditPolicyKind;
+
+typedef struct AuditPolicyKey
+{
+    int32            kind;                                /* AuditPolicyKind */
+    Oid                class_id;                            /* classId of object for AuditPolicy_Object */
+    Oid                object_id;                            /* objectId for AuditPolicy_Object, user id for AuditPolicy_User */
+    int32            object_sub_id;                        /* objectSubId for AuditPolicy_Object */
+    int32            action_id;                            /* refer to AuditSQL */
+} AuditPolicyKey;
+
+typedef struct AuditPolicyEntry
+{
+    AuditPolicyKey    key;                                /* hash key, must be first */
+    bool            on_success;                            /* audit when sql exec successfull */
+    bool            on_fail;                            /* audit when sql exec not successfull */
+} AuditPolicyEntry;
+
+typedef struct AuditPolicyCache
+{
+    HTAB            *policies;                            /* AuditPolicyKey -> AuditPolicyEntry */
+    int32            npolicies[AuditPolicy_NumKinds];    /* number of entries of each kind */
+    bool            valid;                                /* false when catalogs changed since build */
+    bool            callback_registered;                /* syscache callbacks registered ? */
+    uint32            inval_count;                        /* number of invalidations received */
+    bool            bypass;                                /* match in catalogs, see pg_audit_policy_cache_check */
+} AuditPolicyCache;
+
+static AuditPolicyCache gAuditPolicyCache = { NULL, { 0 }, false, false, 0, false };
+
 #ifdef Use_Audit_Assert
     #ifdef Trap
         #undef Trap
@@ -456,6 +505,29 @@ static bool audit_hit_match_in_pg_audit_u(AuditHitInfo * audit_hit,
 static bool audit_hit_match_in_pg_audit_s(AuditHitInfo * audit_hit,
                                              AuditSQL action_id,
                                              AuditMode reverse_mode);
+static void audit_policy_invalidate_callback(Datum arg, int cacheid, uint32 hashvalue);
+static void audit_policy_add_entry(AuditPolicyKind kind,
+                                   Oid class_id,
+                                   Oid object_id,
+                                   int32 object_sub_id,
+                                   int32 action_id,
+                                   AuditMode action_mode);
+static void audit_policy_load_catalog(int32 sys_cacheid);
+static bool audit_policy_cache_prepare(void);
+static bool audit_policy_cache_is_empty(void);
+static bool audit_policy_cache_usable(void);
+static void audit_policy_check_add_key(List ** l_keys, Oid class_id, Oid object_id, int32 object_sub_id);
+static List * audit_policy_check_collect_keys(int32 sys_cacheid);
+static bool audit_policy_check_probe(AuditPolicyKind kind,
+                                     ObjectAddress * key,
+                                     AuditSQL action_id,
+                                     AuditMode reverse_mode);
+static bool audit_policy_cache_match(AuditPolicyKind kind,
+                                     Oid class_id,
+                                     Oid object_id,
+                                     int32 object_sub_id,
+                                     AuditSQL action_id,
+                                     AuditMode reverse_mode);
 static void audit_hit_rebuild_hit_info(AuditHitInfo * hit_info,
                                        int hit_index,
                                        AuditStmtMap * hit_action,
@@ -4883,7 +4955,19 @@ void AuditReadQueryList(const char * query_sring, List * l_parsetree)
         is_audit_environment() &&
         l_parsetree != NULL)
     {
-        MemoryContext oldcontext = MemoryContextSwitchTo(AuditContext);
+        MemoryContext oldcontext = NULL;
+
+        /*
+         * Nothing is configured to be audited, skip walking the query tree.
+         * Sql executed by audit_admin is always audited.
+         */
+        if (!audituser() &&
+            audit_policy_cache_is_empty())
+        {
+            return;
+        }
+
+        oldcontext = MemoryContextSwitchTo(AuditContext);
         audit_hit_read_query_list(MyProcPort, query_sring, l_parsetree);
         MemoryContextSwitchTo(oldcontext);
     }
@@ -8393,6 +8477,16 @@ static bool audit_hit_match_in_pg_audit_o(AuditHitInfo * audit_hit,
 
     bool is_match = false;
 
+    if (audit_policy_cache_usable())
+    {
+        return audit_policy_cache_match(AuditPolicy_Object,
+                                        audit_hit->obj_addr.classId,
+                                        audit_hit->obj_addr.objectId,
+                                        audit_hit->obj_addr.objectSubId,
+                                        action_id,
+                                        reverse_mode);
+    }
+
     audit_get_cacheid_pg_audit_o(&(sys_cacheid), NULL);
     GetSysCacheInfo(sys_cacheid, 
                     &sys_reloid,
@@ -8465,6 +8559,16 @@ static bool audit_hit_match_in_pg_audit_d(AuditHitInfo * audit_hit,
 
     bool is_match = false;
 
+    if (audit_policy_cache_usable())
+    {
+        return audit_policy_cache_match(AuditPolicy_ObjectDefault,
+                                        InvalidOid,
+                                        InvalidOid,
+                                        0,
+                                        action_id,
+                                        reverse_mode);
+    }
+
     audit_get_cacheid_pg_audit_d((int32 *)&(sys_cacheid), NULL);
     GetSysCacheInfo(sys_cacheid, 
                     &sys_reloid,
@@ -8525,6 +8629,16 @@ static bool audit_hit_match_in_pg_audit_u(AuditHitInfo * audit_hit,
 
     bool is_match = false;
 
+    if (audit_policy_cache_usable())
+    {
+        return audit_policy_cache_match(AuditPolicy_User,
+                                        InvalidOid,
+                                        GetUserId(),
+                                        0,
+                                        action_id,
+                                        reverse_mode);
+    }
+
     audit_get_cacheid_pg_audit_u((int32 *)&(sys_cacheid), NULL);
     GetSysCacheInfo(sys_cacheid, 
                     &sys_reloid,
@@ -8589,6 +8703,16 @@ static bool audit_hit_match_in_pg_audit_s(AuditHitInfo * audit_hit,
 
     bool is_match = false;
 
+    if (audit_policy_cache_usable())
+    {
+        return audit_policy_cache_match(AuditPolicy_Statement,
+                                        InvalidOid,
+                                        InvalidOid,
+                                        0,
+                                        action_id,
+                                        reverse_mode);
+    }
+
     audit_get_cacheid_pg_audit_s((int32 *)&(sys_cacheid), NULL);
     GetSysCacheInfo(sys_cacheid, 
                     &sys_reloid,
@@ -8630,6 +8754,540 @@ static bool audit_hit_match_in_pg_audit_s(AuditHitInfo * audit_hit,
     return is_match;
 }
 
+static void audit_policy_invalidate_callback(Datum arg, int cacheid, uint32 hashvalue)
+{
+    gAuditPolicyCache.valid = false;
+    gAuditPolicyCache.inval_count++;
+}
+
+static void audit_policy_add_entry(AuditPolicyKind kind,
+                                   Oid class_id,
+                                   Oid object_id,
+                                   int32 object_sub_id,
+                                   int32 action_id,
+                                   AuditMode action_mode)
+{
+    AuditPolicyKey key;
+    AuditPolicyEntry * entry = NULL;
+    bool found = false;
+
+    MemSet(&key, 0, sizeof(key));
+    key.kind = kind;
+    key.class_id = class_id;
+    key.object_id = object_id;
+    key.object_sub_id = object_sub_id;
+    key.action_id = action_id;
+
+    entry = (AuditPolicyEntry *) hash_search(gAuditPolicyCache.policies,
+                                             &key,
+                                             HASH_ENTER,
+                                             &found);
+    if (!found)
+    {
+        entry->on_success = false;
+        entry->on_fail = false;
+        gAuditPolicyCache.npolicies[kind]++;
+    }
+
+    /* same rule as audit_mode != reverse_mode in audit_hit_match_in_pg_audit_x */
+    if (action_mode != AuditMode_Fail)
+    {
+        entry->on_success = true;
+    }
+
+    if (action_mode != AuditMode_Success)
+    {
+        entry->on_fail = true;
+    }
+}
+
+static void audit_policy_load_catalog(int32 sys_cacheid)
+{
+    Oid sys_reloid = InvalidOid;
+    Oid sys_indoid = InvalidOid;
+
+    Relation sys_rel = NULL;
+    LOCKMODE lockmode = AccessShareLock;
+
+    SysScanDesc sd = NULL;
+    HeapTuple    tup = NULL;
+
+    GetSysCacheInfo(sys_cacheid, 
+                    &sys_reloid,
+                    &sys_indoid,
+                    NULL);
+
+    sys_rel = heap_open(sys_reloid, lockmode);
+    sd = systable_beginscan(sys_rel, 
+                            InvalidOid,
+                            false,
+                            NULL, 
+                            0,
+                            NULL);
+
+    while ((tup = systable_getnext(sd)) != NULL)
+    {
+        switch (sys_cacheid)
+        {
+            case AUDITOBJCONF:
+            {
+                Form_audit_obj_conf pg_struct = (Form_audit_obj_conf)(GETSTRUCT(tup));
+
+                if (pg_struct->action_ison)
+                {
+                    audit_policy_add_entry(AuditPolicy_Object,
+                                           pg_struct->class_id,
+                                           pg_struct->object_id,
+                                           pg_struct->object_sub_id,
+                                           pg_struct->action_id,
+                                           (AuditMode)pg_struct->action_mode);
+                }
+                break;
+            }
+            case AUDITOBJDEFAULT:
+            {
+                Form_audit_obj_def_opts pg_struct = (Form_audit_obj_def_opts)(GETSTRUCT(tup));
+
+                if (pg_struct->action_ison)
+                {
+                    audit_policy_add_entry(AuditPolicy_ObjectDefault,
+                                           InvalidOid,
+                                           InvalidOid,
+                                           0,
+                                           pg_struct->action_id,
+                                           (AuditMode)pg_struct->action_mode);
+                }
+                break;
+            }
+            case AUDITUSERCONF:
+            {
+                Form_audit_user_conf pg_struct = (Form_audit_user_conf)(GETSTRUCT(tup));
+
+                if (pg_struct->action_ison)
+                {
+                    audit_policy_add_entry(AuditPolicy_User,
+                                           InvalidOid,
+                                           pg_struct->user_id,
+                                           0,
+                                           pg_struct->action_id,
+                                           (AuditMode)pg_struct->action_mode);
+                }
+                break;
+            }
+            case AUDITSTMTCONF:
+            {
+                Form_audit_stmt_conf pg_struct = (Form_audit_stmt_conf)(GETSTRUCT(tup));
+
+                if (pg_struct->action_ison)
+                {
+                    audit_policy_add_entry(AuditPolicy_Statement,
+                                           InvalidOid,
+                                           InvalidOid,
+                                           0,
+                                           pg_struct->action_id,
+                                           (AuditMode)pg_struct->action_mode);
+                }
+                break;
+            }
+            default:
+                elog(ERROR, "unrecognized audit syscache id: %d", sys_cacheid);
+                break;
+        }
+    }
+
+    systable_endscan(sd);
+    heap_close(sys_rel, lockmode);
+}
+
+/*
+ * Make sure the compiled audit policies are up to date, rebuild them from
+ * catalogs if necessary. Return false if they can not be used now, caller
+ * should fall back to scan catalogs.
+ */
+static bool audit_policy_cache_prepare(void)
+{
+    int32 sys_cacheid = InvalidSysCacheID;
+    uint32 inval_count = 0;
+    HASHCTL ctl;
+
+    if (gAuditPolicyCache.valid)
+    {
+        return true;
+    }
+
+    /* need a valid transaction to read catalogs */
+    if (!IsTransactionState())
+    {
+        return false;
+    }
+
+    if (!gAuditPolicyCache.callback_registered)
+    {
+        audit_get_cacheid_pg_audit_o(&sys_cacheid, NULL);
+        CacheRegisterSyscacheCallback(sys_cacheid, audit_policy_invalidate_callback, (Datum) 0);
+        audit_get_cacheid_pg_audit_d(&sys_cacheid, NULL);
+        CacheRegisterSyscacheCallback(sys_cacheid, audit_policy_invalidate_callback, (Datum) 0);
+        audit_get_cacheid_pg_audit_u(&sys_cacheid, NULL);
+        CacheRegisterSyscacheCallback(sys_cacheid, audit_policy_invalidate_callback, (Datum) 0);
+        audit_get_cacheid_pg_audit_s(&sys_cacheid, NULL);
+        CacheRegisterSyscacheCallback(sys_cacheid, audit_policy_invalidate_callback, (Datum) 0);
+        gAuditPolicyCache.callback_registered = true;
+    }
+
+    /*
+     * Only mark the result valid once all catalogs are read, so that an
+     * error half way leaves it invalid.  An invalidation arriving while we
+     * read them may have been missed by the scans, build again then.
+     */
+    do
+    {
+        inval_count = gAuditPolicyCache.inval_count;
+
+        if (gAuditPolicyCache.policies != NULL)
+        {
+            hash_destroy(gAuditPolicyCache.policies);
+            gAuditPolicyCache.policies = NULL;
+        }
+
+        MemSet(&ctl, 0, sizeof(ctl));
+        ctl.keysize = sizeof(AuditPolicyKey);
+        ctl.entrysize = sizeof(AuditPolicyEntry);
+        ctl.hcxt = CacheMemoryContext;
+        gAuditPolicyCache.policies = hash_create("Audit Policy Cache",
+                                                 64,
+                                                 &ctl,
+                                                 HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+        MemSet(gAuditPolicyCache.npolicies, 0, sizeof(gAuditPolicyCache.npolicies));
+
+        audit_get_cacheid_pg_audit_o(&sys_cacheid, NULL);
+        audit_policy_load_catalog(sys_cacheid);
+        audit_get_cacheid_pg_audit_d(&sys_cacheid, NULL);
+        audit_policy_load_catalog(sys_cacheid);
+        audit_get_cacheid_pg_audit_u(&sys_cacheid, NULL);
+        audit_policy_load_catalog(sys_cacheid);
+        audit_get_cacheid_pg_audit_s(&sys_cacheid, NULL);
+        audit_policy_load_catalog(sys_cacheid);
+    } while (inval_count != gAuditPolicyCache.inval_count);
+
+    gAuditPolicyCache.valid = true;
+
+    return true;
+}
+
+/*
+ * True if there is no audit configure at all, so no sql can hit an audit
+ * unless executed by audit_admin.
+ */
+static bool audit_policy_cache_is_empty(void)
+{
+    int i = 0;
+
+    if (!enable_audit_policy_cache ||
+        !audit_policy_cache_prepare())
+    {
+        return false;
+    }
+
+    for (i = 0; i < AuditPolicy_NumKinds; i++)
+    {
+        if (gAuditPolicyCache.npolicies[i] != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * True if audit_hit_match_in_pg_audit_x should answer from the compiled
+ * policies instead of scanning the catalogs.
+ */
+static bool audit_policy_cache_usable(void)
+{
+    return (enable_audit_policy_cache &&
+            gAuditPolicyCache.valid &&
+            !gAuditPolicyCache.bypass);
+}
+
+static bool audit_policy_cache_match(AuditPolicyKind kind,
+                                     Oid class_id,
+                                     Oid object_id,
+                                     int32 object_sub_id,
+                                     AuditSQL action_id,
+                                     AuditMode reverse_mode)
+{
+    AuditPolicyKey key;
+    AuditPolicyEntry * entry = NULL;
+
+    Assert(gAuditPolicyCache.valid);
+
+    if (gAuditPolicyCache.npolicies[kind] == 0)
+    {
+        return false;
+    }
+
+    MemSet(&key, 0, sizeof(key));
+    key.kind = kind;
+    key.class_id = class_id;
+    key.object_id = object_id;
+    key.object_sub_id = object_sub_id;
+    key.action_id = action_id;
+
+    entry = (AuditPolicyEntry *) hash_search(gAuditPolicyCache.policies,
+                                             &key,
+                                             HASH_FIND,
+                                             NULL);
+    if (entry == NULL)
+    {
+        return false;
+    }
+
+    return (reverse_mode == AuditMode_Fail) ? entry->on_success : entry->on_fail;
+}
+
+static void audit_policy_check_add_key(List ** l_keys, Oid class_id, Oid object_id, int32 object_sub_id)
+{
+    ListCell * lc = NULL;
+    ObjectAddress * key = NULL;
+
+    foreach(lc, *l_keys)
+    {
+        key = (ObjectAddress *) lfirst(lc);
+
+        if (key->classId == class_id &&
+            key->objectId == object_id &&
+            key->objectSubId == object_sub_id)
+        {
+            return;
+        }
+    }
+
+    key = (ObjectAddress *) palloc0(sizeof(ObjectAddress));
+    key->classId = class_id;
+    key->objectId = object_id;
+    key->objectSubId = object_sub_id;
+    *l_keys = lappend(*l_keys, key);
+}
+
+/*
+ * Distinct objects or users configured in one audit catalog, whether or not
+ * the action is switched on. pg_audit_d and pg_audit_s have a single key.
+ */
+static List * audit_policy_check_collect_keys(int32 sys_cacheid)
+{
+    Oid sys_reloid = InvalidOid;
+    Oid sys_indoid = InvalidOid;
+
+    Relation sys_rel = NULL;
+    LOCKMODE lockmode = AccessShareLock;
+
+    SysScanDesc sd = NULL;
+    HeapTuple    tup = NULL;
+    List * l_keys = NIL;
+
+    if (sys_cacheid == AUDITOBJDEFAULT ||
+        sys_cacheid == AUDITSTMTCONF)
+    {
+        audit_policy_check_add_key(&l_keys, InvalidOid, InvalidOid, 0);
+        return l_keys;
+    }
+
+    GetSysCacheInfo(sys_cacheid, 
+                    &sys_reloid,
+                    &sys_indoid,
+                    NULL);
+
+    sys_rel = heap_open(sys_reloid, lockmode);
+    sd = systable_beginscan(sys_rel, 
+                            InvalidOid,
+                            false,
+                            NULL, 
+                            0,
+                            NULL);
+
+    while ((tup = systable_getnext(sd)) != NULL)
+    {
+        if (sys_cacheid == AUDITOBJCONF)
+        {
+            Form_audit_obj_conf pg_struct = (Form_audit_obj_conf)(GETSTRUCT(tup));
+
+            audit_policy_check_add_key(&l_keys,
+                                       pg_struct->class_id,
+                                       pg_struct->object_id,
+                                       pg_struct->object_sub_id);
+        }
+        else
+        {
+            Form_audit_user_conf pg_struct = (Form_audit_user_conf)(GETSTRUCT(tup));
+
+            Assert(sys_cacheid == AUDITUSERCONF);
+            audit_policy_check_add_key(&l_keys,
+                                       InvalidOid,
+                                       pg_struct->user_id,
+                                       0);
+        }
+    }
+
+    systable_endscan(sd);
+    heap_close(sys_rel, lockmode);
+
+    return l_keys;
+}
+
+/*
+ * Match one action against the compiled policies and by scanning the
+ * catalogs, return true if both agree.
+ */
+static bool audit_policy_check_probe(AuditPolicyKind kind,
+                                     ObjectAddress * key,
+                                     AuditSQL action_id,
+                                     AuditMode reverse_mode)
+{
+    AuditHitInfo audit_hit;
+    bool cache_match = false;
+    bool catalog_match = false;
+    Oid save_userid = InvalidOid;
+    int save_sec_context = 0;
+
+    if (!audit_policy_cache_prepare())
+    {
+        elog(ERROR, "audit policy cache can not be built");
+    }
+
+    cache_match = audit_policy_cache_match(kind,
+                                           key->classId,
+                                           key->objectId,
+                                           key->objectSubId,
+                                           action_id,
+                                           reverse_mode);
+
+    MemSet(&audit_hit, 0, sizeof(audit_hit));
+    audit_hit.obj_addr = *key;
+
+    gAuditPolicyCache.bypass = true;
+    PG_TRY();
+    {
+        switch (kind)
+        {
+            case AuditPolicy_Object:
+                catalog_match = audit_hit_match_in_pg_audit_o(&audit_hit, action_id, reverse_mode);
+                break;
+            case AuditPolicy_ObjectDefault:
+                catalog_match = audit_hit_match_in_pg_audit_d(&audit_hit, action_id, reverse_mode);
+                break;
+            case AuditPolicy_User:
+                /* pg_audit_u is matched against the current user */
+                GetUserIdAndSecContext(&save_userid, &save_sec_context);
+                SetUserIdAndSecContext(key->objectId, save_sec_context);
+                catalog_match = audit_hit_match_in_pg_audit_u(&audit_hit, action_id, reverse_mode);
+                SetUserIdAndSecContext(save_userid, save_sec_context);
+                break;
+            case AuditPolicy_Statement:
+                catalog_match = audit_hit_match_in_pg_audit_s(&audit_hit, action_id, reverse_mode);
+                break;
+            default:
+                elog(ERROR, "unrecognized audit policy kind: %d", kind);
+                break;
+        }
+    }
+    PG_CATCH();
+    {
+        gAuditPolicyCache.bypass = false;
+        PG_RE_THROW();
+    }
+    PG_END_TRY();
+    gAuditPolicyCache.bypass = false;
+
+    if (cache_match != catalog_match)
+    {
+        elog(WARNING, "audit policy cache mismatch: kind %d, class %u, object %u, sub %d, action %d, reverse mode %c, cache %s, catalog %s",
+             kind, key->classId, key->objectId, key->objectSubId,
+             action_id, (char) reverse_mode,
+             cache_match ? "true" : "false", catalog_match ? "true" : "false");
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * pg_audit_policy_cache_check -- match every action against every object,
+ * user and statement configured in the audit catalogs, for success and for
+ * failure, once through the compiled policies and once by scanning the
+ * catalogs. Return the number of probes and of disagreements.
+ */
+Datum
+pg_audit_policy_cache_check(PG_FUNCTION_ARGS)
+{
+    TupleDesc tupdesc;
+    Datum values[2];
+    bool nulls[2];
+    int64 probes = 0;
+    int64 mismatches = 0;
+    int32 kind = 0;
+
+    if (!audituser() && !superuser())
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+                 errmsg("must be audit_admin or superuser to check audit policies")));
+    }
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+        elog(ERROR, "return type must be a row type");
+
+    for (kind = 0; kind < AuditPolicy_NumKinds; kind++)
+    {
+        int32 sys_cacheid = InvalidSysCacheID;
+        List * l_keys = NIL;
+        ListCell * lc = NULL;
+
+        switch (kind)
+        {
+            case AuditPolicy_Object:
+                audit_get_cacheid_pg_audit_o(&sys_cacheid, NULL);
+                break;
+            case AuditPolicy_ObjectDefault:
+                audit_get_cacheid_pg_audit_d(&sys_cacheid, NULL);
+                break;
+            case AuditPolicy_User:
+                audit_get_cacheid_pg_audit_u(&sys_cacheid, NULL);
+                break;
+            default:
+                audit_get_cacheid_pg_audit_s(&sys_cacheid, NULL);
+                break;
+        }
+
+        l_keys = audit_policy_check_collect_keys(sys_cacheid);
+
+        foreach(lc, l_keys)
+        {
+            ObjectAddress * key = (ObjectAddress *) lfirst(lc);
+            int32 idx = 0;
+
+            for (idx = 0; idx < (int32)audit_get_stmt_map_size(); idx++)
+            {
+                AuditSQL action_id = audit_get_stmt_map_by_index(idx)->id;
+
+                if (!audit_policy_check_probe((AuditPolicyKind) kind, key, action_id, AuditMode_Fail))
+                    mismatches++;
+                if (!audit_policy_check_probe((AuditPolicyKind) kind, key, action_id, AuditMode_Success))
+                    mismatches++;
+                probes += 2;
+            }
+        }
+
+        list_free_deep(l_keys);
+    }
+
+    MemSet(nulls, 0, sizeof(nulls));
+    values[0] = Int64GetDatum(probes);
+    values[1] = Int64GetDatum(mismatches);
+
+    PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
+
 static void audit_hit_rebuild_hit_info(AuditHitInfo * hit_info,
                                        int hit_index,
                                        AuditStmtMap * hit_action,
@@ -8689,6 +9347,12 @@ static void audit_hit_match_in_catalog(AuditHitInfo * audit_hit,
 
     Assert(list_length(audit_hit->l_hit_index) == list_length(audit_hit->l_hit_action));
 
+    /* match against compiled policies when possible, see audit_hit_match_in_pg_audit_x */
+    if (enable_audit_policy_cache)
+    {
+        (void) audit_policy_cache_prepare();
+    }
+
     forboth(lc1, audit_hit->l_hit_index, lc2, audit_hit->l_hit_action)
     {
         int    action_index = lfirst_int(lc1);
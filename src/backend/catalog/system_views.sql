@@ -870,6 +870,19 @@ CREATE VIEW pg_stat_archiver AS
         s.stats_reset
     FROM pg_stat_get_archiver() s;
 
+CREATE VIEW pg_stat_cluster_xmin AS
+    SELECT
+        s.node_name,
+        s.local_xmin,
+        s.reported_xmin,
+        s.global_xmin,
+        s.xmin_lag,
+        s.last_report_time,
+        s.last_advance_time,
+        s.report_count,
+        s.advance_count
+    FROM pg_stat_get_cluster_xmin() s;
+
 CREATE VIEW pg_stat_bgwriter AS
     SELECT
         pg_stat_get_bgwriter_timed_checkpoints() AS checkpoints_timed,
@@ -46,6 +46,7 @@
 #include "pgstat.h"
 #include "postmaster/autovacuum.h"
 #include "statistics/extended_stats_internal.h"
+#include "statistics/partstats.h"
 #include "statistics/statistics.h"
 #include "storage/bufmgr.h"
 #include "storage/lmgr.h"
@@ -75,10 +76,16 @@
 #include "utils/snapmgr.h"
 #endif
 #ifdef __OPENTENBASE__
+#include "access/parallel.h"
+#include "catalog/catalog.h"
 #include "funcapi.h"
+#include "lib/binaryheap.h"
 #include "nodes/nodes.h"
 #include "utils/ruleutils.h"
 #include "nodes/pg_list.h"
+#include "optimizer/paths.h"
+#include "storage/shm_mq.h"
+#include "storage/spin.h"
 #endif
 #ifdef _MLS_
 #include "utils/relcrypt.h"
@@ -95,6 +102,55 @@ typedef struct AnlIndexData
     int            attr_cnt;
 } AnlIndexData;
 
+#ifdef __OPENTENBASE__
+/* Magic numbers for parallel sampling state sharing */
+#define PARALLEL_KEY_ANALYZE_SHARED        UINT64CONST(0xA000000000000001)
+#define PARALLEL_KEY_ANALYZE_QUEUE        UINT64CONST(0xA000000000000002)
+
+/* Size of the queue through which each worker sends its sampled rows */
+#define ANALYZE_PARALLEL_QUEUE_SIZE        65536
+
+/*
+ * State shared by the participants of a parallel sampling of a table.  The
+ * table is cut into nranges ranges of consecutive blocks, handed out one at
+ * a time.
+ */
+typedef struct AnalyzeSampleShared
+{
+    Oid            relid;
+    TransactionId OldestXmin;    /* cutoff xmin for HeapTupleSatisfiesVacuum */
+    bool        striptoast;        /* replace toasted fields by NULLs? */
+    int            targrows;        /* blocks to read and rows to keep */
+    BlockNumber nblocks;        /* number of blocks of the table */
+    int            nranges;
+
+    /* mutex protects remaining fields */
+    slock_t        mutex;
+    int            nextrange;        /* first range not handed out yet */
+    double        liverows;        /* live rows seen by the workers */
+    double        deadrows;        /* dead rows seen by the workers */
+    BlockNumber scannedblocks;    /* blocks read by the workers */
+} AnalyzeSampleShared;
+
+/* Header of a sampled row sent by a worker, followed by the tuple data */
+typedef struct AnalyzeSampleMsg
+{
+    ItemPointerData t_self;
+    double        weight;            /* rows the sampled row stands for */
+} AnalyzeSampleMsg;
+
+/* Rows kept by a weighted reservoir sampling, see weighted_sample_init */
+typedef struct WeightedSample
+{
+    HeapTuple  *rows;
+    int            targrows;
+    int            numrows;
+    double       *keys;            /* key of each row of rows[] */
+    binaryheap *heap;            /* indexes into rows[], smallest key first */
+    ReservoirStateData rstate;
+} WeightedSample;
+#endif
+
 
 /* Default statistics target (GUC parameter) */
 int            default_statistics_target = 100;
@@ -133,6 +189,12 @@ static VacAttrStats *examine_attribute(Relation onerel, int attnum,
 static int acquire_sample_rows(Relation onerel, int elevel,
                     HeapTuple *rows, int targrows,
                     double *totalrows, double *totaldeadrows);
+static int acquire_sample_rows_range(Relation onerel, BlockNumber startblock,
+                          BlockNumber nblocks, int targblocks,
+                          TransactionId OldestXmin, bool striptoast,
+                          HeapTuple *rows, int targrows,
+                          double *collected, double *liverows,
+                          double *deadrows, BlockNumber *scannedblocks);
 static int    compare_rows(const void *a, const void *b);
 static int acquire_inherited_sample_rows(Relation onerel, int elevel,
                               HeapTuple *rows, int targrows,
@@ -165,6 +227,26 @@ static int acquire_coordinator_sample_rows(Relation onerel, int elevel,
 												HeapTuple *rows, int targrows,
 												double *totalrows, double *totaldeadrows,
 												int64 *totalpages, int64 *visiblepages);
+static void weighted_sample_init(WeightedSample *ws, HeapTuple *rows,
+					 int targrows);
+static void weighted_sample_add(WeightedSample *ws, HeapTuple tuple,
+					double weight);
+static int	weighted_sample_end(WeightedSample *ws);
+static int	analyze_parallel_workers(Relation onerel, BlockNumber totalblocks,
+						 int targrows);
+static int acquire_parallel_sample_rows(Relation onerel,
+							 BlockNumber totalblocks,
+							 TransactionId OldestXmin, bool striptoast,
+							 HeapTuple *rows, int targrows, int nworkers,
+							 double *liverows, double *deadrows,
+							 BlockNumber *scannedblocks);
+static void analyze_parallel_sample(AnalyzeSampleShared *shared,
+						Relation onerel, WeightedSample *ws,
+						shm_mq_handle *mqh);
+static void analyze_parallel_send(shm_mq_handle *mqh, HeapTuple tuple,
+					  double weight);
+static bool analyze_parallel_receive(shm_mq_handle *mqh, HeapTuple tuple,
+						 double *weight);
 
 #endif
 
@@ -203,6 +285,14 @@ analyze_rel(Oid					 relid,
 			foreach (lc, childs)
 			{
 				child = lfirst_oid(lc);
+
+				/*
+				 * The statistics of the table are merged from those of its
+				 * partitions, only those that changed need sampling again.
+				 */
+				if (IS_PGXC_DATANODE && !part_stats_stale(child))
+					continue;
+
 				analyze_rel(child,
 							relation,
 							options,
@@ -463,6 +553,7 @@ do_analyze_rel(Relation				 onerel,
     int            save_sec_context;
     int            save_nestlevel;
 	bool		iscoordinator = false;
+	bool		merged;
 	int64		coordpages = 0;
 	int64		coordvisiblepages = 0;
 
@@ -700,7 +791,33 @@ do_analyze_rel(Relation				 onerel,
      */
     rows = (HeapTuple *) palloc(targrows * sizeof(HeapTuple));
 #ifdef __OPENTENBASE__
-	if (enable_sampling_analyze && iscoordinator)
+	/*
+	 * The statistics of an interval partitioned table are merged from those
+	 * of its partitions rather than sampled, unless the sample is needed for
+	 * expression indexes or extended statistics too.
+	 */
+	merged = false;
+	if (IS_PGXC_DATANODE && !inh && RELATION_IS_INTERVAL(onerel) &&
+		RelationGetStatExtList(onerel) == NIL)
+	{
+		merged = true;
+		for (ind = 0; ind < nindexes; ind++)
+		{
+			if (indexdata[ind].attr_cnt > 0)
+				merged = false;
+		}
+		if (merged)
+			merged = merge_part_stats(onerel, attr_cnt, vacattrstats,
+									  &totalrows, &totaldeadrows);
+	}
+
+	if (merged)
+	{
+		numrows = 0;
+		update_attstats(RelationGetRelid(onerel), inh,
+						attr_cnt, vacattrstats);
+	}
+	else if (enable_sampling_analyze && iscoordinator)
 	{
 		numrows = acquire_coordinator_sample_rows(onerel, elevel,
 												rows, targrows,
@@ -752,6 +869,11 @@ do_analyze_rel(Relation				 onerel,
                                      std_fetch_func,
                                      numrows,
                                      totalrows);
+#ifdef __OPENTENBASE__
+            /* what the statistics of the interval table are merged with */
+            if (IS_PGXC_DATANODE && !inh && RELATION_IS_CHILD(onerel))
+                build_part_ndv_sketch(stats, std_fetch_func, numrows);
+#endif
 #ifdef _MLS_
             if (stats->tupDesc->attrs_ext && IS_PGXC_DATANODE)
             {
@@ -1250,16 +1372,18 @@ static int
 acquire_sample_rows(Relation onerel, int elevel,
                     HeapTuple *rows, int targrows,
                     double *totalrows, double *totaldeadrows)
-{// #lizard forgives
-    int            numrows = 0;    /* # rows now in reservoir */
+{
+    int            numrows;
     double        samplerows = 0; /* total # rows collected */
     double        liverows = 0;    /* # live rows seen */
     double        deadrows = 0;    /* # dead rows seen */
-    double        rowstoskip = -1;    /* -1 means not set yet */
+    BlockNumber scannedblocks = 0;
     BlockNumber totalblocks;
     TransactionId OldestXmin;
-    BlockSamplerData bs;
-    ReservoirStateData rstate;
+    bool        striptoast;
+#ifdef __OPENTENBASE__
+    int            nworkers;
+#endif
 
     Assert(targrows > 0);
 
@@ -1268,15 +1392,105 @@ acquire_sample_rows(Relation onerel, int elevel,
     /* Need a cutoff xmin for HeapTupleSatisfiesVacuum */
     OldestXmin = GetOldestXmin(onerel, PROCARRAY_FLAGS_VACUUM);
 
+    /*
+     * If connection is from Coordinator on datanodes, we discard TOAST fields
+     * in sample, which will lighten the load of memory usage on coordinator.
+     */
+    striptoast = IS_PGXC_DATANODE && IsConnFromCoord();
+
+#ifdef __OPENTENBASE__
+    /* Big tables have their blocks sampled by parallel workers */
+    nworkers = analyze_parallel_workers(onerel, totalblocks, targrows);
+    if (nworkers > 0)
+        numrows = acquire_parallel_sample_rows(onerel, totalblocks,
+                                               OldestXmin, striptoast,
+                                               rows, targrows, nworkers,
+                                               &liverows, &deadrows,
+                                               &scannedblocks);
+    else
+#endif
+    {
+        numrows = acquire_sample_rows_range(onerel, 0, totalblocks, targrows,
+                                            OldestXmin, striptoast,
+                                            rows, targrows, &samplerows,
+                                            &liverows, &deadrows,
+                                            &scannedblocks);
+
+        /*
+         * If we didn't find as many tuples as we wanted then we're done. No
+         * sort is needed, since they're already in order.
+         *
+         * Otherwise we need to sort the collected tuples by position
+         * (itempointer). It's not worth worrying about corner cases where
+         * the tuples are already sorted.
+         */
+        if (numrows == targrows)
+            qsort((void *) rows, numrows, sizeof(HeapTuple), compare_rows);
+    }
+
+    /*
+     * Estimate total numbers of rows in relation.  For live rows, use
+     * vac_estimate_reltuples; for dead rows, we have no source of old
+     * information, so we have to assume the density is the same in unseen
+     * pages as in the pages we scanned.
+     */
+    *totalrows = vac_estimate_reltuples(onerel, true,
+                                        totalblocks,
+                                        scannedblocks,
+                                        liverows);
+    if (scannedblocks > 0)
+        *totaldeadrows = floor((deadrows / scannedblocks) * totalblocks + 0.5);
+    else
+        *totaldeadrows = 0.0;
+
+    /*
+     * Emit some interesting relation info
+     */
+    ereport(elevel,
+            (errmsg("\"%s\": scanned %d of %u pages, "
+                    "containing %.0f live rows and %.0f dead rows; "
+                    "%d rows in sample, %.0f estimated total rows",
+                    RelationGetRelationName(onerel),
+                    scannedblocks, totalblocks,
+                    liverows, deadrows,
+                    numrows, *totalrows)));
+
+    return numrows;
+}
+
+/*
+ * acquire_sample_rows_range -- sample targblocks random blocks of the
+ * nblocks blocks starting at startblock, and up to targrows rows of them,
+ * into rows[]; see acquire_sample_rows.
+ *
+ * The numbers of rows collected, of live and dead rows seen and of blocks
+ * scanned are added to *collected, *liverows, *deadrows and *scannedblocks.
+ * The rows are not sorted.  If striptoast, the toasted fields of the sampled
+ * rows are replaced by NULLs.
+ */
+static int
+acquire_sample_rows_range(Relation onerel, BlockNumber startblock,
+                          BlockNumber nblocks, int targblocks,
+                          TransactionId OldestXmin, bool striptoast,
+                          HeapTuple *rows, int targrows,
+                          double *collected, double *liverows,
+                          double *deadrows, BlockNumber *scannedblocks)
+{// #lizard forgives
+    int            numrows = 0;    /* # rows now in reservoir */
+    double        samplerows = 0; /* total # rows collected */
+    double        rowstoskip = -1;    /* -1 means not set yet */
+    BlockSamplerData bs;
+    ReservoirStateData rstate;
+
     /* Prepare for sampling block numbers */
-    BlockSampler_Init(&bs, totalblocks, targrows, random());
+    BlockSampler_Init(&bs, nblocks, targblocks, random());
     /* Prepare for sampling rows */
     reservoir_init_selection_state(&rstate, targrows);
 
     /* Outer loop over blocks to sample */
     while (BlockSampler_HasMore(&bs))
     {
-        BlockNumber targblock = BlockSampler_Next(&bs);
+        BlockNumber targblock = startblock + BlockSampler_Next(&bs);
         Buffer        targbuffer;
         Page        targpage;
         OffsetNumber targoffset,
@@ -1318,7 +1532,7 @@ acquire_sample_rows(Relation onerel, int elevel,
             if (!ItemIdIsNormal(itemid))
             {
                 if (ItemIdIsDead(itemid))
-                    deadrows += 1;
+                    *deadrows += 1;
                 continue;
             }
 
@@ -1334,13 +1548,13 @@ acquire_sample_rows(Relation onerel, int elevel,
             {
                 case HEAPTUPLE_LIVE:
                     sample_it = true;
-                    liverows += 1;
+                    *liverows += 1;
                     break;
 
                 case HEAPTUPLE_DEAD:
                 case HEAPTUPLE_RECENTLY_DEAD:
                     /* Count dead and recently-dead rows */
-                    deadrows += 1;
+                    *deadrows += 1;
                     break;
 
                 case HEAPTUPLE_INSERT_IN_PROGRESS:
@@ -1367,7 +1581,7 @@ acquire_sample_rows(Relation onerel, int elevel,
                     if (TransactionIdIsCurrentTransactionId(HeapTupleHeaderGetXmin(targtuple.t_data)))
                     {
                         sample_it = true;
-                        liverows += 1;
+                        *liverows += 1;
                     }
                     break;
 
@@ -1385,9 +1599,9 @@ acquire_sample_rows(Relation onerel, int elevel,
                      * both inserted and deleted in our xact.)
                      */
                     if (TransactionIdIsCurrentTransactionId(HeapTupleHeaderGetUpdateXid(targtuple.t_data)))
-                        deadrows += 1;
+                        *deadrows += 1;
                     else
-                        liverows += 1;
+                        *liverows += 1;
                     break;
 
                 default:
@@ -1401,7 +1615,7 @@ acquire_sample_rows(Relation onerel, int elevel,
                  * If connection is from Coordinator on datanodes, we discard TOAST fields in sample,
                  * which will lighten the load of memory usage on coordinator.
                  */
-			    if (IS_PGXC_DATANODE && IsConnFromCoord())
+			    if (striptoast)
 			    {
 			        Datum       *values;
 			        bool        *nulls;
@@ -1499,47 +1713,456 @@ acquire_sample_rows(Relation onerel, int elevel,
         UnlockReleaseBuffer(targbuffer);
     }
 
-    /*
-     * If we didn't find as many tuples as we wanted then we're done. No sort
-     * is needed, since they're already in order.
-     *
-     * Otherwise we need to sort the collected tuples by position
-     * (itempointer). It's not worth worrying about corner cases where the
-     * tuples are already sorted.
-     */
-    if (numrows == targrows)
-        qsort((void *) rows, numrows, sizeof(HeapTuple), compare_rows);
+    *collected += samplerows;
+    *scannedblocks += bs.m;
 
-    /*
-     * Estimate total numbers of rows in relation.  For live rows, use
-     * vac_estimate_reltuples; for dead rows, we have no source of old
-     * information, so we have to assume the density is the same in unseen
-     * pages as in the pages we scanned.
-     */
-    *totalrows = vac_estimate_reltuples(onerel, true,
-                                        totalblocks,
-                                        bs.m,
-                                        liverows);
-    if (bs.m > 0)
-        *totaldeadrows = floor((deadrows / bs.m) * totalblocks + 0.5);
-    else
-        *totaldeadrows = 0.0;
+    return numrows;
+}
 
-    /*
-     * Emit some interesting relation info
-     */
-    ereport(elevel,
-            (errmsg("\"%s\": scanned %d of %u pages, "
-                    "containing %.0f live rows and %.0f dead rows; "
-                    "%d rows in sample, %.0f estimated total rows",
-                    RelationGetRelationName(onerel),
-                    bs.m, totalblocks,
-                    liverows, deadrows,
-                    numrows, *totalrows)));
+#ifdef __OPENTENBASE__
+/*
+ * Comparator of the heap of a WeightedSample: the row with the smallest key
+ * is the first to be replaced.
+ */
+static int
+compare_sample_keys(Datum a, Datum b, void *arg)
+{
+    double       *keys = (double *) arg;
+    double        ka = keys[DatumGetInt32(a)];
+    double        kb = keys[DatumGetInt32(b)];
+
+    if (ka > kb)
+        return -1;
+    if (ka < kb)
+        return 1;
+    return 0;
+}
+
+/*
+ * weighted_sample_init -- prepare to keep up to targrows rows in rows[] out
+ * of rows added one at a time, each with a weight.
+ *
+ * This is a weighted reservoir sampling (Efraimidis and Spirakis): each row
+ * gets the key u^(1/weight), with u uniform in (0, 1), and the targrows rows
+ * with the largest keys are kept.  Keys are compared as log(u) / weight for
+ * precision.
+ */
+static void
+weighted_sample_init(WeightedSample *ws, HeapTuple *rows, int targrows)
+{
+    ws->rows = rows;
+    ws->targrows = targrows;
+    ws->numrows = 0;
+    ws->keys = (double *) palloc(targrows * sizeof(double));
+    ws->heap = binaryheap_allocate(targrows, compare_sample_keys, ws->keys);
+    /* only the random state is used */
+    reservoir_init_selection_state(&ws->rstate, targrows);
+}
+
+/*
+ * weighted_sample_add -- offer a row standing for weight rows; a copy of it
+ * is kept if it makes it into the sample.
+ */
+static void
+weighted_sample_add(WeightedSample *ws, HeapTuple tuple, double weight)
+{
+    double        key;
+    int            k;
+
+    if (weight <= 0)
+        weight = 1;
+
+    /* sampler_random_fract never returns 0 */
+    key = log(sampler_random_fract(ws->rstate.randstate)) / weight;
+
+    if (ws->numrows < ws->targrows)
+    {
+        k = ws->numrows++;
+        ws->rows[k] = heap_copytuple(tuple);
+        ws->keys[k] = key;
+        binaryheap_add(ws->heap, Int32GetDatum(k));
+    }
+    else if (key > ws->keys[DatumGetInt32(binaryheap_first(ws->heap))])
+    {
+        /* replace the row of smallest key */
+        k = DatumGetInt32(binaryheap_first(ws->heap));
+        Assert(k >= 0 && k < ws->targrows);
+        heap_freetuple(ws->rows[k]);
+        ws->rows[k] = heap_copytuple(tuple);
+        ws->keys[k] = key;
+        binaryheap_replace_first(ws->heap, Int32GetDatum(k));
+    }
+}
+
+/*
+ * weighted_sample_end -- release the state of a WeightedSample, and return
+ * the number of rows kept in its rows[].
+ */
+static int
+weighted_sample_end(WeightedSample *ws)
+{
+    binaryheap_free(ws->heap);
+    pfree(ws->keys);
+
+    return ws->numrows;
+}
+
+/*
+ * analyze_parallel_workers -- number of parallel workers to sample the
+ * blocks of a table with, 0 to sample it alone.
+ *
+ * The number of workers grows with the table size like for a parallel
+ * seqscan, honors the table's parallel_workers option, and is capped by
+ * max_parallel_maintenance_workers.
+ */
+static int
+analyze_parallel_workers(Relation onerel, BlockNumber totalblocks,
+                         int targrows)
+{
+    int            nworkers;
+
+    if (max_parallel_maintenance_workers <= 0 ||
+        IsBootstrapProcessingMode() ||
+        IsInParallelMode() ||
+        !ActiveSnapshotSet() ||
+        RelationUsesLocalBuffers(onerel) ||
+        IsSystemRelation(onerel))
+        return 0;
+
+    nworkers = RelationGetParallelWorkers(onerel, -1);
+    if (nworkers < 0)
+    {
+        BlockNumber threshold = Max(min_parallel_table_scan_size, 1);
+
+        if (totalblocks < threshold)
+            return 0;
+
+        nworkers = 1;
+        while (totalblocks >= threshold * 3 &&
+               nworkers < max_parallel_maintenance_workers)
+        {
+            nworkers++;
+            threshold *= 3;
+            if (threshold > MaxBlockNumber / 3)
+                break;
+        }
+    }
+
+    nworkers = Min(nworkers, max_parallel_maintenance_workers);
+
+    /* every participant's range must have blocks to sample */
+    while (nworkers > 0 &&
+           (BlockNumber) (nworkers + 1) > Min(totalblocks,
+                                              (BlockNumber) targrows))
+        nworkers--;
+
+    return nworkers;
+}
+
+/*
+ * acquire_parallel_sample_rows -- acquire_sample_rows with the help of
+ * nworkers parallel workers.
+ *
+ * The table is cut into a range of consecutive blocks per participant, and
+ * the leader and the workers each take one; the leader also takes those of
+ * workers that fail to start.  Each range has its share of the targrows
+ * blocks to read sampled like a table of its own, so that the blocks read
+ * are still spread evenly over the whole table.  A range may yield more
+ * rows than it keeps; each row it keeps then stands for several rows of
+ * the sampled blocks.  The leader merges the rows of all the ranges with a
+ * weighted reservoir sampling, which gives every row of the sampled blocks
+ * the same chance to be kept, as stage two of acquire_sample_rows does.
+ *
+ * The rows are returned sorted by physical position.
+ */
+static int
+acquire_parallel_sample_rows(Relation onerel, BlockNumber totalblocks,
+                             TransactionId OldestXmin, bool striptoast,
+                             HeapTuple *rows, int targrows, int nworkers,
+                             double *liverows, double *deadrows,
+                             BlockNumber *scannedblocks)
+{
+    ParallelContext *pcxt;
+    AnalyzeSampleShared *shared;
+    char       *mqspace;
+    shm_mq_handle **queues;
+    WeightedSample ws;
+    HeapTupleData tuple;
+    double        weight;
+    int            numrows;
+    int            i;
+
+    Assert(nworkers > 0);
+
+    EnterParallelMode();
+    pcxt = CreateParallelContext("postgres", "analyze_parallel_sample_main",
+                                 nworkers);
+
+    /* Estimate space for the shared state and the tuple queues. */
+    shm_toc_estimate_chunk(&pcxt->estimator, sizeof(AnalyzeSampleShared));
+    shm_toc_estimate_chunk(&pcxt->estimator,
+                           mul_size(ANALYZE_PARALLEL_QUEUE_SIZE,
+                                    pcxt->nworkers));
+    shm_toc_estimate_keys(&pcxt->estimator, 2);
+
+    InitializeParallelDSM(pcxt);
+
+    shared = (AnalyzeSampleShared *)
+        shm_toc_allocate(pcxt->toc, sizeof(AnalyzeSampleShared));
+    shared->relid = RelationGetRelid(onerel);
+    shared->OldestXmin = OldestXmin;
+    shared->striptoast = striptoast;
+    shared->targrows = targrows;
+    shared->nblocks = totalblocks;
+    shared->nranges = nworkers + 1;
+    SpinLockInit(&shared->mutex);
+    shared->nextrange = 0;
+    shared->liverows = 0;
+    shared->deadrows = 0;
+    shared->scannedblocks = 0;
+    shm_toc_insert(pcxt->toc, PARALLEL_KEY_ANALYZE_SHARED, shared);
+
+    /* Create the tuple queues, and become the receiver for each. */
+    mqspace = shm_toc_allocate(pcxt->toc,
+                               mul_size(ANALYZE_PARALLEL_QUEUE_SIZE,
+                                        pcxt->nworkers));
+    queues = (shm_mq_handle **)
+        palloc(pcxt->nworkers * sizeof(shm_mq_handle *));
+    for (i = 0; i < pcxt->nworkers; i++)
+    {
+        shm_mq       *mq;
+
+        mq = shm_mq_create(mqspace + ((Size) i) * ANALYZE_PARALLEL_QUEUE_SIZE,
+                           (Size) ANALYZE_PARALLEL_QUEUE_SIZE);
+        shm_mq_set_receiver(mq, MyProc);
+        queues[i] = shm_mq_attach(mq, pcxt->seg, NULL);
+    }
+    shm_toc_insert(pcxt->toc, PARALLEL_KEY_ANALYZE_QUEUE, mqspace);
+
+    LaunchParallelWorkers(pcxt);
+    for (i = 0; i < pcxt->nworkers_launched; i++)
+        shm_mq_set_handle(queues[i], pcxt->worker[i].bgwhandle);
+
+    /* Take part in the sampling, until every range has been handed out. */
+    weighted_sample_init(&ws, rows, targrows);
+    analyze_parallel_sample(shared, onerel, &ws, NULL);
+
+    /* Merge the rows the workers kept with the leader's. */
+    for (i = 0; i < pcxt->nworkers_launched; i++)
+    {
+        while (analyze_parallel_receive(queues[i], &tuple, &weight))
+        {
+            tuple.t_tableOid = RelationGetRelid(onerel);
+            weighted_sample_add(&ws, &tuple, weight);
+        }
+    }
+    numrows = weighted_sample_end(&ws);
+
+    for (i = 0; i < pcxt->nworkers_launched; i++)
+        shm_mq_detach(shm_mq_get_queue(queues[i]));
+    pfree(queues);
+
+    WaitForParallelWorkersToFinish(pcxt);
+
+    /* Add up what everyone scanned. */
+    *liverows += shared->liverows;
+    *deadrows += shared->deadrows;
+    *scannedblocks += shared->scannedblocks;
+
+    DestroyParallelContext(pcxt);
+    ExitParallelMode();
+
+    qsort((void *) rows, numrows, sizeof(HeapTuple), compare_rows);
 
     return numrows;
 }
 
+/*
+ * analyze_parallel_sample_main -- entry point of the workers of a parallel
+ * sampling of a table.
+ */
+void
+analyze_parallel_sample_main(dsm_segment *seg, shm_toc *toc)
+{
+    AnalyzeSampleShared *shared;
+    char       *mqspace;
+    shm_mq       *mq;
+    shm_mq_handle *mqh;
+    Relation    onerel;
+
+    shared = shm_toc_lookup(toc, PARALLEL_KEY_ANALYZE_SHARED, false);
+
+    /* Become the sender of our tuple queue. */
+    mqspace = shm_toc_lookup(toc, PARALLEL_KEY_ANALYZE_QUEUE, false);
+    mq = (shm_mq *) (mqspace +
+                     ParallelWorkerNumber * ANALYZE_PARALLEL_QUEUE_SIZE);
+    shm_mq_set_sender(mq, MyProc);
+    mqh = shm_mq_attach(mq, seg, NULL);
+
+    vac_strategy = GetAccessStrategy(BAS_VACUUM);
+
+    /* The leader holds a stronger lock, shared with us by group locking. */
+    onerel = heap_open(shared->relid, AccessShareLock);
+
+    analyze_parallel_sample(shared, onerel, NULL, mqh);
+
+    /* mark the end of our rows */
+    (void) shm_mq_send(mqh, 0, NULL, false);
+    shm_mq_detach(mq);
+
+    heap_close(onerel, AccessShareLock);
+}
+
+/*
+ * analyze_parallel_sample -- sample the ranges handed out to this
+ * participant, until there are no more.
+ *
+ * The leader passes its WeightedSample, into which the rows kept from each
+ * range are merged; a worker passes its tuple queue, through which they are
+ * sent to the leader.
+ */
+static void
+analyze_parallel_sample(AnalyzeSampleShared *shared, Relation onerel,
+                        WeightedSample *ws, shm_mq_handle *mqh)
+{
+    HeapTuple  *rows;
+    double        liverows = 0;
+    double        deadrows = 0;
+    BlockNumber scannedblocks = 0;
+
+    rows = (HeapTuple *) palloc(shared->targrows * sizeof(HeapTuple));
+
+    for (;;)
+    {
+        int            range;
+        BlockNumber startblock;
+        BlockNumber endblock;
+        int            targblocks;
+        double        collected = 0;
+        double        weight;
+        int            numrows;
+        int            i;
+
+        SpinLockAcquire(&shared->mutex);
+        range = shared->nextrange;
+        if (range < shared->nranges)
+            shared->nextrange++;
+        SpinLockRelease(&shared->mutex);
+
+        if (range >= shared->nranges)
+            break;
+
+        startblock = (uint64) shared->nblocks * range / shared->nranges;
+        endblock = (uint64) shared->nblocks * (range + 1) / shared->nranges;
+        targblocks = (uint64) shared->targrows * (range + 1) / shared->nranges -
+            (uint64) shared->targrows * range / shared->nranges;
+
+        numrows = acquire_sample_rows_range(onerel, startblock,
+                                            endblock - startblock,
+                                            targblocks,
+                                            shared->OldestXmin,
+                                            shared->striptoast,
+                                            rows, shared->targrows,
+                                            &collected, &liverows,
+                                            &deadrows, &scannedblocks);
+        if (numrows == 0)
+            continue;
+
+        /* rows of the sampled blocks each kept row stands for */
+        weight = collected / numrows;
+
+        for (i = 0; i < numrows; i++)
+        {
+            if (ws != NULL)
+                weighted_sample_add(ws, rows[i], weight);
+            else
+                analyze_parallel_send(mqh, rows[i], weight);
+            heap_freetuple(rows[i]);
+        }
+    }
+
+    pfree(rows);
+
+    SpinLockAcquire(&shared->mutex);
+    shared->liverows += liverows;
+    shared->deadrows += deadrows;
+    shared->scannedblocks += scannedblocks;
+    SpinLockRelease(&shared->mutex);
+}
+
+/*
+ * Send a sampled row and its weight to the leader.
+ */
+static void
+analyze_parallel_send(shm_mq_handle *mqh, HeapTuple tuple, double weight)
+{
+    AnalyzeSampleMsg msg;
+    shm_mq_iovec iov[2];
+
+    msg.t_self = tuple->t_self;
+    msg.weight = weight;
+
+    iov[0].data = (char *) &msg;
+    iov[0].len = sizeof(AnalyzeSampleMsg);
+    iov[1].data = (char *) tuple->t_data;
+    iov[1].len = tuple->t_len;
+
+    /* if the leader went away, it is already reporting an error */
+    (void) shm_mq_sendv(mqh, iov, 2, false);
+}
+
+/*
+ * Receive the next row a worker sent, and its weight, into *tuple and
+ * *weight.  Returns false once the worker has marked the end of its rows.
+ * The tuple is only valid until the next call.
+ */
+static bool
+analyze_parallel_receive(shm_mq_handle *mqh, HeapTuple tuple, double *weight)
+{
+    shm_mq_result res;
+    Size        nbytes;
+    void       *data;
+    AnalyzeSampleMsg msg;
+
+    res = shm_mq_receive(mqh, &nbytes, &data, false);
+    if (res == SHM_MQ_DETACHED)
+    {
+        /* a worker that never started has nothing to send */
+        if (shm_mq_get_sender(shm_mq_get_queue(mqh)) == NULL)
+            return false;
+
+        /*
+         * A worker that gave up before sending all its rows has reported
+         * why; rethrow its error.
+         */
+        HandleParallelMessages();
+        ereport(ERROR,
+                (errcode(ERRCODE_INTERNAL_ERROR),
+                 errmsg("lost connection to parallel worker")));
+    }
+
+    Assert(res == SHM_MQ_SUCCESS);
+
+    if (nbytes == 0)
+        return false;
+
+    Assert(nbytes > sizeof(AnalyzeSampleMsg));
+    memcpy(&msg, data, sizeof(AnalyzeSampleMsg));
+
+    tuple->t_len = nbytes - sizeof(AnalyzeSampleMsg);
+    tuple->t_self = msg.t_self;
+    tuple->t_tableOid = InvalidOid;
+#ifdef PGXC
+    tuple->t_xc_node_id = 0;
+#endif
+    tuple->t_data = (HeapTupleHeader) ((char *) data +
+                                       sizeof(AnalyzeSampleMsg));
+    *weight = msg.weight;
+
+    return true;
+}
+#endif
+
 /*
  * qsort comparator for sorting rows[] array
  */
@@ -4979,7 +5602,7 @@ get_rel_pages_visiblepages(Relation onerel,
 	}
 }
 
-#define SAMPLE_ATTR_NUM 6
+#define SAMPLE_ATTR_NUM 7
 
 void ExecSample(SampleStmt *stmt, DestReceiver *dest)
 {
@@ -5114,10 +5737,13 @@ void ExecSample(SampleStmt *stmt, DestReceiver *dest)
 					   INT8OID, -1, 0);
 	TupleDescInitEntry(tupdesc, (AttrNumber) 6, "rows",
 					   onerel->rd_rel->reltype, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 7, "weight",
+					   FLOAT8OID, -1, 0);
 
 	tstate = begin_tup_output_tupdesc(dest, tupdesc);
 	MemSet(nulls, 0, sizeof(nulls));
 	nulls[5] = true;
+	nulls[6] = true;
 	values[0] = Float8GetDatum(context->samplenum);
 	values[1] = Float8GetDatum(context->totalnum);
 	values[2] = Float8GetDatum(context->deadnum);
@@ -5136,7 +5762,10 @@ void ExecSample(SampleStmt *stmt, DestReceiver *dest)
 			nulls[3] = true;
 			nulls[4] = true;
 			nulls[5] = false;
+			nulls[6] = false;
 			values[5] = heap_copy_tuple_as_datum(context->rows[index], rowdesc);
+			/* live rows each sampled row stands for */
+			values[6] = Float8GetDatum(context->totalnum / context->samplenum);
 			do_tup_output(tstate, values, nulls);
 		}
 
@@ -5152,6 +5781,16 @@ void ExecSample(SampleStmt *stmt, DestReceiver *dest)
 
 }
 
+/*
+ * Sample the rows of a distributed relation: every datanode holding it runs
+ * SAMPLE at the same time, and streams back its own sample of up to targrows
+ * rows, each row along with the number of live rows of the node it stands
+ * for.  The samples are merged here as they arrive, once.
+ *
+ * Datanodes holding more rows must contribute more sample rows, or the
+ * statistics would describe the small nodes as much as the large ones, so
+ * the merge is a weighted reservoir sampling, see weighted_sample_init.
+ */
 static int 
 acquire_coordinator_sample_rows(Relation onerel, int elevel,
 												HeapTuple *rows, int targrows,
@@ -5175,8 +5814,7 @@ acquire_coordinator_sample_rows(Relation onerel, int elevel,
 	double			deadnum = 0;
 	int				numrows = 0;
 	double			samplerows = 0;
-	double			rowstoskip = -1;	/* -1 means not set yet */
-	ReservoirStateData rstate;
+	WeightedSample	ws;
 	int64			totalpagesnum = 0;
 	int64			visiblepagesnum = 0;
 
@@ -5234,6 +5872,9 @@ acquire_coordinator_sample_rows(Relation onerel, int elevel,
 	dummy = makeVar(1, 5, onerel->rd_rel->reltype, 0, InvalidOid, 0);
 	step->scan.plan.targetlist = lappend(step->scan.plan.targetlist,
 										 makeTargetEntry((Expr *) dummy, 5, "rows", false));
+	dummy = makeVar(1, 6, FLOAT8OID, 0, InvalidOid, 0);
+	step->scan.plan.targetlist = lappend(step->scan.plan.targetlist,
+										 makeTargetEntry((Expr *) dummy, 6, "weight", false));
 	/*
 	 * ANALYZE has known it's result slot desc, should
 	 * ignore received one to avoid duplicate name issue
@@ -5248,7 +5889,7 @@ acquire_coordinator_sample_rows(Relation onerel, int elevel,
 	MemoryContextSwitchTo(oldcontext);
 
 	/* Prepare for sampling rows */
-	reservoir_init_selection_state(&rstate, targrows);
+	weighted_sample_init(&ws, rows, targrows);
 
 	result = ExecRemoteQuery((PlanState *) node);
 	
@@ -5283,53 +5924,20 @@ acquire_coordinator_sample_rows(Relation onerel, int elevel,
 
 		if (result->tts_isnull[5] == false)
 		{
-			if (numrows < targrows)
-			{
-				HeapTupleHeader td = DatumGetHeapTupleHeader(result->tts_values[5]);
-				HeapTupleData tmptup;
+			HeapTupleHeader td = DatumGetHeapTupleHeader(result->tts_values[5]);
+			HeapTupleData tmptup;
+			double		weight = 1;
 
-				/* Build a temporary HeapTuple control structure */
-				tmptup.t_len = HeapTupleHeaderGetDatumLength(td);
-				ItemPointerSetInvalid(&(tmptup.t_self));
-				tmptup.t_tableOid = InvalidOid;
-				tmptup.t_data = td;
+			if (result->tts_isnull[6] == false)
+				weight = DatumGetFloat8(result->tts_values[6]);
 
-				/* Build a copy and return it */
-				rows[numrows++] = heap_copytuple(&tmptup);
-			}
-			else
-			{
-				/*
-					* t in Vitter's paper is the number of records already
-					* processed.  If we need to compute a new S value, we
-					* must use the not-yet-incremented value of samplerows as
-					* t.
-					*/
-				if (rowstoskip < 0)
-					rowstoskip = reservoir_get_next_S(&rstate, samplerows, targrows);
-
-				if (rowstoskip <= 0)
-				{
-					/*
-						* Found a suitable tuple, so save it, replacing one
-						* old tuple at random
-						*/
-					int			k = (int) (targrows * sampler_random_fract(rstate.randstate));
-					HeapTupleHeader td = DatumGetHeapTupleHeader(result->tts_values[5]);
-					HeapTupleData tmptup;
-
-					/* Build a temporary HeapTuple control structure */
-					tmptup.t_len = HeapTupleHeaderGetDatumLength(td);
-					ItemPointerSetInvalid(&(tmptup.t_self));
-					tmptup.t_tableOid = InvalidOid;
-					tmptup.t_data = td;
-					Assert(k >= 0 && k < targrows);
-					heap_freetuple(rows[k]);
-					rows[k] = heap_copytuple(&tmptup);
-				}
+			/* Build a temporary HeapTuple control structure */
+			tmptup.t_len = HeapTupleHeaderGetDatumLength(td);
+			ItemPointerSetInvalid(&(tmptup.t_self));
+			tmptup.t_tableOid = InvalidOid;
+			tmptup.t_data = td;
 
-				rowstoskip -= 1;
-			}
+			weighted_sample_add(&ws, &tmptup, weight);
 			samplerows += 1;
 		}
 		
@@ -5337,6 +5945,11 @@ acquire_coordinator_sample_rows(Relation onerel, int elevel,
 	}
 
 	ExecEndRemoteQuery(node);
+
+	numrows = weighted_sample_end(&ws);
+
+	elog(elevel, "\"%s\": kept %d of %.0f rows sampled by datanodes",
+		 relname, numrows, samplerows);
 	
 	*totalrows = totalnum;
 	*totaldeadrows = deadnum;
@@ -2466,7 +2466,8 @@ CopyTo(CopyState cstate)
             
             for(i = 0; i < cstate->nparts; i++)
             {
-                scandesc = heap_beginscan(cstate->partrels[i], GetActiveSnapshot(), 0, NULL);
+                scandesc = heap_beginscan_shards(cstate->partrels[i], GetActiveSnapshot(), 0, NULL,
+                                                 cstate->shard_array);
                 while ((tuple = heap_getnext(scandesc, ForwardScanDirection)) != NULL)
                 {
                     bool isdeformed = false;
@@ -2598,7 +2599,8 @@ CopyTo(CopyState cstate)
         {
 #endif    
 
-        scandesc = heap_beginscan(cstate->rel, GetActiveSnapshot(), 0, NULL);
+        scandesc = heap_beginscan_shards(cstate->rel, GetActiveSnapshot(), 0, NULL,
+                                         cstate->shard_array);
 
         processed = 0;
         while ((tuple = heap_getnext(scandesc, ForwardScanDirection)) != NULL)
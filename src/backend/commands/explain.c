@@ -25,6 +25,7 @@
 #include "commands/prepare.h"
 #include "executor/nodeHash.h"
 #include "foreign/fdwapi.h"
+#include "jit/jit.h"
 #include "nodes/extensible.h"
 #include "nodes/nodeFuncs.h"
 #include "optimizer/clauses.h"
@@ -94,6 +95,8 @@ static void show_upper_qual(List *qual, const char *qlabel,
                 ExplainState *es);
 static void show_sort_keys(SortState *sortstate, List *ancestors,
                ExplainState *es);
+static void show_incremental_sort_keys(IncrementalSortState *incrsortstate,
+                           List *ancestors, ExplainState *es);
 static void show_simple_sort_keys(RemoteSubplanState *remotestate,
                List *ancestors, ExplainState *es);
 static void show_merge_append_keys(MergeAppendState *mstate, List *ancestors,
@@ -117,6 +120,8 @@ static void show_sortorder_options(StringInfo buf, Node *sortexpr,
 static void show_tablesample(TableSampleClause *tsc, PlanState *planstate,
                  List *ancestors, ExplainState *es);
 static void show_sort_info(SortState *sortstate, ExplainState *es);
+static void show_incremental_sort_info(IncrementalSortState *incrsortstate,
+                           ExplainState *es);
 static void show_hash_info(HashState *hashstate, ExplainState *es);
 static void show_tidbitmap_info(BitmapHeapScanState *planstate,
                     ExplainState *es);
@@ -610,6 +615,10 @@ ExplainOnePlan(PlannedStmt *plannedstmt, IntoClause *into, ExplainState *es,
     if (es->analyze)
         ExplainPrintTriggers(es, queryDesc);
 
+    /* Print info about JIT compilation done while running the query */
+    if (es->analyze)
+        ExplainPrintJIT(es, queryDesc);
+
     /*
      * Close down the query and free resources.  Include time for this in the
      * total execution time (although it should be pretty minimal).
@@ -721,6 +730,74 @@ ExplainPrintTriggers(ExplainState *es, QueryDesc *queryDesc)
     ExplainCloseGroup("Triggers", "Triggers", false, es);
 }
 
+/*
+ * ExplainPrintJIT -
+ *      append information about JITing to es->str
+ *
+ * Nothing is printed if no code was JIT compiled for the query.  Only code
+ * compiled in this backend is accounted for, not that of parallel workers.
+ */
+void
+ExplainPrintJIT(ExplainState *es, QueryDesc *queryDesc)
+{
+    JitContext *jc = queryDesc->estate->es_jit;
+    JitInstrumentation *ji;
+    instr_time    total_time;
+
+    if (!jc || jc->instr.created_functions + jc->instr.cached_functions == 0)
+        return;
+    ji = &jc->instr;
+
+    INSTR_TIME_SET_ZERO(total_time);
+    INSTR_TIME_ADD(total_time, ji->generation_counter);
+    INSTR_TIME_ADD(total_time, ji->optimization_counter);
+    INSTR_TIME_ADD(total_time, ji->emission_counter);
+
+    ExplainOpenGroup("JIT", "JIT", true, es);
+
+    if (es->format == EXPLAIN_FORMAT_TEXT)
+    {
+        appendStringInfoString(es->str, "JIT:\n");
+        appendStringInfo(es->str, "  Functions: %zu (%zu cached)\n",
+                         ji->created_functions + ji->cached_functions,
+                         ji->cached_functions);
+        appendStringInfo(es->str, "  Options: Optimization %s\n",
+                         jc->flags & PGJIT_OPT3 ? "true" : "false");
+        if (es->timing)
+            appendStringInfo(es->str,
+                             "  Timing: Generation %.3f ms, Optimization %.3f ms, Emission %.3f ms, Total %.3f ms\n",
+                             1000.0 * INSTR_TIME_GET_DOUBLE(ji->generation_counter),
+                             1000.0 * INSTR_TIME_GET_DOUBLE(ji->optimization_counter),
+                             1000.0 * INSTR_TIME_GET_DOUBLE(ji->emission_counter),
+                             1000.0 * INSTR_TIME_GET_DOUBLE(total_time));
+    }
+    else
+    {
+        ExplainPropertyLong("Functions",
+                            (long) (ji->created_functions + ji->cached_functions),
+                            es);
+        ExplainPropertyLong("Cached Functions", (long) ji->cached_functions, es);
+        ExplainPropertyBool("Optimization", (jc->flags & PGJIT_OPT3) != 0, es);
+        if (es->timing)
+        {
+            ExplainPropertyFloat("Generation Time",
+                                 1000.0 * INSTR_TIME_GET_DOUBLE(ji->generation_counter),
+                                 3, es);
+            ExplainPropertyFloat("Optimization Time",
+                                 1000.0 * INSTR_TIME_GET_DOUBLE(ji->optimization_counter),
+                                 3, es);
+            ExplainPropertyFloat("Emission Time",
+                                 1000.0 * INSTR_TIME_GET_DOUBLE(ji->emission_counter),
+                                 3, es);
+            ExplainPropertyFloat("Total Time",
+                                 1000.0 * INSTR_TIME_GET_DOUBLE(total_time),
+                                 3, es);
+        }
+    }
+
+    ExplainCloseGroup("JIT", "JIT", true, es);
+}
+
 /*
  * ExplainQueryText -
  *      add a "Query Text" node that contains the actual text of the query
@@ -1064,6 +1141,9 @@ ExplainNode(PlanState *planstate, List *ancestors,
         case T_Sort:
             pname = sname = "Sort";
             break;
+        case T_IncrementalSort:
+            pname = sname = "Incremental Sort";
+            break;
         case T_Group:
             pname = sname = "Group";
             break;
@@ -1822,6 +1902,12 @@ ExplainNode(PlanState *planstate, List *ancestors,
             show_sort_keys(castNode(SortState, planstate), ancestors, es);
             show_sort_info(castNode(SortState, planstate), es);
             break;
+        case T_IncrementalSort:
+            show_incremental_sort_keys(castNode(IncrementalSortState, planstate),
+                                       ancestors, es);
+            show_incremental_sort_info(castNode(IncrementalSortState, planstate),
+                                       es);
+            break;
         case T_MergeAppend:
             show_merge_append_keys(castNode(MergeAppendState, planstate),
                                    ancestors, es);
@@ -1920,6 +2006,27 @@ ExplainNode(PlanState *planstate, List *ancestors,
             ExplainCloseGroup("Workers", "Workers", false, es);
     }
 
+#ifdef __OPENTENBASE__
+    /* subplans pruned at executor startup */
+    if (IsA(plan, Append) && ((Append *) plan)->part_prune_info != NULL)
+    {
+        int            nremoved = list_length(((Append *) plan)->appendplans) -
+                                ((AppendState *) planstate)->as_nplans;
+
+        if (nremoved > 0)
+            ExplainPropertyInteger("Subplans Removed", nremoved, es);
+    }
+    else if (IsA(plan, MergeAppend) &&
+             ((MergeAppend *) plan)->part_prune_info != NULL)
+    {
+        int            nremoved = list_length(((MergeAppend *) plan)->mergeplans) -
+                                ((MergeAppendState *) planstate)->ms_nplans;
+
+        if (nremoved > 0)
+            ExplainPropertyInteger("Subplans Removed", nremoved, es);
+    }
+#endif
+
     /* Get ready to display the child plans */
     haschildren = planstate->initPlan ||
         outerPlanState(planstate) ||
@@ -2171,6 +2278,28 @@ show_sort_keys(SortState *sortstate, List *ancestors, ExplainState *es)
                          ancestors, es);
 }
 
+/*
+ * Show the sort keys for an IncrementalSort node, and the leading ones its
+ * input is already sorted by.
+ */
+static void
+show_incremental_sort_keys(IncrementalSortState *incrsortstate,
+                           List *ancestors, ExplainState *es)
+{
+    IncrementalSort *plan = (IncrementalSort *) incrsortstate->ss.ps.plan;
+
+    show_sort_group_keys((PlanState *) incrsortstate, "Sort Key",
+                         plan->sort.numCols, plan->sort.sortColIdx,
+                         plan->sort.sortOperators, plan->sort.collations,
+                         plan->sort.nullsFirst,
+                         ancestors, es);
+    show_sort_group_keys((PlanState *) incrsortstate, "Presorted Key",
+                         plan->nPresortedCols, plan->sort.sortColIdx,
+                         plan->sort.sortOperators, plan->sort.collations,
+                         plan->sort.nullsFirst,
+                         ancestors, es);
+}
+
 /*
  * Show the sort keys for a SimpleSort node.
  */
@@ -2540,6 +2669,41 @@ show_tablesample(TableSampleClause *tsc, PlanState *planstate,
     }
 }
 
+/*
+ * If it's EXPLAIN ANALYZE, show the number of batches an incremental sort
+ * node sorted, and the tuplesort stats of the largest one
+ */
+static void
+show_incremental_sort_info(IncrementalSortState *incrsortstate,
+                           ExplainState *es)
+{
+    TuplesortInstrumentation *stats = &incrsortstate->max_instrument;
+    const char *sortMethod;
+    const char *spaceType;
+
+    if (!es->analyze || incrsortstate->n_batches == 0)
+        return;
+
+    sortMethod = tuplesort_method_name(stats->sortMethod);
+    spaceType = tuplesort_space_type_name(stats->spaceType);
+
+    if (es->format == EXPLAIN_FORMAT_TEXT)
+    {
+        appendStringInfoSpaces(es->str, es->indent * 2);
+        appendStringInfo(es->str,
+                         "Sort Batches: " INT64_FORMAT "  Largest Batch Sort Method: %s  %s: %ldkB\n",
+                         incrsortstate->n_batches,
+                         sortMethod, spaceType, stats->spaceUsed);
+    }
+    else
+    {
+        ExplainPropertyLong("Sort Batches", (long) incrsortstate->n_batches, es);
+        ExplainPropertyText("Sort Method", sortMethod, es);
+        ExplainPropertyLong("Sort Space Used", stats->spaceUsed, es);
+        ExplainPropertyText("Sort Space Type", spaceType, es);
+    }
+}
+
 /*
  * If it's EXPLAIN ANALYZE, show tuplesort stats for a sort node
  */
@@ -3320,6 +3484,8 @@ show_modifytable_info(ModifyTableState *mtstate, List *ancestors,
  *
  * Note: we don't actually need to examine the Plan list members, but
  * we need the list in order to determine the length of the PlanState array.
+ * The PlanStates of the subplans an Append or MergeAppend did not initialize
+ * are NULL, at the end of the array.
  */
 static void
 ExplainMemberNodes(List *plans, PlanState **planstates,
@@ -3329,8 +3495,14 @@ ExplainMemberNodes(List *plans, PlanState **planstates,
     int            j;
 
     for (j = 0; j < nplans; j++)
+    {
+#ifdef __OPENTENBASE__
+        if (planstates[j] == NULL)
+            continue;
+#endif
         ExplainNode(planstates[j], ancestors,
                     "Member", NULL, es);
+    }
 }
 
 /*
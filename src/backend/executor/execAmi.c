@@ -31,6 +31,7 @@
 #include "executor/nodeGroup.h"
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
+#include "executor/nodeIncrementalSort.h"
 #include "executor/nodeIndexonlyscan.h"
 #include "executor/nodeIndexscan.h"
 #include "executor/nodeLimit.h"
@@ -260,6 +261,10 @@ ExecReScan(PlanState *node)
             ExecReScanSort((SortState *) node);
             break;
 
+        case T_IncrementalSortState:
+            ExecReScanIncrementalSort((IncrementalSortState *) node);
+            break;
+
         case T_GroupState:
             ExecReScanGroup((GroupState *) node);
             break;
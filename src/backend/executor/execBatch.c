@@ -0,0 +1,681 @@
+/*-------------------------------------------------------------------------
+ *
+ * execBatch.c
+ *	  Batch evaluation of simple scan quals over many tuples at once.
+ *
+ * ExecQual walks the expression steps of the qual once for every tuple, so
+ * for the simple comparisons that make up most filters on large tables the
+ * per-row opcode dispatch costs more than the comparison itself.  Here the
+ * clauses of a scan qual that only compare (and add, subtract or multiply)
+ * int4, int8, float8, date and timestamp columns and constants are compiled
+ * into a small operand tree, and every clause is evaluated over a whole
+ * batch of tuples with a tight type-specialized loop, shrinking a selection
+ * vector of the tuples still qualifying.
+ *
+ * Only the leading clauses of the qual that can be handled here are taken,
+ * the rest, from the first clause without a kernel on, is returned to the
+ * caller as the residual qual.  That is still evaluated one tuple at a time
+ * by ExecQual on the tuples that pass the batch clauses, so every tuple sees
+ * the clauses in the order the planner put them in.
+ *
+ * The kernels never raise an error themselves.  A tuple on which an
+ * operator would fail, on overflow, ends the batch: the tuples before it
+ * get their batch result, and the caller evaluates it and the tuples after
+ * it one at a time with the whole qual.  So the error is raised only if the
+ * scan really gets to that tuple, and not for instance when a LIMIT above
+ * has already been satisfied by an earlier tuple of the batch.
+ *
+ * Only the qual is evaluated in batches.  The projection of the scan and
+ * the nodes above it, including a RemoteSubplan sending the rows on to
+ * another node, still get the qualifying tuples one at a time.
+ *
+ * Copyright (c) 2023 THL A29 Limited, a Tencent company.
+ *
+ * This source code file is licensed under the BSD 3-Clause License,
+ * you may obtain a copy of the License at http://opensource.org/license/bsd-3-clause/
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/execBatch.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <math.h>
+
+#include "catalog/pg_type.h"
+#include "executor/execBatch.h"
+#include "nodes/nodeFuncs.h"
+#include "nodes/primnodes.h"
+#include "utils/fmgroids.h"
+
+bool		enable_batch_qual = true;
+
+#define SAMESIGN(a,b)	(((a) < 0) == ((b) < 0))
+
+/* value representation of an operand, int4 and date are widened to int64 */
+typedef enum BatchType
+{
+	BATCH_TYPE_INT4,
+	BATCH_TYPE_INT8,
+	BATCH_TYPE_FLOAT8
+} BatchType;
+
+typedef enum BatchOp
+{
+	BATCH_OP_EQ,
+	BATCH_OP_NE,
+	BATCH_OP_LT,
+	BATCH_OP_LE,
+	BATCH_OP_GT,
+	BATCH_OP_GE,
+	BATCH_OP_PL,
+	BATCH_OP_MI,
+	BATCH_OP_MUL
+} BatchOp;
+
+typedef struct BatchFunc
+{
+	Oid			funcid;			/* pg_proc oid of the operator function */
+	Oid			argtype;		/* type of both arguments */
+	BatchType	type;			/* kernel to use */
+	BatchOp		op;
+} BatchFunc;
+
+/*
+ * Functions with a batch kernel.  timestamp_xx (without time zone) have no
+ * F_ symbol because they share prosrc with timestamptz_xx, so use their oid.
+ */
+static const BatchFunc batch_funcs[] =
+{
+	{F_INT4EQ, INT4OID, BATCH_TYPE_INT4, BATCH_OP_EQ},
+	{F_INT4NE, INT4OID, BATCH_TYPE_INT4, BATCH_OP_NE},
+	{F_INT4LT, INT4OID, BATCH_TYPE_INT4, BATCH_OP_LT},
+	{F_INT4LE, INT4OID, BATCH_TYPE_INT4, BATCH_OP_LE},
+	{F_INT4GT, INT4OID, BATCH_TYPE_INT4, BATCH_OP_GT},
+	{F_INT4GE, INT4OID, BATCH_TYPE_INT4, BATCH_OP_GE},
+	{F_INT4PL, INT4OID, BATCH_TYPE_INT4, BATCH_OP_PL},
+	{F_INT4MI, INT4OID, BATCH_TYPE_INT4, BATCH_OP_MI},
+	{F_INT4MUL, INT4OID, BATCH_TYPE_INT4, BATCH_OP_MUL},
+	{F_INT8EQ, INT8OID, BATCH_TYPE_INT8, BATCH_OP_EQ},
+	{F_INT8NE, INT8OID, BATCH_TYPE_INT8, BATCH_OP_NE},
+	{F_INT8LT, INT8OID, BATCH_TYPE_INT8, BATCH_OP_LT},
+	{F_INT8LE, INT8OID, BATCH_TYPE_INT8, BATCH_OP_LE},
+	{F_INT8GT, INT8OID, BATCH_TYPE_INT8, BATCH_OP_GT},
+	{F_INT8GE, INT8OID, BATCH_TYPE_INT8, BATCH_OP_GE},
+	{F_INT8PL, INT8OID, BATCH_TYPE_INT8, BATCH_OP_PL},
+	{F_INT8MI, INT8OID, BATCH_TYPE_INT8, BATCH_OP_MI},
+	{F_INT8MUL, INT8OID, BATCH_TYPE_INT8, BATCH_OP_MUL},
+	{F_FLOAT8EQ, FLOAT8OID, BATCH_TYPE_FLOAT8, BATCH_OP_EQ},
+	{F_FLOAT8NE, FLOAT8OID, BATCH_TYPE_FLOAT8, BATCH_OP_NE},
+	{F_FLOAT8LT, FLOAT8OID, BATCH_TYPE_FLOAT8, BATCH_OP_LT},
+	{F_FLOAT8LE, FLOAT8OID, BATCH_TYPE_FLOAT8, BATCH_OP_LE},
+	{F_FLOAT8GT, FLOAT8OID, BATCH_TYPE_FLOAT8, BATCH_OP_GT},
+	{F_FLOAT8GE, FLOAT8OID, BATCH_TYPE_FLOAT8, BATCH_OP_GE},
+	{F_FLOAT8PL, FLOAT8OID, BATCH_TYPE_FLOAT8, BATCH_OP_PL},
+	{F_FLOAT8MI, FLOAT8OID, BATCH_TYPE_FLOAT8, BATCH_OP_MI},
+	{F_FLOAT8MUL, FLOAT8OID, BATCH_TYPE_FLOAT8, BATCH_OP_MUL},
+	{F_DATE_EQ, DATEOID, BATCH_TYPE_INT4, BATCH_OP_EQ},
+	{F_DATE_NE, DATEOID, BATCH_TYPE_INT4, BATCH_OP_NE},
+	{F_DATE_LT, DATEOID, BATCH_TYPE_INT4, BATCH_OP_LT},
+	{F_DATE_LE, DATEOID, BATCH_TYPE_INT4, BATCH_OP_LE},
+	{F_DATE_GT, DATEOID, BATCH_TYPE_INT4, BATCH_OP_GT},
+	{F_DATE_GE, DATEOID, BATCH_TYPE_INT4, BATCH_OP_GE},
+	{F_TIMESTAMP_EQ, TIMESTAMPTZOID, BATCH_TYPE_INT8, BATCH_OP_EQ},
+	{F_TIMESTAMP_NE, TIMESTAMPTZOID, BATCH_TYPE_INT8, BATCH_OP_NE},
+	{F_TIMESTAMP_LT, TIMESTAMPTZOID, BATCH_TYPE_INT8, BATCH_OP_LT},
+	{F_TIMESTAMP_LE, TIMESTAMPTZOID, BATCH_TYPE_INT8, BATCH_OP_LE},
+	{F_TIMESTAMP_GT, TIMESTAMPTZOID, BATCH_TYPE_INT8, BATCH_OP_GT},
+	{F_TIMESTAMP_GE, TIMESTAMPTZOID, BATCH_TYPE_INT8, BATCH_OP_GE},
+	{2052, TIMESTAMPOID, BATCH_TYPE_INT8, BATCH_OP_EQ},
+	{2053, TIMESTAMPOID, BATCH_TYPE_INT8, BATCH_OP_NE},
+	{2054, TIMESTAMPOID, BATCH_TYPE_INT8, BATCH_OP_LT},
+	{2055, TIMESTAMPOID, BATCH_TYPE_INT8, BATCH_OP_LE},
+	{2057, TIMESTAMPOID, BATCH_TYPE_INT8, BATCH_OP_GT},
+	{2056, TIMESTAMPOID, BATCH_TYPE_INT8, BATCH_OP_GE}
+};
+
+typedef enum BatchOperandKind
+{
+	BATCH_OPERAND_VAR,
+	BATCH_OPERAND_CONST,
+	BATCH_OPERAND_ARITH
+} BatchOperandKind;
+
+/*
+ * One operand of a clause.  Its values for the tuples of the current
+ * selection vector are computed into ivals/fvals and nulls, position k
+ * holding the value for tuple sel[k].  Constants are filled in once.
+ */
+typedef struct BatchOperand
+{
+	BatchOperandKind kind;
+	BatchType	type;
+	AttrNumber	attnum;			/* BATCH_OPERAND_VAR */
+	BatchOp		op;				/* BATCH_OPERAND_ARITH */
+	struct BatchOperand *left;
+	struct BatchOperand *right;
+	int64	   *ivals;			/* values of int4/int8 operands */
+	double	   *fvals;			/* values of float8 operands */
+	bool	   *nulls;
+} BatchOperand;
+
+typedef struct BatchQualClause
+{
+	BatchType	type;
+	BatchOp		op;				/* one of the comparisons */
+	BatchOperand *left;
+	BatchOperand *right;
+} BatchQualClause;
+
+struct BatchQualState
+{
+	TupleDesc	tupdesc;		/* descriptor of the scanned tuples */
+	int			nclauses;
+	BatchQualClause *clauses;
+};
+
+static const BatchFunc *batch_lookup_func(Oid funcid);
+static BatchOperand *batch_compile_operand(Expr *expr, Index scanrelid,
+					  TupleDesc tupdesc, Oid argtype, BatchType type);
+static BatchQualClause *batch_compile_clause(Expr *clause, Index scanrelid,
+					 TupleDesc tupdesc);
+static void batch_eval_operand(BatchOperand *operand, TupleDesc tupdesc,
+				   HeapTupleData *tuples, int *sel, int nsel, int *stop);
+static int	batch_eval_clause(BatchQualClause *clause, int *sel, int nsel);
+
+static const BatchFunc *
+batch_lookup_func(Oid funcid)
+{
+	int			i;
+
+	for (i = 0; i < lengthof(batch_funcs); i++)
+	{
+		if (batch_funcs[i].funcid == funcid)
+			return &batch_funcs[i];
+	}
+
+	return NULL;
+}
+
+static BatchOperand *
+batch_compile_operand(Expr *expr, Index scanrelid, TupleDesc tupdesc,
+					  Oid argtype, BatchType type)
+{
+	BatchOperand *operand;
+
+	if (exprType((Node *) expr) != argtype)
+		return NULL;
+
+	operand = (BatchOperand *) palloc0(sizeof(BatchOperand));
+	operand->type = type;
+
+	if (IsA(expr, Var))
+	{
+		Var		   *var = (Var *) expr;
+
+		if (var->varno != scanrelid ||
+			var->varlevelsup != 0 ||
+			var->varattno <= 0 ||
+			var->varattno > tupdesc->natts ||
+			tupdesc->attrs[var->varattno - 1]->atttypid != argtype)
+		{
+			pfree(operand);
+			return NULL;
+		}
+
+		operand->kind = BATCH_OPERAND_VAR;
+		operand->attnum = var->varattno;
+	}
+	else if (IsA(expr, Const))
+	{
+		Const	   *con = (Const *) expr;
+		int			k;
+
+		/* the operators are strict, let ExecQual deal with a NULL */
+		if (con->constisnull)
+		{
+			pfree(operand);
+			return NULL;
+		}
+
+		operand->kind = BATCH_OPERAND_CONST;
+		operand->nulls = (bool *) palloc0(sizeof(bool) * BATCH_QUAL_MAX_ROWS);
+		if (type == BATCH_TYPE_FLOAT8)
+		{
+			double		val = DatumGetFloat8(con->constvalue);
+
+			operand->fvals = (double *) palloc(sizeof(double) * BATCH_QUAL_MAX_ROWS);
+			for (k = 0; k < BATCH_QUAL_MAX_ROWS; k++)
+				operand->fvals[k] = val;
+		}
+		else
+		{
+			int64		val = (type == BATCH_TYPE_INT4) ?
+			DatumGetInt32(con->constvalue) : DatumGetInt64(con->constvalue);
+
+			operand->ivals = (int64 *) palloc(sizeof(int64) * BATCH_QUAL_MAX_ROWS);
+			for (k = 0; k < BATCH_QUAL_MAX_ROWS; k++)
+				operand->ivals[k] = val;
+		}
+		return operand;
+	}
+	else if (IsA(expr, OpExpr))
+	{
+		OpExpr	   *opexpr = (OpExpr *) expr;
+		const BatchFunc *func;
+
+		set_opfuncid(opexpr);
+		func = batch_lookup_func(opexpr->opfuncid);
+		if (func == NULL ||
+			func->op < BATCH_OP_PL ||
+			func->argtype != argtype ||
+			list_length(opexpr->args) != 2)
+		{
+			pfree(operand);
+			return NULL;
+		}
+
+		operand->kind = BATCH_OPERAND_ARITH;
+		operand->op = func->op;
+		operand->left = batch_compile_operand((Expr *) linitial(opexpr->args),
+											  scanrelid, tupdesc,
+											  argtype, type);
+		operand->right = batch_compile_operand((Expr *) lsecond(opexpr->args),
+											   scanrelid, tupdesc,
+											   argtype, type);
+		if (operand->left == NULL || operand->right == NULL)
+			return NULL;
+	}
+	else
+	{
+		pfree(operand);
+		return NULL;
+	}
+
+	operand->nulls = (bool *) palloc(sizeof(bool) * BATCH_QUAL_MAX_ROWS);
+	if (type == BATCH_TYPE_FLOAT8)
+		operand->fvals = (double *) palloc(sizeof(double) * BATCH_QUAL_MAX_ROWS);
+	else
+		operand->ivals = (int64 *) palloc(sizeof(int64) * BATCH_QUAL_MAX_ROWS);
+
+	return operand;
+}
+
+static BatchQualClause *
+batch_compile_clause(Expr *clause, Index scanrelid, TupleDesc tupdesc)
+{
+	OpExpr	   *opexpr;
+	const BatchFunc *func;
+	BatchQualClause *result;
+
+	if (!IsA(clause, OpExpr))
+		return NULL;
+
+	opexpr = (OpExpr *) clause;
+	set_opfuncid(opexpr);
+	func = batch_lookup_func(opexpr->opfuncid);
+	if (func == NULL ||
+		func->op > BATCH_OP_GE ||
+		list_length(opexpr->args) != 2)
+		return NULL;
+
+	result = (BatchQualClause *) palloc0(sizeof(BatchQualClause));
+	result->type = func->type;
+	result->op = func->op;
+	result->left = batch_compile_operand((Expr *) linitial(opexpr->args),
+										 scanrelid, tupdesc,
+										 func->argtype, func->type);
+	result->right = batch_compile_operand((Expr *) lsecond(opexpr->args),
+										  scanrelid, tupdesc,
+										  func->argtype, func->type);
+
+	/* comparing two constants is left to ExecQual, it is not worth it */
+	if (result->left == NULL || result->right == NULL ||
+		(result->left->kind == BATCH_OPERAND_CONST &&
+		 result->right->kind == BATCH_OPERAND_CONST))
+		return NULL;
+
+	return result;
+}
+
+/*
+ * ExecInitBatchQual
+ *
+ * Compile the leading clauses of an implicitly-ANDed scan qual which have a
+ * batch kernel.  The clauses from the first one without a kernel on are
+ * returned in *residual for the caller to pass to ExecInitQual.  Returns
+ * NULL, with *residual set to the whole qual, if the first clause can not be
+ * evaluated in batches.
+ *
+ * The batch clauses are all evaluated before the residual ones, so we must
+ * not take a clause past one that precedes it: order_qual_clauses puts the
+ * quals of security barrier views and row level security policies first,
+ * and our operators are not leakproof, they can fail on overflow.
+ */
+BatchQualState *
+ExecInitBatchQual(List *qual, Index scanrelid, TupleDesc tupdesc,
+				  List **residual)
+{
+	BatchQualState *state;
+	List	   *clauses = NIL;
+	ListCell   *lc;
+	int			i;
+
+	*residual = NIL;
+
+	foreach(lc, qual)
+	{
+		Expr	   *expr = (Expr *) lfirst(lc);
+		BatchQualClause *clause;
+
+		clause = batch_compile_clause(expr, scanrelid, tupdesc);
+		if (clause == NULL)
+		{
+			*residual = list_copy_tail(qual, list_length(clauses));
+			break;
+		}
+		clauses = lappend(clauses, clause);
+	}
+
+	if (clauses == NIL)
+	{
+		*residual = qual;
+		return NULL;
+	}
+
+	state = (BatchQualState *) palloc0(sizeof(BatchQualState));
+	state->tupdesc = tupdesc;
+	state->nclauses = list_length(clauses);
+	state->clauses = (BatchQualClause *)
+		palloc(sizeof(BatchQualClause) * state->nclauses);
+	i = 0;
+	foreach(lc, clauses)
+		state->clauses[i++] = *(BatchQualClause *) lfirst(lc);
+
+	return state;
+}
+
+/* same ordering as float8_cmp_internal: NaN equals NaN, above all else */
+static inline int
+batch_float8_cmp(double a, double b)
+{
+	if (unlikely(isnan(a) || isnan(b)))
+	{
+		if (isnan(a))
+			return isnan(b) ? 0 : 1;
+		return -1;
+	}
+
+	return (a > b) ? 1 : ((a < b) ? -1 : 0);
+}
+
+/*
+ * Compute the values of an operand for tuples sel[0 .. nsel - 1].  An
+ * arithmetic operator that would fail on tuple sel[k] does not raise the
+ * error, it lowers *stop to sel[k] and yields NULL for it, see ExecBatchQual.
+ */
+/* the operator fails on tuple sel[k], end the batch there */
+#define BATCH_STOP_AT(k) \
+	do { \
+		operand->nulls[(k)] = true; \
+		if (sel[(k)] < *stop) \
+			*stop = sel[(k)]; \
+	} while (0)
+
+static void
+batch_eval_operand(BatchOperand *operand, TupleDesc tupdesc,
+				   HeapTupleData *tuples, int *sel, int nsel, int *stop)
+{
+	int			k;
+
+	switch (operand->kind)
+	{
+		case BATCH_OPERAND_CONST:
+			break;
+
+		case BATCH_OPERAND_VAR:
+			for (k = 0; k < nsel; k++)
+			{
+				Datum		d;
+
+				d = heap_getattr(&tuples[sel[k]], operand->attnum, tupdesc,
+								 &operand->nulls[k]);
+				if (operand->nulls[k])
+					continue;
+				if (operand->type == BATCH_TYPE_INT4)
+					operand->ivals[k] = DatumGetInt32(d);
+				else if (operand->type == BATCH_TYPE_INT8)
+					operand->ivals[k] = DatumGetInt64(d);
+				else
+					operand->fvals[k] = DatumGetFloat8(d);
+			}
+			break;
+
+		case BATCH_OPERAND_ARITH:
+			{
+				BatchOperand *l = operand->left;
+				BatchOperand *r = operand->right;
+
+				batch_eval_operand(l, tupdesc, tuples, sel, nsel, stop);
+				batch_eval_operand(r, tupdesc, tuples, sel, nsel, stop);
+
+				for (k = 0; k < nsel; k++)
+					operand->nulls[k] = l->nulls[k] || r->nulls[k];
+
+				/*
+				 * Overflow is detected exactly as int4pl, int8mul, float8pl
+				 * and friends would do, and left for them to report.
+				 */
+				if (operand->type == BATCH_TYPE_INT4)
+				{
+					for (k = 0; k < nsel; k++)
+					{
+						int64		result;
+
+						if (operand->nulls[k])
+							continue;
+						if (operand->op == BATCH_OP_PL)
+							result = l->ivals[k] + r->ivals[k];
+						else if (operand->op == BATCH_OP_MI)
+							result = l->ivals[k] - r->ivals[k];
+						else
+							result = l->ivals[k] * r->ivals[k];
+						if (result != (int64) ((int32) result))
+						{
+							BATCH_STOP_AT(k);
+							continue;
+						}
+						operand->ivals[k] = result;
+					}
+				}
+				else if (operand->type == BATCH_TYPE_INT8)
+				{
+					for (k = 0; k < nsel; k++)
+					{
+						int64		a = l->ivals[k];
+						int64		b = r->ivals[k];
+						int64		result;
+						bool		overflow;
+
+						if (operand->nulls[k])
+							continue;
+						if (operand->op == BATCH_OP_PL)
+						{
+							result = a + b;
+							overflow = SAMESIGN(a, b) && !SAMESIGN(result, a);
+						}
+						else if (operand->op == BATCH_OP_MI)
+						{
+							result = a - b;
+							overflow = !SAMESIGN(a, b) && !SAMESIGN(result, a);
+						}
+						else
+						{
+							result = a * b;
+							overflow = (a != (int64) ((int32) a) ||
+										b != (int64) ((int32) b)) &&
+								(b != 0 &&
+								 ((b == -1 && a < 0 && result < 0) ||
+								  result / b != a));
+						}
+						if (overflow)
+						{
+							BATCH_STOP_AT(k);
+							continue;
+						}
+						operand->ivals[k] = result;
+					}
+				}
+				else
+				{
+					for (k = 0; k < nsel; k++)
+					{
+						double		a = l->fvals[k];
+						double		b = r->fvals[k];
+						double		result;
+
+						if (operand->nulls[k])
+							continue;
+						if (operand->op == BATCH_OP_PL)
+							result = a + b;
+						else if (operand->op == BATCH_OP_MI)
+							result = a - b;
+						else
+							result = a * b;
+						if ((isinf(result) && !isinf(a) && !isinf(b)) ||
+							(operand->op == BATCH_OP_MUL &&
+							 result == 0.0 && a != 0.0 && b != 0.0))
+						{
+							BATCH_STOP_AT(k);
+							continue;
+						}
+						operand->fvals[k] = result;
+					}
+				}
+			}
+			break;
+	}
+}
+
+/* keep sel[k] for which both operands are not null and cond holds */
+#define BATCH_FILTER(cond) \
+	do { \
+		for (k = 0; k < nsel; k++) \
+		{ \
+			if (!lnulls[k] && !rnulls[k] && (cond)) \
+				sel[nout++] = sel[k]; \
+		} \
+	} while (0)
+
+static int
+batch_eval_clause(BatchQualClause *clause, int *sel, int nsel)
+{
+	bool	   *lnulls = clause->left->nulls;
+	bool	   *rnulls = clause->right->nulls;
+	int			nout = 0;
+	int			k;
+
+	if (clause->type == BATCH_TYPE_FLOAT8)
+	{
+		double	   *l = clause->left->fvals;
+		double	   *r = clause->right->fvals;
+
+		switch (clause->op)
+		{
+			case BATCH_OP_EQ:
+				BATCH_FILTER(batch_float8_cmp(l[k], r[k]) == 0);
+				break;
+			case BATCH_OP_NE:
+				BATCH_FILTER(batch_float8_cmp(l[k], r[k]) != 0);
+				break;
+			case BATCH_OP_LT:
+				BATCH_FILTER(batch_float8_cmp(l[k], r[k]) < 0);
+				break;
+			case BATCH_OP_LE:
+				BATCH_FILTER(batch_float8_cmp(l[k], r[k]) <= 0);
+				break;
+			case BATCH_OP_GT:
+				BATCH_FILTER(batch_float8_cmp(l[k], r[k]) > 0);
+				break;
+			case BATCH_OP_GE:
+				BATCH_FILTER(batch_float8_cmp(l[k], r[k]) >= 0);
+				break;
+			default:
+				elog(ERROR, "unrecognized batch comparison: %d", clause->op);
+		}
+	}
+	else
+	{
+		int64	   *l = clause->left->ivals;
+		int64	   *r = clause->right->ivals;
+
+		switch (clause->op)
+		{
+			case BATCH_OP_EQ:
+				BATCH_FILTER(l[k] == r[k]);
+				break;
+			case BATCH_OP_NE:
+				BATCH_FILTER(l[k] != r[k]);
+				break;
+			case BATCH_OP_LT:
+				BATCH_FILTER(l[k] < r[k]);
+				break;
+			case BATCH_OP_LE:
+				BATCH_FILTER(l[k] <= r[k]);
+				break;
+			case BATCH_OP_GT:
+				BATCH_FILTER(l[k] > r[k]);
+				break;
+			case BATCH_OP_GE:
+				BATCH_FILTER(l[k] >= r[k]);
+				break;
+			default:
+				elog(ERROR, "unrecognized batch comparison: %d", clause->op);
+		}
+	}
+
+	return nout;
+}
+
+/*
+ * ExecBatchQual
+ *
+ * Evaluate the batch clauses over tuples[0 .. ntuples - 1], which must be
+ * at most BATCH_QUAL_MAX_ROWS.  The indexes of the tuples passing all of
+ * them are stored in sel, in ascending order, and their number returned.
+ *
+ * *nfinal is set to the number of leading tuples the result is valid for.
+ * It is less than ntuples if an operator would fail on tuples[*nfinal]; the
+ * caller has to evaluate the whole qual on that tuple and the ones after it
+ * one at a time, so that the error is raised in its turn.
+ */
+int
+ExecBatchQual(BatchQualState *state, HeapTupleData *tuples, int ntuples,
+			  int *sel, int *nfinal)
+{
+	int			nsel = ntuples;
+	int			stop = ntuples;
+	int			i;
+
+	Assert(ntuples <= BATCH_QUAL_MAX_ROWS);
+
+	for (i = 0; i < ntuples; i++)
+		sel[i] = i;
+
+	for (i = 0; i < state->nclauses && nsel > 0; i++)
+	{
+		BatchQualClause *clause = &state->clauses[i];
+
+		batch_eval_operand(clause->left, state->tupdesc, tuples, sel, nsel, &stop);
+		batch_eval_operand(clause->right, state->tupdesc, tuples, sel, nsel, &stop);
+		nsel = batch_eval_clause(clause, sel, nsel);
+	}
+
+	/* the tuples from the first failing one on are left to the caller */
+	while (nsel > 0 && sel[nsel - 1] >= stop)
+		nsel--;
+
+	*nfinal = stop;
+	return nsel;
+}
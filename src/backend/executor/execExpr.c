@@ -36,6 +36,7 @@
 #include "executor/execExpr.h"
 #include "executor/nodeSubplan.h"
 #include "funcapi.h"
+#include "jit/jit.h"
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
@@ -122,6 +123,7 @@ ExecInitExpr(Expr *node, PlanState *parent)
     /* Initialize ExprState with empty step list */
     state = makeNode(ExprState);
     state->expr = node;
+    state->parent = parent;
 
     /* Insert EEOP_*_FETCHSOME steps as needed */
     ExecInitExprSlots(state, (Node *) node);
@@ -172,6 +174,7 @@ ExecInitQual(List *qual, PlanState *parent)
 
     state = makeNode(ExprState);
     state->expr = (Expr *) qual;
+    state->parent = parent;
     /* mark expression as to be used with ExecQual() */
     state->flags = EEO_FLAG_IS_QUAL;
 
@@ -314,6 +317,7 @@ ExecBuildProjectionInfo(List *targetList,
     projInfo->pi_state.tag.type = T_ExprState;
     state = &projInfo->pi_state;
     state->expr = (Expr *) targetList;
+    state->parent = parent;
     state->resultslot = slot;
 
     /* Insert EEOP_*_FETCHSOME steps as needed */
@@ -565,14 +569,17 @@ ExecCheck(ExprState *state, ExprContext *econtext)
  * Prepare a compiled expression for execution.  This has to be called for
  * every ExprState before it can be executed.
  *
- * NB: While this currently only calls ExecReadyInterpretedExpr(),
- * this will likely get extended to further expression evaluation methods.
- * Therefore this should be used instead of directly calling
- * ExecReadyInterpretedExpr().
+ * The expression is handed to the JIT provider first, if the query asked
+ * for JIT compilation; otherwise (or if the provider declines it) it is
+ * prepared for interpretation.  This should be used instead of directly
+ * calling ExecReadyInterpretedExpr().
  */
 static void
 ExecReadyExpr(ExprState *state)
 {
+    if (jit_compile_expr(state))
+        return;
+
     ExecReadyInterpretedExpr(state);
 }
 
@@ -2184,18 +2191,21 @@ ExecInitExprSlots(ExprState *state, Node *node)
     {
         scratch.opcode = EEOP_INNER_FETCHSOME;
         scratch.d.fetch.last_var = info.last_inner;
+        scratch.d.fetch.known_desc = NULL;
         ExprEvalPushStep(state, &scratch);
     }
     if (info.last_outer > 0)
     {
         scratch.opcode = EEOP_OUTER_FETCHSOME;
         scratch.d.fetch.last_var = info.last_outer;
+        scratch.d.fetch.known_desc = NULL;
         ExprEvalPushStep(state, &scratch);
     }
     if (info.last_scan > 0)
     {
         scratch.opcode = EEOP_SCAN_FETCHSOME;
         scratch.d.fetch.last_var = info.last_scan;
+        scratch.d.fetch.known_desc = NULL;
         ExprEvalPushStep(state, &scratch);
     }
 }
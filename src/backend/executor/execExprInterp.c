@@ -131,7 +131,6 @@ static Datum ExecInterpExpr(ExprState *state, ExprContext *econtext, bool *isnul
 static void ExecInitInterpreter(void);
 
 /* support functions */
-static void CheckVarSlotCompatibility(TupleTableSlot *slot, int attnum, Oid vartype);
 static TupleDesc get_cached_rowtype(Oid type_id, int32 typmod,
                    TupleDesc *cache_field, ExprContext *econtext);
 static void ShutdownTupleDescRef(Datum arg);
@@ -678,46 +677,17 @@ ExecInterpExpr(ExprState *state, ExprContext *econtext, bool *isnull)
 
         EEO_CASE(EEOP_FUNCEXPR_FUSAGE)
         {
-            FunctionCallInfo fcinfo = op->d.func.fcinfo_data;
-            PgStat_FunctionCallUsage fcusage;
-
-            pgstat_init_function_usage(fcinfo, &fcusage);
-
-            fcinfo->isnull = false;
-            *op->resvalue = (op->d.func.fn_addr) (fcinfo);
-            *op->resnull = fcinfo->isnull;
-
-            pgstat_end_function_usage(&fcusage, true);
+            /* not common enough to inline */
+            ExecEvalFuncExprFusage(state, op, econtext);
 
             EEO_NEXT();
         }
 
         EEO_CASE(EEOP_FUNCEXPR_STRICT_FUSAGE)
         {
-            FunctionCallInfo fcinfo = op->d.func.fcinfo_data;
-            PgStat_FunctionCallUsage fcusage;
-            bool       *argnull = fcinfo->argnull;
-            int            argno;
-
-            /* strict function, so check for NULL args */
-            for (argno = 0; argno < op->d.func.nargs; argno++)
-            {
-                if (argnull[argno])
-                {
-                    *op->resnull = true;
-                    goto strictfail_fusage;
-                }
-            }
-
-            pgstat_init_function_usage(fcinfo, &fcusage);
-
-            fcinfo->isnull = false;
-            *op->resvalue = (op->d.func.fn_addr) (fcinfo);
-            *op->resnull = fcinfo->isnull;
-
-            pgstat_end_function_usage(&fcusage, true);
+            /* not common enough to inline */
+            ExecEvalFuncExprStrictFusage(state, op, econtext);
 
-    strictfail_fusage:
             EEO_NEXT();
         }
 
@@ -1519,12 +1489,60 @@ out:
     return state->resvalue;
 }
 
+/*
+ * Function-call implementations with function usage tracking, see the
+ * EEOP_FUNCEXPR_* cases of ExecInterpExpr().
+ */
+void
+ExecEvalFuncExprFusage(ExprState *state, ExprEvalStep *op,
+                       ExprContext *econtext)
+{
+    FunctionCallInfo fcinfo = op->d.func.fcinfo_data;
+    PgStat_FunctionCallUsage fcusage;
+
+    pgstat_init_function_usage(fcinfo, &fcusage);
+
+    fcinfo->isnull = false;
+    *op->resvalue = (op->d.func.fn_addr) (fcinfo);
+    *op->resnull = fcinfo->isnull;
+
+    pgstat_end_function_usage(&fcusage, true);
+}
+
+void
+ExecEvalFuncExprStrictFusage(ExprState *state, ExprEvalStep *op,
+                             ExprContext *econtext)
+{
+    FunctionCallInfo fcinfo = op->d.func.fcinfo_data;
+    PgStat_FunctionCallUsage fcusage;
+    bool       *argnull = fcinfo->argnull;
+    int            argno;
+
+    /* strict function, so check for NULL args */
+    for (argno = 0; argno < op->d.func.nargs; argno++)
+    {
+        if (argnull[argno])
+        {
+            *op->resnull = true;
+            return;
+        }
+    }
+
+    pgstat_init_function_usage(fcinfo, &fcusage);
+
+    fcinfo->isnull = false;
+    *op->resvalue = (op->d.func.fn_addr) (fcinfo);
+    *op->resnull = fcinfo->isnull;
+
+    pgstat_end_function_usage(&fcusage, true);
+}
+
 /*
  * Check whether a user attribute in a slot can be referenced by a Var
  * expression.  This should succeed unless there have been schema changes
  * since the expression tree has been created.
  */
-static void
+void
 CheckVarSlotCompatibility(TupleTableSlot *slot, int attnum, Oid vartype)
 {
     /*
@@ -55,6 +55,7 @@
 #include "commands/trigger.h"
 #include "executor/execdebug.h"
 #include "foreign/fdwapi.h"
+#include "jit/jit.h"
 #include "mb/pg_wchar.h"
 #include "miscadmin.h"
 #include "optimizer/clauses.h"
@@ -92,6 +93,7 @@
 #include "pgxc/squeue.h"
 #include "utils/relfilenodemap.h"
 #include "optimizer/pgxcship.h"
+#include "executor/runtimefilter.h"
 #endif
 
 #ifdef __AUDIT__
@@ -123,7 +125,8 @@ static void ExecutePlan(EState *estate, PlanState *planstate,
             uint64 numberTuples,
             ScanDirection direction,
             DestReceiver *dest,
-            bool execute_once);
+            bool execute_once,
+            RuntimeFilter *runtimeFilter);
 static bool ExecCheckRTEPerms(RangeTblEntry *rte);
 static bool ExecCheckRTEPermsModified(Oid relOid, Oid userid,
                           Bitmapset *modifiedCols,
@@ -356,6 +359,11 @@ standard_ExecutorStart(QueryDesc *queryDesc, int eflags)
     estate->es_top_eflags = eflags;
     estate->es_instrument = queryDesc->instrument_options;
 
+    /* decide, from the plan's cost, whether this query's code is JIT compiled */
+    if (queryDesc->plannedstmt->planTree)
+        estate->es_jit_flags =
+            jit_plan_flags(queryDesc->plannedstmt->planTree->total_cost);
+
     /*
      * Initialize the plan state tree
      */
@@ -473,7 +481,8 @@ standard_ExecutorRun(QueryDesc *queryDesc,
                     count,
                     direction,
                     dest,
-                    execute_once);
+                    execute_once,
+                    queryDesc->runtimeFilter);
     }
 
     /*
@@ -2012,7 +2021,8 @@ ExecutePlan(EState *estate,
             uint64 numberTuples,
             ScanDirection direction,
             DestReceiver *dest,
-            bool execute_once)
+            bool execute_once,
+            RuntimeFilter *runtimeFilter)
 {// #lizard forgives
     TupleTableSlot *slot;
     uint64        current_tuple_count;
@@ -2079,6 +2089,24 @@ ExecutePlan(EState *estate,
         if (estate->es_junkFilter != NULL)
             slot = ExecFilterJunk(estate->es_junkFilter, slot);
 
+        /*
+         * Do not send the consumer rows its hash join would discard.  The
+         * per-tuple context is reset above, the hash functions can leak into
+         * it.  Once the executor is told to finish, let the row through so
+         * that we get to the check below.
+         */
+        if (runtimeFilter != NULL && !Executor_done)
+        {
+            MemoryContext oldcontext;
+            bool        match;
+
+            oldcontext = MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
+            match = RuntimeFilterCheckSlot(runtimeFilter, slot);
+            MemoryContextSwitchTo(oldcontext);
+            if (!match)
+                continue;
+        }
+
         /*
          * If we are supposed to send the tuple somewhere, do so. (In
          * practice, this is probably always the case at this point.)
@@ -2140,6 +2168,9 @@ ExecutePlan(EState *estate,
 #endif
     }
 
+    if (runtimeFilter != NULL)
+        RuntimeFilterReport(runtimeFilter);
+
     if (use_parallel_mode)
         ExitParallelMode();
 }
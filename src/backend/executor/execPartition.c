@@ -14,12 +14,20 @@
 
 #include "postgres.h"
 
+#include "access/heapam.h"
 #include "catalog/pg_inherits_fn.h"
 #include "executor/execPartition.h"
 #include "executor/executor.h"
 #include "mb/pg_wchar.h"
 #include "miscadmin.h"
+#include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
+#include "optimizer/var.h"
+#include "parser/parsetree.h"
 #include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
 #include "utils/rls.h"
 #include "utils/ruleutils.h"
 
@@ -957,3 +965,217 @@ ExecBuildSlotPartitionKeyDescription(Relation rel,
 
 	return buf.data;
 }
+
+#ifdef __OPENTENBASE__
+static Node *interval_prune_quals_mutator(Node *node,
+							 PartitionPruneState *prunestate);
+
+/*
+ * ExecSetupPartitionPruneState
+ *		Build the state to prune the subplans of 'planstate', an Append or
+ *		MergeAppend, with the information in 'pinfo'.
+ *
+ * The partition key and bounds of a declaratively partitioned table are
+ * copied, so that a relcache rebuild can't pull them from under us.
+ */
+PartitionPruneState *
+ExecSetupPartitionPruneState(PlanState *planstate, PartitionPruneInfo *pinfo)
+{
+	EState	   *estate = planstate->state;
+	PartitionPruneState *prunestate;
+	PartitionPruneContext *context;
+	Relation	rel;
+
+	prunestate = (PartitionPruneState *) palloc0(sizeof(PartitionPruneState));
+	prunestate->pinfo = pinfo;
+	prunestate->planstate = planstate;
+	prunestate->reloid = getrelid(pinfo->rtindex, estate->es_range_table);
+	prunestate->prune_context = AllocSetContextCreate(CurrentMemoryContext,
+													  "Partition Prune",
+													  ALLOCSET_DEFAULT_SIZES);
+	prunestate->do_initial_prune = bms_is_empty(pinfo->execparamids);
+
+	/* the expressions compared to the partition key are evaluated in it */
+	if (planstate->ps_ExprContext == NULL)
+		ExecAssignExprContext(estate, planstate);
+
+	/*
+	 * The scans of the partitions lock them, but not necessarily the
+	 * partitioned table itself, e.g. on a datanode.
+	 */
+	rel = heap_open(prunestate->reloid, AccessShareLock);
+
+	context = &prunestate->context;
+	if (!pinfo->interval)
+	{
+		PartitionKey partkey = RelationGetPartitionKey(rel);
+		PartitionDesc partdesc = RelationGetPartitionDesc(rel);
+		int			partnatts = partkey->partnatts;
+		int			nsteps = 0;
+		int			keyno;
+		ListCell   *lc;
+
+		context->strategy = partkey->strategy;
+		context->partnatts = partnatts;
+		context->partopfamily = (Oid *) palloc(sizeof(Oid) * partnatts);
+		memcpy(context->partopfamily, partkey->partopfamily,
+			   sizeof(Oid) * partnatts);
+		context->partopcintype = (Oid *) palloc(sizeof(Oid) * partnatts);
+		memcpy(context->partopcintype, partkey->partopcintype,
+			   sizeof(Oid) * partnatts);
+		context->partcollation = (Oid *) palloc(sizeof(Oid) * partnatts);
+		memcpy(context->partcollation, partkey->partcollation,
+			   sizeof(Oid) * partnatts);
+		context->partsupfunc = (FmgrInfo *) palloc(sizeof(FmgrInfo) * partnatts);
+		for (keyno = 0; keyno < partnatts; keyno++)
+			fmgr_info_copy(&context->partsupfunc[keyno],
+						   &partkey->partsupfunc[keyno],
+						   CurrentMemoryContext);
+		context->nparts = partdesc->nparts;
+		context->boundinfo = partition_bounds_copy(partdesc->boundinfo, partkey);
+
+		/*
+		 * Prepare the evaluation of the expressions of the steps.  Those
+		 * referencing the scanned table, or a SubPlan, can't be evaluated
+		 * above the scans, so the steps behave as if there were no value.
+		 */
+		foreach(lc, pinfo->pruning_steps)
+		{
+			PartitionPruneStep *step = (PartitionPruneStep *) lfirst(lc);
+
+			nsteps = Max(nsteps, step->step_id + 1);
+		}
+		context->exprstates = (ExprState **)
+			palloc0(sizeof(ExprState *) * nsteps * partnatts);
+		context->exprcontext = planstate->ps_ExprContext;
+
+		foreach(lc, pinfo->pruning_steps)
+		{
+			PartitionPruneStepOp *opstep = (PartitionPruneStepOp *) lfirst(lc);
+			ListCell   *lc2;
+
+			if (!IsA(opstep, PartitionPruneStepOp))
+				continue;
+
+			lc2 = list_head(opstep->exprs);
+			for (keyno = 0; keyno < partnatts && lc2 != NULL; keyno++)
+			{
+				Expr	   *expr;
+
+				/* no expression for these, see perform_pruning_base_step */
+				if (bms_is_member(keyno, opstep->nullkeys))
+					continue;
+
+				expr = (Expr *) lfirst(lc2);
+				if (!IsA(expr, Const) &&
+					!contain_var_clause((Node *) expr) &&
+					!contain_subplans((Node *) expr))
+					context->exprstates[PruneCxtStateIdx(partnatts,
+														 opstep->step.step_id,
+														 keyno)] =
+						ExecInitExpr(expr, planstate);
+
+				lc2 = lnext(lc2);
+			}
+		}
+	}
+
+	heap_close(rel, NoLock);
+
+	return prunestate;
+}
+
+/*
+ * ExecFindMatchingSubPlans
+ *		Return the indexes, in the list of subplans of the Append or
+ *		MergeAppend, of the subplans that may return rows for the current
+ *		values of the Params.  Subplans that don't scan a partition of the
+ *		table are always part of the result.
+ */
+Bitmapset *
+ExecFindMatchingSubPlans(PartitionPruneState *prunestate)
+{
+	PartitionPruneInfo *pinfo = prunestate->pinfo;
+	MemoryContext oldcontext;
+	Bitmapset  *partindexes;
+	Bitmapset  *result = NULL;
+	ListCell   *lc;
+	int			i;
+
+	oldcontext = MemoryContextSwitchTo(prunestate->prune_context);
+
+	if (pinfo->interval)
+	{
+		Relation	rel = heap_open(prunestate->reloid, NoLock);
+		List	   *quals;
+
+		quals = (List *) interval_prune_quals_mutator((Node *) pinfo->prune_quals,
+													  prunestate);
+		partindexes = RelationGetPartitionsByQuals(rel, quals);
+		heap_close(rel, NoLock);
+	}
+	else
+		partindexes = get_matching_partitions(&prunestate->context,
+											  pinfo->pruning_steps);
+
+	MemoryContextSwitchTo(oldcontext);
+
+	i = 0;
+	foreach(lc, pinfo->subplan_parts)
+	{
+		int			partidx = lfirst_int(lc);
+
+		if (partidx < 0 || bms_is_member(partidx, partindexes))
+			result = bms_add_member(result, i);
+		i++;
+	}
+
+	MemoryContextReset(prunestate->prune_context);
+	ResetExprContext(prunestate->planstate->ps_ExprContext);
+
+	return result;
+}
+
+/*
+ * Replace the expressions compared to the interval partition key by Consts
+ * holding their current values, as RelationGetPartitionsByQuals only knows
+ * about Consts.  A NULL value is left alone, which prunes nothing.  As for
+ * the steps of a declaratively partitioned table, a SubPlan can't be
+ * evaluated above the scans, so an expression containing one is left alone
+ * too.
+ */
+static Node *
+interval_prune_quals_mutator(Node *node, PartitionPruneState *prunestate)
+{
+	if (node == NULL)
+		return NULL;
+
+	if (IsA(node, SubPlan) || IsA(node, AlternativeSubPlan))
+		return node;
+
+	if (!IsA(node, Const) && !IsA(node, List) && !contain_var_clause(node) &&
+		!contain_subplans(node))
+	{
+		ExprState  *exprstate;
+		Datum		value;
+		bool		isnull;
+		int16		typlen;
+		bool		typbyval;
+
+		exprstate = ExecInitExpr((Expr *) node, prunestate->planstate);
+		value = ExecEvalExprSwitchContext(exprstate,
+										  prunestate->planstate->ps_ExprContext,
+										  &isnull);
+		if (isnull)
+			return node;
+
+		get_typlenbyval(exprType(node), &typlen, &typbyval);
+		return (Node *) makeConst(exprType(node), exprTypmod(node),
+								  exprCollation(node), typlen, value,
+								  false, typbyval);
+	}
+
+	return expression_tree_mutator(node, interval_prune_quals_mutator,
+								   (void *) prunestate);
+}
+#endif
@@ -91,6 +91,7 @@
 #include "executor/nodeGroup.h"
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
+#include "executor/nodeIncrementalSort.h"
 #include "executor/nodeIndexonlyscan.h"
 #include "executor/nodeIndexscan.h"
 #include "executor/nodeLimit.h"
@@ -324,6 +325,11 @@ ExecInitNode(Plan *node, EState *estate, int eflags)
                                                 estate, eflags);
             break;
 
+        case T_IncrementalSort:
+            result = (PlanState *) ExecInitIncrementalSort((IncrementalSort *) node,
+                                                           estate, eflags);
+            break;
+
         case T_Group:
             result = (PlanState *) ExecInitGroup((Group *) node,
                                                  estate, eflags);
@@ -788,6 +794,10 @@ ExecEndNode(PlanState *node)
             ExecEndSort((SortState *) node);
             break;
 
+        case T_IncrementalSortState:
+            ExecEndIncrementalSort((IncrementalSortState *) node);
+            break;
+
         case T_GroupState:
             ExecEndGroup((GroupState *) node);
             break;
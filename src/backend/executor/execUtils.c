@@ -49,6 +49,7 @@
 #include "access/relscan.h"
 #include "access/transam.h"
 #include "executor/executor.h"
+#include "jit/jit.h"
 #include "mb/pg_wchar.h"
 #include "nodes/nodeFuncs.h"
 #include "parser/parsetree.h"
@@ -205,6 +206,13 @@ FreeExecutorState(EState *estate)
         /* FreeExprContext removed the list link for us */
     }
 
+    /* release JIT context, if allocated */
+    if (estate->es_jit)
+    {
+        jit_release_context(estate->es_jit);
+        estate->es_jit = NULL;
+    }
+
     /*
      * Free the per-query memory context, thereby releasing all working
      * memory, including the EState node itself.
@@ -63,9 +63,15 @@
 #include "executor/execdebug.h"
 #include "executor/nodeAppend.h"
 #include "miscadmin.h"
+#ifdef __OPENTENBASE__
+#include "executor/execPartition.h"
+#endif
 
 static TupleTableSlot *ExecAppend(PlanState *pstate);
 static bool exec_append_initialize_next(AppendState *appendstate);
+#ifdef __OPENTENBASE__
+static void exec_append_prune_subplans(AppendState *appendstate);
+#endif
 
 
 /* ----------------------------------------------------------------
@@ -96,12 +102,21 @@ exec_append_initialize_next(AppendState *appendstate)
         appendstate->as_whichplan = 0;
         return FALSE;
     }
+#ifdef __OPENTENBASE__
+    else if (whichplan >= appendstate->as_nvalid)
+    {
+        /*
+         * as above, end the scan if we go beyond the last scan in our list..
+         */
+        appendstate->as_whichplan = appendstate->as_nvalid - 1;
+#else
     else if (whichplan >= appendstate->as_nplans)
     {
         /*
          * as above, end the scan if we go beyond the last scan in our list..
          */
         appendstate->as_whichplan = appendstate->as_nplans - 1;
+#endif
         return FALSE;
     }
     else
@@ -110,10 +125,41 @@ exec_append_initialize_next(AppendState *appendstate)
     }
 }
 
+#ifdef __OPENTENBASE__
+/* ----------------------------------------------------------------
+ *        exec_append_prune_subplans
+ *
+ *        Computes the subplans left after pruning the partitions that
+ *        can't match the current values of the Params.
+ * ----------------------------------------------------------------
+ */
+static void
+exec_append_prune_subplans(AppendState *appendstate)
+{
+    Bitmapset  *validsubplans;
+    int            i;
+
+    validsubplans = ExecFindMatchingSubPlans(appendstate->as_prune_state);
+
+    appendstate->as_nvalid = 0;
+    for (i = 0; i < appendstate->as_nplans; i++)
+    {
+        if (bms_is_member(appendstate->as_plannos[i], validsubplans))
+            appendstate->as_valid_plans[appendstate->as_nvalid++] = i;
+    }
+    bms_free(validsubplans);
+
+    appendstate->as_prune_pending = false;
+    appendstate->as_whichplan = 0;
+    exec_append_initialize_next(appendstate);
+}
+#endif
+
 /* ----------------------------------------------------------------
  *        ExecInitAppend
  *
- *        Begin all of the subscans of the append node.
+ *        Begin all of the subscans of the append node, but those of the
+ *        partitions pruned by the values of the Params known at startup.
  *
  *       (This is potentially wasteful, since the entire result of the
  *        append node may not be scanned, but this way all of the
@@ -129,6 +175,12 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
     int            nplans;
     int            i;
     ListCell   *lc;
+#ifdef __OPENTENBASE__
+    Bitmapset  *validsubplans = NULL;
+    bool        initial_pruned = false;
+    bool        all_pruned = false;
+    int            planno;
+#endif
 
     /* check for unsupported flags */
     Assert(!(eflags & EXEC_FLAG_MARK));
@@ -168,6 +220,44 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
      */
     ExecInitResultTupleSlot(estate, &appendstate->ps);
 
+#ifdef __OPENTENBASE__
+    /*
+     * If the partitions to scan only depend on values known at startup,
+     * prune now and don't even initialize the other subplans.  Otherwise,
+     * prune before the first scan and whenever the Params change.
+     */
+    if (node->part_prune_info != NULL)
+    {
+        PartitionPruneState *prunestate;
+
+        prunestate = ExecSetupPartitionPruneState(&appendstate->ps,
+                                                  node->part_prune_info);
+        if (prunestate->do_initial_prune)
+        {
+            validsubplans = ExecFindMatchingSubPlans(prunestate);
+            initial_pruned = true;
+
+            /*
+             * Still initialize one subplan, EXPLAIN needs one to deparse the
+             * target list, but never run it.
+             */
+            if (bms_is_empty(validsubplans))
+            {
+                validsubplans = bms_make_singleton(0);
+                all_pruned = true;
+            }
+        }
+        else
+        {
+            appendstate->as_prune_state = prunestate;
+            appendstate->as_prune_pending = true;
+        }
+    }
+    appendstate->as_plannos = (int *) palloc(Max(nplans, 1) * sizeof(int));
+    appendstate->as_valid_plans = (int *) palloc(Max(nplans, 1) * sizeof(int));
+    planno = 0;
+#endif
+
     /*
      * call ExecInitNode on each of the plans to be executed and save the
      * results into the array "appendplans".
@@ -176,15 +266,34 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
     foreach(lc, node->appendplans)
     {
         Plan       *initNode = (Plan *) lfirst(lc);
+		PlanState *ret;
 
-		PlanState *ret = ExecInitNode(initNode, estate, eflags);
+#ifdef __OPENTENBASE__
+		if (initial_pruned && !bms_is_member(planno, validsubplans))
+		{
+			planno++;
+			continue;
+		}
+#endif
+		ret = ExecInitNode(initNode, estate, eflags);
 		if (ret)
 		{
 			appendplanstates[i] = ret;
+#ifdef __OPENTENBASE__
+			appendstate->as_plannos[i] = planno;
+			appendstate->as_valid_plans[i] = i;
+#endif
 			i++;
 		}
+#ifdef __OPENTENBASE__
+		planno++;
+#endif
     }
 	appendstate->as_nplans = i;
+#ifdef __OPENTENBASE__
+	appendstate->as_nvalid = all_pruned ? 0 : i;
+	bms_free(validsubplans);
+#endif
 
     /*
      * initialize output tuple type
@@ -212,6 +321,15 @@ ExecAppend(PlanState *pstate)
 {
     AppendState *node = castNode(AppendState, pstate);
 
+#ifdef __OPENTENBASE__
+    if (node->as_prune_pending)
+        exec_append_prune_subplans(node);
+
+    /* every partition pruned */
+    if (node->as_nvalid == 0)
+        return ExecClearTuple(node->ps.ps_ResultTupleSlot);
+#endif
+
     for (;;)
     {
         PlanState  *subnode;
@@ -222,7 +340,11 @@ ExecAppend(PlanState *pstate)
         /*
          * figure out which subplan we are currently processing
          */
+#ifdef __OPENTENBASE__
+        subnode = node->appendplans[node->as_valid_plans[node->as_whichplan]];
+#else
         subnode = node->appendplans[node->as_whichplan];
+#endif
 
         /*
          * get a tuple from the subplan
@@ -288,6 +410,14 @@ ExecReScanAppend(AppendState *node)
 {
     int            i;
 
+#ifdef __OPENTENBASE__
+    /* prune again before the next scan if the Params it depends on changed */
+    if (node->as_prune_state != NULL &&
+        bms_overlap(node->ps.chgParam,
+                    node->as_prune_state->pinfo->execparamids))
+        node->as_prune_pending = true;
+#endif
+
     for (i = 0; i < node->as_nplans; i++)
     {
         PlanState  *subnode = node->appendplans[i];
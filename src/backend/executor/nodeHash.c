@@ -40,6 +40,7 @@
 #include "utils/syscache.h"
 #ifdef __OPENTENBASE__
 #include "executor/execParallel.h"
+#include "executor/runtimefilter.h"
 #include "pgxc/nodemgr.h"
 #include "optimizer/cost.h"
 #endif
@@ -47,6 +48,16 @@
 #ifdef __OPENTENBASE__
 #define HASH_BUCKET_THRESHOLD  1048576
 #define HASH_BATCH_THRESHOLD   32
+
+/*
+ * A shared hashtable may have up to this many times as many batches as
+ * planned, within the limit of HASH_SHM_MAX_BATCHES.
+ */
+#define HASH_SHM_BATCH_GROWTH  256
+#define HASH_SHM_MAX_BATCHES   (1 << 20)
+
+/* number of buckets a worker claims at a time to repartition them */
+#define HASH_SHM_REPARTITION_BUCKETS  65536
 #endif
 
 static void ExecHashIncreaseNumBatches(HashJoinTable hashtable);
@@ -137,6 +148,10 @@ MultiExecHash(HashState *node)
                 ExecHashTableInsert(hashtable, slot, hashvalue);
             }
             hashtable->totalTuples += 1;
+#ifdef __OPENTENBASE__
+            if (hashtable->runtimeFilter)
+                RuntimeFilterAdd(hashtable->runtimeFilter, hashvalue);
+#endif
         }
     }
 
@@ -274,45 +289,10 @@ ExecHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
      */
     outerNode = outerPlan(node);
 
-#ifdef __OPENTENBASE__
-    if(IsParallelWorker() && node->plan.parallel_aware)
-    {
-        double plan_rows = outerNode->plan_rows;// * max_parallel_workers_per_gather;
-        double mynbatch  = 0.0;
-        
-        ExecChooseHashTableSize(plan_rows, outerNode->plan_width,
-                        false,
-                        &nbuckets, &nbatch, &num_skew_mcvs);
-
-        if (nbuckets < HASH_BUCKET_THRESHOLD)
-            nbuckets = HASH_BUCKET_THRESHOLD;
-
-        /* 
-          * In parallel mode, nbuckets and nbatch can not be changed.
-          * Need to estimate both appropriate value.
-          */
-        mynbatch = ceil(plan_rows / nbuckets);
-
-        /* ... and force it to be a power of 2. */
-        mynbatch = 1 << my_log2((long)mynbatch);
-        
-        nbatch = Max(nbatch, mynbatch);
-
-        
-        //if (nbatch < HASH_BATCH_THRESHOLD)
-        //    nbatch   = nbatch   * max_parallel_workers_per_gather;
-
-        //nbuckets = nbuckets * NumDataNodes * max_parallel_workers_per_gather;
-    }
-    else
-    {
-#endif
     ExecChooseHashTableSize(outerNode->plan_rows, outerNode->plan_width,
                             OidIsValid(node->skewTable),
                             &nbuckets, &nbatch, &num_skew_mcvs);
-#ifdef __OPENTENBASE__
-    }
-#endif
+
     /* nbuckets must be a power of 2 */
     log2_nbuckets = my_log2(nbuckets);
     Assert(nbuckets == (1 << log2_nbuckets));
@@ -352,6 +332,11 @@ ExecHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
     hashtable->spaceAllowedSkew =
         hashtable->spaceAllowed * SKEW_WORK_MEM_PERCENT / 100;
     hashtable->chunks = NULL;
+#ifdef __OPENTENBASE__
+    hashtable->shmBuckets = NULL;
+    hashtable->shmChunks = InvalidDsaPointer;
+    hashtable->runtimeFilter = NULL;
+#endif
 
 #ifdef HJDEBUG
     printf("Hashjoin %p: initial nbatch = %d, nbuckets = %d\n",
@@ -422,9 +407,6 @@ ExecHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
 
     hashtable->buckets = (HashJoinTuple *)
         palloc0(nbuckets * sizeof(HashJoinTuple));
-#ifdef __OPENTENBASE__
-    hashtable->bucket_wNum = (int *)palloc0(nbuckets * sizeof(int));
-#endif
     /*
      * Set up for skew optimization, if possible and there's a need for more
      * than one batch.  (In a one-batch join, there's no point in it.)
@@ -438,6 +420,48 @@ ExecHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
 }
 
 
+#ifdef __OPENTENBASE__
+/*
+ * ExecHashTableInitRuntimeFilter
+ *
+ *        Set up a bloom filter over the hash values of the inner tuples, for
+ *        MultiExecHash to fill in.  outerkeys are the outer hash keys of the
+ *        join, all plain Vars, which the filter is to be applied to.
+ */
+void
+ExecHashTableInitRuntimeFilter(HashJoinTable hashtable, Hash *node,
+                               List *outerkeys)
+{
+    Plan       *outerNode = outerPlan(node);
+    RuntimeFilter *filter;
+    MemoryContext oldcxt;
+    ListCell   *lc;
+    int            i;
+
+    oldcxt = MemoryContextSwitchTo(hashtable->hashCxt);
+    filter = RuntimeFilterCreate(list_length(outerkeys), outerNode->plan_rows);
+    MemoryContextSwitchTo(oldcxt);
+
+    /* not worth it if the inner side is too large */
+    if (filter == NULL)
+        return;
+
+    i = 0;
+    foreach(lc, outerkeys)
+    {
+        Var           *var = castNode(Var, ((ExprState *) lfirst(lc))->expr);
+
+        filter->keys[i].attno = var->varattno;
+        filter->keys[i].typid = var->vartype;
+        filter->keys[i].hashfn = hashtable->outer_hashfunctions[i].fn_oid;
+        filter->keys[i].strict = hashtable->hashStrict[i];
+        i++;
+    }
+
+    hashtable->runtimeFilter = filter;
+}
+#endif
+
 /*
  * Compute appropriate size for hashtable given the estimated size of the
  * relation to be hashed (number of rows and average row width).
@@ -1118,9 +1142,7 @@ ExecScanHashBucket(HashJoinState *hjstate,
     HashJoinTable hashtable = hjstate->hj_HashTable;
     HashJoinTuple hashTuple = hjstate->hj_CurTuple;
     uint32        hashvalue = hjstate->hj_CurHashValue;
-#ifdef __OPENTENBASE__
-    HashState  *hashNode = (HashState *) innerPlanState(hjstate);
-#endif
+
     /*
      * hj_CurTuple is the address of the tuple last returned from the current
      * bucket, or NULL if it's time to start scanning a new bucket.
@@ -1129,22 +1151,15 @@ ExecScanHashBucket(HashJoinState *hjstate,
      * otherwise scan the standard hashtable bucket.
      */
 #ifdef __OPENTENBASE__
-    if(IsParallelWorker() && hashtable->curbatch == 0 && hashNode->ps.plan->parallel_aware)
+    if (hashtable->shmBuckets != NULL)
     {
-        dsa_area *dsa = NULL;
-        
+        dsa_area   *dsa = GetNumWorkerDsa(0);
+
         if (hashTuple != NULL)
-        {
-            dsa = GetNumWorkerDsa(hashTuple->workerNumber);
-            hashTuple = (HashJoinTuple)dsa_get_address(dsa, (dsa_pointer)hashTuple->next);
-        }
-        else if (hjstate->hj_CurSkewBucketNo != INVALID_SKEW_BUCKET_NO)
-            hashTuple = hashtable->skewBucket[hjstate->hj_CurSkewBucketNo]->tuples;
+            hashTuple = (HashJoinTuple) dsa_get_address(dsa, (dsa_pointer) hashTuple->next);
         else
-        {
-            dsa = GetNumWorkerDsa(hashtable->bucket_wNum[hjstate->hj_CurBucketNo]);
-            hashTuple = (HashJoinTuple)dsa_get_address(dsa, (dsa_pointer)hashtable->buckets[hjstate->hj_CurBucketNo]);
-        }
+            hashTuple = (HashJoinTuple)
+                dsa_get_address(dsa, dsa_pointer_atomic_read(&hashtable->shmBuckets[hjstate->hj_CurBucketNo]));
 
         while (hashTuple != NULL)
         {
@@ -1168,15 +1183,7 @@ ExecScanHashBucket(HashJoinState *hjstate,
                 }
             }
 
-            if(hashTuple->next)
-            {
-                dsa = GetNumWorkerDsa(hashTuple->workerNumber);
-                hashTuple = (HashJoinTuple)dsa_get_address(dsa, (dsa_pointer)hashTuple->next);
-            }
-            else
-            {
-                hashTuple = NULL;
-            }
+            hashTuple = (HashJoinTuple) dsa_get_address(dsa, (dsa_pointer) hashTuple->next);
         }
     }
     else
@@ -1240,6 +1247,16 @@ ExecPrepHashTableForUnmatched(HashJoinState *hjstate)
     hjstate->hj_CurBucketNo = 0;
     hjstate->hj_CurSkewBucketNo = 0;
     hjstate->hj_CurTuple = NULL;
+#ifdef __OPENTENBASE__
+    /* each worker scans its own range of the buckets of a shared hashtable */
+    if (hjstate->hj_HashTable->shmBuckets != NULL)
+    {
+        int            nWorkers = hjstate->hj_parallelState->numLaunchedParallelWorkers;
+
+        hjstate->hj_CurBucketNo = (int) (((int64) hjstate->hj_HashTable->nbuckets *
+                                          ParallelWorkerNumber) / nWorkers);
+    }
+#endif
 }
 
 /*
@@ -1255,85 +1272,59 @@ ExecScanHashTableForUnmatched(HashJoinState *hjstate, ExprContext *econtext)
 {// #lizard forgives
     HashJoinTable hashtable = hjstate->hj_HashTable;
     HashJoinTuple hashTuple = hjstate->hj_CurTuple;
-#ifdef __OPENTENBASE__
-    HashState  *hashNode = (HashState *) innerPlanState(hjstate);
-#endif
 
 #ifdef __OPENTENBASE__
-     /* 
-      * parallel right/full join 
-      */
-    if(IsParallelWorker() && hjstate->hj_parallelState && hashtable->curbatch == 0 &&
-        hashNode->ps.plan->parallel_aware)
+    /*
+     * parallel right/full join: the buckets of the shared hashtable are
+     * divided among the workers, see ExecPrepHashTableForUnmatched.
+     */
+    if (hashtable->shmBuckets != NULL)
     {
-        if (ParallelWorkerNumber == 0)
+        dsa_area   *dsa = GetNumWorkerDsa(0);
+        int            nWorkers = hjstate->hj_parallelState->numLaunchedParallelWorkers;
+        int            endBucket;
+
+        endBucket = (int) (((int64) hashtable->nbuckets * (ParallelWorkerNumber + 1)) / nWorkers);
+
+        for (;;)
         {
-            dsa_area *dsa = NULL;
-        
-            for (;;)
+            if (hashTuple != NULL)
+                hashTuple = (HashJoinTuple) dsa_get_address(dsa, (dsa_pointer) hashTuple->next);
+            else if (hjstate->hj_CurBucketNo < endBucket)
             {
-                if (hashTuple != NULL)
-                {
-                    dsa = GetNumWorkerDsa(hashTuple->workerNumber);
-                    hashTuple = (HashJoinTuple)dsa_get_address(dsa, (dsa_pointer)hashTuple->next);
-                }
-                else if (hjstate->hj_CurBucketNo < hashtable->nbuckets)
-                {
-                    dsa = GetNumWorkerDsa(hashtable->bucket_wNum[hjstate->hj_CurBucketNo]);
-                    hashTuple = (HashJoinTuple)dsa_get_address(dsa, (dsa_pointer)hashtable->buckets[hjstate->hj_CurBucketNo]);
-                
-                    hjstate->hj_CurBucketNo++;
-                }
-                /* no skewbuckets */
-                else if (hjstate->hj_CurSkewBucketNo < hashtable->nSkewBuckets)
+                hashTuple = (HashJoinTuple)
+                    dsa_get_address(dsa, dsa_pointer_atomic_read(&hashtable->shmBuckets[hjstate->hj_CurBucketNo]));
+                hjstate->hj_CurBucketNo++;
+            }
+            else
+                break;                /* finished all buckets */
+
+            while (hashTuple != NULL)
+            {
+                if (!HeapTupleHeaderHasMatch(HJTUPLE_MINTUPLE(hashTuple)))
                 {
-                    int            j = hashtable->skewBucketNums[hjstate->hj_CurSkewBucketNo];
+                    TupleTableSlot *inntuple;
 
-                    hashTuple = hashtable->skewBucket[j]->tuples;
-                    hjstate->hj_CurSkewBucketNo++;
-                }
-                else
-                    break;                /* finished all buckets */
+                    /* insert hashtable's tuple into exec slot */
+                    inntuple = ExecStoreMinimalTuple(HJTUPLE_MINTUPLE(hashTuple),
+                                                     hjstate->hj_HashTupleSlot,
+                                                     false);    /* do not pfree */
+                    econtext->ecxt_innertuple = inntuple;
 
-                while (hashTuple != NULL)
-                {
-                    if (!HeapTupleHeaderHasMatch(HJTUPLE_MINTUPLE(hashTuple)))
-                    {
-                        TupleTableSlot *inntuple;
-
-                        /* insert hashtable's tuple into exec slot */
-                        inntuple = ExecStoreMinimalTuple(HJTUPLE_MINTUPLE(hashTuple),
-                                                         hjstate->hj_HashTupleSlot,
-                                                         false);    /* do not pfree */
-                        econtext->ecxt_innertuple = inntuple;
-
-                        /*
-                         * Reset temp memory each time; although this function doesn't
-                         * do any qual eval, the caller will, so let's keep it
-                         * parallel to ExecScanHashBucket.
-                         */
-                        ResetExprContext(econtext);
-
-                        hjstate->hj_CurTuple = hashTuple;
-                        return true;
-                    }
-
-                    if(hashTuple->next)
-                    {
-                        dsa = GetNumWorkerDsa(hashTuple->workerNumber);
-                        hashTuple = (HashJoinTuple)dsa_get_address(dsa, (dsa_pointer)hashTuple->next);
-                    }
-                    else
-                    {
-                        hashTuple = NULL;
-                    }
+                    /*
+                     * Reset temp memory each time; although this function doesn't
+                     * do any qual eval, the caller will, so let's keep it
+                     * parallel to ExecScanHashBucket.
+                     */
+                    ResetExprContext(econtext);
+
+                    hjstate->hj_CurTuple = hashTuple;
+                    return true;
                 }
+
+                hashTuple = (HashJoinTuple) dsa_get_address(dsa, (dsa_pointer) hashTuple->next);
             }
         }
-        else
-        {
-            return false;
-        }
     }
     else
     {
@@ -2026,378 +2017,229 @@ dense_alloc(HashJoinTable hashtable, Size size)
     /* return pointer to the start of the tuple memory */
     return ptr;
 }
+
 #ifdef __OPENTENBASE__
+/*
+ * Add a chunk allocated for batch 0 of the shared hashtable to its size, and
+ * double the number of batches of all the workers if the size goes over the
+ * work_mem of all of them.  The tuples of the table itself are not moved
+ * before all the workers are done inserting, see ExecShmHashTableRepartition,
+ * so about half of them are simply assumed to have left batch 0, as they do
+ * on average.
+ */
 static void
-ExecShmHashSkewTableInsert(HashJoinTable hashtable,
-                        TupleTableSlot *slot,
-                        uint32 hashvalue,
-                        int bucketNumber)
+shm_account_chunk(HashJoinTable hashtable, Size size)
 {
-    MinimalTuple tuple = ExecFetchSlotMinimalTuple(slot);
-    HashJoinTuple hashTuple;
-    int            hashTupleSize;
+    ParallelHashJoinGrowth *growth = hashtable->shmGrowth;
+    uint32        nbatch;
 
-    /* Create the HashJoinTuple */
-    hashTupleSize = HJTUPLE_OVERHEAD + tuple->t_len;
-    hashTuple = (HashJoinTuple) ParallelWorkerShmAlloc(hashTupleSize, false);
-    hashTuple->hashvalue = hashvalue;
-    memcpy(HJTUPLE_MINTUPLE(hashTuple), tuple, tuple->t_len);
-    HeapTupleHeaderClearMatch(HJTUPLE_MINTUPLE(hashTuple));
+    if (!hashtable->growEnabled)
+        return;
 
-    /* Push it onto the front of the skew bucket's list */
-    hashTuple->next = hashtable->skewBucket[bucketNumber]->tuples;
+    if (pg_atomic_add_fetch_u64(&growth->spaceUsed, size) <= growth->spaceAllowed)
+        return;
 
-    /* put the tail into the skew bucket tail's list */
-    if(hashtable->skewBucket[bucketNumber]->tuples == NULL)
+    nbatch = pg_atomic_read_u32(&growth->nbatch);
+    if (nbatch < (uint32) growth->maxbatch &&
+        pg_atomic_compare_exchange_u32(&growth->nbatch, &nbatch, nbatch * 2))
     {
-        hashtable->skewBucket_tail[bucketNumber]->tuples = hashTuple;
+#ifdef HJDEBUG
+        printf("Hashjoin %p: increasing shared nbatch to %u\n",
+               hashtable, nbatch * 2);
+#endif
+        pg_atomic_fetch_sub_u64(&growth->spaceUsed,
+                                pg_atomic_read_u64(&growth->spaceUsed) / 2);
     }
-    
-    hashtable->skewBucket[bucketNumber]->tuples = hashTuple;
+}
 
-    /* Account for space used, and back off if we've used too much */
-    hashtable->spaceUsed += hashTupleSize;
-    hashtable->spaceUsedSkew += hashTupleSize;
-    if (hashtable->spaceUsed > hashtable->spacePeak)
-        hashtable->spacePeak = hashtable->spaceUsed;
+/*
+ * Free a list of chunks of the shared hashtable.
+ */
+static void
+shm_free_chunks(dsa_pointer chunks)
+{
+    dsa_area   *dsa = GetNumWorkerDsa(0);
 
-    while (hashtable->spaceUsedSkew > hashtable->spaceAllowedSkew)
-        ExecHashRemoveNextSkewBucket(hashtable);
+    while (DsaPointerIsValid(chunks))
+    {
+        HashShmChunk chunk = (HashShmChunk) dsa_get_address(dsa, chunks);
+        dsa_pointer next = chunk->next;
+
+        dsa_free(dsa, chunks);
+        chunks = next;
+    }
 }
 
-static void
-ExecShmHashTableInsert(HashJoinTable hashtable,
-                    TupleTableSlot *slot,
-                    uint32 hashvalue)
-{// #lizard forgives
-    MinimalTuple tuple = ExecFetchSlotMinimalTuple(slot);
-    int            bucketno;
-    int            batchno;
-    dsa_pointer dp;
-    dsa_area * dsa = GetNumWorkerDsa(ParallelWorkerNumber);
+/*
+ * Allocate space for a tuple of the shared hashtable, the counterpart of
+ * dense_alloc: tuples are packed in chunks of the dsa area of the first
+ * worker, and *dp is set to the dsa_pointer of the returned space.
+ */
+static void *
+shm_dense_alloc(HashJoinTable hashtable, Size size, dsa_pointer *dp)
+{
+    dsa_area   *dsa = GetNumWorkerDsa(0);
+    HashShmChunk chunk = NULL;
+    HashShmChunk newChunk;
+    dsa_pointer newChunk_dp;
+    char       *ptr;
 
-    ExecHashGetBucketAndBatch(hashtable, hashvalue,
-                              &bucketno, &batchno);
+    /* just in case the size is not already aligned properly */
+    size = MAXALIGN(size);
+
+    if (DsaPointerIsValid(hashtable->shmChunks))
+        chunk = (HashShmChunk) dsa_get_address(dsa, hashtable->shmChunks);
 
     /*
-     * decide whether to put the tuple in the hash table or a temp file
+     * If tuple size is larger than of 1/4 of chunk size, allocate a separate
+     * chunk, and link it after the current one so that we keep filling it.
      */
-    if (batchno == hashtable->curbatch)
+    if (size > HASH_CHUNK_THRESHOLD)
     {
-        /*
-         * put the tuple in hash table
-         */
-        HashJoinTuple hashTuple;
-        int            hashTupleSize;
-        double        ntuples = (hashtable->totalTuples - hashtable->skewTuples);
-        HashJoinTupleData **buckets;
-        HashJoinTupleData **buckets_tail;
-        int *tail_wnum;
-        /*
-          * TODO:we can compress the minimaltup here, so more data
-          * can be stored in memory, this may make join more efficient
-          */
-        
-        /* Create the HashJoinTuple */
-        hashTupleSize = HJTUPLE_OVERHEAD + tuple->t_len;
-        dp            = dsa_allocate(dsa, hashTupleSize);
-        hashTuple     = (HashJoinTuple) dsa_get_address(dsa, dp);
-
-        hashTuple->hashvalue    = hashvalue;
-        hashTuple->workerNumber = ParallelWorkerNumber;
-        memcpy(HJTUPLE_MINTUPLE(hashTuple), tuple, tuple->t_len);
-
-        /*
-         * We always reset the tuple-matched flag on insertion.  This is okay
-         * even when reloading a tuple from a batch file, since the tuple
-         * could not possibly have been matched to an outer tuple before it
-         * went into the batch file.
-         */
-        HeapTupleHeaderClearMatch(HJTUPLE_MINTUPLE(hashTuple));
-
-        buckets      = (HashJoinTuple *)dsa_get_address(dsa, (dsa_pointer)hashtable->buckets);
-        buckets_tail = (HashJoinTuple *)dsa_get_address(dsa, (dsa_pointer)hashtable->buckets_tail);
-        tail_wnum    = (int *)dsa_get_address(dsa, (dsa_pointer)hashtable->bucket_tail_wNum);
-        /* Push it onto the front of the bucket's list */
-        hashTuple->next = buckets[bucketno];
+        newChunk_dp = dsa_allocate(dsa, HASH_SHM_CHUNK_HEADER + size);
+        newChunk = (HashShmChunk) dsa_get_address(dsa, newChunk_dp);
+        newChunk->maxlen = size;
+        newChunk->used = size;
+        shm_account_chunk(hashtable, HASH_SHM_CHUNK_HEADER + size);
 
-        /* put it to the tail of the bucket's list */
-        if(buckets[bucketno] == NULL)
+        if (chunk != NULL)
         {
-            buckets_tail[bucketno] = (HashJoinTupleData *)dp;
-            tail_wnum[bucketno] = ParallelWorkerNumber;
+            newChunk->next = chunk->next;
+            chunk->next = newChunk_dp;
         }
-        buckets[bucketno] = (HashJoinTupleData *)dp;
-
-        hashtable->spaceUsed += hashTupleSize;
-        if (hashtable->spaceUsed > hashtable->spacePeak)
-            hashtable->spacePeak = hashtable->spaceUsed;
-        if (hashtable->spaceUsed > hashtable->spaceAllowed)
-            
-        /*
-         * Increase the (optimal) number of buckets if we just exceeded the
-         * NTUP_PER_BUCKET threshold, but only when there's still a single
-         * batch.
-         */
-        if (hashtable->nbatch == 1 &&
-            ntuples > (hashtable->nbuckets_optimal * NTUP_PER_BUCKET))
+        else
         {
-            /* Guard against integer overflow and alloc size overflow */
-            if (hashtable->nbuckets_optimal <= INT_MAX / 2 &&
-                hashtable->nbuckets_optimal * 2 <= MaxAllocSize / sizeof(HashJoinTuple))
-            {
-                hashtable->nbuckets_optimal *= 2;
-                hashtable->log2_nbuckets_optimal += 1;
-            }
+            newChunk->next = InvalidDsaPointer;
+            hashtable->shmChunks = newChunk_dp;
         }
 
-        /* Account for space used, and back off if we've used too much */
-        hashtable->spaceUsed += hashTupleSize;
-        if (hashtable->spaceUsed > hashtable->spacePeak)
-            hashtable->spacePeak = hashtable->spaceUsed;
-        if (hashtable->spaceUsed +
-            hashtable->nbuckets_optimal * sizeof(HashJoinTuple)
-            > hashtable->spaceAllowed)
-            ExecHashIncreaseNumBatches(hashtable);
+        *dp = newChunk_dp + HASH_SHM_CHUNK_HEADER;
+        return (char *) newChunk + HASH_SHM_CHUNK_HEADER;
     }
-    else
+
+    /* allocate a new chunk if there is not enough space in the current one */
+    if (chunk == NULL || (chunk->maxlen - chunk->used) < size)
     {
-        /*
-         * put the tuple into a temp file for later batches
-         */
-        Assert(batchno > hashtable->curbatch);
-        ExecHashJoinSaveTuple(tuple,
-                              hashvalue,
-                              &hashtable->innerBatchFile[batchno]);
+        newChunk_dp = dsa_allocate(dsa, HASH_SHM_CHUNK_HEADER + HASH_CHUNK_SIZE);
+        chunk = (HashShmChunk) dsa_get_address(dsa, newChunk_dp);
+        chunk->maxlen = HASH_CHUNK_SIZE;
+        chunk->used = 0;
+        chunk->next = hashtable->shmChunks;
+        hashtable->shmChunks = newChunk_dp;
+        shm_account_chunk(hashtable, HASH_SHM_CHUNK_HEADER + HASH_CHUNK_SIZE);
     }
+
+    *dp = hashtable->shmChunks + HASH_SHM_CHUNK_HEADER + chunk->used;
+    ptr = (char *) chunk + HASH_SHM_CHUNK_HEADER + chunk->used;
+    chunk->used += size;
+
+    return ptr;
 }
 
-#if 0
-static void
-ExecShmHashBuildSkewHash(HashJoinTable hashtable, Hash *node, int mcvsToUse)
-{// #lizard forgives
-    HeapTupleData *statsTuple;
-    AttStatsSlot sslot;
+/* ----------------------------------------------------------------
+ *        ExecShmHashTableChooseSize
+ *
+ *        size the hashtable shared by the workers of a parallel hashjoin.
+ *
+ * The inner plan is partial, so its plan_rows is the share of one worker,
+ * while the shared hashtable holds the tuples of all of them, in the
+ * work_mem of all of them: that is as many batches as for one share in
+ * one work_mem, and as many more buckets as there are workers.  nbuckets
+ * can not be changed once the workers have started to fill the hashtable,
+ * so it is decided by the leader before launching the workers.  nbatch can
+ * be doubled while the workers build the hashtable, up to maxbatch, for
+ * which the shared state of the batches is laid out in advance.
+ * ----------------------------------------------------------------
+ */
+void
+ExecShmHashTableChooseSize(Hash *node, int nworkers,
+                           int *numbuckets, int *numbatches,
+                           int *maxbatches)
+{
+    Plan       *outerNode = outerPlan(node);
+    double      plan_rows = outerNode->plan_rows;
+    double      mynbatch;
+    int            nbuckets;
+    int            nbatch;
+    int            maxbatch;
+    int            num_skew_mcvs;
+    int            i;
 
-    /* Do nothing if planner didn't identify the outer relation's join key */
-    if (!OidIsValid(node->skewTable))
-        return;
-    /* Also, do nothing if we don't have room for at least one skew bucket */
-    if (mcvsToUse <= 0)
-        return;
+    ExecChooseHashTableSize(plan_rows, outerNode->plan_width,
+                            false,
+                            &nbuckets, &nbatch, &num_skew_mcvs);
+
+    for (i = 1; i < nworkers; i <<= 1)
+    {
+        if (nbuckets > INT_MAX / 2 ||
+            (Size) nbuckets * 2 > MaxAllocSize / sizeof(dsa_pointer_atomic))
+            break;
+        nbuckets <<= 1;
+    }
+
+    if (nbuckets < HASH_BUCKET_THRESHOLD)
+        nbuckets = HASH_BUCKET_THRESHOLD;
 
     /*
-     * Try to find the MCV statistics for the outer relation's join key.
+     * Make sure that the buckets are not overloaded in any batch, since
+     * neither of them can grow.
      */
-    statsTuple = SearchSysCache3(STATRELATTINH,
-                                 ObjectIdGetDatum(node->skewTable),
-                                 Int16GetDatum(node->skewColumn),
-                                 BoolGetDatum(node->skewInherit));
-    if (!HeapTupleIsValid(statsTuple))
-        return;
+    mynbatch = ceil(plan_rows * Max(nworkers, 1) / nbuckets);
 
-    if (get_attstatsslot(&sslot, statsTuple,
-                         STATISTIC_KIND_MCV, InvalidOid,
-                         ATTSTATSSLOT_VALUES | ATTSTATSSLOT_NUMBERS))
-    {
-        double        frac;
-        int            nbuckets;
-        FmgrInfo   *hashfunctions;
-        int            i;
+    /* ... and force it to be a power of 2. */
+    mynbatch = 1 << my_log2((long) mynbatch);
 
-        if (mcvsToUse > sslot.nvalues)
-            mcvsToUse = sslot.nvalues;
+    nbatch = Max(nbatch, (int) mynbatch);
 
-        /*
-         * Calculate the expected fraction of outer relation that will
-         * participate in the skew optimization.  If this isn't at least
-         * SKEW_MIN_OUTER_FRACTION, don't use skew optimization.
-         */
-        frac = 0;
-        for (i = 0; i < mcvsToUse; i++)
-            frac += sslot.numbers[i];
-        if (frac < SKEW_MIN_OUTER_FRACTION)
-        {
-            free_attstatsslot(&sslot);
-            ReleaseSysCache(statsTuple);
-            return;
-        }
-
-        /*
-         * Okay, set up the skew hashtable.
-         *
-         * skewBucket[] is an open addressing hashtable with a power of 2 size
-         * that is greater than the number of MCV values.  (This ensures there
-         * will be at least one null entry, so searches will always
-         * terminate.)
-         *
-         * Note: this code could fail if mcvsToUse exceeds INT_MAX/8 or
-         * MaxAllocSize/sizeof(void *)/8, but that is not currently possible
-         * since we limit pg_statistic entries to much less than that.
-         */
-        nbuckets = 2;
-        while (nbuckets <= mcvsToUse)
-            nbuckets <<= 1;
-        /* use two more bits just to help avoid collisions */
-        nbuckets <<= 2;
-
-        hashtable->skewEnabled = true;
-        hashtable->skewBucketLen = nbuckets;
-
-        /*
-         * We allocate the bucket memory in the hashtable's batch context. It
-         * is only needed during the first batch, and this ensures it will be
-         * automatically removed once the first batch is done.
-         */
-        hashtable->skewBucket      = (HashSkewBucket **)
-            ParallelWorkerShmAlloc(nbuckets * sizeof(HashSkewBucket *), true);
-        hashtable->skewBucket_tail = (HashSkewBucket **)
-            ParallelWorkerShmAlloc(nbuckets * sizeof(HashSkewBucket *), true);
-        hashtable->skewBucketNums  = (int *)
-            ParallelWorkerShmAlloc(mcvsToUse * sizeof(int), true);
-
-        hashtable->spaceUsed += nbuckets * sizeof(HashSkewBucket *)
-            + mcvsToUse * sizeof(int);
-        hashtable->spaceUsedSkew += nbuckets * sizeof(HashSkewBucket *)
-            + mcvsToUse * sizeof(int);
-        if (hashtable->spaceUsed > hashtable->spacePeak)
-            hashtable->spacePeak = hashtable->spaceUsed;
-
-        /*
-         * Create a skew bucket for each MCV hash value.
-         *
-         * Note: it is very important that we create the buckets in order of
-         * decreasing MCV frequency.  If we have to remove some buckets, they
-         * must be removed in reverse order of creation (see notes in
-         * ExecHashRemoveNextSkewBucket) and we want the least common MCVs to
-         * be removed first.
-         */
-        hashfunctions = hashtable->outer_hashfunctions;
-
-        for (i = 0; i < mcvsToUse; i++)
-        {
-            uint32        hashvalue;
-            int            bucket;
-
-            hashvalue = DatumGetUInt32(FunctionCall1(&hashfunctions[0],
-                                                     sslot.values[i]));
-
-            /*
-             * While we have not hit a hole in the hashtable and have not hit
-             * the desired bucket, we have collided with some previous hash
-             * value, so try the next bucket location.  NB: this code must
-             * match ExecHashGetSkewBucket.
-             */
-            bucket = hashvalue & (nbuckets - 1);
-            while (hashtable->skewBucket[bucket] != NULL &&
-                   hashtable->skewBucket[bucket]->hashvalue != hashvalue)
-                bucket = (bucket + 1) & (nbuckets - 1);
-
-            /*
-             * If we found an existing bucket with the same hashvalue, leave
-             * it alone.  It's okay for two MCVs to share a hashvalue.
-             */
-            if (hashtable->skewBucket[bucket] != NULL)
-                continue;
-
-            /* Okay, create a new skew bucket for this hashvalue. */
-            hashtable->skewBucket[bucket]      = (HashSkewBucket *)
-                ParallelWorkerShmAlloc(sizeof(HashSkewBucket), false);
-            hashtable->skewBucket_tail[bucket] = (HashSkewBucket *)
-                ParallelWorkerShmAlloc(sizeof(HashSkewBucket), false);
-            hashtable->skewBucket[bucket]->hashvalue      = hashvalue;
-            hashtable->skewBucket_tail[bucket]->hashvalue = hashvalue;
-            hashtable->skewBucket[bucket]->tuples      = NULL;
-            hashtable->skewBucket_tail[bucket]->tuples = NULL;
-            hashtable->skewBucketNums[hashtable->nSkewBuckets] = bucket;
-            hashtable->nSkewBuckets++;
-            hashtable->spaceUsed += SKEW_BUCKET_OVERHEAD;
-            hashtable->spaceUsedSkew += SKEW_BUCKET_OVERHEAD;
-            if (hashtable->spaceUsed > hashtable->spacePeak)
-                hashtable->spacePeak = hashtable->spaceUsed;
-        }
-
-        free_attstatsslot(&sslot);
-    }
+    maxbatch = nbatch;
+    for (i = 1; i < HASH_SHM_BATCH_GROWTH && maxbatch < HASH_SHM_MAX_BATCHES; i <<= 1)
+        maxbatch <<= 1;
 
-    ReleaseSysCache(statsTuple);
+    *numbuckets = nbuckets;
+    *numbatches = nbatch;
+    *maxbatches = maxbatch;
 }
-#endif
 
 /* ----------------------------------------------------------------
  *        ExecShmHashTableCreate
  *
- *        create an empty share-hashtable data structure for hashjoin.
+ *        create the hashtable of a worker of a parallel hashjoin, over the
+ *        bucket array shared by all workers, see ExecShmHashTableChooseSize.
+ *        The number of batches may grow as long as growth is shared.
  * ----------------------------------------------------------------
  */
 HashJoinTable
-ExecShmHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
+ExecShmHashTableCreate(List *hashOperators, bool keepNulls,
+                       int nbuckets, int nbatch, dsa_pointer_atomic *buckets,
+                       ParallelHashJoinGrowth *growth)
 {
     HashJoinTable hashtable;
-    Plan       *outerNode;
-    int            nbuckets;
-    int            nbatch;
-    int            num_skew_mcvs;
     int            log2_nbuckets;
     int            nkeys;
     int            i;
-    double      plan_rows;
     ListCell   *ho;
     MemoryContext oldcxt;
-    dsa_pointer dp;
-    dsa_pointer dp_buckets;
-    dsa_pointer dp_wnum;
-    dsa_area * dsa = GetNumWorkerDsa(ParallelWorkerNumber);
-    double mynbatch  = 0.0;
-
-    /*
-     * Get information about the size of the relation to be hashed (it's the
-     * "outer" subtree of this node, but the inner relation of the hashjoin).
-     * Compute the appropriate size of the hash table.
-     */
-    outerNode = outerPlan(node);
-
-    plan_rows = outerNode->plan_rows;// * max_parallel_workers_per_gather;
-        
-    ExecChooseHashTableSize(plan_rows, outerNode->plan_width,
-                            false,
-                            &nbuckets, &nbatch, &num_skew_mcvs);
-
-    if (nbuckets < HASH_BUCKET_THRESHOLD)
-        nbuckets = HASH_BUCKET_THRESHOLD;
-
-    /* 
-      * In parallel mode, nbuckets and nbatch can not be changed.
-      * Need to estimate both appropriate value.
-      */
-    mynbatch = ceil(plan_rows / nbuckets);
-
-    /* ... and force it to be a power of 2. */
-    mynbatch = 1 << my_log2((long)mynbatch);
-    
-    nbatch = Max(nbatch, mynbatch);
-    
-    //if (nbatch < HASH_BATCH_THRESHOLD)
-    //    nbatch     = nbatch    * max_parallel_workers_per_gather;
 
     /* nbuckets must be a power of 2 */
     log2_nbuckets = my_log2(nbuckets);
     Assert(nbuckets == (1 << log2_nbuckets));
 
     /*
-     * Initialize the hash table control block.
-     *
-     * The hashtable control block is just palloc'd from the executor's
-     * per-query memory context.
+     * Initialize the hash table control block.  Only the buckets and the
+     * tuples of the current batch are shared, the control block and the
+     * batch files are private to the worker.
      */
-    dp        = dsa_allocate(dsa, sizeof(HashJoinTableData));
-    hashtable = (HashJoinTable)dsa_get_address(dsa, dp);
+    hashtable = (HashJoinTable) palloc(sizeof(HashJoinTableData));
     hashtable->nbuckets = nbuckets;
     hashtable->nbuckets_original = nbuckets;
     hashtable->nbuckets_optimal = nbuckets;
     hashtable->log2_nbuckets = log2_nbuckets;
     hashtable->log2_nbuckets_optimal = log2_nbuckets;
     hashtable->buckets = NULL;
+    hashtable->shmBuckets = buckets;
+    hashtable->shmChunks = InvalidDsaPointer;
+    hashtable->shmOldChunks = InvalidDsaPointer;
+    hashtable->shmGrowth = growth;
     hashtable->keepNulls = keepNulls;
     hashtable->skewEnabled = false;
     hashtable->skewBucket = NULL;
@@ -2408,7 +2250,7 @@ ExecShmHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
     hashtable->curbatch = 0;
     hashtable->nbatch_original = nbatch;
     hashtable->nbatch_outstart = nbatch;
-    hashtable->growEnabled = false;
+    hashtable->growEnabled = (growth != NULL);
     hashtable->totalTuples = 0;
     hashtable->skewTuples = 0;
     hashtable->innerBatchFile = NULL;
@@ -2417,9 +2259,9 @@ ExecShmHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
     hashtable->spacePeak = 0;
     hashtable->spaceAllowed = work_mem * 1024L;
     hashtable->spaceUsedSkew = 0;
-    hashtable->spaceAllowedSkew =
-        hashtable->spaceAllowed * SKEW_WORK_MEM_PERCENT / 100;
+    hashtable->spaceAllowedSkew = 0;
     hashtable->chunks = NULL;
+    hashtable->runtimeFilter = NULL;
 
 #ifdef HJDEBUG
     printf("Hashjoin %p: initial nbatch = %d, nbuckets = %d\n",
@@ -2484,53 +2326,264 @@ ExecShmHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
         PrepareTempTablespaces();
     }
 
-    /*
-     * Prepare context for the first-scan space allocations; allocate the
-     * hashbucket array therein, and set each bucket "empty".
-     */
-    MemoryContextSwitchTo(hashtable->batchCxt);
+    MemoryContextSwitchTo(oldcxt);
+
+    return hashtable;
+}
+
+/*
+ * ExecShmHashTableInsert
+ *        insert a tuple into the shared hashtable, or into one of our temp
+ *        files for a later batch.
+ *
+ * All workers insert into the same buckets concurrently, so the tuple is
+ * pushed onto the front of its bucket's list with a compare-and-swap, which
+ * is retried until no other worker changed the head of the list meanwhile.
+ */
+void
+ExecShmHashTableInsert(HashJoinTable hashtable,
+                       TupleTableSlot *slot,
+                       uint32 hashvalue)
+{
+    MinimalTuple tuple = ExecFetchSlotMinimalTuple(slot);
+    int            bucketno;
+    int            batchno;
+
+    /* follow the batches added by the other workers */
+    if (hashtable->growEnabled)
+    {
+        int            nbatch = (int) pg_atomic_read_u32(&hashtable->shmGrowth->nbatch);
+
+        if (nbatch != hashtable->nbatch)
+            ExecShmHashTableSetNumBatches(hashtable, nbatch);
+    }
+
+    ExecHashGetBucketAndBatch(hashtable, hashvalue,
+                              &bucketno, &batchno);
 
-    dp_buckets                  = dsa_allocate0(dsa, nbuckets * sizeof(HashJoinTuple));
-    hashtable->buckets          = (HashJoinTuple *)dp_buckets;
-    dp_buckets                  = dsa_allocate0(dsa, nbuckets * sizeof(HashJoinTuple));
-    hashtable->buckets_tail     = (HashJoinTuple *)dp_buckets;
-    dp_wnum                     = dsa_allocate0(dsa, nbuckets * sizeof(int));
-    hashtable->bucket_tail_wNum = (int *)dp_wnum;
-    dp_wnum                     = dsa_allocate0(dsa, nbuckets * sizeof(int));
-    hashtable->bucket_wNum      = (int *)dp_wnum;
     /*
-     * Set up for skew optimization, if possible and there's a need for more
-     * than one batch.  (In a one-batch join, there's no point in it.)
+     * decide whether to put the tuple in the hash table or a temp file
      */
-#if 0
-    if (nbatch > 1)
-        ExecShmHashBuildSkewHash(hashtable, node, num_skew_mcvs);
-#endif
+    if (batchno == hashtable->curbatch)
+    {
+        HashJoinTuple hashTuple;
+        int            hashTupleSize;
+        dsa_pointer dp;
+        dsa_pointer head;
+
+        /* Create the HashJoinTuple */
+        hashTupleSize = HJTUPLE_OVERHEAD + tuple->t_len;
+        hashTuple = (HashJoinTuple) shm_dense_alloc(hashtable, hashTupleSize, &dp);
+
+        hashTuple->hashvalue = hashvalue;
+        memcpy(HJTUPLE_MINTUPLE(hashTuple), tuple, tuple->t_len);
+
+        /*
+         * We always reset the tuple-matched flag on insertion.  This is okay
+         * even when reloading a tuple from a batch file, since the tuple
+         * could not possibly have been matched to an outer tuple before it
+         * went into the batch file.
+         */
+        HeapTupleHeaderClearMatch(HJTUPLE_MINTUPLE(hashTuple));
+
+        /* Push it onto the front of the bucket's list */
+        head = dsa_pointer_atomic_read(&hashtable->shmBuckets[bucketno]);
+        do
+        {
+            hashTuple->next = (HashJoinTuple) head;
+        } while (!dsa_pointer_atomic_compare_exchange(&hashtable->shmBuckets[bucketno],
+                                                      &head, dp));
+
+        /* Account for space used */
+        hashtable->spaceUsed += hashTupleSize;
+        if (hashtable->spaceUsed > hashtable->spacePeak)
+            hashtable->spacePeak = hashtable->spaceUsed;
+    }
+    else
+    {
+        /*
+         * put the tuple into a temp file for later batches
+         */
+        Assert(batchno > hashtable->curbatch);
+        ExecHashJoinSaveTuple(tuple,
+                              hashvalue,
+                              &hashtable->innerBatchFile[batchno]);
+    }
+}
+
+/*
+ * ExecShmHashTableSetNumBatches
+ *        switch to the number of batches set by the workers of the shared
+ *        hashtable, enlarging the arrays of our batch files.
+ */
+void
+ExecShmHashTableSetNumBatches(HashJoinTable hashtable, int nbatch)
+{
+    int            oldnbatch = hashtable->nbatch;
+    MemoryContext oldcxt;
+
+    Assert(nbatch > oldnbatch);
+
+    oldcxt = MemoryContextSwitchTo(hashtable->hashCxt);
+
+    if (hashtable->innerBatchFile == NULL)
+    {
+        /* we had no file arrays before */
+        hashtable->innerBatchFile = (BufFile **)
+            palloc0(nbatch * sizeof(BufFile *));
+        hashtable->outerBatchFile = (BufFile **)
+            palloc0(nbatch * sizeof(BufFile *));
+        /* time to establish the temp tablespaces, too */
+        PrepareTempTablespaces();
+    }
+    else
+    {
+        /* enlarge arrays and zero out added entries */
+        hashtable->innerBatchFile = (BufFile **)
+            repalloc(hashtable->innerBatchFile, nbatch * sizeof(BufFile *));
+        hashtable->outerBatchFile = (BufFile **)
+            repalloc(hashtable->outerBatchFile, nbatch * sizeof(BufFile *));
+        MemSet(hashtable->innerBatchFile + oldnbatch, 0,
+               (nbatch - oldnbatch) * sizeof(BufFile *));
+        MemSet(hashtable->outerBatchFile + oldnbatch, 0,
+               (nbatch - oldnbatch) * sizeof(BufFile *));
+    }
+
     MemoryContextSwitchTo(oldcxt);
 
-    return (HashJoinTable)dp;
+    hashtable->nbatch = nbatch;
+}
+
+/*
+ * ExecShmHashTableRepartition
+ *        after the number of batches grew during the build, dump out of the
+ *        shared hashtable the tuples that are no longer of batch 0.
+ *
+ * Called by all workers once they are all done inserting, each of them
+ * claiming ranges of buckets with nextBuckets.  The tuples kept are copied
+ * into chunks of our own, so that the chunks of the whole table can be freed
+ * by their owners with ExecShmHashTableFreeOldChunks, once all workers are
+ * done with the buckets.  The tuples dumped out go to our batch files.
+ */
+void
+ExecShmHashTableRepartition(HashJoinTable hashtable,
+                            pg_atomic_uint32 *nextBuckets)
+{
+    dsa_area   *dsa = GetNumWorkerDsa(0);
+    uint32        bucketno;
+
+    Assert(hashtable->curbatch == 0 && !hashtable->growEnabled);
+
+    hashtable->shmOldChunks = hashtable->shmChunks;
+    hashtable->shmChunks = InvalidDsaPointer;
+    hashtable->spaceUsed = 0;
+
+    while ((bucketno = pg_atomic_fetch_add_u32(nextBuckets, HASH_SHM_REPARTITION_BUCKETS)) <
+           (uint32) hashtable->nbuckets)
+    {
+        uint32        endbucket = Min(bucketno + HASH_SHM_REPARTITION_BUCKETS,
+                                    (uint32) hashtable->nbuckets);
+
+        for (; bucketno < endbucket; bucketno++)
+        {
+            dsa_pointer dp = dsa_pointer_atomic_read(&hashtable->shmBuckets[bucketno]);
+            dsa_pointer head = InvalidDsaPointer;
+
+            while (DsaPointerIsValid(dp))
+            {
+                HashJoinTuple hashTuple = (HashJoinTuple) dsa_get_address(dsa, dp);
+                MinimalTuple tuple = HJTUPLE_MINTUPLE(hashTuple);
+                dsa_pointer next = (dsa_pointer) hashTuple->next;
+                int            thisbucketno;
+                int            batchno;
+
+                ExecHashGetBucketAndBatch(hashtable, hashTuple->hashvalue,
+                                          &thisbucketno, &batchno);
+                Assert(thisbucketno == bucketno);
+
+                if (batchno == 0)
+                {
+                    /* keep it, in a chunk of ours */
+                    int            hashTupleSize = HJTUPLE_OVERHEAD + tuple->t_len;
+                    HashJoinTuple copyTuple;
+                    dsa_pointer copy;
+
+                    copyTuple = (HashJoinTuple) shm_dense_alloc(hashtable, hashTupleSize, &copy);
+                    memcpy(copyTuple, hashTuple, hashTupleSize);
+                    copyTuple->next = (HashJoinTuple) head;
+                    head = copy;
+
+                    hashtable->spaceUsed += hashTupleSize;
+                }
+                else
+                {
+                    /* dump it out */
+                    Assert(batchno > 0 && batchno < hashtable->nbatch);
+                    ExecHashJoinSaveTuple(tuple,
+                                          hashTuple->hashvalue,
+                                          &hashtable->innerBatchFile[batchno]);
+                }
+
+                dp = next;
+            }
+
+            dsa_pointer_atomic_write(&hashtable->shmBuckets[bucketno], head);
+        }
+    }
+
+    if (hashtable->spaceUsed > hashtable->spacePeak)
+        hashtable->spacePeak = hashtable->spaceUsed;
+}
+
+/*
+ * ExecShmHashTableFreeOldChunks
+ *        free the chunks we inserted tuples into before a repartition.
+ *
+ * The caller has to make sure that all workers are done repartitioning.
+ */
+void
+ExecShmHashTableFreeOldChunks(HashJoinTable hashtable)
+{
+    shm_free_chunks(hashtable->shmOldChunks);
+    hashtable->shmOldChunks = InvalidDsaPointer;
+}
+
+/*
+ * ExecShmHashTableReset
+ *        free the tuples we inserted into the shared hashtable, before
+ *        loading a new batch.
+ *
+ * The caller has to make sure that no worker is scanning them anymore.
+ */
+void
+ExecShmHashTableReset(HashJoinTable hashtable)
+{
+    shm_free_chunks(hashtable->shmChunks);
+    hashtable->shmChunks = InvalidDsaPointer;
+    ExecShmHashTableFreeOldChunks(hashtable);
+
+    hashtable->spaceUsed = 0;
 }
 
 /* ----------------------------------------------------------------
  *        MultiExecShmHash
  *
- *        build share hash table for hashjoin, doing partitioning if more
- *        than one batch is required.
+ *        insert our share of the inner relation into the shared hashtable
+ *        of a parallel hashjoin, doing partitioning if more than one batch
+ *        is required.  The caller finishes the partitioning once all the
+ *        workers are done, see ExecHashJoinFinishShmBuild.
  * ----------------------------------------------------------------
  */
 Node *
 MultiExecShmHash(HashState *node)
-{// #lizard forgives
+{
     PlanState  *outerNode;
     List       *hashkeys;
     HashJoinTable hashtable;
     TupleTableSlot *slot;
     ExprContext *econtext;
     uint32        hashvalue;
-    uint32      tuple_number;
-    dsa_pointer dp;
-    dsa_area * dsa = GetNumWorkerDsa(ParallelWorkerNumber);
-    
+
     /* must provide our own instrumentation support */
     if (node->ps.instrument)
         InstrStartNode(node->ps.instrument);
@@ -2539,9 +2592,7 @@ MultiExecShmHash(HashState *node)
      * get state info from node
      */
     outerNode = outerPlanState(node);
-
-    dp = (dsa_pointer)node->hashtable;
-    hashtable = (HashJoinTable)dsa_get_address(dsa, dp);
+    hashtable = node->hashtable;
 
     /*
      * set expression context
@@ -2552,74 +2603,27 @@ MultiExecShmHash(HashState *node)
     /*
      * get all inner tuples and insert into the hash table (or temp files)
      */
-    tuple_number = 0;
     for (;;)
     {
         slot = ExecProcNode(outerNode);
         if (TupIsNull(slot))
             break;
-        
-        tuple_number++;
-        
+
         /* We have to compute the hash value */
         econtext->ecxt_innertuple = slot;
         if (ExecHashGetHashValue(hashtable, econtext, hashkeys,
                                  false, hashtable->keepNulls,
                                  &hashvalue))
         {
-            int            bucketNumber;
-
-            bucketNumber = ExecHashGetSkewBucket(hashtable, hashvalue);
-            if (bucketNumber != INVALID_SKEW_BUCKET_NO)
-            {
-                /* It's a skew tuple, so put it into that hash table */
-                ExecShmHashSkewTableInsert(hashtable, slot, hashvalue,
-                                           bucketNumber);
-                hashtable->skewTuples += 1;
-            }
-            else
-            {
-                /* Not subject to skew optimization, so insert normally */
-                ExecShmHashTableInsert(hashtable, slot, hashvalue);
-            }
+            ExecShmHashTableInsert(hashtable, slot, hashvalue);
             hashtable->totalTuples += 1;
         }
     }
 
-#if 0
-    /* debug */
-    if(hashtable->totalTuples != tuple_number)
-    {
-        elog(PANIC, "tuple number is mismatch");    
-    }
-#endif
-
-    /* Account for the buckets in spaceUsed (reported in EXPLAIN ANALYZE) */
-    hashtable->spaceUsed += hashtable->nbuckets * sizeof(HashJoinTuple);
-    if (hashtable->spaceUsed > hashtable->spacePeak)
-        hashtable->spacePeak = hashtable->spaceUsed;
-
     /* must provide our own instrumentation support */
     if (node->ps.instrument)
         InstrStopNode(node->ps.instrument, hashtable->totalTuples);
 
-    /* finish to build share hashtable, flush all the bufFiles */
-    if(hashtable->nbatch> 1)
-    {
-        int i   = 0;
-        int ret = 0;
-        for(i = 0; i < hashtable->nbatch; i++)
-        {
-            if(hashtable->innerBatchFile[i])
-            {
-                /* flush bufFile until flush successfully  */
-                do
-                {
-                    ret = FlushBufFile(hashtable->innerBatchFile[i]);
-                } while(ret == EOF);
-            }
-        }
-    }
     /*
      * We do not return the hash table directly because it's not a subtype of
      * Node, and so would violate the MultiExecProcNode API.  Instead, our
@@ -27,6 +27,8 @@
 #ifdef __OPENTENBASE__
 #include "access/xact.h"
 #include "executor/execParallel.h"
+#include "executor/runtimefilter.h"
+#include "pgxc/execRemote.h"
 #endif
 
 /*
@@ -46,6 +48,21 @@
 
 #ifdef __OPENTENBASE__
 volatile ParallelHashJoinStatus *statusParallelWorker = NULL;
+
+/*
+ * Barrier phases of the batches of a shared hashtable, see
+ * ExecHashJoinNewShmBatch.  Phases only grow, so skipped batches need no
+ * barrier.  Batch 0 has no buckets to clear: its clear phase is reached
+ * once the workers are done inserting the inner relation instead, see
+ * ExecHashJoinFinishShmBuild.
+ */
+#define HJ_PHASE_RELEASE(batchno)    (3 * (batchno))        /* previous batch done */
+#define HJ_PHASE_CLEAR(batchno)        (3 * (batchno) + 1)    /* buckets cleared */
+#define HJ_PHASE_LOAD(batchno)        (3 * (batchno) + 2)    /* inner batch loaded */
+#define HJ_PHASE_BUILD                HJ_PHASE_CLEAR(0)    /* inner relation inserted */
+
+/* number of buckets a worker claims at a time to clear them */
+#define HJ_CLEAR_BUCKETS            65536
 #endif
 static TupleTableSlot *ExecHashJoinOuterGetTuple(PlanState *outerNode,
                           HashJoinState *hjstate,
@@ -58,10 +75,17 @@ static bool ExecHashJoinNewBatch(HashJoinState *hjstate);
 
 #ifdef __OPENTENBASE__
 static void ExecShareBufFileName(volatile ParallelHashJoinState *parallelState, HashJoinTable hashtable, bool inner);
-static HashJoinTable ExecMergeShmHashTable(HashJoinState * hjstate, volatile ParallelHashJoinState *parallelState, 
-                                Hash *node, List *hashOperators, bool keepNulls);
+static void ExecHashJoinShareInnerBufFile(HashJoinState *hjstate,
+                                          volatile ParallelHashJoinState *parallelState);
+static void ExecHashJoinBatchBarrier(volatile ParallelHashJoinState *parallelState, int phase);
+static void ExecHashJoinFinishShmBuild(HashJoinState *hjstate,
+                            volatile ParallelHashJoinState *parallelState);
+static bool ExecHashJoinNewShmBatch(HashJoinState *hjstate);
 static void ExecFormNewOuterBufFile(HashJoinState * hjstate, volatile ParallelHashJoinState *parallelState, 
                                  Hash *node);
+static bool ExecHashJoinCanPushRuntimeFilter(HashJoinState *hjstate);
+static void ExecHashJoinPushRuntimeFilter(HashJoinState *hjstate,
+                                          HashJoinTable hashtable);
 
 #endif
 /* ----------------------------------------------------------------
@@ -152,6 +176,10 @@ ExecHashJoin(PlanState *pstate)
                  * The only way to make the check is to try to fetch a tuple
                  * from the outer plan node.  If we succeed, we have to stash
                  * it away for later consumption by ExecHashJoinOuterGetTuple.
+                 *
+                 * When we are to push a bloom filter of the inner side to the
+                 * outer side, the hash table has to be built before the outer
+                 * side is started.
                  */
                 hashJoin = (HashJoin*)node->js.ps.plan;
                 if (HJ_FILL_INNER(node))
@@ -161,7 +189,7 @@ ExecHashJoin(PlanState *pstate)
                 }
                 else if (HJ_FILL_OUTER(node) ||
                          (outerNode->plan->startup_cost < hashNode->ps.plan->total_cost &&
-                          !node->hj_OuterNotEmpty))
+                          !node->hj_OuterNotEmpty && !node->hj_PushRuntimeFilter))
                 {
 #ifdef __OPENTENBASE__
                     /* When we need to prefetch inner, we just assume there is at lease one row from outer plan */
@@ -262,36 +290,44 @@ ExecHashJoin(PlanState *pstate)
                     {
                         node->hj_InnerInited = true;
                         /* 
-                          * create hashtable in share-memory
+                          * create our hashtable over the buckets shared by all workers
                           */
                         parallelState->statusParallelWorker[ParallelWorkerNumber] = ParallelHashJoin_BuildShmHashTable;
-                        hashtable = ExecShmHashTableCreate((Hash *) hashNode->ps.plan,
-                                                            node->hj_HashOperators,
-                                                            HJ_FILL_INNER(node));
-
+                        hashtable = ExecShmHashTableCreate(node->hj_HashOperators,
+                                                           HJ_FILL_INNER(node),
+                                                           parallelState->nbuckets,
+                                                           parallelState->nbatch,
+                                                           parallelState->buckets,
+                                                           parallelState->growth);
+                        node->hj_HashTable = hashtable;
                         hashNode->hashtable = hashtable;
 
                         /* 
-                          * build hashtable in share-memory, and set the worker status to tell other worker our hashtable
-                          * has been finished.
+                          * insert our share of the inner relation, together with the other workers
                           */
                         (void)MultiExecShmHash((HashState *) hashNode);
 
+                        /*
+                          * once all workers are done, split the batches they added meanwhile
+                          */
+                        ExecHashJoinBatchBarrier(parallelState, HJ_PHASE_BUILD);
+                        ExecHashJoinFinishShmBuild(node, parallelState);
+
                         /*
                           * put hashtable bufile's file name into shm, so other workers can access
                           */
-                        parallelState->hashTableParallelWorker[ParallelWorkerNumber] = (dsa_pointer)hashtable;
                         ExecShareBufFileName(parallelState, hashtable, true);
+                        pg_atomic_fetch_add_u64(&parallelState->batches[0].ntuples,
+                                                (uint64) hashtable->totalTuples);
                         parallelState->statusParallelWorker[ParallelWorkerNumber] = ParallelHashJoin_BuildShmHashTableDone;
 
-                        /* merge shared hashtable, copy into local hashtable */
-                        hashtable = ExecMergeShmHashTable(node, parallelState, (Hash *) hashNode->ps.plan,
-                                                            node->hj_HashOperators,
-                                                            HJ_FILL_INNER(node));
-                        node->hj_HashTable = hashtable;
-						/* copy into hashNode too, for instrumentation */
-						hashNode->hashtable = hashtable;
-                        parallelState->statusParallelWorker[ParallelWorkerNumber] = ParallelHashJoin_MergeShmHashTableDone;
+                        /* wait for the other workers to finish the build */
+                        ExecHashJoinBatchBarrier(parallelState, HJ_PHASE_LOAD(0));
+
+                        ExecShmHashTableFreeOldChunks(hashtable);
+                        ExecHashJoinShareInnerBufFile(node, parallelState);
+                        hashtable->totalTuples = (double)
+                            pg_atomic_read_u64(&parallelState->batches[0].ntuples);
                     }
                     else
                     {
@@ -303,6 +339,10 @@ ExecHashJoin(PlanState *pstate)
                                                         node->hj_HashOperators,
                                                         HJ_FILL_INNER(node));
                         node->hj_HashTable = hashtable;
+                        if (node->hj_PushRuntimeFilter)
+                            ExecHashTableInitRuntimeFilter(hashtable,
+                                                           (Hash *) hashNode->ps.plan,
+                                                           node->hj_OuterHashKeys);
 
                         /*
                          * execute the Hash node, to build the hash table
@@ -322,6 +362,12 @@ ExecHashJoin(PlanState *pstate)
                                                 node->hj_HashOperators,
                                                 HJ_FILL_INNER(node));
                 node->hj_HashTable = hashtable;
+#ifdef __OPENTENBASE__
+                if (node->hj_PushRuntimeFilter)
+                    ExecHashTableInitRuntimeFilter(hashtable,
+                                                   (Hash *) hashNode->ps.plan,
+                                                   node->hj_OuterHashKeys);
+#endif
 
                 /*
                  * execute the Hash node, to build the hash table
@@ -330,6 +376,9 @@ ExecHashJoin(PlanState *pstate)
                 (void) MultiExecProcNode((PlanState *) hashNode);
 #ifdef __OPENTENBASE__
                 }
+
+                if (node->hj_PushRuntimeFilter)
+                    ExecHashJoinPushRuntimeFilter(node, hashtable);
 #endif
                 /*
                  * If the inner relation is completely empty, and we're not
@@ -766,6 +815,8 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 #ifdef __OPENTENBASE__
     hjstate->hj_OuterInited = false;
     hjstate->hj_InnerInited = false;
+    hjstate->hj_ShmInnerBatchFile = NULL;
+    hjstate->hj_PushRuntimeFilter = ExecHashJoinCanPushRuntimeFilter(hjstate);
 #endif
 
     return hjstate;
@@ -837,10 +888,8 @@ ExecEndHashJoin(HashJoinState *node)
     {
         int nWorkers = 0;
         int nDone    = 0;
-        dsa_area *dsa = GetNumWorkerDsa(ParallelWorkerNumber);
         ParallelHashJoinState *parallelState = node->hj_parallelState;
         volatile ParallelHashJoinStatus *statusParallelWorker = parallelState->statusParallelWorker;
-        HashJoinTable hashtable = (HashJoinTable)dsa_get_address(dsa, parallelState->hashTableParallelWorker[ParallelWorkerNumber]);
 
         if (statusParallelWorker[ParallelWorkerNumber] != ParallelHashJoin_EmptyOuter)
         {
@@ -868,16 +917,18 @@ ExecEndHashJoin(HashJoinState *node)
             }
         }
 
-        /* remove bufFile in share hashtable */
-        if(hashtable)
+        /* remove the inner bufFiles we wrote for the shared hashtable */
+        if (node->hj_ShmInnerBatchFile)
         {
             int            i;
             
-            for (i = 1; i < hashtable->nbatch; i++)
+            for (i = 1; i < parallelState->nbatch; i++)
             {
-                if (hashtable->innerBatchFile[i])
-                    BufFileClose(hashtable->innerBatchFile[i]);
+                if (node->hj_ShmInnerBatchFile[i])
+                    BufFileClose(node->hj_ShmInnerBatchFile[i]);
             }
+            pfree(node->hj_ShmInnerBatchFile);
+            node->hj_ShmInnerBatchFile = NULL;
         }
 
         elog(DEBUG1, "worker %d ExecHashjoin matched tuples %zu", ParallelWorkerNumber,
@@ -1007,6 +1058,19 @@ ExecHashJoinNewBatch(HashJoinState *hjstate)
     uint32        hashvalue;
 #ifdef __OPENTENBASE__
     HashState  *hashNode = (HashState *) innerPlanState(hjstate);
+
+    /*
+     * The batches of a shared hashtable are processed by all workers
+     * together.  In a right or full join, the later batches are divided among
+     * the workers instead, each one loading the batches it processes into a
+     * private hashtable.
+     */
+    if (hashtable->shmBuckets != NULL)
+    {
+        if (!HJ_FILL_INNER(hjstate))
+            return ExecHashJoinNewShmBatch(hjstate);
+        hashtable->shmBuckets = NULL;
+    }
 #endif
 
     nbatch = hashtable->nbatch;
@@ -1365,6 +1429,59 @@ ExecReScanHashJoin(HashJoinState *node)
         ExecReScan(node->js.ps.lefttree);
 }
 #ifdef __OPENTENBASE__
+/*
+ * Size of the hashtable shared by the workers, if the Hash node is parallel
+ * aware.  The leader and the workers lay out the shared state with it.
+ */
+static void
+ExecParallelHashJoinChooseSize(HashJoinState *node, int nWorkers,
+                               int *nbuckets, int *nbatch, int *maxbatch)
+{
+    Plan       *hashPlan = innerPlan(node->js.ps.plan);
+
+    if (hashPlan->parallel_aware)
+        ExecShmHashTableChooseSize((Hash *) hashPlan, nWorkers,
+                                   nbuckets, nbatch, maxbatch);
+    else
+    {
+        *nbuckets = 0;
+        *nbatch = 0;
+        *maxbatch = 0;
+    }
+}
+
+/*
+ * Point the arrays of a parallel hashjoin state into the shared memory
+ * starting at base, laid out as in ParallelHashJoinState_Size.
+ */
+static void
+ExecParallelHashJoinSetPointers(ParallelHashJoinState *parallelState,
+                                char *base, int nWorkers)
+{
+    Size        offset = sizeof(ParallelHashJoinState);
+
+    parallelState->statusParallelWorker = (ParallelHashJoinStatus *)(base + offset);
+
+    offset += sizeof(ParallelHashJoinStatus) * nWorkers;
+    parallelState->phaseParallelWorker = (int *)(base + offset);
+
+    offset += sizeof(int) * nWorkers;
+    parallelState->bufFileNames = (dsa_pointer *)(base + offset);
+
+    offset += sizeof(dsa_pointer) * nWorkers;
+    parallelState->outerBufFileNames = (dsa_pointer *)(base + offset);
+
+    offset += sizeof(dsa_pointer) * nWorkers;
+    offset = MAXALIGN(offset);
+    parallelState->batches = (ParallelHashJoinBatch *)(base + offset);
+
+    offset += MAXALIGN(sizeof(ParallelHashJoinBatch) * parallelState->maxbatch);
+    parallelState->growth = (ParallelHashJoinGrowth *)(base + offset);
+
+    offset += MAXALIGN(sizeof(ParallelHashJoinGrowth));
+    parallelState->buckets = (dsa_pointer_atomic *)(base + offset);
+}
+
 /* ----------------------------------------------------------------
  *        ExecParallelHashJoinEstimate
  *
@@ -1374,7 +1491,13 @@ ExecReScanHashJoin(HashJoinState *node)
 void
 ExecParallelHashJoinEstimate(HashJoinState *node, ParallelContext *pcxt)
 {
-    node->hj_parallelStateLen = ParallelHashJoinState_Size(pcxt->nworkers);
+    int nbuckets = 0;
+    int nbatch   = 0;
+    int maxbatch = 0;
+
+    ExecParallelHashJoinChooseSize(node, pcxt->nworkers, &nbuckets, &nbatch, &maxbatch);
+
+    node->hj_parallelStateLen = ParallelHashJoinState_Size(pcxt->nworkers, nbuckets, maxbatch);
     shm_toc_estimate_chunk(&pcxt->estimator, node->hj_parallelStateLen);
     shm_toc_estimate_keys(&pcxt->estimator, 1);
 }
@@ -1391,29 +1514,39 @@ ExecParallelHashJoinInitializeDSM(HashJoinState *node,
                                           ParallelContext *pcxt)
 {
     int i = 0;
-    int offset = 0;
     ParallelHashJoinState *parallelState = NULL;
 
     parallelState = shm_toc_allocate(pcxt->toc, node->hj_parallelStateLen);
 
     /* orginize memory allocated */
-    offset += sizeof(ParallelHashJoinState);
-    parallelState->statusParallelWorker = (ParallelHashJoinStatus *)((char *)parallelState + offset);
-
-    offset += sizeof(ParallelHashJoinStatus) * pcxt->nworkers;
-    parallelState->hashTableParallelWorker = (dsa_pointer *)((char *)parallelState + offset);
-
-    offset += sizeof(dsa_pointer) * pcxt->nworkers;
-    parallelState->bufFileNames = (dsa_pointer *)((char *)parallelState + offset);
-
-    offset += sizeof(dsa_pointer) * pcxt->nworkers;
-    parallelState->outerBufFileNames = (dsa_pointer *)((char *)parallelState + offset);
+    ExecParallelHashJoinChooseSize(node, pcxt->nworkers,
+                                   &parallelState->nbuckets, &parallelState->nbatch,
+                                   &parallelState->maxbatch);
+    ExecParallelHashJoinSetPointers(parallelState, (char *) parallelState, pcxt->nworkers);
     
     parallelState->numExpectedParallelWorkers = pcxt->nworkers;
     for(i = 0;i < pcxt->nworkers; i++)
     {
         parallelState->statusParallelWorker[i] = ParallelHashJoin_None;
+        parallelState->phaseParallelWorker[i] = 0;
+        parallelState->bufFileNames[i] = InvalidDsaPointer;
+        parallelState->outerBufFileNames[i] = InvalidDsaPointer;
     }
+
+    for (i = 0; i < parallelState->maxbatch; i++)
+    {
+        pg_atomic_init_u32(&parallelState->batches[i].nextBuckets, 0);
+        pg_atomic_init_u32(&parallelState->batches[i].nextWorker, 0);
+        pg_atomic_init_u64(&parallelState->batches[i].ntuples, 0);
+    }
+
+    pg_atomic_init_u32(&parallelState->growth->nbatch, (uint32) parallelState->nbatch);
+    pg_atomic_init_u64(&parallelState->growth->spaceUsed, 0);
+    parallelState->growth->spaceAllowed = work_mem * 1024L * Max(pcxt->nworkers, 1);
+    parallelState->growth->maxbatch = parallelState->maxbatch;
+
+    for (i = 0; i < parallelState->nbuckets; i++)
+        dsa_pointer_atomic_init(&parallelState->buckets[i], InvalidDsaPointer);
     
     shm_toc_insert(pcxt->toc, node->js.ps.plan->plan_node_id, parallelState);
     node->hj_parallelState = parallelState;
@@ -1428,7 +1561,6 @@ ExecParallelHashJoinInitializeDSM(HashJoinState *node,
 void
 ExecParallelHashJoinInitWorker(HashJoinState *node, ParallelWorkerContext *pwcxt)
 {
-    int offset = 0;
     ParallelHashJoinState *parallelState = NULL;
     volatile ParallelWorkerStatus *numParallelWorkers = NULL;
 
@@ -1438,20 +1570,14 @@ ExecParallelHashJoinInitWorker(HashJoinState *node, ParallelWorkerContext *pwcxt
     node->hj_parallelState = (ParallelHashJoinState *)palloc0(sizeof(ParallelHashJoinState));
 
     node->hj_parallelState->numExpectedParallelWorkers = parallelState->numExpectedParallelWorkers;
+    node->hj_parallelState->nbuckets = parallelState->nbuckets;
+    node->hj_parallelState->nbatch = parallelState->nbatch;
+    node->hj_parallelState->maxbatch = parallelState->maxbatch;
     
     /* orginize memory allocated */
-    offset += sizeof(ParallelHashJoinState);
-    node->hj_parallelState->statusParallelWorker = (ParallelHashJoinStatus *)((char *)parallelState + offset);
+    ExecParallelHashJoinSetPointers(node->hj_parallelState, (char *) parallelState,
+                                    numParallelWorkers->numExpectedWorkers);
 
-    offset += sizeof(ParallelHashJoinStatus) * numParallelWorkers->numExpectedWorkers;
-    node->hj_parallelState->hashTableParallelWorker = (dsa_pointer *)((char *)parallelState + offset);
-
-    offset += sizeof(dsa_pointer) * numParallelWorkers->numExpectedWorkers;
-    node->hj_parallelState->bufFileNames = (dsa_pointer *)((char *)parallelState + offset);
-
-    offset += sizeof(dsa_pointer) * numParallelWorkers->numExpectedWorkers;
-    node->hj_parallelState->outerBufFileNames = (dsa_pointer *)((char *)parallelState + offset);
-    
     /*
       * get total number of launched parallel workers.
       * this number is set by session after launching all parallel workers,
@@ -1494,19 +1620,8 @@ ExecShareBufFileName(volatile ParallelHashJoinState *parallelState, HashJoinTabl
     int j = 0;
     int numFiles = 0;
     dsa_pointer dp;
-    HashJoinTable ht;
-    
-    /* get hashtable */
+    HashJoinTable ht = hashtable;
     dsa_area * dsa = GetNumWorkerDsa(ParallelWorkerNumber);
-
-    if (inner)
-    {
-        ht = (HashJoinTable)dsa_get_address(dsa, (dsa_pointer)hashtable);
-    }
-    else
-    {
-        ht = hashtable;
-    }
     
     /*
       * allocate space for bufFile's file name in shm.
@@ -1590,358 +1705,467 @@ ExecShareBufFileName(volatile ParallelHashJoinState *parallelState, HashJoinTabl
     }
 }
 
-/*
-  * merge all parallel workers' shared hashtables into local hashtable
-  */
-static HashJoinTable
-ExecMergeShmHashTable(HashJoinState * hjstate, volatile ParallelHashJoinState *parallelState, 
-                                Hash *node, List *hashOperators, bool keepNulls)
+static void
+ExecFormNewOuterBufFile(HashJoinState * hjstate, volatile ParallelHashJoinState *parallelState, 
+                                 Hash *node)
 {// #lizard forgives
-    int i            = 0;
-    int nMerged      = 0;
-    int workerLeader = 0;
-    int indexbucket  = 0;
+    int i = 0;
+    int nMerged = 0;
     int indexbatch   = 0;
     int nWorkers     = parallelState->numLaunchedParallelWorkers;
     bool *merged     = (bool *)palloc0(sizeof(bool) * nWorkers);
-    dsa_area * leaderDsa = GetNumWorkerDsa(workerLeader);
-    volatile ParallelHashJoinStatus *statusParallelWorker    = parallelState->statusParallelWorker;
-    volatile dsa_pointer            *hashTableParallelWorker = parallelState->hashTableParallelWorker;
-    HashJoinTable ht = (HashJoinTable)dsa_get_address(leaderDsa, hashTableParallelWorker[workerLeader]);
-    
-    /* build local hashtable */
-    HashJoinTable hashtable = ExecHashTableCreate(node,
-                                                  hashOperators,
-                                                  keepNulls);
+    HashJoinTable hashtable = hjstate->hj_HashTable;
+    volatile ParallelHashJoinStatus *statusParallelWorker     = parallelState->statusParallelWorker;
+
     i = 0;
-    nMerged = 0;
+    nMerged = 1;
     while(nMerged < nWorkers)
     {
-        if(!merged[i] && statusParallelWorker[i] >= ParallelHashJoin_BuildShmHashTableDone)
+        if (i != ParallelWorkerNumber && !merged[i] && statusParallelWorker[i] >= ParallelHashJoin_ShareOuterBufFileDone)
         {
             dsa_area *dsa = GetNumWorkerDsa(i);
-            HashJoinTable mergeHashtable = (HashJoinTable)dsa_get_address(dsa, hashTableParallelWorker[i]);
             
             merged[i] = true;
             nMerged++;
 
-            /* 
-              *   merge hashtable buckets 
-              *   worker leader do the merging, other workers just copy the merged hashtable
-              *   into local memory
-              * 
-              *   the main work of merging is just linking the hashtable's buckets from different workers.
-              */
-            if(workerLeader == ParallelWorkerNumber)
-            {
-                if(i != workerLeader)
-                {            
-                    HashJoinTupleData **ht_buckets          = (HashJoinTuple *)dsa_get_address(leaderDsa, 
-                                                                          (dsa_pointer)ht->buckets);
-                    HashJoinTupleData **ht_buckets_tail     = (HashJoinTuple *)dsa_get_address(leaderDsa, 
-                                                                          (dsa_pointer)ht->buckets_tail);
-                    HashJoinTupleData **merged_buckets      = (HashJoinTuple *)dsa_get_address(dsa, 
-                                                                          (dsa_pointer)mergeHashtable->buckets);
-                    HashJoinTupleData **merged_buckets_tail = (HashJoinTuple *)dsa_get_address(dsa, 
-                                                                          (dsa_pointer)mergeHashtable->buckets_tail);
-                    int *head_workNum                       = (int *)dsa_get_address(leaderDsa, 
-                                                                          (dsa_pointer)ht->bucket_wNum);
-                    int *tail_workNum                       = (int *)dsa_get_address(leaderDsa, 
-                                                                          (dsa_pointer)ht->bucket_tail_wNum);
-                    
-                    if(ht->nbuckets != mergeHashtable->nbuckets)
-                    {
-                        elog(ERROR, "number of buckets is different in parallel workers' hashtables.");
-                    }
-
-                    ht->totalTuples = ht->totalTuples + mergeHashtable->totalTuples;
-					ht->spacePeak = Max(ht->spacePeak, mergeHashtable->spacePeak);
-                    
-                    /* merge hashtable */
-                    for(indexbucket = 0; indexbucket < ht->nbuckets; indexbucket++)
-                    {
-                        if(ht_buckets[indexbucket])
-                        {
-                            int workerNumber = tail_workNum[indexbucket];
-                            HashJoinTupleData *tail = (HashJoinTupleData *)dsa_get_address(GetNumWorkerDsa(workerNumber), 
-                                                                                       (dsa_pointer)ht_buckets_tail[indexbucket]);
-                            tail->next              = merged_buckets[indexbucket];
-                            tail->workerNumber      = i;
-
-                            if(merged_buckets[indexbucket])
-                            {
-                                ht_buckets_tail[indexbucket] = merged_buckets_tail[indexbucket];
-                                tail_workNum[indexbucket] = i;
-                            }
-                        }
-                        else
-                        {
-                            if(merged_buckets[indexbucket])
-                            {
-                                ht_buckets[indexbucket] = merged_buckets[indexbucket];
-                                ht_buckets_tail[indexbucket] = merged_buckets_tail[indexbucket];
-                                tail_workNum[indexbucket] = i;
-                                head_workNum[indexbucket] = i;
-                            }
-                        }
-                    }
-                }
-            }
-
-            /* merge hashtable inner batch file */
-            if(hashtable->nbatch > 1)
+            /* merge hashtable outer batch files */
+            if (hashtable->nbatch > 1)
             {
                 HashTableBufFileName *bufFileNames = (HashTableBufFileName *)dsa_get_address(dsa, 
-                                                                         parallelState->bufFileNames[i]);
+                                                                         parallelState->outerBufFileNames[i]);
+                
                 int *nFiles                        = (int *)dsa_get_address(dsa, bufFileNames->nFiles);
                 
                 dsa_pointer *names                 = (dsa_pointer *)dsa_get_address(dsa, bufFileNames->name);
                 
-                if(hashtable->nbatch != mergeHashtable->nbatch)
+                if (hashtable->nbatch != bufFileNames->nBatch)
                 {
-                    elog(ERROR, "number of batch is different in parallel workers' hashtables.");
+                    elog(ERROR, "number of outer batch is different in parallel workers' hashtables."
+                                "worker %d nbatch %d, worker %d nbatch %d.", ParallelWorkerNumber, hashtable->nbatch,
+                                i, bufFileNames->nBatch);
                 }
                 
-                for(indexbatch = 0; indexbatch < hashtable->nbatch; indexbatch++)
+                for (indexbatch = 0; indexbatch < hashtable->nbatch; indexbatch++)
                 {
                     int fileNum   = 0;
                     dsa_pointer *fileName = NULL;
 
                     fileNum     = nFiles[indexbatch];
 
-                    if(fileNum > 0)
+                    if (fileNum > 0)
                     {
                         fileName = (dsa_pointer *)dsa_get_address(dsa, names[indexbatch]);
-                        CreateBufFile(dsa, fileNum, fileName, &hashtable->innerBatchFile[indexbatch]);
+                        CreateBufFile(dsa, fileNum, fileName, &hashtable->outerBatchFile[indexbatch]);
                     }
                 }
             }
+            
         }
         else if (statusParallelWorker[i] == ParallelHashJoin_Error || ParallelError())
         {
             elog(ERROR, "[%s:%d]some other workers exit with errors, and we need to exit because"
                         " of data corrupted.", __FILE__, __LINE__);
         }
-#if 0
-        else if (!merged[i] && statusParallelWorker[i] == ParallelHashJoin_None)
-        {
-            elog(LOG, "worker %d not launched while worker %d ExecMergeShmHashTable.", i, ParallelWorkerNumber);
-            merged[i] = true;
-            nMerged++;
-        }
-#endif
+
         pg_usleep(1000L);
         i = (i + 1) % nWorkers;
     }
+}
 
-    if(workerLeader == ParallelWorkerNumber)
-    {
-#if 0
-        /* debug */
-        int i = 0;
-        size_t tuple_num = 0;
-        HashJoinTuple hashTuple;
-        dsa_area *dsa = NULL;
-        int work_num = 0;
-
-        HashJoinTupleData **ht_buckets  = (HashJoinTuple *)dsa_get_address(leaderDsa, 
-                                              (dsa_pointer)ht->buckets);
-        int *head_wnum = (int *)dsa_get_address(leaderDsa, 
-                                              (dsa_pointer)ht->bucket_wNum);
-        for(i = 0; i < ht->nbuckets; i++)
-        {
-            HashJoinTupleData *temp = NULL;
-            
-            if(ht_buckets[i])
-            {
-                tuple_num++;
+/*
+ * After the build of the shared hashtable, move our inner batch files aside:
+ * the other workers may read them until they are all done with the join,
+ * see ExecEndHashJoin.  In a right or full join, each later batch is
+ * processed by a single worker, which reads the inner batch files of all
+ * workers as one.
+ */
+static void
+ExecHashJoinShareInnerBufFile(HashJoinState *hjstate,
+                              volatile ParallelHashJoinState *parallelState)
+{
+    int i = 0;
+    int indexbatch = 0;
+    int nWorkers = parallelState->numLaunchedParallelWorkers;
+    HashJoinTable hashtable = hjstate->hj_HashTable;
 
-                dsa = GetNumWorkerDsa(head_wnum[i]);
-                hashTuple = (HashJoinTuple)dsa_get_address(dsa, (dsa_pointer)ht_buckets[i]);
+    if (hashtable->nbatch <= 1)
+        return;
 
-                temp = hashTuple->next;
-                work_num = hashTuple->workerNumber;
-            }
+    hjstate->hj_ShmInnerBatchFile = (BufFile **)palloc(sizeof(BufFile *) * hashtable->nbatch);
+    memcpy(hjstate->hj_ShmInnerBatchFile, hashtable->innerBatchFile,
+           sizeof(BufFile *) * hashtable->nbatch);
+    memset(hashtable->innerBatchFile, 0, sizeof(BufFile *) * hashtable->nbatch);
 
-            while(temp)
-            {
-                tuple_num++;
+    if (!HJ_FILL_INNER(hjstate))
+        return;
 
-                dsa = GetNumWorkerDsa(work_num);
-                hashTuple = (HashJoinTuple)dsa_get_address(dsa, (dsa_pointer)temp);
+    for (i = 0; i < nWorkers; i++)
+    {
+        dsa_area *dsa = GetNumWorkerDsa(i);
+        HashTableBufFileName *bufFileNames;
+        int *nFiles;
+        dsa_pointer *names;
 
-                temp = hashTuple->next;
-                work_num = hashTuple->workerNumber;
-            }
-        }
+        /* workers that never started the join have no files */
+        if (!DsaPointerIsValid(parallelState->bufFileNames[i]))
+            continue;
+
+        bufFileNames = (HashTableBufFileName *)dsa_get_address(dsa, parallelState->bufFileNames[i]);
+        nFiles       = (int *)dsa_get_address(dsa, bufFileNames->nFiles);
+        names        = (dsa_pointer *)dsa_get_address(dsa, bufFileNames->name);
 
-        if(tuple_num != ht->totalTuples)
+        for (indexbatch = 0; indexbatch < hashtable->nbatch; indexbatch++)
         {
-            elog(PANIC, "merged hashtable's totaltuple is mismatch, tuple_num %zu, totalTuples %lf.",
-                         tuple_num, ht->totalTuples);
+            if (nFiles[indexbatch] > 0)
+                CreateBufFile(dsa, nFiles[indexbatch],
+                              (dsa_pointer *)dsa_get_address(dsa, names[indexbatch]),
+                              &hashtable->innerBatchFile[indexbatch]);
         }
-#endif
-        statusParallelWorker[workerLeader] = ParallelHashJoin_MergeShmHashTableDone;
     }
+}
 
-    /* 
-      * copy merged hashtable into local hashtable 
-      * should wait for the leader finish merging hashtable
-      */
-    while(statusParallelWorker[workerLeader] < ParallelHashJoin_MergeShmHashTableDone)
+/*
+ * Once all workers are done inserting the inner relation, take on the
+ * number of batches they grew the shared hashtable to.  If it grew, dump out
+ * of the hashtable the tuples of the batches added, see
+ * ExecShmHashTableRepartition, and move the tuples we wrote to a batch file
+ * before the last growth to the file of the batch they now belong to.  The
+ * buckets of batch 0 are never cleared, so its nextBuckets is free to
+ * distribute the repartition among the workers.
+ *
+ * Only the build of batch 0 grows the number of batches: the outer tuples
+ * are partitioned after it, and later batches must not split anymore.
+ */
+static void
+ExecHashJoinFinishShmBuild(HashJoinState *hjstate,
+                           volatile ParallelHashJoinState *parallelState)
+{
+    HashJoinTable hashtable = hjstate->hj_HashTable;
+    int            nbatch = (int) pg_atomic_read_u32(&parallelState->growth->nbatch);
+    int            i;
+
+    hashtable->growEnabled = false;
+    if (nbatch != hashtable->nbatch)
+        ExecShmHashTableSetNumBatches(hashtable, nbatch);
+    parallelState->nbatch = nbatch;
+
+    if (nbatch != hashtable->nbatch_original)
     {
-        if (statusParallelWorker[workerLeader] == ParallelHashJoin_Error || ParallelError())
+        ExecShmHashTableRepartition(hashtable,
+                                    &parallelState->batches[0].nextBuckets);
+
+        /*
+         * Files of the upper half of the batches were only written to with
+         * the final number of batches.
+         */
+        for (i = 1; i < nbatch / 2; i++)
         {
-            elog(ERROR, "[%s:%d]some other workers exit with errors, and we need to exit because"
-                        " of data corrupted.", __FILE__, __LINE__);
+            BufFile    *file = hashtable->innerBatchFile[i];
+            TupleTableSlot *slot;
+            uint32        hashvalue;
+
+            if (file == NULL)
+                continue;
+
+            hashtable->innerBatchFile[i] = NULL;
+            if (BufFileSeek(file, 0, 0L, SEEK_SET))
+                ereport(ERROR,
+                        (errcode_for_file_access(),
+                         errmsg("could not rewind hash-join temporary file: %m")));
+
+            while ((slot = ExecHashJoinGetSavedTuple(hjstate,
+                                                     file,
+                                                     &hashvalue,
+                                                     hjstate->hj_HashTupleSlot)))
+            {
+                int            bucketno;
+                int            batchno;
+
+                ExecHashGetBucketAndBatch(hashtable, hashvalue,
+                                          &bucketno, &batchno);
+                Assert(batchno >= i);
+                ExecHashJoinSaveTuple(ExecFetchSlotMinimalTuple(slot), hashvalue,
+                                      &hashtable->innerBatchFile[batchno]);
+            }
+
+            BufFileClose(file);
         }
-        pg_usleep(1000L);
     }
 
+    /* flush all the bufFiles, for the other workers to read them */
+    for (i = 0; i < hashtable->nbatch; i++)
     {
-        HashJoinTable ht = (HashJoinTable)dsa_get_address(leaderDsa, hashTableParallelWorker[workerLeader]);
-        HashJoinTupleData **ht_buckets  = (HashJoinTuple *)dsa_get_address(leaderDsa, 
-                                                      (dsa_pointer)ht->buckets);
-        int *bucket_wNum = (int *)dsa_get_address(leaderDsa, (dsa_pointer)ht->bucket_wNum);
-        memcpy(hashtable->buckets, ht_buckets, sizeof(HashJoinTupleData *) * hashtable->nbuckets);
-        memcpy(hashtable->bucket_wNum, bucket_wNum, sizeof(int) * hashtable->nbuckets);
-        hashtable->totalTuples = ht->totalTuples;
-        hashtable->skewEnabled = false;
-        hashtable->growEnabled = false;
-		/* copy instrumentation too */
-		hashtable->nbuckets = ht->nbuckets;
-		hashtable->nbuckets_original = ht->nbuckets_original;
-		hashtable->nbatch = ht->nbatch;
-		hashtable->nbatch_original = ht->nbatch_original;
-		hashtable->spacePeak = ht->spacePeak;
+        if (hashtable->innerBatchFile && hashtable->innerBatchFile[i])
+        {
+            int            ret;
+
+            /* flush bufFile until flush successfully  */
+            do
+            {
+                ret = FlushBufFile(hashtable->innerBatchFile[i]);
+            } while (ret == EOF);
+        }
     }
+}
 
-#if 0
-    /* debug */
+/*
+ * Does any worker have inner tuples of the batch?
+ */
+static bool
+ExecHashJoinShmBatchHasInner(volatile ParallelHashJoinState *parallelState, int batchno)
+{
+    int i = 0;
+    int nWorkers = parallelState->numLaunchedParallelWorkers;
+
+    for (i = 0; i < nWorkers; i++)
     {
-        int i = 0;
-        size_t tuple_num = 0;
-        HashJoinTuple hashTuple;
-        dsa_area *dsa = NULL;
-        int work_num = 0;
-
-        HashJoinTupleData **ht_buckets  = hashtable->buckets;
-        for(i = 0; i < hashtable->nbuckets; i++)
-        {
-            HashJoinTupleData *temp = NULL;
-            
-            if(ht_buckets[i])
-            {
-                tuple_num++;
+        dsa_area *dsa = GetNumWorkerDsa(i);
+        HashTableBufFileName *bufFileNames;
+        int *nFiles;
 
-                dsa = GetNumWorkerDsa(hashtable->bucket_wNum[i]);
-                hashTuple = (HashJoinTuple)dsa_get_address(dsa, (dsa_pointer)ht_buckets[i]);
+        if (!DsaPointerIsValid(parallelState->bufFileNames[i]))
+            continue;
 
-                temp = hashTuple->next;
-                work_num = hashTuple->workerNumber;
-            }
+        bufFileNames = (HashTableBufFileName *)dsa_get_address(dsa, parallelState->bufFileNames[i]);
+        nFiles       = (int *)dsa_get_address(dsa, bufFileNames->nFiles);
+        if (nFiles[batchno] > 0)
+            return true;
+    }
 
-            while(temp)
-            {
-                tuple_num++;
+    return false;
+}
 
-                dsa = GetNumWorkerDsa(work_num);
-                hashTuple = (HashJoinTuple)dsa_get_address(dsa, (dsa_pointer)temp);
+/*
+ * Open the inner batch file a worker wrote for the batch, or return NULL if
+ * it has none.
+ */
+static BufFile *
+ExecHashJoinOpenShmInnerFile(volatile ParallelHashJoinState *parallelState,
+                             int workerno, int batchno)
+{
+    dsa_area *dsa = GetNumWorkerDsa(workerno);
+    HashTableBufFileName *bufFileNames;
+    int *nFiles;
+    dsa_pointer *names;
+    BufFile *file = NULL;
 
-                temp = hashTuple->next;
-                work_num = hashTuple->workerNumber;
-            }
-        }
+    if (!DsaPointerIsValid(parallelState->bufFileNames[workerno]))
+        return NULL;
+
+    bufFileNames = (HashTableBufFileName *)dsa_get_address(dsa, parallelState->bufFileNames[workerno]);
+    nFiles       = (int *)dsa_get_address(dsa, bufFileNames->nFiles);
+    names        = (dsa_pointer *)dsa_get_address(dsa, bufFileNames->name);
+
+    if (nFiles[batchno] > 0)
+        CreateBufFile(dsa, nFiles[batchno],
+                      (dsa_pointer *)dsa_get_address(dsa, names[batchno]),
+                      &file);
 
-        if (hashtable->nbatch > 1)
+    return file;
+}
+
+/*
+ * Wait until all workers still running the join have reached the phase.
+ * Workers that are done with the join, see ExecEndHashJoin, no longer take
+ * part in it.
+ */
+static void
+ExecHashJoinBatchBarrier(volatile ParallelHashJoinState *parallelState, int phase)
+{
+    int i = 0;
+    int nWorkers = parallelState->numLaunchedParallelWorkers;
+    volatile ParallelHashJoinStatus *statusParallelWorker = parallelState->statusParallelWorker;
+    volatile int *phaseParallelWorker = parallelState->phaseParallelWorker;
+
+    /* what we wrote into the shared hashtable must be seen once we arrive */
+    pg_memory_barrier();
+    phaseParallelWorker[ParallelWorkerNumber] = phase;
+
+    for (i = 0; i < nWorkers; i++)
+    {
+        while (phaseParallelWorker[i] < phase &&
+               statusParallelWorker[i] != ParallelHashJoin_ExecJoinDone)
         {
-            uint32 hashvalue = 0;
-            
-            for(i = 1; i < hashtable->nbatch; i++)
+            if (statusParallelWorker[i] == ParallelHashJoin_Error || ParallelError())
             {
-                while (ExecHashJoinGetSavedTuple(hjstate, hashtable->innerBatchFile[i], &hashvalue, hjstate->hj_HashTupleSlot))
-                {
-                    tuple_num++;
-                    ExecClearTuple(hjstate->hj_HashTupleSlot);
-                }
-
-                ReSetBufFile(hashtable->innerBatchFile[i]);
+                elog(ERROR, "[%s:%d]some other workers exit with errors, and we need to exit because"
+                            " of data corrupted.", __FILE__, __LINE__);
             }
-        }
 
-        elog(LOG, "worker_num:%d, tuple_num:%zu, totaltuple:%lf", ParallelWorkerNumber, tuple_num, hashtable->totalTuples);
+            pg_usleep(1000L);
+        }
     }
-#endif
-    pfree(merged);
 
-    return hashtable;
+    pg_memory_barrier();
 }
 
-static void
-ExecFormNewOuterBufFile(HashJoinState * hjstate, volatile ParallelHashJoinState *parallelState, 
-                                 Hash *node)
-{// #lizard forgives
-    int i = 0;
-    int nMerged = 0;
-    int indexbatch   = 0;
-    int nWorkers     = parallelState->numLaunchedParallelWorkers;
-    bool *merged     = (bool *)palloc0(sizeof(bool) * nWorkers);
+/*
+ * ExecHashJoinNewShmBatch
+ *        switch to a new batch of the hashtable shared by parallel workers
+ *
+ * All workers go through the same batches, so that each batch is loaded
+ * into the shared hashtable only once, by all workers together, before each
+ * worker probes it with its own outer batch file.  A batch no worker has
+ * inner tuples for is skipped, unless outer tuples need null-filling.
+ *
+ * Each batch takes three barriers: once nobody scans the previous batch,
+ * its tuples are freed and the buckets cleared; once the buckets are clear,
+ * the inner batch files of all workers are loaded, a worker's file at a
+ * time; once the batch is loaded, it is probed.
+ *
+ * Returns true if successful, false if there are no more batches.
+ */
+static bool
+ExecHashJoinNewShmBatch(HashJoinState *hjstate)
+{
     HashJoinTable hashtable = hjstate->hj_HashTable;
-    volatile ParallelHashJoinStatus *statusParallelWorker     = parallelState->statusParallelWorker;
+    volatile ParallelHashJoinState *parallelState = hjstate->hj_parallelState;
+    int            nWorkers = parallelState->numLaunchedParallelWorkers;
+    int            nbatch = hashtable->nbatch;
+    int            curbatch = hashtable->curbatch;
+    ParallelHashJoinBatch *batch;
+    uint32        bucketno;
+    uint32        workerno;
+    uint64        ntuples = 0;
 
-    i = 0;
-    nMerged = 1;
-    while(nMerged < nWorkers)
+    /*
+     * We no longer need the previous outer batch file; close it right away to
+     * free disk space.
+     */
+    if (curbatch > 0)
     {
-        if (i != ParallelWorkerNumber && !merged[i] && statusParallelWorker[i] >= ParallelHashJoin_ShareOuterBufFileDone)
-        {
-            dsa_area *dsa = GetNumWorkerDsa(i);
-            
-            merged[i] = true;
-            nMerged++;
+        if (hashtable->outerBatchFile[curbatch])
+            BufFileClose(hashtable->outerBatchFile[curbatch]);
+        hashtable->outerBatchFile[curbatch] = NULL;
+    }
 
-            /* merge hashtable outer batch files */
-            if (hashtable->nbatch > 1)
-            {
-                HashTableBufFileName *bufFileNames = (HashTableBufFileName *)dsa_get_address(dsa, 
-                                                                         parallelState->outerBufFileNames[i]);
-                
-                int *nFiles                        = (int *)dsa_get_address(dsa, bufFileNames->nFiles);
-                
-                dsa_pointer *names                 = (dsa_pointer *)dsa_get_address(dsa, bufFileNames->name);
-                
-                if (hashtable->nbatch != bufFileNames->nBatch)
-                {
-                    elog(ERROR, "number of outer batch is different in parallel workers' hashtables."
-                                "worker %d nbatch %d, worker %d nbatch %d.", ParallelWorkerNumber, hashtable->nbatch,
-                                i, bufFileNames->nBatch);
-                }
-                
-                for (indexbatch = 0; indexbatch < hashtable->nbatch; indexbatch++)
-                {
-                    int fileNum   = 0;
-                    dsa_pointer *fileName = NULL;
+    for (curbatch++; curbatch < nbatch; curbatch++)
+    {
+        if (HJ_FILL_OUTER(hjstate) ||
+            ExecHashJoinShmBatchHasInner(parallelState, curbatch))
+            break;
 
-                    fileNum     = nFiles[indexbatch];
+        /* no inner tuples, so none of our outer tuples can match */
+        if (hashtable->outerBatchFile[curbatch])
+            BufFileClose(hashtable->outerBatchFile[curbatch]);
+        hashtable->outerBatchFile[curbatch] = NULL;
+    }
 
-                    if (fileNum > 0)
-                    {
-                        fileName = (dsa_pointer *)dsa_get_address(dsa, names[indexbatch]);
-                        CreateBufFile(dsa, fileNum, fileName, &hashtable->outerBatchFile[indexbatch]);
-                    }
-                }
-            }
-            
-        }
-        else if (statusParallelWorker[i] == ParallelHashJoin_Error || ParallelError())
+    if (curbatch >= nbatch)
+        return false;            /* no more batches */
+
+    hashtable->curbatch = curbatch;
+    batch = &parallelState->batches[curbatch];
+
+    /* release the previous batch */
+    ExecHashJoinBatchBarrier(parallelState, HJ_PHASE_RELEASE(curbatch));
+    ExecShmHashTableReset(hashtable);
+
+    while ((bucketno = pg_atomic_fetch_add_u32(&batch->nextBuckets, HJ_CLEAR_BUCKETS)) <
+           (uint32) hashtable->nbuckets)
+    {
+        uint32        endbucket = Min(bucketno + HJ_CLEAR_BUCKETS, (uint32) hashtable->nbuckets);
+
+        for (; bucketno < endbucket; bucketno++)
+            dsa_pointer_atomic_write(&hashtable->shmBuckets[bucketno], InvalidDsaPointer);
+    }
+
+    /* load the new inner batch */
+    ExecHashJoinBatchBarrier(parallelState, HJ_PHASE_CLEAR(curbatch));
+
+    while ((workerno = pg_atomic_fetch_add_u32(&batch->nextWorker, 1)) < (uint32) nWorkers)
+    {
+        BufFile    *innerFile;
+        TupleTableSlot *slot;
+        uint32        hashvalue;
+
+        innerFile = ExecHashJoinOpenShmInnerFile(parallelState, workerno, curbatch);
+        if (innerFile == NULL)
+            continue;
+
+        while ((slot = ExecHashJoinGetSavedTuple(hjstate,
+                                                 innerFile,
+                                                 &hashvalue,
+                                                 hjstate->hj_HashTupleSlot)))
         {
-            elog(ERROR, "[%s:%d]some other workers exit with errors, and we need to exit because"
-                        " of data corrupted.", __FILE__, __LINE__);
+            ExecShmHashTableInsert(hashtable, slot, hashvalue);
+            ntuples++;
         }
 
-        pg_usleep(1000L);
-        i = (i + 1) % nWorkers;
+        BufFileClose(innerFile);
     }
+    pg_atomic_fetch_add_u64(&batch->ntuples, ntuples);
+
+    ExecHashJoinBatchBarrier(parallelState, HJ_PHASE_LOAD(curbatch));
+
+    /*
+     * Rewind outer batch file (if present), so that we can start reading it.
+     */
+    if (hashtable->outerBatchFile[curbatch] != NULL)
+    {
+        if (BufFileSeek(hashtable->outerBatchFile[curbatch], 0, 0L, SEEK_SET))
+            ereport(ERROR,
+                    (errcode_for_file_access(),
+                     errmsg("could not rewind hash-join temporary file: %m")));
+    }
+
+    return true;
+}
+
+/*
+ * Can we push a bloom filter of the inner side down to the producers of the
+ * outer side?  The outer side must be a RemoteSubplan, whose rows are hashed
+ * by the producers, so all outer hash keys must be plain columns of it.  And
+ * the join must discard outer rows without a match.
+ */
+static bool
+ExecHashJoinCanPushRuntimeFilter(HashJoinState *hjstate)
+{
+    ListCell   *lc;
+
+    if (!enable_runtime_filter || IsParallelWorker())
+        return false;
+
+    switch (hjstate->js.jointype)
+    {
+        case JOIN_INNER:
+        case JOIN_SEMI:
+        case JOIN_RIGHT:
+            break;
+        default:
+            return false;
+    }
+
+    if (!IsA(outerPlanState(hjstate), RemoteSubplanState) ||
+        hjstate->hj_OuterHashKeys == NIL)
+        return false;
+
+    foreach(lc, hjstate->hj_OuterHashKeys)
+    {
+        Expr       *key = ((ExprState *) lfirst(lc))->expr;
+
+        if (key == NULL || !IsA(key, Var) || ((Var *) key)->varno != OUTER_VAR)
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * Hand the bloom filter built with the hash table over to the outer
+ * RemoteSubplan, which sends it to the producers when it is bound.  A filter
+ * that turned out to be saturated is not worth it.
+ */
+static void
+ExecHashJoinPushRuntimeFilter(HashJoinState *hjstate, HashJoinTable hashtable)
+{
+    RuntimeFilter *filter = hashtable->runtimeFilter;
+
+    if (filter != NULL && !RuntimeFilterIsSelective(filter))
+        filter = NULL;
+
+    ExecRemoteSubplanSetRuntimeFilter((RemoteSubplanState *) outerPlanState(hjstate),
+                                      filter);
 }
 
 void
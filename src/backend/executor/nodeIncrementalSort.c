@@ -0,0 +1,343 @@
+/*-------------------------------------------------------------------------
+ *
+ * nodeIncrementalSort.c
+ *	  Routines to sort an input that is already sorted by a leading part of
+ *	  the sort keys.
+ *
+ * When the input of an ORDER BY a, b comes ordered by a, for instance from
+ * an index scan or the merge receive of a RemoteSubplan, the tuples only
+ * need to be sorted within each run of equal values of a.  The input is
+ * read in batches of at least INCREMENTAL_SORT_MIN_BATCH tuples; once a
+ * batch has reached that size, it goes on until the presorted columns
+ * change, and is then sorted on all the sort columns.  A batch therefore
+ * only ever holds complete runs, and the sorted batches come out in the
+ * right order one after the other.
+ *
+ * The first tuples are returned as soon as the first batch is sorted, and
+ * with a bound from an upper Limit the input is only read as far as needed:
+ * each batch is sorted with a bounded sort keeping only the tuples still
+ * missing, and no batch is started once the bound is reached.
+ *
+ * Only forward scans are supported; the planner puts a Material node above
+ * when backward scan or mark/restore is needed.
+ *
+ * Copyright (c) 2023 THL A29 Limited, a Tencent company.
+ *
+ * This source code file is licensed under the BSD 3-Clause License,
+ * you may obtain a copy of the License at http://opensource.org/license/bsd-3-clause/
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/nodeIncrementalSort.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "executor/execdebug.h"
+#include "executor/nodeIncrementalSort.h"
+#include "miscadmin.h"
+#include "utils/tuplesort.h"
+
+/*
+ * Do the two tuples have the same values in the presorted columns?
+ */
+static bool
+IncrementalSortSamePrefix(IncrementalSortState *node,
+						  TupleTableSlot *pivot, TupleTableSlot *slot)
+{
+	IncrementalSort *plannode = (IncrementalSort *) node->ss.ps.plan;
+	int			i;
+
+	/*
+	 * The last columns are the most likely to differ between neighbouring
+	 * tuples, so compare them first.
+	 */
+	for (i = plannode->nPresortedCols - 1; i >= 0; i--)
+	{
+		SortSupport ssup = &node->presortedKeys[i];
+		Datum		datum1,
+					datum2;
+		bool		isNull1,
+					isNull2;
+
+		datum1 = slot_getattr(pivot, ssup->ssup_attno, &isNull1);
+		datum2 = slot_getattr(slot, ssup->ssup_attno, &isNull2);
+
+		if (ApplySortComparator(datum1, isNull1, datum2, isNull2, ssup) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Read the next batch of tuples from the outer plan and sort it.
+ */
+static void
+IncrementalSortNextBatch(IncrementalSortState *node)
+{
+	IncrementalSort *plannode = (IncrementalSort *) node->ss.ps.plan;
+	PlanState  *outerNode = outerPlanState(node);
+	TupleDesc	tupDesc = ExecGetResultType(outerNode);
+	Tuplesortstate *tuplesortstate;
+	TupleTableSlot *slot;
+	int64		min_batch = INCREMENTAL_SORT_MIN_BATCH;
+	int64		ntuples = 0;
+	TuplesortInstrumentation stats;
+
+	/* must drop pointer to the previous batch's result tuple */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+	if (node->tuplesortstate != NULL)
+		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+	node->tuplesortstate = NULL;
+
+	tuplesortstate = tuplesort_begin_heap(tupDesc,
+										  plannode->sort.numCols,
+										  plannode->sort.sortColIdx,
+										  plannode->sort.sortOperators,
+										  plannode->sort.collations,
+										  plannode->sort.nullsFirst,
+										  work_mem,
+										  false);
+	node->tuplesortstate = (void *) tuplesortstate;
+
+	/*
+	 * With a bound, no more than the missing tuples have to be kept, and the
+	 * batch may end as soon as it holds them and its last run is complete.
+	 */
+	if (node->bounded)
+	{
+		int64		remaining = node->bound - node->n_returned;
+
+		Assert(remaining > 0);
+		tuplesort_set_bound(tuplesortstate, remaining);
+		min_batch = Min(min_batch, remaining);
+	}
+
+	/* the tuple that ended the previous batch starts this one */
+	if (!TupIsNull(node->transfer_tuple))
+	{
+		tuplesort_puttupleslot(tuplesortstate, node->transfer_tuple);
+		ntuples++;
+		if (ntuples >= min_batch)
+			ExecCopySlot(node->group_pivot, node->transfer_tuple);
+		ExecClearTuple(node->transfer_tuple);
+	}
+
+	for (;;)
+	{
+		slot = ExecProcNode(outerNode);
+
+		if (TupIsNull(slot))
+		{
+			node->outer_done = true;
+			break;
+		}
+
+		if (ntuples >= min_batch &&
+			!IncrementalSortSamePrefix(node, node->group_pivot, slot))
+		{
+			ExecCopySlot(node->transfer_tuple, slot);
+			break;
+		}
+
+		tuplesort_puttupleslot(tuplesortstate, slot);
+		ntuples++;
+
+		if (ntuples == min_batch)
+			ExecCopySlot(node->group_pivot, slot);
+	}
+
+	ExecClearTuple(node->group_pivot);
+
+	tuplesort_performsort(tuplesortstate);
+
+	node->n_batches++;
+	tuplesort_get_stats(tuplesortstate, &stats);
+	if (stats.spaceType < node->max_instrument.spaceType ||
+		(stats.spaceType == node->max_instrument.spaceType &&
+		 stats.spaceUsed > node->max_instrument.spaceUsed))
+		node->max_instrument = stats;
+
+	SO1_printf("IncrementalSortNextBatch: sorted batch of " INT64_FORMAT " tuples\n",
+			   ntuples);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecIncrementalSort
+ *
+ *		Returns the next tuple of the current sorted batch, reading and
+ *		sorting the next batch of the outer plan when it is exhausted.
+ * ----------------------------------------------------------------
+ */
+static TupleTableSlot *
+ExecIncrementalSort(PlanState *pstate)
+{
+	IncrementalSortState *node = castNode(IncrementalSortState, pstate);
+	TupleTableSlot *slot = node->ss.ps.ps_ResultTupleSlot;
+
+	CHECK_FOR_INTERRUPTS();
+
+	Assert(ScanDirectionIsForward(node->ss.ps.state->es_direction));
+
+	for (;;)
+	{
+		if (node->tuplesortstate != NULL &&
+			tuplesort_gettupleslot((Tuplesortstate *) node->tuplesortstate,
+								   true, false, slot, NULL))
+		{
+			node->n_returned++;
+			return slot;
+		}
+
+		/* the previous batch was the last one */
+		if (node->outer_done && TupIsNull(node->transfer_tuple))
+			break;
+		if (node->bounded && node->n_returned >= node->bound)
+			break;
+
+		IncrementalSortNextBatch(node);
+	}
+
+	return ExecClearTuple(slot);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecInitIncrementalSort
+ *
+ *		Creates the run-time state information for the incremental sort
+ *		node produced by the planner and initializes its outer subtree.
+ * ----------------------------------------------------------------
+ */
+IncrementalSortState *
+ExecInitIncrementalSort(IncrementalSort *node, EState *estate, int eflags)
+{
+	IncrementalSortState *sortstate;
+	TupleDesc	tupDesc;
+	int			i;
+
+	/* check for unsupported flags */
+	Assert(!(eflags & (EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)));
+
+	/*
+	 * create state structure
+	 */
+	sortstate = makeNode(IncrementalSortState);
+	sortstate->ss.ps.plan = (Plan *) node;
+	sortstate->ss.ps.state = estate;
+	sortstate->ss.ps.ExecProcNode = ExecIncrementalSort;
+
+	sortstate->bounded = false;
+	sortstate->bound = 0;
+	sortstate->outer_done = false;
+	sortstate->n_returned = 0;
+	sortstate->tuplesortstate = NULL;
+	sortstate->n_batches = 0;
+	sortstate->max_instrument.sortMethod = SORT_TYPE_STILL_IN_PROGRESS;
+	sortstate->max_instrument.spaceType = SORT_SPACE_TYPE_MEMORY;
+	sortstate->max_instrument.spaceUsed = 0;
+
+	/*
+	 * tuple table initialization
+	 *
+	 * incremental sort nodes only return scan tuples from their sorted
+	 * batches.
+	 */
+	ExecInitResultTupleSlot(estate, &sortstate->ss.ps);
+	ExecInitScanTupleSlot(estate, &sortstate->ss);
+
+	/*
+	 * initialize child nodes
+	 *
+	 * Each batch is sorted again after a rescan, so the child must support
+	 * REWIND if we are asked to.
+	 */
+	outerPlanState(sortstate) = ExecInitNode(outerPlan(node), estate, eflags);
+
+	/*
+	 * initialize tuple type.  no need to initialize projection info because
+	 * this node doesn't do projections.
+	 */
+	ExecAssignResultTypeFromTL(&sortstate->ss.ps);
+	ExecAssignScanTypeFromOuterPlan(&sortstate->ss);
+	sortstate->ss.ps.ps_ProjInfo = NULL;
+
+	tupDesc = ExecGetResultType(outerPlanState(sortstate));
+	sortstate->group_pivot = MakeSingleTupleTableSlot(tupDesc);
+	sortstate->transfer_tuple = MakeSingleTupleTableSlot(tupDesc);
+
+	/* comparators of the presorted columns, to find where runs end */
+	sortstate->presortedKeys = (SortSupport)
+		palloc0(node->nPresortedCols * sizeof(SortSupportData));
+	for (i = 0; i < node->nPresortedCols; i++)
+	{
+		SortSupport ssup = &sortstate->presortedKeys[i];
+
+		ssup->ssup_cxt = CurrentMemoryContext;
+		ssup->ssup_collation = node->sort.collations[i];
+		ssup->ssup_nulls_first = node->sort.nullsFirst[i];
+		ssup->ssup_attno = node->sort.sortColIdx[i];
+		ssup->abbreviate = false;
+
+		PrepareSortSupportFromOrderingOp(node->sort.sortOperators[i], ssup);
+	}
+
+	return sortstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecEndIncrementalSort(node)
+ * ----------------------------------------------------------------
+ */
+void
+ExecEndIncrementalSort(IncrementalSortState *node)
+{
+	/*
+	 * clean out the tuple table
+	 */
+	ExecClearTuple(node->ss.ss_ScanTupleSlot);
+	/* must drop pointer to sort result tuple */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+	ExecDropSingleTupleTableSlot(node->group_pivot);
+	ExecDropSingleTupleTableSlot(node->transfer_tuple);
+
+	/*
+	 * Release tuplesort resources
+	 */
+	if (node->tuplesortstate != NULL)
+		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+	node->tuplesortstate = NULL;
+
+	/*
+	 * shut down the subplan
+	 */
+	ExecEndNode(outerPlanState(node));
+}
+
+void
+ExecReScanIncrementalSort(IncrementalSortState *node)
+{
+	PlanState  *outerPlan = outerPlanState(node);
+
+	/*
+	 * The batches are not kept once returned, so the input is always read
+	 * and sorted again.
+	 */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+	ExecClearTuple(node->group_pivot);
+	ExecClearTuple(node->transfer_tuple);
+
+	if (node->tuplesortstate != NULL)
+		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+	node->tuplesortstate = NULL;
+
+	node->outer_done = false;
+	node->n_returned = 0;
+
+	/*
+	 * if chgParam of subnode is not null then plan will be re-scanned by
+	 * first ExecProcNode.
+	 */
+	if (outerPlan->chgParam == NULL)
+		ExecReScan(outerPlan);
+}
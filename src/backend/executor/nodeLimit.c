@@ -320,8 +320,8 @@ recompute_limits(LimitState *node)
 }
 
 /*
- * If we have a COUNT, and our input is a Sort node, notify it that it can
- * use bounded sort.  Also, if our input is a MergeAppend, we can apply the
+ * If we have a COUNT, and our input is a Sort or IncrementalSort node, notify
+ * it that it can use bounded sort.  Also, if our input is a MergeAppend, we can apply the
  * same bound to any Sorts that are direct children of the MergeAppend,
  * since the MergeAppend surely need read no more than that many tuples from
  * any one input.  We also have to be prepared to look through a Result,
@@ -355,6 +355,23 @@ pass_down_bound(LimitState *node, PlanState *child_node)
             sortState->bound = tuples_needed;
         }
     }
+    else if (IsA(child_node, IncrementalSortState))
+    {
+        IncrementalSortState *sortState = (IncrementalSortState *) child_node;
+        int64        tuples_needed = node->count + node->offset;
+
+        /* negative test checks for overflow in sum */
+        if (node->noCount || tuples_needed < 0)
+        {
+            /* make sure flag gets reset if needed upon rescan */
+            sortState->bounded = false;
+        }
+        else
+        {
+            sortState->bounded = true;
+            sortState->bound = tuples_needed;
+        }
+    }
     else if (IsA(child_node, MergeAppendState))
     {
         MergeAppendState *maState = (MergeAppendState *) child_node;
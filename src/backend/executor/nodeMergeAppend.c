@@ -42,6 +42,9 @@
 #include "executor/nodeMergeAppend.h"
 #include "lib/binaryheap.h"
 #include "miscadmin.h"
+#ifdef __OPENTENBASE__
+#include "executor/execPartition.h"
+#endif
 
 /*
  * We have one slot for each item in the heap array.  We use SlotNumber
@@ -52,12 +55,17 @@ typedef int32 SlotNumber;
 
 static TupleTableSlot *ExecMergeAppend(PlanState *pstate);
 static int    heap_compare_slots(Datum a, Datum b, void *arg);
+#ifdef __OPENTENBASE__
+static void exec_merge_append_prune_subplans(MergeAppendState *mergestate);
+#endif
 
 
 /* ----------------------------------------------------------------
  *        ExecInitMergeAppend
  *
- *        Begin all of the subscans of the MergeAppend node.
+ *        Begin all of the subscans of the MergeAppend node, but those of
+ *        the partitions pruned by the values of the Params known at
+ *        startup, see ExecInitAppend.
  * ----------------------------------------------------------------
  */
 MergeAppendState *
@@ -68,6 +76,12 @@ ExecInitMergeAppend(MergeAppend *node, EState *estate, int eflags)
     int            nplans;
     int            i;
     ListCell   *lc;
+#ifdef __OPENTENBASE__
+    Bitmapset  *validsubplans = NULL;
+    bool        initial_pruned = false;
+    bool        all_pruned = false;
+    int            planno;
+#endif
 
     /* check for unsupported flags */
     Assert(!(eflags & (EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)));
@@ -111,6 +125,63 @@ ExecInitMergeAppend(MergeAppend *node, EState *estate, int eflags)
      */
     ExecInitResultTupleSlot(estate, &mergestate->ps);
 
+#ifdef __OPENTENBASE__
+    if (node->part_prune_info != NULL)
+    {
+        PartitionPruneState *prunestate;
+
+        prunestate = ExecSetupPartitionPruneState(&mergestate->ps,
+                                                  node->part_prune_info);
+        if (prunestate->do_initial_prune)
+        {
+            validsubplans = ExecFindMatchingSubPlans(prunestate);
+            initial_pruned = true;
+
+            /* keep one subplan for EXPLAIN, as ExecInitAppend does */
+            if (bms_is_empty(validsubplans))
+            {
+                validsubplans = bms_make_singleton(0);
+                all_pruned = true;
+            }
+        }
+        else
+        {
+            mergestate->ms_prune_state = prunestate;
+            mergestate->ms_prune_pending = true;
+        }
+    }
+    mergestate->ms_plannos = (int *) palloc(Max(nplans, 1) * sizeof(int));
+    mergestate->ms_valid_plans = (int *) palloc(Max(nplans, 1) * sizeof(int));
+    planno = 0;
+
+    /*
+     * call ExecInitNode on each of the plans to be executed and save the
+     * results into the array "mergeplans", leaving out the pruned ones and
+     * those that have nothing to scan.
+     */
+    i = 0;
+    foreach(lc, node->mergeplans)
+    {
+        Plan       *initNode = (Plan *) lfirst(lc);
+        PlanState  *ret;
+
+        if (!initial_pruned || bms_is_member(planno, validsubplans))
+        {
+            ret = ExecInitNode(initNode, estate, eflags);
+            if (ret)
+            {
+                mergeplanstates[i] = ret;
+                mergestate->ms_plannos[i] = planno;
+                mergestate->ms_valid_plans[i] = i;
+                i++;
+            }
+        }
+        planno++;
+    }
+    mergestate->ms_nplans = i;
+    mergestate->ms_nvalid = all_pruned ? 0 : i;
+    bms_free(validsubplans);
+#else
     /*
      * call ExecInitNode on each of the plans to be executed and save the
      * results into the array "mergeplans".
@@ -123,6 +194,7 @@ ExecInitMergeAppend(MergeAppend *node, EState *estate, int eflags)
         mergeplanstates[i] = ExecInitNode(initNode, estate, eflags);
         i++;
     }
+#endif
 
     /*
      * initialize output tuple type
@@ -182,6 +254,24 @@ ExecMergeAppend(PlanState *pstate)
 
     if (!node->ms_initialized)
     {
+#ifdef __OPENTENBASE__
+        int            j;
+
+        if (node->ms_prune_pending)
+            exec_merge_append_prune_subplans(node);
+
+        /*
+         * First time through: pull the first tuple from each subplan left
+         * after pruning, and set up the heap.
+         */
+        for (j = 0; j < node->ms_nvalid; j++)
+        {
+            i = node->ms_valid_plans[j];
+            node->ms_slots[i] = ExecProcNode(node->mergeplans[i]);
+            if (!TupIsNull(node->ms_slots[i]))
+                binaryheap_add_unordered(node->ms_heap, Int32GetDatum(i));
+        }
+#else
         /*
          * First time through: pull the first tuple from each subplan, and set
          * up the heap.
@@ -192,6 +282,7 @@ ExecMergeAppend(PlanState *pstate)
             if (!TupIsNull(node->ms_slots[i]))
                 binaryheap_add_unordered(node->ms_heap, Int32GetDatum(i));
         }
+#endif
         binaryheap_build(node->ms_heap);
         node->ms_initialized = true;
     }
@@ -227,6 +318,31 @@ ExecMergeAppend(PlanState *pstate)
     return result;
 }
 
+#ifdef __OPENTENBASE__
+/*
+ * Computes the subplans left after pruning the partitions that can't match
+ * the current values of the Params.
+ */
+static void
+exec_merge_append_prune_subplans(MergeAppendState *mergestate)
+{
+    Bitmapset  *validsubplans;
+    int            i;
+
+    validsubplans = ExecFindMatchingSubPlans(mergestate->ms_prune_state);
+
+    mergestate->ms_nvalid = 0;
+    for (i = 0; i < mergestate->ms_nplans; i++)
+    {
+        if (bms_is_member(mergestate->ms_plannos[i], validsubplans))
+            mergestate->ms_valid_plans[mergestate->ms_nvalid++] = i;
+    }
+    bms_free(validsubplans);
+
+    mergestate->ms_prune_pending = false;
+}
+#endif
+
 /*
  * Compare the tuples in the two given slots.
  */
@@ -299,6 +415,14 @@ ExecReScanMergeAppend(MergeAppendState *node)
 {
     int            i;
 
+#ifdef __OPENTENBASE__
+    /* prune again before the next scan if the Params it depends on changed */
+    if (node->ms_prune_state != NULL &&
+        bms_overlap(node->ps.chgParam,
+                    node->ms_prune_state->pinfo->execparamids))
+        node->ms_prune_pending = true;
+#endif
+
     for (i = 0; i < node->ms_nplans; i++)
     {
         PlanState  *subnode = node->mergeplans[i];
@@ -30,8 +30,10 @@
 #include "postgres.h"
 
 #include "access/relscan.h"
+#include "executor/execBatch.h"
 #include "executor/execdebug.h"
 #include "executor/nodeSeqscan.h"
+#include "utils/memutils.h"
 #include "utils/rel.h"
 #ifdef _MLS_
 #include "utils/mls.h"
@@ -40,10 +42,25 @@
 #ifdef __AUDIT_FGA__
 #include "audit/audit_fga.h"
 #endif
+#ifdef _SHARDING_
+#include "access/sysattr.h"
+#include "catalog/pg_operator.h"
+#include "catalog/pg_type.h"
+#include "pgxc/pgxc.h"
+#include "utils/array.h"
+#include "utils/guc.h"
+#include "utils/tqual.h"
+#endif
 
 
 static bool InitScanRelation(SeqScanState *node, EState *estate, int eflags);
 static TupleTableSlot *SeqNext(SeqScanState *node);
+static TupleTableSlot *SeqNextBatch(SeqScanState *node, HeapScanDesc scandesc,
+			 ScanDirection direction);
+static bool SeqScanCanBatchQual(SeqScanState *node, EState *estate, int eflags);
+#ifdef _SHARDING_
+static Bitmapset *SeqScanGetShards(SeqScanState *node, Snapshot snapshot);
+#endif
 
 /* ----------------------------------------------------------------
  *						Scan Support
@@ -79,9 +96,18 @@ SeqNext(SeqScanState *node)
 		 * We reach here if the scan is not parallel, or if we're executing a
 		 * scan that was intended to be parallel serially.
 		 */
+#ifdef _SHARDING_
+		Bitmapset  *shards = SeqScanGetShards(node, estate->es_snapshot);
+
+		scandesc = heap_beginscan_shards(node->ss.ss_currentRelation,
+										 estate->es_snapshot,
+										 0, NULL, shards);
+		bms_free(shards);
+#else
 		scandesc = heap_beginscan(node->ss.ss_currentRelation,
 								  estate->es_snapshot,
 								  0, NULL);
+#endif
 		if(enable_distri_print)
 		{
 			elog(LOG, "seq scan snapshot local %d start ts "INT64_FORMAT " rel %s", estate->es_snapshot->local,
@@ -90,6 +116,9 @@ SeqNext(SeqScanState *node)
 		node->ss.ss_currentScanDesc = scandesc;
 	}
 
+	if (node->batchqual != NULL)
+		return SeqNextBatch(node, scandesc, direction);
+
 	/*
 	 * get the next tuple from the table
 	 */
@@ -124,6 +153,271 @@ SeqNext(SeqScanState *node)
 	return slot;
 }
 
+/*
+ * SeqNextBatch -- SeqNext when some quals are evaluated in batches
+ *
+ * In page-at-a-time mode all visible tuples of the current page stay valid
+ * while the scan holds its pin on the page, so they are collected into one
+ * batch and the batch quals are run over all of them at once.  Only the
+ * tuples passing them are handed to ExecScan, which evaluates the residual
+ * quals one by one.  The batch never spans two pages since heap_getnext
+ * releases the previous page when it moves on.
+ *
+ * If a batch clause would fail on some tuple, the batch result only covers
+ * the tuples before it.  That tuple and the rest of the batch are checked
+ * one at a time against the batch clauses here, so the error is raised only
+ * once the scan gets to it.
+ */
+static TupleTableSlot *
+SeqNextBatch(SeqScanState *node, HeapScanDesc scandesc, ScanDirection direction)
+{
+	TupleTableSlot *slot = node->ss.ss_ScanTupleSlot;
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+
+	for (;;)
+	{
+		HeapTuple	tuple;
+		int			ntuples = 0;
+		int			nfinal = 0;
+
+		if (node->batchpos < node->batchnsel)
+		{
+			tuple = &node->batchtuples[node->batchsel[node->batchpos++]];
+			return ExecStoreTuple(tuple,
+								  slot,
+								  scandesc->rs_cbuf,
+								  false);
+		}
+
+		while (node->batchnext < node->batchntuples)
+		{
+			tuple = &node->batchtuples[node->batchnext++];
+			ExecStoreTuple(tuple, slot, scandesc->rs_cbuf, false);
+
+			ResetExprContext(econtext);
+			econtext->ecxt_scantuple = slot;
+			if (ExecQual(node->batchrowqual, econtext))
+				return slot;
+
+			InstrCountFiltered1(node, 1);
+		}
+
+		tuple = heap_getnext(scandesc, direction);
+		if (tuple == NULL)
+			return ExecClearTuple(slot);
+		node->batchtuples[ntuples++] = *tuple;
+
+		/* rest of the visible tuples on this page */
+		while (scandesc->rs_pageatatime &&
+			   ScanDirectionIsForward(direction) &&
+			   scandesc->rs_cindex + 1 < scandesc->rs_ntuples &&
+			   ntuples < BATCH_QUAL_MAX_ROWS)
+		{
+			tuple = heap_getnext(scandesc, direction);
+			Assert(tuple != NULL);
+			node->batchtuples[ntuples++] = *tuple;
+		}
+
+		if (enable_distri_debug)
+			scandesc->rs_scan_number += ntuples;
+
+		node->batchnsel = ExecBatchQual(node->batchqual,
+										node->batchtuples, ntuples,
+										node->batchsel, &nfinal);
+		node->batchntuples = ntuples;
+		node->batchpos = 0;
+		node->batchnext = nfinal;
+		InstrCountFiltered1(node, nfinal - node->batchnsel);
+	}
+}
+
+/*
+ * SeqScanCanBatchQual -- may quals of this scan be evaluated in batches?
+ *
+ * EvalPlanQual rechecks a single tuple through the residual quals only, and
+ * a backward fetch would have to walk back over the current batch, so both
+ * keep to per-tuple evaluation.  So do relations whose values are decrypted
+ * or masked by MlsExecCheck before the quals see them.
+ */
+static bool
+SeqScanCanBatchQual(SeqScanState *node, EState *estate, int eflags)
+{
+	Relation	rel = node->ss.ss_currentRelation;
+
+	if (!enable_batch_qual || node->ss.ps.plan->qual == NIL)
+		return false;
+
+	if (estate->es_epqTuple != NULL || (eflags & EXEC_FLAG_BACKWARD))
+		return false;
+
+#ifdef _MLS_
+	if (rel->rd_att->transp_crypt != NULL || rel->rd_att->tdatamask != NULL)
+		return false;
+#endif
+
+	return true;
+}
+
+#ifdef _SHARDING_
+/*
+ * ShardQualGetShards -- shards allowed by one qual clause
+ *
+ * Recognizes "shardid = const" and "shardid = ANY(const array)".  Returns
+ * false if the clause does not restrict the shard id.
+ */
+static bool
+ShardQualGetShards(Expr *clause, Index scanrelid, Bitmapset **shards)
+{
+	Node	   *leftop;
+	Node	   *rightop;
+	Const	   *con;
+
+	*shards = NULL;
+
+	if (IsA(clause, OpExpr))
+	{
+		OpExpr	   *op = (OpExpr *) clause;
+
+		if (op->opno != Int4EqualOperator || list_length(op->args) != 2)
+			return false;
+		leftop = linitial(op->args);
+		rightop = lsecond(op->args);
+		if (IsA(rightop, Var))
+		{
+			Node	   *tmp = leftop;
+
+			leftop = rightop;
+			rightop = tmp;
+		}
+	}
+	else if (IsA(clause, ScalarArrayOpExpr))
+	{
+		ScalarArrayOpExpr *saop = (ScalarArrayOpExpr *) clause;
+
+		if (saop->opno != Int4EqualOperator || !saop->useOr)
+			return false;
+		leftop = linitial(saop->args);
+		rightop = lsecond(saop->args);
+	}
+	else
+		return false;
+
+	if (!IsA(leftop, Var) ||
+		((Var *) leftop)->varno != scanrelid ||
+		((Var *) leftop)->varattno != ShardIdAttributeNumber ||
+		((Var *) leftop)->varlevelsup != 0)
+		return false;
+	if (!IsA(rightop, Const) || ((Const *) rightop)->constisnull)
+		return false;
+	con = (Const *) rightop;
+
+	if (IsA(clause, OpExpr))
+	{
+		int32		sid = DatumGetInt32(con->constvalue);
+
+		if (ShardIDIsValid(sid))
+			*shards = bms_make_singleton(sid);
+	}
+	else
+	{
+		ArrayType  *arr = DatumGetArrayTypeP(con->constvalue);
+		Datum	   *elems;
+		bool	   *nulls;
+		int			nelems;
+		int			i;
+
+		if (ARR_ELEMTYPE(arr) != INT4OID)
+			return false;
+		deconstruct_array(arr, INT4OID, sizeof(int32), true, 'i',
+						  &elems, &nulls, &nelems);
+		for (i = 0; i < nelems; i++)
+		{
+			int32		sid = DatumGetInt32(elems[i]);
+
+			if (!nulls[i] && ShardIDIsValid(sid))
+				*shards = bms_add_member(*shards, sid);
+		}
+	}
+
+	return true;
+}
+
+/*
+ * SeqScanGetShards -- shards a seqscan actually needs to read
+ *
+ * Quals on the shardid system column restrict the scan to the listed
+ * shards.  A datanode session that only looks at hidden shards (as when
+ * cleaning up after a shard move) cannot see rows of any shard present in
+ * the snapshot's shard map, so those are pruned as well.  The result is
+ * only a hint for heap_beginscan_shards; quals are still evaluated on every
+ * tuple.  NULL means the whole relation must be read.
+ */
+static Bitmapset *
+SeqScanGetShards(SeqScanState *node, Snapshot snapshot)
+{
+	Relation	rel = node->ss.ss_currentRelation;
+	Index		scanrelid = ((Scan *) node->ss.ps.plan)->scanrelid;
+	Bitmapset  *result = NULL;
+	bool		restricted = false;
+	ListCell   *lc;
+
+	if (!enable_shard_pruned_scan || !RelationHasExtent(rel))
+		return NULL;
+
+	foreach(lc, node->ss.ps.plan->qual)
+	{
+		Bitmapset  *shards;
+
+		if (!ShardQualGetShards((Expr *) lfirst(lc), scanrelid, &shards))
+			continue;
+
+		if (restricted)
+		{
+			Bitmapset  *tmp = bms_intersect(result, shards);
+
+			bms_free(result);
+			bms_free(shards);
+			result = tmp;
+		}
+		else
+			result = shards;
+		restricted = true;
+	}
+
+	if (IS_PGXC_DATANODE &&
+		IsConnFromApp() &&
+		g_ShardVisibleMode == SHARD_VISIBLE_MODE_HIDDEN &&
+		IsMVCCSnapshot(snapshot) &&
+		snapshot->groupsize > 0)
+	{
+		Bitmapset  *hidden = NULL;
+		int			sid;
+
+		for (sid = 0; sid < MAX_SHARDS; sid++)
+		{
+			if (!bms_is_member(sid / snapshot->groupsize,
+							   SnapshotGetShardTable(snapshot)))
+				hidden = bms_add_member(hidden, sid);
+		}
+
+		if (restricted)
+		{
+			result = bms_int_members(result, hidden);
+			bms_free(hidden);
+		}
+		else
+			result = hidden;
+		restricted = true;
+	}
+
+	/*
+	 * An empty set would mean no tuple can qualify, but NULL is how "read
+	 * everything" is spelled; just let the quals reject the rows.
+	 */
+	return result;
+}
+#endif
+
 /*
  * SeqRecheck -- access method routine to recheck a tuple in EvalPlanQual
  */
@@ -244,12 +538,6 @@ ExecInitSeqScan(SeqScan *node, EState *estate, int eflags)
 	 */
 	ExecAssignExprContext(estate, &scanstate->ss.ps);
 
-	/*
-	 * initialize child expressions
-	 */
-	scanstate->ss.ps.qual =
-		ExecInitQual(node->plan.qual, (PlanState *) scanstate);
-    
 #ifdef __AUDIT_FGA__
     if (enable_fga)
     {
@@ -287,6 +575,39 @@ ExecInitSeqScan(SeqScan *node, EState *estate, int eflags)
 		return NULL;
 	}
 
+	/*
+	 * initialize child expressions, the leading quals having a batch kernel
+	 * are evaluated over whole pages in SeqNextBatch and the rest per tuple.
+	 */
+	if (SeqScanCanBatchQual(scanstate, estate, eflags))
+	{
+		List	   *residual = NIL;
+
+		scanstate->batchqual =
+			ExecInitBatchQual(node->plan.qual, node->scanrelid,
+							  RelationGetDescr(scanstate->ss.ss_currentRelation),
+							  &residual);
+		if (scanstate->batchqual != NULL)
+		{
+			List	   *batchclauses;
+
+			batchclauses = list_truncate(list_copy(node->plan.qual),
+										 list_length(node->plan.qual) -
+										 list_length(residual));
+			scanstate->batchrowqual =
+				ExecInitQual(batchclauses, (PlanState *) scanstate);
+			scanstate->batchtuples = (HeapTupleData *)
+				palloc(sizeof(HeapTupleData) * BATCH_QUAL_MAX_ROWS);
+			scanstate->batchsel = (int *)
+				palloc(sizeof(int) * BATCH_QUAL_MAX_ROWS);
+		}
+		scanstate->ss.ps.qual =
+			ExecInitQual(residual, (PlanState *) scanstate);
+	}
+	else
+		scanstate->ss.ps.qual =
+			ExecInitQual(node->plan.qual, (PlanState *) scanstate);
+
 	/*
 	 * Initialize result tuple type and projection info.
 	 */
@@ -359,6 +680,11 @@ ExecReScanSeqScan(SeqScanState *node)
 		heap_rescan(scan,		/* scan desc */
 					NULL);		/* new scan keys */
 
+	node->batchntuples = 0;
+	node->batchnsel = 0;
+	node->batchpos = 0;
+	node->batchnext = 0;
+
 	ExecScanReScan((ScanState *) node);
 }
 
@@ -20,8 +20,10 @@
 #include "miscadmin.h"
 
 #include "executor/producerReceiver.h"
+#include "executor/runtimefilter.h"
 #include "pgxc/nodemgr.h"
 #include "tcop/pquery.h"
+#include "utils/memutils.h"
 #include "utils/tuplestore.h"
 #include "utils/timestamp.h"
 #include "postmaster/postmaster.h"
@@ -51,9 +53,27 @@ typedef struct
 #ifdef __OPENTENBASE__
     uint64      send_tuples;        /* number of tuples sent to remote */
     TimestampTz send_total_time;    /* total time to send tuples */
+
+    /*
+     * Bloom filters of the consumers' hash joins: rows failing the filter of
+     * their destination can not have a match and are not sent.  Filters of
+     * the consumers bound to other backends are imported from the shared
+     * queue once they are published.
+     */
+    RuntimeFilter *selfFilter;      /* filter for SQ_CONS_SELF */
+    RuntimeFilter **rfilters;       /* filters by consumer index */
+    bool       *rfdone;             /* no need to look for the filter */
+    int         nrfilters;
+    MemoryContext rfcxt;            /* per-row memory of the hash functions */
+    long        rfcount;            /* rows not sent because of filters */
 #endif
 } ProducerState;
 
+#ifdef __OPENTENBASE__
+static bool producerRuntimeFilterPass(ProducerState *myState, int consumerIdx,
+                          TupleTableSlot *slot);
+#endif
+
 
 /*
  * Prepare to receive tuples from executor.
@@ -144,6 +164,14 @@ producerReceiveSlot(TupleTableSlot *slot, DestReceiver *self)
         {
             continue;
         }
+#ifdef __OPENTENBASE__
+        else if ((myState->selfFilter || myState->rfilters) &&
+                 !producerRuntimeFilterPass(myState, consumerIdx, slot))
+        {
+            myState->rfcount++;
+            continue;
+        }
+#endif
         else if (consumerIdx == SQ_CONS_SELF)
         {
             Assert(myState->consumer);
@@ -229,6 +257,28 @@ producerDestroyReceiver(DestReceiver *self)
 
     elog(DEBUG2, "Producer stats: total %ld tuples, %ld tuples to self, %ld to other nodes",
          myState->tcount, myState->selfcount, myState->othercount);
+#ifdef __OPENTENBASE__
+    if (myState->selfFilter || myState->rfilters)
+        elog(DEBUG2, "Producer stats: %ld tuples not sent because of runtime filters",
+             myState->rfcount);
+    if (myState->selfFilter)
+        RuntimeFilterReport(myState->selfFilter);
+    if (myState->rfilters)
+    {
+        int         i;
+
+        for (i = 0; i < myState->nrfilters; i++)
+        {
+            if (myState->rfilters[i])
+                RuntimeFilterReport(myState->rfilters[i]);
+        }
+    }
+    if (myState->rfcxt)
+    {
+        MemoryContextDelete(myState->rfcxt);
+        myState->rfcxt = NULL;
+    }
+#endif
 
     if (myState->consumer)
     {
@@ -408,6 +458,97 @@ ProducerReceiverPushBuffers(DestReceiver *self)
     return true;
 }
 #ifdef __OPENTENBASE__
+/*
+ * Set up the bloom filters of the consumers' hash joins.  The filter of the
+ * consumer this backend is bound to came with the Bind message; the other
+ * consumers publish theirs in the shared queue.  tupdesc describes the rows
+ * produced, and the filters are ignored if they do not fit it.
+ *
+ * Must be called after SetProducerDestReceiverParams.
+ */
+void
+SetProducerRuntimeFilter(DestReceiver *self, RuntimeFilter *filter,
+                         TupleDesc tupdesc)
+{
+    ProducerState *myState = (ProducerState *) self;
+    int         selfIdx = SQ_CONS_SELF;
+
+    Assert(myState->pub.mydest == DestProducer);
+
+    if (myState->squeue)
+    {
+        myState->nrfilters = getLocatorNodeCount(myState->locator);
+        myState->rfilters = (RuntimeFilter **)
+            palloc0(myState->nrfilters * sizeof(RuntimeFilter *));
+        myState->rfdone = (bool *) palloc0(myState->nrfilters * sizeof(bool));
+        selfIdx = GetConsumerIdx(myState->squeue, PGXC_PARENT_NODE_ID);
+    }
+    myState->rfcxt = AllocSetContextCreate(CurrentMemoryContext,
+                                           "Producer runtime filter",
+                                           ALLOCSET_SMALL_SIZES);
+
+    if (filter == NULL || !RuntimeFilterPrepare(filter, tupdesc))
+        filter = NULL;
+
+    if (selfIdx == SQ_CONS_SELF)
+        myState->selfFilter = filter;
+    else if (selfIdx >= 0 && selfIdx < myState->nrfilters)
+    {
+        myState->rfilters[selfIdx] = filter;
+        myState->rfdone[selfIdx] = true;
+    }
+}
+
+/*
+ * Can the row have a match in the hash join of consumer consumerIdx?  Returns
+ * true if the consumer has no filter.
+ */
+static bool
+producerRuntimeFilterPass(ProducerState *myState, int consumerIdx,
+                          TupleTableSlot *slot)
+{
+    RuntimeFilter *filter;
+    MemoryContext oldcontext;
+    bool        pass;
+
+    if (consumerIdx == SQ_CONS_SELF)
+        filter = myState->selfFilter;
+    else if (consumerIdx < 0 || consumerIdx >= myState->nrfilters)
+        filter = NULL;
+    else
+    {
+        /* look for a filter the consumer published since the last row */
+        if (!myState->rfdone[consumerIdx])
+        {
+            dsm_handle  handle;
+
+            handle = SharedQueueGetRuntimeFilter(myState->squeue, consumerIdx);
+            if (handle != DSM_HANDLE_INVALID)
+            {
+                oldcontext = MemoryContextSwitchTo(GetMemoryChunkContext(myState));
+                filter = RuntimeFilterImport(handle);
+                if (filter && !RuntimeFilterPrepare(filter, myState->typeinfo))
+                    filter = NULL;
+                MemoryContextSwitchTo(oldcontext);
+
+                myState->rfilters[consumerIdx] = filter;
+                myState->rfdone[consumerIdx] = true;
+            }
+        }
+        filter = myState->rfilters[consumerIdx];
+    }
+
+    if (filter == NULL)
+        return true;
+
+    MemoryContextReset(myState->rfcxt);
+    oldcontext = MemoryContextSwitchTo(myState->rfcxt);
+    pass = RuntimeFilterCheckSlot(filter, slot);
+    MemoryContextSwitchTo(oldcontext);
+
+    return pass;
+}
+
 void
 SetProducerNodeMap(DestReceiver *self, int16 *nodemap)
 {
@@ -0,0 +1,417 @@
+/*-------------------------------------------------------------------------
+ *
+ * runtimefilter.c
+ *	  Bloom filters built over the inner side of a hash join and applied by
+ *	  the producers of its outer side.
+ *
+ * When the outer side of an inner or semi hash join is a RemoteSubplan, all
+ * of its rows are redistributed over the network only for most of them to
+ * be discarded by the join.  While the hash table is built, the hash values
+ * of the inner tuples are also added to a bloom filter, which is shipped in
+ * the Bind message of the RemoteSubplan.  The remote producer hashes the
+ * join keys of each row it is about to send with the same outer hash
+ * functions, and drops the row when the filter of its destination proves
+ * that it can not have a match.
+ *
+ * A filter only describes the inner tuples of one consumer, so a producer
+ * distributing rows to several consumers applies each consumer's filter to
+ * the rows sent to that consumer.  Consumers other than the one that started
+ * the producer hand their filter over in a dynamic shared memory segment,
+ * see RuntimeFilterExport and RuntimeFilterImport.
+ *
+ * Each node counts the filters it builds, sends and receives and the rows
+ * its producers check and drop, see pg_stat_get_runtime_filter().
+ *
+ * Copyright (c) 2023 THL A29 Limited, a Tencent company.
+ *
+ * This source code file is licensed under the BSD 3-Clause License,
+ * you may obtain a copy of the License at http://opensource.org/license/bsd-3-clause/
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/runtimefilter.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "catalog/pg_type.h"
+#include "executor/runtimefilter.h"
+#include "funcapi.h"
+#include "libpq/pqformat.h"
+#include "port/atomics.h"
+#include "storage/shmem.h"
+#include "utils/builtins.h"
+
+bool		enable_runtime_filter = true;
+int			runtime_filter_max_size = 1024;	/* kB */
+
+/* bits of the bitmap per expected value, and the resulting number of hashes */
+#define RUNTIME_FILTER_BITS_PER_VALUE	10
+#define RUNTIME_FILTER_NHASHES			3
+
+/*
+ * Below this number of bits per added value the false positive rate goes
+ * above 15%, and the filter is not worth shipping nor checking.
+ */
+#define RUNTIME_FILTER_MIN_BITS_PER_VALUE	4
+
+#define RUNTIME_FILTER_MIN_BITS		1024
+
+/* header of a filter exported to dynamic shared memory */
+#define RUNTIME_FILTER_MAGIC		0x52464C54
+
+typedef struct RuntimeFilterShared
+{
+	uint32		magic;
+	uint32		len;			/* length of the serialized filter */
+	char		data[FLEXIBLE_ARRAY_MEMBER];
+} RuntimeFilterShared;
+
+typedef struct RuntimeFilterStats
+{
+	pg_atomic_uint64 counters[RUNTIME_FILTER_NSTATS];
+} RuntimeFilterStats;
+
+static RuntimeFilterStats *RuntimeFilterStatsShmem = NULL;
+
+/*
+ * Create an empty filter for about nvalues values, in the current memory
+ * context.  The bitmap never exceeds runtime_filter_max_size, so returns
+ * NULL if that many values would saturate it.
+ */
+RuntimeFilter *
+RuntimeFilterCreate(int nkeys, double nvalues)
+{
+	RuntimeFilter *filter;
+	double		maxbits = (double) runtime_filter_max_size * 1024 * BITS_PER_BYTE;
+	double		wanted = nvalues * RUNTIME_FILTER_BITS_PER_VALUE;
+	uint32		nbits = RUNTIME_FILTER_MIN_BITS;
+
+	if (nvalues * RUNTIME_FILTER_MIN_BITS_PER_VALUE > maxbits)
+		return NULL;
+
+	while (nbits < wanted && nbits * 2.0 <= maxbits && nbits < PG_UINT32_MAX / 2)
+		nbits *= 2;
+
+	filter = (RuntimeFilter *) palloc0(sizeof(RuntimeFilter));
+	filter->nkeys = nkeys;
+	filter->keys = (RuntimeFilterKey *) palloc0(nkeys * sizeof(RuntimeFilterKey));
+	filter->nhashes = RUNTIME_FILTER_NHASHES;
+	filter->nbits = nbits;
+	filter->bits = (uint64 *) palloc0((nbits / 64) * sizeof(uint64));
+
+	return filter;
+}
+
+/*
+ * Is the filter still sparse enough to reject a useful share of rows?  The
+ * planner's estimate of the inner side may have been far too low.
+ */
+bool
+RuntimeFilterIsSelective(RuntimeFilter *filter)
+{
+	return filter->nvalues * RUNTIME_FILTER_MIN_BITS_PER_VALUE <= filter->nbits;
+}
+
+/*
+ * Append the filter to buf in network byte order, as expected by
+ * RuntimeFilterDeserialize.
+ */
+void
+RuntimeFilterSerialize(RuntimeFilter *filter, StringInfo buf)
+{
+	int			i;
+	uint32		w;
+
+	pq_sendint(buf, filter->nkeys, 2);
+	for (i = 0; i < filter->nkeys; i++)
+	{
+		RuntimeFilterKey *key = &filter->keys[i];
+
+		pq_sendint(buf, key->attno, 2);
+		pq_sendint(buf, key->typid, 4);
+		pq_sendint(buf, key->hashfn, 4);
+		pq_sendbyte(buf, key->strict ? 1 : 0);
+	}
+	pq_sendint(buf, filter->nhashes, 2);
+	pq_sendint(buf, filter->nbits, 4);
+	pq_sendint64(buf, filter->nvalues);
+	for (w = 0; w < filter->nbits / 64; w++)
+		pq_sendint64(buf, filter->bits[w]);
+}
+
+/*
+ * Read a filter at the cursor of msg.  Returns NULL if the sender had no
+ * filter, which is serialized as a zero number of keys.
+ */
+RuntimeFilter *
+RuntimeFilterDeserialize(StringInfo msg)
+{
+	RuntimeFilter *filter;
+	int			nkeys;
+	int			i;
+	uint32		w;
+
+	nkeys = pq_getmsgint(msg, 2);
+	if (nkeys <= 0)
+		return NULL;
+
+	filter = (RuntimeFilter *) palloc0(sizeof(RuntimeFilter));
+	filter->nkeys = nkeys;
+	filter->keys = (RuntimeFilterKey *) palloc0(nkeys * sizeof(RuntimeFilterKey));
+	for (i = 0; i < nkeys; i++)
+	{
+		RuntimeFilterKey *key = &filter->keys[i];
+
+		key->attno = pq_getmsgint(msg, 2);
+		key->typid = pq_getmsgint(msg, 4);
+		key->hashfn = pq_getmsgint(msg, 4);
+		key->strict = pq_getmsgbyte(msg) != 0;
+	}
+	filter->nhashes = pq_getmsgint(msg, 2);
+	filter->nbits = pq_getmsgint(msg, 4);
+	filter->nvalues = pq_getmsgint64(msg);
+
+	if (filter->nhashes <= 0 || filter->nbits < RUNTIME_FILTER_MIN_BITS ||
+		(filter->nbits & (filter->nbits - 1)) != 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("invalid runtime filter in message")));
+
+	filter->bits = (uint64 *) palloc((filter->nbits / 64) * sizeof(uint64));
+	for (w = 0; w < filter->nbits / 64; w++)
+		filter->bits[w] = pq_getmsgint64(msg);
+
+	return filter;
+}
+
+/*
+ * Check the filter's keys against the descriptor of the tuples it is going
+ * to be applied to, and look up the hash functions.  Returns false if the
+ * filter does not fit these tuples and must not be used.
+ */
+bool
+RuntimeFilterPrepare(RuntimeFilter *filter, TupleDesc tupdesc)
+{
+	int			i;
+
+	for (i = 0; i < filter->nkeys; i++)
+	{
+		RuntimeFilterKey *key = &filter->keys[i];
+		Form_pg_attribute attr;
+
+		if (key->attno < 1 || key->attno > tupdesc->natts)
+			return false;
+		attr = tupdesc->attrs[key->attno - 1];
+		if (attr->attisdropped || attr->atttypid != key->typid ||
+			!OidIsValid(key->hashfn))
+			return false;
+	}
+
+	filter->hashfunctions = (FmgrInfo *) palloc(filter->nkeys * sizeof(FmgrInfo));
+	for (i = 0; i < filter->nkeys; i++)
+		fmgr_info(filter->keys[i].hashfn, &filter->hashfunctions[i]);
+
+	return true;
+}
+
+/*
+ * Compute the hash join hash value of the keys of the tuple in slot, the way
+ * ExecHashGetHashValue does for an outer tuple.  Returns false if a key is
+ * NULL and the join operator is strict: such a tuple never has a match.
+ *
+ * The hash functions may leak memory, so the caller should be in a short
+ * lived memory context.
+ */
+bool
+RuntimeFilterHashSlot(RuntimeFilter *filter, TupleTableSlot *slot,
+					  uint32 *hashvalue)
+{
+	uint32		hashkey = 0;
+	int			i;
+
+	Assert(filter->hashfunctions != NULL);
+
+	for (i = 0; i < filter->nkeys; i++)
+	{
+		Datum		keyval;
+		bool		isNull;
+
+		/* rotate hashkey left 1 bit at each step */
+		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+		keyval = slot_getattr(slot, filter->keys[i].attno, &isNull);
+		if (isNull)
+		{
+			if (filter->keys[i].strict)
+				return false;
+			/* else, leave hashkey unmodified, equivalent to hashcode 0 */
+		}
+		else
+			hashkey ^= DatumGetUInt32(FunctionCall1(&filter->hashfunctions[i],
+													keyval));
+	}
+
+	*hashvalue = hashkey;
+	return true;
+}
+
+/*
+ * Can the tuple in slot have a match on the inner side of the join?
+ */
+bool
+RuntimeFilterCheckSlot(RuntimeFilter *filter, TupleTableSlot *slot)
+{
+	uint32		hashvalue;
+
+	filter->nchecked++;
+	if (!RuntimeFilterHashSlot(filter, slot, &hashvalue) ||
+		!RuntimeFilterTest(filter, hashvalue))
+	{
+		filter->nremoved++;
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Copy the filter into a new dynamic shared memory segment, for the backend
+ * producing the rows to import.  The segment belongs to the current resource
+ * owner and goes away with it; returns NULL if no segment is available.
+ */
+dsm_segment *
+RuntimeFilterExport(RuntimeFilter *filter)
+{
+	StringInfoData buf;
+	dsm_segment *seg;
+	RuntimeFilterShared *shared;
+
+	initStringInfo(&buf);
+	RuntimeFilterSerialize(filter, &buf);
+
+	seg = dsm_create(offsetof(RuntimeFilterShared, data) + buf.len,
+					 DSM_CREATE_NULL_IF_MAXSEGMENTS);
+	if (seg != NULL)
+	{
+		shared = (RuntimeFilterShared *) dsm_segment_address(seg);
+		shared->len = buf.len;
+		memcpy(shared->data, buf.data, buf.len);
+		shared->magic = RUNTIME_FILTER_MAGIC;
+	}
+	pfree(buf.data);
+
+	return seg;
+}
+
+/*
+ * Read back a filter exported by another backend.  The segment is only
+ * attached for the time of the copy, so the exporting backend is free to
+ * go away at any time; returns NULL if it already has.
+ */
+RuntimeFilter *
+RuntimeFilterImport(dsm_handle handle)
+{
+	dsm_segment *seg;
+	RuntimeFilterShared *shared;
+	RuntimeFilter *filter = NULL;
+	StringInfoData buf;
+
+	seg = dsm_attach(handle);
+	if (seg == NULL)
+		return NULL;
+
+	shared = (RuntimeFilterShared *) dsm_segment_address(seg);
+	if (dsm_segment_map_length(seg) >= offsetof(RuntimeFilterShared, data) &&
+		shared->magic == RUNTIME_FILTER_MAGIC &&
+		offsetof(RuntimeFilterShared, data) + shared->len <= dsm_segment_map_length(seg))
+	{
+		initStringInfo(&buf);
+		appendBinaryStringInfo(&buf, shared->data, shared->len);
+		filter = RuntimeFilterDeserialize(&buf);
+		pfree(buf.data);
+	}
+	dsm_detach(seg);
+
+	return filter;
+}
+
+/*
+ * Add the rows checked and removed by the filter since the last call to the
+ * counters of the node.  Called when the filter is done with, or at the end
+ * of each run of the portal applying it.
+ */
+void
+RuntimeFilterReport(RuntimeFilter *filter)
+{
+	if (filter->nchecked > 0)
+		RuntimeFilterCount(RUNTIME_FILTER_STAT_CHECKED, filter->nchecked);
+	if (filter->nremoved > 0)
+		RuntimeFilterCount(RUNTIME_FILTER_STAT_REMOVED, filter->nremoved);
+	filter->nchecked = 0;
+	filter->nremoved = 0;
+}
+
+void
+RuntimeFilterCount(RuntimeFilterStat stat, uint64 n)
+{
+	Assert(stat >= 0 && stat < RUNTIME_FILTER_NSTATS);
+
+	if (RuntimeFilterStatsShmem != NULL)
+		pg_atomic_fetch_add_u64(&RuntimeFilterStatsShmem->counters[stat], n);
+}
+
+Size
+RuntimeFilterShmemSize(void)
+{
+	return sizeof(RuntimeFilterStats);
+}
+
+void
+RuntimeFilterShmemInit(void)
+{
+	bool		found;
+	int			i;
+
+	RuntimeFilterStatsShmem = (RuntimeFilterStats *)
+		ShmemInitStruct("Runtime Filter Stats", RuntimeFilterShmemSize(), &found);
+	if (!found)
+	{
+		for (i = 0; i < RUNTIME_FILTER_NSTATS; i++)
+			pg_atomic_init_u64(&RuntimeFilterStatsShmem->counters[i], 0);
+	}
+}
+
+/*
+ * pg_stat_get_runtime_filter
+ *
+ * SQL-callable view of the runtime filter counters of this node.  The
+ * filters are built and sent by the consumers, received and applied by the
+ * producers, so a coordinator usually only shows the first two.
+ */
+Datum
+pg_stat_get_runtime_filter(PG_FUNCTION_ARGS)
+{
+	Datum		values[RUNTIME_FILTER_NSTATS];
+	bool		nulls[RUNTIME_FILTER_NSTATS];
+	TupleDesc	tupdesc;
+	HeapTuple	htup;
+	int			i;
+
+	tupdesc = CreateTemplateTupleDesc(RUNTIME_FILTER_NSTATS, false);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "built", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "sent", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 3, "received", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 4, "checked", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "removed", INT8OID, -1, 0);
+	tupdesc = BlessTupleDesc(tupdesc);
+
+	memset(nulls, 0, sizeof(nulls));
+	for (i = 0; i < RUNTIME_FILTER_NSTATS; i++)
+		values[i] = Int64GetDatum((int64)
+			pg_atomic_read_u64(&RuntimeFilterStatsShmem->counters[i]));
+
+	htup = heap_form_tuple(tupdesc, values, nulls);
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(htup));
+}
@@ -0,0 +1,591 @@
+/*-------------------------------------------------------------------------
+ *
+ * llvmjit.c
+ *      Core part of the LLVM JIT provider.
+ *
+ * Generated code is emitted through two LLJIT instances, one emitting code
+ * quickly without optimization and one running the full O3 pipeline, chosen
+ * per query by jit_optimize_above_cost.
+ *
+ * Every function is compiled into a module of its own, tracked by its own
+ * ORC resource tracker, so that it can be freed independently.  Compiled
+ * functions are kept in a per-backend cache keyed by everything the code
+ * was generated from (see llvmjit_expr.c), so that the next execution of a
+ * prepared statement - or any other query evaluating an expression of the
+ * same shape - finds its code already compiled.  Queries pin the functions
+ * they run; the least recently used unpinned functions are evicted once the
+ * cache holds more than jit_cache_size of them.
+ *
+ * Copyright (c) 2023 THL A29 Limited, a Tencent company.
+ *
+ * This source code file is licensed under the BSD 3-Clause License,
+ * you may obtain a copy of the License at http://opensource.org/license/bsd-3-clause/
+ *
+ * IDENTIFICATION
+ *      src/backend/jit/llvm/llvmjit.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <llvm-c/Error.h>
+#include <llvm-c/ErrorHandling.h>
+#include <llvm-c/LLJIT.h>
+#include <llvm-c/Orc.h>
+#include <llvm-c/Support.h>
+#include <llvm-c/Target.h>
+#include <llvm-c/TargetMachine.h>
+#include <llvm-c/Transforms/PassBuilder.h>
+
+#include "access/hash.h"
+#include "fmgr.h"
+#include "jit/llvmjit.h"
+#include "lib/ilist.h"
+#include "miscadmin.h"
+#include "portability/instr_time.h"
+#include "utils/hsearch.h"
+#include "utils/memutils.h"
+#include "utils/resowner_private.h"
+
+PG_MODULE_MAGIC;
+
+
+struct LLVMJitFunction
+{
+    /* cache key, or NULL if the function isn't in the cache */
+    char       *key;
+    int            keylen;
+    uint32        hash;
+
+    /* address of the emitted code */
+    void       *addr;
+
+    /* tracks the code's memory, removing it frees the function */
+    LLVMOrcResourceTrackerRef tracker;
+
+    /* number of queries running the function */
+    int            refcount;
+
+    /* position in the cache's LRU list, most recently used first */
+    dlist_node    lru_node;
+};
+
+typedef struct LLVMJitCacheKey
+{
+    uint32        hash;
+    int            keylen;
+    const char *key;
+} LLVMJitCacheKey;
+
+typedef struct LLVMJitCacheEntry
+{
+    LLVMJitCacheKey key;        /* hash key, must be first */
+    LLVMJitFunction *func;
+} LLVMJitCacheEntry;
+
+
+/* types used by generated code */
+LLVMTypeRef TypeSizeT;
+LLVMTypeRef TypeDatum;
+LLVMTypeRef TypeStorageBool;
+LLVMTypeRef TypeInt8Ptr;
+LLVMTypeRef TypeDatumPtr;
+LLVMTypeRef TypeVoid;
+
+static bool llvm_session_initialized = false;
+static size_t llvm_generation = 0;
+
+static char *llvm_triple = NULL;
+static char *llvm_layout = NULL;
+
+static LLVMOrcThreadSafeContextRef llvm_ts_context;
+static LLVMContextRef llvm_llvm_context;
+static LLVMTargetMachineRef llvm_opt3_targetmachine;
+static LLVMOrcLLJITRef llvm_opt0_orc;
+static LLVMOrcLLJITRef llvm_opt3_orc;
+
+/* compiled function cache */
+static MemoryContext llvm_cache_context = NULL;
+static HTAB *llvm_cache = NULL;
+static dlist_head llvm_cache_lru = DLIST_STATIC_INIT(llvm_cache_lru);
+static int    llvm_cache_nfunctions = 0;
+
+
+static void llvm_release_context(JitContext *context);
+static void llvm_session_initialize(void);
+static LLVMOrcLLJITRef llvm_create_jit_instance(LLVMCodeGenOptLevel level);
+static void llvm_fatal_error_handler(const char *reason);
+static char *llvm_error_message(LLVMErrorRef error);
+static void llvm_pin_function(LLVMJitContext *context, LLVMJitFunction *func);
+static void llvm_free_function(LLVMJitFunction *func);
+static void llvm_cache_insert(LLVMJitFunction *func, StringInfo key);
+static uint32 llvm_cache_hash(const void *key, Size keysize);
+static int    llvm_cache_match(const void *key1, const void *key2, Size keysize);
+
+
+/*
+ * Initialize LLVM JIT provider.
+ */
+void
+_PG_jit_provider_init(JitProviderCallbacks *cb)
+{
+    cb->release_context = llvm_release_context;
+    cb->compile_expr = llvm_compile_expr;
+}
+
+/*
+ * Create a context for JITing work.
+ *
+ * The context, including subsidiary resources, will be cleaned up either
+ * when the context is explicitly released, or when the lifetime of
+ * CurrentResourceOwner ends (usually the end of the current [sub]xact).
+ */
+LLVMJitContext *
+llvm_create_context(int jitFlags)
+{
+    LLVMJitContext *context;
+
+    llvm_session_initialize();
+
+    ResourceOwnerEnlargeJIT(CurrentResourceOwner);
+
+    context = MemoryContextAllocZero(TopMemoryContext,
+                                     sizeof(LLVMJitContext));
+    context->base.flags = jitFlags;
+
+    /* ensure cleanup */
+    context->base.resowner = CurrentResourceOwner;
+    ResourceOwnerRememberJIT(CurrentResourceOwner, PointerGetDatum(context));
+
+    return context;
+}
+
+/*
+ * Release resources required by one llvm context: unpin the functions the
+ * query ran, freeing those that aren't kept in the cache.
+ */
+static void
+llvm_release_context(JitContext *context)
+{
+    LLVMJitContext *llvm_context = (LLVMJitContext *) context;
+    int            i;
+
+    for (i = 0; i < llvm_context->nfunctions; i++)
+    {
+        LLVMJitFunction *func = llvm_context->functions[i];
+
+        Assert(func->refcount > 0);
+        if (--func->refcount == 0 && func->key == NULL)
+            llvm_free_function(func);
+    }
+
+    if (llvm_context->functions)
+        pfree(llvm_context->functions);
+    llvm_context->functions = NULL;
+    llvm_context->nfunctions = 0;
+}
+
+/*
+ * The LLVM context all code is generated in.
+ */
+LLVMContextRef
+llvm_context(void)
+{
+    return llvm_llvm_context;
+}
+
+/*
+ * Return a new module to generate one function into.
+ */
+LLVMModuleRef
+llvm_create_module(LLVMJitContext *context)
+{
+    LLVMModuleRef module;
+
+    module = LLVMModuleCreateWithNameInContext("pg", llvm_llvm_context);
+    LLVMSetTarget(module, llvm_triple);
+    LLVMSetDataLayout(module, llvm_layout);
+
+    return module;
+}
+
+/*
+ * Expand function name to be non-conflicting.  This should be used by code
+ * generating code, when adding new externally visible function definitions
+ * to a module.
+ */
+char *
+llvm_expand_funcname(LLVMJitContext *context, const char *basename)
+{
+    return psprintf("%s_%zu", basename, ++llvm_generation);
+}
+
+/*
+ * Return the address of a compiled function for 'key' from the cache,
+ * pinning it for the query, or NULL if there is none.
+ */
+void *
+llvm_cache_lookup(LLVMJitContext *context, StringInfo key)
+{
+    LLVMJitCacheKey hkey;
+    LLVMJitCacheEntry *entry;
+
+    if (llvm_cache == NULL)
+        return NULL;
+
+    hkey.hash = DatumGetUInt32(hash_any((unsigned char *) key->data, key->len));
+    hkey.keylen = key->len;
+    hkey.key = key->data;
+
+    entry = (LLVMJitCacheEntry *) hash_search(llvm_cache, &hkey, HASH_FIND, NULL);
+    if (entry == NULL)
+        return NULL;
+
+    dlist_move_head(&llvm_cache_lru, &entry->func->lru_node);
+    llvm_pin_function(context, entry->func);
+    context->base.instr.cached_functions++;
+
+    return entry->func->addr;
+}
+
+/*
+ * Optimize and emit the only function of 'module', returning its address.
+ * The module is consumed.  The function is pinned for the query and, if
+ * there is room, added to the cache under 'key'.
+ */
+void *
+llvm_emit_function(LLVMJitContext *context, LLVMModuleRef module,
+                   const char *funcname, StringInfo key)
+{
+    LLVMOrcLLJITRef lljit;
+    LLVMOrcResourceTrackerRef tracker;
+    LLVMOrcThreadSafeModuleRef ts_module;
+    LLVMOrcExecutorAddress addr;
+    LLVMPassBuilderOptionsRef options;
+    LLVMErrorRef error;
+    LLVMJitFunction *func;
+    instr_time    starttime;
+    instr_time    endtime;
+
+    /* optimize according to the chosen optimization settings */
+    INSTR_TIME_SET_CURRENT(starttime);
+    options = LLVMCreatePassBuilderOptions();
+    if (context->base.flags & PGJIT_OPT3)
+        error = LLVMRunPasses(module, "default<O3>",
+                              llvm_opt3_targetmachine, options);
+    else
+        error = LLVMRunPasses(module, "mem2reg",
+                              llvm_opt3_targetmachine, options);
+    LLVMDisposePassBuilderOptions(options);
+    if (error)
+    {
+        LLVMDisposeModule(module);
+        elog(ERROR, "failed to optimize JIT module: %s",
+             llvm_error_message(error));
+    }
+    INSTR_TIME_SET_CURRENT(endtime);
+    INSTR_TIME_ACCUM_DIFF(context->base.instr.optimization_counter,
+                          endtime, starttime);
+
+    /* emit the code */
+    INSTR_TIME_SET_CURRENT(starttime);
+    lljit = context->base.flags & PGJIT_OPT3 ? llvm_opt3_orc : llvm_opt0_orc;
+    tracker = LLVMOrcJITDylibCreateResourceTracker(LLVMOrcLLJITGetMainJITDylib(lljit));
+    ts_module = LLVMOrcCreateNewThreadSafeModule(module, llvm_ts_context);
+    error = LLVMOrcLLJITAddLLVMIRModuleWithRT(lljit, tracker, ts_module);
+    if (error)
+    {
+        LLVMOrcDisposeThreadSafeModule(ts_module);
+        LLVMOrcReleaseResourceTracker(tracker);
+        elog(ERROR, "failed to JIT module: %s", llvm_error_message(error));
+    }
+    error = LLVMOrcLLJITLookup(lljit, &addr, funcname);
+    if (error)
+    {
+        char       *msg = llvm_error_message(error);
+
+        error = LLVMOrcResourceTrackerRemove(tracker);
+        if (error)
+            LLVMConsumeError(error);
+        LLVMOrcReleaseResourceTracker(tracker);
+        elog(ERROR, "failed to JIT function \"%s\": %s", funcname, msg);
+    }
+    INSTR_TIME_SET_CURRENT(endtime);
+    INSTR_TIME_ACCUM_DIFF(context->base.instr.emission_counter,
+                          endtime, starttime);
+
+    func = MemoryContextAllocZero(llvm_cache_context, sizeof(LLVMJitFunction));
+    func->addr = (void *) addr;
+    func->tracker = tracker;
+
+    llvm_pin_function(context, func);
+    llvm_cache_insert(func, key);
+    context->base.instr.created_functions++;
+
+    return func->addr;
+}
+
+/*
+ * Remember that the query runs 'func', so it is kept until the query ends.
+ */
+static void
+llvm_pin_function(LLVMJitContext *context, LLVMJitFunction *func)
+{
+    if (context->nfunctions >= context->maxfunctions)
+    {
+        int            newmax = Max(context->maxfunctions * 2, 8);
+
+        if (context->functions == NULL)
+            context->functions = (LLVMJitFunction **)
+                MemoryContextAlloc(TopMemoryContext,
+                                   newmax * sizeof(LLVMJitFunction *));
+        else
+            context->functions = (LLVMJitFunction **)
+                repalloc(context->functions,
+                         newmax * sizeof(LLVMJitFunction *));
+        context->maxfunctions = newmax;
+    }
+
+    context->functions[context->nfunctions++] = func;
+    func->refcount++;
+}
+
+/*
+ * Free the code of a function no query runs and the cache doesn't hold.
+ */
+static void
+llvm_free_function(LLVMJitFunction *func)
+{
+    LLVMErrorRef error;
+
+    Assert(func->refcount == 0 && func->key == NULL);
+
+    error = LLVMOrcResourceTrackerRemove(func->tracker);
+    if (error)
+        elog(WARNING, "failed to free JIT function: %s",
+             llvm_error_message(error));
+    LLVMOrcReleaseResourceTracker(func->tracker);
+    pfree(func);
+}
+
+/*
+ * Add a new function to the cache, evicting the least recently used
+ * unpinned functions to stay within jit_cache_size.  If the cache is full
+ * of pinned functions, the new one stays private to the query.
+ */
+static void
+llvm_cache_insert(LLVMJitFunction *func, StringInfo key)
+{
+    LLVMJitCacheKey hkey;
+    LLVMJitCacheEntry *entry;
+    bool        found;
+
+    if (jit_cache_size <= 0)
+        return;
+
+    while (llvm_cache_nfunctions >= jit_cache_size)
+    {
+        LLVMJitFunction *victim = NULL;
+        dlist_iter    iter;
+
+        dlist_reverse_foreach(iter, &llvm_cache_lru)
+        {
+            LLVMJitFunction *cur = dlist_container(LLVMJitFunction, lru_node,
+                                                   iter.cur);
+
+            if (cur->refcount == 0)
+            {
+                victim = cur;
+                break;
+            }
+        }
+
+        if (victim == NULL)
+            return;
+
+        hkey.hash = victim->hash;
+        hkey.keylen = victim->keylen;
+        hkey.key = victim->key;
+        hash_search(llvm_cache, &hkey, HASH_REMOVE, NULL);
+        dlist_delete(&victim->lru_node);
+        llvm_cache_nfunctions--;
+
+        pfree(victim->key);
+        victim->key = NULL;
+        llvm_free_function(victim);
+    }
+
+    func->keylen = key->len;
+    func->key = MemoryContextAlloc(llvm_cache_context, key->len);
+    memcpy(func->key, key->data, key->len);
+    func->hash = DatumGetUInt32(hash_any((unsigned char *) key->data, key->len));
+
+    hkey.hash = func->hash;
+    hkey.keylen = func->keylen;
+    hkey.key = func->key;
+    entry = (LLVMJitCacheEntry *) hash_search(llvm_cache, &hkey, HASH_ENTER,
+                                              &found);
+    Assert(!found);
+    entry->func = func;
+
+    dlist_push_head(&llvm_cache_lru, &func->lru_node);
+    llvm_cache_nfunctions++;
+}
+
+static uint32
+llvm_cache_hash(const void *key, Size keysize)
+{
+    return ((const LLVMJitCacheKey *) key)->hash;
+}
+
+static int
+llvm_cache_match(const void *key1, const void *key2, Size keysize)
+{
+    const LLVMJitCacheKey *k1 = (const LLVMJitCacheKey *) key1;
+    const LLVMJitCacheKey *k2 = (const LLVMJitCacheKey *) key2;
+
+    if (k1->hash != k2->hash || k1->keylen != k2->keylen)
+        return 1;
+    return memcmp(k1->key, k2->key, k1->keylen);
+}
+
+/*
+ * Per session initialization.
+ */
+static void
+llvm_session_initialize(void)
+{
+    LLVMTargetRef target;
+    LLVMTargetDataRef layout;
+    char       *triple;
+    char       *error = NULL;
+    char       *cpu;
+    char       *features;
+    char       *tmp;
+    HASHCTL        ctl;
+
+    if (llvm_session_initialized)
+        return;
+
+    LLVMInitializeNativeTarget();
+    LLVMInitializeNativeAsmPrinter();
+    LLVMInitializeNativeAsmParser();
+
+    /* report LLVM failures in a way the server can deal with */
+    LLVMInstallFatalErrorHandler(llvm_fatal_error_handler);
+
+    /*
+     * Synchronize types early, as that also includes the target triple and
+     * layout of the generated code.
+     */
+    triple = LLVMGetDefaultTargetTriple();
+    if (LLVMGetTargetFromTriple(triple, &target, &error) != 0)
+        elog(FATAL, "failed to query triple %s", error);
+    llvm_triple = MemoryContextStrdup(TopMemoryContext, triple);
+
+    cpu = LLVMGetHostCPUName();
+    features = LLVMGetHostCPUFeatures();
+    elog(DEBUG2, "LLVMJIT detected CPU \"%s\", with features \"%s\"",
+         cpu, features);
+
+    /* target machine used to run optimization passes */
+    llvm_opt3_targetmachine =
+        LLVMCreateTargetMachine(target, triple, cpu, features,
+                                LLVMCodeGenLevelAggressive,
+                                LLVMRelocDefault,
+                                LLVMCodeModelJITDefault);
+    layout = LLVMCreateTargetDataLayout(llvm_opt3_targetmachine);
+    tmp = LLVMCopyStringRepOfTargetData(layout);
+    llvm_layout = MemoryContextStrdup(TopMemoryContext, tmp);
+    LLVMDisposeMessage(tmp);
+    LLVMDisposeTargetData(layout);
+
+    LLVMDisposeMessage(triple);
+    LLVMDisposeMessage(cpu);
+    LLVMDisposeMessage(features);
+
+    llvm_ts_context = LLVMOrcCreateNewThreadSafeContext();
+    llvm_llvm_context = LLVMOrcThreadSafeContextGetContext(llvm_ts_context);
+
+    TypeSizeT = LLVMIntTypeInContext(llvm_llvm_context, sizeof(size_t) * 8);
+    TypeDatum = LLVMIntTypeInContext(llvm_llvm_context, SIZEOF_DATUM * 8);
+    TypeStorageBool = LLVMIntTypeInContext(llvm_llvm_context, sizeof(bool) * 8);
+    TypeInt8Ptr = LLVMPointerType(LLVMInt8TypeInContext(llvm_llvm_context), 0);
+    TypeDatumPtr = LLVMPointerType(TypeDatum, 0);
+    TypeVoid = LLVMVoidTypeInContext(llvm_llvm_context);
+
+    llvm_opt0_orc = llvm_create_jit_instance(LLVMCodeGenLevelNone);
+    llvm_opt3_orc = llvm_create_jit_instance(LLVMCodeGenLevelAggressive);
+
+    llvm_cache_context = AllocSetContextCreate(TopMemoryContext,
+                                               "LLVM JIT cache",
+                                               ALLOCSET_SMALL_SIZES);
+
+    MemSet(&ctl, 0, sizeof(ctl));
+    ctl.keysize = sizeof(LLVMJitCacheKey);
+    ctl.entrysize = sizeof(LLVMJitCacheEntry);
+    ctl.hash = llvm_cache_hash;
+    ctl.match = llvm_cache_match;
+    ctl.hcxt = llvm_cache_context;
+    llvm_cache = hash_create("LLVM JIT cache", 256, &ctl,
+                             HASH_ELEM | HASH_FUNCTION | HASH_COMPARE |
+                             HASH_CONTEXT);
+
+    llvm_session_initialized = true;
+}
+
+static LLVMOrcLLJITRef
+llvm_create_jit_instance(LLVMCodeGenOptLevel level)
+{
+    LLVMOrcJITTargetMachineBuilderRef tm_builder;
+    LLVMOrcLLJITBuilderRef lljit_builder;
+    LLVMOrcLLJITRef lljit;
+    LLVMTargetRef target;
+    LLVMTargetMachineRef tm;
+    LLVMErrorRef error;
+    char       *err = NULL;
+    char       *cpu = LLVMGetHostCPUName();
+    char       *features = LLVMGetHostCPUFeatures();
+
+    if (LLVMGetTargetFromTriple(llvm_triple, &target, &err) != 0)
+        elog(FATAL, "failed to query triple %s", err);
+
+    tm = LLVMCreateTargetMachine(target, llvm_triple, cpu, features, level,
+                                 LLVMRelocDefault, LLVMCodeModelJITDefault);
+    LLVMDisposeMessage(cpu);
+    LLVMDisposeMessage(features);
+
+    /* the builders take ownership of the target machine, and of each other */
+    tm_builder = LLVMOrcJITTargetMachineBuilderCreateFromTargetMachine(tm);
+    lljit_builder = LLVMOrcCreateLLJITBuilder();
+    LLVMOrcLLJITBuilderSetJITTargetMachineBuilder(lljit_builder, tm_builder);
+
+    error = LLVMOrcCreateLLJIT(&lljit, lljit_builder);
+    if (error)
+        elog(FATAL, "failed to create lljit instance: %s",
+             llvm_error_message(error));
+
+    return lljit;
+}
+
+static void
+llvm_fatal_error_handler(const char *reason)
+{
+    ereport(FATAL,
+            (errcode(ERRCODE_OUT_OF_MEMORY),
+             errmsg("fatal llvm error: %s", reason)));
+}
+
+/*
+ * Return a palloc'd copy of the message of an LLVM error, consuming it.
+ */
+static char *
+llvm_error_message(LLVMErrorRef error)
+{
+    char       *orig = LLVMGetErrorMessage(error);
+    char       *msg = pstrdup(orig);
+
+    LLVMDisposeErrorMessage(orig);
+
+    return msg;
+}
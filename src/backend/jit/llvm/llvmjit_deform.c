@@ -0,0 +1,372 @@
+/*-------------------------------------------------------------------------
+ *
+ * llvmjit_deform.c
+ *      Generate code for deforming a heap tuple.
+ *
+ * This gains performance over unJITed deforming from compile-time knowledge
+ * of the tuple descriptor: the loop over the attributes is unrolled, and
+ * each attribute's length, alignment and by-value-ness is a constant.
+ *
+ * Tuples the generated code isn't prepared for - DataRow tuples, virtual
+ * slots and tuples with fewer attributes than requested - are handed to
+ * slot_getsomeattrs().
+ *
+ * Copyright (c) 2023 THL A29 Limited, a Tencent company.
+ *
+ * This source code file is licensed under the BSD 3-Clause License,
+ * you may obtain a copy of the License at http://opensource.org/license/bsd-3-clause/
+ *
+ * IDENTIFICATION
+ *      src/backend/jit/llvm/llvmjit_deform.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <string.h>
+
+#include "access/htup_details.h"
+#include "executor/tuptable.h"
+#include "jit/llvmjit.h"
+#ifdef _MLS_
+#include "utils/relcrypt.h"
+#endif
+
+
+/*
+ * Can the deforming of the first 'natts' attributes of tuples of 'desc' be
+ * JIT compiled?
+ */
+bool
+llvm_deform_supported(TupleDesc desc, int natts)
+{
+    int            attnum;
+
+    if (desc == NULL || natts <= 0 || natts > desc->natts)
+        return false;
+
+#ifdef _MLS_
+    /* attributes are described by attrs_ext, leave that to the interpreter */
+    if (TRANSP_CRYPT_ATTRS_EXT_IS_ENABLED(desc))
+        return false;
+#endif
+
+    for (attnum = 0; attnum < natts; attnum++)
+    {
+        Form_pg_attribute att = desc->attrs[attnum];
+
+        if (att->attbyval &&
+            att->attlen != 1 && att->attlen != 2 &&
+            att->attlen != 4 && att->attlen != 8)
+            return false;
+        if (!att->attbyval && att->attlen <= 0 &&
+            att->attlen != -1 && att->attlen != -2)
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * Append everything slot_compile_deform() generates code from to a cache
+ * key.
+ */
+void
+llvm_deform_cache_key(StringInfo key, TupleDesc desc, int natts)
+{
+    int            attnum;
+
+    appendBinaryStringInfo(key, (char *) &natts, sizeof(natts));
+    for (attnum = 0; attnum < natts; attnum++)
+    {
+        Form_pg_attribute att = desc->attrs[attnum];
+
+        appendBinaryStringInfo(key, (char *) &att->attlen, sizeof(att->attlen));
+        appendStringInfoChar(key, att->attalign);
+        appendStringInfoChar(key, att->attbyval ? 't' : 'f');
+    }
+}
+
+/*
+ * Create a function that deforms the first 'natts' attributes of a heap
+ * tuple of 'desc' into a slot.  The function takes the slot as argument and
+ * continues where an earlier deforming of the slot's tuple stopped.
+ */
+LLVMValueRef
+slot_compile_deform(LLVMJitContext *context, LLVMModuleRef mod,
+                    TupleDesc desc, int natts)
+{
+    LLVMContextRef lc = llvm_context();
+    LLVMTypeRef i8 = LLVMInt8TypeInContext(lc);
+    LLVMTypeRef i16 = LLVMInt16TypeInContext(lc);
+    LLVMTypeRef i32 = LLVMInt32TypeInContext(lc);
+    LLVMTypeRef tlong = LLVMIntTypeInContext(lc, sizeof(long) * 8);
+    LLVMTypeRef deform_type;
+    LLVMTypeRef getsomeattrs_type;
+    LLVMTypeRef varsize_type;
+    LLVMTypeRef strlen_type;
+    LLVMBuilderRef b;
+    LLVMValueRef v_deform_fn;
+    LLVMBasicBlockRef b_entry;
+    LLVMBasicBlockRef b_resume;
+    LLVMBasicBlockRef b_fallback;
+    LLVMBasicBlockRef b_out;
+    LLVMBasicBlockRef *attcheckblocks;
+    LLVMValueRef v_slot;
+    LLVMValueRef v_tuple;
+    LLVMValueRef v_tupdata;
+    LLVMValueRef v_tp;
+    LLVMValueRef v_bits;
+    LLVMValueRef v_hasnulls;
+    LLVMValueRef v_values;
+    LLVMValueRef v_nulls;
+    LLVMValueRef v_nvalid;
+    LLVMValueRef v_offp;
+    LLVMValueRef v_switch;
+    LLVMValueRef v_cond;
+    LLVMValueRef v_tmp;
+    LLVMTypeRef param_types[2];
+    LLVMValueRef params[2];
+    char       *funcname;
+    int            attnum;
+
+    Assert(llvm_deform_supported(desc, natts));
+
+    funcname = llvm_expand_funcname(context, "deform");
+
+    deform_type = LLVMFunctionType(TypeVoid, &TypeInt8Ptr, 1, false);
+    param_types[0] = TypeInt8Ptr;
+    param_types[1] = i32;
+    getsomeattrs_type = LLVMFunctionType(TypeVoid, param_types, 2, false);
+    varsize_type = LLVMFunctionType(TypeSizeT, &TypeInt8Ptr, 1, false);
+    strlen_type = LLVMFunctionType(TypeSizeT, &TypeInt8Ptr, 1, false);
+
+    v_deform_fn = LLVMAddFunction(mod, funcname, deform_type);
+    LLVMSetLinkage(v_deform_fn, LLVMInternalLinkage);
+
+    b = LLVMCreateBuilderInContext(lc);
+
+    b_entry = LLVMAppendBasicBlockInContext(lc, v_deform_fn, "entry");
+    b_resume = LLVMAppendBasicBlockInContext(lc, v_deform_fn, "resume");
+    b_fallback = LLVMAppendBasicBlockInContext(lc, v_deform_fn, "fallback");
+    attcheckblocks = palloc(sizeof(LLVMBasicBlockRef) * (natts + 1));
+    for (attnum = 0; attnum < natts; attnum++)
+        attcheckblocks[attnum] =
+            LLVMAppendBasicBlockInContext(lc, v_deform_fn, "attcheck");
+    b_out = LLVMAppendBasicBlockInContext(lc, v_deform_fn, "out");
+    attcheckblocks[natts] = b_out;
+
+    LLVMPositionBuilderAtEnd(b, b_entry);
+
+    v_slot = LLVMGetParam(v_deform_fn, 0);
+    v_offp = LLVMBuildAlloca(b, tlong, "v_offp");
+
+    /* only physical heap tuples are deformed here */
+    v_tuple = l_load_field(b, v_slot, offsetof(TupleTableSlot, tts_tuple),
+                           TypeInt8Ptr, "tuple");
+    v_cond = LLVMBuildIsNull(b, v_tuple, "");
+#ifdef PGXC
+    v_tmp = l_load_field(b, v_slot, offsetof(TupleTableSlot, tts_datarow),
+                         TypeInt8Ptr, "datarow");
+    v_cond = LLVMBuildOr(b, v_cond, LLVMBuildIsNotNull(b, v_tmp, ""), "");
+#endif
+    LLVMBuildCondBr(b, v_cond, b_fallback, b_resume);
+
+    /* the tuple must have all the attributes we deform */
+    LLVMPositionBuilderAtEnd(b, b_resume);
+    v_tupdata = l_load_field(b, v_tuple, offsetof(HeapTupleData, t_data),
+                             TypeInt8Ptr, "tupdata");
+    v_tmp = l_load_field(b, v_tupdata,
+                         offsetof(HeapTupleHeaderData, t_infomask2),
+                         i16, "infomask2");
+    v_tmp = LLVMBuildAnd(b, v_tmp, l_int16_const(HEAP_NATTS_MASK), "maxatt");
+    v_cond = LLVMBuildICmp(b, LLVMIntSLT, v_tmp, l_int16_const(natts), "");
+
+    v_tmp = l_load_field(b, v_tupdata,
+                         offsetof(HeapTupleHeaderData, t_infomask),
+                         i16, "infomask");
+    v_tmp = LLVMBuildAnd(b, v_tmp, l_int16_const(HEAP_HASNULL), "");
+    v_hasnulls = LLVMBuildICmp(b, LLVMIntNE, v_tmp, l_int16_const(0),
+                               "hasnulls");
+
+    v_tmp = l_load_field(b, v_tupdata,
+                         offsetof(HeapTupleHeaderData, t_hoff), i8, "hoff");
+    v_tmp = LLVMBuildZExt(b, v_tmp, TypeSizeT, "");
+    v_tp = LLVMBuildGEP2(b, i8, v_tupdata, &v_tmp, 1, "tp");
+    v_tmp = l_sizet_const(offsetof(HeapTupleHeaderData, t_bits));
+    v_bits = LLVMBuildGEP2(b, i8, v_tupdata, &v_tmp, 1, "bits");
+
+    v_values = l_load_field(b, v_slot, offsetof(TupleTableSlot, tts_values),
+                            TypeDatumPtr, "values");
+    v_nulls = l_load_field(b, v_slot, offsetof(TupleTableSlot, tts_isnull),
+                           TypeInt8Ptr, "nulls");
+
+    /* continue where the previous deforming of this tuple stopped */
+    v_nvalid = l_load_field(b, v_slot, offsetof(TupleTableSlot, tts_nvalid),
+                            i32, "nvalid");
+    v_tmp = l_load_field(b, v_slot, offsetof(TupleTableSlot, tts_off),
+                         tlong, "");
+    v_tmp = LLVMBuildSelect(b,
+                            LLVMBuildICmp(b, LLVMIntEQ, v_nvalid,
+                                          l_int32_const(0), ""),
+                            LLVMConstInt(tlong, 0, false), v_tmp, "");
+    LLVMBuildStore(b, v_tmp, v_offp);
+
+    {
+        LLVMBasicBlockRef b_dispatch;
+
+        b_dispatch = LLVMInsertBasicBlockInContext(lc, attcheckblocks[0],
+                                                   "dispatch");
+        LLVMBuildCondBr(b, v_cond, b_fallback, b_dispatch);
+
+        LLVMPositionBuilderAtEnd(b, b_dispatch);
+        v_switch = LLVMBuildSwitch(b, v_nvalid, b_fallback, natts);
+        for (attnum = 0; attnum < natts; attnum++)
+            LLVMAddCase(v_switch, l_int32_const(attnum),
+                        attcheckblocks[attnum]);
+    }
+
+    for (attnum = 0; attnum < natts; attnum++)
+    {
+        Form_pg_attribute att = desc->attrs[attnum];
+        LLVMBasicBlockRef b_checkbit;
+        LLVMBasicBlockRef b_isnull;
+        LLVMBasicBlockRef b_notnull;
+        LLVMValueRef v_idx = l_int32_const(attnum);
+        LLVMValueRef v_off;
+        LLVMValueRef v_attptr;
+        LLVMValueRef v_value;
+        int            alignto;
+
+        LLVMPositionBuilderAtEnd(b, attcheckblocks[attnum]);
+
+        b_checkbit = LLVMInsertBasicBlockInContext(lc, attcheckblocks[attnum + 1],
+                                                   "checkbit");
+        b_isnull = LLVMInsertBasicBlockInContext(lc, attcheckblocks[attnum + 1],
+                                                 "isnull");
+        b_notnull = LLVMInsertBasicBlockInContext(lc, attcheckblocks[attnum + 1],
+                                                  "notnull");
+
+        /* att_isnull(attnum, bits), if the tuple has a null bitmap */
+        LLVMBuildCondBr(b, v_hasnulls, b_checkbit, b_notnull);
+
+        LLVMPositionBuilderAtEnd(b, b_checkbit);
+        v_tmp = l_int32_const(attnum >> 3);
+        v_tmp = LLVMBuildLoad2(b, i8, LLVMBuildGEP2(b, i8, v_bits, &v_tmp, 1, ""),
+                               "nullbyte");
+        v_tmp = LLVMBuildAnd(b, v_tmp, l_int8_const(1 << (attnum & 0x07)), "");
+        v_cond = LLVMBuildICmp(b, LLVMIntEQ, v_tmp, l_int8_const(0), "attisnull");
+        LLVMBuildCondBr(b, v_cond, b_isnull, b_notnull);
+
+        LLVMPositionBuilderAtEnd(b, b_isnull);
+        LLVMBuildStore(b, LLVMConstInt(TypeDatum, 0, false),
+                       l_elem_ptr(b, TypeDatum, v_values, v_idx));
+        LLVMBuildStore(b, l_sbool_const(true),
+                       l_elem_ptr(b, TypeStorageBool, v_nulls, v_idx));
+        LLVMBuildBr(b, attcheckblocks[attnum + 1]);
+
+        LLVMPositionBuilderAtEnd(b, b_notnull);
+        LLVMBuildStore(b, l_sbool_const(false),
+                       l_elem_ptr(b, TypeStorageBool, v_nulls, v_idx));
+
+        v_off = LLVMBuildLoad2(b, tlong, v_offp, "off");
+
+        /* align the offset, see att_align_pointer() and att_align_nominal() */
+        if (att->attalign == 'i')
+            alignto = ALIGNOF_INT;
+        else if (att->attalign == 's')
+            alignto = ALIGNOF_SHORT;
+        else if (att->attalign == 'd')
+            alignto = ALIGNOF_DOUBLE;
+        else
+            alignto = 1;
+
+        if (alignto > 1)
+        {
+            LLVMValueRef v_aligned;
+
+            v_aligned = LLVMBuildAdd(b, v_off,
+                                     LLVMConstInt(tlong, alignto - 1, false), "");
+            v_aligned = LLVMBuildAnd(b, v_aligned,
+                                     LLVMConstInt(tlong, ~((uint64) alignto - 1), true),
+                                     "aligned");
+
+            if (att->attlen == -1)
+            {
+                /* a nonzero byte starts a short varlena, which isn't aligned */
+                v_tmp = LLVMBuildLoad2(b, i8,
+                                       LLVMBuildGEP2(b, i8, v_tp, &v_off, 1, ""),
+                                       "");
+                v_cond = LLVMBuildICmp(b, LLVMIntNE, v_tmp, l_int8_const(0), "");
+                v_off = LLVMBuildSelect(b, v_cond, v_off, v_aligned, "");
+            }
+            else
+                v_off = v_aligned;
+        }
+
+        v_attptr = LLVMBuildGEP2(b, i8, v_tp, &v_off, 1, "attptr");
+
+        /* fetch_att() */
+        if (att->attbyval)
+        {
+            LLVMTypeRef vartype = LLVMIntTypeInContext(lc, att->attlen * 8);
+
+            v_value = LLVMBuildLoad2(b, vartype,
+                                     LLVMBuildBitCast(b, v_attptr,
+                                                      l_ptr(vartype), ""),
+                                     "");
+#if CHAR_MIN == 0
+            if (att->attlen == 1)
+                v_value = LLVMBuildZExt(b, v_value, TypeDatum, "");
+            else
+#endif
+                v_value = LLVMBuildSExt(b, v_value, TypeDatum, "");
+        }
+        else
+            v_value = LLVMBuildPtrToInt(b, v_attptr, TypeDatum, "");
+        LLVMBuildStore(b, v_value, l_elem_ptr(b, TypeDatum, v_values, v_idx));
+
+        /* att_addlength_pointer() */
+        if (att->attlen > 0)
+            v_tmp = LLVMConstInt(tlong, att->attlen, false);
+        else if (att->attlen == -1)
+            v_tmp = LLVMBuildZExtOrBitCast(b,
+                                           l_call(b, varsize_type, varsize_any,
+                                                  &v_attptr, 1, "varsize"),
+                                           tlong, "");
+        else
+        {
+            v_tmp = l_call(b, strlen_type, strlen, &v_attptr, 1, "strlen");
+            v_tmp = LLVMBuildAdd(b, LLVMBuildZExtOrBitCast(b, v_tmp, tlong, ""),
+                                 LLVMConstInt(tlong, 1, false), "");
+        }
+        LLVMBuildStore(b, LLVMBuildAdd(b, v_off, v_tmp, ""), v_offp);
+
+        LLVMBuildBr(b, attcheckblocks[attnum + 1]);
+    }
+
+    /*
+     * Save state for the next deforming.  As the offsets aren't checked
+     * against attcacheoff, later deforming has to take the slow path.
+     */
+    LLVMPositionBuilderAtEnd(b, b_out);
+    l_store_field(b, l_int32_const(natts), v_slot,
+                  offsetof(TupleTableSlot, tts_nvalid));
+    l_store_field(b, LLVMBuildLoad2(b, tlong, v_offp, ""), v_slot,
+                  offsetof(TupleTableSlot, tts_off));
+    l_store_field(b, l_sbool_const(true), v_slot,
+                  offsetof(TupleTableSlot, tts_slow));
+    LLVMBuildRetVoid(b);
+
+    /* tuples the code isn't specialized for */
+    LLVMPositionBuilderAtEnd(b, b_fallback);
+    params[0] = v_slot;
+    params[1] = l_int32_const(natts);
+    l_call(b, getsomeattrs_type, slot_getsomeattrs, params, 2, "");
+    LLVMBuildRetVoid(b);
+
+    LLVMDisposeBuilder(b);
+    pfree(attcheckblocks);
+
+    return v_deform_fn;
+}
@@ -0,0 +1,1498 @@
+/*-------------------------------------------------------------------------
+ *
+ * llvmjit_expr.c
+ *      JIT compile expressions.
+ *
+ * An expression is compiled the first time it is evaluated, when the slots
+ * it reads from are known: the generated function follows the expression's
+ * steps with the dispatch between them, the fetching of attributes and the
+ * common opcodes inlined, calling the ExecEval* functions of
+ * execExprInterp.c for everything else.
+ *
+ * The generated code only depends on the shape of the expression: the
+ * opcodes, jump targets, attribute numbers and called functions.  Anything
+ * specific to one execution - constants, parameter values, the addresses of
+ * argument workspaces - is loaded at runtime from the ExprState's steps.
+ * That allows the backend's code cache to hand the same function to every
+ * ExprState of the same shape, so e.g. the second execution of a prepared
+ * statement finds all its expressions already compiled.
+ *
+ * Copyright (c) 2023 THL A29 Limited, a Tencent company.
+ *
+ * This source code file is licensed under the BSD 3-Clause License,
+ * you may obtain a copy of the License at http://opensource.org/license/bsd-3-clause/
+ *
+ * IDENTIFICATION
+ *      src/backend/jit/llvm/llvmjit_expr.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "executor/execExpr.h"
+#include "jit/llvmjit.h"
+#include "nodes/execnodes.h"
+#include "portability/instr_time.h"
+#include "utils/expandeddatum.h"
+
+
+/* signatures of the out-of-line step implementations */
+typedef enum LLVMEvalHelperKind
+{
+    EVAL_HELPER_OP,                /* void fn(ExprState *, ExprEvalStep *) */
+    EVAL_HELPER_OP_ECONTEXT        /* ... plus ExprContext * */
+} LLVMEvalHelperKind;
+
+
+static Datum ExecCompiledExprFirst(ExprState *state, ExprContext *econtext,
+                      bool *isNull);
+static bool llvm_expr_step_supported(ExprEvalOp opcode);
+static ExprEvalOp llvm_expr_normalize_op(ExprEvalOp opcode);
+static void *llvm_prepare_expr(ExprState *state, ExprContext *econtext);
+static void llvm_expr_cache_key(ExprState *state, int flags, StringInfo key);
+static void *llvm_generate_expr(LLVMJitContext *context, ExprState *state,
+                   StringInfo key);
+static void build_EvalHelper(LLVMBuilderRef b, void *fnaddr,
+                 LLVMEvalHelperKind kind, LLVMValueRef v_state,
+                 LLVMValueRef v_op, LLVMValueRef v_econtext);
+
+
+/*
+ * JIT compile expression, if supported.  Compilation itself is deferred to
+ * the first evaluation.
+ */
+bool
+llvm_compile_expr(ExprState *state)
+{
+    int            i;
+
+    Assert(state->steps[state->steps_len - 1].opcode == EEOP_DONE);
+
+    /*
+     * The fast-path evalfuncs ExecReadyInterpretedExpr() picks for plain Vars
+     * and Consts are already about as cheap as generated code would be.
+     */
+    if (state->steps_len == 3)
+    {
+        ExprEvalOp    step0 = state->steps[0].opcode;
+        ExprEvalOp    step1 = state->steps[1].opcode;
+
+        if ((step0 == EEOP_INNER_FETCHSOME &&
+             (step1 == EEOP_INNER_VAR_FIRST || step1 == EEOP_ASSIGN_INNER_VAR)) ||
+            (step0 == EEOP_OUTER_FETCHSOME &&
+             (step1 == EEOP_OUTER_VAR_FIRST || step1 == EEOP_ASSIGN_OUTER_VAR)) ||
+            (step0 == EEOP_SCAN_FETCHSOME &&
+             (step1 == EEOP_SCAN_VAR_FIRST || step1 == EEOP_ASSIGN_SCAN_VAR)))
+            return false;
+    }
+    else if (state->steps_len == 2 &&
+             state->steps[0].opcode == EEOP_CONST)
+        return false;
+
+    for (i = 0; i < state->steps_len; i++)
+    {
+        if (!llvm_expr_step_supported(state->steps[i].opcode))
+            return false;
+    }
+
+    state->evalfunc = ExecCompiledExprFirst;
+
+    return true;
+}
+
+/*
+ * First evaluation of an expression: compile it, or fall back to the
+ * interpreter if that isn't possible, and evaluate it.
+ */
+static Datum
+ExecCompiledExprFirst(ExprState *state, ExprContext *econtext, bool *isNull)
+{
+    void       *func;
+
+    func = llvm_prepare_expr(state, econtext);
+    if (func != NULL)
+        state->evalfunc = (ExprStateEvalFunc) func;
+    else
+        ExecReadyInterpretedExpr(state);
+
+    return state->evalfunc(state, econtext, isNull);
+}
+
+/*
+ * Can code be generated for the opcode?
+ */
+static bool
+llvm_expr_step_supported(ExprEvalOp opcode)
+{
+    switch (opcode)
+    {
+        case EEOP_IOCOERCE:
+        case EEOP_ROWCOMPARE_STEP:
+        case EEOP_ROWCOMPARE_FINAL:
+        case EEOP_LAST:
+            return false;
+        default:
+            return opcode < EEOP_LAST;
+    }
+}
+
+/*
+ * The _FIRST variants of the Var opcodes only differ in checks done once,
+ * before generating code.
+ */
+static ExprEvalOp
+llvm_expr_normalize_op(ExprEvalOp opcode)
+{
+    switch (opcode)
+    {
+        case EEOP_INNER_VAR_FIRST:
+            return EEOP_INNER_VAR;
+        case EEOP_OUTER_VAR_FIRST:
+            return EEOP_OUTER_VAR;
+        case EEOP_SCAN_VAR_FIRST:
+            return EEOP_SCAN_VAR;
+        default:
+            return opcode;
+    }
+}
+
+/*
+ * Do the checks of the first evaluation, then find the expression's code in
+ * the cache or generate it.  Returns NULL if the expression has to be
+ * interpreted after all.
+ */
+static void *
+llvm_prepare_expr(ExprState *state, ExprContext *econtext)
+{
+    EState       *estate = state->parent->state;
+    LLVMJitContext *context;
+    StringInfoData key;
+    void       *func;
+    int            i;
+
+    if (estate->es_jit == NULL)
+        estate->es_jit = &llvm_create_context(estate->es_jit_flags)->base;
+    context = (LLVMJitContext *) estate->es_jit;
+
+    for (i = 0; i < state->steps_len; i++)
+    {
+        ExprEvalStep *op = &state->steps[i];
+        ExprEvalOp    opcode = op->opcode;
+        TupleTableSlot *slot = NULL;
+
+        switch (opcode)
+        {
+            case EEOP_INNER_VAR_FIRST:
+            case EEOP_INNER_FETCHSOME:
+                slot = econtext->ecxt_innertuple;
+                break;
+            case EEOP_OUTER_VAR_FIRST:
+            case EEOP_OUTER_FETCHSOME:
+                slot = econtext->ecxt_outertuple;
+                break;
+            case EEOP_SCAN_VAR_FIRST:
+            case EEOP_SCAN_FETCHSOME:
+                slot = econtext->ecxt_scantuple;
+                break;
+            default:
+                continue;
+        }
+
+        if (opcode == EEOP_INNER_FETCHSOME ||
+            opcode == EEOP_OUTER_FETCHSOME ||
+            opcode == EEOP_SCAN_FETCHSOME)
+        {
+            /*
+             * Specialize the deforming for the descriptor the slot has now.
+             * Slots keep their descriptor for the life of the plan node, the
+             * generated code still checks it before using the deforming.
+             */
+            op->d.fetch.known_desc = NULL;
+            if (slot != NULL &&
+                (context->base.flags & PGJIT_DEFORM) &&
+                llvm_deform_supported(slot->tts_tupleDescriptor,
+                                      op->d.fetch.last_var))
+                op->d.fetch.known_desc = slot->tts_tupleDescriptor;
+        }
+        else
+        {
+            /* see EEOP_INNER_VAR_FIRST in ExecInterpExpr() */
+            if (slot == NULL)
+                return NULL;
+            CheckVarSlotCompatibility(slot, op->d.var.attnum + 1,
+                                      op->d.var.vartype);
+        }
+    }
+
+    initStringInfo(&key);
+    llvm_expr_cache_key(state, context->base.flags, &key);
+
+    func = llvm_cache_lookup(context, &key);
+    if (func == NULL)
+        func = llvm_generate_expr(context, state, &key);
+
+    pfree(key.data);
+
+    return func;
+}
+
+/*
+ * Build the cache key of an expression: everything llvm_generate_expr()
+ * emits as constants into the code.
+ */
+static void
+llvm_expr_cache_key(ExprState *state, int flags, StringInfo key)
+{
+    int            i;
+
+    flags &= (PGJIT_OPT3 | PGJIT_DEFORM);
+    appendBinaryStringInfo(key, (char *) &flags, sizeof(flags));
+    appendBinaryStringInfo(key, (char *) &state->steps_len,
+                           sizeof(state->steps_len));
+
+#define KEY_APPEND(field) \
+    appendBinaryStringInfo(key, (char *) &(field), sizeof(field))
+
+    for (i = 0; i < state->steps_len; i++)
+    {
+        ExprEvalStep *op = &state->steps[i];
+        ExprEvalOp    opcode = llvm_expr_normalize_op(op->opcode);
+
+        KEY_APPEND(opcode);
+
+        switch (opcode)
+        {
+            case EEOP_INNER_FETCHSOME:
+            case EEOP_OUTER_FETCHSOME:
+            case EEOP_SCAN_FETCHSOME:
+                KEY_APPEND(op->d.fetch.last_var);
+                if (op->d.fetch.known_desc != NULL)
+                {
+                    appendStringInfoChar(key, 'd');
+                    llvm_deform_cache_key(key, op->d.fetch.known_desc,
+                                          op->d.fetch.last_var);
+                }
+                else
+                    appendStringInfoChar(key, 'n');
+                break;
+
+            case EEOP_INNER_VAR:
+            case EEOP_OUTER_VAR:
+            case EEOP_SCAN_VAR:
+            case EEOP_INNER_SYSVAR:
+            case EEOP_OUTER_SYSVAR:
+            case EEOP_SCAN_SYSVAR:
+                KEY_APPEND(op->d.var.attnum);
+                break;
+
+            case EEOP_ASSIGN_INNER_VAR:
+            case EEOP_ASSIGN_OUTER_VAR:
+            case EEOP_ASSIGN_SCAN_VAR:
+                KEY_APPEND(op->d.assign_var.resultnum);
+                KEY_APPEND(op->d.assign_var.attnum);
+                break;
+
+            case EEOP_ASSIGN_TMP:
+            case EEOP_ASSIGN_TMP_MAKE_RO:
+                KEY_APPEND(op->d.assign_tmp.resultnum);
+                break;
+
+            case EEOP_FUNCEXPR:
+            case EEOP_FUNCEXPR_STRICT:
+            case EEOP_DISTINCT:
+            case EEOP_NULLIF:
+                KEY_APPEND(op->d.func.fn_addr);
+                KEY_APPEND(op->d.func.nargs);
+                break;
+
+            case EEOP_BOOL_AND_STEP_FIRST:
+            case EEOP_BOOL_AND_STEP:
+            case EEOP_BOOL_OR_STEP_FIRST:
+            case EEOP_BOOL_OR_STEP:
+                KEY_APPEND(op->d.boolexpr.jumpdone);
+                break;
+
+            case EEOP_QUAL:
+                KEY_APPEND(op->d.qualexpr.jumpdone);
+                break;
+
+            case EEOP_JUMP:
+            case EEOP_JUMP_IF_NULL:
+            case EEOP_JUMP_IF_NOT_NULL:
+            case EEOP_JUMP_IF_NOT_TRUE:
+                KEY_APPEND(op->d.jump.jumpdone);
+                break;
+
+            case EEOP_ARRAYREF_SUBSCRIPT:
+                KEY_APPEND(op->d.arrayref_subscript.jumpdone);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+#undef KEY_APPEND
+}
+
+/*
+ * Generate, optimize and emit the code of an expression.
+ */
+static void *
+llvm_generate_expr(LLVMJitContext *context, ExprState *state, StringInfo key)
+{
+    LLVMContextRef lc = llvm_context();
+    LLVMTypeRef i32 = LLVMInt32TypeInContext(lc);
+    LLVMModuleRef mod;
+    LLVMBuilderRef b;
+    LLVMTypeRef eval_type;
+    LLVMTypeRef params[4];
+    LLVMTypeRef pgfunc_type;
+    LLVMTypeRef getsomeattrs_type;
+    LLVMTypeRef getsysattr_type;
+    LLVMTypeRef readonly_type;
+    LLVMTypeRef subscript_type;
+    LLVMValueRef eval_fn;
+    LLVMBasicBlockRef entry;
+    LLVMBasicBlockRef *opblocks;
+    LLVMValueRef v_state;
+    LLVMValueRef v_econtext;
+    LLVMValueRef v_isnullp;
+    LLVMValueRef v_steps;
+    LLVMValueRef v_innerslot;
+    LLVMValueRef v_outerslot;
+    LLVMValueRef v_scanslot;
+    LLVMValueRef v_resultslot;
+    LLVMValueRef v_stateresvaluep;
+    LLVMValueRef v_stateresnullp;
+    char       *funcname;
+    void       *func;
+    instr_time    starttime;
+    instr_time    endtime;
+    int            i;
+
+    INSTR_TIME_SET_CURRENT(starttime);
+
+    mod = llvm_create_module(context);
+    b = LLVMCreateBuilderInContext(lc);
+
+    funcname = llvm_expand_funcname(context, "evalexpr");
+
+    /* Datum evalexpr(ExprState *, ExprContext *, bool *) */
+    params[0] = TypeInt8Ptr;
+    params[1] = TypeInt8Ptr;
+    params[2] = TypeInt8Ptr;
+    eval_type = LLVMFunctionType(TypeDatum, params, 3, false);
+    eval_fn = LLVMAddFunction(mod, funcname, eval_type);
+    LLVMSetLinkage(eval_fn, LLVMExternalLinkage);
+    LLVMSetVisibility(eval_fn, LLVMDefaultVisibility);
+
+    /* Datum fn(FunctionCallInfo) */
+    pgfunc_type = LLVMFunctionType(TypeDatum, &TypeInt8Ptr, 1, false);
+    /* void slot_getsomeattrs(TupleTableSlot *, int) */
+    params[0] = TypeInt8Ptr;
+    params[1] = i32;
+    getsomeattrs_type = LLVMFunctionType(TypeVoid, params, 2, false);
+    /* Datum heap_getsysattr(HeapTuple, int, TupleDesc, bool *) */
+    params[0] = TypeInt8Ptr;
+    params[1] = i32;
+    params[2] = TypeInt8Ptr;
+    params[3] = TypeInt8Ptr;
+    getsysattr_type = LLVMFunctionType(TypeDatum, params, 4, false);
+    /* Datum MakeExpandedObjectReadOnlyInternal(Datum) */
+    readonly_type = LLVMFunctionType(TypeDatum, &TypeDatum, 1, false);
+    /* bool ExecEvalArrayRefSubscript(ExprState *, ExprEvalStep *) */
+    params[0] = TypeInt8Ptr;
+    params[1] = TypeInt8Ptr;
+    subscript_type = LLVMFunctionType(TypeStorageBool, params, 2, false);
+
+    entry = LLVMAppendBasicBlockInContext(lc, eval_fn, "entry");
+
+    /* build state */
+    v_state = LLVMGetParam(eval_fn, 0);
+    v_econtext = LLVMGetParam(eval_fn, 1);
+    v_isnullp = LLVMGetParam(eval_fn, 2);
+
+    LLVMPositionBuilderAtEnd(b, entry);
+
+    v_steps = l_load_field(b, v_state, offsetof(ExprState, steps),
+                           TypeInt8Ptr, "v_steps");
+    v_resultslot = l_load_field(b, v_state, offsetof(ExprState, resultslot),
+                                TypeInt8Ptr, "v_resultslot");
+    v_stateresvaluep = l_field_ptr(b, v_state, offsetof(ExprState, resvalue),
+                                   TypeDatum);
+    v_stateresnullp = l_field_ptr(b, v_state, offsetof(ExprState, resnull),
+                                  TypeStorageBool);
+    v_innerslot = l_load_field(b, v_econtext,
+                               offsetof(ExprContext, ecxt_innertuple),
+                               TypeInt8Ptr, "v_innerslot");
+    v_outerslot = l_load_field(b, v_econtext,
+                               offsetof(ExprContext, ecxt_outertuple),
+                               TypeInt8Ptr, "v_outerslot");
+    v_scanslot = l_load_field(b, v_econtext,
+                              offsetof(ExprContext, ecxt_scantuple),
+                              TypeInt8Ptr, "v_scanslot");
+
+    /* allocate blocks for each op upfront, so we can do jumps easily */
+    opblocks = palloc(sizeof(LLVMBasicBlockRef) * state->steps_len);
+    for (i = 0; i < state->steps_len; i++)
+        opblocks[i] = LLVMAppendBasicBlockInContext(lc, eval_fn, "b.op.start");
+
+    /* jump from entry to first block */
+    LLVMBuildBr(b, opblocks[0]);
+
+    for (i = 0; i < state->steps_len; i++)
+    {
+        ExprEvalStep *op = &state->steps[i];
+        ExprEvalOp    opcode = llvm_expr_normalize_op(op->opcode);
+        LLVMValueRef v_op;
+        LLVMValueRef v_resvaluep;
+        LLVMValueRef v_resnullp;
+        LLVMValueRef v_tmp;
+
+        LLVMPositionBuilderAtEnd(b, opblocks[i]);
+
+        /* the step's data, and where to store its result */
+        v_tmp = l_sizet_const(i * sizeof(ExprEvalStep));
+        v_op = LLVMBuildGEP2(b, LLVMInt8TypeInContext(lc), v_steps, &v_tmp, 1,
+                             "v_op");
+        v_resvaluep = l_load_field(b, v_op, offsetof(ExprEvalStep, resvalue),
+                                   TypeDatumPtr, "v_resvaluep");
+        v_resnullp = l_load_field(b, v_op, offsetof(ExprEvalStep, resnull),
+                                  TypeInt8Ptr, "v_resnullp");
+
+        switch (opcode)
+        {
+            case EEOP_DONE:
+                {
+                    LLVMValueRef v_tmpvalue;
+                    LLVMValueRef v_tmpisnull;
+
+                    v_tmpvalue = LLVMBuildLoad2(b, TypeDatum, v_stateresvaluep,
+                                                "");
+                    v_tmpisnull = LLVMBuildLoad2(b, TypeStorageBool,
+                                                 v_stateresnullp, "");
+                    LLVMBuildStore(b, v_tmpisnull, v_isnullp);
+                    LLVMBuildRet(b, v_tmpvalue);
+                    break;
+                }
+
+            case EEOP_INNER_FETCHSOME:
+            case EEOP_OUTER_FETCHSOME:
+            case EEOP_SCAN_FETCHSOME:
+                {
+                    LLVMValueRef v_slot;
+                    LLVMValueRef v_nvalid;
+                    LLVMValueRef v_params[2];
+                    LLVMBasicBlockRef b_fetch;
+                    LLVMBasicBlockRef b_generic;
+
+                    if (opcode == EEOP_INNER_FETCHSOME)
+                        v_slot = v_innerslot;
+                    else if (opcode == EEOP_OUTER_FETCHSOME)
+                        v_slot = v_outerslot;
+                    else
+                        v_slot = v_scanslot;
+
+                    b_fetch = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                            "op.fetch");
+                    b_generic = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                              "op.fetch.generic");
+
+                    /* nothing to do if the attributes have been fetched */
+                    v_nvalid = l_load_field(b, v_slot,
+                                            offsetof(TupleTableSlot, tts_nvalid),
+                                            i32, "");
+                    LLVMBuildCondBr(b,
+                                    LLVMBuildICmp(b, LLVMIntSGE, v_nvalid,
+                                                  l_int32_const(op->d.fetch.last_var),
+                                                  ""),
+                                    opblocks[i + 1], b_fetch);
+
+                    LLVMPositionBuilderAtEnd(b, b_fetch);
+                    if (op->d.fetch.known_desc != NULL)
+                    {
+                        LLVMValueRef v_deform;
+                        LLVMValueRef v_desc;
+                        LLVMValueRef v_known;
+                        LLVMBasicBlockRef b_deform;
+
+                        b_deform = LLVMInsertBasicBlockInContext(lc, b_generic,
+                                                                 "op.fetch.deform");
+
+                        v_deform = slot_compile_deform(context, mod,
+                                                       op->d.fetch.known_desc,
+                                                       op->d.fetch.last_var);
+
+                        /* only use the deforming for the descriptor it's for */
+                        v_desc = l_load_field(b, v_slot,
+                                              offsetof(TupleTableSlot, tts_tupleDescriptor),
+                                              TypeInt8Ptr, "");
+                        v_known = l_load_field(b, v_op,
+                                               offsetof(ExprEvalStep, d.fetch.known_desc),
+                                               TypeInt8Ptr, "");
+                        LLVMBuildCondBr(b,
+                                        LLVMBuildICmp(b, LLVMIntEQ, v_desc,
+                                                      v_known, ""),
+                                        b_deform, b_generic);
+
+                        LLVMPositionBuilderAtEnd(b, b_deform);
+                        LLVMBuildCall2(b, LLVMGlobalGetValueType(v_deform),
+                                       v_deform, &v_slot, 1, "");
+                        LLVMBuildBr(b, opblocks[i + 1]);
+                    }
+                    else
+                        LLVMBuildBr(b, b_generic);
+
+                    LLVMPositionBuilderAtEnd(b, b_generic);
+                    v_params[0] = v_slot;
+                    v_params[1] = l_int32_const(op->d.fetch.last_var);
+                    l_call(b, getsomeattrs_type, slot_getsomeattrs,
+                           v_params, 2, "");
+                    LLVMBuildBr(b, opblocks[i + 1]);
+                    break;
+                }
+
+            case EEOP_INNER_VAR:
+            case EEOP_OUTER_VAR:
+            case EEOP_SCAN_VAR:
+                {
+                    LLVMValueRef v_slot;
+                    LLVMValueRef v_values;
+                    LLVMValueRef v_nulls;
+                    LLVMValueRef v_attnum;
+                    LLVMValueRef v_value;
+                    LLVMValueRef v_isnull;
+
+                    if (opcode == EEOP_INNER_VAR)
+                        v_slot = v_innerslot;
+                    else if (opcode == EEOP_OUTER_VAR)
+                        v_slot = v_outerslot;
+                    else
+                        v_slot = v_scanslot;
+
+                    v_values = l_load_field(b, v_slot,
+                                            offsetof(TupleTableSlot, tts_values),
+                                            TypeDatumPtr, "");
+                    v_nulls = l_load_field(b, v_slot,
+                                           offsetof(TupleTableSlot, tts_isnull),
+                                           TypeInt8Ptr, "");
+
+                    v_attnum = l_int32_const(op->d.var.attnum);
+                    v_value = LLVMBuildLoad2(b, TypeDatum,
+                                             l_elem_ptr(b, TypeDatum, v_values,
+                                                        v_attnum), "");
+                    v_isnull = LLVMBuildLoad2(b, TypeStorageBool,
+                                              l_elem_ptr(b, TypeStorageBool,
+                                                         v_nulls, v_attnum), "");
+                    LLVMBuildStore(b, v_value, v_resvaluep);
+                    LLVMBuildStore(b, v_isnull, v_resnullp);
+
+                    LLVMBuildBr(b, opblocks[i + 1]);
+                    break;
+                }
+
+            case EEOP_INNER_SYSVAR:
+            case EEOP_OUTER_SYSVAR:
+            case EEOP_SCAN_SYSVAR:
+                {
+                    LLVMValueRef v_slot;
+                    LLVMValueRef v_params[4];
+
+                    if (opcode == EEOP_INNER_SYSVAR)
+                        v_slot = v_innerslot;
+                    else if (opcode == EEOP_OUTER_SYSVAR)
+                        v_slot = v_outerslot;
+                    else
+                        v_slot = v_scanslot;
+
+                    v_params[0] = l_load_field(b, v_slot,
+                                               offsetof(TupleTableSlot, tts_tuple),
+                                               TypeInt8Ptr, "");
+                    v_params[1] = l_int32_const(op->d.var.attnum);
+                    v_params[2] = l_load_field(b, v_slot,
+                                               offsetof(TupleTableSlot, tts_tupleDescriptor),
+                                               TypeInt8Ptr, "");
+                    v_params[3] = v_resnullp;
+                    LLVMBuildStore(b,
+                                   l_call(b, getsysattr_type, heap_getsysattr,
+                                          v_params, 4, "sysattr"),
+                                   v_resvaluep);
+
+                    LLVMBuildBr(b, opblocks[i + 1]);
+                    break;
+                }
+
+            case EEOP_WHOLEROW:
+                build_EvalHelper(b, ExecEvalWholeRowVar, EVAL_HELPER_OP_ECONTEXT,
+                                 v_state, v_op, v_econtext);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_ASSIGN_INNER_VAR:
+            case EEOP_ASSIGN_OUTER_VAR:
+            case EEOP_ASSIGN_SCAN_VAR:
+                {
+                    LLVMValueRef v_slot;
+                    LLVMValueRef v_attnum;
+                    LLVMValueRef v_resultnum;
+                    LLVMValueRef v_value;
+                    LLVMValueRef v_isnull;
+
+                    if (opcode == EEOP_ASSIGN_INNER_VAR)
+                        v_slot = v_innerslot;
+                    else if (opcode == EEOP_ASSIGN_OUTER_VAR)
+                        v_slot = v_outerslot;
+                    else
+                        v_slot = v_scanslot;
+
+                    v_attnum = l_int32_const(op->d.assign_var.attnum);
+                    v_value = l_load_field(b, v_slot,
+                                           offsetof(TupleTableSlot, tts_values),
+                                           TypeDatumPtr, "");
+                    v_value = LLVMBuildLoad2(b, TypeDatum,
+                                             l_elem_ptr(b, TypeDatum, v_value,
+                                                        v_attnum), "");
+                    v_isnull = l_load_field(b, v_slot,
+                                            offsetof(TupleTableSlot, tts_isnull),
+                                            TypeInt8Ptr, "");
+                    v_isnull = LLVMBuildLoad2(b, TypeStorageBool,
+                                              l_elem_ptr(b, TypeStorageBool,
+                                                         v_isnull, v_attnum), "");
+
+                    v_resultnum = l_int32_const(op->d.assign_var.resultnum);
+                    v_tmp = l_load_field(b, v_resultslot,
+                                         offsetof(TupleTableSlot, tts_values),
+                                         TypeDatumPtr, "");
+                    LLVMBuildStore(b, v_value,
+                                   l_elem_ptr(b, TypeDatum, v_tmp, v_resultnum));
+                    v_tmp = l_load_field(b, v_resultslot,
+                                         offsetof(TupleTableSlot, tts_isnull),
+                                         TypeInt8Ptr, "");
+                    LLVMBuildStore(b, v_isnull,
+                                   l_elem_ptr(b, TypeStorageBool, v_tmp,
+                                              v_resultnum));
+
+                    LLVMBuildBr(b, opblocks[i + 1]);
+                    break;
+                }
+
+            case EEOP_ASSIGN_TMP:
+            case EEOP_ASSIGN_TMP_MAKE_RO:
+                {
+                    LLVMValueRef v_resultnum;
+                    LLVMValueRef v_value;
+                    LLVMValueRef v_isnull;
+                    LLVMValueRef v_values;
+                    LLVMValueRef v_nulls;
+
+                    v_value = LLVMBuildLoad2(b, TypeDatum, v_stateresvaluep, "");
+                    v_isnull = LLVMBuildLoad2(b, TypeStorageBool,
+                                              v_stateresnullp, "");
+
+                    v_resultnum = l_int32_const(op->d.assign_tmp.resultnum);
+                    v_values = l_load_field(b, v_resultslot,
+                                            offsetof(TupleTableSlot, tts_values),
+                                            TypeDatumPtr, "");
+                    v_nulls = l_load_field(b, v_resultslot,
+                                           offsetof(TupleTableSlot, tts_isnull),
+                                           TypeInt8Ptr, "");
+                    LLVMBuildStore(b, v_isnull,
+                                   l_elem_ptr(b, TypeStorageBool, v_nulls,
+                                              v_resultnum));
+
+                    if (opcode == EEOP_ASSIGN_TMP_MAKE_RO)
+                    {
+                        LLVMBasicBlockRef b_notnull;
+                        LLVMBasicBlockRef b_store;
+                        LLVMBasicBlockRef b_cur;
+                        LLVMValueRef v_ro;
+                        LLVMValueRef v_phi;
+
+                        b_cur = LLVMGetInsertBlock(b);
+                        b_notnull = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                                  "op.makero");
+                        b_store = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                                "op.store");
+                        LLVMBuildCondBr(b, l_sbool_is_true(b, v_isnull),
+                                        b_store, b_notnull);
+
+                        LLVMPositionBuilderAtEnd(b, b_notnull);
+                        v_ro = l_call(b, readonly_type,
+                                      MakeExpandedObjectReadOnlyInternal,
+                                      &v_value, 1, "");
+                        LLVMBuildBr(b, b_store);
+
+                        LLVMPositionBuilderAtEnd(b, b_store);
+                        v_phi = LLVMBuildPhi(b, TypeDatum, "");
+                        LLVMAddIncoming(v_phi, &v_value, &b_cur, 1);
+                        LLVMAddIncoming(v_phi, &v_ro, &b_notnull, 1);
+                        v_value = v_phi;
+                    }
+
+                    LLVMBuildStore(b, v_value,
+                                   l_elem_ptr(b, TypeDatum, v_values,
+                                              v_resultnum));
+
+                    LLVMBuildBr(b, opblocks[i + 1]);
+                    break;
+                }
+
+            case EEOP_CONST:
+                {
+                    LLVMValueRef v_constvalue;
+                    LLVMValueRef v_constnull;
+
+                    v_constvalue = l_load_field(b, v_op,
+                                                offsetof(ExprEvalStep, d.constval.value),
+                                                TypeDatum, "");
+                    v_constnull = l_load_field(b, v_op,
+                                               offsetof(ExprEvalStep, d.constval.isnull),
+                                               TypeStorageBool, "");
+                    LLVMBuildStore(b, v_constvalue, v_resvaluep);
+                    LLVMBuildStore(b, v_constnull, v_resnullp);
+
+                    LLVMBuildBr(b, opblocks[i + 1]);
+                    break;
+                }
+
+            case EEOP_FUNCEXPR:
+            case EEOP_FUNCEXPR_STRICT:
+                {
+                    LLVMValueRef v_fcinfo;
+                    LLVMValueRef v_retval;
+                    LLVMBasicBlockRef b_call;
+                    LLVMBasicBlockRef b_nonull;
+
+                    v_fcinfo = l_load_field(b, v_op,
+                                            offsetof(ExprEvalStep, d.func.fcinfo_data),
+                                            TypeInt8Ptr, "v_fcinfo");
+
+                    b_call = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                           "op.call");
+
+                    if (opcode == EEOP_FUNCEXPR_STRICT && op->d.func.nargs > 0)
+                    {
+                        LLVMBasicBlockRef b_strictfail;
+                        int            argno;
+
+                        b_strictfail = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                                     "op.strictfail");
+
+                        /* strict function, so check for NULL args */
+                        for (argno = 0; argno < op->d.func.nargs; argno++)
+                        {
+                            LLVMValueRef v_argnull;
+
+                            if (argno + 1 == op->d.func.nargs)
+                                b_nonull = b_call;
+                            else
+                                b_nonull = LLVMInsertBasicBlockInContext(lc, b_call,
+                                                                         "op.argnotnull");
+
+                            v_argnull = l_load_field(b, v_fcinfo,
+                                                     offsetof(FunctionCallInfoData, argnull) + argno,
+                                                     TypeStorageBool, "");
+                            LLVMBuildCondBr(b, l_sbool_is_true(b, v_argnull),
+                                            b_strictfail, b_nonull);
+                            LLVMPositionBuilderAtEnd(b, b_nonull);
+                        }
+
+                        LLVMPositionBuilderAtEnd(b, b_strictfail);
+                        LLVMBuildStore(b, l_sbool_const(true), v_resnullp);
+                        LLVMBuildBr(b, opblocks[i + 1]);
+                    }
+                    else
+                        LLVMBuildBr(b, b_call);
+
+                    LLVMPositionBuilderAtEnd(b, b_call);
+                    l_store_field(b, l_sbool_const(false), v_fcinfo,
+                                  offsetof(FunctionCallInfoData, isnull));
+                    v_retval = l_call(b, pgfunc_type, op->d.func.fn_addr,
+                                      &v_fcinfo, 1, "funccall");
+                    LLVMBuildStore(b, v_retval, v_resvaluep);
+                    LLVMBuildStore(b,
+                                   l_load_field(b, v_fcinfo,
+                                                offsetof(FunctionCallInfoData, isnull),
+                                                TypeStorageBool, ""),
+                                   v_resnullp);
+
+                    LLVMBuildBr(b, opblocks[i + 1]);
+                    break;
+                }
+
+            case EEOP_FUNCEXPR_FUSAGE:
+                build_EvalHelper(b, ExecEvalFuncExprFusage,
+                                 EVAL_HELPER_OP_ECONTEXT,
+                                 v_state, v_op, v_econtext);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_FUNCEXPR_STRICT_FUSAGE:
+                build_EvalHelper(b, ExecEvalFuncExprStrictFusage,
+                                 EVAL_HELPER_OP_ECONTEXT,
+                                 v_state, v_op, v_econtext);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_BOOL_AND_STEP_FIRST:
+            case EEOP_BOOL_AND_STEP:
+            case EEOP_BOOL_AND_STEP_LAST:
+            case EEOP_BOOL_OR_STEP_FIRST:
+            case EEOP_BOOL_OR_STEP:
+            case EEOP_BOOL_OR_STEP_LAST:
+                {
+                    bool        is_and = (opcode == EEOP_BOOL_AND_STEP_FIRST ||
+                                          opcode == EEOP_BOOL_AND_STEP ||
+                                          opcode == EEOP_BOOL_AND_STEP_LAST);
+                    bool        is_last = (opcode == EEOP_BOOL_AND_STEP_LAST ||
+                                           opcode == EEOP_BOOL_OR_STEP_LAST);
+                    LLVMValueRef v_anynullp;
+                    LLVMValueRef v_boolnull;
+                    LLVMValueRef v_boolvalue;
+                    LLVMBasicBlockRef b_isnull;
+                    LLVMBasicBlockRef b_notnull;
+                    LLVMBasicBlockRef b_decided;
+
+                    v_anynullp = l_load_field(b, v_op,
+                                              offsetof(ExprEvalStep, d.boolexpr.anynull),
+                                              TypeInt8Ptr, "v_anynullp");
+
+                    /* the first step resets anynull */
+                    if (opcode == EEOP_BOOL_AND_STEP_FIRST ||
+                        opcode == EEOP_BOOL_OR_STEP_FIRST)
+                        LLVMBuildStore(b, l_sbool_const(false), v_anynullp);
+
+                    b_isnull = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                             "op.boolisnull");
+                    b_notnull = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                              "op.boolnotnull");
+
+                    v_boolnull = LLVMBuildLoad2(b, TypeStorageBool, v_resnullp, "");
+                    LLVMBuildCondBr(b, l_sbool_is_true(b, v_boolnull),
+                                    b_isnull, b_notnull);
+
+                    /* a NULL input is remembered, the result stays NULL */
+                    LLVMPositionBuilderAtEnd(b, b_isnull);
+                    if (!is_last)
+                        LLVMBuildStore(b, l_sbool_const(true), v_anynullp);
+                    LLVMBuildBr(b, opblocks[i + 1]);
+
+                    /*
+                     * A FALSE input to AND, or TRUE input to OR, decides the
+                     * result, which already is in place.
+                     */
+                    LLVMPositionBuilderAtEnd(b, b_notnull);
+                    v_boolvalue = LLVMBuildLoad2(b, TypeDatum, v_resvaluep, "");
+                    v_tmp = l_datum_is_true(b, v_boolvalue);
+                    if (is_and)
+                        v_tmp = LLVMBuildNot(b, v_tmp, "");
+
+                    if (!is_last)
+                    {
+                        LLVMBuildCondBr(b, v_tmp,
+                                        opblocks[op->d.boolexpr.jumpdone],
+                                        opblocks[i + 1]);
+                        break;
+                    }
+
+                    /* otherwise the last step returns NULL if any input was */
+                    b_decided = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                              "op.boolanynull");
+                    LLVMBuildCondBr(b, v_tmp, opblocks[i + 1], b_decided);
+
+                    LLVMPositionBuilderAtEnd(b, b_decided);
+                    {
+                        LLVMBasicBlockRef b_setnull;
+
+                        b_setnull = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                                  "op.boolsetnull");
+                        v_tmp = LLVMBuildLoad2(b, TypeStorageBool, v_anynullp, "");
+                        LLVMBuildCondBr(b, l_sbool_is_true(b, v_tmp),
+                                        b_setnull, opblocks[i + 1]);
+
+                        LLVMPositionBuilderAtEnd(b, b_setnull);
+                        LLVMBuildStore(b, LLVMConstInt(TypeDatum, 0, false),
+                                       v_resvaluep);
+                        LLVMBuildStore(b, l_sbool_const(true), v_resnullp);
+                        LLVMBuildBr(b, opblocks[i + 1]);
+                    }
+                    break;
+                }
+
+            case EEOP_BOOL_NOT_STEP:
+                {
+                    LLVMValueRef v_boolvalue;
+
+                    v_boolvalue = LLVMBuildLoad2(b, TypeDatum, v_resvaluep, "");
+                    v_tmp = LLVMBuildNot(b, l_datum_is_true(b, v_boolvalue), "");
+                    LLVMBuildStore(b, LLVMBuildZExt(b, v_tmp, TypeDatum, ""),
+                                   v_resvaluep);
+
+                    LLVMBuildBr(b, opblocks[i + 1]);
+                    break;
+                }
+
+            case EEOP_QUAL:
+                {
+                    LLVMValueRef v_resnull;
+                    LLVMValueRef v_resvalue;
+                    LLVMValueRef v_nullorfalse;
+                    LLVMBasicBlockRef b_qualfail;
+
+                    b_qualfail = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                               "op.qualfail");
+
+                    v_resnull = LLVMBuildLoad2(b, TypeStorageBool, v_resnullp, "");
+                    v_resvalue = LLVMBuildLoad2(b, TypeDatum, v_resvaluep, "");
+                    v_nullorfalse = LLVMBuildOr(b, l_sbool_is_true(b, v_resnull),
+                                                LLVMBuildNot(b,
+                                                             l_datum_is_true(b, v_resvalue),
+                                                             ""),
+                                                "");
+                    LLVMBuildCondBr(b, v_nullorfalse, b_qualfail, opblocks[i + 1]);
+
+                    /* bail out early, returning FALSE */
+                    LLVMPositionBuilderAtEnd(b, b_qualfail);
+                    LLVMBuildStore(b, l_sbool_const(false), v_resnullp);
+                    LLVMBuildStore(b, LLVMConstInt(TypeDatum, 0, false),
+                                   v_resvaluep);
+                    LLVMBuildBr(b, opblocks[op->d.qualexpr.jumpdone]);
+                    break;
+                }
+
+            case EEOP_JUMP:
+                LLVMBuildBr(b, opblocks[op->d.jump.jumpdone]);
+                break;
+
+            case EEOP_JUMP_IF_NULL:
+            case EEOP_JUMP_IF_NOT_NULL:
+            case EEOP_JUMP_IF_NOT_TRUE:
+                {
+                    LLVMValueRef v_cond;
+
+                    v_tmp = LLVMBuildLoad2(b, TypeStorageBool, v_resnullp, "");
+                    v_cond = l_sbool_is_true(b, v_tmp);
+                    if (opcode == EEOP_JUMP_IF_NOT_NULL)
+                        v_cond = LLVMBuildNot(b, v_cond, "");
+                    else if (opcode == EEOP_JUMP_IF_NOT_TRUE)
+                    {
+                        v_tmp = LLVMBuildLoad2(b, TypeDatum, v_resvaluep, "");
+                        v_cond = LLVMBuildOr(b, v_cond,
+                                             LLVMBuildNot(b,
+                                                          l_datum_is_true(b, v_tmp),
+                                                          ""),
+                                             "");
+                    }
+                    LLVMBuildCondBr(b, v_cond, opblocks[op->d.jump.jumpdone],
+                                    opblocks[i + 1]);
+                    break;
+                }
+
+            case EEOP_NULLTEST_ISNULL:
+            case EEOP_NULLTEST_ISNOTNULL:
+                {
+                    LLVMValueRef v_cond;
+
+                    v_tmp = LLVMBuildLoad2(b, TypeStorageBool, v_resnullp, "");
+                    v_cond = l_sbool_is_true(b, v_tmp);
+                    if (opcode == EEOP_NULLTEST_ISNOTNULL)
+                        v_cond = LLVMBuildNot(b, v_cond, "");
+                    LLVMBuildStore(b, LLVMBuildZExt(b, v_cond, TypeDatum, ""),
+                                   v_resvaluep);
+                    LLVMBuildStore(b, l_sbool_const(false), v_resnullp);
+
+                    LLVMBuildBr(b, opblocks[i + 1]);
+                    break;
+                }
+
+            case EEOP_NULLTEST_ROWISNULL:
+                build_EvalHelper(b, ExecEvalRowNull, EVAL_HELPER_OP_ECONTEXT,
+                                 v_state, v_op, v_econtext);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_NULLTEST_ROWISNOTNULL:
+                build_EvalHelper(b, ExecEvalRowNotNull, EVAL_HELPER_OP_ECONTEXT,
+                                 v_state, v_op, v_econtext);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_BOOLTEST_IS_TRUE:
+            case EEOP_BOOLTEST_IS_NOT_TRUE:
+            case EEOP_BOOLTEST_IS_FALSE:
+            case EEOP_BOOLTEST_IS_NOT_FALSE:
+                {
+                    LLVMBasicBlockRef b_isnull;
+                    LLVMBasicBlockRef b_notnull;
+                    bool        null_result;
+
+                    null_result = (opcode == EEOP_BOOLTEST_IS_NOT_TRUE ||
+                                   opcode == EEOP_BOOLTEST_IS_NOT_FALSE);
+
+                    b_isnull = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                             "op.booltestnull");
+                    b_notnull = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                              "op.booltestnotnull");
+
+                    v_tmp = LLVMBuildLoad2(b, TypeStorageBool, v_resnullp, "");
+                    LLVMBuildCondBr(b, l_sbool_is_true(b, v_tmp),
+                                    b_isnull, b_notnull);
+
+                    /* a NULL input yields a non-NULL result */
+                    LLVMPositionBuilderAtEnd(b, b_isnull);
+                    LLVMBuildStore(b, LLVMConstInt(TypeDatum, null_result, false),
+                                   v_resvaluep);
+                    LLVMBuildStore(b, l_sbool_const(false), v_resnullp);
+                    LLVMBuildBr(b, opblocks[i + 1]);
+
+                    /* otherwise IS [NOT] TRUE/FALSE pass on or invert the input */
+                    LLVMPositionBuilderAtEnd(b, b_notnull);
+                    if (opcode == EEOP_BOOLTEST_IS_NOT_TRUE ||
+                        opcode == EEOP_BOOLTEST_IS_FALSE)
+                    {
+                        v_tmp = LLVMBuildLoad2(b, TypeDatum, v_resvaluep, "");
+                        v_tmp = LLVMBuildNot(b, l_datum_is_true(b, v_tmp), "");
+                        LLVMBuildStore(b, LLVMBuildZExt(b, v_tmp, TypeDatum, ""),
+                                       v_resvaluep);
+                    }
+                    LLVMBuildBr(b, opblocks[i + 1]);
+                    break;
+                }
+
+            case EEOP_PARAM_EXEC:
+                build_EvalHelper(b, ExecEvalParamExec, EVAL_HELPER_OP_ECONTEXT,
+                                 v_state, v_op, v_econtext);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_PARAM_EXTERN:
+                build_EvalHelper(b, ExecEvalParamExtern, EVAL_HELPER_OP_ECONTEXT,
+                                 v_state, v_op, v_econtext);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_CASE_TESTVAL:
+            case EEOP_DOMAIN_TESTVAL:
+                {
+                    LLVMBasicBlockRef b_avail;
+                    LLVMBasicBlockRef b_notavail;
+                    LLVMValueRef v_casevaluep;
+                    LLVMValueRef v_casenullp;
+                    size_t        datum_off;
+                    size_t        null_off;
+
+                    if (opcode == EEOP_CASE_TESTVAL)
+                    {
+                        datum_off = offsetof(ExprContext, caseValue_datum);
+                        null_off = offsetof(ExprContext, caseValue_isNull);
+                    }
+                    else
+                    {
+                        datum_off = offsetof(ExprContext, domainValue_datum);
+                        null_off = offsetof(ExprContext, domainValue_isNull);
+                    }
+
+                    b_avail = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                            "op.testval.avail");
+                    b_notavail = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                               "op.testval.notavail");
+
+                    /* see EEOP_CASE_TESTVAL in ExecInterpExpr() */
+                    v_casevaluep = l_load_field(b, v_op,
+                                                offsetof(ExprEvalStep, d.casetest.value),
+                                                TypeDatumPtr, "");
+                    LLVMBuildCondBr(b, LLVMBuildIsNotNull(b, v_casevaluep, ""),
+                                    b_avail, b_notavail);
+
+                    LLVMPositionBuilderAtEnd(b, b_avail);
+                    v_casenullp = l_load_field(b, v_op,
+                                               offsetof(ExprEvalStep, d.casetest.isnull),
+                                               TypeInt8Ptr, "");
+                    LLVMBuildStore(b,
+                                   LLVMBuildLoad2(b, TypeDatum, v_casevaluep, ""),
+                                   v_resvaluep);
+                    LLVMBuildStore(b,
+                                   LLVMBuildLoad2(b, TypeStorageBool, v_casenullp, ""),
+                                   v_resnullp);
+                    LLVMBuildBr(b, opblocks[i + 1]);
+
+                    LLVMPositionBuilderAtEnd(b, b_notavail);
+                    LLVMBuildStore(b,
+                                   l_load_field(b, v_econtext, datum_off,
+                                                TypeDatum, ""),
+                                   v_resvaluep);
+                    LLVMBuildStore(b,
+                                   l_load_field(b, v_econtext, null_off,
+                                                TypeStorageBool, ""),
+                                   v_resnullp);
+                    LLVMBuildBr(b, opblocks[i + 1]);
+                    break;
+                }
+
+            case EEOP_MAKE_READONLY:
+                {
+                    LLVMBasicBlockRef b_notnull;
+                    LLVMValueRef v_valuep;
+                    LLVMValueRef v_nullp;
+                    LLVMValueRef v_null;
+
+                    b_notnull = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                              "op.readonly.notnull");
+
+                    v_nullp = l_load_field(b, v_op,
+                                           offsetof(ExprEvalStep, d.make_readonly.isnull),
+                                           TypeInt8Ptr, "");
+                    v_null = LLVMBuildLoad2(b, TypeStorageBool, v_nullp, "");
+                    LLVMBuildStore(b, v_null, v_resnullp);
+                    LLVMBuildCondBr(b, l_sbool_is_true(b, v_null),
+                                    opblocks[i + 1], b_notnull);
+
+                    LLVMPositionBuilderAtEnd(b, b_notnull);
+                    v_valuep = l_load_field(b, v_op,
+                                            offsetof(ExprEvalStep, d.make_readonly.value),
+                                            TypeDatumPtr, "");
+                    v_tmp = LLVMBuildLoad2(b, TypeDatum, v_valuep, "");
+                    LLVMBuildStore(b,
+                                   l_call(b, readonly_type,
+                                          MakeExpandedObjectReadOnlyInternal,
+                                          &v_tmp, 1, ""),
+                                   v_resvaluep);
+                    LLVMBuildBr(b, opblocks[i + 1]);
+                    break;
+                }
+
+            case EEOP_DISTINCT:
+            case EEOP_NULLIF:
+                {
+                    LLVMValueRef v_fcinfo;
+                    LLVMValueRef v_argnull0;
+                    LLVMValueRef v_argnull1;
+                    LLVMValueRef v_anyargnull;
+                    LLVMValueRef v_retval;
+                    LLVMValueRef v_fnnull;
+                    LLVMBasicBlockRef b_hasnull;
+                    LLVMBasicBlockRef b_nonull;
+
+                    b_hasnull = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                              "op.hasnull");
+                    b_nonull = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                             "op.nonull");
+
+                    v_fcinfo = l_load_field(b, v_op,
+                                            offsetof(ExprEvalStep, d.func.fcinfo_data),
+                                            TypeInt8Ptr, "v_fcinfo");
+                    v_argnull0 = l_sbool_is_true(b,
+                                                 l_load_field(b, v_fcinfo,
+                                                              offsetof(FunctionCallInfoData, argnull),
+                                                              TypeStorageBool, ""));
+                    v_argnull1 = l_sbool_is_true(b,
+                                                 l_load_field(b, v_fcinfo,
+                                                              offsetof(FunctionCallInfoData, argnull) + 1,
+                                                              TypeStorageBool, ""));
+                    v_anyargnull = LLVMBuildOr(b, v_argnull0, v_argnull1, "");
+                    LLVMBuildCondBr(b, v_anyargnull, b_hasnull, b_nonull);
+
+                    /* apply the equality function to non-NULL arguments */
+                    LLVMPositionBuilderAtEnd(b, b_nonull);
+                    l_store_field(b, l_sbool_const(false), v_fcinfo,
+                                  offsetof(FunctionCallInfoData, isnull));
+                    v_retval = l_call(b, pgfunc_type, op->d.func.fn_addr,
+                                      &v_fcinfo, 1, "funccall");
+                    v_fnnull = l_load_field(b, v_fcinfo,
+                                            offsetof(FunctionCallInfoData, isnull),
+                                            TypeStorageBool, "");
+
+                    if (opcode == EEOP_DISTINCT)
+                    {
+                        /* must invert result of "=", safe even if null */
+                        v_tmp = LLVMBuildNot(b, l_datum_is_true(b, v_retval), "");
+                        LLVMBuildStore(b, LLVMBuildZExt(b, v_tmp, TypeDatum, ""),
+                                       v_resvaluep);
+                        LLVMBuildStore(b, v_fnnull, v_resnullp);
+                        LLVMBuildBr(b, opblocks[i + 1]);
+
+                        /* both NULL is not distinct, one NULL is */
+                        LLVMPositionBuilderAtEnd(b, b_hasnull);
+                        v_tmp = LLVMBuildAnd(b, v_argnull0, v_argnull1, "");
+                        v_tmp = LLVMBuildNot(b, v_tmp, "");
+                        LLVMBuildStore(b, LLVMBuildZExt(b, v_tmp, TypeDatum, ""),
+                                       v_resvaluep);
+                        LLVMBuildStore(b, l_sbool_const(false), v_resnullp);
+                        LLVMBuildBr(b, opblocks[i + 1]);
+                    }
+                    else
+                    {
+                        LLVMBasicBlockRef b_equal;
+
+                        b_equal = LLVMInsertBasicBlockInContext(lc, opblocks[i + 1],
+                                                                "op.equal");
+
+                        /* if the arguments are equal return null */
+                        v_tmp = LLVMBuildAnd(b,
+                                             LLVMBuildNot(b,
+                                                          l_sbool_is_true(b, v_fnnull),
+                                                          ""),
+                                             l_datum_is_true(b, v_retval), "");
+                        LLVMBuildCondBr(b, v_tmp, b_equal, b_hasnull);
+
+                        LLVMPositionBuilderAtEnd(b, b_equal);
+                        LLVMBuildStore(b, LLVMConstInt(TypeDatum, 0, false),
+                                       v_resvaluep);
+                        LLVMBuildStore(b, l_sbool_const(true), v_resnullp);
+                        LLVMBuildBr(b, opblocks[i + 1]);
+
+                        /* arguments aren't equal, so return the first one */
+                        LLVMPositionBuilderAtEnd(b, b_hasnull);
+                        LLVMBuildStore(b,
+                                       l_load_field(b, v_fcinfo,
+                                                    offsetof(FunctionCallInfoData, arg),
+                                                    TypeDatum, ""),
+                                       v_resvaluep);
+                        LLVMBuildStore(b,
+                                       l_load_field(b, v_fcinfo,
+                                                    offsetof(FunctionCallInfoData, argnull),
+                                                    TypeStorageBool, ""),
+                                       v_resnullp);
+                        LLVMBuildBr(b, opblocks[i + 1]);
+                    }
+                    break;
+                }
+
+            case EEOP_SQLVALUEFUNCTION:
+                build_EvalHelper(b, ExecEvalSQLValueFunction, EVAL_HELPER_OP,
+                                 v_state, v_op, NULL);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_CURRENTOFEXPR:
+                build_EvalHelper(b, ExecEvalCurrentOfExpr, EVAL_HELPER_OP,
+                                 v_state, v_op, NULL);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_NEXTVALUEEXPR:
+                build_EvalHelper(b, ExecEvalNextValueExpr, EVAL_HELPER_OP,
+                                 v_state, v_op, NULL);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_ARRAYEXPR:
+                build_EvalHelper(b, ExecEvalArrayExpr, EVAL_HELPER_OP,
+                                 v_state, v_op, NULL);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_ARRAYCOERCE:
+                build_EvalHelper(b, ExecEvalArrayCoerce, EVAL_HELPER_OP,
+                                 v_state, v_op, NULL);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_ROW:
+                build_EvalHelper(b, ExecEvalRow, EVAL_HELPER_OP,
+                                 v_state, v_op, NULL);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_MINMAX:
+                build_EvalHelper(b, ExecEvalMinMax, EVAL_HELPER_OP,
+                                 v_state, v_op, NULL);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_FIELDSELECT:
+                build_EvalHelper(b, ExecEvalFieldSelect, EVAL_HELPER_OP_ECONTEXT,
+                                 v_state, v_op, v_econtext);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_FIELDSTORE_DEFORM:
+                build_EvalHelper(b, ExecEvalFieldStoreDeForm,
+                                 EVAL_HELPER_OP_ECONTEXT,
+                                 v_state, v_op, v_econtext);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_FIELDSTORE_FORM:
+                build_EvalHelper(b, ExecEvalFieldStoreForm,
+                                 EVAL_HELPER_OP_ECONTEXT,
+                                 v_state, v_op, v_econtext);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_ARRAYREF_SUBSCRIPT:
+                {
+                    LLVMValueRef v_params[2];
+
+                    /* a NULL subscript short-circuits the ArrayRef to NULL */
+                    v_params[0] = v_state;
+                    v_params[1] = v_op;
+                    v_tmp = l_call(b, subscript_type, ExecEvalArrayRefSubscript,
+                                   v_params, 2, "");
+                    LLVMBuildCondBr(b, l_sbool_is_true(b, v_tmp),
+                                    opblocks[i + 1],
+                                    opblocks[op->d.arrayref_subscript.jumpdone]);
+                    break;
+                }
+
+            case EEOP_ARRAYREF_OLD:
+                build_EvalHelper(b, ExecEvalArrayRefOld, EVAL_HELPER_OP,
+                                 v_state, v_op, NULL);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_ARRAYREF_ASSIGN:
+                build_EvalHelper(b, ExecEvalArrayRefAssign, EVAL_HELPER_OP,
+                                 v_state, v_op, NULL);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_ARRAYREF_FETCH:
+                build_EvalHelper(b, ExecEvalArrayRefFetch, EVAL_HELPER_OP,
+                                 v_state, v_op, NULL);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_DOMAIN_NOTNULL:
+                build_EvalHelper(b, ExecEvalConstraintNotNull, EVAL_HELPER_OP,
+                                 v_state, v_op, NULL);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_DOMAIN_CHECK:
+                build_EvalHelper(b, ExecEvalConstraintCheck, EVAL_HELPER_OP,
+                                 v_state, v_op, NULL);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_CONVERT_ROWTYPE:
+                build_EvalHelper(b, ExecEvalConvertRowtype,
+                                 EVAL_HELPER_OP_ECONTEXT,
+                                 v_state, v_op, v_econtext);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_SCALARARRAYOP:
+                build_EvalHelper(b, ExecEvalScalarArrayOp, EVAL_HELPER_OP,
+                                 v_state, v_op, NULL);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_XMLEXPR:
+                build_EvalHelper(b, ExecEvalXmlExpr, EVAL_HELPER_OP,
+                                 v_state, v_op, NULL);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_AGGREF:
+            case EEOP_WINDOW_FUNC:
+                {
+                    LLVMValueRef v_aggstate;
+                    LLVMValueRef v_aggno;
+                    LLVMValueRef v_aggvalues;
+                    LLVMValueRef v_aggnulls;
+
+                    /* return the precomputed value found in the econtext */
+                    if (opcode == EEOP_AGGREF)
+                    {
+                        v_aggstate = l_load_field(b, v_op,
+                                                  offsetof(ExprEvalStep, d.aggref.astate),
+                                                  TypeInt8Ptr, "");
+                        v_aggno = l_load_field(b, v_aggstate,
+                                               offsetof(AggrefExprState, aggno),
+                                               i32, "v_aggno");
+                    }
+                    else
+                    {
+                        v_aggstate = l_load_field(b, v_op,
+                                                  offsetof(ExprEvalStep, d.window_func.wfstate),
+                                                  TypeInt8Ptr, "");
+                        v_aggno = l_load_field(b, v_aggstate,
+                                               offsetof(WindowFuncExprState, wfuncno),
+                                               i32, "v_wfuncno");
+                    }
+
+                    v_aggvalues = l_load_field(b, v_econtext,
+                                               offsetof(ExprContext, ecxt_aggvalues),
+                                               TypeDatumPtr, "");
+                    v_aggnulls = l_load_field(b, v_econtext,
+                                              offsetof(ExprContext, ecxt_aggnulls),
+                                              TypeInt8Ptr, "");
+                    LLVMBuildStore(b,
+                                   LLVMBuildLoad2(b, TypeDatum,
+                                                  l_elem_ptr(b, TypeDatum,
+                                                             v_aggvalues, v_aggno),
+                                                  ""),
+                                   v_resvaluep);
+                    LLVMBuildStore(b,
+                                   LLVMBuildLoad2(b, TypeStorageBool,
+                                                  l_elem_ptr(b, TypeStorageBool,
+                                                             v_aggnulls, v_aggno),
+                                                  ""),
+                                   v_resnullp);
+
+                    LLVMBuildBr(b, opblocks[i + 1]);
+                    break;
+                }
+
+            case EEOP_GROUPING_FUNC:
+                build_EvalHelper(b, ExecEvalGroupingFunc, EVAL_HELPER_OP,
+                                 v_state, v_op, NULL);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_SUBPLAN:
+                build_EvalHelper(b, ExecEvalSubPlan, EVAL_HELPER_OP_ECONTEXT,
+                                 v_state, v_op, v_econtext);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            case EEOP_ALTERNATIVE_SUBPLAN:
+                build_EvalHelper(b, ExecEvalAlternativeSubPlan,
+                                 EVAL_HELPER_OP_ECONTEXT,
+                                 v_state, v_op, v_econtext);
+                LLVMBuildBr(b, opblocks[i + 1]);
+                break;
+
+            default:
+                /* llvm_compile_expr() rejected everything else */
+                elog(ERROR, "unexpected expression step %d", (int) opcode);
+                break;
+        }
+    }
+
+    LLVMDisposeBuilder(b);
+    pfree(opblocks);
+
+    INSTR_TIME_SET_CURRENT(endtime);
+    INSTR_TIME_ACCUM_DIFF(context->base.instr.generation_counter,
+                          endtime, starttime);
+
+    func = llvm_emit_function(context, mod, funcname, key);
+    pfree(funcname);
+
+    return func;
+}
+
+/*
+ * Emit a call to one of the out-of-line ExecEval* step implementations.
+ */
+static void
+build_EvalHelper(LLVMBuilderRef b, void *fnaddr, LLVMEvalHelperKind kind,
+                 LLVMValueRef v_state, LLVMValueRef v_op,
+                 LLVMValueRef v_econtext)
+{
+    LLVMTypeRef params[3] = {TypeInt8Ptr, TypeInt8Ptr, TypeInt8Ptr};
+    LLVMValueRef v_params[3];
+    int            nargs;
+
+    v_params[0] = v_state;
+    v_params[1] = v_op;
+    v_params[2] = v_econtext;
+    nargs = (kind == EVAL_HELPER_OP_ECONTEXT) ? 3 : 2;
+
+    l_call(b, LLVMFunctionType(TypeVoid, params, nargs, false), fnaddr,
+           v_params, nargs, "");
+}
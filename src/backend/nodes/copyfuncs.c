@@ -298,6 +298,7 @@ _copyAppend(const Append *from)
     COPY_NODE_FIELD(appendplans);
 #ifdef __OPENTENBASE__
     COPY_SCALAR_FIELD(interval);
+    COPY_NODE_FIELD(part_prune_info);
 #endif
 
     return newnode;
@@ -328,6 +329,7 @@ _copyMergeAppend(const MergeAppend *from)
     COPY_POINTER_FIELD(nullsFirst, from->numCols * sizeof(bool));
 #ifdef __OPENTENBASE__
     COPY_SCALAR_FIELD(interval);
+    COPY_NODE_FIELD(part_prune_info);
 #endif
 
     return newnode;
@@ -473,6 +475,10 @@ CopyScanFields(const Scan *from, Scan *newnode)
     COPY_SCALAR_FIELD(ispartchild);
     COPY_SCALAR_FIELD(childidx);
 #endif
+#ifdef _MLS_
+    COPY_SCALAR_FIELD(crypt_attrs_pruned);
+    COPY_BITMAPSET_FIELD(crypt_attrs);
+#endif
 }
 
 /*
@@ -1008,6 +1014,30 @@ _copySort(const Sort *from)
 }
 
 
+/*
+ * _copyIncrementalSort
+ */
+static IncrementalSort *
+_copyIncrementalSort(const IncrementalSort *from)
+{
+    IncrementalSort *newnode = makeNode(IncrementalSort);
+
+    /*
+     * copy node superclass fields
+     */
+    CopyPlanFields((const Plan *) from, (Plan *) newnode);
+
+    COPY_SCALAR_FIELD(sort.numCols);
+    COPY_POINTER_FIELD(sort.sortColIdx, from->sort.numCols * sizeof(AttrNumber));
+    COPY_POINTER_FIELD(sort.sortOperators, from->sort.numCols * sizeof(Oid));
+    COPY_POINTER_FIELD(sort.collations, from->sort.numCols * sizeof(Oid));
+    COPY_POINTER_FIELD(sort.nullsFirst, from->sort.numCols * sizeof(bool));
+    COPY_SCALAR_FIELD(nPresortedCols);
+
+    return newnode;
+}
+
+
 /*
  * _copyGroup
  */
@@ -1254,6 +1284,26 @@ _copyPlanInvalItem(const PlanInvalItem *from)
     return newnode;
 }
 
+#ifdef __OPENTENBASE__
+/*
+ * _copyPartitionPruneInfo
+ */
+static PartitionPruneInfo *
+_copyPartitionPruneInfo(const PartitionPruneInfo *from)
+{
+    PartitionPruneInfo *newnode = makeNode(PartitionPruneInfo);
+
+    COPY_SCALAR_FIELD(rtindex);
+    COPY_SCALAR_FIELD(interval);
+    COPY_NODE_FIELD(prune_quals);
+    COPY_NODE_FIELD(pruning_steps);
+    COPY_NODE_FIELD(subplan_parts);
+    COPY_BITMAPSET_FIELD(execparamids);
+
+    return newnode;
+}
+#endif
+
 #ifdef PGXC
 /*
  * _copyExecDirect
@@ -5496,6 +5546,9 @@ copyObjectImpl(const void *from)
         case T_Sort:
             retval = _copySort(from);
             break;
+        case T_IncrementalSort:
+            retval = _copyIncrementalSort(from);
+            break;
         case T_Group:
             retval = _copyGroup(from);
             break;
@@ -5529,6 +5582,11 @@ copyObjectImpl(const void *from)
         case T_PlanInvalItem:
             retval = _copyPlanInvalItem(from);
             break;
+#ifdef __OPENTENBASE__
+        case T_PartitionPruneInfo:
+            retval = _copyPartitionPruneInfo(from);
+            break;
+#endif
 #ifdef PGXC
             /*
              * PGXC SPECIFIC NODES
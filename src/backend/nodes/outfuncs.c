@@ -611,6 +611,10 @@ _outScanInfo(StringInfo str, const Scan *node)
     WRITE_BOOL_FIELD(ispartchild);
     WRITE_INT_FIELD(childidx);
 #endif
+#ifdef _MLS_
+    WRITE_BOOL_FIELD(crypt_attrs_pruned);
+    WRITE_BITMAPSET_FIELD(crypt_attrs);
+#endif
 }
 
 /*
@@ -713,6 +717,7 @@ _outAppend(StringInfo str, const Append *node)
     WRITE_NODE_FIELD(appendplans);
 #ifdef __OPENTENBASE__
     WRITE_BOOL_FIELD(interval);
+    WRITE_NODE_FIELD(part_prune_info);
 #endif
 }
 
@@ -789,6 +794,7 @@ _outMergeAppend(StringInfo str, const MergeAppend *node)
         appendStringInfo(str, " %s", booltostr(node->nullsFirst[i]));
 #ifdef __OPENTENBASE__
     WRITE_BOOL_FIELD(interval);
+    WRITE_NODE_FIELD(part_prune_info);
 #endif
 }
 
@@ -1482,12 +1488,10 @@ _outMaterial(StringInfo str, const Material *node)
 }
 
 static void
-_outSort(StringInfo str, const Sort *node)
+_outSortInfo(StringInfo str, const Sort *node)
 {// #lizard forgives
     int            i;
 
-    WRITE_NODE_TYPE("SORT");
-
     _outPlanInfo(str, (const Plan *) node);
 
     WRITE_INT_FIELD(numCols);
@@ -1551,6 +1555,24 @@ _outSort(StringInfo str, const Sort *node)
         appendStringInfo(str, " %s", booltostr(node->nullsFirst[i]));
 }
 
+static void
+_outSort(StringInfo str, const Sort *node)
+{
+    WRITE_NODE_TYPE("SORT");
+
+    _outSortInfo(str, node);
+}
+
+static void
+_outIncrementalSort(StringInfo str, const IncrementalSort *node)
+{
+    WRITE_NODE_TYPE("INCREMENTALSORT");
+
+    _outSortInfo(str, (const Sort *) node);
+
+    WRITE_INT_FIELD(nPresortedCols);
+}
+
 static void
 _outUnique(StringInfo str, const Unique *node)
 {// #lizard forgives
@@ -1896,6 +1918,21 @@ _outPlanInvalItem(StringInfo str, const PlanInvalItem *node)
     WRITE_UINT_FIELD(hashValue);
 }
 
+#ifdef __OPENTENBASE__
+static void
+_outPartitionPruneInfo(StringInfo str, const PartitionPruneInfo *node)
+{
+    WRITE_NODE_TYPE("PARTITIONPRUNEINFO");
+
+    WRITE_UINT_FIELD(rtindex);
+    WRITE_BOOL_FIELD(interval);
+    WRITE_NODE_FIELD(prune_quals);
+    WRITE_NODE_FIELD(pruning_steps);
+    WRITE_NODE_FIELD(subplan_parts);
+    WRITE_BITMAPSET_FIELD(execparamids);
+}
+#endif
+
 /*****************************************************************************
  *
  *    Stuff from primnodes.h.
@@ -3299,6 +3336,17 @@ _outSortPath(StringInfo str, const SortPath *node)
     WRITE_NODE_FIELD(subpath);
 }
 
+static void
+_outIncrementalSortPath(StringInfo str, const IncrementalSortPath *node)
+{
+    WRITE_NODE_TYPE("INCREMENTALSORTPATH");
+
+    _outPathInfo(str, (const Path *) node);
+
+    WRITE_NODE_FIELD(spath.subpath);
+    WRITE_INT_FIELD(nPresortedCols);
+}
+
 static void
 _outGroupPath(StringInfo str, const GroupPath *node)
 {
@@ -5286,6 +5334,9 @@ outNode(StringInfo str, const void *obj)
             case T_Sort:
                 _outSort(str, obj);
                 break;
+            case T_IncrementalSort:
+                _outIncrementalSort(str, obj);
+                break;
             case T_Unique:
                 _outUnique(str, obj);
                 break;
@@ -5321,6 +5372,11 @@ outNode(StringInfo str, const void *obj)
             case T_PlanInvalItem:
                 _outPlanInvalItem(str, obj);
                 break;
+#ifdef __OPENTENBASE__
+            case T_PartitionPruneInfo:
+                _outPartitionPruneInfo(str, obj);
+                break;
+#endif
             case T_Alias:
                 _outAlias(str, obj);
                 break;
@@ -5537,6 +5593,9 @@ outNode(StringInfo str, const void *obj)
             case T_SortPath:
                 _outSortPath(str, obj);
                 break;
+            case T_IncrementalSortPath:
+                _outIncrementalSortPath(str, obj);
+                break;
             case T_GroupPath:
                 _outGroupPath(str, obj);
                 break;
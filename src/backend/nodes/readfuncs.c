@@ -2479,6 +2479,7 @@ _readAppend(void)
     READ_NODE_FIELD(appendplans);
 #ifdef __OPENTENBASE__
     READ_BOOL_FIELD(interval);
+    READ_NODE_FIELD(part_prune_info);
 #endif
 
     READ_DONE();
@@ -2576,6 +2577,7 @@ _readMergeAppend(void)
     READ_BOOL_ARRAY(nullsFirst, local_node->numCols);
 #ifdef __OPENTENBASE__
     READ_BOOL_FIELD(interval);
+    READ_NODE_FIELD(part_prune_info);
 #endif
 
     READ_DONE();
@@ -2647,6 +2649,10 @@ ReadCommonScan(Scan *local_node)
     READ_BOOL_FIELD(ispartchild);
     READ_INT_FIELD(childidx);
 #endif
+#ifdef _MLS_
+    READ_BOOL_FIELD(crypt_attrs_pruned);
+    READ_BITMAPSET_FIELD(crypt_attrs);
+#endif
 }
 
 /*
@@ -3059,13 +3065,14 @@ _readMaterial(void)
 }
 
 /*
- * _readSort
+ * ReadCommonSort
+ *    Assign the basic stuff of all nodes that inherit from Sort
  */
-static Sort *
-_readSort(void)
+static void
+ReadCommonSort(Sort *local_node)
 {// #lizard forgives
     int i;
-    READ_LOCALS(Sort);
+    READ_TEMP_LOCALS();
 
     ReadCommonPlan(&local_node->plan);
 
@@ -3159,6 +3166,32 @@ _readSort(void)
         token = pg_strtok(&length);
         local_node->nullsFirst[i] = strtobool(token);
     }
+}
+
+/*
+ * _readSort
+ */
+static Sort *
+_readSort(void)
+{
+    READ_LOCALS_NO_FIELDS(Sort);
+
+    ReadCommonSort(local_node);
+
+    READ_DONE();
+}
+
+/*
+ * _readIncrementalSort
+ */
+static IncrementalSort *
+_readIncrementalSort(void)
+{
+    READ_LOCALS(IncrementalSort);
+
+    ReadCommonSort(&local_node->sort);
+
+    READ_INT_FIELD(nPresortedCols);
 
     READ_DONE();
 }
@@ -3737,6 +3770,26 @@ _readPlanInvalItem(void)
     READ_DONE();
 }
 
+#ifdef __OPENTENBASE__
+/*
+ * _readPartitionPruneInfo
+ */
+static PartitionPruneInfo *
+_readPartitionPruneInfo(void)
+{
+    READ_LOCALS(PartitionPruneInfo);
+
+    READ_UINT_FIELD(rtindex);
+    READ_BOOL_FIELD(interval);
+    READ_NODE_FIELD(prune_quals);
+    READ_NODE_FIELD(pruning_steps);
+    READ_NODE_FIELD(subplan_parts);
+    READ_BITMAPSET_FIELD(execparamids);
+
+    READ_DONE();
+}
+#endif
+
 /*
  * _readSubPlan
  */
@@ -4486,6 +4539,8 @@ parseNodeString(void)
         return_value = _readMaterial();
     else if (MATCH("SORT", 4))
         return_value = _readSort();
+    else if (MATCH("INCREMENTALSORT", 15))
+        return_value = _readIncrementalSort();
     else if (MATCH("GROUP", 5))
         return_value = _readGroup();
     else if (MATCH("AGG", 3))
@@ -4512,6 +4567,10 @@ parseNodeString(void)
         return_value = _readPlanRowMark();
     else if (MATCH("PLANINVALITEM", 13))
         return_value = _readPlanInvalItem();
+#ifdef __OPENTENBASE__
+    else if (MATCH("PARTITIONPRUNEINFO", 18))
+        return_value = _readPartitionPruneInfo();
+#endif
     else if (MATCH("SUBPLAN", 7))
         return_value = _readSubPlan();
     else if (MATCH("ALTERNATIVESUBPLAN", 18))
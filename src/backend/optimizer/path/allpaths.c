@@ -149,6 +149,11 @@ static void remove_unused_subquery_outputs(Query *subquery, RelOptInfo *rel);
 static void add_paths_to_append_rel(PlannerInfo *root, RelOptInfo *rel,
                         List *live_childrels);
 static bool check_list_contain_all_const(List *list);
+static void prune_interval_join_rels(PlannerInfo *root);
+static bool interval_rel_is_nullable(PlannerInfo *root, Index relid);
+static bool interval_keys_are_equal(PlannerInfo *root,
+						Index relid1, AttrNumber key1,
+						Index relid2, AttrNumber key2);
 
 
 /*
@@ -3711,6 +3716,10 @@ print_path(PlannerInfo *root, Path *path, int indent)
             ptype = "Sort";
             subpath = ((SortPath *) path)->subpath;
             break;
+        case T_IncrementalSortPath:
+            ptype = "IncrementalSort";
+            subpath = ((SortPath *) path)->subpath;
+            break;
         case T_GroupPath:
             ptype = "Group";
             subpath = ((GroupPath *) path)->subpath;
@@ -3900,8 +3909,6 @@ prune_interval_base_rel(PlannerInfo *root)
 		{
 			RangeTblEntry *rte;
 			Relation    relation;
-			Oid         partoid = InvalidOid;
-			Bitmapset   *tmpset;
 			
 			rte = rt_fetch(rel->relid, root->parse->rtable);
 			relation = heap_open(rte->relid, AccessShareLock);
@@ -3918,6 +3925,33 @@ prune_interval_base_rel(PlannerInfo *root)
 			}
 #endif
 			
+			heap_close(relation, AccessShareLock);
+		}
+	}
+
+	/* pruning by the partitions of the tables joined on their keys */
+	prune_interval_join_rels(root);
+
+	for (rti = 1; rti < root->simple_rel_array_size; rti++)
+	{
+		RelOptInfo *rel = root->simple_rel_array[rti];
+		
+		if (rel == NULL)
+			continue;
+		
+		if (IS_DUMMY_REL(rel))
+			continue;
+		
+		if (IS_SIMPLE_REL(rel) && rel->intervalparent && !rel->isdefault)
+		{
+			RangeTblEntry *rte;
+			Relation    relation;
+			Oid         partoid = InvalidOid;
+			Bitmapset   *tmpset;
+			
+			rte = rt_fetch(rel->relid, root->parse->rtable);
+			relation = heap_open(rte->relid, AccessShareLock);
+			
 			tmpset = bms_copy(rel->childs);
 			
 			if (bms_num_members(tmpset) == 1)
@@ -3966,3 +4000,170 @@ prune_interval_base_rel(PlannerInfo *root)
 		}
 	}
 }
+
+/*
+ * Rows of two interval partitioned tables with the same partition bounds
+ * that are joined on their partition keys can only match within partitions
+ * of the same index: partition i of one table holds the same range of keys
+ * as partition i of the other.  So only the partitions left on both sides
+ * after pruning by qual need to be scanned, e.g. the days of a range that a
+ * query restricts on one fact table only.  That keeps the join, and a hash
+ * table built over one of its sides, down to the partitions that can match.
+ *
+ * A table on the nullable side of an outer join keeps its rows, so is left
+ * alone, as is the target of an UPDATE or DELETE.
+ */
+static void
+prune_interval_join_rels(PlannerInfo *root)
+{
+	Index		rti1;
+	Index		rti2;
+	bool		changed;
+
+	if (root->eq_classes == NIL)
+		return;
+
+	/* until no more partitions are pruned, as more than two can be joined */
+	do
+	{
+		changed = false;
+
+		for (rti1 = 1; rti1 < root->simple_rel_array_size; rti1++)
+		{
+			RelOptInfo *rel1 = root->simple_rel_array[rti1];
+			RangeTblEntry *rte1;
+			Relation	relation1;
+			Form_pg_partition_interval part1;
+
+			if (rel1 == NULL || IS_DUMMY_REL(rel1) || !IS_SIMPLE_REL(rel1) ||
+				!rel1->intervalparent || rel1->isdefault ||
+				rti1 == root->parse->resultRelation ||
+				interval_rel_is_nullable(root, rti1))
+				continue;
+
+			rte1 = rt_fetch(rti1, root->parse->rtable);
+			relation1 = heap_open(rte1->relid, AccessShareLock);
+			part1 = relation1->rd_partitions_info;
+
+			for (rti2 = rti1 + 1; part1 && rti2 < root->simple_rel_array_size; rti2++)
+			{
+				RelOptInfo *rel2 = root->simple_rel_array[rti2];
+				RangeTblEntry *rte2;
+				Relation	relation2;
+				Form_pg_partition_interval part2;
+				Bitmapset  *childs;
+
+				if (rel2 == NULL || IS_DUMMY_REL(rel2) || !IS_SIMPLE_REL(rel2) ||
+					!rel2->intervalparent || rel2->isdefault ||
+					rti2 == root->parse->resultRelation ||
+					interval_rel_is_nullable(root, rti2))
+					continue;
+
+				rte2 = rt_fetch(rti2, root->parse->rtable);
+				relation2 = heap_open(rte2->relid, AccessShareLock);
+				part2 = relation2->rd_partitions_info;
+
+				if (part2 &&
+					part1->partinterval_type == part2->partinterval_type &&
+					part1->partdatatype == part2->partdatatype &&
+					part1->partstartvalue_int == part2->partstartvalue_int &&
+					part1->partstartvalue_ts == part2->partstartvalue_ts &&
+					part1->partinterval_int == part2->partinterval_int &&
+					interval_keys_are_equal(root, rti1, part1->partpartkey,
+											rti2, part2->partpartkey))
+				{
+					childs = bms_intersect(rel1->childs, rel2->childs);
+
+					if (!bms_equal(childs, rel1->childs) ||
+						!bms_equal(childs, rel2->childs))
+					{
+						elog(DEBUG1, "interval partitions of \"%s\" and \"%s\" pruned by join from %d and %d to %d",
+							 RelationGetRelationName(relation1),
+							 RelationGetRelationName(relation2),
+							 bms_num_members(rel1->childs),
+							 bms_num_members(rel2->childs),
+							 bms_num_members(childs));
+
+						bms_free(rel1->childs);
+						bms_free(rel2->childs);
+						rel1->childs = childs;
+						rel2->childs = bms_copy(childs);
+						changed = true;
+					}
+					else
+						bms_free(childs);
+				}
+
+				heap_close(relation2, AccessShareLock);
+			}
+
+			heap_close(relation1, AccessShareLock);
+		}
+	} while (changed);
+}
+
+/*
+ * Can the rows of the relation be null-extended by an outer join?
+ */
+static bool
+interval_rel_is_nullable(PlannerInfo *root, Index relid)
+{
+	ListCell   *lc;
+
+	foreach(lc, root->join_info_list)
+	{
+		SpecialJoinInfo *sjinfo = (SpecialJoinInfo *) lfirst(lc);
+
+		if (sjinfo->jointype == JOIN_INNER || sjinfo->jointype == JOIN_SEMI)
+			continue;
+
+		if (bms_is_member(relid, sjinfo->syn_righthand) ||
+			(sjinfo->jointype == JOIN_FULL &&
+			 bms_is_member(relid, sjinfo->syn_lefthand)))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Are the given columns of two relations known to be equal, that is, in the
+ * same equivalence class?
+ */
+static bool
+interval_keys_are_equal(PlannerInfo *root,
+						Index relid1, AttrNumber key1,
+						Index relid2, AttrNumber key2)
+{
+	ListCell   *lc;
+
+	foreach(lc, root->eq_classes)
+	{
+		EquivalenceClass *ec = (EquivalenceClass *) lfirst(lc);
+		bool		found1 = false;
+		bool		found2 = false;
+		ListCell   *lc2;
+
+		if (ec->ec_has_volatile || list_length(ec->ec_members) < 2)
+			continue;
+
+		foreach(lc2, ec->ec_members)
+		{
+			EquivalenceMember *em = (EquivalenceMember *) lfirst(lc2);
+			Var		   *var = (Var *) em->em_expr;
+
+			if (em->em_is_child || !IsA(var, Var) || var->varlevelsup != 0)
+				continue;
+
+			if (var->varno == relid1 && var->varattno == key1)
+				found1 = true;
+			else if (var->varno == relid2 && var->varattno == key2)
+				found2 = true;
+		}
+
+		if (found1 && found2)
+			return true;
+	}
+
+	return false;
+}
@@ -85,6 +85,7 @@
 #include "access/tsmapi.h"
 #include "executor/executor.h"
 #include "executor/nodeHash.h"
+#include "executor/nodeIncrementalSort.h"
 #include "miscadmin.h"
 #include "nodes/nodeFuncs.h"
 #include "optimizer/clauses.h"
@@ -137,6 +138,7 @@ bool		enable_indexonlyscan = true;
 bool		enable_bitmapscan = true;
 bool		enable_tidscan = true;
 bool		enable_sort = true;
+bool		enable_incrementalsort = true;
 bool		enable_hashagg = true;
 bool		enable_nestloop = true;
 bool		enable_material = true;
@@ -145,6 +147,10 @@ bool		enable_hashjoin = true;
 bool		enable_fast_query_shipping = true;
 bool		enable_gathermerge = true;
 bool        enable_partition_wise_join = false;
+#ifdef __OPENTENBASE__
+bool        enable_partition_wise_aggregate = false;
+bool        enable_runtime_partition_pruning = true;
+#endif
 bool		enable_nestloop_suppression = false;
 
 typedef struct
@@ -157,6 +163,10 @@ static List *extract_nonindex_conditions(List *qual_clauses, List *indexquals);
 static MergeScanSelCache *cached_scansel(PlannerInfo *root,
                RestrictInfo *rinfo,
                PathKey *pathkey);
+static void cost_tuplesort(Cost *startup_cost, Cost *run_cost,
+               double tuples, int width,
+               Cost comparison_cost, int sort_mem,
+               double limit_tuples);
 static void cost_rescan(PlannerInfo *root, Path *path,
             Cost *rescan_startup_cost, Cost *rescan_total_cost);
 static bool cost_qual_eval_walker(Node *node, cost_qual_eval_context *context);
@@ -1744,18 +1754,43 @@ cost_sort(Path *path, PlannerInfo *root,
           List *pathkeys, Cost input_cost, double tuples, int width,
           Cost comparison_cost, int sort_mem,
           double limit_tuples)
-{// #lizard forgives
-    Cost        startup_cost = input_cost;
-    Cost        run_cost = 0;
-    double        input_bytes = relation_byte_size(tuples, width);
-    double        output_bytes;
-    double        output_tuples;
-    long        sort_mem_bytes = sort_mem * 1024L;
+{
+    Cost        startup_cost;
+    Cost        run_cost;
+
+    cost_tuplesort(&startup_cost, &run_cost,
+                   tuples, width,
+                   comparison_cost, sort_mem,
+                   limit_tuples);
 
     if (!enable_sort)
         startup_cost += disable_cost;
 
+    startup_cost += input_cost;
+
     path->rows = tuples;
+    path->startup_cost = startup_cost;
+    path->total_cost = startup_cost + run_cost;
+}
+
+/*
+ * cost_tuplesort
+ *      Determines the cost of sorting tuples with tuplesort.c, leaving out
+ *      the cost of reading the input.
+ *
+ * The startup cost is the cost of the sort itself, the run cost that of
+ * returning the sorted tuples.  See cost_sort for the parameters.
+ */
+static void
+cost_tuplesort(Cost *startup_cost, Cost *run_cost,
+               double tuples, int width,
+               Cost comparison_cost, int sort_mem,
+               double limit_tuples)
+{
+    double        input_bytes = relation_byte_size(tuples, width);
+    double        output_bytes;
+    double        output_tuples;
+    long        sort_mem_bytes = sort_mem * 1024L;
 
     /*
      * We want to be sure the cost of a sort is never estimated as zero, even
@@ -1795,7 +1830,7 @@ cost_sort(Path *path, PlannerInfo *root,
          *
          * Assume about N log2 N comparisons
          */
-        startup_cost += comparison_cost * tuples * LOG2(tuples);
+        *startup_cost = comparison_cost * tuples * LOG2(tuples);
 
         /* Disk costs */
 
@@ -1806,7 +1841,7 @@ cost_sort(Path *path, PlannerInfo *root,
             log_runs = 1.0;
         npageaccesses = 2.0 * npages * log_runs;
         /* Assume 3/4ths of accesses are sequential, 1/4th are not */
-        startup_cost += npageaccesses *
+        *startup_cost += npageaccesses *
             (seq_page_cost * 0.75 + random_page_cost * 0.25);
     }
     else if (tuples > 2 * output_tuples || input_bytes > sort_mem_bytes)
@@ -1817,12 +1852,12 @@ cost_sort(Path *path, PlannerInfo *root,
          * factor is a bit higher than for quicksort.  Tweak it so that the
          * cost curve is continuous at the crossover point.
          */
-        startup_cost += comparison_cost * tuples * LOG2(2.0 * output_tuples);
+        *startup_cost = comparison_cost * tuples * LOG2(2.0 * output_tuples);
     }
     else
     {
         /* We'll use plain quicksort on all the input tuples */
-        startup_cost += comparison_cost * tuples * LOG2(tuples);
+        *startup_cost = comparison_cost * tuples * LOG2(tuples);
     }
 
     /*
@@ -1833,7 +1868,104 @@ cost_sort(Path *path, PlannerInfo *root,
      * here --- the upper LIMIT will pro-rate the run cost so we'd be double
      * counting the LIMIT otherwise.
      */
-    run_cost += cpu_operator_cost * tuples;
+    *run_cost = cpu_operator_cost * tuples;
+}
+
+/*
+ * cost_incremental_sort
+ *      Determines and returns the cost of sorting a relation incrementally,
+ *      when the input is already sorted by the first 'presorted_keys' of
+ *      'pathkeys'.
+ *
+ * The executor reads the input in batches of at least
+ * INCREMENTAL_SORT_MIN_BATCH tuples that end where the presorted keys change,
+ * and sorts each batch on its own.  The first output tuple is available as
+ * soon as the first batch is sorted, which is what makes the incremental
+ * sort attractive below a LIMIT.
+ *
+ * 'input_startup_cost' and 'input_total_cost' are the costs of the input,
+ * the other parameters are as for cost_sort.
+ */
+void
+cost_incremental_sort(Path *path, PlannerInfo *root,
+                      List *pathkeys, int presorted_keys,
+                      Cost input_startup_cost, Cost input_total_cost,
+                      double input_tuples, int width, Cost comparison_cost,
+                      int sort_mem, double limit_tuples)
+{
+    Cost        startup_cost;
+    Cost        run_cost;
+    Cost        input_run_cost = input_total_cost - input_startup_cost;
+    Cost        batch_startup_cost;
+    Cost        batch_run_cost;
+    Cost        batch_input_run_cost;
+    double        input_groups;
+    double        nbatches;
+    double        batch_tuples;
+    List       *presortedExprs = NIL;
+    ListCell   *l;
+    int            i = 0;
+
+    Assert(presorted_keys > 0 && presorted_keys < list_length(pathkeys));
+
+    path->rows = input_tuples;
+
+    /*
+     * We want to be sure the cost of a sort is never estimated as zero, even
+     * if passed-in tuple count is zero.  Besides, mustn't do log(0)...
+     */
+    if (input_tuples < 2.0)
+        input_tuples = 2.0;
+
+    /*
+     * Estimate the number of runs of equal presorted keys, from any member
+     * of their equivalence classes.  Without statistics this falls back to
+     * the usual default number of distinct values.
+     */
+    foreach(l, pathkeys)
+    {
+        PathKey    *key = (PathKey *) lfirst(l);
+        EquivalenceMember *member = (EquivalenceMember *)
+            linitial(key->pk_eclass->ec_members);
+
+        presortedExprs = lappend(presortedExprs, member->em_expr);
+
+        if (++i >= presorted_keys)
+            break;
+    }
+
+    input_groups = estimate_num_groups(root, presortedExprs, input_tuples, NULL);
+    list_free(presortedExprs);
+
+    /* Small runs share a batch, up to the batch's minimum size */
+    nbatches = Min(input_groups,
+                   ceil(input_tuples / INCREMENTAL_SORT_MIN_BATCH));
+    nbatches = Max(nbatches, 1.0);
+    batch_tuples = input_tuples / nbatches;
+    batch_input_run_cost = input_run_cost / nbatches;
+
+    cost_tuplesort(&batch_startup_cost, &batch_run_cost,
+                   batch_tuples, width,
+                   comparison_cost, sort_mem,
+                   limit_tuples);
+
+    /*
+     * The first output tuple is returned once the first batch has been read
+     * and sorted.  Every other batch adds the same work.
+     */
+    startup_cost = input_startup_cost + batch_input_run_cost +
+        batch_startup_cost;
+    run_cost = batch_run_cost +
+        (batch_startup_cost + batch_run_cost + batch_input_run_cost) *
+        (nbatches - 1);
+
+    /*
+     * Each input tuple is compared to the batch's pivot on the presorted
+     * keys, and each batch needs a tuplesort of its own.
+     */
+    run_cost += (cpu_tuple_cost + 2.0 * cpu_operator_cost * presorted_keys) *
+        input_tuples;
+    run_cost += 2.0 * cpu_tuple_cost * nbatches;
 
     path->startup_cost = startup_cost;
     path->total_cost = startup_cost + run_cost;
@@ -328,6 +328,54 @@ pathkeys_contained_in(List *keys1, List *keys2)
     return false;
 }
 
+/*
+ * pathkeys_count_contained_in
+ *      Same as pathkeys_contained_in, but also sets *n_common to the number
+ *      of leading keys of keys1 that keys2 is sorted by.  An incremental
+ *      sort only needs to sort the input by the remaining keys.
+ */
+bool
+pathkeys_count_contained_in(List *keys1, List *keys2, int *n_common)
+{
+    int            n = 0;
+    ListCell   *key1,
+               *key2;
+
+    /* Fall out quickly in the trivial cases, as compare_pathkeys does */
+    if (keys1 == keys2)
+    {
+        *n_common = list_length(keys1);
+        return true;
+    }
+    else if (keys1 == NIL)
+    {
+        *n_common = 0;
+        return true;
+    }
+    else if (keys2 == NIL)
+    {
+        *n_common = 0;
+        return false;
+    }
+
+    forboth(key1, keys1, key2, keys2)
+    {
+        PathKey    *pathkey1 = (PathKey *) lfirst(key1);
+        PathKey    *pathkey2 = (PathKey *) lfirst(key2);
+
+        if (pathkey1 != pathkey2)
+        {
+            *n_common = n;
+            return false;
+        }
+        n++;
+    }
+
+    /* If we ended with a null value, then we've processed the whole list. */
+    *n_common = n;
+    return (key1 == NULL);
+}
+
 /*
  * get_cheapest_path_for_pathkeys
  *      Find the cheapest path (according to the specified criterion) that
@@ -79,6 +79,10 @@
 #endif
 
 #include "executor/nodeAgg.h"
+#include "partitioning/partprune.h"
+#ifdef _MLS_
+#include "utils/relcrypt.h"
+#endif
 /*
  * Flag bits that can appear in the flags argument of create_plan_recurse().
  * These can be OR-ed together.
@@ -119,11 +123,31 @@ static Plan *create_plan_recurse(PlannerInfo *root, Path *best_path,
 static Plan *create_scan_plan(PlannerInfo *root, Path *best_path,
                  int flags);
 static List *build_path_tlist(PlannerInfo *root, Path *path);
+#ifdef _MLS_
+static void set_scan_crypt_attrs(PlannerInfo *root, Path *best_path,
+                     List *scan_clauses, Scan *scan);
+#endif
 static bool use_physical_tlist(PlannerInfo *root, Path *path, int flags);
 static List *get_gating_quals(PlannerInfo *root, List *quals);
 static Plan *create_gating_plan(PlannerInfo *root, Path *path, Plan *plan,
                    List *gating_quals);
 static Plan *create_join_plan(PlannerInfo *root, JoinPath *best_path);
+static Plan *create_join_plan_internal(PlannerInfo *root, JoinPath *best_path);
+#ifdef __OPENTENBASE__
+static bool interval_path_partitions(PlannerInfo *root, Path *path,
+						 List **rels, Bitmapset **parts);
+static bool interval_join_on_keys(PlannerInfo *root, JoinPath *path,
+					  List *outer_rels, List *inner_rels);
+static Form_pg_partition_interval interval_rel_bounds(PlannerInfo *root,
+					RelOptInfo *rel);
+static bool interval_partitions_useful(List *rels, Bitmapset *parts);
+static Plan *create_interval_join_plan(PlannerInfo *root, JoinPath *best_path,
+						  List *rels, Bitmapset *parts);
+static bool interval_agg_partitions(PlannerInfo *root, AggPath *best_path,
+						List **rels, Bitmapset **parts);
+static Plan *create_interval_agg_plan(PlannerInfo *root, AggPath *best_path,
+						 List *rels, Bitmapset *parts);
+#endif
 static Plan *create_append_plan(PlannerInfo *root, AppendPath *best_path);
 static Plan *create_merge_append_plan(PlannerInfo *root, MergeAppendPath *best_path);
 static Result *create_result_plan(PlannerInfo *root, ResultPath *best_path);
@@ -144,10 +168,14 @@ static Gather *create_gather_plan(PlannerInfo *root, GatherPath *best_path);
 static Plan *create_projection_plan(PlannerInfo *root, ProjectionPath *best_path);
 static Plan *inject_projection_plan(Plan *subplan, List *tlist, bool parallel_safe);
 static Sort *create_sort_plan(PlannerInfo *root, SortPath *best_path, int flags);
+static IncrementalSort *create_incrementalsort_plan(PlannerInfo *root,
+                            IncrementalSortPath *best_path, int flags);
 static Group *create_group_plan(PlannerInfo *root, GroupPath *best_path);
 static Unique *create_upper_unique_plan(PlannerInfo *root, UpperUniquePath *best_path,
                          int flags);
-static Agg *create_agg_plan(PlannerInfo *root, AggPath *best_path);
+static Plan *create_agg_plan(PlannerInfo *root, AggPath *best_path);
+static Agg *create_agg_plan_for_subplan(PlannerInfo *root, AggPath *best_path,
+							Plan *subplan, double numGroups);
 static Plan *create_groupingsets_plan(PlannerInfo *root, GroupingSetsPath *best_path);
 static Result *create_minmaxagg_plan(PlannerInfo *root, MinMaxAggPath *best_path);
 static WindowAgg *create_windowagg_plan(PlannerInfo *root, WindowAggPath *best_path);
@@ -206,6 +234,12 @@ static NestLoop *create_nestloop_plan(PlannerInfo *root, NestPath *best_path);
 static MergeJoin *create_mergejoin_plan(PlannerInfo *root, MergePath *best_path);
 static HashJoin *create_hashjoin_plan(PlannerInfo *root, HashPath *best_path);
 static Node *replace_nestloop_params(PlannerInfo *root, Node *expr);
+#ifdef __OPENTENBASE__
+static List *append_prune_quals(PlannerInfo *root, RelOptInfo *rel,
+                   ParamPathInfo *param_info);
+static List *interval_prune_quals(PlannerInfo *root, Path *best_path,
+                     List *scan_clauses);
+#endif
 static Node *replace_nestloop_params_mutator(Node *node, PlannerInfo *root);
 static void process_subquery_nestloop_params(PlannerInfo *root,
                                  List *subplan_params);
@@ -305,6 +339,8 @@ static Plan *prepare_sort_from_pathkeys(Plan *lefttree, List *pathkeys,
 static EquivalenceMember *find_ec_member_for_tle(EquivalenceClass *ec,
                        TargetEntry *tle,
                        Relids relids);
+static IncrementalSort *make_incrementalsort_from_pathkeys(Plan *lefttree,
+                                   List *pathkeys, int nPresortedKeys);
 static Sort *make_sort_from_pathkeys(Plan *lefttree, List *pathkeys,
 						Relids relids);
 static Sort *make_sort_from_groupcols(List *groupcls,
@@ -526,6 +562,11 @@ create_plan_recurse(PlannerInfo *root, Path *best_path, int flags)
                                              (SortPath *) best_path,
                                              flags);
             break;
+        case T_IncrementalSort:
+            plan = (Plan *) create_incrementalsort_plan(root,
+                                                        (IncrementalSortPath *) best_path,
+                                                        flags);
+            break;
         case T_Group:
             plan = (Plan *) create_group_plan(root,
                                               (GroupPath *) best_path);
@@ -600,7 +641,7 @@ create_scan_plan(PlannerInfo *root, Path *best_path, int flags)
     bool    need_merge_append = false;            /* need MergeAppend */
 //    bool    need_pullup_filter = false;         /* need pull up filter */
     bool    isbackward = false;                 /* indexscan is backward ?*/
-    AttrNumber partkey;
+    AttrNumber partkey = InvalidAttrNumber;
 //    List        *outtlist = NULL;
 //    List        *qual = NULL;
 
@@ -892,6 +933,13 @@ create_scan_plan(PlannerInfo *root, Path *best_path, int flags)
             break;
     }
 
+#ifdef _MLS_
+    if (g_enable_transparent_crypt && rel->rtekind == RTE_RELATION)
+    {
+        set_scan_crypt_attrs(root, best_path, scan_clauses, (Scan *) plan);
+    }
+#endif
+
 #ifdef __OPENTENBASE__
     if((rel->reloptkind == RELOPT_BASEREL || rel->reloptkind == RELOPT_OTHER_MEMBER_REL) && rel->rtekind == RTE_RELATION && rel->intervalparent && !rel->isdefault)
     {        
@@ -1032,6 +1080,9 @@ create_scan_plan(PlannerInfo *root, Path *best_path, int flags)
                     }
                     mappend->interval = true;
                     mappend->plan.parallel_aware = best_path->parallel_aware;
+                    mappend->part_prune_info = make_interval_pruneinfo(rel, partkey,
+                                                                       scanlist,
+                                                                       interval_prune_quals(root, best_path, scan_clauses));
                     plan = (Plan *)mappend;
                 }
                 else
@@ -1040,6 +1091,9 @@ create_scan_plan(PlannerInfo *root, Path *best_path, int flags)
                     append = make_append(scanlist, tlist, NULL);
                     append->interval = true;
                     append->plan.parallel_aware = best_path->parallel_aware;
+                    append->part_prune_info = make_interval_pruneinfo(rel, partkey,
+                                                                      scanlist,
+                                                                      interval_prune_quals(root, best_path, scan_clauses));
                     plan = (Plan *)append;
                 }
             }
@@ -1073,6 +1127,44 @@ create_scan_plan(PlannerInfo *root, Path *best_path, int flags)
     return plan;
 }
 
+#ifdef _MLS_
+/*
+ * set_scan_crypt_attrs
+ *      Remember which attributes of a column-crypted relation are read above
+ *      the scan, so that the executor only decrypts those.
+ *
+ * The set is taken from the path's target and the scan clauses rather than
+ * from the plan's tlist, which may be the physical tlist.
+ */
+static void
+set_scan_crypt_attrs(PlannerInfo *root, Path *best_path,
+                     List *scan_clauses, Scan *scan)
+{
+    RelOptInfo    *rel = best_path->parent;
+    RangeTblEntry *rte = planner_rt_fetch(rel->relid, root);
+    Relation       relation;
+    Bitmapset     *attrs = NULL;
+    bool           has_crypt;
+
+    relation = heap_open(rte->relid, NoLock);
+    has_crypt = (relation->rd_att->transp_crypt != NULL);
+    heap_close(relation, NoLock);
+
+    if (!has_crypt)
+        return;
+
+    pull_varattnos((Node *) best_path->pathtarget->exprs, rel->relid, &attrs);
+    pull_varattnos((Node *) extract_actual_clauses(scan_clauses, false),
+                   rel->relid, &attrs);
+    if (IsA(best_path, IndexPath))
+        pull_varattnos((Node *) ((IndexPath *) best_path)->indexorderbys,
+                       rel->relid, &attrs);
+
+    scan->crypt_attrs_pruned = true;
+    scan->crypt_attrs = attrs;
+}
+#endif
+
 /*
  * Build a target list (ie, a list of TargetEntry) for the Path's output.
  *
@@ -1305,27 +1397,21 @@ create_join_plan(PlannerInfo *root, JoinPath *best_path)
 {
     Plan       *plan;
     List       *gating_clauses;
+#ifdef __OPENTENBASE__
+    List       *rels = NIL;
+    Bitmapset  *parts = NULL;
 
-    switch (best_path->path.pathtype)
-    {
-        case T_MergeJoin:
-            plan = (Plan *) create_mergejoin_plan(root,
-                                                  (MergePath *) best_path);
-            break;
-        case T_HashJoin:
-            plan = (Plan *) create_hashjoin_plan(root,
-                                                 (HashPath *) best_path);
-            break;
-        case T_NestLoop:
-            plan = (Plan *) create_nestloop_plan(root,
-                                                 (NestPath *) best_path);
-            break;
-        default:
-            elog(ERROR, "unrecognized node type: %d",
-                 (int) best_path->path.pathtype);
-            plan = NULL;        /* keep compiler quiet */
-            break;
-    }
+    /*
+     * A join of interval partitioned tables on their partition keys is done
+     * partition by partition, unless its output is expected in some order.
+     */
+    if (enable_partition_wise_join && best_path->path.pathkeys == NIL &&
+        interval_path_partitions(root, (Path *) best_path, &rels, &parts) &&
+        interval_partitions_useful(rels, parts))
+        plan = create_interval_join_plan(root, best_path, rels, parts);
+    else
+#endif
+        plan = create_join_plan_internal(root, best_path);
 
     /*
      * If there are any pseudoconstant clauses attached to this node, insert a
@@ -1353,6 +1439,319 @@ create_join_plan(PlannerInfo *root, JoinPath *best_path)
     return plan;
 }
 
+/*
+ * create_join_plan_internal
+ *      Create the join node for 'best_path', without any gating Result.
+ */
+static Plan *
+create_join_plan_internal(PlannerInfo *root, JoinPath *best_path)
+{
+    Plan       *plan;
+
+    switch (best_path->path.pathtype)
+    {
+        case T_MergeJoin:
+            plan = (Plan *) create_mergejoin_plan(root,
+                                                  (MergePath *) best_path);
+            break;
+        case T_HashJoin:
+            plan = (Plan *) create_hashjoin_plan(root,
+                                                 (HashPath *) best_path);
+            break;
+        case T_NestLoop:
+            plan = (Plan *) create_nestloop_plan(root,
+                                                 (NestPath *) best_path);
+            break;
+        default:
+            elog(ERROR, "unrecognized node type: %d",
+                 (int) best_path->path.pathtype);
+            plan = NULL;        /* keep compiler quiet */
+            break;
+    }
+
+    return plan;
+}
+
+#ifdef __OPENTENBASE__
+/*
+ * interval_path_partitions
+ *      Can the plan of the path be built once for each partition of the
+ *      interval partitioned tables it reads?
+ *
+ * That is so for a scan of such a table, and for a join of such scans on
+ * their partition keys when all the tables have the same partition bounds:
+ * rows of partition i of one table can only match rows of partition i of
+ * another.  On success *rels gets the RelOptInfos of the tables and *parts
+ * the partitions their rows can come from, as seen from above the path.
+ */
+static bool
+interval_path_partitions(PlannerInfo *root, Path *path,
+						 List **rels, Bitmapset **parts)
+{
+	RelOptInfo *rel = path->parent;
+
+	/* parallel plans share their scans across workers, leave them alone */
+	if (path->parallel_aware || path->parallel_workers > 0)
+		return false;
+
+	switch (path->pathtype)
+	{
+		case T_SeqScan:
+		case T_IndexScan:
+		case T_IndexOnlyScan:
+		case T_BitmapHeapScan:
+			if (rel->reloptkind != RELOPT_BASEREL ||
+				rel->rtekind != RTE_RELATION ||
+				!rel->intervalparent || rel->isdefault ||
+				bms_is_empty(rel->childs) ||
+				(root->parse->resultRelation == rel->relid &&
+				 root->parse->commandType != CMD_INSERT))
+				return false;
+
+			*rels = list_make1(rel);
+			*parts = bms_copy(rel->childs);
+			return true;
+
+		case T_NestLoop:
+		case T_MergeJoin:
+		case T_HashJoin:
+			{
+				JoinPath   *jpath = (JoinPath *) path;
+				List	   *outer_rels = NIL;
+				List	   *inner_rels = NIL;
+				Bitmapset  *outer_parts = NULL;
+				Bitmapset  *inner_parts = NULL;
+				Form_pg_partition_interval bounds1;
+				Form_pg_partition_interval bounds2;
+
+				if (!interval_path_partitions(root, jpath->outerjoinpath,
+											  &outer_rels, &outer_parts) ||
+					!interval_path_partitions(root, jpath->innerjoinpath,
+											  &inner_rels, &inner_parts))
+					return false;
+
+				/* the partition i of every table holds the same keys */
+				bounds1 = interval_rel_bounds(root, linitial(outer_rels));
+				bounds2 = interval_rel_bounds(root, linitial(inner_rels));
+				if (bounds1 == NULL || bounds2 == NULL ||
+					bounds1->partinterval_type != bounds2->partinterval_type ||
+					bounds1->partdatatype != bounds2->partdatatype ||
+					bounds1->partnparts != bounds2->partnparts ||
+					bounds1->partstartvalue_int != bounds2->partstartvalue_int ||
+					bounds1->partstartvalue_ts != bounds2->partstartvalue_ts ||
+					bounds1->partinterval_int != bounds2->partinterval_int)
+					return false;
+
+				if (!interval_join_on_keys(root, jpath, outer_rels, inner_rels))
+					return false;
+
+				/*
+				 * The rows of a partition not scanned on one side have been
+				 * filtered out by quals, so they cannot match.  What is left
+				 * are the partitions of the sides that keep their rows.
+				 */
+				switch (jpath->jointype)
+				{
+					case JOIN_INNER:
+						*parts = bms_intersect(outer_parts, inner_parts);
+						break;
+					case JOIN_LEFT:
+					case JOIN_SEMI:
+					case JOIN_ANTI:
+						*parts = outer_parts;
+						break;
+					case JOIN_RIGHT:
+						*parts = inner_parts;
+						break;
+					case JOIN_FULL:
+						*parts = bms_union(outer_parts, inner_parts);
+						break;
+					default:
+						return false;
+				}
+
+				*rels = list_concat(outer_rels, inner_rels);
+				return true;
+			}
+
+		default:
+			return false;
+	}
+}
+
+/*
+ * interval_join_on_keys
+ *      Does the join equate the partition key of a table on its outer side
+ *      with the partition key of a table on its inner side?
+ */
+static bool
+interval_join_on_keys(PlannerInfo *root, JoinPath *path,
+					  List *outer_rels, List *inner_rels)
+{
+	List	   *clauses = path->joinrestrictinfo;
+	ListCell   *lc;
+
+	/* the join clauses may have been pushed into a parameterized inner scan */
+	if (path->innerjoinpath->param_info)
+		clauses = list_concat(list_copy(clauses),
+							  path->innerjoinpath->param_info->ppi_clauses);
+
+	foreach(lc, clauses)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+		OpExpr	   *clause = (OpExpr *) rinfo->clause;
+		Var		   *var1;
+		Var		   *var2;
+		ListCell   *lc2;
+		bool		outer_key1 = false;
+		bool		outer_key2 = false;
+		bool		inner_key1 = false;
+		bool		inner_key2 = false;
+
+		/* only equalities, which no NULL satisfies */
+		if (rinfo->pseudoconstant || rinfo->mergeopfamilies == NIL ||
+			!is_opclause(clause) || list_length(clause->args) != 2)
+			continue;
+
+		var1 = (Var *) strip_implicit_coercions(linitial(clause->args));
+		var2 = (Var *) strip_implicit_coercions(lsecond(clause->args));
+		if (!IsA(var1, Var) || !IsA(var2, Var) ||
+			var1->varlevelsup != 0 || var2->varlevelsup != 0)
+			continue;
+
+		foreach(lc2, outer_rels)
+		{
+			RelOptInfo *rel = (RelOptInfo *) lfirst(lc2);
+			Form_pg_partition_interval bounds = interval_rel_bounds(root, rel);
+
+			outer_key1 |= (var1->varno == rel->relid &&
+						   var1->varattno == bounds->partpartkey);
+			outer_key2 |= (var2->varno == rel->relid &&
+						   var2->varattno == bounds->partpartkey);
+		}
+
+		foreach(lc2, inner_rels)
+		{
+			RelOptInfo *rel = (RelOptInfo *) lfirst(lc2);
+			Form_pg_partition_interval bounds = interval_rel_bounds(root, rel);
+
+			inner_key1 |= (var1->varno == rel->relid &&
+						   var1->varattno == bounds->partpartkey);
+			inner_key2 |= (var2->varno == rel->relid &&
+						   var2->varattno == bounds->partpartkey);
+		}
+
+		if ((outer_key1 && inner_key2) || (outer_key2 && inner_key1))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * interval_rel_bounds
+ *      The partition bounds of an interval partitioned table, NULL if it has
+ *      none.
+ */
+static Form_pg_partition_interval
+interval_rel_bounds(PlannerInfo *root, RelOptInfo *rel)
+{
+	RangeTblEntry *rte = root->simple_rte_array[rel->relid];
+	Relation	relation;
+	Form_pg_partition_interval bounds = NULL;
+
+	relation = heap_open(rte->relid, NoLock);
+	if (relation->rd_partitions_info)
+	{
+		bounds = (Form_pg_partition_interval)
+			palloc(sizeof(FormData_pg_partition_interval));
+		memcpy(bounds, relation->rd_partitions_info,
+			   sizeof(FormData_pg_partition_interval));
+	}
+	heap_close(relation, NoLock);
+
+	return bounds;
+}
+
+/*
+ * interval_partitions_useful
+ *      Is there anything to gain in building a plan per partition?  Yes if
+ *      there are several, or if a table scans partitions of which no row can
+ *      be returned, like the nullable side of an outer join.
+ */
+static bool
+interval_partitions_useful(List *rels, Bitmapset *parts)
+{
+	ListCell   *lc;
+
+	if (bms_is_empty(parts))
+		return false;
+
+	if (bms_num_members(parts) > 1)
+		return true;
+
+	foreach(lc, rels)
+	{
+		if (!bms_equal(((RelOptInfo *) lfirst(lc))->childs, parts))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * create_interval_join_plan
+ *      Create the plan of a join of interval partitioned tables once for each
+ *      of their partitions, and append them.
+ *
+ * Each join then only hashes, sorts or rescans the rows of one partition of
+ * its inner side, instead of those of all the partitions.  The plans of the
+ * tables scan a single partition each, the one of the current join.
+ */
+static Plan *
+create_interval_join_plan(PlannerInfo *root, JoinPath *best_path,
+						  List *rels, Bitmapset *parts)
+{
+	Append	   *plan;
+	List	   *subplans = NIL;
+	Bitmapset **childs;
+	Bitmapset  *tmpparts;
+	ListCell   *lc;
+	int			idx;
+	int			i;
+
+	childs = (Bitmapset **) palloc(list_length(rels) * sizeof(Bitmapset *));
+	i = 0;
+	foreach(lc, rels)
+		childs[i++] = ((RelOptInfo *) lfirst(lc))->childs;
+
+	tmpparts = bms_copy(parts);
+	while ((idx = bms_first_member(tmpparts)) >= 0)
+	{
+		Plan	   *subplan;
+
+		foreach(lc, rels)
+			((RelOptInfo *) lfirst(lc))->childs = bms_make_singleton(idx);
+
+		subplan = create_join_plan_internal(root, best_path);
+		subplan->plan_rows = clamp_row_est(subplan->plan_rows /
+										   bms_num_members(parts));
+		subplans = lappend(subplans, subplan);
+	}
+	bms_free(tmpparts);
+
+	i = 0;
+	foreach(lc, rels)
+		((RelOptInfo *) lfirst(lc))->childs = childs[i++];
+	pfree(childs);
+
+	plan = make_append(subplans, build_path_tlist(root, &best_path->path), NIL);
+	copy_generic_path_info(&plan->plan, &best_path->path);
+
+	return (Plan *) plan;
+}
+#endif
+
 /*
  * create_append_plan
  *      Create an Append plan for 'best_path' and (recursively) plans
@@ -1422,6 +1821,16 @@ create_append_plan(PlannerInfo *root, AppendPath *best_path)
 
     copy_generic_path_info(&plan->plan, (Path *) best_path);
 
+#ifdef __OPENTENBASE__
+    /* prune the partitions again once the values of Params are known */
+    if (best_path->partitioned_rels != NIL)
+        plan->part_prune_info =
+            make_partition_pruneinfo(root, best_path->path.parent,
+                                     best_path->subpaths,
+                                     append_prune_quals(root, best_path->path.parent,
+                                                        best_path->path.param_info));
+#endif
+
 #ifdef __OPENTENBASE__
     if (olap_optimizer)
     {
@@ -1536,9 +1945,60 @@ create_merge_append_plan(PlannerInfo *root, MergeAppendPath *best_path)
     node->partitioned_rels = best_path->partitioned_rels;
     node->mergeplans = subplans;
 
+#ifdef __OPENTENBASE__
+    if (best_path->partitioned_rels != NIL)
+        node->part_prune_info =
+            make_partition_pruneinfo(root, best_path->path.parent,
+                                     best_path->subpaths,
+                                     append_prune_quals(root, best_path->path.parent,
+                                                        best_path->path.param_info));
+#endif
+
     return (Plan *) node;
 }
 
+#ifdef __OPENTENBASE__
+/*
+ * The quals an Append over partitioned table 'rel' may prune partitions with
+ * at run time: its restriction clauses, and the join clauses it enforces as
+ * the inner side of a nestloop, with the outer Vars replaced by Params.
+ */
+static List *
+append_prune_quals(PlannerInfo *root, RelOptInfo *rel, ParamPathInfo *param_info)
+{
+    List       *prunequal;
+
+    if (!IS_SIMPLE_REL(rel) || rel->rtekind != RTE_RELATION)
+        return NIL;
+
+    prunequal = extract_actual_clauses(rel->baserestrictinfo, false);
+    if (param_info)
+    {
+        List       *prmquals = extract_actual_clauses(param_info->ppi_clauses, false);
+
+        prmquals = (List *) replace_nestloop_params(root, (Node *) prmquals);
+        prunequal = list_concat(prunequal, prmquals);
+    }
+
+    return prunequal;
+}
+
+/*
+ * Same for the Append over the partitions of an interval partitioned table,
+ * built from the scan of the table, see create_scan_plan.
+ */
+static List *
+interval_prune_quals(PlannerInfo *root, Path *best_path, List *scan_clauses)
+{
+    List       *prunequal = extract_actual_clauses(scan_clauses, false);
+
+    if (best_path->param_info)
+        prunequal = (List *) replace_nestloop_params(root, (Node *) prunequal);
+
+    return prunequal;
+}
+#endif
+
 /*
  * create_result_plan
  *      Create a Result plan for 'best_path'.
@@ -2256,6 +2716,32 @@ create_sort_plan(PlannerInfo *root, SortPath *best_path, int flags)
     return plan;
 }
 
+/*
+ * create_incrementalsort_plan
+ *
+ *      Create an IncrementalSort plan for 'best_path' and (recursively) plans
+ *      for its subpaths.
+ */
+static IncrementalSort *
+create_incrementalsort_plan(PlannerInfo *root, IncrementalSortPath *best_path,
+                            int flags)
+{
+    IncrementalSort *plan;
+    Plan       *subplan;
+
+    /* See comments in create_sort_plan() above */
+    subplan = create_plan_recurse(root, best_path->spath.subpath,
+                                  flags | CP_SMALL_TLIST);
+
+    plan = make_incrementalsort_from_pathkeys(subplan,
+                                              best_path->spath.path.pathkeys,
+                                              best_path->nPresortedCols);
+
+    copy_generic_path_info(&plan->sort.plan, (Path *) best_path);
+
+    return plan;
+}
+
 /*
  * create_group_plan
  *
@@ -2327,13 +2813,18 @@ create_upper_unique_plan(PlannerInfo *root, UpperUniquePath *best_path, int flag
  *      Create an Agg plan for 'best_path' and (recursively) plans
  *      for its subpaths.
  */
-static Agg *
+static Plan *
 create_agg_plan(PlannerInfo *root, AggPath *best_path)
 {
-    Agg           *plan;
     Plan       *subplan;
-    List       *tlist;
-    List       *quals;
+#ifdef __OPENTENBASE__
+    List       *rels = NIL;
+    Bitmapset  *parts = NULL;
+
+    if (enable_partition_wise_aggregate &&
+        interval_agg_partitions(root, best_path, &rels, &parts))
+        return create_interval_agg_plan(root, best_path, rels, parts);
+#endif
 
     /*
      * Agg can project, so no need to be terribly picky about child tlist, but
@@ -2341,6 +2832,22 @@ create_agg_plan(PlannerInfo *root, AggPath *best_path)
      */
     subplan = create_plan_recurse(root, best_path->subpath, CP_LABEL_TLIST);
 
+    return (Plan *) create_agg_plan_for_subplan(root, best_path, subplan,
+                                                best_path->numGroups);
+}
+
+/*
+ * create_agg_plan_for_subplan
+ *      Create the Agg node of 'best_path' over the given plan of its subpath.
+ */
+static Agg *
+create_agg_plan_for_subplan(PlannerInfo *root, AggPath *best_path,
+                            Plan *subplan, double numGroups)
+{
+    Agg           *plan;
+    List       *tlist;
+    List       *quals;
+
     tlist = build_path_tlist(root, &best_path->path);
 
     quals = order_qual_clauses(root, best_path->qual);
@@ -2354,7 +2861,7 @@ create_agg_plan(PlannerInfo *root, AggPath *best_path)
                     extract_grouping_ops(best_path->groupClause),
                     NIL,
                     NIL,
-                    best_path->numGroups,
+                    numGroups,
                     subplan);
 
     copy_generic_path_info(&plan->plan, (Path *) best_path);
@@ -2380,6 +2887,140 @@ create_agg_plan(PlannerInfo *root, AggPath *best_path)
     return plan;
 }
 
+#ifdef __OPENTENBASE__
+/*
+ * interval_agg_partitions
+ *      Can the aggregation be done partition by partition of the interval
+ *      partitioned tables under it?
+ *
+ * A partial aggregation, as done on the datanodes before the results are
+ * combined, can always be: the partial results of the partitions are then
+ * combined instead.  It must not be sorted though, the output of the
+ * partitions being appended one after the other.  A complete aggregation
+ * can be if it groups by the partition key, as no group then spans two
+ * partitions.
+ */
+static bool
+interval_agg_partitions(PlannerInfo *root, AggPath *best_path,
+						List **rels, Bitmapset **parts)
+{
+	Path	   *path;
+	ListCell   *lc;
+
+	if (best_path->path.parallel_aware || best_path->path.parallel_workers > 0)
+		return false;
+
+	if (!(best_path->aggstrategy == AGG_HASHED ||
+		  (best_path->aggstrategy == AGG_PLAIN &&
+		   best_path->aggsplit == AGGSPLIT_INITIAL_SERIAL)))
+		return false;
+
+	if (best_path->aggsplit != AGGSPLIT_INITIAL_SERIAL &&
+		best_path->aggsplit != AGGSPLIT_SIMPLE)
+		return false;
+
+	if (!interval_path_partitions(root, best_path->subpath, rels, parts) ||
+		!interval_partitions_useful(*rels, *parts))
+		return false;
+
+	if (best_path->aggsplit == AGGSPLIT_INITIAL_SERIAL)
+		return true;
+
+	/*
+	 * Outer joins null-extend rows of all the partitions, so only inner ones
+	 * keep the groups of a key within a partition.
+	 */
+	for (path = best_path->subpath; path->pathtype != T_SeqScan &&
+		 path->pathtype != T_IndexScan && path->pathtype != T_IndexOnlyScan &&
+		 path->pathtype != T_BitmapHeapScan;
+		 path = ((JoinPath *) path)->outerjoinpath)
+	{
+		if (((JoinPath *) path)->jointype != JOIN_INNER ||
+			!IS_SIMPLE_REL(((JoinPath *) path)->innerjoinpath->parent))
+			return false;
+	}
+
+	foreach(lc, best_path->groupClause)
+	{
+		SortGroupClause *sgc = (SortGroupClause *) lfirst(lc);
+		Var		   *var;
+		ListCell   *lc2;
+
+		var = (Var *) strip_implicit_coercions((Node *)
+						get_sortgroupclause_expr(sgc, root->parse->targetList));
+		if (!IsA(var, Var) || var->varlevelsup != 0)
+			continue;
+
+		foreach(lc2, *rels)
+		{
+			RelOptInfo *rel = (RelOptInfo *) lfirst(lc2);
+			Form_pg_partition_interval bounds = interval_rel_bounds(root, rel);
+
+			if (var->varno == rel->relid && var->varattno == bounds->partpartkey)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * create_interval_agg_plan
+ *      Create the plan of an aggregation once for each partition of the
+ *      interval partitioned tables it reads, and append them.
+ *
+ * The hash table of each aggregation only holds the groups of a partition.
+ */
+static Plan *
+create_interval_agg_plan(PlannerInfo *root, AggPath *best_path,
+						 List *rels, Bitmapset *parts)
+{
+	Append	   *plan;
+	List	   *subplans = NIL;
+	Bitmapset **childs;
+	Bitmapset  *tmpparts;
+	ListCell   *lc;
+	double		numGroups = best_path->numGroups;
+	int			idx;
+	int			i;
+
+	/* the groups of a complete aggregation are spread across the partitions */
+	if (best_path->aggsplit == AGGSPLIT_SIMPLE)
+		numGroups = clamp_row_est(numGroups / bms_num_members(parts));
+
+	childs = (Bitmapset **) palloc(list_length(rels) * sizeof(Bitmapset *));
+	i = 0;
+	foreach(lc, rels)
+		childs[i++] = ((RelOptInfo *) lfirst(lc))->childs;
+
+	tmpparts = bms_copy(parts);
+	while ((idx = bms_first_member(tmpparts)) >= 0)
+	{
+		Plan	   *subplan;
+
+		foreach(lc, rels)
+			((RelOptInfo *) lfirst(lc))->childs = bms_make_singleton(idx);
+
+		subplan = create_plan_recurse(root, best_path->subpath, CP_LABEL_TLIST);
+		subplan = (Plan *) create_agg_plan_for_subplan(root, best_path,
+													   subplan, numGroups);
+		subplan->plan_rows = numGroups;
+		subplans = lappend(subplans, subplan);
+	}
+	bms_free(tmpparts);
+
+	i = 0;
+	foreach(lc, rels)
+		((RelOptInfo *) lfirst(lc))->childs = childs[i++];
+	pfree(childs);
+
+	plan = make_append(subplans, build_path_tlist(root, &best_path->path), NIL);
+	copy_generic_path_info(&plan->plan, &best_path->path);
+
+	return (Plan *) plan;
+}
+#endif
+
 /*
  * Given a groupclause for a collection of grouping sets, produce the
  * corresponding groupColIdx.
@@ -7893,6 +8534,75 @@ make_sort_from_pathkeys(Plan *lefttree, List *pathkeys, Relids relids)
                      collations, nullsFirst);
 }
 
+/*
+ * make_incrementalsort_from_pathkeys
+ *      Create incremental sort plan to sort according to given pathkeys
+ *
+ *      'lefttree' is the node which yields input tuples
+ *      'pathkeys' is the list of pathkeys by which the result is to be sorted
+ *      'nPresortedKeys' is the number of leading pathkeys lefttree is sorted by
+ */
+static IncrementalSort *
+make_incrementalsort_from_pathkeys(Plan *lefttree, List *pathkeys,
+                                   int nPresortedKeys)
+{
+    IncrementalSort *node = makeNode(IncrementalSort);
+    Plan       *plan = &node->sort.plan;
+    List       *presorted;
+    int            numsortkeys;
+    AttrNumber *sortColIdx;
+    Oid           *sortOperators;
+    Oid           *collations;
+    bool       *nullsFirst;
+    int            npresorted;
+    AttrNumber *presortedColIdx;
+    Oid           *presortedOperators;
+    Oid           *presortedCollations;
+    bool       *presortedNullsFirst;
+
+    /* Compute sort column info, and adjust lefttree as needed */
+    lefttree = prepare_sort_from_pathkeys(lefttree, pathkeys,
+                                          NULL,
+                                          NULL,
+                                          false,
+                                          &numsortkeys,
+                                          &sortColIdx,
+                                          &sortOperators,
+                                          &collations,
+                                          &nullsFirst);
+
+    /*
+     * Duplicate sort columns are entered only once, so count the columns of
+     * the presorted pathkeys the same way.  They are the leading ones, and
+     * lefttree already computes all of them.
+     */
+    presorted = list_truncate(list_copy(pathkeys), nPresortedKeys);
+    (void) prepare_sort_from_pathkeys(lefttree, presorted,
+                                      NULL,
+                                      NULL,
+                                      false,
+                                      &npresorted,
+                                      &presortedColIdx,
+                                      &presortedOperators,
+                                      &presortedCollations,
+                                      &presortedNullsFirst);
+    list_free(presorted);
+    Assert(npresorted <= numsortkeys);
+
+    plan->targetlist = lefttree->targetlist;
+    plan->qual = NIL;
+    plan->lefttree = lefttree;
+    plan->righttree = NULL;
+    node->sort.numCols = numsortkeys;
+    node->sort.sortColIdx = sortColIdx;
+    node->sort.sortOperators = sortOperators;
+    node->sort.collations = collations;
+    node->sort.nullsFirst = nullsFirst;
+    node->nPresortedCols = npresorted;
+
+    return node;
+}
+
 /*
  * make_sort_from_sortclauses
  *      Create sort plan to sort according to given sortclauses
@@ -8838,6 +9548,7 @@ is_projection_capable_path(Path *path)
         case T_Hash:
         case T_Material:
         case T_Sort:
+        case T_IncrementalSort:
         case T_Unique:
         case T_SetOp:
         case T_LockRows:
@@ -8884,6 +9595,7 @@ is_projection_capable_plan(Plan *plan)
         case T_Hash:
         case T_Material:
         case T_Sort:
+        case T_IncrementalSort:
         case T_Unique:
         case T_SetOp:
         case T_LockRows:
@@ -9736,6 +10448,7 @@ GetPlanRows(Plan *plan)
         case T_Group:
         case T_Agg:
         case T_Sort:
+        case T_IncrementalSort:
         case T_Limit:
             rows = GetPlanRows(plan->lefttree);
             break;
@@ -5801,8 +5801,9 @@ create_distinct_paths(PlannerInfo *root,
  * Build a new upperrel containing Paths for ORDER BY evaluation.
  *
  * All paths in the result must satisfy the ORDER BY ordering.
- * The only new path we need consider is an explicit sort on the
- * cheapest-total existing path.
+ * The new paths we need consider are an explicit sort on the
+ * cheapest-total existing path, and incremental sorts on the paths
+ * already sorted by a leading part of the ORDER BY.
  *
  * input_rel: contains the source-data Paths
  * target: the output tlist the result Paths must emit
@@ -5842,10 +5843,13 @@ create_ordered_paths(PlannerInfo *root,
 	foreach(lc, input_rel->pathlist)
                         {
 		Path	   *path = (Path *) lfirst(lc);
+		Path	   *input_path = path;
 		bool		is_sorted;
+		int			presorted_keys;
 
-		is_sorted = pathkeys_contained_in(root->sort_pathkeys,
-										  path->pathkeys);
+		is_sorted = pathkeys_count_contained_in(root->sort_pathkeys,
+												path->pathkeys,
+												&presorted_keys);
 		if (path == cheapest_input_path || is_sorted)
 		{
 			if (!is_sorted)
@@ -5865,6 +5869,30 @@ create_ordered_paths(PlannerInfo *root,
                             
 			add_path(ordered_rel, path);
                         }
+
+		/*
+		 * A path already sorted by a leading part of the sort keys, such as
+		 * an index scan or the merge receive of a RemoteSubplan, only needs
+		 * its runs of equal leading keys to be sorted, and can return the
+		 * first rows long before a full sort would.  That's worth trying on
+		 * every such path, not just the cheapest one.
+		 */
+		if (!is_sorted && presorted_keys > 0 && enable_incrementalsort)
+		{
+			path = (Path *) create_incremental_sort_path(root,
+														 ordered_rel,
+														 input_path,
+														 root->sort_pathkeys,
+														 presorted_keys,
+														 limit_tuples);
+
+			/* Add projection step if needed */
+			if (path->pathtarget != target)
+				path = apply_projection_to_path(root, ordered_rel,
+												path, target);
+
+			add_path(ordered_rel, path);
+		}
                     }
 
             /*
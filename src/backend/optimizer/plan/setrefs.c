@@ -123,6 +123,10 @@ static void set_join_references(PlannerInfo *root, Join *join, int rtoffset);
 static void set_upper_references(PlannerInfo *root, Plan *plan, int rtoffset);
 static Node *convert_combining_aggrefs(Node *node, void *context);
 static void set_dummy_tlist_references(Plan *plan, int rtoffset);
+#ifdef __OPENTENBASE__
+static void set_part_prune_info_references(PlannerInfo *root,
+                               PartitionPruneInfo *pinfo, int rtoffset);
+#endif
 static indexed_tlist *build_tlist_index(List *tlist);
 static Var *search_indexed_tlist_for_var(Var *var,
                              indexed_tlist *itlist,
@@ -685,6 +689,7 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
         case T_Hash:
         case T_Material:
         case T_Sort:
+        case T_IncrementalSort:
         case T_Unique:
         case T_SetOp:
 
@@ -979,6 +984,11 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
                                               (Plan *) lfirst(l),
                                               rtoffset);
                 }
+#ifdef __OPENTENBASE__
+                if (splan->part_prune_info)
+                    set_part_prune_info_references(root, splan->part_prune_info,
+                                                   rtoffset);
+#endif
             }
             break;
         case T_MergeAppend:
@@ -1001,6 +1011,11 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
                                               (Plan *) lfirst(l),
                                               rtoffset);
                 }
+#ifdef __OPENTENBASE__
+                if (splan->part_prune_info)
+                    set_part_prune_info_references(root, splan->part_prune_info,
+                                                   rtoffset);
+#endif
             }
             break;
         case T_RecursiveUnion:
@@ -1921,6 +1936,30 @@ convert_combining_aggrefs(Node *node, void *context)
                                    (void *) context);
 }
 
+#ifdef __OPENTENBASE__
+/*
+ * set_part_prune_info_references
+ *	   Do set_plan_references processing on the run-time pruning info of an
+ *	   Append or MergeAppend: its expressions are evaluated by the executor.
+ */
+static void
+set_part_prune_info_references(PlannerInfo *root, PartitionPruneInfo *pinfo,
+                               int rtoffset)
+{
+    ListCell   *l;
+
+    pinfo->rtindex += rtoffset;
+    pinfo->prune_quals = fix_scan_list(root, pinfo->prune_quals, rtoffset);
+    foreach(l, pinfo->pruning_steps)
+    {
+        PartitionPruneStepOp *opstep = (PartitionPruneStepOp *) lfirst(l);
+
+        if (IsA(opstep, PartitionPruneStepOp))
+            opstep->exprs = fix_scan_list(root, opstep->exprs, rtoffset);
+    }
+}
+#endif
+
 /*
  * set_dummy_tlist_references
  *      Replace the targetlist of an upper-level plan node with a simple
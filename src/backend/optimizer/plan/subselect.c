@@ -5309,6 +5309,13 @@ finalize_plan(PlannerInfo *root, Plan *plan, int gather_param, Bitmapset *valid_
                                                       valid_params,
                                                       scan_params));
                 }
+#ifdef __OPENTENBASE__
+                /* run-time partition pruning depends on these too */
+                if (((Append *) plan)->part_prune_info)
+                    context.paramids =
+                        bms_add_members(context.paramids,
+                                        ((Append *) plan)->part_prune_info->execparamids);
+#endif
             }
             break;
 
@@ -5326,6 +5333,13 @@ finalize_plan(PlannerInfo *root, Plan *plan, int gather_param, Bitmapset *valid_
                                                       valid_params,
                                                       scan_params));
                 }
+#ifdef __OPENTENBASE__
+                /* run-time partition pruning depends on these too */
+                if (((MergeAppend *) plan)->part_prune_info)
+                    context.paramids =
+                        bms_add_members(context.paramids,
+                                        ((MergeAppend *) plan)->part_prune_info->execparamids);
+#endif
             }
             break;
 
@@ -5452,6 +5466,7 @@ finalize_plan(PlannerInfo *root, Plan *plan, int gather_param, Bitmapset *valid_
         case T_Hash:
         case T_Material:
         case T_Sort:
+        case T_IncrementalSort:
         case T_Unique:
         case T_Gather:
         case T_GatherMerge:
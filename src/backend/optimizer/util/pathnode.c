@@ -2985,6 +2985,7 @@ contains_remotesubplan(Path *path, int *number, bool *redistribute)
             }
             break;
         case T_Sort:
+        case T_IncrementalSort:
             {
                 SortPath *pathnode = (SortPath *)path;
 
@@ -6065,6 +6066,59 @@ create_sort_path(PlannerInfo *root,
     return pathnode;
 }
 
+/*
+ * create_incremental_sort_path
+ *      Creates a pathnode that represents sorting an input already sorted
+ *      by the first 'presorted_keys' of 'pathkeys'
+ *
+ * 'rel' is the parent relation associated with the result
+ * 'subpath' is the path representing the source of data
+ * 'pathkeys' represents the desired sort order
+ * 'presorted_keys' is the number of leading pathkeys subpath is sorted by
+ * 'limit_tuples' is the estimated bound on the number of output tuples,
+ *        or -1 if no LIMIT or couldn't estimate
+ */
+IncrementalSortPath *
+create_incremental_sort_path(PlannerInfo *root,
+                             RelOptInfo *rel,
+                             Path *subpath,
+                             List *pathkeys,
+                             int presorted_keys,
+                             double limit_tuples)
+{
+    IncrementalSortPath *sort = makeNode(IncrementalSortPath);
+    SortPath   *pathnode = &sort->spath;
+
+    pathnode->path.pathtype = T_IncrementalSort;
+    pathnode->path.parent = rel;
+    /* Sort doesn't project, so use source path's pathtarget */
+    pathnode->path.pathtarget = subpath->pathtarget;
+    /* For now, assume we are above any joins, so no parameterization */
+    pathnode->path.param_info = NULL;
+    pathnode->path.parallel_aware = false;
+    pathnode->path.parallel_safe = rel->consider_parallel &&
+        subpath->parallel_safe;
+    pathnode->path.parallel_workers = subpath->parallel_workers;
+    pathnode->path.pathkeys = pathkeys;
+
+    /* distribution is the same as in the subpath */
+    pathnode->path.distribution = copyObject(subpath->distribution);
+
+    pathnode->subpath = subpath;
+    sort->nPresortedCols = presorted_keys;
+
+    cost_incremental_sort(&pathnode->path,
+                          root, pathkeys, presorted_keys,
+                          subpath->startup_cost,
+                          subpath->total_cost,
+                          subpath->rows,
+                          subpath->pathtarget->width,
+                          0.0,                /* XXX comparison_cost shouldn't be 0? */
+                          work_mem, limit_tuples);
+
+    return sort;
+}
+
 /*
  * create_group_path
  *      Creates a pathnode that represents performing grouping of presorted input
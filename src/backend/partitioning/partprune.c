@@ -24,13 +24,17 @@
 #include "catalog/pg_operator.h"
 #include "catalog/pg_opfamily.h"
 #include "catalog/pg_type.h"
+#include "executor/executor.h"
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
 #include "optimizer/clauses.h"
+#include "optimizer/cost.h"
+#include "optimizer/pathnode.h"
 #include "optimizer/planner.h"
 #include "optimizer/predtest.h"
 #include "optimizer/prep.h"
+#include "optimizer/var.h"
 #include "partitioning/partprune.h"
 #include "partitioning/partbounds.h"
 #include "rewrite/rewriteManip.h"
@@ -148,7 +152,15 @@ static PartClauseMatchStatus match_boolean_partition_clause(Oid partopfamily,
                                                            Expr *partkey,
                                                            Expr **outconst);
 static bool partkey_datum_from_expr(PartitionPruneContext *context,
-						Expr *expr, Datum *value);
+						Expr *expr, int stateidx, Datum *value);
+#ifdef __OPENTENBASE__
+static bool partprune_needs_runtime(Node *clause);
+static bool contain_params_walker(Node *node, void *context);
+static bool pull_exec_paramids_walker(Node *node, Bitmapset **context);
+static int	partition_index_of_rel(PlannerInfo *root, RelOptInfo *rel,
+					   RelOptInfo *childrel);
+static bool interval_prune_qual_ok(Node *qual, Index varno, AttrNumber partkey);
+#endif
 
 
 /*
@@ -244,6 +256,10 @@ prune_append_rel_partitions(RelOptInfo *rel)
 	context.partsupfunc = rel->part_scheme->partsupfunc;
 	context.nparts = rel->nparts;
 	context.boundinfo = rel->boundinfo;
+#ifdef __OPENTENBASE__
+	context.exprstates = NULL;
+	context.exprcontext = NULL;
+#endif
 
 	/* Actual pruning happens here. */
 	partindexes = get_matching_partitions(&context, pruning_steps);
@@ -2491,7 +2507,11 @@ perform_pruning_base_step(PartitionPruneContext *context,
 			Datum		datum;
 
 			expr = lfirst(lc1);
-			if (partkey_datum_from_expr(context, expr, &datum))
+			if (partkey_datum_from_expr(context, expr,
+										PruneCxtStateIdx(context->partnatts,
+														 opstep->step.step_id,
+														 keyno),
+										&datum))
 			{
 				Oid			cmpfn;
 
@@ -2740,10 +2760,13 @@ match_boolean_partition_clause(Oid partopfamily, Expr *clause, Expr *partkey,
  * partkey_datum_from_expr
  *		Evaluate 'expr', set *value to the resulting Datum. Return true if
  *		evaluation was possible, otherwise false.
+ *
+ * At run time, expressions that are not Consts are evaluated with the state
+ * found at 'stateidx', if any.
  */
 static bool
 partkey_datum_from_expr(PartitionPruneContext *context,
-						Expr *expr, Datum *value)
+						Expr *expr, int stateidx, Datum *value)
 {
 	switch (nodeTag(expr))
 	{
@@ -2755,5 +2778,290 @@ partkey_datum_from_expr(PartitionPruneContext *context,
 			break;
 	}
 
+#ifdef __OPENTENBASE__
+	if (context->exprstates != NULL && context->exprstates[stateidx] != NULL)
+	{
+		bool		isnull;
+
+		*value = ExecEvalExprSwitchContext(context->exprstates[stateidx],
+										   context->exprcontext, &isnull);
+
+		/*
+		 * The operators are strict, so no partition matches a NULL, but
+		 * leave that to the scans.
+		 */
+		return !isnull;
+	}
+#endif
+
 	return false;
 }
+
+#ifdef __OPENTENBASE__
+/*
+ * make_partition_pruneinfo
+ *		Build the information to prune at run time the subplans of an Append
+ *		or MergeAppend over the partitioned table 'rel', one per subpath in
+ *		'subpaths'.  'prunequal' are the quals of the Append, with the outer
+ *		Vars of a parameterized path replaced by Params.
+ *
+ * Returns NULL if the quals don't prune more at run time than they did at
+ * plan time, or if no subplan scans a partition of 'rel'.
+ */
+PartitionPruneInfo *
+make_partition_pruneinfo(PlannerInfo *root, RelOptInfo *rel,
+						 List *subpaths, List *prunequal)
+{
+	PartitionPruneInfo *pinfo;
+	List	   *pruning_steps;
+	List	   *subplan_parts = NIL;
+	bool		contradictory;
+	bool		doprune = false;
+	ListCell   *lc;
+
+	if (!enable_runtime_partition_pruning ||
+		rel->part_scheme == NULL || rel->nparts <= 0 ||
+		!partprune_needs_runtime((Node *) prunequal))
+		return NULL;
+
+	pruning_steps = gen_partprune_steps(rel, prunequal, &contradictory);
+	if (contradictory || pruning_steps == NIL)
+		return NULL;
+
+	/*
+	 * The steps are shipped to the datanodes with the plan, and the
+	 * comparison functions are identified by OID, so keep to built-in ones.
+	 */
+	foreach(lc, pruning_steps)
+	{
+		PartitionPruneStepOp *opstep = (PartitionPruneStepOp *) lfirst(lc);
+		ListCell   *lc2;
+
+		if (!IsA(opstep, PartitionPruneStepOp))
+			continue;
+
+		foreach(lc2, opstep->cmpfns)
+		{
+			if (lfirst_oid(lc2) >= FirstNormalObjectId)
+				return NULL;
+		}
+	}
+
+	foreach(lc, subpaths)
+	{
+		Path	   *subpath = (Path *) lfirst(lc);
+		int			partidx = partition_index_of_rel(root, rel, subpath->parent);
+
+		if (partidx >= 0)
+			doprune = true;
+		subplan_parts = lappend_int(subplan_parts, partidx);
+	}
+
+	if (!doprune)
+		return NULL;
+
+	pinfo = makeNode(PartitionPruneInfo);
+	pinfo->rtindex = rel->relid;
+	pinfo->interval = false;
+	pinfo->prune_quals = NIL;
+	pinfo->pruning_steps = pruning_steps;
+	pinfo->subplan_parts = subplan_parts;
+	pinfo->execparamids = NULL;
+	(void) pull_exec_paramids_walker((Node *) prunequal, &pinfo->execparamids);
+
+	return pinfo;
+}
+
+/*
+ * make_interval_pruneinfo
+ *		Build the information to prune at run time the scans of the
+ *		partitions of the interval partitioned table 'rel', partitioned on
+ *		column 'partkey', see create_scan_plan.  Each plan in 'subplans' is a
+ *		copy of the same scan, over partition childidx.
+ *
+ * Only the quals RelationGetPartitionsByQuals can use, once the expressions
+ * compared to the partition key are replaced by their values, are kept.
+ */
+PartitionPruneInfo *
+make_interval_pruneinfo(RelOptInfo *rel, AttrNumber partkey,
+						List *subplans, List *prunequal)
+{
+	PartitionPruneInfo *pinfo;
+	List	   *quals = NIL;
+	List	   *subplan_parts = NIL;
+	ListCell   *lc;
+
+	if (!enable_runtime_partition_pruning)
+		return NULL;
+
+	foreach(lc, prunequal)
+	{
+		Node	   *qual = (Node *) lfirst(lc);
+
+		if (partprune_needs_runtime(qual) &&
+			interval_prune_qual_ok(qual, rel->relid, partkey))
+			quals = lappend(quals, qual);
+	}
+
+	if (quals == NIL)
+		return NULL;
+
+	foreach(lc, subplans)
+	{
+		Scan	   *scan = (Scan *) lfirst(lc);
+
+		subplan_parts = lappend_int(subplan_parts,
+									scan->ispartchild ? scan->childidx : -1);
+	}
+
+	pinfo = makeNode(PartitionPruneInfo);
+	pinfo->rtindex = rel->relid;
+	pinfo->interval = true;
+	pinfo->prune_quals = quals;
+	pinfo->pruning_steps = NIL;
+	pinfo->subplan_parts = subplan_parts;
+	pinfo->execparamids = NULL;
+	(void) pull_exec_paramids_walker((Node *) quals, &pinfo->execparamids);
+
+	return pinfo;
+}
+
+/*
+ * Can the clause prune partitions at run time that it could not at plan
+ * time?  Only if it involves Params or functions the planner can't evaluate.
+ */
+static bool
+partprune_needs_runtime(Node *clause)
+{
+	return contain_params_walker(clause, NULL) ||
+		contain_mutable_functions(clause);
+}
+
+static bool
+contain_params_walker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Param))
+		return true;
+	return expression_tree_walker(node, contain_params_walker, context);
+}
+
+static bool
+pull_exec_paramids_walker(Node *node, Bitmapset **context)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Param))
+	{
+		Param	   *param = (Param *) node;
+
+		if (param->paramkind == PARAM_EXEC)
+			*context = bms_add_member(*context, param->paramid);
+		return false;
+	}
+	return expression_tree_walker(node, pull_exec_paramids_walker,
+								  (void *) context);
+}
+
+/*
+ * Index in rel->part_rels of the partition of 'rel' that 'childrel' is, or
+ * is a partition of, or -1.  The partitions of a sub-partitioned partition
+ * are scanned by the subplans of the Append of the topmost table.
+ */
+static int
+partition_index_of_rel(PlannerInfo *root, RelOptInfo *rel, RelOptInfo *childrel)
+{
+	while (childrel->reloptkind == RELOPT_OTHER_MEMBER_REL)
+	{
+		AppendRelInfo *appinfo = find_childrel_appendrelinfo(root, childrel);
+
+		if (appinfo->parent_relid == rel->relid)
+		{
+			int			i;
+
+			for (i = 0; i < rel->nparts; i++)
+			{
+				if (rel->part_rels[i]->relid == childrel->relid)
+					return i;
+			}
+			return -1;
+		}
+
+		childrel = find_base_rel(root, appinfo->parent_relid);
+	}
+
+	return -1;
+}
+
+/*
+ * Is the qual made of comparisons of the interval partition key to Var-free
+ * expressions of the types pruning_opexpr and pruning_scalar_array_opexpr
+ * handle, combined with AND and OR?
+ */
+static bool
+interval_prune_qual_ok(Node *qual, Index varno, AttrNumber partkey)
+{
+	List	   *args;
+	Node	   *leftop;
+	Node	   *rightop;
+	Node	   *other;
+	Oid			othertype;
+
+	if (IsA(qual, BoolExpr))
+	{
+		BoolExpr   *boolexpr = (BoolExpr *) qual;
+		ListCell   *lc;
+
+		if (boolexpr->boolop == NOT_EXPR)
+			return false;
+
+		foreach(lc, boolexpr->args)
+		{
+			if (!interval_prune_qual_ok((Node *) lfirst(lc), varno, partkey))
+				return false;
+		}
+		return true;
+	}
+
+	if (IsA(qual, OpExpr))
+		args = ((OpExpr *) qual)->args;
+	else if (IsA(qual, ScalarArrayOpExpr))
+		args = ((ScalarArrayOpExpr *) qual)->args;
+	else
+		return false;
+
+	if (list_length(args) != 2)
+		return false;
+
+	leftop = (Node *) linitial(args);
+	rightop = (Node *) lsecond(args);
+	if (IsA(leftop, Var))
+		other = rightop;
+	else if (IsA(rightop, Var) && IsA(qual, OpExpr))
+	{
+		other = leftop;
+		leftop = rightop;
+	}
+	else
+		return false;
+
+	if (((Var *) leftop)->varno != varno ||
+		((Var *) leftop)->varattno != partkey ||
+		((Var *) leftop)->varlevelsup != 0)
+		return false;
+
+	if (contain_var_clause(other) ||
+		contain_volatile_functions(other) ||
+		contain_subplans(other))
+		return false;
+
+	othertype = exprType(other);
+	if (IsA(qual, OpExpr))
+		return othertype == INT2OID || othertype == INT4OID ||
+			othertype == INT8OID || othertype == TIMESTAMPOID;
+	else
+		return othertype == INT2ARRAYOID || othertype == INT4ARRAYOID ||
+			othertype == INT8ARRAYOID || othertype == TIMESTAMPARRAYOID;
+}
+#endif
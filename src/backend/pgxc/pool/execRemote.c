@@ -66,6 +66,7 @@
 #include "executor/nodeModifyTable.h"
 #include "nodes/print.h"
 #include "optimizer/pathnode.h"
+#include "executor/runtimefilter.h"
 #include "pgxc/squeue.h"
 #include "postmaster/postmaster.h"
 #include "utils/syscache.h"
@@ -293,6 +294,7 @@ InitResponseCombiner(ResponseCombiner *combiner, int node_count,
     combiner->errorMessage = NULL;
     combiner->errorDetail = NULL;
     combiner->errorHint = NULL;
+    combiner->errorContext = NULL;
     combiner->tuple_desc = NULL;
     combiner->probing_primary = false;
     combiner->returning_node = InvalidOid;
@@ -784,6 +786,7 @@ HandleError(ResponseCombiner *combiner, char *msg_body, size_t len, PGXCNodeHand
     char *message = NULL;
     char *detail = NULL;
     char *hint = NULL;
+    char *context = NULL;
     int   offset = 0;
 
     /*
@@ -810,13 +813,16 @@ HandleError(ResponseCombiner *combiner, char *msg_body, size_t len, PGXCNodeHand
                 hint = str;
                 break;
 
+            case 'W':    /* where */
+                context = str;
+                break;
+
             /* Fields not yet in use */
             case 'S':    /* severity */
             case 'R':    /* routine */
             case 'P':    /* position string */
             case 'p':    /* position int */
             case 'q':    /* int query */
-            case 'W':    /* where */
             case 'F':    /* file */
             case 'L':    /* line */
             default:
@@ -866,6 +872,8 @@ HandleError(ResponseCombiner *combiner, char *msg_body, size_t len, PGXCNodeHand
             combiner->errorDetail = pstrdup(detail);
         if (hint)
             combiner->errorHint = pstrdup(hint);
+        if (context)
+            combiner->errorContext = pstrdup(context);
         MemoryContextSwitchTo(oldcontext);
     }
 
@@ -1112,6 +1120,11 @@ CloseCombiner(ResponseCombiner *combiner)
         pfree(combiner->errorHint);
         combiner->errorHint = NULL;
     }
+    if (combiner->errorContext)
+    {
+        pfree(combiner->errorContext);
+        combiner->errorContext = NULL;
+    }
     if (combiner->cursor_connections)
     {
         pfree(combiner->cursor_connections);
@@ -9985,6 +9998,7 @@ determine_param_types(Plan *plan,  struct find_params_context *context)
         case T_Agg:
         case T_Material:
         case T_Sort:
+        case T_IncrementalSort:
         case T_Unique:
         case T_SetOp:
         case T_Group:
@@ -11065,7 +11079,10 @@ primary_mode_phase_two:
 
                 /* rebind */
                 pgxc_node_send_bind(conn, combiner->cursor, combiner->cursor,
-									paramlen, paramdata, epqctxlen, epqctxdata, shardmap);
+									paramlen, paramdata, epqctxlen, epqctxdata, shardmap,
+									node->runtime_filter);
+                if (node->runtime_filter)
+                    RuntimeFilterCount(RUNTIME_FILTER_STAT_SENT, 1);
                 if (enable_statistic)
                 {
                     elog(LOG, "Bind Message:pid:%d,remote_pid:%d,remote_ip:%s,remote_port:%d,fd:%d,cursor:%s",
@@ -11154,7 +11171,10 @@ primary_mode_phase_two:
 
                 /* bind */
 				pgxc_node_send_bind(conn, cursor, cursor, paramlen, paramdata,
-				                    epqctxlen, epqctxdata, shardmap);
+				                    epqctxlen, epqctxdata, shardmap,
+				                    node->runtime_filter);
+				if (node->runtime_filter)
+					RuntimeFilterCount(RUNTIME_FILTER_STAT_SENT, 1);
 
                 if (enable_statistic)
                 {
@@ -11329,6 +11349,38 @@ ExecReScanRemoteSubplan(RemoteSubplanState *node)
 }
 
 #ifdef __OPENTENBASE__
+/*
+ * ExecRemoteSubplanSetRuntimeFilter
+ *
+ * Set the bloom filter of the parent hash join, to be sent down with the
+ * next Bind so that the producers skip rows the join would discard.  A NULL
+ * filter stops sending one.  Has no effect on a subplan already bound.
+ */
+void
+ExecRemoteSubplanSetRuntimeFilter(RemoteSubplanState *node,
+                                  RuntimeFilter *filter)
+{
+    EState       *estate = node->combiner.ss.ps.state;
+    MemoryContext oldcontext;
+
+    if (node->runtime_filter)
+    {
+        pfree(node->runtime_filter->data);
+        pfree(node->runtime_filter);
+        node->runtime_filter = NULL;
+    }
+
+    if (filter == NULL)
+        return;
+
+    oldcontext = MemoryContextSwitchTo(estate->es_query_cxt);
+    node->runtime_filter = makeStringInfo();
+    RuntimeFilterSerialize(filter, node->runtime_filter);
+    MemoryContextSwitchTo(oldcontext);
+
+    RuntimeFilterCount(RUNTIME_FILTER_STAT_BUILT, 1);
+}
+
 /*
  * ExecShutdownRemoteSubplan
  * 
@@ -2245,7 +2245,8 @@ pgxc_node_send_plan(PGXCNodeHandle * handle, const char *statement,
 int
 pgxc_node_send_bind(PGXCNodeHandle * handle, const char *portal,
 					const char *statement, int paramlen, const char *params,
-					int epqctxlen, const char *epqctx, StringInfo shardmap)
+					int epqctxlen, const char *epqctx, StringInfo shardmap,
+					StringInfo rfilter)
 {
     int            pnameLen;
     int            stmtLen;
@@ -2255,6 +2256,7 @@ pgxc_node_send_bind(PGXCNodeHandle * handle, const char *portal,
 	int         epqCtxLen;
     int            msgLen;
 	int         shardMapLen;
+	int         rfilterLen;
 
     /* Invalid connection state, return error */
     if (handle->state != DN_CONNECTION_STATE_IDLE)
@@ -2274,9 +2276,11 @@ pgxc_node_send_bind(PGXCNodeHandle * handle, const char *portal,
 	epqCtxLen = epqctxlen ? epqctxlen : 2;
 	/* size of shard map information */
 	shardMapLen = shardmap ? shardmap->len + 1 : 1;
-	/* size + pnameLen + stmtLen + parameters + epqctx + shardmap */
+	/* size of runtime filter, 2 if none */
+	rfilterLen = rfilter ? rfilter->len : 2;
+	/* size + pnameLen + stmtLen + parameters + epqctx + shardmap + rfilter */
 	msgLen = 4 + pnameLen + stmtLen + paramCodeLen + paramValueLen +
-	         paramOutLen + epqCtxLen + shardMapLen;
+	         paramOutLen + epqCtxLen + shardMapLen + rfilterLen;
 
     /* msgType + msgLen */
     if (ensure_out_buffer_capacity(handle->outEnd + 1 + msgLen, handle) != 0)
@@ -2344,6 +2348,18 @@ pgxc_node_send_bind(PGXCNodeHandle * handle, const char *portal,
 	else
 		handle->outBuffer[handle->outEnd++] = '\0';
 
+	/* runtime filter of the parent hash join, zero keys if none */
+	if (rfilter)
+	{
+		memcpy(handle->outBuffer + handle->outEnd, rfilter->data, rfilterLen);
+		handle->outEnd += rfilterLen;
+	}
+	else
+	{
+		handle->outBuffer[handle->outEnd++] = 0;
+		handle->outBuffer[handle->outEnd++] = 0;
+	}
+
     handle->in_extended_query = true;
      return 0;
 }
@@ -2620,6 +2636,54 @@ pgxc_node_send_apply(PGXCNodeHandle * handle, char * buf, int len, bool ignore_p
     handle->in_extended_query = false;
      return pgxc_node_flush(handle);
 }
+
+/*
+ * Send a batch of logical apply messages down to the Datanode, applied in
+ * one go and acknowledged by a single ApplyDone.  buf holds nchanges
+ * messages, each preceded by its length.
+ */
+int
+pgxc_node_send_apply_batch(PGXCNodeHandle * handle, char * buf, int len,
+                           int nchanges, bool ignore_pk_conflict)
+{
+    int    msgLen = 0;
+    uint32 n32;
+
+    /* size + ignore_pk_conflict + 'B' + nchanges + len */
+    msgLen = 4 + 1 + 1 + 4 + len;
+
+    /* msgType + msgLen */
+    if (ensure_out_buffer_capacity(handle->outEnd + 1 + msgLen, handle) != 0)
+    {
+        add_error_message(handle, "out of memory");
+        return EOF;
+    }
+
+    handle->outBuffer[handle->outEnd++] = 'a';        /* logical apply */
+
+    msgLen = htonl(msgLen);
+    memcpy(handle->outBuffer + handle->outEnd, &msgLen, 4);
+    handle->outEnd += 4;
+
+    if (ignore_pk_conflict)
+        handle->outBuffer[handle->outEnd++] = 'Y';
+    else
+        handle->outBuffer[handle->outEnd++] = 'N';
+
+    handle->outBuffer[handle->outEnd++] = 'B';        /* batch */
+
+    n32 = htonl((uint32) nchanges);
+    memcpy(handle->outBuffer + handle->outEnd, &n32, 4);
+    handle->outEnd += 4;
+
+    memcpy(handle->outBuffer + handle->outEnd, buf, len);
+    handle->outEnd += len;
+
+    PGXCNodeSetConnectionState(handle, DN_CONNECTION_STATE_QUERY);
+
+    handle->in_extended_query = false;
+    return pgxc_node_flush(handle);
+}
 #endif
 
 /*
@@ -2636,7 +2700,7 @@ pgxc_node_send_query_extended(PGXCNodeHandle *handle, const char *query,
     if (query)
         if (pgxc_node_send_parse(handle, statement, query, num_params, param_types))
             return EOF;
-	if (pgxc_node_send_bind(handle, portal, statement, paramlen, params, 0, NULL, NULL))
+	if (pgxc_node_send_bind(handle, portal, statement, paramlen, params, 0, NULL, NULL, NULL))
         return EOF;
     if (send_describe)
         if (pgxc_node_send_describe(handle, false, portal))
@@ -381,7 +381,8 @@ int64 vacuum_shard_internal(Relation rel, Bitmapset *to_vacuum, Snapshot vacuum_
         }
     }    
 
-    scan = heap_beginscan(rel, vacuum_snapshot, 0, NULL);
+    /* read only the extents of the shards being vacuumed */
+    scan = heap_beginscan_shards(rel, vacuum_snapshot, 0, NULL, to_vacuum);
     tup = heap_getnext(scan,ForwardScanDirection);
     
     while(HeapTupleIsValid(tup))
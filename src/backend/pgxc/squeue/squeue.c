@@ -45,6 +45,7 @@
 #include <pthread.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include "port/atomics.h"
 #include "storage/spin.h"
 #include "storage/s_lock.h"
 #include "miscadmin.h"
@@ -161,6 +162,7 @@ typedef struct
 #ifdef __OPENTENBASE__
     bool        send_fd;        /* true if send fd to producer */
     bool        cs_done;
+    dsm_handle  cs_rfilter;     /* bloom filter of the consumer's hash join */
 #endif
 #ifdef SQUEUE_STAT
     long         stat_writes;
@@ -933,6 +935,7 @@ tryagain:
 #ifdef __OPENTENBASE__
             cstate->send_fd = false;
             cstate->cs_done = false;
+            cstate->cs_rfilter = DSM_HANDLE_INVALID;
             InitSharedLatch(&sqsync->sqs_consumer_sync[i].cs_latch);
 #endif
             heapPtr += qsize;
@@ -9116,6 +9119,37 @@ GetConsumerIdx(SharedQueue sq, int nodeid)
     return sq->nodeMap[nodeid];
 }
 
+/*
+ * Publish the bloom filter of the consumer's hash join, exported to a dynamic
+ * shared memory segment, for the producer to apply to the rows it sends to
+ * this consumer.
+ */
+void
+SharedQueueSetRuntimeFilter(SharedQueue sq, int consumerIdx, dsm_handle handle)
+{
+    Assert(consumerIdx >= 0 && consumerIdx < sq->sq_nconsumers);
+
+    /* the segment is filled in before the handle becomes visible */
+    pg_write_barrier();
+    sq->sq_consumers[consumerIdx].cs_rfilter = handle;
+}
+
+/*
+ * Get the handle of the bloom filter published by a consumer, or
+ * DSM_HANDLE_INVALID if it has not published one (yet).
+ */
+dsm_handle
+SharedQueueGetRuntimeFilter(SharedQueue sq, int consumerIdx)
+{
+    dsm_handle  handle;
+
+    Assert(consumerIdx >= 0 && consumerIdx < sq->sq_nconsumers);
+
+    handle = sq->sq_consumers[consumerIdx].cs_rfilter;
+    pg_read_barrier();
+    return handle;
+}
+
 bool
 IsSqueueProducer(void)
 {
@@ -22,8 +22,10 @@
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include "access/htup_details.h"
 #include "lib/stringinfo.h"
 #include "libpq/pqsignal.h"
 #include "miscadmin.h"
@@ -51,6 +53,9 @@
 #include "storage/procarray.h"
 #include "pgxc/squeue.h"
 #include "pgxc/shardmap.h"
+#include "funcapi.h"
+#include "utils/builtins.h"
+#include "port/atomics.h"
 
 #define        BYTES_PER_KB            1024
 #define        AUDIT_BITMAP_WORD        (WORDNUM(MaxBackends) + 1)
@@ -58,6 +63,8 @@
 
 #define        AUDIT_SLEEP_MICROSEC    100000L
 #define        AUDIT_LATCH_MICROSEC    10000000L
+#define        AUDIT_WRITEV_MAX_IOV    512
+#define        AUDIT_LOG_TYPE_NUM      3
 
 // #define     Use_Audit_Assert         0
 
@@ -68,6 +75,7 @@
 #define        AuditLog_005_For_ThreadWorker        0
 #define        AuditLog_006_For_Elog                0
 #define        AuditLog_007_For_ShardStatistics    0
+#define        AuditLog_008_For_Statistics         0
 
 #ifdef Use_Audit_Assert
     #ifdef Trap
@@ -87,13 +95,25 @@
     #endif
 #endif
 
+/*
+ * Single producer single consumer ring, no lock is needed:
+ * q_tail is only advanced by the producer after the content is written,
+ * q_head is only advanced by the consumer after the content is read.
+ */
 typedef struct AuditLogQueue
 {
 	pid_t					q_pid;
 	int						q_size;
-	slock_t					q_lock;
-	volatile int			q_head;
-	volatile int			q_tail;
+	pg_atomic_uint32		q_head;
+	pg_atomic_uint32		q_tail;
+
+	/*
+	 * statistics, only updated by the producer, but read by any backend
+	 * through pg_stat_get_audit_logger
+	 */
+	pg_atomic_uint64		q_push_records;	/* records pushed */
+	pg_atomic_uint64		q_push_bytes;	/* bytes pushed */
+	pg_atomic_uint64		q_full_waits;	/* times producer waited for a full queue */
 	char					q_area[FLEXIBLE_ARRAY_MEMBER];
 } AlogQueue;
 
@@ -106,8 +126,12 @@ typedef struct AuditLogQueueArray
 
 typedef struct AuditLogQueueCache
 {
-	/* local ThreadSema for CommonLogWriter, FGALogWriter and TraceLogWriter. */
-	ThreadSema				q_sema;
+	/*
+	 * local ThreadSema for CommonLogWriter, FGALogWriter and TraceLogWriter,
+	 * one for each writer shard.
+	 */
+	ThreadSema				q_sema[AUDIT_MAX_COMMON_WRITER];
+	int						q_writers;
 	int						q_count;
 	AlogQueue			  * q_cache[FLEXIBLE_ARRAY_MEMBER];
 } AlogQueueCache;
@@ -123,6 +147,27 @@ static AlogQueueArray	  * AuditFGALogQueueArray = NULL;
 /* store trace audit logs, each elem for a backend */
 static AlogQueueArray	  * AuditTraceLogQueueArray = NULL;
 
+/*
+ * shared memory statistics of writers, indexed by alog_destination_index()
+ */
+typedef struct AuditLogWriterStats
+{
+	pg_atomic_uint64		w_write_calls[AUDIT_LOG_TYPE_NUM];	/* writev calls */
+	pg_atomic_uint64		w_write_records[AUDIT_LOG_TYPE_NUM];	/* records written */
+	pg_atomic_uint64		w_write_bytes[AUDIT_LOG_TYPE_NUM];	/* bytes written */
+} AlogWriterStats;
+
+static AlogWriterStats	  * AuditWriterStats = NULL;
+
+/*
+ * writer thread argument, destination and shard of log file
+ */
+typedef struct AuditLogWriterArg
+{
+	int						destination;
+	int						shard;
+} AlogWriterArg;
+
 /*
  * shared memory bitmap to notify consumers to read audit log from AlogQueueArray above
  * each element for one consumer
@@ -173,6 +218,8 @@ int							AuditLog_file_mode = S_IRUSR | S_IWUSR;
 
 /* max number of worker thead to read audit log */
 int							AuditLog_max_worker_number = 16;
+/* writer number of common audit log, each writer owns a file shard */
+int							AuditLog_common_log_writer_number = 1;
 /* size of AlogQueue->q_area for each backend to store common audit log, KB */
 int							AuditLog_common_log_queue_size_kb = 64;
 /* size of AlogQueue->q_area for each backend to store fga audit log, KB */
@@ -197,14 +244,18 @@ bool                        enable_auditlogger_warning = false;
  */
 static pg_time_t			audit_next_rotation_time = 0;
 static bool					audit_rotation_disabled = false;
-static FILE				  * audit_comm_log_file = NULL;
+static FILE				  * audit_comm_log_file[AUDIT_MAX_COMMON_WRITER] = { NULL };
 static FILE				  * audit_fga_log_file = NULL;
 static FILE				  * audit_trace_log_file = NULL;
-static slock_t				audit_comm_log_file_lock;
+static slock_t				audit_comm_log_file_lock[AUDIT_MAX_COMMON_WRITER];
 static slock_t				audit_fga_log_file_lock;
 static slock_t				audit_trace_log_file_lock;
+/* writers in the middle of a writev to the file, protected by the file lock */
+static int					audit_comm_log_file_busy[AUDIT_MAX_COMMON_WRITER] = { 0 };
+static int					audit_fga_log_file_busy = 0;
+static int					audit_trace_log_file_busy = 0;
 NON_EXEC_STATIC pg_time_t	audit_first_log_file_time = 0;
-static char				  * audit_last_comm_log_file_name = NULL;
+static char				  * audit_last_comm_log_file_name[AUDIT_MAX_COMMON_WRITER] = { NULL };
 static char				  * audit_last_fga_log_file_name = NULL;
 static char				  * audit_last_trace_log_file_name = NULL;
 static char				  * audit_log_directory = NULL;
@@ -270,12 +321,15 @@ static void 	audit_shared_consumer_bitmap_set_value(int consumer_id, int value);
 #endif
 
 #ifdef AuditLog_003_For_LogFile
-static int		audit_write_log_file(const char *buffer, int count, int destination);
+static int		audit_write_log_file(int fd, struct iovec *iov, int iovcnt);
+static void		audit_switch_log_file(FILE **file, FILE *fh, volatile slock_t *file_lock,
+									  volatile int *file_busy);
 static FILE *	audit_open_log_file(const char *filename, const char *mode, bool allow_errors);
 static void		audit_open_fga_log_file(void);
 static void		audit_open_trace_log_file(void);
 static void		audit_rotate_log_file(bool time_based_rotation, int size_rotation_for);
 static char *	audit_log_file_getname(pg_time_t timestamp, const char *suffix);
+static char *	audit_comm_log_file_getname(pg_time_t timestamp, int shard);
 static char *	trace_log_file_getname(pg_time_t timestamp, const char *suffix);
 static void		audit_set_next_rotation_time(void);
 #endif
@@ -283,6 +337,7 @@ static void		audit_set_next_rotation_time(void);
 #ifdef AuditLog_004_For_QueueReadWrite
 static void     alog_just_caller(void * var);
 static void     alog_queue_init(AlogQueue * queue, int queue_size_kb);
+static void     alog_queue_count(pg_atomic_uint64 * counter, uint64 n);
 static char *     alog_queue_offset_to(AlogQueue * queue, int offset);
 static bool     alog_queue_is_full(int q_size, int q_head, int q_tail);
 static bool     alog_queue_is_empty(int q_size, int q_head, int q_tail);
@@ -295,7 +350,8 @@ static bool     alog_queue_push2(AlogQueue * queue, char * buff1, int len1, char
 static bool     alog_queue_pushn(AlogQueue * queue, char * buff[], int len[], int n);
 static int         alog_queue_get_str_len(AlogQueue * queue, int offset);
 static bool     alog_queue_pop_to_queue(AlogQueue * from, AlogQueue * to);
-static bool     alog_queue_pop_to_file(AlogQueue * from, int destination);
+static bool     alog_queue_pop_to_file(AlogQueue * from, int destination, int shard);
+static int      alog_destination_index(int destination);
 #endif
 
 #ifdef AuditLog_005_For_ThreadWorker
@@ -305,15 +361,15 @@ static AlogQueue * 		alog_get_shared_trace_queue(int idx);
 static AlogQueue *		alog_get_local_common_cache(int consumer_id);
 static AlogQueue *		alog_get_local_fga_cache(int consumer_id);
 static AlogQueue *		alog_get_local_trace_cache(int consumer_id);
-static AlogQueueCache * alog_make_local_cache(int cache_number, int queue_size_kb);
+static AlogQueueCache * alog_make_local_cache(int cache_number, int queue_size_kb, int writer_number);
 static ThreadSema *        alog_make_consumer_semas(int consumer_count);
 static void             alog_consumer_wakeup(int consumer_id);
 static void             alog_consumer_sleep(int consumer_id);
 static void *            alog_consumer_main(void * arg);
-static void             alog_writer_wakeup(int writer_destination);
-static void             alog_writer_sleep(int writer_destination);
+static void             alog_writer_wakeup(int writer_destination, int consumer_id);
+static void             alog_writer_sleep(int writer_destination, int shard);
 static void *            alog_writer_main(void * arg);
-static void                alog_start_writer(int writer_destination);
+static void                alog_start_writer(int writer_destination, int shard);
 static void                alog_start_consumer(int consumer_id);
 static void                alog_start_all_worker(void);
 #endif
@@ -471,6 +527,8 @@ AuditLoggerMain(int argc, char *argv[])
 static void
 audit_logger_MainLoop(void)
 {
+	int i = 0;
+
 	/*
 	 * Create log directory if not present; ignore errors
 	 */
@@ -484,8 +542,12 @@ audit_logger_MainLoop(void)
 	 * passing a whole file path in the EXEC_BACKEND case.
 	 */
 	audit_first_log_file_time = time(NULL);
-	audit_last_comm_log_file_name = audit_log_file_getname(audit_first_log_file_time, NULL);
-	audit_comm_log_file = audit_open_log_file(audit_last_comm_log_file_name, "a", false);
+	for (i = 0; i < AuditLog_common_log_writer_number; i++)
+	{
+		audit_last_comm_log_file_name[i] = audit_comm_log_file_getname(audit_first_log_file_time, i);
+		audit_comm_log_file[i] = audit_open_log_file(audit_last_comm_log_file_name[i], "a", false);
+		SpinLockInit(&(audit_comm_log_file_lock[i]));
+	}
 	audit_open_fga_log_file();
 	audit_open_trace_log_file();
 
@@ -495,7 +557,6 @@ audit_logger_MainLoop(void)
 	audit_curr_log_file_name = pstrdup(AuditLog_filename);
 	audit_curr_log_rotation_age = AuditLog_RotationAge;
 
-	SpinLockInit(&(audit_comm_log_file_lock));
 	SpinLockInit(&(audit_fga_log_file_lock));
 	SpinLockInit(&(audit_trace_log_file_lock));
 
@@ -771,11 +832,16 @@ static void audit_process_rotate(void)
 
 	if (!audit_rotation_requested && AuditLog_RotationSize > 0 && !audit_rotation_disabled)
 	{
-		/* Do a rotation if file is too big */
-		if (ftell(audit_comm_log_file) >= AuditLog_RotationSize * 1024L)
+		int i = 0;
+
+		/* Do a rotation if file is too big, all shards of common log rotate together */
+		for (i = 0; i < AuditLog_common_log_writer_number; i++)
 		{
-			audit_rotation_requested = true;
-			size_rotation_for |= AUDIT_COMMON_LOG;
+			if (ftell(audit_comm_log_file[i]) >= AuditLog_RotationSize * 1024L)
+			{
+				audit_rotation_requested = true;
+				size_rotation_for |= AUDIT_COMMON_LOG;
+			}
 		}
 
 		if (audit_fga_log_file != NULL &&
@@ -898,7 +964,7 @@ static void	audit_process_wakeup(bool timeout)
  * 02. AlogQueue as follows
  *
  *                                             | q_area -> char[AuditLog_common_log_queue_size_kb * BYTES_PER_KB] |
- * | q_pid | q_size | q_lock | q_head | q_tail |                              OR                                  |
+ * | q_pid | q_size | q_head | q_tail | stats  |                              OR                                  |
  *                                             | q_area ->  char[AuditLog_fga_log_queue_size_kb * BYTES_PER_KB]   |
  *                                             |                              OR                                  |
  *                                             | q_area ->  char[Maintain_trace_log_queue_size_kb * BYTES_PER_KB] |
@@ -933,6 +999,9 @@ static Size audit_shared_queue_array_header_size(void)
 	alogQueueArrayHeaderSize = add_size(alogQueueArrayHeaderSize,
 										AUDIT_BITMAP_SIZE);
 
+	/* keep the atomics and counters of each AlogQueue aligned */
+	alogQueueArrayHeaderSize = MAXALIGN(alogQueueArrayHeaderSize);
+
     return alogQueueArrayHeaderSize;
 }
 
@@ -1064,6 +1133,9 @@ Size AuditLoggerShmemSize(void)
 	size = add_size(size, alogTraceQueueSize);
 	size = add_size(size, alogConsumerBmpSize);
 
+	/* for writer statistics */
+	size = add_size(size, sizeof(AlogWriterStats));
+
     return size;
 }
 
@@ -1292,6 +1364,21 @@ void AuditLoggerShmemInit(void)
 	{
 		MemSet(AuditConsumerNotifyBitmap, 0, alogConsumerBmpSize);
 	}
+
+	found = false;
+
+	AuditWriterStats = ShmemInitStruct("Audit Writer Stats",
+									   sizeof(AlogWriterStats),
+									   &found);
+	if (!found)
+	{
+		for (i = 0; i < AUDIT_LOG_TYPE_NUM; i++)
+		{
+			pg_atomic_init_u64(&(AuditWriterStats->w_write_calls[i]), 0);
+			pg_atomic_init_u64(&(AuditWriterStats->w_write_records[i]), 0);
+			pg_atomic_init_u64(&(AuditWriterStats->w_write_bytes[i]), 0);
+		}
+	}
 }
 
 #endif
@@ -1339,39 +1426,77 @@ audit_assign_log_dir(void)
 }
 
 /*
- * Write text to the currently open logfile
+ * Write a batch of text to the file descriptor of a logfile with one writev.
+ * The caller has marked the logfile busy, so it is not closed meanwhile.
  *
- * This is exported so that elog.c can call it when am_auditlogger is true.
- * This allows the auditlogger process to record elog messages of its own,
- * even though its stderr does not point at the syslog pipe.
+ * Nothing is written through the stdio buffer of the logfile, so the
+ * content goes straight to the file descriptor.
  */
 static int
-audit_write_log_file(const char *buffer, int count, int destination)
+audit_write_log_file(int fd, struct iovec *iov, int iovcnt)
 {
-    int            rc = 0;
+	ssize_t		rc = 0;
 
-	if (destination == AUDIT_FGA_LOG)
+	while (iovcnt > 0)
 	{
-		rc = fwrite(buffer, 1, count, audit_fga_log_file);
-	}
-	else if (destination == MAINTAIN_TRACE_LOG)
-	{
-		rc = fwrite(buffer, 1, count, audit_trace_log_file);
+		rc = writev(fd, iov, iovcnt);
+		if (rc < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			/* can't use ereport here because of possible recursion */
+			write_stderr("could not write to audit log file: %s\n", strerror(errno));
+			return -1;
+		}
+
+		/* skip what is written, and retry the rest of a short write */
+		while (iovcnt > 0 && rc >= (ssize_t) iov->iov_len)
+		{
+			rc -= iov->iov_len;
+			iov++;
+			iovcnt--;
+		}
+		if (iovcnt > 0)
+		{
+			iov->iov_base = (char *) iov->iov_base + rc;
+			iov->iov_len -= rc;
+		}
 	}
-	else
+
+	return 0;
+}
+
+/*
+ * Replace a logfile by a newly opened one during rotation.
+ *
+ * The writer only holds the file lock to pick up the file descriptor and
+ * mark the file busy, the writev itself runs without it. So the old file
+ * is only closed once the writer is done with it.
+ */
+static void
+audit_switch_log_file(FILE **file, FILE *fh, volatile slock_t *file_lock,
+					  volatile int *file_busy)
+{
+	FILE	   *old = NULL;
+	bool		busy = false;
+
+	SpinLockAcquire(file_lock);
+	old = *file;
+	*file = fh;
+	busy = (*file_busy > 0);
+	SpinLockRelease(file_lock);
+
+	while (busy)
 	{
-		Assert(destination == AUDIT_COMMON_LOG);
-		rc = fwrite(buffer, 1, count, audit_comm_log_file);
-	}
+		pg_usleep(AUDIT_SLEEP_MICROSEC);
 
-    /* can't use ereport here because of possible recursion */
-    if (rc != count)
-    {
-        write_stderr("could not write to audit log file: %s\n", strerror(errno));
-        return -1;
-    }
+		SpinLockAcquire(file_lock);
+		busy = (*file_busy > 0);
+		SpinLockRelease(file_lock);
+	}
 
-    return 0;
+	fclose(old);
 }
 
 static void
@@ -1463,6 +1588,7 @@ audit_rotate_log_file(bool time_based_rotation, int size_rotation_for)
 	char	   *tracefilename = NULL;
 	pg_time_t	fntime = 0;
 	FILE	   *fh = NULL;
+	int			shard = 0;
 
 	audit_rotation_requested = false;
 
@@ -1475,7 +1601,6 @@ audit_rotate_log_file(bool time_based_rotation, int size_rotation_for)
 		fntime = audit_next_rotation_time;
 	else
 		fntime = time(NULL);
-	filename = audit_log_file_getname(fntime, NULL);
 	if (audit_fga_log_file != NULL)
 		fgafilename = audit_log_file_getname(fntime, ".fga");
 	if (audit_trace_log_file != NULL)
@@ -1488,12 +1613,17 @@ audit_rotate_log_file(bool time_based_rotation, int size_rotation_for)
 	 * different from what we were previously logging into.
 	 *
 	 * Note: audit_last_comm_log_file_name should never be NULL here, but if it is, append.
+	 *
+	 * All shards of the common log are rotated together.
 	 */
-	if (time_based_rotation || (size_rotation_for & AUDIT_COMMON_LOG))
+	for (shard = 0; shard < AuditLog_common_log_writer_number &&
+		 (time_based_rotation || (size_rotation_for & AUDIT_COMMON_LOG)); shard++)
 	{
+		filename = audit_comm_log_file_getname(fntime, shard);
+
 		if (AuditLog_truncate_on_rotation && time_based_rotation &&
-			audit_last_comm_log_file_name != NULL &&
-			strcmp(filename, audit_last_comm_log_file_name) != 0)
+			audit_last_comm_log_file_name[shard] != NULL &&
+			strcmp(filename, audit_last_comm_log_file_name[shard]) != 0)
 			fh = audit_open_log_file(filename, "w", true);
 		else
 			fh = audit_open_log_file(filename, "a", true);
@@ -1522,15 +1652,14 @@ audit_rotate_log_file(bool time_based_rotation, int size_rotation_for)
 			return;
 		}
 
-		SpinLockAcquire(&(audit_comm_log_file_lock));
-		fclose(audit_comm_log_file);
-		audit_comm_log_file = fh;
-		SpinLockRelease(&(audit_comm_log_file_lock));
+		audit_switch_log_file(&(audit_comm_log_file[shard]), fh,
+							  &(audit_comm_log_file_lock[shard]),
+							  &(audit_comm_log_file_busy[shard]));
 
 		/* instead of pfree'ing filename, remember it for next time */
-		if (audit_last_comm_log_file_name != NULL)
-			pfree(audit_last_comm_log_file_name);
-		audit_last_comm_log_file_name = filename;
+		if (audit_last_comm_log_file_name[shard] != NULL)
+			pfree(audit_last_comm_log_file_name[shard]);
+		audit_last_comm_log_file_name[shard] = filename;
 		filename = NULL;
 	}
 
@@ -1569,10 +1698,9 @@ audit_rotate_log_file(bool time_based_rotation, int size_rotation_for)
 			return;
 		}
 
-		SpinLockAcquire(&(audit_fga_log_file_lock));
-		fclose(audit_fga_log_file);
-		audit_fga_log_file = fh;
-		SpinLockRelease(&(audit_fga_log_file_lock));
+		audit_switch_log_file(&audit_fga_log_file, fh,
+							  &audit_fga_log_file_lock,
+							  &audit_fga_log_file_busy);
 
 		/* instead of pfree'ing filename, remember it for next time */
 		if (audit_last_fga_log_file_name != NULL)
@@ -1623,10 +1751,9 @@ audit_rotate_log_file(bool time_based_rotation, int size_rotation_for)
 			return;
 		}
 
-		SpinLockAcquire(&(audit_trace_log_file_lock));
-		fclose(audit_trace_log_file);
-		audit_trace_log_file = fh;
-		SpinLockRelease(&(audit_trace_log_file_lock));
+		audit_switch_log_file(&audit_trace_log_file, fh,
+							  &audit_trace_log_file_lock,
+							  &audit_trace_log_file_busy);
 
 		/* instead of pfree'ing filename, remember it for next time */
 		if (audit_last_trace_log_file_name != NULL)
@@ -1680,6 +1807,24 @@ audit_log_file_getname(pg_time_t timestamp, const char *suffix)
     return filename;
 }
 
+/*
+ * construct common logfile name of a writer shard, shard 0 keeps the name
+ * without shard number.
+ *
+ * Result is palloc'd.
+ */
+static char *
+audit_comm_log_file_getname(pg_time_t timestamp, int shard)
+{
+	char		suffix[MAXPGPATH];
+
+	if (shard == 0)
+		return audit_log_file_getname(timestamp, NULL);
+
+	snprintf(suffix, MAXPGPATH, ".%d.log", shard);
+	return audit_log_file_getname(timestamp, suffix);
+}
+
 /*
  * construct logfile name using timestamp information.
  * acoording to audit_log_file_getname().
@@ -1768,12 +1913,23 @@ static void alog_queue_init(AlogQueue * queue, int queue_size_kb)
 {
     queue->q_pid = 0;
     queue->q_size = mul_size(queue_size_kb, BYTES_PER_KB);
-    SpinLockInit(&(queue->q_lock));
-    queue->q_head = 0;
-    queue->q_tail = 0;
+    pg_atomic_init_u32(&(queue->q_head), 0);
+    pg_atomic_init_u32(&(queue->q_tail), 0);
+    pg_atomic_init_u64(&(queue->q_push_records), 0);
+    pg_atomic_init_u64(&(queue->q_push_bytes), 0);
+    pg_atomic_init_u64(&(queue->q_full_waits), 0);
     MemSet(queue->q_area, 0, queue->q_size);
 }
 
+/*
+ * add to a statistics counter of queue, there is only one producer for
+ * each queue, so no locked add is needed
+ */
+static void alog_queue_count(pg_atomic_uint64 * counter, uint64 n)
+{
+    pg_atomic_write_u64(counter, pg_atomic_read_u64(counter) + n);
+}
+
 /*
  * Get a write pointer in queue
  */
@@ -1821,11 +1977,9 @@ static bool alog_queue_is_empty(int q_size, int q_head, int q_tail)
 
 static bool alog_queue_is_empty2(AlogQueue * queue)
 {
-	volatile int q_head = queue->q_head;
-	volatile int q_tail = queue->q_tail;
-	volatile int q_size = queue->q_size;
-
-    pg_memory_barrier();
+	int q_head = pg_atomic_read_u32(&(queue->q_head));
+	int q_tail = pg_atomic_read_u32(&(queue->q_tail));
+	int q_size = queue->q_size;
 
     return alog_queue_is_empty(q_size, q_head, q_tail);
 }
@@ -1906,9 +2060,9 @@ static bool alog_queue_push2(AlogQueue * queue, char * buff1, int len1, char * b
  */
 static bool alog_queue_pushn(AlogQueue * queue, char * buff[], int len[], int n)
 {
-	volatile int q_head = queue->q_head;
-	volatile int q_tail = queue->q_tail;
-	volatile int q_size = queue->q_size;
+	int q_head = pg_atomic_read_u32(&(queue->q_head));
+	int q_tail = pg_atomic_read_u32(&(queue->q_tail));
+	int q_size = queue->q_size;
 
 	int q_head_before = q_head;
 	int q_tail_before = q_tail;
@@ -1967,8 +2121,6 @@ static bool alog_queue_pushn(AlogQueue * queue, char * buff[], int len[], int n)
 
             char * p_start = NULL;
 
-            pg_memory_barrier();
-
             Assert(first_len > 0 && first_len < q_size);
             Assert(second_len > 0 && second_len < q_size);
 
@@ -1989,7 +2141,9 @@ static bool alog_queue_pushn(AlogQueue * queue, char * buff[], int len[], int n)
     q_used_after = alog_queue_used(q_size, q_head, q_tail);
     Assert(q_used_before + total_len == q_used_after);
 
-    queue->q_tail = q_tail;
+    /* content must be visible before the consumer sees the new tail */
+    pg_write_barrier();
+    pg_atomic_write_u32(&(queue->q_tail), q_tail);
 
     return true;
 }
@@ -2009,8 +2163,6 @@ static int alog_queue_get_str_len(AlogQueue * queue, int offset)
     char buff[sizeof(int)] = { '\0' };
     int len = 0;
 
-    pg_memory_barrier();
-
     Assert(offset >= 0 && offset < q_size);
 
     /* read len directly */
@@ -2027,8 +2179,6 @@ static int alog_queue_get_str_len(AlogQueue * queue, int offset)
 
         char * p_start = NULL;
 
-        pg_memory_barrier();
-
         Assert(first_len > 0 && first_len < q_size);
         Assert(second_len > 0 && second_len < sizeof(int));
 
@@ -2061,13 +2211,13 @@ static int alog_queue_get_str_len(AlogQueue * queue, int offset)
  */
 static bool alog_queue_pop_to_queue(AlogQueue * from, AlogQueue * to)
 {// #lizard forgives
-    volatile int q_from_head = from->q_head;      
-    volatile int q_from_tail = from->q_tail;
-    volatile int q_from_size = from->q_size;
+    int q_from_head = pg_atomic_read_u32(&(from->q_head));
+    int q_from_tail = pg_atomic_read_u32(&(from->q_tail));
+    int q_from_size = from->q_size;
 
-    volatile int q_to_head = to->q_head;      
-    volatile int q_to_tail = to->q_tail;
-    volatile int q_to_size = to->q_size;
+    int q_to_head = pg_atomic_read_u32(&(to->q_head));
+    int q_to_tail = pg_atomic_read_u32(&(to->q_tail));
+    int q_to_size = to->q_size;
 
     int from_head = q_from_head;      
     int from_tail = q_from_tail;
@@ -2116,8 +2266,6 @@ static bool alog_queue_pop_to_queue(AlogQueue * from, AlogQueue * to)
         int string_len = alog_queue_get_str_len(from, from_head);
         int copy_len = sizeof(int) + string_len;
 
-        pg_memory_barrier();
-
         Assert(string_len > 0 && string_len < from_size);
         Assert(copy_len > 0 && copy_len < from_size);
 
@@ -2172,54 +2320,72 @@ static bool alog_queue_pop_to_queue(AlogQueue * from, AlogQueue * to)
         to_used = alog_queue_used(to_size, to_head, to_tail);
     } while (!alog_queue_is_empty(from_size, from_head, from_tail));
 
-    from->q_head = from_head;
+    /* content must be read before the producer sees the new head */
+    pg_memory_barrier();
+    pg_atomic_write_u32(&(from->q_head), from_head);
 
     return true;
 }
 
 /*
- * copy message from queue to file as much as possible
+ * map audit log destination to index of statistics arrays
  */
-static bool alog_queue_pop_to_file(AlogQueue * from, int destination)
+static int alog_destination_index(int destination)
 {
-	volatile int q_from_head = from->q_head;
-	volatile int q_from_tail = from->q_tail;
-	volatile int q_from_size = from->q_size;
-
-	int from_head = q_from_head;
-	int from_tail = q_from_tail;
-	int from_size = q_from_size;
+	Assert(destination == AUDIT_COMMON_LOG ||
+		destination == AUDIT_FGA_LOG ||
+		destination == MAINTAIN_TRACE_LOG);
 
-	int from_total = 0;
+	if (destination == AUDIT_COMMON_LOG)
+		return 0;
+	else if (destination == AUDIT_FGA_LOG)
+		return 1;
+	return 2;
+}
 
-	int from_used = 0;
-	int from_copyed = 0;
+/*
+ * copy message from queue to file as much as possible
+ *
+ * Messages are gathered into an iovec array pointing into the queue, and
+ * written with one writev for up to AUDIT_WRITEV_MAX_IOV pieces, instead
+ * of one write for each message.
+ */
+static bool alog_queue_pop_to_file(AlogQueue * from, int destination, int shard)
+{
+	int from_head = pg_atomic_read_u32(&(from->q_head));
+	int from_tail = pg_atomic_read_u32(&(from->q_tail));
+	int from_size = from->q_size;
 
+	FILE ** file = NULL;
 	volatile slock_t * file_lock = NULL;
+	volatile int * file_busy = NULL;
+	int stat_idx = alog_destination_index(destination);
 
-	pg_memory_barrier();
-	alog_just_caller(&from_total);
-
-	from_total = from_used = alog_queue_used(from_size, from_head, from_tail);
+	/* the content written before the tail must be visible */
+	pg_read_barrier();
 
 	Assert(from_size > 0 && from_head >= 0 && from_tail >= 0);
-	Assert(from_head < from_size && from_tail < from_size && from_used <= from_size);
-	Assert(destination == AUDIT_COMMON_LOG ||
-		destination == AUDIT_FGA_LOG ||
-		destination == MAINTAIN_TRACE_LOG);
+	Assert(from_head < from_size && from_tail < from_size);
 
 	if (destination == AUDIT_COMMON_LOG)
 	{
-		file_lock = &audit_comm_log_file_lock;
+		Assert(shard >= 0 && shard < AuditLog_common_log_writer_number);
+		file = &audit_comm_log_file[shard];
+		file_lock = &audit_comm_log_file_lock[shard];
+		file_busy = &audit_comm_log_file_busy[shard];
 	}
 	else if (destination == AUDIT_FGA_LOG)
 	{
+		file = &audit_fga_log_file;
 		file_lock = &audit_fga_log_file_lock;
+		file_busy = &audit_fga_log_file_busy;
 	}
 	else
 	{
 		Assert(destination == MAINTAIN_TRACE_LOG);
+		file = &audit_trace_log_file;
 		file_lock = &audit_trace_log_file_lock;
+		file_busy = &audit_trace_log_file_busy;
 	}
 
 	/* from is empty, ignore */
@@ -2231,63 +2397,71 @@ static bool alog_queue_pop_to_file(AlogQueue * from, int destination)
 	/* copy message into file until from is empty */
 	do
 	{
-		int string_len = alog_queue_get_str_len(from, from_head);
-		int copy_len = sizeof(int) + string_len;
+		struct iovec iov[AUDIT_WRITEV_MAX_IOV];
+		int iovcnt = 0;
+		int records = 0;
+		int bytes = 0;
+		int fd = -1;
+
+		/* a message takes at most two pieces, when it wraps around */
+		while (!alog_queue_is_empty(from_size, from_head, from_tail) &&
+			   iovcnt + 2 <= AUDIT_WRITEV_MAX_IOV)
+		{
+			int string_len = alog_queue_get_str_len(from, from_head);
+			int copy_len = sizeof(int) + string_len;
 
-		pg_memory_barrier();
+			/* only write message content, not message len */
+			int content_offset = (from_head + sizeof(int)) % from_size;
 
-		/* just copy dierctly */
-		if (from_size - from_head >= copy_len)
-		{
-			char * p_start = alog_queue_offset_to(from, from_head + sizeof(int));
+			if (from_size - content_offset >= string_len)
+			{
+				iov[iovcnt].iov_base = alog_queue_offset_to(from, content_offset);
+				iov[iovcnt].iov_len = string_len;
+				iovcnt++;
+			}
+			else
+			{
+				/* must write as two parts */
+				int first_len = from_size - content_offset;
+				int second_len = string_len - first_len;
+
+				Assert(first_len > 0 && first_len < from_size);
+				Assert(second_len > 0 && second_len < from_size);
+
+				iov[iovcnt].iov_base = alog_queue_offset_to(from, content_offset);
+				iov[iovcnt].iov_len = first_len;
+				iovcnt++;
+				iov[iovcnt].iov_base = alog_queue_offset_to(from, 0);
+				iov[iovcnt].iov_len = second_len;
+				iovcnt++;
+			}
 
-			/* only copy message content, not write message len */
-			SpinLockAcquire(file_lock);
-			audit_write_log_file(p_start, string_len, destination);
-			SpinLockRelease(file_lock);
+			from_head = (from_head + copy_len) % from_size;
+			records++;
+			bytes += string_len;
 		}
-		else if (from_size - from_head > sizeof(int))
-		{
-			/* must copy as two parts */
-			int first_len = from_size - from_head - sizeof(int);
-			int second_len = string_len - first_len;
-			char * p_start = NULL;
 
-			Assert(first_len > 0 && first_len < from_size);
-			Assert(second_len > 0 && second_len < from_size);
+		/* the rotation must not close the file while writing to it */
+		SpinLockAcquire(file_lock);
+		fd = fileno(*file);
+		(*file_busy)++;
+		SpinLockRelease(file_lock);
 
-			SpinLockAcquire(file_lock);
-			p_start = alog_queue_offset_to(from, from_head + sizeof(int));
-			audit_write_log_file(p_start, first_len, destination);
-
-			p_start = alog_queue_offset_to(from, 0);
-			audit_write_log_file(p_start, second_len, destination);
-			SpinLockRelease(file_lock);
-		}
-		else
-		{
-			/* just copy content only */
-			int cpy_offset = (from_head + sizeof(int)) % from_size;
-			char * p_start = alog_queue_offset_to(from, cpy_offset);
-
-			Assert(from_size - from_head <= sizeof(int));
-			SpinLockAcquire(file_lock);
-			audit_write_log_file(p_start, string_len, destination);
-			SpinLockRelease(file_lock);
-		}
+		audit_write_log_file(fd, iov, iovcnt);
 
-		from_head = (from_head + copy_len) % from_size;
-		from_copyed += copy_len;
+		SpinLockAcquire(file_lock);
+		(*file_busy)--;
+		SpinLockRelease(file_lock);
 
-		Assert(from_copyed <= from_total);
-		Assert(from_used - copy_len >= 0);
-		Assert(from_used - copy_len == alog_queue_used(from_size, from_head, from_tail));
+		/* content must be written out before the producer sees the new head */
+		pg_memory_barrier();
+		pg_atomic_write_u32(&(from->q_head), from_head);
 
-		from_used = alog_queue_used(from_size, from_head, from_tail);
+		pg_atomic_fetch_add_u64(&(AuditWriterStats->w_write_calls[stat_idx]), 1);
+		pg_atomic_fetch_add_u64(&(AuditWriterStats->w_write_records[stat_idx]), records);
+		pg_atomic_fetch_add_u64(&(AuditWriterStats->w_write_bytes[stat_idx]), bytes);
 	} while (!alog_queue_is_empty(from_size, from_head, from_tail));
 
-	from->q_head = from_head;
-
 	return true;
 }
 
@@ -2405,25 +2579,28 @@ static AlogQueue * alog_get_local_trace_cache(int consumer_id)
  * local cache for log Consumer
  *
  * AuditCommonLogLocalCache = alog_make_local_cache(AuditLog_max_worker_number,
- * 		AuditLog_common_log_cache_size_kb);
+ * 		AuditLog_common_log_cache_size_kb, AuditLog_common_log_writer_number);
  *
  * AuditFGALogLocalCache = alog_make_local_cache(AuditLog_max_worker_number,
- * 		AuditLog_fga_log_cacae_size_kb);
+ * 		AuditLog_fga_log_cacae_size_kb, 1);
  *
  * AuditTraceLogLocalCache = alog_make_local_cache(AuditLog_max_worker_number,
- * 		Maintain_trace_log_cache_size_kb);
+ * 		Maintain_trace_log_cache_size_kb, 1);
+ *
+ * cache i is written out by writer (i % writer_number)
  */
-static AlogQueueCache * alog_make_local_cache(int cache_number, int queue_size_kb)
+static AlogQueueCache * alog_make_local_cache(int cache_number, int queue_size_kb, int writer_number)
 {
     Size headerSize = 0;
     Size cacheSize = 0;
     Size queueSize = 0;
 
     AlogQueueCache * cache = NULL;
-    ThreadSema * sema = NULL;
 
     int i = 0;
 
+    Assert(writer_number > 0 && writer_number <= AUDIT_MAX_COMMON_WRITER);
+
     headerSize = offsetof(AlogQueueCache, q_cache);
     headerSize = add_size(headerSize, cache_number * sizeof(AlogQueue *));
 
@@ -2433,7 +2610,6 @@ static AlogQueueCache * alog_make_local_cache(int cache_number, int queue_size_k
     cacheSize = add_size(cacheSize, headerSize);
 
     cache = palloc0(cacheSize);
-    sema = &(cache->q_sema);
 
     for (i = 0; i < cache_number; i++)
     {
@@ -2446,7 +2622,11 @@ static AlogQueueCache * alog_make_local_cache(int cache_number, int queue_size_k
         cache->q_cache[i] = queue;
     }
 
-    ThreadSemaInit(sema, 0);
+    for (i = 0; i < writer_number; i++)
+    {
+        ThreadSemaInit(&(cache->q_sema[i]), 0);
+    }
+    cache->q_writers = writer_number;
     cache->q_count = cache_number;
 
     return cache;
@@ -2565,7 +2745,7 @@ static void * alog_consumer_main(void * arg)
 				{
 					if (local_is_empty)
 					{
-						alog_writer_wakeup(AUDIT_COMMON_LOG);
+						alog_writer_wakeup(AUDIT_COMMON_LOG, consumer_id);
 					}
 				}
 
@@ -2579,7 +2759,7 @@ static void * alog_consumer_main(void * arg)
 				{
 					if (local_is_empty)
 					{
-						alog_writer_wakeup(AUDIT_FGA_LOG);
+						alog_writer_wakeup(AUDIT_FGA_LOG, consumer_id);
 					}
 				}
 
@@ -2593,7 +2773,7 @@ static void * alog_consumer_main(void * arg)
 				{
 					if (local_is_empty)
 					{
-						alog_writer_wakeup(MAINTAIN_TRACE_LOG);
+						alog_writer_wakeup(MAINTAIN_TRACE_LOG, consumer_id);
 					}
 				}
 
@@ -2625,7 +2805,7 @@ static void * alog_consumer_main(void * arg)
  * Wakeup a writer thread to read audit log
  * from local audit log cache
  */
-static void alog_writer_wakeup(int writer_destination)
+static void alog_writer_wakeup(int writer_destination, int consumer_id)
 {
     ThreadSema * sema = NULL;
     AlogQueueCache * local_cache = NULL;
@@ -2648,7 +2828,8 @@ static void alog_writer_wakeup(int writer_destination)
 		local_cache = AuditTraceLogLocalCache;
 	}
 
-    sema = (&(local_cache->q_sema));
+    /* wakeup the writer owning the cache of consumer */
+    sema = (&(local_cache->q_sema[consumer_id % local_cache->q_writers]));
     ThreadSemaUp(sema);
 }
 
@@ -2656,7 +2837,7 @@ static void alog_writer_wakeup(int writer_destination)
  * Sleep if there is no log to read in
  * local audit log cache
  */
-static void alog_writer_sleep(int writer_destination)
+static void alog_writer_sleep(int writer_destination, int shard)
 {
     ThreadSema * sema = NULL;
     AlogQueueCache * local_cache = NULL;
@@ -2679,20 +2860,23 @@ static void alog_writer_sleep(int writer_destination)
 		local_cache = AuditTraceLogLocalCache;
 	}
 
-    sema = (&(local_cache->q_sema));
+    Assert(shard >= 0 && shard < local_cache->q_writers);
+    sema = (&(local_cache->q_sema[shard]));
     ThreadSemaDown(sema);
 }
 
 /*
- * three writer, write log to logfile
+ * writers, write log to logfile
  *
- * one for AuditCommonLogLocalCache
+ * AuditLog_common_log_writer_number for AuditCommonLogLocalCache, each one
+ * writes its own shard of common log file
  * one for AuditFgaLogQueueCache
  * one for AuditTraceLogQueueCache
  */
 static void * alog_writer_main(void * arg)
 {
-	int writer_destination = *((int *) arg);
+	int writer_destination = ((AlogWriterArg *) arg)->destination;
+	int shard = ((AlogWriterArg *) arg)->shard;
 	AlogQueueCache * local_cache = NULL;
 
 	Assert(writer_destination == AUDIT_COMMON_LOG ||
@@ -2721,12 +2905,12 @@ static void * alog_writer_main(void * arg)
 		int i = 0;
 		bool copy_nothing = true;
 
-		for (i = 0; i < AuditLog_max_worker_number; i++)
+		for (i = shard; i < AuditLog_max_worker_number; i += local_cache->q_writers)
 		{
 			int consumer_id = i;
 			AlogQueue * local_queue = local_cache->q_cache[i];
 
-			if (alog_queue_pop_to_file(local_queue, writer_destination))
+			if (alog_queue_pop_to_file(local_queue, writer_destination, shard))
 			{
 				copy_nothing = false;
 			}
@@ -2743,24 +2927,25 @@ static void * alog_writer_main(void * arg)
 			 * maybe local input is empty,
 			 * so wait a moment and retry
 			 */
-			alog_writer_sleep(writer_destination);
+			alog_writer_sleep(writer_destination, shard);
 		}
 	}
 
 	return NULL;
 }
 
-static void alog_start_writer(int writer_destination)
+static void alog_start_writer(int writer_destination, int shard)
 {
-    int * des = NULL;
+    AlogWriterArg * des = NULL;
     int ret = 0;
 
 	Assert(writer_destination == AUDIT_COMMON_LOG ||
 		writer_destination == AUDIT_FGA_LOG ||
 		writer_destination == MAINTAIN_TRACE_LOG);
 
-    des = palloc0(sizeof(int));
-    *des = writer_destination;
+    des = palloc0(sizeof(AlogWriterArg));
+    des->destination = writer_destination;
+    des->shard = shard;
 
 	ret = CreateThread(alog_writer_main, (void *)des, MT_THR_DETACHED);
 	if (ret != 0)
@@ -2799,17 +2984,24 @@ static void alog_start_all_worker(void)
     int i = 0;
 
 	AuditCommonLogLocalCache = alog_make_local_cache(AuditLog_max_worker_number,
-											AuditLog_common_log_cache_size_kb);
+											AuditLog_common_log_cache_size_kb,
+											AuditLog_common_log_writer_number);
 	AuditFGALogLocalCache = alog_make_local_cache(AuditLog_max_worker_number,
-											AuditLog_fga_log_cacae_size_kb);
+											AuditLog_fga_log_cacae_size_kb, 1);
 	AuditTraceLogLocalCache = alog_make_local_cache(AuditLog_max_worker_number,
-											Maintain_trace_log_cache_size_kb);
+											Maintain_trace_log_cache_size_kb, 1);
 	AuditConsumerNotifySemas = alog_make_consumer_semas(AuditLog_max_worker_number);
 
-	/* 00, start writer worker, one for common log, one for fga log, one for trace log. */
-	alog_start_writer(AUDIT_COMMON_LOG);
-	alog_start_writer(AUDIT_FGA_LOG);
-	alog_start_writer(MAINTAIN_TRACE_LOG);
+	/*
+	 * 00, start writer worker, AuditLog_common_log_writer_number for common log,
+	 * one for fga log, one for trace log.
+	 */
+	for (i = 0; i < AuditLog_common_log_writer_number; i++)
+	{
+		alog_start_writer(AUDIT_COMMON_LOG, i);
+	}
+	alog_start_writer(AUDIT_FGA_LOG, 0);
+	alog_start_writer(MAINTAIN_TRACE_LOG, 0);
 
     /* 001, start AuditLog_max_worker_number consumer worker */
     for (i = 0; i < AuditLog_max_worker_number; i++)
@@ -2902,6 +3094,9 @@ void alog(int destination, const char *fmt,...)
 	len = buf.len;
 	while (false == alog_queue_push(queue, buf.data, len))
 	{
+		/* queue is full, wait for consumer */
+		alog_queue_count(&(queue->q_full_waits), 1);
+
 		if (!audit_shared_consumer_bitmap_get_value(consumer_id))
 		{
 			/*
@@ -2917,6 +3112,9 @@ void alog(int destination, const char *fmt,...)
 		pg_usleep(AUDIT_SLEEP_MICROSEC);
 	}
 
+	alog_queue_count(&(queue->q_push_records), 1);
+	alog_queue_count(&(queue->q_push_bytes), len);
+
 	pfree(buf.data);
 
 	if (!audit_shared_consumer_bitmap_get_value(consumer_id))
@@ -2967,3 +3165,86 @@ static void    alog_start_shard_stat_worker(void)
 }
 
 #endif
+
+#ifdef AuditLog_008_For_Statistics
+
+/*
+ * pg_stat_get_audit_logger
+ *
+ * one row for each kind of audit log: how much backends pushed into their
+ * queues, how often they had to wait for a full queue, and how much the
+ * writers wrote out and with how many writev calls.
+ */
+Datum
+pg_stat_get_audit_logger(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_GET_AUDIT_LOGGER_COLS	7
+	static const int destinations[AUDIT_LOG_TYPE_NUM] = { AUDIT_COMMON_LOG, AUDIT_FGA_LOG, MAINTAIN_TRACE_LOG };
+	static const char *names[AUDIT_LOG_TYPE_NUM] = { "common", "fga", "trace" };
+	FuncCallContext *funcctx = NULL;
+	int			call_cntr = 0;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		MemoryContext oldcontext;
+		TupleDesc	tupdesc;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+		funcctx->max_calls = AUDIT_LOG_TYPE_NUM;
+
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	call_cntr = funcctx->call_cntr;
+
+	if (call_cntr < funcctx->max_calls)
+	{
+		Datum		values[PG_STAT_GET_AUDIT_LOGGER_COLS];
+		bool		nulls[PG_STAT_GET_AUDIT_LOGGER_COLS];
+		HeapTuple	tuple;
+		int			destination = destinations[call_cntr];
+		int			stat_idx = alog_destination_index(destination);
+		uint64		push_records = 0;
+		uint64		push_bytes = 0;
+		uint64		full_waits = 0;
+		int			i = 0;
+
+		for (i = 0; i < MaxBackends; i++)
+		{
+			AlogQueue * queue = NULL;
+
+			if (destination == AUDIT_COMMON_LOG)
+				queue = alog_get_shared_common_queue(i);
+			else if (destination == AUDIT_FGA_LOG)
+				queue = alog_get_shared_fga_queue(i);
+			else
+				queue = alog_get_shared_trace_queue(i);
+
+			push_records += pg_atomic_read_u64(&(queue->q_push_records));
+			push_bytes += pg_atomic_read_u64(&(queue->q_push_bytes));
+			full_waits += pg_atomic_read_u64(&(queue->q_full_waits));
+		}
+
+		MemSet(nulls, 0, sizeof(nulls));
+		values[0] = CStringGetTextDatum(names[call_cntr]);
+		values[1] = Int64GetDatum(push_records);
+		values[2] = Int64GetDatum(push_bytes);
+		values[3] = Int64GetDatum(full_waits);
+		values[4] = Int64GetDatum(pg_atomic_read_u64(&(AuditWriterStats->w_write_calls[stat_idx])));
+		values[5] = Int64GetDatum(pg_atomic_read_u64(&(AuditWriterStats->w_write_records[stat_idx])));
+		values[6] = Int64GetDatum(pg_atomic_read_u64(&(AuditWriterStats->w_write_bytes[stat_idx])));
+
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
+
+#endif
@@ -23,6 +23,7 @@
 #include "pgstat.h"
 #include "port/atomics.h"
 #include "postmaster/bgworker_internals.h"
+#include "postmaster/partprecreate.h"
 #include "postmaster/postmaster.h"
 #include "replication/logicallauncher.h"
 #include "replication/logicalworker.h"
@@ -146,6 +147,12 @@ static const struct
         "ApplyAuditFgaMain", ApplyAuditFgaMain
     }
 #endif
+    ,{
+        "IntervalPartitionLauncherMain", IntervalPartitionLauncherMain
+    },
+    {
+        "IntervalPartitionWorkerMain", IntervalPartitionWorkerMain
+    }
 };
 
 /* Private functions. */
@@ -25,8 +25,10 @@
 #include <unistd.h>
 
 #include "access/gtm.h"
+#include "access/htup_details.h"
 #include "access/transam.h"
 #include "access/xact.h"
+#include "funcapi.h"
 #include "gtm/gtm_c.h"
 #include "gtm/gtm_gxid.h"
 #include "libpq/pqsignal.h"
@@ -40,6 +42,7 @@
 #include "storage/procarray.h"
 #include "storage/spin.h"
 #include "tcop/tcopprot.h"
+#include "utils/builtins.h"
 #include "utils/memutils.h"
 #include "utils/ps_status.h"
 #include "utils/timeout.h"
@@ -62,12 +65,22 @@ static void cm_sigterm_handler(SIGNAL_ARGS);
 #ifdef __USE_GLOBAL_SNAPSHOT__
 static void ClusterMonitorSetReportedGlobalXmin(GlobalTransactionId xmin);
 static void ClusterMonitorSetReportingGlobalXmin(GlobalTransactionId xmin);
+static void ClusterMonitorSetLocalXmin(GlobalTransactionId xmin);
 #endif
 /* PID of clustser monitoring process */
 int            ClusterMonitorPid = 0;
 
+/* GUC, see clustermon.h */
+int            global_xmin_report_threshold = 1024;
+
 #define CLUSTER_MONITOR_NAPTIME    5
 
+/*
+ * Interval at which the local xmin is checked against
+ * global_xmin_report_threshold, in milliseconds.
+ */
+#define CLUSTER_MONITOR_POLL_MS    100
+
 /*
  * Main loop for the cluster monitor process.
  */
@@ -83,6 +96,9 @@ ClusterMonitorInit(void)
     GlobalTransactionId newOldestXmin;
     GlobalTransactionId lastGlobalXmin;
     GlobalTransactionId latestCompletedXid;
+    GlobalTransactionId lastReportedXmin = InvalidGlobalTransactionId;
+    TimestampTz lastReportTime = 0;
+    bool        lastReportFailed = false;
     int status;
 #endif
     am_clustermon = true;
@@ -202,10 +218,18 @@ ClusterMonitorInit(void)
         int            rc;
 
         /*
-         * Repeat at CLUSTER_MONITOR_NAPTIME seconds interval
+         * Repeat at CLUSTER_MONITOR_NAPTIME seconds interval, or poll the
+         * local xmin more often if it is to be reported as it advances.
          */
         nap.tv_sec = CLUSTER_MONITOR_NAPTIME;
         nap.tv_usec = 0;
+#ifdef __USE_GLOBAL_SNAPSHOT__
+        if (global_xmin_report_threshold > 0)
+        {
+            nap.tv_sec = 0;
+            nap.tv_usec = CLUSTER_MONITOR_POLL_MS * 1000L;
+        }
+#endif
 
         /*
          * Wait until naptime expires or we get some type of signal (all the
@@ -244,6 +268,29 @@ ClusterMonitorInit(void)
          * interval. Keep doing this forever
          */
         lastGlobalXmin = ClusterMonitorGetGlobalXmin();
+
+        /*
+         * Between naptimes, only report once the local xmin advanced by
+         * global_xmin_report_threshold since the last report, so the global
+         * xmin follows hot update workloads closely without flooding GTM.
+         * The estimate is taken without ClusterMonitorLock, the xmin that is
+         * actually reported is computed again below.  After a failed report,
+         * wait for the naptime before trying again instead of asking GTM at
+         * every poll.
+         */
+        if (global_xmin_report_threshold > 0 &&
+            (TransactionIdIsValid(lastReportedXmin) || lastReportFailed) &&
+            !TimestampDifferenceExceeds(lastReportTime, GetCurrentTimestamp(),
+                                        CLUSTER_MONITOR_NAPTIME * 1000))
+        {
+            oldestXmin = GetOldestXminInternal(NULL, 0, true, lastGlobalXmin);
+            ClusterMonitorSetLocalXmin(oldestXmin);
+            if (lastReportFailed ||
+                !TransactionIdFollows(oldestXmin, lastReportedXmin) ||
+                oldestXmin - lastReportedXmin < (uint32) global_xmin_report_threshold)
+                continue;
+        }
+
          LWLockAcquire(ClusterMonitorLock, LW_EXCLUSIVE);
         oldestXmin = GetOldestXminInternal(NULL, 0, true, lastGlobalXmin);
         ClusterMonitorSetReportingGlobalXmin(oldestXmin);
@@ -279,9 +326,14 @@ ClusterMonitorInit(void)
                         TransactionIdPrecedes(oldestXmin, latestCompletedXid))
                 {
                     SetLatestCompletedXid(latestCompletedXid);
+                    lastReportFailed = false;
                     continue;
                 }
             }
+
+            /* back off until the next naptime */
+            lastReportFailed = true;
+            lastReportTime = GetCurrentTimestamp();
         }
         else
         {
@@ -294,6 +346,9 @@ ClusterMonitorInit(void)
             ClusterMonitorSetReportedGlobalXmin(oldestXmin);
             if (GlobalTransactionIdIsValid(newOldestXmin))
                 ClusterMonitorSetGlobalXmin(newOldestXmin);
+            lastReportedXmin = oldestXmin;
+            lastReportTime = GetCurrentTimestamp();
+            lastReportFailed = false;
         }
 
         ClusterMonitorSetReportingGlobalXmin(InvalidGlobalTransactionId);
@@ -366,19 +421,16 @@ ClusterMonitorShmemInit(void)
         /* First time through, so initialize */
         MemSet(ClusterMonitorCtl, 0, ClusterMonitorShmemSize());
         SpinLockInit(&ClusterMonitorCtl->mutex);
+        pg_atomic_init_u32(&ClusterMonitorCtl->gtm_recent_global_xmin,
+                           InvalidGlobalTransactionId);
     }
 }
 
 GlobalTransactionId
 ClusterMonitorGetGlobalXmin(void)
 {
-    GlobalTransactionId xmin;
-
-    SpinLockAcquire(&ClusterMonitorCtl->mutex);
-    xmin = ClusterMonitorCtl->gtm_recent_global_xmin;
-    SpinLockRelease(&ClusterMonitorCtl->mutex);
-
-    return xmin;
+    return (GlobalTransactionId)
+        pg_atomic_read_u32(&ClusterMonitorCtl->gtm_recent_global_xmin);
 }
 
 void
@@ -404,7 +456,12 @@ ClusterMonitorSetGlobalXmin(GlobalTransactionId xmin)
     ProcArrayCheckXminConsistency(xmin);
 
     SpinLockAcquire(&ClusterMonitorCtl->mutex);
-    ClusterMonitorCtl->gtm_recent_global_xmin = xmin;
+    if (xmin != pg_atomic_read_u32(&ClusterMonitorCtl->gtm_recent_global_xmin))
+    {
+        ClusterMonitorCtl->last_advance_time = GetCurrentTimestamp();
+        ClusterMonitorCtl->advance_count++;
+    }
+    pg_atomic_write_u32(&ClusterMonitorCtl->gtm_recent_global_xmin, xmin);
     SpinLockRelease(&ClusterMonitorCtl->mutex);
 
     LWLockRelease(ProcArrayLock);
@@ -418,6 +475,17 @@ ClusterMonitorSetReportedGlobalXmin(GlobalTransactionId xmin)
             xmin);
     SpinLockAcquire(&ClusterMonitorCtl->mutex);
     ClusterMonitorCtl->reported_recent_global_xmin = xmin;
+    ClusterMonitorCtl->local_xmin = xmin;
+    ClusterMonitorCtl->last_report_time = GetCurrentTimestamp();
+    ClusterMonitorCtl->report_count++;
+    SpinLockRelease(&ClusterMonitorCtl->mutex);
+}
+
+static void
+ClusterMonitorSetLocalXmin(GlobalTransactionId xmin)
+{
+    SpinLockAcquire(&ClusterMonitorCtl->mutex);
+    ClusterMonitorCtl->local_xmin = xmin;
     SpinLockRelease(&ClusterMonitorCtl->mutex);
 }
 
@@ -443,3 +511,73 @@ ClusterMonitorGetReportingGlobalXmin(void)
 
     return reporting_xmin;
 }
+
+/*
+ * pg_stat_get_cluster_xmin
+ *        Show how far the global xmin received from GTM lags behind the local
+ *        xmin of this node.  Global values are NULL when the node does not
+ *        take its xmin from GTM.
+ */
+Datum
+pg_stat_get_cluster_xmin(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_GET_CLUSTER_XMIN_COLS    9
+    TupleDesc    tupdesc;
+    Datum        values[PG_STAT_GET_CLUSTER_XMIN_COLS];
+    bool        nulls[PG_STAT_GET_CLUSTER_XMIN_COLS];
+    GlobalTransactionId local_xmin;
+    GlobalTransactionId reported_xmin;
+    GlobalTransactionId global_xmin;
+    TimestampTz last_report_time;
+    TimestampTz last_advance_time;
+    int64        report_count;
+    int64        advance_count;
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+        elog(ERROR, "return type must be a row type");
+
+    SpinLockAcquire(&ClusterMonitorCtl->mutex);
+    local_xmin = ClusterMonitorCtl->local_xmin;
+    reported_xmin = ClusterMonitorCtl->reported_recent_global_xmin;
+    last_report_time = ClusterMonitorCtl->last_report_time;
+    last_advance_time = ClusterMonitorCtl->last_advance_time;
+    report_count = ClusterMonitorCtl->report_count;
+    advance_count = ClusterMonitorCtl->advance_count;
+    SpinLockRelease(&ClusterMonitorCtl->mutex);
+    global_xmin = ClusterMonitorGetGlobalXmin();
+
+    /* nobody computed it yet, e.g. xmin is not reported to GTM */
+    if (!TransactionIdIsValid(local_xmin))
+        local_xmin = GetOldestXmin(NULL, PROCARRAY_FLAGS_DEFAULT);
+
+    MemSet(nulls, 0, sizeof(nulls));
+    values[0] = CStringGetTextDatum(PGXCNodeName);
+    values[1] = TransactionIdGetDatum(local_xmin);
+    if (TransactionIdIsValid(reported_xmin))
+        values[2] = TransactionIdGetDatum(reported_xmin);
+    else
+        nulls[2] = true;
+    if (TransactionIdIsValid(global_xmin))
+    {
+        values[3] = TransactionIdGetDatum(global_xmin);
+        values[4] = Int64GetDatum(TransactionIdFollows(local_xmin, global_xmin) ?
+                                  (int64) (local_xmin - global_xmin) : 0);
+    }
+    else
+    {
+        nulls[3] = true;
+        nulls[4] = true;
+    }
+    if (last_report_time != 0)
+        values[5] = TimestampTzGetDatum(last_report_time);
+    else
+        nulls[5] = true;
+    if (last_advance_time != 0)
+        values[6] = TimestampTzGetDatum(last_advance_time);
+    else
+        nulls[6] = true;
+    values[7] = Int64GetDatum(report_count);
+    values[8] = Int64GetDatum(advance_count);
+
+    PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
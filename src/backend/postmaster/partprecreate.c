@@ -0,0 +1,850 @@
+/*-------------------------------------------------------------------------
+ *
+ * partprecreate.c
+ *
+ * Interval partitioned tables only accept rows for which a partition
+ * exists, so partitions are added ahead of time with ALTER TABLE ... ADD
+ * PARTITIONS.  Doing so when the first row of a new period arrives makes
+ * ingestion wait for the files of the new partition to be created and for
+ * the catalog changes to reach every node.
+ *
+ * With interval_partition_precreate set at server start, a launcher runs on
+ * the coordinators.  It wakes up every interval_partition_precreate_naptime
+ * seconds and starts a worker in each database in turn.  The worker looks
+ * for the tables partitioned by day or month whose partitions do not cover
+ * the current period and the interval_partition_precreate next ones, and
+ * adds the missing partitions.  The DDL is run through a regular session on
+ * the coordinator as interval_partition_precreate_role, to be applied on all
+ * the nodes like any other.  The new partitions are then made ready for
+ * their first rows on every node: their first extents are added and their
+ * catalog entries read.
+ *
+ * Only the coordinator with the smallest node name among those answering
+ * runs the launcher's work.  Should two of them run it at once, the table
+ * is locked and its partitions counted again before adding any.
+ *
+ * Copyright (c) 2023 THL A29 Limited, a Tencent company.
+ *
+ * This source code file is licensed under the BSD 3-Clause License,
+ * you may obtain a copy of the License at http://opensource.org/license/bsd-3-clause/
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/postmaster/partprecreate.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "access/heapam.h"
+#include "access/hio.h"
+#include "access/htup_details.h"
+#include "access/xact.h"
+#include "catalog/pg_class.h"
+#include "catalog/pg_database.h"
+#include "catalog/pg_partition_interval.h"
+#include "catalog/pg_type.h"
+#include "commands/dbcommands.h"
+#include "funcapi.h"
+#include "libpq/pqsignal.h"
+#include "miscadmin.h"
+#include "nodes/parsenodes.h"
+#include "pgstat.h"
+#include "pgxc/nodemgr.h"
+#include "pgxc/pgxc.h"
+#include "pgxc/shardmap.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/partprecreate.h"
+#include "storage/extentmapping.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/proc.h"
+#include "tcop/tcopprot.h"
+#include "utils/acl.h"
+#include "utils/builtins.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/ruleutils.h"
+#include "utils/snapmgr.h"
+#include "utils/timestamp.h"
+#include "utils/tuplestore.h"
+#include "../interfaces/libpq/libpq-fe.h"
+
+
+int			interval_partition_precreate = 0;
+int			interval_partition_precreate_naptime = 600;
+char	   *interval_partition_precreate_role = NULL;
+
+/* A table short of partitions, and the number it should have */
+typedef struct IntervalPartitionTask
+{
+	char	   *relname;		/* qualified and quoted */
+	int			nparts;
+	int			wanted;
+} IntervalPartitionTask;
+
+static volatile sig_atomic_t got_SIGHUP = false;
+
+static void interval_partition_sighup(SIGNAL_ARGS);
+static bool interval_partition_is_leader(void);
+static bool interval_partition_node_answers(NodeDefinition *node);
+static void interval_partition_launch_workers(void);
+static List *interval_partition_tasks(Timestamp now, int count);
+static char *interval_partition_command(IntervalPartitionTask *task,
+						   int nparts);
+static List *interval_partition_datanodes(void);
+static PGconn *interval_partition_connect(const char *dbname);
+static bool interval_partition_exec(PGconn *conn, const char *sql,
+						ExecStatusType status);
+static void interval_partition_add(PGconn *conn, IntervalPartitionTask *task,
+					   List *datanodes);
+
+/*
+ * Register the launcher, on coordinators only: the partitions are added by
+ * DDL sent from a coordinator to the other nodes.  It takes a background
+ * worker slot, so only if the feature is on at server start.
+ */
+void
+IntervalPartitionLauncherRegister(void)
+{
+	BackgroundWorker bgw;
+
+	if (!IS_PGXC_COORDINATOR || interval_partition_precreate <= 0)
+		return;
+
+	memset(&bgw, 0, sizeof(bgw));
+	bgw.bgw_flags = BGWORKER_SHMEM_ACCESS |
+		BGWORKER_BACKEND_DATABASE_CONNECTION;
+	bgw.bgw_start_time = BgWorkerStart_RecoveryFinished;
+	snprintf(bgw.bgw_library_name, BGW_MAXLEN, "postgres");
+	snprintf(bgw.bgw_function_name, BGW_MAXLEN, "IntervalPartitionLauncherMain");
+	snprintf(bgw.bgw_name, BGW_MAXLEN,
+			 "interval partition launcher");
+	bgw.bgw_restart_time = 5;
+	bgw.bgw_notify_pid = 0;
+	bgw.bgw_main_arg = (Datum) 0;
+
+	RegisterBackgroundWorker(&bgw);
+}
+
+/*
+ * Main loop for the launcher.
+ */
+void
+IntervalPartitionLauncherMain(Datum main_arg)
+{
+	bool		warned = false;
+
+	ereport(DEBUG1,
+			(errmsg("interval partition launcher started")));
+
+	pqsignal(SIGHUP, interval_partition_sighup);
+	pqsignal(SIGTERM, die);
+	BackgroundWorkerUnblockSignals();
+
+	/* only the shared catalogs are read here */
+	BackgroundWorkerInitializeConnection(NULL, NULL);
+
+	for (;;)
+	{
+		int			rc;
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (got_SIGHUP)
+		{
+			got_SIGHUP = false;
+			ProcessConfigFile(PGC_SIGHUP);
+			warned = false;
+		}
+
+		if (interval_partition_precreate > 0 &&
+			(interval_partition_precreate_role == NULL ||
+			 interval_partition_precreate_role[0] == '\0'))
+		{
+			if (!warned)
+				ereport(LOG,
+						(errmsg("interval partitions are not pre-created"),
+						 errhint("Set interval_partition_precreate_role to the role to add them as.")));
+			warned = true;
+		}
+		else if (interval_partition_precreate > 0 &&
+				 interval_partition_is_leader())
+			interval_partition_launch_workers();
+
+		rc = WaitLatch(MyLatch,
+					   WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+					   interval_partition_precreate_naptime * 1000L,
+					   WAIT_EVENT_INTERVAL_PARTITION_MAIN);
+
+		if (rc & WL_POSTMASTER_DEATH)
+			proc_exit(1);
+
+		ResetLatch(MyLatch);
+	}
+}
+
+/*
+ * Main for the worker, adding the upcoming partitions of the tables of the
+ * database given as argument.
+ */
+void
+IntervalPartitionWorkerMain(Datum main_arg)
+{
+	Oid			dboid = DatumGetObjectId(main_arg);
+	List	   *tasks;
+	List	   *datanodes;
+	char	   *dbname;
+	Timestamp	now;
+	ListCell   *lc;
+	PGconn	   *conn;
+	MemoryContext workcxt;
+	MemoryContext oldcxt;
+
+	pqsignal(SIGTERM, die);
+	BackgroundWorkerUnblockSignals();
+
+	BackgroundWorkerInitializeConnectionByOid(dboid, InvalidOid);
+
+	/* what is built in the transaction is used after it */
+	workcxt = AllocSetContextCreate(TopMemoryContext,
+									"interval partition worker",
+									ALLOCSET_DEFAULT_SIZES);
+
+	StartTransactionCommand();
+	(void) GetTransactionSnapshot();
+	oldcxt = MemoryContextSwitchTo(workcxt);
+
+	/* partition bounds are local times */
+	now = DatumGetTimestamp(DirectFunctionCall1(timestamptz_timestamp,
+												TimestampTzGetDatum(GetCurrentTimestamp())));
+	tasks = interval_partition_tasks(now, interval_partition_precreate);
+	datanodes = interval_partition_datanodes();
+	dbname = get_database_name(MyDatabaseId);
+
+	MemoryContextSwitchTo(oldcxt);
+	CommitTransactionCommand();
+
+	if (tasks == NIL)
+		proc_exit(0);
+
+	conn = interval_partition_connect(dbname);
+	if (conn == NULL)
+		proc_exit(0);
+
+	foreach(lc, tasks)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		interval_partition_add(conn, (IntervalPartitionTask *) lfirst(lc),
+							   datanodes);
+	}
+
+	PQfinish(conn);
+
+	proc_exit(0);
+}
+
+static void
+interval_partition_sighup(SIGNAL_ARGS)
+{
+	int			save_errno = errno;
+
+	got_SIGHUP = true;
+	SetLatch(MyLatch);
+
+	errno = save_errno;
+}
+
+/*
+ * Is this the coordinator with the smallest name, among those answering?
+ * One that is down must not keep the others from adding partitions.
+ */
+static bool
+interval_partition_is_leader(void)
+{
+	Oid		   *coOids = NULL;
+	Oid		   *dnOids = NULL;
+	int			numCoords = 0;
+	int			numDns = 0;
+	int			i;
+	bool		leader = true;
+
+	if (PGXCNodeName == NULL || PGXCNodeName[0] == '\0')
+		return false;
+
+	PgxcNodeGetOids(&coOids, &dnOids, &numCoords, &numDns, false);
+
+	for (i = 0; i < numCoords && leader; i++)
+	{
+		NodeDefinition *node = PgxcNodeGetDefinition(coOids[i]);
+
+		if (node == NULL)
+			continue;
+		if (strcmp(NameStr(node->nodename), PGXCNodeName) < 0 &&
+			interval_partition_node_answers(node))
+			leader = false;
+		pfree(node);
+	}
+
+	if (coOids)
+		pfree(coOids);
+	if (dnOids)
+		pfree(dnOids);
+
+	return leader;
+}
+
+/*
+ * Does the node answer connection requests?  One that rejects them, while
+ * starting up or out of connections, is up all the same.
+ */
+static bool
+interval_partition_node_answers(NodeDefinition *node)
+{
+	char		port[12];
+	const char *keywords[4];
+	const char *values[4];
+
+	snprintf(port, sizeof(port), "%d", node->nodeport);
+
+	keywords[0] = "host";
+	values[0] = NameStr(node->nodehost);
+	keywords[1] = "port";
+	values[1] = port;
+	keywords[2] = "connect_timeout";
+	values[2] = "10";
+	keywords[3] = NULL;
+	values[3] = NULL;
+
+	return PQpingParams(keywords, values, false) != PQPING_NO_RESPONSE;
+}
+
+/*
+ * Run a worker in each database accepting connections, one after the other.
+ */
+static void
+interval_partition_launch_workers(void)
+{
+	List	   *dboids = NIL;
+	ListCell   *lc;
+	Relation	rel;
+	HeapScanDesc scan;
+	HeapTuple	tup;
+	MemoryContext oldcxt;
+
+	StartTransactionCommand();
+	(void) GetTransactionSnapshot();
+
+	rel = heap_open(DatabaseRelationId, AccessShareLock);
+	scan = heap_beginscan_catalog(rel, 0, NULL);
+
+	while (HeapTupleIsValid(tup = heap_getnext(scan, ForwardScanDirection)))
+	{
+		Form_pg_database pgdatabase = (Form_pg_database) GETSTRUCT(tup);
+
+		if (!pgdatabase->datallowconn)
+			continue;
+
+		/* the list must survive the transaction */
+		oldcxt = MemoryContextSwitchTo(TopMemoryContext);
+		dboids = lappend_oid(dboids, HeapTupleGetOid(tup));
+		MemoryContextSwitchTo(oldcxt);
+	}
+
+	heap_endscan(scan);
+	heap_close(rel, AccessShareLock);
+
+	CommitTransactionCommand();
+
+	foreach(lc, dboids)
+	{
+		BackgroundWorker bgw;
+		BackgroundWorkerHandle *handle;
+		BgwHandleStatus status;
+
+		memset(&bgw, 0, sizeof(bgw));
+		bgw.bgw_flags = BGWORKER_SHMEM_ACCESS |
+			BGWORKER_BACKEND_DATABASE_CONNECTION;
+		bgw.bgw_start_time = BgWorkerStart_RecoveryFinished;
+		snprintf(bgw.bgw_library_name, BGW_MAXLEN, "postgres");
+		snprintf(bgw.bgw_function_name, BGW_MAXLEN, "IntervalPartitionWorkerMain");
+		snprintf(bgw.bgw_name, BGW_MAXLEN,
+				 "interval partition worker for database %u", lfirst_oid(lc));
+		bgw.bgw_restart_time = BGW_NEVER_RESTART;
+		bgw.bgw_notify_pid = MyProcPid;
+		bgw.bgw_main_arg = ObjectIdGetDatum(lfirst_oid(lc));
+
+		if (!RegisterDynamicBackgroundWorker(&bgw, &handle))
+		{
+			ereport(WARNING,
+					(errcode(ERRCODE_CONFIGURATION_LIMIT_EXCEEDED),
+					 errmsg("out of background worker slots"),
+					 errhint("You might need to increase max_worker_processes.")));
+			break;
+		}
+
+		status = WaitForBackgroundWorkerShutdown(handle);
+		pfree(handle);
+
+		if (status == BGWH_POSTMASTER_DIED)
+			proc_exit(1);
+	}
+
+	list_free(dboids);
+}
+
+/*
+ * Find the tables of the current database partitioned by day or month
+ * whose partitions do not cover the period of 'now' and the 'count' next
+ * ones.  Must be called in a transaction.
+ */
+static List *
+interval_partition_tasks(Timestamp now, int count)
+{
+	List	   *tasks = NIL;
+	Relation	rel;
+	HeapScanDesc scan;
+	HeapTuple	tup;
+
+	rel = heap_open(PgPartitionIntervalRelationId, AccessShareLock);
+	scan = heap_beginscan_catalog(rel, 0, NULL);
+
+	while (HeapTupleIsValid(tup = heap_getnext(scan, ForwardScanDirection)))
+	{
+		Form_pg_partition_interval form = (Form_pg_partition_interval) GETSTRUCT(tup);
+		IntervalPartitionTask *task;
+		int			current;
+		int			wanted;
+		char	   *nspname;
+		char	   *relname;
+
+		if (form->partdatatype != TIMESTAMPOID ||
+			(form->partinterval_type != IntervalType_Day &&
+			 form->partinterval_type != IntervalType_Month))
+			continue;
+
+		if (get_rel_persistence(form->partrelid) == RELPERSISTENCE_TEMP)
+			continue;
+
+		current = GetPartitionIndex(form->partstartvalue_ts,
+									form->partinterval_int,
+									form->partinterval_type,
+									INT_MAX, now);
+		if (current < 0)
+			continue;
+
+		wanted = Min((int64) current + count + 1,
+					 MAX_NUM_INTERVAL_PARTITIONS);
+		if (wanted <= form->partnparts)
+			continue;
+
+		nspname = get_namespace_name(get_rel_namespace(form->partrelid));
+		relname = get_rel_name(form->partrelid);
+		if (nspname == NULL || relname == NULL)
+			continue;
+
+		task = (IntervalPartitionTask *) palloc(sizeof(IntervalPartitionTask));
+		task->relname = pstrdup(quote_qualified_identifier(nspname, relname));
+		task->nparts = form->partnparts;
+		task->wanted = wanted;
+		tasks = lappend(tasks, task);
+	}
+
+	heap_endscan(scan);
+	heap_close(rel, AccessShareLock);
+
+	return tasks;
+}
+
+/*
+ * The command adding the partitions missing to a table that has 'nparts'.
+ */
+static char *
+interval_partition_command(IntervalPartitionTask *task, int nparts)
+{
+	return psprintf("ALTER TABLE %s ADD PARTITIONS %d",
+					task->relname, task->wanted - nparts);
+}
+
+/*
+ * The quoted names of the datanodes.
+ */
+static List *
+interval_partition_datanodes(void)
+{
+	Oid		   *coOids = NULL;
+	Oid		   *dnOids = NULL;
+	int			numCoords = 0;
+	int			numDns = 0;
+	int			i;
+	List	   *datanodes = NIL;
+
+	PgxcNodeGetOids(&coOids, &dnOids, &numCoords, &numDns, false);
+	for (i = 0; i < numDns; i++)
+	{
+		NodeDefinition *node = PgxcNodeGetDefinition(dnOids[i]);
+
+		if (node == NULL)
+			continue;
+		datanodes = lappend(datanodes,
+							pstrdup(quote_identifier(NameStr(node->nodename))));
+		pfree(node);
+	}
+
+	if (coOids)
+		pfree(coOids);
+	if (dnOids)
+		pfree(dnOids);
+
+	return datanodes;
+}
+
+/*
+ * Open a regular session on this coordinator to the given database, as
+ * interval_partition_precreate_role.  As for any client, its password is
+ * taken from the password file of the server's operating system user, or
+ * the one PGPASSFILE names.
+ */
+static PGconn *
+interval_partition_connect(const char *dbname)
+{
+	Oid		   *coOids = NULL;
+	Oid		   *dnOids = NULL;
+	int			numCoords = 0;
+	int			numDns = 0;
+	int			i;
+	NodeDefinition *self = NULL;
+	char		port[12];
+	const char *keywords[6];
+	const char *values[6];
+	PGconn	   *conn;
+
+	PgxcNodeGetOids(&coOids, &dnOids, &numCoords, &numDns, false);
+	for (i = 0; i < numCoords && self == NULL; i++)
+	{
+		NodeDefinition *node = PgxcNodeGetDefinition(coOids[i]);
+
+		if (node == NULL)
+			continue;
+		if (strcmp(NameStr(node->nodename), PGXCNodeName) == 0)
+			self = node;
+		else
+			pfree(node);
+	}
+
+	if (self == NULL)
+	{
+		ereport(LOG,
+				(errmsg("could not find coordinator \"%s\" to pre-create interval partitions",
+						PGXCNodeName)));
+		return NULL;
+	}
+
+	snprintf(port, sizeof(port), "%d", self->nodeport);
+
+	keywords[0] = "host";
+	values[0] = NameStr(self->nodehost);
+	keywords[1] = "port";
+	values[1] = port;
+	keywords[2] = "user";
+	values[2] = interval_partition_precreate_role;
+	keywords[3] = "dbname";
+	values[3] = dbname;
+	keywords[4] = "fallback_application_name";
+	values[4] = "interval partition worker";
+	keywords[5] = NULL;
+	values[5] = NULL;
+
+	conn = PQconnectdbParams(keywords, values, false);
+	if (PQstatus(conn) != CONNECTION_OK)
+	{
+		ereport(LOG,
+				(errmsg("could not connect to coordinator \"%s\" as \"%s\" to pre-create interval partitions: %s",
+						PGXCNodeName, interval_partition_precreate_role,
+						PQerrorMessage(conn))));
+		PQfinish(conn);
+		return NULL;
+	}
+
+	return conn;
+}
+
+/*
+ * Run a statement of the worker's session, logging its failure.
+ */
+static bool
+interval_partition_exec(PGconn *conn, const char *sql, ExecStatusType status)
+{
+	PGresult   *res;
+	bool		ok;
+
+	res = PQexec(conn, sql);
+	ok = (PQresultStatus(res) == status);
+	if (!ok)
+		ereport(LOG,
+				(errmsg("could not pre-create interval partitions with \"%s\": %s",
+						sql, PQerrorMessage(conn))));
+	PQclear(res);
+
+	return ok;
+}
+
+/*
+ * Add the partitions missing to a table, then get them ready on every node.
+ */
+static void
+interval_partition_add(PGconn *conn, IntervalPartitionTask *task,
+					   List *datanodes)
+{
+	char	   *relid = psprintf("%s::pg_catalog.regclass",
+								 quote_literal_cstr(task->relname));
+	char	   *sql;
+	char	   *command;
+	PGresult   *res;
+	int			nparts;
+	ListCell   *lc;
+
+	if (!interval_partition_exec(conn, "BEGIN", PGRES_COMMAND_OK))
+		return;
+
+	/*
+	 * Another coordinator may have added the partitions since they were
+	 * counted, if it took this one for down.
+	 */
+	sql = psprintf("LOCK TABLE %s IN SHARE UPDATE EXCLUSIVE MODE",
+				   task->relname);
+	if (!interval_partition_exec(conn, sql, PGRES_COMMAND_OK))
+	{
+		interval_partition_exec(conn, "ROLLBACK", PGRES_COMMAND_OK);
+		return;
+	}
+
+	sql = psprintf("SELECT partnparts FROM pg_catalog.pg_partition_interval WHERE partrelid = %s",
+				   relid);
+	res = PQexec(conn, sql);
+	if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) != 1)
+	{
+		ereport(LOG,
+				(errmsg("could not pre-create interval partitions with \"%s\": %s",
+						sql, PQerrorMessage(conn))));
+		PQclear(res);
+		interval_partition_exec(conn, "ROLLBACK", PGRES_COMMAND_OK);
+		return;
+	}
+	nparts = atoi(PQgetvalue(res, 0, 0));
+	PQclear(res);
+
+	if (nparts >= task->wanted)
+	{
+		interval_partition_exec(conn, "ROLLBACK", PGRES_COMMAND_OK);
+		return;
+	}
+
+	command = interval_partition_command(task, nparts);
+	if (!interval_partition_exec(conn, command, PGRES_COMMAND_OK))
+	{
+		interval_partition_exec(conn, "ROLLBACK", PGRES_COMMAND_OK);
+		return;
+	}
+	if (!interval_partition_exec(conn, "COMMIT", PGRES_COMMAND_OK))
+		return;
+
+	ereport(LOG,
+			(errmsg("pre-created interval partitions with \"%s\"", command)));
+
+	/* the first extents and catalog entries of the new partitions */
+	sql = psprintf("SELECT pg_catalog.pg_interval_partition_prepare(%s, %d)",
+				   relid, nparts);
+	interval_partition_exec(conn, sql, PGRES_TUPLES_OK);
+
+	foreach(lc, datanodes)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		interval_partition_exec(conn,
+								psprintf("EXECUTE DIRECT ON (%s) %s",
+										 (char *) lfirst(lc),
+										 quote_literal_cstr(sql)),
+								PGRES_TUPLES_OK);
+	}
+}
+
+/*
+ * pg_interval_partition_precreate_commands
+ *		The partitions the worker would add to the tables of the current
+ *		database at the given time, to cover its period and 'count' more.
+ */
+Datum
+pg_interval_partition_precreate_commands(PG_FUNCTION_ARGS)
+{
+#define INTERVAL_PARTITION_PRECREATE_COLS	4
+	Timestamp	now = PG_GETARG_TIMESTAMP(0);
+	int32		count = PG_GETARG_INT32(1);
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	TupleDesc	tupdesc;
+	Tuplestorestate *tupstore;
+	MemoryContext per_query_ctx;
+	MemoryContext oldcontext;
+	List	   *tasks;
+	ListCell   *lc;
+
+	/* check to see if caller supports us returning a tuplestore */
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+	if (!(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("materialize mode required, but it is not " \
+						"allowed in this context")));
+
+	if (count < 0 || count > MAX_NUM_INTERVAL_PARTITIONS)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("number of upcoming partitions must be between 0 and %d",
+						MAX_NUM_INTERVAL_PARTITIONS)));
+
+	/* Build a tuple descriptor for our result type */
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+	oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+	tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = tupdesc;
+	MemoryContextSwitchTo(oldcontext);
+
+	tasks = interval_partition_tasks(now, count);
+
+	foreach(lc, tasks)
+	{
+		IntervalPartitionTask *task = (IntervalPartitionTask *) lfirst(lc);
+		Datum		values[INTERVAL_PARTITION_PRECREATE_COLS];
+		bool		nulls[INTERVAL_PARTITION_PRECREATE_COLS];
+
+		MemSet(nulls, 0, sizeof(nulls));
+		values[0] = CStringGetTextDatum(task->relname);
+		values[1] = Int32GetDatum(task->nparts);
+		values[2] = Int32GetDatum(task->wanted);
+		values[3] = CStringGetTextDatum(interval_partition_command(task,
+																   task->nparts));
+
+		tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+	}
+
+	tuplestore_donestoring(tupstore);
+
+	return (Datum) 0;
+}
+
+/*
+ * pg_interval_partition_prepare
+ *		Get the partitions of an interval partitioned table from 'first' on
+ *		ready for their first rows.
+ *
+ * Their catalog entries and those of their indexes are read, and on a
+ * coordinator their locator entries, so that sessions find them in shared
+ * buffers when they build their own cache entries.  On a datanode, every
+ * shard of the node holding rows in the partition before them gets its
+ * first extent in each, which the first insert into the shard would
+ * otherwise have to write out.  Returns the number of extents added.
+ */
+Datum
+pg_interval_partition_prepare(PG_FUNCTION_ARGS)
+{
+	Oid			relid = PG_GETARG_OID(0);
+	int32		first = PG_GETARG_INT32(1);
+	Relation	rel;
+	Relation	prev = NULL;
+	Bitmapset  *shards = NULL;
+	int32		nextents = 0;
+	int			nparts;
+	int			i;
+
+	rel = heap_open(relid, AccessShareLock);
+
+	if (!RELATION_IS_INTERVAL(rel))
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("\"%s\" is not an interval partitioned table",
+						RelationGetRelationName(rel))));
+
+	if (!pg_class_ownercheck(relid, GetUserId()))
+		aclcheck_error(ACLCHECK_NOT_OWNER, ACL_KIND_CLASS,
+					   RelationGetRelationName(rel));
+
+	nparts = RelationGetNParts(rel);
+	first = Max(first, 0);
+
+	/* the shards of this datanode with rows in the partition before */
+	if (IS_PGXC_DATANODE && first > 0 && first < nparts)
+	{
+		Oid			prevoid = RelationGetPartition(rel, first - 1, false);
+
+		if (OidIsValid(prevoid))
+		{
+			prev = heap_open(prevoid, AccessShareLock);
+			if (RelationHasExtent(prev))
+			{
+				shards = (Bitmapset *) palloc0(SHARD_TABLE_BITMAP_SIZE);
+				if (CopyShardGroups_DN(shards) == NULL)
+				{
+					pfree(shards);
+					shards = NULL;
+				}
+			}
+		}
+	}
+
+	for (i = first; i < nparts; i++)
+	{
+		Oid			partoid = RelationGetPartition(rel, i, false);
+		Relation	part;
+		List	   *indexes;
+		ListCell   *lc;
+		int			sid;
+
+		if (!OidIsValid(partoid))
+			continue;
+
+		part = heap_open(partoid, RowExclusiveLock);
+
+		indexes = RelationGetIndexList(part);
+		foreach(lc, indexes)
+		{
+			Relation	index = index_open(lfirst_oid(lc), AccessShareLock);
+
+			index_close(index, AccessShareLock);
+		}
+		list_free(indexes);
+
+		if (shards != NULL && RelationHasExtent(part))
+		{
+			sid = -1;
+			while ((sid = bms_next_member(shards, sid)) >= 0)
+			{
+				CHECK_FOR_INTERRUPTS();
+
+				if (ExtentIdIsValid(GetShardScanHead(prev, sid)) &&
+					RelationPreextendShard(part, sid))
+					nextents++;
+			}
+		}
+
+		heap_close(part, RowExclusiveLock);
+	}
+
+	if (prev != NULL)
+		heap_close(prev, AccessShareLock);
+	heap_close(rel, AccessShareLock);
+
+	PG_RETURN_INT32(nextents);
+}
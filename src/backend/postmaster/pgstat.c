@@ -3614,6 +3614,9 @@ pgstat_get_wait_activity(WaitEventActivity w)
         case WAIT_EVENT_CLUSTER_MONITOR_MAIN:
             event_name = "ClusterMonitorMain";
             break;
+        case WAIT_EVENT_INTERVAL_PARTITION_MAIN:
+            event_name = "IntervalPartitionMain";
+            break;
             /* no default case, so that compiler will warn */
     }
 
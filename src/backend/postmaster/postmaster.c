@@ -125,6 +125,7 @@
 #include "postmaster/bgworker_internals.h"
 #include "postmaster/clean2pc.h"
 #include "postmaster/fork_process.h"
+#include "postmaster/partprecreate.h"
 #include "postmaster/pgarch.h"
 #include "postmaster/postmaster.h"
 #include "postmaster/syslogger.h"
@@ -1152,6 +1153,12 @@ PostmasterMain(int argc, char *argv[])
         */
     ApplyAuditFgaRegister();
 
+    /*
+     * Register the launcher of the workers creating interval partitions
+     * ahead of time.
+     */
+    IntervalPartitionLauncherRegister();
+
     /*
      * process any libraries that should be preloaded at postmaster start
      */
@@ -396,6 +396,9 @@ libpqrcv_startstreaming(WalReceiverConn *conn,
         PQfreemem(pubnames_literal);
         pfree(pubnames_str);
 
+        if (options->proto.logical.streaming)
+            appendStringInfoString(&cmd, ", streaming 'on'");
+
         appendStringInfoChar(&cmd, ')');
     }
     else
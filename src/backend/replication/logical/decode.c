@@ -163,6 +163,16 @@ LogicalDecodingProcessRecord(LogicalDecodingContext *ctx, XLogReaderState *recor
     buf.endptr = ctx->reader->EndRecPtr;
     buf.record = record;
 
+    /*
+     * If the toplevel transaction of a subtransaction was logged with this
+     * record, remember the assignment right away: an in-progress transaction
+     * may be streamed before it commits, and its subtransactions have to be
+     * known by then.
+     */
+    if (TransactionIdIsValid(XLogRecGetTopXid(record)))
+        ReorderBufferAssignChild(ctx->reorder, XLogRecGetTopXid(record),
+                                 XLogRecGetXid(record), buf.origptr);
+
     /* cast so we get a warning when new rmgrs are added */
     switch ((RmgrIds) XLogRecGetRmid(record))
     {
@@ -1258,7 +1268,7 @@ DecodeMultiInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
                 if (relationId != MyReplicationSlot->relid)
                 {
                     data += datalen;
-                    ReorderBufferReturnChange(ctx->reorder, change);
+                    ReorderBufferReturnChange(ctx->reorder, change, false);
                     continue;
                 }
         
@@ -1268,7 +1278,7 @@ DecodeMultiInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
                     if (!bms_is_member(xlhdr->t_shardid, MyReplicationSlot->shards))
                     {
                         data += datalen;
-                        ReorderBufferReturnChange(ctx->reorder, change);
+                        ReorderBufferReturnChange(ctx->reorder, change, false);
                         continue;
                     }
                 }
@@ -1291,7 +1301,7 @@ DecodeMultiInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
                 if (!found)
                 {
                     data += datalen;
-                    ReorderBufferReturnChange(ctx->reorder, change);
+                    ReorderBufferReturnChange(ctx->reorder, change, false);
                     continue;
                 }
             }
@@ -412,6 +412,9 @@ retry:
     TIMESTAMP_NOBEGIN(worker->last_recv_time);
     worker->reply_lsn = InvalidXLogRecPtr;
     TIMESTAMP_NOBEGIN(worker->reply_time);
+#ifdef __SUBSCRIPTION__
+    worker->fanout_handle = DSM_HANDLE_INVALID;
+#endif
 
     LWLockRelease(LogicalRepWorkerLock);
 
@@ -668,6 +671,9 @@ logicalrep_worker_cleanup(LogicalRepWorker *worker)
     worker->userid = InvalidOid;
     worker->subid = InvalidOid;
     worker->relid = InvalidOid;
+#ifdef __SUBSCRIPTION__
+    worker->fanout_handle = DSM_HANDLE_INVALID;
+#endif
 }
 
 /*
@@ -152,6 +152,133 @@ logicalrep_read_origin(StringInfo in, XLogRecPtr *origin_lsn)
     return pstrdup(pq_getmsgstring(in));
 }
 
+/*
+ * Write STREAM START to the output stream, which opens a block of changes of
+ * an in-progress transaction.
+ */
+void
+logicalrep_write_stream_start(StringInfo out, TransactionId xid,
+                              bool first_segment)
+{
+    Assert(TransactionIdIsValid(xid));
+
+    pq_sendbyte(out, 'S');        /* STREAM START */
+
+    /* transaction ID, and whether its earlier changes were ever sent */
+    pq_sendint(out, xid, 4);
+    pq_sendbyte(out, first_segment ? 1 : 0);
+}
+
+/*
+ * Read STREAM START from the output stream.
+ */
+TransactionId
+logicalrep_read_stream_start(StringInfo in, bool *first_segment)
+{
+    TransactionId xid;
+
+    xid = pq_getmsgint(in, 4);
+    *first_segment = (pq_getmsgbyte(in) == 1);
+
+    return xid;
+}
+
+/*
+ * Write STREAM STOP to the output stream.
+ */
+void
+logicalrep_write_stream_stop(StringInfo out)
+{
+    pq_sendbyte(out, 'E');        /* STREAM STOP */
+}
+
+/*
+ * Write STREAM SUBXACT to the output stream: the changes following it in the
+ * block belong to this (sub)transaction.
+ */
+void
+logicalrep_write_stream_subxact(StringInfo out, TransactionId subxid)
+{
+    Assert(TransactionIdIsValid(subxid));
+
+    pq_sendbyte(out, 'X');        /* STREAM SUBXACT */
+    pq_sendint(out, subxid, 4);
+}
+
+/*
+ * Read STREAM SUBXACT from the output stream.
+ */
+TransactionId
+logicalrep_read_stream_subxact(StringInfo in)
+{
+    return pq_getmsgint(in, 4);
+}
+
+/*
+ * Write STREAM ABORT to the output stream. The subtransaction is the
+ * toplevel one when the whole transaction aborted.
+ */
+void
+logicalrep_write_stream_abort(StringInfo out, TransactionId xid,
+                              TransactionId subxid)
+{
+    Assert(TransactionIdIsValid(xid) && TransactionIdIsValid(subxid));
+
+    pq_sendbyte(out, 'A');        /* STREAM ABORT */
+
+    pq_sendint(out, xid, 4);
+    pq_sendint(out, subxid, 4);
+}
+
+/*
+ * Read STREAM ABORT from the output stream.
+ */
+void
+logicalrep_read_stream_abort(StringInfo in, TransactionId *xid,
+                             TransactionId *subxid)
+{
+    *xid = pq_getmsgint(in, 4);
+    *subxid = pq_getmsgint(in, 4);
+}
+
+/*
+ * Write STREAM COMMIT to the output stream, with the same fields as COMMIT.
+ */
+void
+logicalrep_write_stream_commit(StringInfo out, ReorderBufferTXN *txn,
+                               XLogRecPtr commit_lsn)
+{
+    uint8        flags = 0;
+
+    pq_sendbyte(out, 'c');        /* STREAM COMMIT */
+
+    pq_sendint(out, txn->xid, 4);
+
+    /* send the flags field (unused for now) */
+    pq_sendbyte(out, flags);
+
+    /* send fields */
+    pq_sendint64(out, commit_lsn);
+    pq_sendint64(out, txn->end_lsn);
+    pq_sendint64(out, txn->commit_time);
+}
+
+/*
+ * Read STREAM COMMIT from the output stream.
+ */
+TransactionId
+logicalrep_read_stream_commit(StringInfo in, LogicalRepCommitData *commit_data)
+{
+    TransactionId xid;
+
+    xid = pq_getmsgint(in, 4);
+
+    /* read the commit fields, same as COMMIT */
+    logicalrep_read_commit(in, commit_data);
+
+    return xid;
+}
+
 /*
  * Write INSERT to the output stream.
  */
@@ -945,6 +1072,30 @@ bool logicalrep_dml_get_send_all(void)
     return logicalrep_dml_send_all;
 }
 
+/*
+ * Read the tuple hash of an INSERT, UPDATE or DELETE message, positioned
+ * after the action byte, without consuming the message.  The hash is the
+ * same for the old and the new tuple of an UPDATE, see pgoutput_change.
+ */
+int32 logicalrep_read_dml_hash(StringInfo in)
+{
+    StringInfoData msg = *in;
+    char        action;
+
+    /* relation id, namespace, name and replica identity */
+    (void) pq_getmsgint(&msg, 4);
+    (void) logicalrep_read_namespace(&msg);
+    (void) pq_getmsgstring(&msg);
+    (void) pq_getmsgbyte(&msg);
+
+    action = pq_getmsgbyte(&msg);
+    if (action != 'K' && action != 'O' && action != 'N')
+        elog(ERROR, "expected action 'N', 'O' or 'K', got %c",
+             action);
+
+    return pq_getmsgint(&msg, 4);
+}
+
 int32 logicalrep_dml_calc_hash(Relation rel, HeapTuple tuple)
 {// #lizard forgives
     TupleDesc    desc = NULL;
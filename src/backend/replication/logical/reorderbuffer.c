@@ -33,10 +33,13 @@
  *      smallest current LSN from the heap.
  *
  *      In order to cope with large transactions - which can be several times as
- *      big as the available memory - this module supports spooling the contents
- *      of a large transactions to disk. When the transaction is replayed the
- *      contents of individual (sub-)transactions will be read from disk in
- *      chunks.
+ *      big as the available memory - the size of the changes kept in memory is
+ *      bounded by logical_decoding_work_mem. When that limit is reached, the
+ *      largest transaction is either streamed to the output plugin before its
+ *      commit, if both the plugin and the transaction allow it (c.f.
+ *      ReorderBufferStreamTXN()), or its contents are spooled to disk. When a
+ *      spooled transaction is replayed the contents of individual
+ *      (sub-)transactions will be read from disk in chunks.
  *
  *      This module also has to deal with reassembling toast records from the
  *      individual chunks stored in WAL. When a new (or initial) version of a
@@ -64,7 +67,7 @@
 #include "replication/logical.h"
 #include "replication/reorderbuffer.h"
 #include "replication/slot.h"
-#include "replication/snapbuild.h"    /* just for SnapBuildSnapDecRefcount */
+#include "replication/snapbuild.h"
 #include "storage/bufmgr.h"
 #include "storage/fd.h"
 #include "storage/sinval.h"
@@ -139,16 +142,15 @@ typedef struct ReorderBufferDiskChange
 } ReorderBufferDiskChange;
 
 /*
- * Maximum number of changes kept in memory, per transaction. After that,
- * changes are spooled to disk.
- *
- * The current value should be sufficient to decode the entire transaction
- * without hitting disk in OLTP workloads, while starting to spool to disk in
- * other workloads reasonably fast.
- *
- * At some point in the future it probably makes sense to have a more elaborate
- * resource management here, but it's not entirely clear what that would look
- * like.
+ * Maximum amount of memory, in kB, used by the changes of all the decoded
+ * transactions. Beyond it, the largest transaction is streamed or spooled to
+ * disk, see ReorderBufferCheckMemoryLimit().
+ */
+int            logical_decoding_work_mem;
+
+/*
+ * Number of changes of a spooled (sub-)transaction read back from disk at a
+ * time, while it is replayed.
  */
 static const Size max_changes_in_memory = 4096;
 
@@ -192,7 +194,7 @@ static void ReorderBufferExecuteInvalidations(ReorderBuffer *rb, ReorderBufferTX
  * Disk serialization support functions
  * ---------------------------------------
  */
-static void ReorderBufferCheckSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn);
+static void ReorderBufferCheckMemoryLimit(ReorderBuffer *rb);
 static void ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn);
 static void ReorderBufferSerializeChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
                              int fd, ReorderBufferChange *change);
@@ -206,6 +208,25 @@ static void ReorderBufferFreeSnap(ReorderBuffer *rb, Snapshot snap);
 static Snapshot ReorderBufferCopySnap(ReorderBuffer *rb, Snapshot orig_snap,
                       ReorderBufferTXN *txn, CommandId cid);
 
+/* ---------------------------------------
+ * memory accounting and streaming of in-progress transactions
+ * ---------------------------------------
+ */
+static Size ReorderBufferChangeSize(ReorderBufferChange *change);
+static void ReorderBufferChangeMemoryUpdate(ReorderBuffer *rb,
+                                ReorderBufferChange *change, bool addition);
+static ReorderBufferTXN *ReorderBufferLargestTXN(ReorderBuffer *rb);
+static ReorderBufferTXN *ReorderBufferLargestTopTXN(ReorderBuffer *rb);
+static bool ReorderBufferCanStream(ReorderBuffer *rb);
+static bool ReorderBufferCanStreamTXN(ReorderBufferTXN *txn);
+static void ReorderBufferTransferSnapToParent(ReorderBufferTXN *txn,
+                                  ReorderBufferTXN *subtxn);
+static void ReorderBufferProcessTXN(ReorderBuffer *rb, ReorderBufferTXN *txn,
+                        XLogRecPtr commit_lsn, Snapshot snapshot_now,
+                        CommandId command_id, bool streaming);
+static void ReorderBufferStreamTXN(ReorderBuffer *rb, ReorderBufferTXN *txn);
+static void ReorderBufferTruncateTXN(ReorderBuffer *rb, ReorderBufferTXN *txn);
+
 /* ---------------------------------------
  * toast reassembly support
  * ---------------------------------------
@@ -264,6 +285,7 @@ ReorderBufferAllocate(void)
 
     buffer->outbuf = NULL;
     buffer->outbufsize = 0;
+    buffer->size = 0;
 
     buffer->current_restart_decoding_lsn = InvalidXLogRecPtr;
 
@@ -359,12 +381,20 @@ ReorderBufferGetChange(ReorderBuffer *rb)
 /*
  * Free an ReorderBufferChange.
  *
+ * upd_mem tells whether the change is still accounted for in the memory used
+ * by its transaction, see ReorderBufferChangeMemoryUpdate().
+ *
  * Deallocation might be delayed for efficiency purposes, for details check
  * the comments above max_cached_changes's definition.
  */
 void
-ReorderBufferReturnChange(ReorderBuffer *rb, ReorderBufferChange *change)
+ReorderBufferReturnChange(ReorderBuffer *rb, ReorderBufferChange *change,
+                          bool upd_mem)
 {// #lizard forgives
+    /* update memory accounting info */
+    if (upd_mem)
+        ReorderBufferChangeMemoryUpdate(rb, change, false);
+
     /* free contained data */
     switch (change->action)
     {
@@ -585,12 +615,17 @@ ReorderBufferQueueChange(ReorderBuffer *rb, TransactionId xid, XLogRecPtr lsn,
     txn = ReorderBufferTXNByXid(rb, xid, true, NULL, lsn, true);
 
     change->lsn = lsn;
+    change->txn = txn;
     Assert(InvalidXLogRecPtr != lsn);
     dlist_push_tail(&txn->changes, &change->node);
     txn->nentries++;
     txn->nentries_mem++;
 
-    ReorderBufferCheckSerializeTXN(rb, txn);
+    /* update memory accounting information */
+    ReorderBufferChangeMemoryUpdate(rb, change, true);
+
+    /* stream or spill to disk, if we exceeded the memory limit */
+    ReorderBufferCheckMemoryLimit(rb);
 }
 
 /*
@@ -709,32 +744,63 @@ ReorderBufferAssignChild(ReorderBuffer *rb, TransactionId xid,
     txn = ReorderBufferTXNByXid(rb, xid, true, &new_top, lsn, true);
     subtxn = ReorderBufferTXNByXid(rb, subxid, true, &new_sub, lsn, false);
 
-    if (new_sub)
-    {
-        /*
-         * we assign subtransactions to top level transaction even if we don't
-         * have data for it yet, assignment records frequently reference xids
-         * that have not yet produced any records. Knowing those aren't top
-         * level xids allows us to make processing cheaper in some places.
-         */
-        dlist_push_tail(&txn->subtxns, &subtxn->node);
-        txn->nsubtxns++;
-    }
-    else if (!subtxn->is_known_as_subxact)
+    /*
+     * The association is learnt both from assignment records and from the
+     * toplevel xid logged with the first record of each subtransaction, so
+     * it is usually already known.
+     */
+    if (!new_sub)
     {
-        subtxn->is_known_as_subxact = true;
-        Assert(subtxn->nsubtxns == 0);
+        if (subtxn->is_known_as_subxact)
+        {
+            if (new_top)
+                elog(ERROR, "existing subxact assigned to unknown toplevel xact");
+            return;
+        }
 
         /* remove from lsn order list of top-level transactions */
         dlist_delete(&subtxn->node);
-
-        /* add to toplevel transaction */
-        dlist_push_tail(&txn->subtxns, &subtxn->node);
-        txn->nsubtxns++;
     }
-    else if (new_top)
+
+    /*
+     * we assign subtransactions to top level transaction even if we don't
+     * have data for it yet, assignment records frequently reference xids
+     * that have not yet produced any records. Knowing those aren't top level
+     * xids allows us to make processing cheaper in some places.
+     */
+    subtxn->is_known_as_subxact = true;
+    subtxn->toptxn = txn;
+    Assert(subtxn->nsubtxns == 0);
+
+    /* add to toplevel transaction */
+    dlist_push_tail(&txn->subtxns, &subtxn->node);
+    txn->nsubtxns++;
+
+    /* possibly transfer the subtxn's snapshot to its toplevel txn */
+    ReorderBufferTransferSnapToParent(txn, subtxn);
+}
+
+/*
+ * Pass the base snapshot of a subtransaction to its toplevel transaction if
+ * the latter doesn't have one, or the subtransaction's is older. That can
+ * happen if there are no changes in the toplevel transaction but in one of
+ * the child transactions. This allows the parent to simply use its base
+ * snapshot initially, and to be streamed before its commit.
+ */
+static void
+ReorderBufferTransferSnapToParent(ReorderBufferTXN *txn,
+                                  ReorderBufferTXN *subtxn)
+{
+    if (subtxn->base_snapshot != NULL &&
+        (txn->base_snapshot == NULL ||
+         txn->base_snapshot_lsn > subtxn->base_snapshot_lsn))
     {
-        elog(ERROR, "existing subxact assigned to unknown toplevel xact");
+        if (txn->base_snapshot != NULL)
+            SnapBuildSnapDecRefcount(txn->base_snapshot);
+        txn->base_snapshot = subtxn->base_snapshot;
+        txn->base_snapshot_lsn = subtxn->base_snapshot_lsn;
+        subtxn->base_snapshot = NULL;
+        subtxn->base_snapshot_lsn = InvalidXLogRecPtr;
     }
 }
 
@@ -764,21 +830,7 @@ ReorderBufferCommitChild(ReorderBuffer *rb, TransactionId xid,
     if (txn == NULL)
         elog(ERROR, "subxact logged without previous toplevel record");
 
-    /*
-     * Pass our base snapshot to the parent transaction if it doesn't have
-     * one, or ours is older. That can happen if there are no changes in the
-     * toplevel transaction but in one of the child transactions. This allows
-     * the parent to simply use its base snapshot initially.
-     */
-    if (subtxn->base_snapshot != NULL &&
-        (txn->base_snapshot == NULL ||
-         txn->base_snapshot_lsn > subtxn->base_snapshot_lsn))
-    {
-        txn->base_snapshot = subtxn->base_snapshot;
-        txn->base_snapshot_lsn = subtxn->base_snapshot_lsn;
-        subtxn->base_snapshot = NULL;
-        subtxn->base_snapshot_lsn = InvalidXLogRecPtr;
-    }
+    ReorderBufferTransferSnapToParent(txn, subtxn);
 
     subtxn->final_lsn = commit_lsn;
     subtxn->end_lsn = end_lsn;
@@ -786,6 +838,7 @@ ReorderBufferCommitChild(ReorderBuffer *rb, TransactionId xid,
     if (!subtxn->is_known_as_subxact)
     {
         subtxn->is_known_as_subxact = true;
+        subtxn->toptxn = txn;
         Assert(subtxn->nsubtxns == 0);
 
         /* remove from lsn order list of top-level transactions */
@@ -973,7 +1026,7 @@ ReorderBufferIterTXNNext(ReorderBuffer *rb, ReorderBufferIterTXNState *state)
     {
         change = dlist_container(ReorderBufferChange, node,
                                  dlist_pop_head_node(&state->old_change));
-        ReorderBufferReturnChange(rb, change);
+        ReorderBufferReturnChange(rb, change, true);
         Assert(dlist_is_empty(&state->old_change));
     }
 
@@ -1059,7 +1112,7 @@ ReorderBufferIterTXNFinish(ReorderBuffer *rb,
 
         change = dlist_container(ReorderBufferChange, node,
                                  dlist_pop_head_node(&state->old_change));
-        ReorderBufferReturnChange(rb, change);
+        ReorderBufferReturnChange(rb, change, true);
         Assert(dlist_is_empty(&state->old_change));
     }
 
@@ -1077,6 +1130,23 @@ ReorderBufferCleanupTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
     bool        found;
     dlist_mutable_iter iter;
 
+    /*
+     * A streamed transaction may hold reassembled toast chunks and a pending
+     * speculative insertion between its runs. Free them first, they may
+     * belong to the subtransactions cleaned up below.
+     */
+    ReorderBufferToastReset(rb, txn);
+    if (txn->specinsert != NULL)
+    {
+        ReorderBufferReturnChange(rb, txn->specinsert, false);
+        txn->specinsert = NULL;
+    }
+    if (txn->snapshot_now != NULL)
+    {
+        ReorderBufferFreeSnap(rb, txn->snapshot_now);
+        txn->snapshot_now = NULL;
+    }
+
     /* cleanup subtransactions & their changes */
     dlist_foreach_modify(iter, &txn->subtxns)
     {
@@ -1102,7 +1172,7 @@ ReorderBufferCleanupTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 
         change = dlist_container(ReorderBufferChange, node, iter.cur);
 
-        ReorderBufferReturnChange(rb, change);
+        ReorderBufferReturnChange(rb, change, true);
     }
 
     /*
@@ -1115,7 +1185,7 @@ ReorderBufferCleanupTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 
         change = dlist_container(ReorderBufferChange, node, iter.cur);
         Assert(change->action == REORDER_BUFFER_CHANGE_INTERNAL_TUPLECID);
-        ReorderBufferReturnChange(rb, change);
+        ReorderBufferReturnChange(rb, change, true);
     }
 
     if (txn->base_snapshot != NULL)
@@ -1297,58 +1367,23 @@ ReorderBufferFreeSnap(ReorderBuffer *rb, Snapshot snap)
 }
 
 /*
- * Perform the replay of a transaction and it's non-aborted subtransactions.
+ * Replay the changes of a transaction and its subtransactions queued so far,
+ * in lsn order, to the output plugin, starting with the passed snapshot and
+ * command id.
  *
- * Subtransactions previously have to be processed by
- * ReorderBufferCommitChild(), even if previously assigned to the toplevel
- * transaction with ReorderBufferAssignChild.
- *
- * We currently can only decode a transaction's contents in when their commit
- * record is read because that's currently the only place where we know about
- * cache invalidations. Thus, once a toplevel commit is read, we iterate over
- * the top and subtransactions (using a k-way merge) and replay the changes in
- * lsn order.
+ * When streaming, the changes are sent between stream_start and stream_stop
+ * callbacks and freed, and the transaction is kept along with the state the
+ * next run resumes from, see ReorderBufferStreamTXN(). Otherwise the whole
+ * transaction is sent between begin and commit callbacks, and cleaned up.
  */
-void
-ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
-                    XLogRecPtr commit_lsn, XLogRecPtr end_lsn,
-                    TimestampTz commit_time,
-                    RepOriginId origin_id, XLogRecPtr origin_lsn)
+static void
+ReorderBufferProcessTXN(ReorderBuffer *rb, ReorderBufferTXN *txn,
+                        XLogRecPtr commit_lsn, volatile Snapshot snapshot_now,
+                        volatile CommandId command_id, bool streaming)
 {// #lizard forgives
-    ReorderBufferTXN *txn;
-    volatile Snapshot snapshot_now;
-    volatile CommandId command_id = FirstCommandId;
     bool        using_subtxn;
     ReorderBufferIterTXNState *volatile iterstate = NULL;
 
-    txn = ReorderBufferTXNByXid(rb, xid, false, NULL, InvalidXLogRecPtr,
-                                false);
-
-    /* unknown transaction, nothing to replay */
-    if (txn == NULL)
-        return;
-
-    txn->final_lsn = commit_lsn;
-    txn->end_lsn = end_lsn;
-    txn->commit_time = commit_time;
-    txn->origin_id = origin_id;
-    txn->origin_lsn = origin_lsn;
-
-    /*
-     * If this transaction didn't have any real changes in our database, it's
-     * OK not to have a snapshot. Note that ReorderBufferCommitChild will have
-     * transferred its snapshot to this transaction if it had one and the
-     * toplevel tx didn't.
-     */
-    if (txn->base_snapshot == NULL)
-    {
-        Assert(txn->ninvalidations == 0);
-        ReorderBufferCleanupTXN(rb, txn);
-        return;
-    }
-
-    snapshot_now = txn->base_snapshot;
-
     /* build data to be able to lookup the CommandIds of catalog tuples */
     ReorderBufferBuildTupleCidHash(rb, txn);
 
@@ -1370,14 +1405,20 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
     PG_TRY();
     {
         ReorderBufferChange *change;
-        ReorderBufferChange *specinsert = NULL;
+        ReorderBufferChange *specinsert = txn->specinsert;
+        XLogRecPtr    prev_lsn = InvalidXLogRecPtr;
+        bool        stream_started = false;
+
+        /* a pending insertion left by the previous run, if streamed */
+        txn->specinsert = NULL;
 
         if (using_subtxn)
             BeginInternalSubTransaction("replay");
         else
             StartTransactionCommand();
 
-        rb->begin(rb, txn);
+        if (!streaming)
+            rb->begin(rb, txn);
 
         iterstate = ReorderBufferIterTXNInit(rb, txn);
         while ((change = ReorderBufferIterTXNNext(rb, iterstate)) != NULL)
@@ -1385,6 +1426,15 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
             Relation    relation = NULL;
             Oid            reloid;
 
+            /* the first change opens the block of streamed changes */
+            if (streaming && !stream_started)
+            {
+                rb->stream_start(rb, txn, change->lsn);
+                stream_started = true;
+                txn->streamed = true;
+            }
+            prev_lsn = change->lsn;
+
             switch (change->action)
             {
                 case REORDER_BUFFER_CHANGE_INTERNAL_SPEC_CONFIRM:
@@ -1392,11 +1442,13 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
                     /*
                      * Confirmation for speculative insertion arrived. Simply
                      * use as a normal record. It'll be cleaned up at the end
-                     * of INSERT processing.
+                     * of INSERT processing. It is accounted for again while
+                     * it is applied, as toast reassembly may resize it.
                      */
                     Assert(specinsert->data.tp.oldtuple == NULL);
                     change = specinsert;
                     change->action = REORDER_BUFFER_CHANGE_INSERT;
+                    ReorderBufferChangeMemoryUpdate(rb, change, true);
 
                     /* intentionally fall through */
                 case REORDER_BUFFER_CHANGE_INSERT:
@@ -1444,7 +1496,10 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
                     if (!IsToastRelation(relation))
                     {
                         ReorderBufferToastReplace(rb, txn, relation, change);
-                        rb->apply_change(rb, txn, relation, change);
+                        if (streaming)
+                            rb->stream_change(rb, txn, relation, change);
+                        else
+                            rb->apply_change(rb, txn, relation, change);
 
                         /*
                          * Only clear reassembled toast chunks if we're sure
@@ -1495,9 +1550,12 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
                          * we're done remove it from the list of this
                          * transaction's changes. Otherwise it will get
                          * freed/reused while restoring spooled data from
-                         * disk.
+                         * disk. It is not accounted for anymore from then
+                         * on, as it may outlive the run of a streamed
+                         * transaction.
                          */
                         dlist_delete(&change->node);
+                        ReorderBufferChangeMemoryUpdate(rb, change, false);
                         ReorderBufferToastAppendChunk(rb, txn, relation,
                                                       change);
                     }
@@ -1510,7 +1568,8 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
                      */
                     if (specinsert != NULL)
                     {
-                        ReorderBufferReturnChange(rb, specinsert);
+                        ReorderBufferReturnChange(rb, specinsert,
+                                                  specinsert == change);
                         specinsert = NULL;
                     }
 
@@ -1539,20 +1598,30 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
                     /* clear out a pending (and thus failed) speculation */
                     if (specinsert != NULL)
                     {
-                        ReorderBufferReturnChange(rb, specinsert);
+                        ReorderBufferReturnChange(rb, specinsert, false);
                         specinsert = NULL;
                     }
 
-                    /* and memorize the pending insertion */
+                    /*
+                     * and memorize the pending insertion, which is not
+                     * accounted for until confirmed, like toast chunks
+                     */
                     dlist_delete(&change->node);
+                    ReorderBufferChangeMemoryUpdate(rb, change, false);
                     specinsert = change;
                     break;
 
                 case REORDER_BUFFER_CHANGE_MESSAGE:
-                    rb->message(rb, txn, change->lsn, true,
-                                change->data.msg.prefix,
-                                change->data.msg.message_size,
-                                change->data.msg.message);
+                    if (streaming)
+                        rb->stream_message(rb, txn, change->lsn, true,
+                                           change->data.msg.prefix,
+                                           change->data.msg.message_size,
+                                           change->data.msg.message);
+                    else
+                        rb->message(rb, txn, change->lsn, true,
+                                    change->data.msg.prefix,
+                                    change->data.msg.message_size,
+                                    change->data.msg.message);
                     break;
 
                 case REORDER_BUFFER_CHANGE_INTERNAL_SNAPSHOT:
@@ -1624,13 +1693,17 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
         }
 
         /*
-         * There's a speculative insertion remaining, just clean in up, it
-         * can't have been successful, otherwise we'd gotten a confirmation
-         * record.
+         * There's a speculative insertion remaining. When streaming, its
+         * confirmation may still be decoded, so keep it for the next run.
+         * Otherwise just clean it up, it can't have been successful, or we'd
+         * gotten a confirmation record.
          */
         if (specinsert)
         {
-            ReorderBufferReturnChange(rb, specinsert);
+            if (streaming)
+                txn->specinsert = specinsert;
+            else
+                ReorderBufferReturnChange(rb, specinsert, false);
             specinsert = NULL;
         }
 
@@ -1638,8 +1711,14 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
         ReorderBufferIterTXNFinish(rb, iterstate);
         iterstate = NULL;
 
-        /* call commit callback */
-        rb->commit(rb, txn, commit_lsn);
+        /* call stream stop or commit callback */
+        if (streaming)
+        {
+            if (stream_started)
+                rb->stream_stop(rb, txn, prev_lsn);
+        }
+        else
+            rb->commit(rb, txn, commit_lsn);
 
         /* this is just a sanity check against bad output plugin behaviour */
         if (GetCurrentTransactionIdIfAny() != InvalidTransactionId)
@@ -1663,11 +1742,32 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
         if (using_subtxn)
             RollbackAndReleaseCurrentSubTransaction();
 
-        if (snapshot_now->copied)
-            ReorderBufferFreeSnap(rb, snapshot_now);
+        if (streaming)
+        {
+            /*
+             * Remember the snapshot and command id the next run resumes
+             * from, and free the changes streamed so far.
+             */
+            Assert(snapshot_now->copied);
+            txn->snapshot_now = snapshot_now;
+            txn->command_id = command_id;
 
-        /* remove potential on-disk data, and deallocate */
-        ReorderBufferCleanupTXN(rb, txn);
+            if (txn->tuplecid_hash != NULL)
+            {
+                hash_destroy(txn->tuplecid_hash);
+                txn->tuplecid_hash = NULL;
+            }
+
+            ReorderBufferTruncateTXN(rb, txn);
+        }
+        else
+        {
+            if (snapshot_now->copied)
+                ReorderBufferFreeSnap(rb, snapshot_now);
+
+            /* remove potential on-disk data, and deallocate */
+            ReorderBufferCleanupTXN(rb, txn);
+        }
     }
     PG_CATCH();
     {
@@ -1700,6 +1800,162 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
     PG_END_TRY();
 }
 
+/*
+ * Perform the replay of a transaction and it's non-aborted subtransactions.
+ *
+ * Subtransactions previously have to be processed by
+ * ReorderBufferCommitChild(), even if previously assigned to the toplevel
+ * transaction with ReorderBufferAssignChild.
+ *
+ * We currently can only decode a transaction's contents in when their commit
+ * record is read because that's currently the only place where we know about
+ * cache invalidations. Thus, once a toplevel commit is read, we iterate over
+ * the top and subtransactions (using a k-way merge) and replay the changes in
+ * lsn order. Transactions already streamed before their commit only have the
+ * changes queued since their last run left to send.
+ */
+void
+ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
+                    XLogRecPtr commit_lsn, XLogRecPtr end_lsn,
+                    TimestampTz commit_time,
+                    RepOriginId origin_id, XLogRecPtr origin_lsn)
+{
+    ReorderBufferTXN *txn;
+
+    txn = ReorderBufferTXNByXid(rb, xid, false, NULL, InvalidXLogRecPtr,
+                                false);
+
+    /* unknown transaction, nothing to replay */
+    if (txn == NULL)
+        return;
+
+    txn->final_lsn = commit_lsn;
+    txn->end_lsn = end_lsn;
+    txn->commit_time = commit_time;
+    txn->origin_id = origin_id;
+    txn->origin_lsn = origin_lsn;
+
+    if (txn->streamed)
+    {
+        ReorderBufferStreamTXN(rb, txn);
+        rb->stream_commit(rb, txn, commit_lsn);
+        ReorderBufferCleanupTXN(rb, txn);
+        return;
+    }
+
+    /*
+     * If this transaction didn't have any real changes in our database, it's
+     * OK not to have a snapshot. Note that ReorderBufferCommitChild will have
+     * transferred its snapshot to this transaction if it had one and the
+     * toplevel tx didn't.
+     */
+    if (txn->base_snapshot == NULL)
+    {
+        Assert(txn->ninvalidations == 0);
+        ReorderBufferCleanupTXN(rb, txn);
+        return;
+    }
+
+    ReorderBufferProcessTXN(rb, txn, commit_lsn, txn->base_snapshot,
+                            FirstCommandId, false);
+}
+
+/*
+ * Send the changes of a toplevel transaction queued so far to the output
+ * plugin before its commit, and free them.
+ *
+ * Each run resumes from the snapshot and command id the previous one ended
+ * with. Changes to the catalog can't be streamed before the commit, as the
+ * cache invalidations are only known then, see ReorderBufferCanStreamTXN();
+ * the last run, at commit, may contain some.
+ */
+static void
+ReorderBufferStreamTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
+{
+    Snapshot    snapshot_now;
+    CommandId    command_id;
+    dlist_iter    iter;
+
+    Assert(!txn->is_known_as_subxact);
+
+    /* the changes may so far only be in subtransactions */
+    dlist_foreach(iter, &txn->subtxns)
+    {
+        ReorderBufferTXN *subtxn;
+
+        subtxn = dlist_container(ReorderBufferTXN, node, iter.cur);
+        ReorderBufferTransferSnapToParent(txn, subtxn);
+    }
+
+    if (txn->base_snapshot == NULL)
+    {
+        Assert(!txn->streamed);
+        return;
+    }
+
+    /*
+     * Copy the snapshot, also in later runs, as subtransactions may have been
+     * assigned since the previous one.
+     */
+    if (txn->snapshot_now == NULL)
+    {
+        command_id = FirstCommandId;
+        snapshot_now = ReorderBufferCopySnap(rb, txn->base_snapshot,
+                                             txn, command_id);
+    }
+    else
+    {
+        command_id = txn->command_id;
+        snapshot_now = ReorderBufferCopySnap(rb, txn->snapshot_now,
+                                             txn, command_id);
+        ReorderBufferFreeSnap(rb, txn->snapshot_now);
+        txn->snapshot_now = NULL;
+    }
+
+    ReorderBufferProcessTXN(rb, txn, InvalidXLogRecPtr, snapshot_now,
+                            command_id, true);
+}
+
+/*
+ * Free the changes of a transaction and its subtransactions once streamed,
+ * keeping the transactions themselves until their commit or abort.
+ */
+static void
+ReorderBufferTruncateTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
+{
+    dlist_mutable_iter iter;
+
+    dlist_foreach_modify(iter, &txn->subtxns)
+    {
+        ReorderBufferTXN *subtxn;
+
+        subtxn = dlist_container(ReorderBufferTXN, node, iter.cur);
+        ReorderBufferTruncateTXN(rb, subtxn);
+    }
+
+    dlist_foreach_modify(iter, &txn->changes)
+    {
+        ReorderBufferChange *change;
+
+        change = dlist_container(ReorderBufferChange, node, iter.cur);
+
+        dlist_delete(&change->node);
+        ReorderBufferReturnChange(rb, change, true);
+    }
+
+    /* remove entries spilled to disk */
+    if (txn->serialized)
+    {
+        ReorderBufferRestoreCleanup(rb, txn);
+        txn->serialized = false;
+    }
+
+    if (txn->nentries > 0)
+        txn->streamed = true;
+    txn->nentries = 0;
+    txn->nentries_mem = 0;
+}
+
 /*
  * Abort a transaction that possibly has previous changes. Needs to be first
  * called for subtransactions and then for the toplevel xid.
@@ -1727,6 +1983,10 @@ ReorderBufferAbort(ReorderBuffer *rb, TransactionId xid, XLogRecPtr lsn)
     /* cosmetic... */
     txn->final_lsn = lsn;
 
+    /* tell the output plugin to discard what it was sent of it */
+    if (txn->streamed)
+        rb->stream_abort(rb, txn, lsn);
+
     /* remove potential on-disk data, and deallocate */
     ReorderBufferCleanupTXN(rb, txn);
 }
@@ -1760,6 +2020,9 @@ ReorderBufferAbortOld(ReorderBuffer *rb, TransactionId oldestRunningXid)
         {
             elog(DEBUG2, "aborting old transaction %u", txn->xid);
 
+            if (txn->streamed)
+                rb->stream_abort(rb, txn, InvalidXLogRecPtr);
+
             /* remove potential on-disk data, and deallocate this tx */
             ReorderBufferCleanupTXN(rb, txn);
         }
@@ -1796,6 +2059,10 @@ ReorderBufferForget(ReorderBuffer *rb, TransactionId xid, XLogRecPtr lsn)
     /* cosmetic... */
     txn->final_lsn = lsn;
 
+    /* tell the output plugin to discard what it was sent of it */
+    if (txn->streamed)
+        rb->stream_abort(rb, txn, lsn);
+
     /*
      * Process cache invalidation messages if there are any. Even if we're not
      * interested in the transaction's contents, it could have manipulated the
@@ -2065,20 +2332,210 @@ ReorderBufferSerializeReserve(ReorderBuffer *rb, Size sz)
 }
 
 /*
- * Check whether the transaction tx should spill its data to disk.
+ * Size of a change and of the data it holds, as accounted for by
+ * ReorderBufferChangeMemoryUpdate().
+ */
+static Size
+ReorderBufferChangeSize(ReorderBufferChange *change)
+{
+    Size        sz = sizeof(ReorderBufferChange);
+
+    switch (change->action)
+    {
+        case REORDER_BUFFER_CHANGE_INSERT:
+        case REORDER_BUFFER_CHANGE_UPDATE:
+        case REORDER_BUFFER_CHANGE_DELETE:
+        case REORDER_BUFFER_CHANGE_INTERNAL_SPEC_INSERT:
+            if (change->data.tp.oldtuple)
+                sz += sizeof(HeapTupleData) +
+                    change->data.tp.oldtuple->tuple.t_len;
+            if (change->data.tp.newtuple)
+                sz += sizeof(HeapTupleData) +
+                    change->data.tp.newtuple->tuple.t_len;
+            break;
+        case REORDER_BUFFER_CHANGE_MESSAGE:
+            sz += strlen(change->data.msg.prefix) + 1 +
+                change->data.msg.message_size;
+            break;
+        case REORDER_BUFFER_CHANGE_INTERNAL_SNAPSHOT:
+            sz += sizeof(SnapshotData) +
+                sizeof(TransactionId) * change->data.snapshot->xcnt +
+                sizeof(TransactionId) * change->data.snapshot->subxcnt;
+            break;
+            /* no data in addition to the struct itself */
+        case REORDER_BUFFER_CHANGE_INTERNAL_SPEC_CONFIRM:
+        case REORDER_BUFFER_CHANGE_INTERNAL_COMMAND_ID:
+        case REORDER_BUFFER_CHANGE_INTERNAL_TUPLECID:
+            break;
+    }
+
+    return sz;
+}
+
+/*
+ * Add or subtract the size of a change to the memory used by its transaction
+ * and by the whole reorder buffer.
+ *
+ * Tuple cids are not accounted for: they are never spilled nor streamed, so
+ * counting them could only trigger pointless attempts at freeing memory.
  */
 static void
-ReorderBufferCheckSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
+ReorderBufferChangeMemoryUpdate(ReorderBuffer *rb,
+                                ReorderBufferChange *change, bool addition)
 {
-    /*
-     * TODO: improve accounting so we cheaply can take subtransactions into
-     * account here.
-     */
-    if (txn->nentries_mem >= max_changes_in_memory)
+    Size        sz;
+
+    if (change->action == REORDER_BUFFER_CHANGE_INTERNAL_TUPLECID)
+        return;
+
+    Assert(change->txn);
+
+    sz = ReorderBufferChangeSize(change);
+
+    if (addition)
+    {
+        change->txn->size += sz;
+        rb->size += sz;
+    }
+    else
+    {
+        Assert(change->txn->size >= sz && rb->size >= sz);
+        change->txn->size -= sz;
+        rb->size -= sz;
+    }
+}
+
+/*
+ * Make room once the changes held in memory reach logical_decoding_work_mem:
+ * stream the largest toplevel transaction to the output plugin if possible,
+ * otherwise spill the largest (sub)transaction to disk.
+ */
+static void
+ReorderBufferCheckMemoryLimit(ReorderBuffer *rb)
+{
+    ReorderBufferTXN *txn;
+
+    while (rb->size >= logical_decoding_work_mem * 1024L)
+    {
+        if (ReorderBufferCanStream(rb) &&
+            (txn = ReorderBufferLargestTopTXN(rb)) != NULL)
+        {
+            ReorderBufferStreamTXN(rb, txn);
+        }
+        else if ((txn = ReorderBufferLargestTXN(rb)) != NULL)
+        {
+            ReorderBufferSerializeTXN(rb, txn);
+            Assert(txn->nentries_mem == 0);
+        }
+        else
+            break;
+    }
+}
+
+/*
+ * Find the (sub)transaction with the most memory used by its changes.
+ */
+static ReorderBufferTXN *
+ReorderBufferLargestTXN(ReorderBuffer *rb)
+{
+    HASH_SEQ_STATUS hash_seq;
+    ReorderBufferTXNByIdEnt *ent;
+    ReorderBufferTXN *largest = NULL;
+
+    hash_seq_init(&hash_seq, rb->by_txn);
+    while ((ent = hash_seq_search(&hash_seq)) != NULL)
+    {
+        ReorderBufferTXN *txn = ent->txn;
+
+        if (txn->size > 0 && (largest == NULL || txn->size > largest->size))
+            largest = txn;
+    }
+
+    return largest;
+}
+
+/*
+ * Find the toplevel transaction that can be streamed with the most memory
+ * used by its own and its subtransactions' changes.
+ */
+static ReorderBufferTXN *
+ReorderBufferLargestTopTXN(ReorderBuffer *rb)
+{
+    dlist_iter    iter;
+    ReorderBufferTXN *largest = NULL;
+    Size        largest_size = 0;
+
+    dlist_foreach(iter, &rb->toplevel_by_lsn)
+    {
+        ReorderBufferTXN *txn;
+        dlist_iter    sub_iter;
+        Size        size;
+
+        txn = dlist_container(ReorderBufferTXN, node, iter.cur);
+
+        if (!ReorderBufferCanStreamTXN(txn))
+            continue;
+
+        size = txn->size;
+        dlist_foreach(sub_iter, &txn->subtxns)
+        {
+            ReorderBufferTXN *subtxn;
+
+            subtxn = dlist_container(ReorderBufferTXN, node, sub_iter.cur);
+            size += subtxn->size;
+        }
+
+        if (size > largest_size)
+        {
+            largest = txn;
+            largest_size = size;
+        }
+    }
+
+    return largest;
+}
+
+/*
+ * Can in-progress transactions be streamed at all? The output plugin has to
+ * support it, and only transactions decoded from a consistent snapshot past
+ * the point the client asked for are complete.
+ */
+static bool
+ReorderBufferCanStream(ReorderBuffer *rb)
+{
+    LogicalDecodingContext *ctx = rb->private_data;
+
+    return ctx->streaming &&
+        SnapBuildCurrentState(ctx->snapshot_builder) == SNAPBUILD_CONSISTENT &&
+        !SnapBuildXactNeedsSkip(ctx->snapshot_builder, ctx->reader->EndRecPtr);
+}
+
+/*
+ * Can this toplevel transaction be streamed? It needs a base snapshot, and
+ * no changes to the catalog, see ReorderBufferStreamTXN().
+ */
+static bool
+ReorderBufferCanStreamTXN(ReorderBufferTXN *txn)
+{
+    bool        has_snapshot = (txn->base_snapshot != NULL);
+    dlist_iter    iter;
+
+    if (txn->has_catalog_changes)
+        return false;
+
+    dlist_foreach(iter, &txn->subtxns)
     {
-        ReorderBufferSerializeTXN(rb, txn);
-        Assert(txn->nentries_mem == 0);
+        ReorderBufferTXN *subtxn;
+
+        subtxn = dlist_container(ReorderBufferTXN, node, iter.cur);
+
+        if (subtxn->has_catalog_changes)
+            return false;
+        if (subtxn->base_snapshot != NULL)
+            has_snapshot = true;
     }
+
+    return has_snapshot;
 }
 
 /*
@@ -2147,9 +2604,13 @@ ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
                                 path)));
         }
 
+        /* the transaction may be restored before its commit, if streamed */
+        if (txn->final_lsn < change->lsn)
+            txn->final_lsn = change->lsn;
+
         ReorderBufferSerializeChange(rb, txn, fd, change);
         dlist_delete(&change->node);
-        ReorderBufferReturnChange(rb, change);
+        ReorderBufferReturnChange(rb, change, true);
 
         spilled++;
     }
@@ -2348,7 +2809,7 @@ ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
         dlist_container(ReorderBufferChange, node, cleanup_iter.cur);
 
         dlist_delete(&cleanup->node);
-        ReorderBufferReturnChange(rb, cleanup);
+        ReorderBufferReturnChange(rb, cleanup, true);
     }
     txn->nentries_mem = 0;
     Assert(dlist_is_empty(&txn->changes));
@@ -2592,8 +3053,12 @@ ReorderBufferRestoreChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
             break;
     }
 
+    change->txn = txn;
     dlist_push_tail(&txn->changes, &change->node);
     txn->nentries_mem++;
+
+    /* update memory accounting information */
+    ReorderBufferChangeMemoryUpdate(rb, change, true);
 }
 
 /*
@@ -3010,9 +3475,14 @@ ReorderBufferToastReplace(ReorderBuffer *rb, ReorderBufferTXN *txn,
     Assert(newtup->tuple.t_len <= MaxHeapTupleSize);
     Assert(ReorderBufferTupleBufData(newtup) == newtup->tuple.t_data);
 
+    /* the change grows, update memory accounting */
+    ReorderBufferChangeMemoryUpdate(rb, change, false);
+
     memcpy(newtup->tuple.t_data, tmphtup->t_data, tmphtup->t_len);
     newtup->tuple.t_len = tmphtup->t_len;
 
+    ReorderBufferChangeMemoryUpdate(rb, change, true);
+
     /*
      * free resources we won't further need, more persistent stuff will be
      * free'd in ReorderBufferToastReset().
@@ -3058,7 +3528,7 @@ ReorderBufferToastReset(ReorderBuffer *rb, ReorderBufferTXN *txn)
             dlist_container(ReorderBufferChange, node, it.cur);
 
             dlist_delete(&change->node);
-            ReorderBufferReturnChange(rb, change);
+            ReorderBufferReturnChange(rb, change, false);
         }
     }
 
@@ -70,6 +70,7 @@
 
 #include "rewrite/rewriteHandler.h"
 
+#include "storage/buffile.h"
 #include "storage/bufmgr.h"
 #include "storage/ipc.h"
 #include "storage/lmgr.h"
@@ -94,8 +95,13 @@
 #endif
 
 #ifdef __SUBSCRIPTION__
+#include "catalog/pg_type.h"
 #include "pgxc/pgxcnode.h"
 #include "pgxc/execRemote.h"
+#include "pgxc/nodemgr.h"
+#include "storage/shm_mq.h"
+#include "storage/spin.h"
+#include "utils/pg_lsn.h"
 #endif
 
 #include "commands/dbcommands.h"
@@ -137,6 +143,152 @@ static void maybe_reread_subscription(void);
 /* Flags set by signal handlers */
 static volatile sig_atomic_t got_SIGHUP = false;
 
+#ifdef __SUBSCRIPTION__
+bool        logical_apply_fanout = false;
+
+/*
+ * Fan-out of a parallel OpenTenBase subscription.
+ *
+ * Otherwise, the worker of each of the opentenbase-sub-subscriptions of a
+ * parallel subscription streams from its own slot, and the publisher decodes
+ * the whole WAL once per worker to send it the changes of its tuple hash.
+ * With logical_apply_fanout, the worker of the first sub-subscription is the
+ * only one to stream: it receives every change, applies those of hash 0 and
+ * passes the others to the worker of that parallel_index through a shm_mq.
+ * The other messages, BEGIN and COMMIT included, go to every worker, so
+ * that each one applies its share of the transactions in commit order, as
+ * if it streamed from its own slot.
+ *
+ * The receiver reports to the publisher the oldest position flushed by any
+ * worker.  It can not stream from before the confirmed position of its own
+ * slot, so a worker whose slot is behind that keeps streaming from its slot
+ * until it has flushed everything up to there, and only then switches to
+ * its queue.  Each worker skips the transactions it had already applied.
+ */
+typedef enum ApplyFanoutRole
+{
+    APPLY_FANOUT_NONE,
+    APPLY_FANOUT_RECEIVER,        /* streams and dispatches the changes */
+    APPLY_FANOUT_WORKER            /* reads its queue */
+} ApplyFanoutRole;
+
+typedef struct ApplyFanoutShared
+{
+    slock_t        mutex;
+    int            nworkers;        /* parallel_number of the subscription */
+    XLogRecPtr    startpos;        /* where the receiver streams from */
+    XLogRecPtr    flush_lsn[FLEXIBLE_ARRAY_MEMBER];    /* by parallel_index */
+} ApplyFanoutShared;
+
+#define APPLY_FANOUT_QUEUE_SIZE        (1024 * 1024)
+
+/* the queue to the worker of parallel_index 'index', from 1 */
+#define ApplyFanoutQueue(shared, index) \
+    ((shm_mq *) ((char *) (shared) + \
+                 MAXALIGN(offsetof(ApplyFanoutShared, flush_lsn) + \
+                          sizeof(XLogRecPtr) * (shared)->nworkers) + \
+                 ((Size) (index) - 1) * APPLY_FANOUT_QUEUE_SIZE))
+
+static ApplyFanoutRole fanout_role = APPLY_FANOUT_NONE;
+static ApplyFanoutShared *fanout_shared = NULL;
+static shm_mq_handle **fanout_queues = NULL;    /* receiver, by parallel_index */
+static shm_mq_handle *fanout_queue = NULL;        /* worker */
+static dsm_segment *fanout_segment = NULL;        /* worker */
+
+/* a worker streams from its own slot until it has flushed this */
+static XLogRecPtr fanout_catchup_lsn = InvalidXLogRecPtr;
+
+/* transactions committed before were applied by this worker already */
+static XLogRecPtr fanout_skip_lsn = InvalidXLogRecPtr;
+static bool skip_remote_xact = false;
+
+static bool apply_fanout_wanted(void);
+static XLogRecPtr apply_fanout_slot_confirmed(char *slotname);
+static XLogRecPtr apply_fanout_setup_receiver(XLogRecPtr origin_startpos);
+static void apply_fanout_setup_worker(void);
+static void apply_fanout_attach(void);
+static void apply_fanout_switch(void);
+static void apply_fanout_send(int index, char *buf, int len);
+static void apply_fanout_dispatch(StringInfo s, char *buf, int len);
+static int    apply_fanout_receive(char **buffer);
+
+/*
+ * Batched apply on the datanodes.
+ *
+ * On a coordinator, the changes of a distributed table are applied by the
+ * datanodes their tuple goes to.  Rather than waiting for the datanode to
+ * apply each change before reading the next one, the changes of the
+ * remote transaction are queued per datanode and sent by batches of
+ * logical_apply_batch_size, a datanode applying a batch while the next one
+ * is being queued.  Everything queued is applied before anything else
+ * touches the datanodes, and before the commit.
+ *
+ * The datanode reports the change of the batch that failed in the context
+ * of its error, which is passed on.
+ */
+int            logical_apply_batch_size = 100;
+
+#define APPLY_BATCH_MAX_BYTES        (1024 * 1024)
+
+typedef struct ApplyBatch
+{
+    StringInfoData buf;            /* changes queued, each after its length */
+    int            nchanges;
+    PGXCNodeHandle *inflight;    /* waiting for the ApplyDone of a batch */
+} ApplyBatch;
+
+static ApplyBatch *apply_batches = NULL;    /* by datanode index */
+static int    apply_nbatches = 0;
+static bool apply_batch_pending = false;
+
+static bool apply_batch_wanted(void);
+static void apply_batch_add(StringInfo s, ExecNodes *exec_nodes);
+static void apply_batch_send(int nodeidx);
+static void apply_batch_wait(int nodeidx);
+static void apply_batch_flush(void);
+#endif
+
+/*
+ * Streamed transactions.
+ *
+ * With logical_apply_streaming, the publisher sends the changes of a large
+ * transaction by blocks while it is still in progress, instead of spilling
+ * them to disk and sending them all after its commit.  The messages of each
+ * block are written to a temporary file of the transaction as they come, and
+ * applied all at once when its commit is received, so transactions are still
+ * applied in commit order; the worker merely does not wait for the commit to
+ * receive their changes.  The position of the first change of each
+ * subtransaction is remembered, for an aborted one to truncate the file
+ * there: what follows can only belong to it or to its own subtransactions.
+ */
+bool        logical_apply_streaming = false;
+
+typedef struct ApplyStreamSubXact
+{
+    TransactionId xid;
+    int            fileno;            /* where its first change was written */
+    off_t        offset;
+} ApplyStreamSubXact;
+
+typedef struct ApplyStreamXact
+{
+    TransactionId xid;
+    BufFile    *file;            /* messages received, see apply_stream_write */
+    int            fileno;            /* end of the messages */
+    off_t        offset;
+    List       *subxacts;        /* ApplyStreamSubXact, by first change */
+} ApplyStreamXact;
+
+static List *apply_stream_xacts = NIL;    /* neither committed nor aborted */
+static ApplyStreamXact *apply_stream_cur = NULL;    /* in a block of this one */
+
+static ApplyStreamXact *apply_stream_find(TransactionId xid);
+static void apply_stream_write(StringInfo s);
+static void apply_stream_read(ApplyStreamXact *xact, void *ptr, size_t size);
+static void apply_stream_replay(ApplyStreamXact *xact);
+static void apply_stream_discard(ApplyStreamXact *xact);
+static void apply_dispatch(StringInfo s);
+
 /*
  * Should this worker apply changes for given relation.
  *
@@ -663,6 +815,13 @@ apply_exec_on_nodes(StringInfo s, char *nspname, char *relname, ExecNodes * exec
 	if (exec_nodes == NULL)
 		return;
 
+	/* queue the change for the datanodes, they will apply it later on */
+	if (apply_batch_wanted())
+	{
+		apply_batch_add(s, exec_nodes);
+		return;
+	}
+
 	/* send apply message to DN and wait response */
 	all_handles = get_handles(exec_nodes->nodeList, NIL, false, true, true);
 
@@ -672,6 +831,273 @@ apply_exec_on_nodes(StringInfo s, char *nspname, char *relname, ExecNodes * exec
     pfree_pgxc_all_handles(all_handles);
 }
 
+/*
+ * Are the changes of this worker to be applied on the datanodes by batches?
+ * A change whose primary key conflicts is skipped by aborting the apply of
+ * its message alone, so it can not be part of a batch.
+ */
+static bool
+apply_batch_wanted(void)
+{
+    return logical_apply_batch_size > 1 &&
+            !am_tablesync_worker() &&
+            !MySubscription->ignore_pk_conflict;
+}
+
+/*
+ * Queue the change in s for each of the datanodes of exec_nodes, and send
+ * the batches that are full.
+ */
+static void
+apply_batch_add(StringInfo s, ExecNodes *exec_nodes)
+{
+    ListCell   *lc;
+
+    if (apply_nbatches < NumDataNodes)
+    {
+        MemoryContext oldcontext = MemoryContextSwitchTo(ApplyContext);
+        int            i;
+
+        /* only grown between remote transactions, with nothing queued */
+        Assert(!apply_batch_pending);
+        if (apply_batches == NULL)
+            apply_batches = (ApplyBatch *) palloc0(sizeof(ApplyBatch) * NumDataNodes);
+        else
+            apply_batches = (ApplyBatch *) repalloc(apply_batches,
+                                                    sizeof(ApplyBatch) * NumDataNodes);
+        for (i = apply_nbatches; i < NumDataNodes; i++)
+        {
+            initStringInfo(&apply_batches[i].buf);
+            apply_batches[i].nchanges = 0;
+            apply_batches[i].inflight = NULL;
+        }
+        apply_nbatches = NumDataNodes;
+
+        MemoryContextSwitchTo(oldcontext);
+    }
+
+    foreach(lc, exec_nodes->nodeList)
+    {
+        int            nodeidx = lfirst_int(lc);
+        ApplyBatch *batch;
+
+        Assert(nodeidx >= 0 && nodeidx < apply_nbatches);
+        batch = &apply_batches[nodeidx];
+
+        pq_sendint(&batch->buf, s->len, 4);
+        appendBinaryStringInfo(&batch->buf, s->data, s->len);
+        batch->nchanges++;
+        apply_batch_pending = true;
+
+        if (batch->nchanges >= logical_apply_batch_size ||
+            batch->buf.len >= APPLY_BATCH_MAX_BYTES)
+            apply_batch_send(nodeidx);
+    }
+}
+
+/*
+ * Send the changes queued for a datanode, once it has applied the previous
+ * batch.
+ */
+static void
+apply_batch_send(int nodeidx)
+{
+    ApplyBatch *batch = &apply_batches[nodeidx];
+    PGXCNodeAllHandles *all_handles;
+    PGXCNodeHandle *handle;
+
+    if (batch->inflight != NULL)
+        apply_batch_wait(nodeidx);
+
+    if (batch->nchanges == 0)
+        return;
+
+    all_handles = get_handles(list_make1_int(nodeidx), NIL, false, true, true);
+    Assert(all_handles->dn_conn_count == 1);
+    handle = all_handles->datanode_handles[0];
+    pfree_pgxc_all_handles(all_handles);
+
+    if (handle->sock == PGINVALID_SOCKET ||
+        pgxc_node_send_apply_batch(handle, batch->buf.data, batch->buf.len,
+                                   batch->nchanges, false))
+        ereport(ERROR,
+                (errcode(ERRCODE_INTERNAL_ERROR),
+                 errmsg("failed to send a batch of %d changes to datanode %s",
+                        batch->nchanges, handle->nodename)));
+
+    batch->inflight = handle;
+    resetStringInfo(&batch->buf);
+    batch->nchanges = 0;
+}
+
+/*
+ * Report the error of a datanode along with its context, which tells the
+ * change it failed to apply.
+ */
+static void
+apply_batch_error_callback(void *arg)
+{
+    ResponseCombiner *combiner = (ResponseCombiner *) arg;
+
+    if (combiner->errorContext)
+        errcontext("%s", combiner->errorContext);
+}
+
+/*
+ * Wait for a datanode to have applied the batch sent to it.
+ */
+static void
+apply_batch_wait(int nodeidx)
+{
+    ApplyBatch *batch = &apply_batches[nodeidx];
+    ResponseCombiner combiner;
+    ErrorContextCallback errcallback;
+    int            result;
+
+    InitResponseCombiner(&combiner, 1, COMBINE_TYPE_NONE);
+
+    result = pgxc_node_receive_responses(1, &batch->inflight, NULL, &combiner);
+    if (result || combiner.errorMessage || !validate_combiner(&combiner))
+    {
+        if (combiner.errorMessage)
+        {
+            errcallback.callback = apply_batch_error_callback;
+            errcallback.arg = (void *) &combiner;
+            errcallback.previous = error_context_stack;
+            error_context_stack = &errcallback;
+
+            pgxc_node_report_error(&combiner);
+        }
+
+        ereport(ERROR,
+                (errcode(ERRCODE_INTERNAL_ERROR),
+                 errmsg("failed to apply a batch of changes on datanode %s in database %s",
+                        batch->inflight->nodename, get_database_name(MyDatabaseId))));
+    }
+
+    CloseCombiner(&combiner);
+    batch->inflight = NULL;
+}
+
+/*
+ * Have the datanodes apply all the changes queued for them.
+ */
+static void
+apply_batch_flush(void)
+{
+    int            i;
+
+    if (!apply_batch_pending)
+        return;
+
+    /* send all the batches first, so that the datanodes work together */
+    for (i = 0; i < apply_nbatches; i++)
+    {
+        if (apply_batches[i].nchanges > 0)
+            apply_batch_send(i);
+    }
+
+    for (i = 0; i < apply_nbatches; i++)
+    {
+        if (apply_batches[i].inflight != NULL)
+            apply_batch_wait(i);
+    }
+
+    apply_batch_pending = false;
+}
+
+/*
+ * DN: error context of the apply of a batch of changes.
+ */
+typedef struct ApplyBatchErrorArg
+{
+    int            index;
+    int            nchanges;
+    char        action;
+    char       *nspname;
+    char       *relname;
+    XLogRecPtr    lsn;
+} ApplyBatchErrorArg;
+
+static void
+apply_batch_change_error_callback(void *arg)
+{
+    ApplyBatchErrorArg *errarg = (ApplyBatchErrorArg *) arg;
+    const char *action;
+
+    switch (errarg->action)
+    {
+        case 'I':
+            action = "INSERT";
+            break;
+        case 'U':
+            action = "UPDATE";
+            break;
+        case 'D':
+            action = "DELETE";
+            break;
+        default:
+            action = "change";
+            break;
+    }
+
+    errcontext("applying remote %s on replication target relation \"%s.%s\" at %X/%X, change %d of %d in the batch",
+               action, errarg->nspname, errarg->relname,
+               (uint32) (errarg->lsn >> 32), (uint32) errarg->lsn,
+               errarg->index + 1, errarg->nchanges);
+}
+
+/*
+ * Logical apply of a batch of changes for DN: pgxc_node_send_apply_batch.
+ */
+void
+logical_apply_dispatch_batch(StringInfo s)
+{
+    ApplyBatchErrorArg errarg;
+    ErrorContextCallback errcallback;
+    int            i;
+
+    errarg.nchanges = pq_getmsgint(s, 4);
+
+    errcallback.callback = apply_batch_change_error_callback;
+    errcallback.arg = (void *) &errarg;
+    errcallback.previous = error_context_stack;
+
+    for (i = 0; i < errarg.nchanges; i++)
+    {
+        StringInfoData change;
+        StringInfoData peek;
+        int            len;
+
+        len = pq_getmsgint(s, 4);
+        change.data = (char *) pq_getmsgbytes(s, len);
+        change.len = len;
+        change.cursor = 0;
+        change.maxlen = -1;
+
+        if (pq_getmsgbyte(&change) != 'w')    /* WalSndPrepareWrite */
+            ereport(ERROR,
+                    (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                     errmsg("invalid logical apply batch message")));
+
+        errarg.index = i;
+        errarg.lsn = pq_getmsgint64(&change);    /* start_lsn */
+        (void) pq_getmsgint64(&change);            /* end_lsn */
+        (void) pq_getmsgint64(&change);            /* send_time */
+
+        /* action, relid, namespace and name of the relation */
+        peek = change;
+        errarg.action = pq_getmsgbyte(&peek);
+        (void) pq_getmsgint(&peek, 4);
+        errarg.nspname = (char *) pq_getmsgstring(&peek);
+        errarg.relname = (char *) pq_getmsgstring(&peek);
+
+        error_context_stack = &errcallback;
+        logical_apply_dispatch(&change);
+        error_context_stack = errcallback.previous;
+    }
+}
+
 static bool 
 check_if_ican_apply(int32 tuple_hash)
 {// #lizard forgives
@@ -730,11 +1156,18 @@ apply_handle_begin(StringInfo s)
 
     remote_final_lsn = begin_data.final_lsn;
 
+#ifdef __SUBSCRIPTION__
+    /* applied before the receiver restarted from an older position */
+    skip_remote_xact = begin_data.final_lsn < fanout_skip_lsn;
+#endif
+
     in_remote_transaction = true;
 
     pgstat_report_activity(STATE_RUNNING, NULL);
 }
 
+static void apply_handle_commit_internal(LogicalRepCommitData *commit_data);
+
 /*
  * Handle COMMIT message.
  *
@@ -749,6 +1182,20 @@ apply_handle_commit(StringInfo s)
 
     Assert(commit_data.commit_lsn == remote_final_lsn);
 
+    apply_handle_commit_internal(&commit_data);
+}
+
+/*
+ * Commit the remote transaction applied, for COMMIT and STREAM COMMIT.
+ */
+static void
+apply_handle_commit_internal(LogicalRepCommitData *commit_data)
+{
+#ifdef __SUBSCRIPTION__
+    /* the datanodes must have applied all the changes before the commit */
+    apply_batch_flush();
+#endif
+
     /* The synchronization worker runs in single transaction. */
     if (IsTransactionState() && !am_tablesync_worker())
     {
@@ -769,13 +1216,13 @@ apply_handle_commit(StringInfo s)
          * Update origin state so we can restart streaming from correct
          * position in case of crash.
          */
-        replorigin_session_origin_lsn = commit_data.end_lsn;
-        replorigin_session_origin_timestamp = commit_data.committime;
+        replorigin_session_origin_lsn = commit_data->end_lsn;
+        replorigin_session_origin_timestamp = commit_data->committime;
 
         CommitTransactionCommand();
         pgstat_report_stat(false);
 
-        store_flush_position(commit_data.end_lsn);
+        store_flush_position(commit_data->end_lsn);
     }
     else
     {
@@ -787,7 +1234,7 @@ apply_handle_commit(StringInfo s)
     in_remote_transaction = false;
 
     /* Process any tables that are being synchronized in parallel. */
-    process_syncing_tables(commit_data.end_lsn);
+    process_syncing_tables(commit_data->end_lsn);
 
     pgstat_report_activity(STATE_IDLE, NULL);
 }
@@ -838,6 +1285,9 @@ apply_handle_relation(StringInfo s)
 
         ensure_transaction();
 
+		/* the queued changes were decoded with the previous definition */
+		apply_batch_flush();
+
 		/* get all DN handles */
 		connections = get_exec_connections_all_dn(true);
 
@@ -950,6 +1400,9 @@ apply_handle_insert(StringInfo s)
         CommandCounterIncrement();
         return;
     }
+
+    /* the datanodes must have applied the changes queued before this one */
+    apply_batch_flush();
 #endif
 
     /* Initialize the executor state. */
@@ -1112,6 +1565,9 @@ apply_handle_update(StringInfo s)
         CommandCounterIncrement();
         return;
     }
+
+    /* the datanodes must have applied the changes queued before this one */
+    apply_batch_flush();
 #endif
 
     /* Initialize the executor state. */
@@ -1289,6 +1745,9 @@ apply_handle_delete(StringInfo s)
         CommandCounterIncrement();
         return;
     }
+
+    /* the datanodes must have applied the changes queued before this one */
+    apply_batch_flush();
 #endif
 
     /* Initialize the executor state. */
@@ -1374,78 +1833,432 @@ apply_handle_delete(StringInfo s)
 
 
 /*
- * Logical replication protocol message dispatcher for CN.
+ * Handle STREAM START message: the messages up to STREAM STOP are changes of
+ * an in-progress transaction, kept until it commits.
  */
 static void
-apply_dispatch(StringInfo s)
-{// #lizard forgives
-    char        action = pq_getmsgbyte(s);
+apply_handle_stream_start(StringInfo s)
+{
+    TransactionId xid;
+    bool        first_segment;
+    ApplyStreamXact *xact;
+    MemoryContext oldctx;
 
-    switch (action)
+    if (in_remote_transaction || apply_stream_cur != NULL)
+        ereport(ERROR,
+                (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                 errmsg("STREAM START message sent out of order")));
+
+    xid = logicalrep_read_stream_start(s, &first_segment);
+
+    if (!TransactionIdIsValid(xid))
+        ereport(ERROR,
+                (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                 errmsg("invalid transaction ID in streamed replication transaction")));
+
+    /* the publisher starts over after it restarted decoding */
+    xact = apply_stream_find(xid);
+    if (xact != NULL && first_segment)
     {
-            /* BEGIN */
-        case 'B':
-            apply_handle_begin(s);
-            break;
-            /* COMMIT */
-        case 'C':
-            apply_handle_commit(s);
-            break;
-            /* INSERT */
-        case 'I':
-            apply_handle_insert(s);
-            break;
-            /* UPDATE */
-        case 'U':
-            apply_handle_update(s);
-            break;
-            /* DELETE */
-        case 'D':
-            apply_handle_delete(s);
-            break;
-            /* RELATION */
-        case 'R':
-            apply_handle_relation(s);
-            break;
-            /* TYPE */
-        case 'Y':
-            apply_handle_type(s);
-            break;
-            /* ORIGIN */
-        case 'O':
-            apply_handle_origin(s);
-            break;
-        default:
-            {
-                ereport(ERROR,
-                        (errcode(ERRCODE_PROTOCOL_VIOLATION),
-                         errmsg("invalid logical replication message type %c", action)));
-            }
+        apply_stream_discard(xact);
+        xact = NULL;
+    }
+
+    if (xact == NULL)
+    {
+        if (!first_segment)
+            ereport(ERROR,
+                    (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                     errmsg("earlier changes of streamed transaction %u were not received",
+                            xid)));
+
+        oldctx = MemoryContextSwitchTo(ApplyContext);
+        xact = (ApplyStreamXact *) palloc0(sizeof(ApplyStreamXact));
+        xact->xid = xid;
+        xact->file = BufFileCreateTemp(true);
+        apply_stream_xacts = lappend(apply_stream_xacts, xact);
+        MemoryContextSwitchTo(oldctx);
     }
+
+    /* append to the messages received so far */
+    if (BufFileSeek(xact->file, xact->fileno, xact->offset, SEEK_SET) != 0)
+        ereport(ERROR,
+                (errcode_for_file_access(),
+                 errmsg("could not seek in file of streamed transaction %u: %m",
+                        xid)));
+
+    apply_stream_cur = xact;
 }
 
-#ifdef __SUBSCRIPTION__
 /*
- * Logical apply protocol message dispatcher for DN.
+ * Handle STREAM STOP message.
  */
-void logical_apply_dispatch(StringInfo s)
+static void
+apply_handle_stream_stop(StringInfo s)
 {
-	char action = pq_getmsgbyte(s);
+    if (apply_stream_cur == NULL)
+        ereport(ERROR,
+                (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                 errmsg("STREAM STOP message without STREAM START")));
 
-	OpenTenBaseSubscriptionApplyWorkerSet();
+    apply_stream_cur = NULL;
+}
 
-	switch (action)
-	{
-			/* INSERT */
-		case 'I':
-			apply_handle_insert(s);
-			break;
-			/* UPDATE */
-		case 'U':
-			apply_handle_update(s);
-			break;
-			/* DELETE */
-		case 'D':
+/*
+ * Handle STREAM SUBXACT message: remember where the changes of a
+ * subtransaction start.
+ */
+static void
+apply_handle_stream_subxact(StringInfo s)
+{
+    ApplyStreamXact *xact = apply_stream_cur;
+    ApplyStreamSubXact *subxact;
+    TransactionId subxid;
+    ListCell   *lc;
+    MemoryContext oldctx;
+
+    if (xact == NULL)
+        ereport(ERROR,
+                (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                 errmsg("STREAM SUBXACT message without STREAM START")));
+
+    subxid = logicalrep_read_stream_subxact(s);
+    if (subxid == xact->xid)
+        return;
+
+    foreach(lc, xact->subxacts)
+    {
+        if (((ApplyStreamSubXact *) lfirst(lc))->xid == subxid)
+            return;
+    }
+
+    oldctx = MemoryContextSwitchTo(ApplyContext);
+    subxact = (ApplyStreamSubXact *) palloc(sizeof(ApplyStreamSubXact));
+    subxact->xid = subxid;
+    subxact->fileno = xact->fileno;
+    subxact->offset = xact->offset;
+    xact->subxacts = lappend(xact->subxacts, subxact);
+    MemoryContextSwitchTo(oldctx);
+}
+
+/*
+ * Handle STREAM ABORT message: forget the changes of the transaction, or
+ * those from the first change of the subtransaction on.
+ */
+static void
+apply_handle_stream_abort(StringInfo s)
+{
+    TransactionId xid;
+    TransactionId subxid;
+    ApplyStreamXact *xact;
+    ListCell   *lc;
+    int            nkept = 0;
+
+    if (apply_stream_cur != NULL)
+        ereport(ERROR,
+                (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                 errmsg("STREAM ABORT message sent out of order")));
+
+    logicalrep_read_stream_abort(s, &xid, &subxid);
+
+    /* none of its changes were received */
+    xact = apply_stream_find(xid);
+    if (xact == NULL)
+        return;
+
+    if (subxid == xid)
+    {
+        apply_stream_discard(xact);
+        return;
+    }
+
+    foreach(lc, xact->subxacts)
+    {
+        ApplyStreamSubXact *subxact = (ApplyStreamSubXact *) lfirst(lc);
+
+        if (subxact->xid == subxid)
+        {
+            ListCell   *lc2;
+
+            xact->fileno = subxact->fileno;
+            xact->offset = subxact->offset;
+
+            for_each_cell(lc2, lc)
+                pfree(lfirst(lc2));
+            xact->subxacts = list_truncate(xact->subxacts, nkept);
+            break;
+        }
+        nkept++;
+    }
+}
+
+/*
+ * Handle STREAM COMMIT message: apply the changes received for the
+ * transaction, and commit it.
+ */
+static void
+apply_handle_stream_commit(StringInfo s)
+{
+    TransactionId xid;
+    LogicalRepCommitData commit_data;
+    ApplyStreamXact *xact;
+
+    if (in_remote_transaction || apply_stream_cur != NULL)
+        ereport(ERROR,
+                (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                 errmsg("STREAM COMMIT message sent out of order")));
+
+    xid = logicalrep_read_stream_commit(s, &commit_data);
+
+    remote_final_lsn = commit_data.commit_lsn;
+
+#ifdef __SUBSCRIPTION__
+    /* applied before the receiver restarted from an older position */
+    skip_remote_xact = commit_data.commit_lsn < fanout_skip_lsn;
+#endif
+
+    in_remote_transaction = true;
+
+    pgstat_report_activity(STATE_RUNNING, NULL);
+
+    xact = apply_stream_find(xid);
+    if (xact != NULL)
+        apply_stream_replay(xact);
+
+    apply_handle_commit_internal(&commit_data);
+
+    if (xact != NULL)
+        apply_stream_discard(xact);
+}
+
+static ApplyStreamXact *
+apply_stream_find(TransactionId xid)
+{
+    ListCell   *lc;
+
+    foreach(lc, apply_stream_xacts)
+    {
+        ApplyStreamXact *xact = (ApplyStreamXact *) lfirst(lc);
+
+        if (xact->xid == xid)
+            return xact;
+    }
+
+    return NULL;
+}
+
+/*
+ * Append the message in s, the action of which was just read, to the file of
+ * the streamed transaction: its length, the position of its action, and the
+ * whole message as received, the header included, as the apply on the
+ * datanodes needs it.
+ */
+static void
+apply_stream_write(StringInfo s)
+{
+    ApplyStreamXact *xact = apply_stream_cur;
+    int            cursor = s->cursor - 1;
+
+    if (BufFileWrite(xact->file, &s->len, sizeof(s->len)) != sizeof(s->len) ||
+        BufFileWrite(xact->file, &cursor, sizeof(cursor)) != sizeof(cursor) ||
+        BufFileWrite(xact->file, s->data, s->len) != (size_t) s->len)
+        ereport(ERROR,
+                (errcode_for_file_access(),
+                 errmsg("could not write to file of streamed transaction %u: %m",
+                        xact->xid)));
+
+    BufFileTell(xact->file, &xact->fileno, &xact->offset);
+}
+
+static void
+apply_stream_read(ApplyStreamXact *xact, void *ptr, size_t size)
+{
+    if (BufFileRead(xact->file, ptr, size) != size)
+        ereport(ERROR,
+                (errcode_for_file_access(),
+                 errmsg("could not read from file of streamed transaction %u: %m",
+                        xact->xid)));
+}
+
+/*
+ * Apply the messages written for the streamed transaction, in order.
+ */
+static void
+apply_stream_replay(ApplyStreamXact *xact)
+{
+    StringInfoData s;
+    MemoryContext oldctx;
+    int            fileno;
+    off_t        offset;
+    int            nmsgs = 0;
+
+    oldctx = MemoryContextSwitchTo(ApplyContext);
+    initStringInfo(&s);
+    MemoryContextSwitchTo(oldctx);
+
+    if (BufFileSeek(xact->file, 0, 0, SEEK_SET) != 0)
+        ereport(ERROR,
+                (errcode_for_file_access(),
+                 errmsg("could not seek in file of streamed transaction %u: %m",
+                        xact->xid)));
+
+    for (;;)
+    {
+        int            len;
+        int            cursor;
+
+        BufFileTell(xact->file, &fileno, &offset);
+        if (fileno > xact->fileno ||
+            (fileno == xact->fileno && offset >= xact->offset))
+            break;
+
+        apply_stream_read(xact, &len, sizeof(len));
+        apply_stream_read(xact, &cursor, sizeof(cursor));
+
+        resetStringInfo(&s);
+        enlargeStringInfo(&s, len);
+        apply_stream_read(xact, s.data, len);
+        s.len = len;
+        s.data[len] = '\0';
+        s.cursor = cursor;
+
+        /* like a message just received */
+        oldctx = MemoryContextSwitchTo(ApplyMessageContext);
+        apply_dispatch(&s);
+        MemoryContextReset(ApplyMessageContext);
+        MemoryContextSwitchTo(oldctx);
+
+        nmsgs++;
+    }
+
+    pfree(s.data);
+
+    elog(DEBUG1, "applied %d messages of streamed transaction %u",
+         nmsgs, xact->xid);
+}
+
+static void
+apply_stream_discard(ApplyStreamXact *xact)
+{
+    BufFileClose(xact->file);
+    list_free_deep(xact->subxacts);
+    apply_stream_xacts = list_delete_ptr(apply_stream_xacts, xact);
+    pfree(xact);
+}
+
+/*
+ * Logical replication protocol message dispatcher for CN.
+ */
+static void
+apply_dispatch(StringInfo s)
+{// #lizard forgives
+    char        action = pq_getmsgbyte(s);
+
+    /* the changes of a streamed transaction are applied at its commit */
+    if (apply_stream_cur != NULL && action != 'E' && action != 'X')
+    {
+        if (action != 'I' && action != 'U' && action != 'D' &&
+            action != 'R' && action != 'Y')
+            ereport(ERROR,
+                    (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                     errmsg("invalid logical replication message type %c in streamed transaction",
+                            action)));
+
+        apply_stream_write(s);
+        return;
+    }
+
+#ifdef __SUBSCRIPTION__
+    if (skip_remote_xact &&
+        (action == 'I' || action == 'U' || action == 'D'))
+        return;
+#endif
+
+    switch (action)
+    {
+            /* BEGIN */
+        case 'B':
+            apply_handle_begin(s);
+            break;
+            /* COMMIT */
+        case 'C':
+            apply_handle_commit(s);
+            break;
+            /* INSERT */
+        case 'I':
+            apply_handle_insert(s);
+            break;
+            /* UPDATE */
+        case 'U':
+            apply_handle_update(s);
+            break;
+            /* DELETE */
+        case 'D':
+            apply_handle_delete(s);
+            break;
+            /* RELATION */
+        case 'R':
+            apply_handle_relation(s);
+            break;
+            /* TYPE */
+        case 'Y':
+            apply_handle_type(s);
+            break;
+            /* ORIGIN */
+        case 'O':
+            apply_handle_origin(s);
+            break;
+            /* STREAM START */
+        case 'S':
+            apply_handle_stream_start(s);
+            break;
+            /* STREAM STOP */
+        case 'E':
+            apply_handle_stream_stop(s);
+            break;
+            /* STREAM SUBXACT */
+        case 'X':
+            apply_handle_stream_subxact(s);
+            break;
+            /* STREAM ABORT */
+        case 'A':
+            apply_handle_stream_abort(s);
+            break;
+            /* STREAM COMMIT */
+        case 'c':
+            apply_handle_stream_commit(s);
+            break;
+        default:
+            {
+                ereport(ERROR,
+                        (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                         errmsg("invalid logical replication message type %c", action)));
+            }
+    }
+}
+
+#ifdef __SUBSCRIPTION__
+/*
+ * Logical apply protocol message dispatcher for DN.
+ */
+void logical_apply_dispatch(StringInfo s)
+{
+	char action = pq_getmsgbyte(s);
+
+	OpenTenBaseSubscriptionApplyWorkerSet();
+
+	switch (action)
+	{
+			/* INSERT */
+		case 'I':
+			apply_handle_insert(s);
+			break;
+			/* UPDATE */
+		case 'U':
+			apply_handle_update(s);
+			break;
+			/* DELETE */
+		case 'D':
 			apply_handle_delete(s);
 			break;
 			/* RELATION */
@@ -1580,6 +2393,11 @@ LogicalRepApplyLoop(XLogRecPtr last_received)
 
         MemoryContextSwitchTo(ApplyMessageContext);
 
+#ifdef __SUBSCRIPTION__
+        if (fanout_role == APPLY_FANOUT_WORKER)
+            len = apply_fanout_receive(&buf);
+        else
+#endif
         len = walrcv_receive(wrconn, &buf, &fd);
 
         if (len != 0)
@@ -1637,6 +2455,11 @@ LogicalRepApplyLoop(XLogRecPtr last_received)
 
                         UpdateWorkerStats(last_received, send_time, false);
 
+#ifdef __SUBSCRIPTION__
+                        if (fanout_role == APPLY_FANOUT_RECEIVER)
+                            apply_fanout_dispatch(&s, buf, len);
+                        else
+#endif
                         apply_dispatch(&s);
                     }
                     else if (c == 'k')    /* WalSndKeepalive */
@@ -1652,6 +2475,17 @@ LogicalRepApplyLoop(XLogRecPtr last_received)
                         if (last_received < end_lsn)
                             last_received = end_lsn;
 
+#ifdef __SUBSCRIPTION__
+                        /* let the workers report their position too */
+                        if (fanout_role == APPLY_FANOUT_RECEIVER)
+                        {
+                            int            i;
+
+                            for (i = 1; i < fanout_shared->nworkers; i++)
+                                apply_fanout_send(i, buf, len);
+                        }
+#endif
+
                         send_feedback(last_received, reply_requested, false);
                         UpdateWorkerStats(last_received, timestamp, true);
                     }
@@ -1660,6 +2494,11 @@ LogicalRepApplyLoop(XLogRecPtr last_received)
                     MemoryContextReset(ApplyMessageContext);
                 }
 
+#ifdef __SUBSCRIPTION__
+                if (fanout_role == APPLY_FANOUT_WORKER)
+                    len = apply_fanout_receive(&buf);
+                else
+#endif
                 len = walrcv_receive(wrconn, &buf, &fd);
             }
         }
@@ -1675,6 +2514,24 @@ LogicalRepApplyLoop(XLogRecPtr last_received)
         /* confirm all writes so far */
         send_feedback(last_received, false, false);
 
+#ifdef __SUBSCRIPTION__
+        /* read our queue once our own slot has caught up with the receiver */
+        if (fanout_catchup_lsn != InvalidXLogRecPtr &&
+            !in_remote_transaction && last_received >= fanout_catchup_lsn)
+        {
+            XLogRecPtr    writepos;
+            XLogRecPtr    flushpos;
+            bool        have_pending_txes;
+
+            get_flush_position(&writepos, &flushpos, &have_pending_txes);
+            if (!have_pending_txes)
+            {
+                send_feedback(last_received, true, false);
+                apply_fanout_switch();
+            }
+        }
+#endif
+
         if (!in_remote_transaction)
         {
             /*
@@ -1714,6 +2571,15 @@ LogicalRepApplyLoop(XLogRecPtr last_received)
         else
             wait_time = NAPTIME_PER_CYCLE;
 
+#ifdef __SUBSCRIPTION__
+        /* the receiver sets our latch when it queues a message */
+        if (fanout_role == APPLY_FANOUT_WORKER)
+            rc = WaitLatch(MyLatch,
+                           WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+                           wait_time,
+                           WAIT_EVENT_LOGICAL_APPLY_MAIN);
+        else
+#endif
         rc = WaitLatchOrSocket(MyLatch,
                                WL_SOCKET_READABLE | WL_LATCH_SET |
                                WL_TIMEOUT | WL_POSTMASTER_DEATH,
@@ -1827,6 +2693,31 @@ send_feedback(XLogRecPtr recvpos, bool force, bool requestReply)
     if (!have_pending_txes)
         flushpos = writepos = recvpos;
 
+#ifdef __SUBSCRIPTION__
+    if (fanout_role == APPLY_FANOUT_WORKER)
+    {
+        /* the receiver reports it for us */
+        SpinLockAcquire(&fanout_shared->mutex);
+        if (fanout_shared->flush_lsn[MySubscription->parallel_index] < flushpos)
+            fanout_shared->flush_lsn[MySubscription->parallel_index] = flushpos;
+        SpinLockRelease(&fanout_shared->mutex);
+        return;
+    }
+    else if (fanout_role == APPLY_FANOUT_RECEIVER)
+    {
+        int            i;
+
+        /* the publisher must keep what any worker has not flushed */
+        SpinLockAcquire(&fanout_shared->mutex);
+        for (i = 1; i < fanout_shared->nworkers; i++)
+        {
+            if (fanout_shared->flush_lsn[i] < flushpos)
+                flushpos = fanout_shared->flush_lsn[i];
+        }
+        SpinLockRelease(&fanout_shared->mutex);
+    }
+#endif
+
     if (writepos < last_writepos)
         writepos = last_writepos;
 
@@ -1867,7 +2758,10 @@ send_feedback(XLogRecPtr recvpos, bool force, bool requestReply)
     }
     else
     {
-        pq_sendbyte(reply_message, MySubscription->is_all_actived ? 1 : 0); /* is_all_actived */
+        /* the receiver of a fan-out needs the changes of all the workers */
+        pq_sendbyte(reply_message,
+                    (MySubscription->is_all_actived &&
+                     fanout_role != APPLY_FANOUT_RECEIVER) ? 1 : 0); /* is_all_actived */
     }
 #endif
 
@@ -2001,6 +2895,23 @@ maybe_reread_subscription(void)
         proc_exit(0);
     }
 
+#ifdef __SUBSCRIPTION__
+    /*
+     * Exit once all the opentenbase-sub-subscriptions are active, to restart
+     * as the receiver of their changes, or as a worker fed by it.
+     */
+    if (logical_apply_fanout &&
+        newsub->is_all_actived != MySubscription->is_all_actived)
+    {
+        ereport(LOG,
+                (errmsg("logical replication apply worker for subscription \"%s\" will "
+                        "restart because all the parallel subscriptions were activated",
+                        MySubscription->name)));
+
+        proc_exit(0);
+    }
+#endif
+
     /* Check for other changes that should never happen too. */
     if (newsub->dbid != MySubscription->dbid)
     {
@@ -2196,6 +3107,9 @@ ApplyWorkerMain(Datum main_arg)
         TimeLineID    startpointTLI;
         char       *err;
         int            server_version;
+#ifdef __SUBSCRIPTION__
+        bool        fanout;
+#endif
 
         myslotname = MySubscription->slotname;
 
@@ -2217,6 +3131,11 @@ ApplyWorkerMain(Datum main_arg)
         replorigin_session_setup(originid);
         replorigin_session_origin = originid;
         origin_startpos = replorigin_session_get_progress(false);
+#ifdef __SUBSCRIPTION__
+        fanout = apply_fanout_wanted();
+        if (fanout)
+            fanout_skip_lsn = origin_startpos;
+#endif
         CommitTransactionCommand();
 
         wrconn = walrcv_connect(MySubscription->conninfo, true, MySubscription->name,
@@ -2231,6 +3150,17 @@ ApplyWorkerMain(Datum main_arg)
          */
         (void) walrcv_identify_system(wrconn, &startpointTLI,
                                       &server_version);
+
+#ifdef __SUBSCRIPTION__
+        if (fanout && MySubscription->parallel_index == 0)
+        {
+            StartTransactionCommand();
+            origin_startpos = apply_fanout_setup_receiver(origin_startpos);
+            CommitTransactionCommand();
+        }
+        else if (fanout)
+            apply_fanout_setup_worker();
+#endif
     }
 
     /*
@@ -2245,10 +3175,22 @@ ApplyWorkerMain(Datum main_arg)
     options.logical = true;
     options.startpoint = origin_startpos;
     options.slotname = myslotname;
-    options.proto.logical.proto_version = LOGICALREP_PROTO_VERSION_NUM;
     options.proto.logical.publication_names = MySubscription->publications;
 
+    /*
+     * Only ask for in-progress transactions to be streamed when wanted, as
+     * publishers of the first protocol version reject newer ones. A
+     * tablesync worker catches up on its table in a single transaction.
+     */
+    options.proto.logical.streaming = logical_apply_streaming &&
+        !am_tablesync_worker();
+    options.proto.logical.proto_version = options.proto.logical.streaming ?
+        LOGICALREP_PROTO_STREAM_VERSION_NUM : LOGICALREP_PROTO_MIN_VERSION_NUM;
+
     /* Start normal logical streaming replication. */
+#ifdef __SUBSCRIPTION__
+    if (fanout_role != APPLY_FANOUT_WORKER)
+#endif
     walrcv_startstreaming(wrconn, &options);
 
     /* Run the main loop. */
@@ -2310,5 +3252,357 @@ bool IsClusterSyncOpenTenBaseSubscription(void)
 
     return false;
 }
-#endif
 
+/*
+ * Should this worker take part in the fan-out of a parallel subscription?
+ * Only once all its opentenbase-sub-subscriptions are active: until then,
+ * the first one applies every change by itself.
+ */
+static bool
+apply_fanout_wanted(void)
+{
+    return logical_apply_fanout &&
+            am_opentenbase_subscript_dispatch_worker() &&
+            !am_tablesync_worker() &&
+            MySubscription->parallel_number > 1 &&
+            MySubscription->is_all_actived;
+}
+
+/*
+ * Ask the publisher for the confirmed flush position of a slot of ours.
+ * Must be called in a transaction.
+ */
+static XLogRecPtr
+apply_fanout_slot_confirmed(char *slotname)
+{
+    WalRcvExecResult *res;
+    StringInfoData cmd;
+    TupleTableSlot *slot;
+    Oid            lsnRow[1] = {LSNOID};
+    XLogRecPtr    confirmed = InvalidXLogRecPtr;
+    bool        isnull;
+
+    initStringInfo(&cmd);
+    appendStringInfo(&cmd,
+                     "SELECT confirmed_flush_lsn"
+                     "  FROM pg_catalog.pg_replication_slots"
+                     " WHERE slot_name = %s",
+                     quote_literal_cstr(slotname));
+    res = walrcv_exec(wrconn, cmd.data, 1, lsnRow);
+
+    if (res->status != WALRCV_OK_TUPLES)
+        ereport(ERROR,
+                (errmsg("could not fetch the position of replication slot \"%s\" from publisher: %s",
+                        slotname, res->err)));
+
+    slot = MakeSingleTupleTableSlot(res->tupledesc);
+    if (!tuplestore_gettupleslot(res->tuplestore, true, false, slot))
+        ereport(ERROR,
+                (errmsg("replication slot \"%s\" not found on publisher",
+                        slotname)));
+
+    confirmed = DatumGetLSN(slot_getattr(slot, 1, &isnull));
+    if (isnull)
+        confirmed = InvalidXLogRecPtr;
+
+    ExecDropSingleTupleTableSlot(slot);
+    walrcv_clear_result(res);
+    pfree(cmd.data);
+
+    return confirmed;
+}
+
+/*
+ * Create the queues to the other workers of the subscription and publish
+ * them.  Returns the position to stream from: our own progress, but not
+ * before the confirmed position of our slot, since the publisher would
+ * start from there anyway.  Workers that have not flushed up to there catch
+ * up on their own slot before reading their queue.  Must be called in a
+ * transaction.
+ */
+static XLogRecPtr
+apply_fanout_setup_receiver(XLogRecPtr origin_startpos)
+{
+    int            nworkers = MySubscription->parallel_number;
+    XLogRecPtr    startpos = origin_startpos;
+    XLogRecPtr    confirmed;
+    Size        headersize;
+    dsm_segment *seg;
+    MemoryContext oldcontext;
+    int            i;
+
+    confirmed = apply_fanout_slot_confirmed(MySubscription->slotname);
+    if (startpos < confirmed)
+        startpos = confirmed;
+
+    headersize = MAXALIGN(offsetof(ApplyFanoutShared, flush_lsn) +
+                          sizeof(XLogRecPtr) * nworkers);
+    seg = dsm_create(headersize + (Size) (nworkers - 1) * APPLY_FANOUT_QUEUE_SIZE, 0);
+    dsm_pin_mapping(seg);
+
+    /*
+     * A worker has flushed everything before startpos by the time it reads
+     * its queue, so the publisher may throw that away.
+     */
+    fanout_shared = (ApplyFanoutShared *) dsm_segment_address(seg);
+    SpinLockInit(&fanout_shared->mutex);
+    fanout_shared->nworkers = nworkers;
+    fanout_shared->startpos = startpos;
+    for (i = 0; i < nworkers; i++)
+        fanout_shared->flush_lsn[i] = startpos;
+
+    oldcontext = MemoryContextSwitchTo(ApplyContext);
+    fanout_queues = (shm_mq_handle **) palloc0(sizeof(shm_mq_handle *) * nworkers);
+    for (i = 1; i < nworkers; i++)
+    {
+        shm_mq       *mq;
+
+        mq = shm_mq_create(ApplyFanoutQueue(fanout_shared, i),
+                           APPLY_FANOUT_QUEUE_SIZE);
+        shm_mq_set_sender(mq, MyProc);
+        fanout_queues[i] = shm_mq_attach(mq, seg, NULL);
+    }
+    MemoryContextSwitchTo(oldcontext);
+
+    SpinLockAcquire(&MyLogicalRepWorker->relmutex);
+    MyLogicalRepWorker->fanout_handle = dsm_segment_handle(seg);
+    SpinLockRelease(&MyLogicalRepWorker->relmutex);
+
+    fanout_role = APPLY_FANOUT_RECEIVER;
+
+    elog(LOG, "logical replication apply worker for subscription \"%s\" "
+         "receives for %d workers from %X/%X",
+         MySubscription->name, nworkers,
+         (uint32) (startpos >> 32), (uint32) startpos);
+
+    return startpos;
+}
+
+/*
+ * Find the receiver of the subscription.  If our slot is confirmed up to
+ * where the receiver streams from, we have nothing left to get from it and
+ * read our queue right away.  Otherwise we keep streaming from our slot
+ * until we have flushed everything up to there, LogicalRepApplyLoop then
+ * switches to the queue.
+ */
+static void
+apply_fanout_setup_worker(void)
+{
+    XLogRecPtr    confirmed;
+
+    apply_fanout_attach();
+
+    StartTransactionCommand();
+    confirmed = apply_fanout_slot_confirmed(MySubscription->slotname);
+    CommitTransactionCommand();
+
+    if (confirmed >= fanout_shared->startpos)
+    {
+        apply_fanout_switch();
+        return;
+    }
+
+    fanout_catchup_lsn = fanout_shared->startpos;
+
+    elog(LOG, "logical replication apply worker for subscription \"%s\" "
+         "catches up to %X/%X before it is fed by the receiver of its parallel subscription",
+         MySubscription->name,
+         (uint32) (fanout_catchup_lsn >> 32), (uint32) fanout_catchup_lsn);
+}
+
+/*
+ * Wait for the receiver of the subscription to publish its queues.
+ */
+static void
+apply_fanout_attach(void)
+{
+    dsm_segment *seg = NULL;
+
+    for (;;)
+    {
+        dsm_handle    handle = DSM_HANDLE_INVALID;
+        List       *workers;
+        ListCell   *lc;
+        int            rc;
+
+        CHECK_FOR_INTERRUPTS();
+
+        StartTransactionCommand();
+        AcceptInvalidationMessages();
+        maybe_reread_subscription();
+
+        workers = GetOpenTenBaseSubscriptnParallelWorker(MySubscription->oid);
+        foreach(lc, workers)
+        {
+            LogicalRepWorker *worker = (LogicalRepWorker *) lfirst(lc);
+
+            SpinLockAcquire(&worker->relmutex);
+            if (worker->fanout_handle != DSM_HANDLE_INVALID)
+                handle = worker->fanout_handle;
+            SpinLockRelease(&worker->relmutex);
+        }
+        list_free(workers);
+        CommitTransactionCommand();
+
+        if (handle != DSM_HANDLE_INVALID)
+        {
+            seg = dsm_attach(handle);
+            if (seg != NULL)
+            {
+                ApplyFanoutShared *shared;
+                shm_mq       *mq;
+
+                shared = (ApplyFanoutShared *) dsm_segment_address(seg);
+                if (shared->nworkers != MySubscription->parallel_number)
+                    elog(ERROR, "receiver of subscription \"%s\" has %d workers instead of %d",
+                         MySubscription->name, shared->nworkers,
+                         MySubscription->parallel_number);
+
+                /*
+                 * A previous incarnation of this worker used the queue: the
+                 * receiver will notice it has gone, and start again.
+                 */
+                mq = ApplyFanoutQueue(shared, MySubscription->parallel_index);
+                if (shm_mq_get_receiver(mq) == NULL)
+                {
+                    fanout_shared = shared;
+                    break;
+                }
+
+                dsm_detach(seg);
+                seg = NULL;
+            }
+        }
+
+        rc = WaitLatch(MyLatch,
+                       WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+                       NAPTIME_PER_CYCLE,
+                       WAIT_EVENT_LOGICAL_APPLY_MAIN);
+
+        /* Emergency bailout if postmaster has died */
+        if (rc & WL_POSTMASTER_DEATH)
+            proc_exit(1);
+
+        if (rc & WL_LATCH_SET)
+            ResetLatch(MyLatch);
+    }
+
+    dsm_pin_mapping(seg);
+    fanout_segment = seg;
+}
+
+/*
+ * Stop streaming from our slot and read our queue from now on, skipping
+ * the transactions we have applied already.
+ */
+static void
+apply_fanout_switch(void)
+{
+    shm_mq       *mq;
+    MemoryContext oldcontext;
+
+    walrcv_disconnect(wrconn);
+    wrconn = NULL;
+
+    fanout_skip_lsn = replorigin_session_get_progress(false);
+    fanout_catchup_lsn = InvalidXLogRecPtr;
+
+    mq = ApplyFanoutQueue(fanout_shared, MySubscription->parallel_index);
+    shm_mq_set_receiver(mq, MyProc);
+    oldcontext = MemoryContextSwitchTo(ApplyContext);
+    fanout_queue = shm_mq_attach(mq, fanout_segment, NULL);
+    MemoryContextSwitchTo(oldcontext);
+
+    fanout_role = APPLY_FANOUT_WORKER;
+
+    elog(LOG, "logical replication apply worker for subscription \"%s\" "
+         "is fed by the receiver of its parallel subscription",
+         MySubscription->name);
+}
+
+/*
+ * Pass a message received from the publisher to the worker of the given
+ * parallel_index, waiting while its queue is full.
+ */
+static void
+apply_fanout_send(int index, char *buf, int len)
+{
+    shm_mq_result res;
+
+    res = shm_mq_send(fanout_queues[index], (Size) len, buf, false);
+    if (res != SHM_MQ_SUCCESS)
+        ereport(ERROR,
+                (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+                 errmsg("logical replication apply worker %d of subscription \"%s\" has exited",
+                        index, MySubscription->parent_name)));
+}
+
+/*
+ * Apply the message received from the publisher, in 's' and whole in 'buf',
+ * and pass it to the workers it concerns: an INSERT, UPDATE or DELETE to
+ * the worker of its tuple hash only, any other message to all of them.
+ */
+static void
+apply_fanout_dispatch(StringInfo s, char *buf, int len)
+{
+    char        action;
+    int            index;
+
+    if (s->cursor >= s->len)
+        ereport(ERROR,
+                (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                 errmsg("empty logical replication message")));
+
+    action = s->data[s->cursor];
+    if (action == 'I' || action == 'U' || action == 'D')
+    {
+        StringInfoData msg = *s;
+
+        msg.cursor++;
+        index = logicalrep_read_dml_hash(&msg);
+        if (index < 0 || index >= fanout_shared->nworkers)
+            ereport(ERROR,
+                    (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                     errmsg("invalid tuple hash %d in logical replication message",
+                            index)));
+
+        if (index != 0)
+        {
+            apply_fanout_send(index, buf, len);
+            return;
+        }
+    }
+    else
+    {
+        for (index = 1; index < fanout_shared->nworkers; index++)
+            apply_fanout_send(index, buf, len);
+    }
+
+    apply_dispatch(s);
+}
+
+/*
+ * Counterpart of walrcv_receive for a worker fed by the receiver: returns
+ * the length of the next message and points *buffer to it, or 0 if there
+ * is none for now.
+ */
+static int
+apply_fanout_receive(char **buffer)
+{
+    shm_mq_result res;
+    Size        nbytes;
+    void       *data;
+
+    res = shm_mq_receive(fanout_queue, &nbytes, &data, true);
+    if (res == SHM_MQ_WOULD_BLOCK)
+        return 0;
+    if (res != SHM_MQ_SUCCESS)
+        ereport(ERROR,
+                (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+                 errmsg("the receiver of subscription \"%s\" has exited",
+                        MySubscription->parent_name)));
+
+    *buffer = (char *) data;
+    return (int) nbytes;
+}
+#endif
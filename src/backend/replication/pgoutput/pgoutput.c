@@ -22,6 +22,7 @@
 #include "replication/origin.h"
 #include "replication/pgoutput.h"
 
+#include "utils/builtins.h"
 #include "utils/inval.h"
 #include "utils/int8.h"
 #include "utils/memutils.h"
@@ -44,6 +45,14 @@ static void pgoutput_change(LogicalDecodingContext *ctx,
                 ReorderBufferChange *change);
 static bool pgoutput_origin_filter(LogicalDecodingContext *ctx,
                        RepOriginId origin_id);
+static void pgoutput_stream_start(LogicalDecodingContext *ctx,
+                      ReorderBufferTXN *txn);
+static void pgoutput_stream_stop(LogicalDecodingContext *ctx,
+                     ReorderBufferTXN *txn);
+static void pgoutput_stream_abort(LogicalDecodingContext *ctx,
+                      ReorderBufferTXN *txn, XLogRecPtr abort_lsn);
+static void pgoutput_stream_commit(LogicalDecodingContext *ctx,
+                       ReorderBufferTXN *txn, XLogRecPtr commit_lsn);
 
 static bool publications_valid;
 
@@ -63,6 +72,17 @@ typedef struct RelationSyncEntry
 /* Map used to remember which relation schemas we sent. */
 static HTAB *RelationSyncCache = NULL;
 
+/*
+ * State of the block of streamed changes being sent: the subscriber only
+ * applies them at commit, in the order it got them, so the schema of each
+ * relation is sent again in each block instead of being remembered in the
+ * RelationSyncCache, and each change of a different subtransaction than the
+ * previous one is preceded by the subtransaction's xid.
+ */
+static bool in_streaming = false;
+static TransactionId stream_subxid = InvalidTransactionId;
+static List *stream_relids = NIL;
+
 static void init_rel_sync_cache(MemoryContext decoding_context);
 static RelationSyncEntry *get_rel_sync_entry(PGOutputData *data, Oid relid);
 static void rel_sync_cache_relation_cb(Datum arg, Oid relid);
@@ -83,15 +103,23 @@ _PG_output_plugin_init(OutputPluginCallbacks *cb)
     cb->commit_cb = pgoutput_commit_txn;
     cb->filter_by_origin_cb = pgoutput_origin_filter;
     cb->shutdown_cb = pgoutput_shutdown;
+
+    /* transaction streaming */
+    cb->stream_start_cb = pgoutput_stream_start;
+    cb->stream_stop_cb = pgoutput_stream_stop;
+    cb->stream_abort_cb = pgoutput_stream_abort;
+    cb->stream_commit_cb = pgoutput_stream_commit;
+    cb->stream_change_cb = pgoutput_change;
 }
 
 static void
 parse_output_parameters(List *options, uint32 *protocol_version,
-                        List **publication_names)
+                        List **publication_names, bool *streaming)
 {// #lizard forgives
     ListCell   *lc;
     bool        protocol_version_given = false;
     bool        publication_names_given = false;
+    bool        streaming_given = false;
 
     foreach(lc, options)
     {
@@ -137,6 +165,20 @@ parse_output_parameters(List *options, uint32 *protocol_version,
                         (errcode(ERRCODE_INVALID_NAME),
                          errmsg("invalid publication_names syntax")));
         }
+        else if (strcmp(defel->defname, "streaming") == 0)
+        {
+            if (streaming_given)
+                ereport(ERROR,
+                        (errcode(ERRCODE_SYNTAX_ERROR),
+                         errmsg("conflicting or redundant options")));
+            streaming_given = true;
+
+            if (!parse_bool(strVal(defel->arg), streaming))
+                ereport(ERROR,
+                        (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                         errmsg("invalid streaming value \"%s\"",
+                                strVal(defel->arg))));
+        }
         else
             elog(ERROR, "unrecognized pgoutput option: %s", defel->defname);
     }
@@ -173,10 +215,11 @@ pgoutput_startup(LogicalDecodingContext *ctx, OutputPluginOptions *opt,
         /* Parse the params and ERROR if we see any we don't recognize */
         parse_output_parameters(ctx->output_plugin_options,
                                 &data->protocol_version,
-                                &data->publication_names);
+                                &data->publication_names,
+                                &data->streaming);
 
         /* Check if we support requested protocol */
-        if (data->protocol_version != LOGICALREP_PROTO_VERSION_NUM)
+        if (data->protocol_version > LOGICALREP_PROTO_VERSION_NUM)
             ereport(ERROR,
                     (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
                      errmsg("client sent proto_version=%d but we only support protocol %d or lower",
@@ -193,6 +236,14 @@ pgoutput_startup(LogicalDecodingContext *ctx, OutputPluginOptions *opt,
                     (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
                      errmsg("publication_names parameter missing")));
 
+        if (data->streaming &&
+            data->protocol_version < LOGICALREP_PROTO_STREAM_VERSION_NUM)
+            ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                     errmsg("requested proto_version=%d does not support streaming, need %d or higher",
+                            data->protocol_version,
+                            LOGICALREP_PROTO_STREAM_VERSION_NUM)));
+
         /* Init publication state. */
         data->publications = NIL;
         publications_valid = false;
@@ -203,6 +254,10 @@ pgoutput_startup(LogicalDecodingContext *ctx, OutputPluginOptions *opt,
         /* Initialize relation schema cache. */
         init_rel_sync_cache(CacheMemoryContext);
     }
+
+    /* in-progress transactions are only streamed if the client asked */
+    if (!data->streaming)
+        ctx->streaming = false;
 }
 
 /*
@@ -322,10 +377,27 @@ pgoutput_change(LogicalDecodingContext *ctx, ReorderBufferTXN *txn,
     /* Avoid leaking memory by using and resetting our own context */
     old = MemoryContextSwitchTo(data->context);
 
+    /* Tell which subtransaction the following streamed changes belong to */
+    if (in_streaming)
+    {
+        TransactionId subxid = change->txn ? change->txn->xid : txn->xid;
+
+        if (subxid != stream_subxid)
+        {
+            OutputPluginPrepareWrite(ctx, false);
+            logicalrep_write_stream_subxact(ctx->out, subxid);
+            OutputPluginWrite(ctx, false);
+            stream_subxid = subxid;
+        }
+    }
+
     /*
-     * Write the relation schema if the current schema haven't been sent yet.
+     * Write the relation schema if the current schema haven't been sent yet,
+     * or, when streaming, not in this block.
      */
-    if (!relentry->schema_sent)
+    if (in_streaming ?
+        !list_member_oid(stream_relids, RelationGetRelid(relation)) :
+        !relentry->schema_sent)
     {
         TupleDesc    desc;
         int            i;
@@ -354,7 +426,16 @@ pgoutput_change(LogicalDecodingContext *ctx, ReorderBufferTXN *txn,
         OutputPluginPrepareWrite(ctx, false);
         logicalrep_write_rel(ctx->out, relation);
         OutputPluginWrite(ctx, false);
-        relentry->schema_sent = true;
+
+        if (in_streaming)
+        {
+            MemoryContextSwitchTo(ctx->context);
+            stream_relids = lappend_oid(stream_relids,
+                                        RelationGetRelid(relation));
+            MemoryContextSwitchTo(data->context);
+        }
+        else
+            relentry->schema_sent = true;
     }
 
     /* Send the data */
@@ -417,6 +498,76 @@ pgoutput_origin_filter(LogicalDecodingContext *ctx,
     return false;
 }
 
+/*
+ * STREAM START callback: open a block of changes of an in-progress
+ * transaction, which starts over on the subscriber if none of them were sent
+ * before.
+ */
+static void
+pgoutput_stream_start(LogicalDecodingContext *ctx, ReorderBufferTXN *txn)
+{
+    Assert(!in_streaming);
+
+    OutputPluginPrepareWrite(ctx, true);
+    logicalrep_write_stream_start(ctx->out, txn->xid, !txn->streamed);
+    OutputPluginWrite(ctx, true);
+
+    in_streaming = true;
+    stream_subxid = txn->xid;
+}
+
+/*
+ * STREAM STOP callback
+ */
+static void
+pgoutput_stream_stop(LogicalDecodingContext *ctx, ReorderBufferTXN *txn)
+{
+    Assert(in_streaming);
+
+    OutputPluginPrepareWrite(ctx, true);
+    logicalrep_write_stream_stop(ctx->out);
+    OutputPluginWrite(ctx, true);
+
+    in_streaming = false;
+    stream_subxid = InvalidTransactionId;
+    list_free(stream_relids);
+    stream_relids = NIL;
+}
+
+/*
+ * STREAM ABORT callback: the subscriber discards the changes streamed for
+ * the subtransaction, or the whole transaction.
+ */
+static void
+pgoutput_stream_abort(LogicalDecodingContext *ctx, ReorderBufferTXN *txn,
+                      XLogRecPtr abort_lsn)
+{
+    TransactionId xid = txn->toptxn ? txn->toptxn->xid : txn->xid;
+
+    Assert(!in_streaming);
+
+    OutputPluginPrepareWrite(ctx, true);
+    logicalrep_write_stream_abort(ctx->out, xid, txn->xid);
+    OutputPluginWrite(ctx, true);
+}
+
+/*
+ * STREAM COMMIT callback: the subscriber applies the changes streamed for
+ * the transaction.
+ */
+static void
+pgoutput_stream_commit(LogicalDecodingContext *ctx, ReorderBufferTXN *txn,
+                       XLogRecPtr commit_lsn)
+{
+    Assert(!in_streaming);
+
+    OutputPluginUpdateProgress(ctx);
+
+    OutputPluginPrepareWrite(ctx, true);
+    logicalrep_write_stream_commit(ctx->out, txn, commit_lsn);
+    OutputPluginWrite(ctx, true);
+}
+
 /*
  * Shutdown the output plugin.
  *
@@ -0,0 +1,746 @@
+/*-------------------------------------------------------------------------
+ *
+ * partstats.c
+ *      Statistics of interval partitioned tables merged from those of their
+ *      partitions.
+ *
+ * The rows of an interval partitioned table are all in its partitions, and
+ * new rows usually go to the newest of them only.  Sampling every partition
+ * again to build the statistics of the table is then mostly wasted work.
+ * Instead, ANALYZE of a datanode builds them from the statistics of the
+ * partitions, which it only refreshes for those that changed:
+ *
+ * - the fraction of nulls and the average width are averaged over the rows
+ *   of the partitions;
+ * - the most common values lists are added up, weighted by the rows of
+ *   their partition;
+ * - the histograms, and the common values of the partitions that are not
+ *   common in the table, are merged as weighted quantiles;
+ * - the number of distinct values comes from the NDV sketches kept with
+ *   the statistics of the partitions: a HyperLogLog of the values of the
+ *   sample, in a slot of its own.  The union of the sketches tells how many
+ *   of the values seen in the samples are shared by several partitions,
+ *   which scales down the sum of the estimates of the partitions.  The
+ *   ranges of the partitions don't overlap, so the estimates of the
+ *   partition key are simply added up.
+ *
+ * Other kinds of statistics, such as those of the elements of arrays, are
+ * not merged.  A table some partition of which was never analyzed, or has
+ * no sketch yet, is sampled as before.
+ *
+ * This source code file contains modifications made by THL A29 Limited ("Tencent Modifications").
+ * All Tencent Modifications are Copyright (C) 2023 THL A29 Limited.
+ *
+ * IDENTIFICATION
+ *      src/backend/statistics/partstats.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <math.h>
+
+#include "access/heapam.h"
+#include "access/htup_details.h"
+#include "catalog/pg_statistic.h"
+#include "lib/hyperloglog.h"
+#include "parser/parse_oper.h"
+#include "pgstat.h"
+#include "statistics/partstats.h"
+#include "storage/bufmgr.h"
+#include "utils/catcache.h"
+#include "utils/datum.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/ruleutils.h"
+#include "utils/sortsupport.h"
+#include "utils/syscache.h"
+#include "utils/typcache.h"
+
+/* a partition of the table, and the statistics of its columns */
+typedef struct PartStats
+{
+    Oid            relid;
+    double        reltuples;
+    HeapTuple  *stattups;        /* pg_statistic row of each column */
+} PartStats;
+
+/* a value and the number of rows of the table it stands for */
+typedef struct WeightedValue
+{
+    Datum        value;
+    double        weight;
+} WeightedValue;
+
+static bool part_ndv_sketch_wanted(Oid typid);
+static bool part_ndv_sketch_get(HeapTuple stattup, hyperLogLogState *sketch);
+static void merge_column_stats(VacAttrStats *stats, bool partkey,
+                   PartStats *parts, int nparts, int col,
+                   double totalrows);
+static int    compare_weight_desc(const void *a, const void *b);
+static int    compare_weighted_values(const void *a, const void *b, void *arg);
+
+/*
+ * Whether the values of a type can be added to an NDV sketch, that is
+ * whether the type has a hash function.
+ */
+static bool
+part_ndv_sketch_wanted(Oid typid)
+{
+    TypeCacheEntry *typentry;
+
+    typentry = lookup_type_cache(typid,
+                                 TYPECACHE_EQ_OPR | TYPECACHE_HASH_PROC);
+
+    return OidIsValid(typentry->eq_opr) && OidIsValid(typentry->hash_proc);
+}
+
+/*
+ * build_part_ndv_sketch
+ *        Add the NDV sketch of the sampled values of a column of a partition
+ *        to its statistics, if a slot is left for it.
+ */
+void
+build_part_ndv_sketch(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
+                      int samplerows)
+{
+    TypeCacheEntry *typentry;
+    hyperLogLogState sketch;
+    MemoryContext old_context;
+    float4       *registers;
+    int            slot_idx;
+    int            i;
+
+    if (!stats->stats_valid)
+        return;
+
+    for (slot_idx = 0; slot_idx < STATISTIC_NUM_SLOTS; slot_idx++)
+    {
+        if (stats->stakind[slot_idx] == 0)
+            break;
+    }
+    if (slot_idx >= STATISTIC_NUM_SLOTS)
+        return;
+
+    if (!part_ndv_sketch_wanted(stats->attrtypid))
+        return;
+    typentry = lookup_type_cache(stats->attrtypid,
+                                 TYPECACHE_EQ_OPR | TYPECACHE_HASH_PROC_FINFO);
+
+    initHyperLogLog(&sketch, PART_NDV_SKETCH_WIDTH);
+    for (i = 0; i < samplerows; i++)
+    {
+        Datum        value;
+        bool        isnull;
+        uint32        hash;
+
+        vacuum_delay_point();
+
+        value = fetchfunc(stats, i, &isnull);
+        if (isnull)
+            continue;
+
+        hash = DatumGetUInt32(FunctionCall1Coll(&typentry->hash_proc_finfo,
+                                                stats->attr->attcollation,
+                                                value));
+        addHyperLogLog(&sketch, hash);
+    }
+
+    /* the registers are small, a float4 holds them exactly */
+    old_context = MemoryContextSwitchTo(stats->anl_context);
+    registers = (float4 *) palloc(sketch.nRegisters * sizeof(float4));
+    for (i = 0; i < sketch.nRegisters; i++)
+        registers[i] = (float4) sketch.hashesArr[i];
+    MemoryContextSwitchTo(old_context);
+
+    stats->stakind[slot_idx] = STATISTIC_KIND_NDV_SKETCH;
+    stats->staop[slot_idx] = typentry->eq_opr;
+    stats->stanumbers[slot_idx] = registers;
+    stats->numnumbers[slot_idx] = sketch.nRegisters;
+
+    freeHyperLogLog(&sketch);
+}
+
+/*
+ * Read the NDV sketch of a pg_statistic row into *sketch.  Returns false if
+ * the row has none.
+ */
+static bool
+part_ndv_sketch_get(HeapTuple stattup, hyperLogLogState *sketch)
+{
+    AttStatsSlot sslot;
+    int            i;
+
+    if (!get_attstatsslot(&sslot, stattup, STATISTIC_KIND_NDV_SKETCH,
+                          InvalidOid, ATTSTATSSLOT_NUMBERS))
+        return false;
+
+    initHyperLogLog(sketch, PART_NDV_SKETCH_WIDTH);
+    if (sslot.nnumbers != sketch->nRegisters)
+    {
+        freeHyperLogLog(sketch);
+        free_attstatsslot(&sslot);
+        return false;
+    }
+
+    for (i = 0; i < sslot.nnumbers; i++)
+        sketch->hashesArr[i] = (uint8) sslot.numbers[i];
+
+    free_attstatsslot(&sslot);
+    return true;
+}
+
+/*
+ * part_stats_stale
+ *        Whether the statistics of a partition of an interval partitioned
+ *        table must be built again before those of the table are merged
+ *        from them: rows of the partition changed since it was last
+ *        analyzed, it never was, or its statistics have no NDV sketch.
+ */
+bool
+part_stats_stale(Oid partoid)
+{
+    PgStat_StatTabEntry *tabentry;
+    CatCList   *catlist;
+    bool        stale = false;
+    int            i;
+
+    tabentry = pgstat_fetch_stat_tabentry(partoid);
+    if (tabentry == NULL)
+        return true;
+
+    if (tabentry->changes_since_analyze > 0)
+        return true;
+
+    if (tabentry->analyze_timestamp == 0 &&
+        tabentry->autovac_analyze_timestamp == 0)
+        return true;
+
+    /* analyzed before the sketches were kept */
+    catlist = SearchSysCacheList1(STATRELATTINH, ObjectIdGetDatum(partoid));
+    for (i = 0; i < catlist->n_members && !stale; i++)
+    {
+        HeapTuple    stattup = &catlist->members[i]->tuple;
+        Form_pg_statistic form = (Form_pg_statistic) GETSTRUCT(stattup);
+        Oid            typid;
+        hyperLogLogState sketch;
+
+        if (form->stainherit || form->stanullfrac >= 1.0)
+            continue;
+
+        typid = get_atttype(partoid, form->staattnum);
+        if (!OidIsValid(typid) || !part_ndv_sketch_wanted(typid))
+            continue;
+
+        if (part_ndv_sketch_get(stattup, &sketch))
+            freeHyperLogLog(&sketch);
+        else
+            stale = true;
+    }
+    ReleaseSysCacheList(catlist);
+
+    return stale;
+}
+
+/*
+ * merge_part_stats
+ *        Build the statistics of the columns of an interval partitioned
+ *        table from those of its partitions.
+ *
+ * Returns false, leaving vacattrstats alone, if some partition holding rows
+ * has no statistics to merge; the table is then to be sampled.  Otherwise
+ * sets the statistics of each column and the rows of the table.
+ */
+bool
+merge_part_stats(Relation onerel, int attr_cnt, VacAttrStats **vacattrstats,
+                 double *totalrows, double *totaldeadrows)
+{
+    List       *partoids;
+    ListCell   *lc;
+    PartStats  *parts;
+    int            nparts = 0;
+    double        rows = 0;
+    double        deadrows = 0;
+    AttrNumber    partkey = RelationGetPartitionColumnIndex(onerel);
+    int            i;
+
+    partoids = RelationGetAllPartitions(onerel);
+    parts = (PartStats *) palloc0(Max(list_length(partoids), 1) *
+                                  sizeof(PartStats));
+
+    foreach(lc, partoids)
+    {
+        Oid            partoid = lfirst_oid(lc);
+        PartStats  *part = &parts[nparts];
+        PgStat_StatTabEntry *tabentry;
+        float        reltuples;
+
+        if (!get_rel_stat(partoid, NULL, &reltuples, NULL))
+            continue;
+
+        tabentry = pgstat_fetch_stat_tabentry(partoid);
+        if (tabentry != NULL)
+            deadrows += tabentry->n_dead_tuples;
+
+        if (reltuples <= 0)
+        {
+            Relation    partrel;
+            BlockNumber nblocks;
+
+            /* an empty partition adds nothing, one never analyzed may */
+            if (tabentry != NULL &&
+                (tabentry->analyze_timestamp != 0 ||
+                 tabentry->autovac_analyze_timestamp != 0))
+                continue;
+
+            partrel = try_relation_open(partoid, AccessShareLock);
+            if (partrel == NULL)
+                continue;
+            nblocks = RelationGetNumberOfBlocks(partrel);
+            relation_close(partrel, AccessShareLock);
+
+            if (nblocks == 0)
+                continue;
+            return false;
+        }
+
+        part->relid = partoid;
+        part->reltuples = reltuples;
+        part->stattups = (HeapTuple *) palloc0(attr_cnt * sizeof(HeapTuple));
+
+        for (i = 0; i < attr_cnt; i++)
+        {
+            VacAttrStats *stats = vacattrstats[i];
+            AttrNumber    attnum;
+            HeapTuple    stattup;
+            hyperLogLogState sketch;
+
+            attnum = get_attnum(partoid, NameStr(stats->attr->attname));
+            if (attnum == InvalidAttrNumber)
+                return false;
+
+            stattup = SearchSysCacheCopy3(STATRELATTINH,
+                                          ObjectIdGetDatum(partoid),
+                                          Int16GetDatum(attnum),
+                                          BoolGetDatum(false));
+            if (!HeapTupleIsValid(stattup))
+                return false;
+
+            /* the distinct values of other columns are counted by sketch */
+            if (stats->attr->attnum != partkey &&
+                ((Form_pg_statistic) GETSTRUCT(stattup))->stanullfrac < 1.0 &&
+                part_ndv_sketch_wanted(stats->attrtypid))
+            {
+                if (!part_ndv_sketch_get(stattup, &sketch))
+                    return false;
+                freeHyperLogLog(&sketch);
+            }
+
+            part->stattups[i] = stattup;
+        }
+
+        rows += reltuples;
+        nparts++;
+    }
+
+    /* nothing to merge, the table is sampled in no time */
+    if (nparts == 0)
+        return false;
+
+    for (i = 0; i < attr_cnt; i++)
+    {
+        MemoryContext col_context,
+                    old_context;
+
+        col_context = AllocSetContextCreate(CurrentMemoryContext,
+                                            "Analyze Merge Column",
+                                            ALLOCSET_DEFAULT_SIZES);
+        old_context = MemoryContextSwitchTo(col_context);
+
+        merge_column_stats(vacattrstats[i],
+                           vacattrstats[i]->attr->attnum == partkey,
+                           parts, nparts, i, rows);
+
+        MemoryContextSwitchTo(old_context);
+        MemoryContextDelete(col_context);
+    }
+
+    *totalrows = rows;
+    *totaldeadrows = deadrows;
+    return true;
+}
+
+/*
+ * Merge the statistics of one column.  Everything stats keeps is allocated
+ * in its anl_context, the rest goes with the current context.
+ */
+static void
+merge_column_stats(VacAttrStats *stats, bool partkey, PartStats *parts,
+                   int nparts, int col, double totalrows)
+{
+    Oid            collation = stats->attr->attcollation;
+    Oid            ltopr;
+    Oid            eqopr;
+    FmgrInfo    eqfunc;
+    double        nonnull = 0;
+    double        nulls = 0;
+    double        widths = 0;
+    double        ndistinct_sum = 0;
+    double        ndistinct_max = 0;
+    bool        ndistinct_known = true;
+    hyperLogLogState sketch_union;
+    double        sketch_sum = 0;
+    bool        sketched;
+    double        ndistinct;
+    WeightedValue *mcv;
+    int            nmcv = 0;
+    int            num_mcv;
+    WeightedValue *points;
+    int            npoints = 0;
+    int            maxpoints = 0;
+    double        corr_sum = 0;
+    bool        corr_known = true;
+    int            slot_idx = 0;
+    int            stattarget = stats->attr->attstattarget;
+    int            i,
+                j,
+                p;
+
+    if (stattarget < 0)
+        stattarget = default_statistics_target;
+
+    get_sort_group_operators(stats->attrtypid,
+                             false, false, false,
+                             &ltopr, &eqopr, NULL,
+                             NULL);
+    if (OidIsValid(eqopr))
+        fmgr_info(get_opcode(eqopr), &eqfunc);
+
+    sketched = !partkey && part_ndv_sketch_wanted(stats->attrtypid);
+    if (sketched)
+        initHyperLogLog(&sketch_union, PART_NDV_SKETCH_WIDTH);
+
+    /* room for the common values of every partition */
+    for (p = 0; p < nparts; p++)
+    {
+        AttStatsSlot sslot;
+
+        if (get_attstatsslot(&sslot, parts[p].stattups[col],
+                             STATISTIC_KIND_MCV, InvalidOid, 0))
+        {
+            maxpoints += sslot.nvalues;
+            free_attstatsslot(&sslot);
+        }
+        if (get_attstatsslot(&sslot, parts[p].stattups[col],
+                             STATISTIC_KIND_HISTOGRAM, InvalidOid, 0))
+        {
+            maxpoints += sslot.nvalues;
+            free_attstatsslot(&sslot);
+        }
+    }
+    mcv = (WeightedValue *) palloc(Max(maxpoints, 1) * sizeof(WeightedValue));
+    points = (WeightedValue *) palloc(Max(maxpoints, 1) *
+                                      sizeof(WeightedValue));
+
+    for (p = 0; p < nparts; p++)
+    {
+        HeapTuple    stattup = parts[p].stattups[col];
+        Form_pg_statistic form = (Form_pg_statistic) GETSTRUCT(stattup);
+        double        rows = parts[p].reltuples;
+        double        part_nonnull = rows * (1.0 - form->stanullfrac);
+        double        part_ndistinct;
+        double        mcv_frac = 0;
+        AttStatsSlot sslot;
+
+        nulls += rows * form->stanullfrac;
+        nonnull += part_nonnull;
+        widths += part_nonnull * form->stawidth;
+
+        if (part_nonnull <= 0)
+            continue;
+
+        /* a negative stadistinct is a fraction of the rows */
+        part_ndistinct = form->stadistinct;
+        if (part_ndistinct < 0)
+            part_ndistinct = -part_ndistinct * rows;
+        if (part_ndistinct == 0)
+            ndistinct_known = false;
+        ndistinct_sum += part_ndistinct;
+        ndistinct_max = Max(ndistinct_max, part_ndistinct);
+
+        if (sketched)
+        {
+            hyperLogLogState sketch;
+
+            if (part_ndv_sketch_get(stattup, &sketch))
+            {
+                sketch_sum += estimateHyperLogLog(&sketch);
+                for (i = 0; i < sketch.nRegisters; i++)
+                    sketch_union.hashesArr[i] = Max(sketch_union.hashesArr[i],
+                                                    sketch.hashesArr[i]);
+                freeHyperLogLog(&sketch);
+            }
+            else
+                sketched = false;
+        }
+
+        /* add the common values of the partition to those of the table */
+        if (OidIsValid(eqopr) &&
+            get_attstatsslot(&sslot, stattup, STATISTIC_KIND_MCV, InvalidOid,
+                             ATTSTATSSLOT_VALUES | ATTSTATSSLOT_NUMBERS))
+        {
+            for (i = 0; i < sslot.nvalues && i < sslot.nnumbers; i++)
+            {
+                double        weight = sslot.numbers[i] * rows;
+
+                mcv_frac += sslot.numbers[i];
+                for (j = 0; j < nmcv; j++)
+                {
+                    if (DatumGetBool(FunctionCall2Coll(&eqfunc, collation,
+                                                       mcv[j].value,
+                                                       sslot.values[i])))
+                        break;
+                }
+                if (j < nmcv)
+                    mcv[j].weight += weight;
+                else
+                {
+                    mcv[nmcv].value = datumCopy(sslot.values[i],
+                                                stats->attrtype->typbyval,
+                                                stats->attrtype->typlen);
+                    mcv[nmcv].weight = weight;
+                    nmcv++;
+                }
+            }
+            free_attstatsslot(&sslot);
+        }
+
+        /*
+         * The bins of the histogram hold the same number of rows: half a
+         * bin for each end, a whole one for the bounds in between.
+         */
+        if (OidIsValid(ltopr) &&
+            get_attstatsslot(&sslot, stattup, STATISTIC_KIND_HISTOGRAM,
+                             InvalidOid, ATTSTATSSLOT_VALUES))
+        {
+            double        hist_frac = 1.0 - form->stanullfrac - mcv_frac;
+
+            if (sslot.nvalues >= 2 && hist_frac > 0)
+            {
+                double        binrows = rows * hist_frac / (sslot.nvalues - 1);
+
+                for (i = 0; i < sslot.nvalues; i++)
+                {
+                    points[npoints].value = datumCopy(sslot.values[i],
+                                                      stats->attrtype->typbyval,
+                                                      stats->attrtype->typlen);
+                    points[npoints].weight = binrows;
+                    if (i == 0 || i == sslot.nvalues - 1)
+                        points[npoints].weight /= 2;
+                    npoints++;
+                }
+            }
+            free_attstatsslot(&sslot);
+        }
+
+        if (OidIsValid(ltopr) &&
+            get_attstatsslot(&sslot, stattup, STATISTIC_KIND_CORRELATION,
+                             InvalidOid, ATTSTATSSLOT_NUMBERS))
+        {
+            if (sslot.nnumbers == 1)
+                corr_sum += sslot.numbers[0] * part_nonnull;
+            else
+                corr_known = false;
+            free_attstatsslot(&sslot);
+        }
+        else
+            corr_known = false;
+    }
+
+    stats->stats_valid = true;
+    stats->stanullfrac = (totalrows > 0) ? nulls / totalrows : 0;
+    stats->stawidth = (nonnull > 0) ? (int32) (widths / nonnull + 0.5) : 0;
+
+    /*
+     * The values seen in the samples of several partitions are counted
+     * once by the union of their sketches.  The estimates of the partitions
+     * overlap about as much.
+     */
+    if (!ndistinct_known || nonnull <= 0)
+        ndistinct = 0;
+    else
+    {
+        ndistinct = ndistinct_sum;
+        if (sketched && sketch_sum > 0)
+            ndistinct *= estimateHyperLogLog(&sketch_union) / sketch_sum;
+
+        /* clamp to sane range in case of estimation error */
+        if (ndistinct < ndistinct_max)
+            ndistinct = ndistinct_max;
+        if (ndistinct > ndistinct_sum)
+            ndistinct = ndistinct_sum;
+        if (ndistinct > nonnull)
+            ndistinct = nonnull;
+        ndistinct = floor(ndistinct + 0.5);
+    }
+    if (sketched)
+        freeHyperLogLog(&sketch_union);
+
+    /* as compute_scalar_stats does */
+    stats->stadistinct = ndistinct;
+    if (stats->stadistinct > 0.1 * totalrows)
+        stats->stadistinct = -(stats->stadistinct / totalrows);
+
+    /*
+     * Keep the values that are common in the table, the way
+     * compute_scalar_stats picks them from the sample: all of them if they
+     * are all the values there are, else those 25% more common than
+     * average.  The others go to the histogram.
+     */
+    qsort(mcv, nmcv, sizeof(WeightedValue), compare_weight_desc);
+    num_mcv = Min(nmcv, stattarget);
+    if (!(ndistinct > 0 && nmcv <= num_mcv && nmcv >= ndistinct))
+    {
+        double        mincount = (ndistinct > 0) ? 1.25 * nonnull / ndistinct : 0;
+
+        for (i = 0; i < num_mcv; i++)
+        {
+            if (mcv[i].weight < mincount)
+            {
+                num_mcv = i;
+                break;
+            }
+        }
+    }
+
+    if (num_mcv > 0)
+    {
+        MemoryContext old_context;
+        Datum       *mcv_values;
+        float4       *mcv_freqs;
+
+        old_context = MemoryContextSwitchTo(stats->anl_context);
+        mcv_values = (Datum *) palloc(num_mcv * sizeof(Datum));
+        mcv_freqs = (float4 *) palloc(num_mcv * sizeof(float4));
+        for (i = 0; i < num_mcv; i++)
+        {
+            mcv_values[i] = datumCopy(mcv[i].value,
+                                      stats->attrtype->typbyval,
+                                      stats->attrtype->typlen);
+            mcv_freqs[i] = mcv[i].weight / totalrows;
+        }
+        MemoryContextSwitchTo(old_context);
+
+        stats->stakind[slot_idx] = STATISTIC_KIND_MCV;
+        stats->staop[slot_idx] = eqopr;
+        stats->stanumbers[slot_idx] = mcv_freqs;
+        stats->numnumbers[slot_idx] = num_mcv;
+        stats->stavalues[slot_idx] = mcv_values;
+        stats->numvalues[slot_idx] = num_mcv;
+        slot_idx++;
+    }
+
+    for (i = num_mcv; i < nmcv && OidIsValid(ltopr); i++)
+        points[npoints++] = mcv[i];
+
+    /*
+     * Cut the merged points into bins of the same number of rows, with the
+     * smallest and the largest as the ends.
+     */
+    if (OidIsValid(ltopr) && npoints >= 2)
+    {
+        SortSupportData ssup;
+        int            num_hist = Min(npoints, stattarget + 1);
+        double        total_weight = 0;
+        double        cum_weight = 0;
+
+        memset(&ssup, 0, sizeof(ssup));
+        ssup.ssup_cxt = CurrentMemoryContext;
+        ssup.ssup_collation = collation;
+        ssup.ssup_nulls_first = false;
+        PrepareSortSupportFromOrderingOp(ltopr, &ssup);
+
+        qsort_arg(points, npoints, sizeof(WeightedValue),
+                  compare_weighted_values, &ssup);
+
+        for (i = 0; i < npoints; i++)
+            total_weight += points[i].weight;
+
+        if (num_hist >= 2 && total_weight > 0)
+        {
+            MemoryContext old_context;
+            Datum       *hist_values;
+
+            old_context = MemoryContextSwitchTo(stats->anl_context);
+            hist_values = (Datum *) palloc(num_hist * sizeof(Datum));
+            j = 0;
+            for (i = 0; i < num_hist; i++)
+            {
+                double        target = total_weight * i / (num_hist - 1);
+
+                if (i == num_hist - 1)
+                    j = npoints - 1;
+                else if (i > 0)
+                {
+                    while (j < npoints - 1 &&
+                           cum_weight + points[j].weight < target)
+                        cum_weight += points[j++].weight;
+                }
+                hist_values[i] = datumCopy(points[j].value,
+                                           stats->attrtype->typbyval,
+                                           stats->attrtype->typlen);
+            }
+            MemoryContextSwitchTo(old_context);
+
+            stats->stakind[slot_idx] = STATISTIC_KIND_HISTOGRAM;
+            stats->staop[slot_idx] = ltopr;
+            stats->stavalues[slot_idx] = hist_values;
+            stats->numvalues[slot_idx] = num_hist;
+            slot_idx++;
+        }
+    }
+
+    /* how ordered the rows of each partition are, on average */
+    if (OidIsValid(ltopr) && corr_known && nonnull > 0)
+    {
+        MemoryContext old_context;
+        float4       *corrs;
+
+        old_context = MemoryContextSwitchTo(stats->anl_context);
+        corrs = (float4 *) palloc(sizeof(float4));
+        MemoryContextSwitchTo(old_context);
+        corrs[0] = corr_sum / nonnull;
+
+        stats->stakind[slot_idx] = STATISTIC_KIND_CORRELATION;
+        stats->staop[slot_idx] = ltopr;
+        stats->stanumbers[slot_idx] = corrs;
+        stats->numnumbers[slot_idx] = 1;
+        slot_idx++;
+    }
+}
+
+/* qsort comparator for WeightedValues, most rows first */
+static int
+compare_weight_desc(const void *a, const void *b)
+{
+    double        wa = ((const WeightedValue *) a)->weight;
+    double        wb = ((const WeightedValue *) b)->weight;
+
+    if (wa > wb)
+        return -1;
+    if (wa < wb)
+        return 1;
+    return 0;
+}
+
+/* qsort_arg comparator for WeightedValues, by value */
+static int
+compare_weighted_values(const void *a, const void *b, void *arg)
+{
+    SortSupport ssup = (SortSupport) arg;
+
+    return ApplySortComparator(((const WeightedValue *) a)->value, false,
+                               ((const WeightedValue *) b)->value, false,
+                               ssup);
+}
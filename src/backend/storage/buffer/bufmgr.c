@@ -59,6 +59,7 @@
 #include "utils/mls.h"
 #include "utils/relcrypt.h"
 #include "storage/relcryptstorage.h"
+#include "storage/relcryptpagecache.h"
 #endif
 
 
@@ -938,70 +939,99 @@ ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
         {
             instr_time    io_start,
                         io_time;
+#ifdef _MLS_
+            bool        crypt_cached = false;
+            bool        crypt_cacheable;
 
-            if (track_io_timing)
-                INSTR_TIME_SET_CURRENT(io_start);
-
-			BufDisableMemoryProtection(bufBlock, isLocalBuf);
-            smgrread(smgr, forkNum, blockNum, (char *) bufBlock);
-			BufEnableMemoryProtection(bufBlock, isLocalBuf);
-
-            if (track_io_timing)
+            /*
+             * Pages of crypted relations may have a decrypted image in the
+             * rel crypt page cache, then there is no io and no decrypt.
+             */
+            crypt_cacheable = !isLocalBuf
+                && REL_CRYPT_PAGE_CACHE_ENABLED()
+                && REL_CRYPT_PAGE_CACHE_FORK(forkNum)
+                && REL_CRYPT_ENTRY_IS_VALID(&(smgr->smgr_relcrypt));
+            if (crypt_cacheable)
             {
-                INSTR_TIME_SET_CURRENT(io_time);
-                INSTR_TIME_SUBTRACT(io_time, io_start);
-                pgstat_count_buffer_read_time(INSTR_TIME_GET_MICROSEC(io_time));
-                INSTR_TIME_ADD(pgBufferUsage.blk_read_time, io_time);
+				BufDisableMemoryProtection(bufBlock, isLocalBuf);
+                crypt_cached = rel_crypt_page_cache_read(smgr, forkNum, blockNum, (char *) bufBlock);
+				BufEnableMemoryProtection(bufBlock, isLocalBuf);
             }
-#ifdef _MLS_
-            /* before verify, decrypt if needed */
-            if (MAIN_FORKNUM == forkNum || EXTENT_FORKNUM == forkNum)
+
+            if (!crypt_cached)
             {
-                algo_id = PageGetAlgorithmId(bufBlock);
-                if (TRANSP_CRYPT_ALGO_ID_IS_VALID(algo_id))
+#endif
+                if (track_io_timing)
+                    INSTR_TIME_SET_CURRENT(io_start);
+
+			    BufDisableMemoryProtection(bufBlock, isLocalBuf);
+                smgrread(smgr, forkNum, blockNum, (char *) bufBlock);
+			    BufEnableMemoryProtection(bufBlock, isLocalBuf);
+
+                if (track_io_timing)
                 {
-                    if (algo_id == smgr->smgr_relcrypt.algo_id)
-                    {
-						BufDisableMemoryProtection(bufBlock, isLocalBuf);
-                        rel_crypt_page_decrypt(&(smgr->smgr_relcrypt), (Page)bufBlock);
-						BufEnableMemoryProtection(bufBlock, isLocalBuf);
-                    }
-                    else
+                    INSTR_TIME_SET_CURRENT(io_time);
+                    INSTR_TIME_SUBTRACT(io_time, io_start);
+                    pgstat_count_buffer_read_time(INSTR_TIME_GET_MICROSEC(io_time));
+                    INSTR_TIME_ADD(pgBufferUsage.blk_read_time, io_time);
+                }
+#ifdef _MLS_
+                /* before verify, decrypt if needed */
+                if (MAIN_FORKNUM == forkNum || EXTENT_FORKNUM == forkNum)
+                {
+                    algo_id = PageGetAlgorithmId(bufBlock);
+                    if (TRANSP_CRYPT_ALGO_ID_IS_VALID(algo_id))
                     {
-                        elog(LOG, "found one page whose algo_id:%d diffs with smgr_relcrypt_algo_id:%d, relfilenode:%d:%d:%d, forknum:%d, blknum:%d",
-                                    algo_id,
-                                    smgr->smgr_relcrypt.algo_id,
-                                    smgr->smgr_rnode.node.dbNode, smgr->smgr_rnode.node.spcNode, smgr->smgr_rnode.node.relNode,
-                                    forkNum, blockNum);
+                        if (algo_id == smgr->smgr_relcrypt.algo_id)
+                        {
+						    BufDisableMemoryProtection(bufBlock, isLocalBuf);
+                            rel_crypt_page_decrypt(&(smgr->smgr_relcrypt), (Page)bufBlock);
+						    BufEnableMemoryProtection(bufBlock, isLocalBuf);
+                        }
+                        else
+                        {
+                            elog(LOG, "found one page whose algo_id:%d diffs with smgr_relcrypt_algo_id:%d, relfilenode:%d:%d:%d, forknum:%d, blknum:%d",
+                                        algo_id,
+                                        smgr->smgr_relcrypt.algo_id,
+                                        smgr->smgr_rnode.node.dbNode, smgr->smgr_rnode.node.spcNode, smgr->smgr_rnode.node.relNode,
+                                        forkNum, blockNum);
+                        }
                     }
                 }
-            }
 #endif
-            /* check for garbage data */
-            if (!PageIsVerified((Page) bufBlock, blockNum))
-            {
-                if (mode == RBM_ZERO_ON_ERROR || zero_damaged_pages)
+                /* check for garbage data */
+                if (!PageIsVerified((Page) bufBlock, blockNum))
                 {
-                    ereport(WARNING,
-                            (errcode(ERRCODE_DATA_CORRUPTED),
-                             errmsg("invalid page in block %u of relation %s; zeroing out page",
-                                    blockNum,
-                                    relpath(smgr->smgr_rnode, forkNum))));
-
-					BufDisableMemoryProtection(bufBlock, isLocalBuf);
-                    MemSet((char *) bufBlock, 0, BLCKSZ);
-					BufEnableMemoryProtection(bufBlock, isLocalBuf);
+                    if (mode == RBM_ZERO_ON_ERROR || zero_damaged_pages)
+                    {
+                        ereport(WARNING,
+                                (errcode(ERRCODE_DATA_CORRUPTED),
+                                 errmsg("invalid page in block %u of relation %s; zeroing out page",
+                                        blockNum,
+                                        relpath(smgr->smgr_rnode, forkNum))));
+
+					    BufDisableMemoryProtection(bufBlock, isLocalBuf);
+                        MemSet((char *) bufBlock, 0, BLCKSZ);
+					    BufEnableMemoryProtection(bufBlock, isLocalBuf);
+                    }
+                    else
+                    {
+                        print_page_header((PageHeader)bufBlock);
+                        ereport(ERROR,
+                                (errcode(ERRCODE_DATA_CORRUPTED),
+                                 errmsg("invalid page in block %u of relation %s, forkNum:%d",
+                                        blockNum,
+                                        relpath(smgr->smgr_rnode, forkNum), forkNum)));
+                    }
                 }
-                else
+#ifdef _MLS_
+                /* only pages which really were decrypted are worth caching */
+                if (crypt_cacheable && PageGetAlgorithmId(bufBlock) == smgr->smgr_relcrypt.algo_id)
                 {
-                    print_page_header((PageHeader)bufBlock);
-                    ereport(ERROR,
-                            (errcode(ERRCODE_DATA_CORRUPTED),
-                             errmsg("invalid page in block %u of relation %s, forkNum:%d",
-                                    blockNum,
-                                    relpath(smgr->smgr_rnode, forkNum), forkNum)));
+                    rel_crypt_page_cache_insert(smgr, forkNum, blockNum, (char *) bufBlock);
                 }
             }
+#endif
         }
     }
 
@@ -3285,6 +3315,9 @@ DropDatabaseBuffers(Oid dbid)
      * We needn't consider local buffers, since by assumption the target
      * database isn't our own.
      */
+#ifdef _MLS_
+    rel_crypt_page_cache_drop_database(dbid);
+#endif
 
     for (i = 0; i < NBuffers; i++)
     {
@@ -0,0 +1,563 @@
+/*-------------------------------------------------------------------------
+ *
+ * relcryptpagecache.c
+ *      shared cache of decrypted pages of crypted relations.
+ *
+ * Pages of crypted relations are decrypted every time they are read into
+ * shared buffers, so a working set a bit larger than shared_buffers pays
+ * the decrypt cost over and over.  This cache keeps the decrypted images
+ * of recently read pages, ReadBuffer looks here before going to smgr and
+ * copies the page without any io or decrypt on a hit.
+ *
+ * The cache is split into partitions, every partition owns a fixed range
+ * of slots and the lwlock of the partition protects the mapping entries
+ * and slots of the partition.  A tag only ever lives in the slots of the
+ * partition its hash maps to, so eviction is a clock sweep inside one
+ * partition under one lock.
+ *
+ * A cached image is only valid as long as the block on disk is unchanged.
+ * smgrwrite and smgrextend invalidate the block, smgrtruncate and the
+ * unlink routines drop the dropped blocks.  While a block is in shared
+ * buffers the buffer is the only one reading or writing it, so a reader
+ * can never insert an image older than the one on disk.  None of this
+ * looks at the relcrypt of the smgr relation, which may be stale in this
+ * backend, every write of a cacheable fork invalidates.
+ *
+ * Every image also remembers the algorithm it was decrypted with, and is
+ * only handed to a reader whose relcrypt has the same one.  A change of
+ * the crypt policy of a relfilenode drops all its images.
+ *
+ * Copyright (c) 2023 THL A29 Limited, a Tencent company.
+ *
+ * This source code file is licensed under the BSD 3-Clause License,
+ * you may obtain a copy of the License at http://opensource.org/license/bsd-3-clause/
+ *
+ * IDENTIFICATION
+ *      src/backend/storage/buffer/relcryptpagecache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "port/atomics.h"
+#include "storage/buf_internals.h"
+#include "storage/lwlock.h"
+#include "storage/relcryptpagecache.h"
+#include "storage/shmem.h"
+#include "utils/builtins.h"
+#include "utils/hsearch.h"
+#include "utils/relcrypt.h"
+
+#ifdef _MLS_
+
+/* must be a power of 2, see HASH_PARTITION */
+#define REL_CRYPT_PAGE_CACHE_PARTITIONS     128
+
+/* saturation of the clock sweep usage count */
+#define REL_CRYPT_PAGE_CACHE_MAX_USAGE      3
+
+int g_rel_crypt_page_cache_size = 0;
+
+typedef struct RelCryptPageCacheEnt
+{
+    BufferTag   key;            /* tag of the cached block */
+    int         slot;           /* slot holding its decrypted image */
+} RelCryptPageCacheEnt;
+
+typedef struct RelCryptPageCacheSlot
+{
+    BufferTag   tag;            /* valid only if 'valid' */
+    AlgoId      algo_id;        /* algorithm the image was decrypted with */
+    bool        valid;
+    uint8       usage;          /* clock sweep usage count */
+} RelCryptPageCacheSlot;
+
+typedef struct RelCryptPageCacheCtl
+{
+    int             nslots;
+    int             lwlock_tranche_id;
+    LWLockPadded    locks[REL_CRYPT_PAGE_CACHE_PARTITIONS];
+    int             clock_hand[REL_CRYPT_PAGE_CACHE_PARTITIONS];  /* offset inside the partition */
+
+    /* statistics */
+    pg_atomic_uint64 hits;
+    pg_atomic_uint64 misses;
+    pg_atomic_uint64 inserts;
+    pg_atomic_uint64 evictions;
+    pg_atomic_uint64 invalidations;
+} RelCryptPageCacheCtl;
+
+static RelCryptPageCacheCtl  *g_page_cache_ctl   = NULL;
+static RelCryptPageCacheSlot *g_page_cache_slots = NULL;
+static char                  *g_page_cache_pages = NULL;
+static HTAB                  *g_page_cache_hash  = NULL;
+
+#define page_cache_partition(_hashcode)      ((_hashcode) % REL_CRYPT_PAGE_CACHE_PARTITIONS)
+#define page_cache_partition_lock(_partid)   (&(g_page_cache_ctl->locks[(_partid)].lock))
+#define page_cache_partition_first(_partid) \
+    ((int) (((int64) (_partid) * g_page_cache_ctl->nslots) / REL_CRYPT_PAGE_CACHE_PARTITIONS))
+#define page_cache_page(_slot)               (g_page_cache_pages + (Size) (_slot) * BLCKSZ)
+
+static int rel_crypt_page_cache_nslots(void);
+static void rel_crypt_page_cache_set_tag(BufferTag *tag, SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum);
+static void rel_crypt_page_cache_remove_slot(int slot);
+static void rel_crypt_page_cache_drop_matching(RelFileNode *rnode, Oid dbid, ForkNumber forknum, BlockNumber firstDelBlock);
+
+/*
+ * a non zero cache size smaller than the number of partitions would leave
+ * partitions without slots, round it up.
+ */
+static int rel_crypt_page_cache_nslots(void)
+{
+    if (g_rel_crypt_page_cache_size <= 0)
+    {
+        return 0;
+    }
+
+    return Max(g_rel_crypt_page_cache_size, REL_CRYPT_PAGE_CACHE_PARTITIONS);
+}
+
+Size rel_crypt_page_cache_shmem_size(void)
+{
+    Size size;
+    int  nslots = rel_crypt_page_cache_nslots();
+
+    if (0 == nslots)
+    {
+        return 0;
+    }
+
+    size = MAXALIGN(sizeof(RelCryptPageCacheCtl));
+    size = add_size(size, MAXALIGN(mul_size(nslots, sizeof(RelCryptPageCacheSlot))));
+    /* pages are BLCKSZ aligned, as the buffer pool */
+    size = add_size(size, add_size(mul_size(nslots, BLCKSZ), BLCKSZ));
+    size = add_size(size, hash_estimate_size(nslots, sizeof(RelCryptPageCacheEnt)));
+
+    return size;
+}
+
+void rel_crypt_page_cache_init(void)
+{
+    HASHCTL info;
+    bool    found_ctl;
+    bool    found_slots;
+    bool    found_pages;
+    int     nslots = rel_crypt_page_cache_nslots();
+    int     i;
+
+    if (0 == nslots)
+    {
+        return;
+    }
+
+    g_page_cache_ctl = (RelCryptPageCacheCtl *)
+        ShmemInitStruct("rel crypt page cache ctl", sizeof(RelCryptPageCacheCtl), &found_ctl);
+    g_page_cache_slots = (RelCryptPageCacheSlot *)
+        ShmemInitStruct("rel crypt page cache slots", mul_size(nslots, sizeof(RelCryptPageCacheSlot)), &found_slots);
+    g_page_cache_pages = (char *)
+        TYPEALIGN(BLCKSZ, ShmemInitStruct("rel crypt page cache pages",
+                                          add_size(mul_size(nslots, BLCKSZ), BLCKSZ),
+                                          &found_pages));
+
+    info.keysize        = sizeof(BufferTag);
+    info.entrysize      = sizeof(RelCryptPageCacheEnt);
+    info.num_partitions = REL_CRYPT_PAGE_CACHE_PARTITIONS;
+    g_page_cache_hash = ShmemInitHash("rel crypt page cache",
+                                      nslots, nslots,
+                                      &info,
+                                      HASH_ELEM | HASH_BLOBS | HASH_PARTITION);
+
+    if (false == found_ctl)
+    {
+        g_page_cache_ctl->nslots            = nslots;
+        g_page_cache_ctl->lwlock_tranche_id = LWTRANCHE_REL_CRYPT_PAGE_CACHE;
+
+        for (i = 0; i < REL_CRYPT_PAGE_CACHE_PARTITIONS; i++)
+        {
+            LWLockInitialize(&(g_page_cache_ctl->locks[i].lock), g_page_cache_ctl->lwlock_tranche_id);
+            g_page_cache_ctl->clock_hand[i] = 0;
+        }
+
+        pg_atomic_init_u64(&g_page_cache_ctl->hits, 0);
+        pg_atomic_init_u64(&g_page_cache_ctl->misses, 0);
+        pg_atomic_init_u64(&g_page_cache_ctl->inserts, 0);
+        pg_atomic_init_u64(&g_page_cache_ctl->evictions, 0);
+        pg_atomic_init_u64(&g_page_cache_ctl->invalidations, 0);
+
+        for (i = 0; i < nslots; i++)
+        {
+            g_page_cache_slots[i].valid   = false;
+            g_page_cache_slots[i].algo_id = TRANSP_CRYPT_INVALID_ALGORITHM_ID;
+            g_page_cache_slots[i].usage = 0;
+        }
+    }
+
+    LWLockRegisterTranche(g_page_cache_ctl->lwlock_tranche_id, "rel crypt page cache");
+
+    return;
+}
+
+static void rel_crypt_page_cache_set_tag(BufferTag *tag, SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum)
+{
+    /* the hash key is the whole struct, zero any padding */
+    MemSet(tag, 0, sizeof(BufferTag));
+    INIT_BUFFERTAG(*tag, reln->smgr_rnode.node, forknum, blocknum);
+}
+
+/*
+ * forget the block held by slot, caller holds the partition lock exclusively.
+ */
+static void rel_crypt_page_cache_remove_slot(int slot)
+{
+    RelCryptPageCacheSlot *s = &g_page_cache_slots[slot];
+    bool                   found;
+
+    hash_search(g_page_cache_hash, (void *) &s->tag, HASH_REMOVE, &found);
+    Assert(found);
+
+    s->valid = false;
+    s->usage = 0;
+}
+
+/*
+ * copy the decrypted image of the block into buffer if it is cached.
+ */
+bool rel_crypt_page_cache_read(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char *buffer)
+{
+    BufferTag              tag;
+    uint32                 hashcode;
+    LWLock                *partition_lock;
+    RelCryptPageCacheEnt  *ent;
+    RelCryptPageCacheSlot *s;
+
+    if (NULL == g_page_cache_ctl)
+    {
+        return false;
+    }
+
+    rel_crypt_page_cache_set_tag(&tag, reln, forknum, blocknum);
+    hashcode       = get_hash_value(g_page_cache_hash, (void *) &tag);
+    partition_lock = page_cache_partition_lock(page_cache_partition(hashcode));
+
+    LWLockAcquire(partition_lock, LW_SHARED);
+    ent = (RelCryptPageCacheEnt *) hash_search_with_hash_value(g_page_cache_hash,
+                                                               (void *) &tag,
+                                                               hashcode,
+                                                               HASH_FIND,
+                                                               NULL);
+    if (NULL == ent || g_page_cache_slots[ent->slot].algo_id != reln->smgr_relcrypt.algo_id)
+    {
+        LWLockRelease(partition_lock);
+        pg_atomic_fetch_add_u64(&g_page_cache_ctl->misses, 1);
+        return false;
+    }
+
+    memcpy(buffer, page_cache_page(ent->slot), BLCKSZ);
+
+    /* a racy bump is fine, usage is only a hint for the sweep */
+    s = &g_page_cache_slots[ent->slot];
+    if (s->usage < REL_CRYPT_PAGE_CACHE_MAX_USAGE)
+    {
+        s->usage++;
+    }
+    LWLockRelease(partition_lock);
+
+    pg_atomic_fetch_add_u64(&g_page_cache_ctl->hits, 1);
+    return true;
+}
+
+/*
+ * remember the decrypted image of a block just read from disk.
+ */
+void rel_crypt_page_cache_insert(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char *page)
+{
+    BufferTag              tag;
+    uint32                 hashcode;
+    int                    partid;
+    int                    first;
+    int                    nslots;
+    int                    slot;
+    bool                   found;
+    LWLock                *partition_lock;
+    RelCryptPageCacheEnt  *ent;
+    RelCryptPageCacheSlot *s;
+
+    if (NULL == g_page_cache_ctl)
+    {
+        return;
+    }
+
+    rel_crypt_page_cache_set_tag(&tag, reln, forknum, blocknum);
+    hashcode       = get_hash_value(g_page_cache_hash, (void *) &tag);
+    partid         = page_cache_partition(hashcode);
+    partition_lock = page_cache_partition_lock(partid);
+    first          = page_cache_partition_first(partid);
+    nslots         = page_cache_partition_first(partid + 1) - first;
+
+    LWLockAcquire(partition_lock, LW_EXCLUSIVE);
+
+    ent = (RelCryptPageCacheEnt *) hash_search_with_hash_value(g_page_cache_hash,
+                                                               (void *) &tag,
+                                                               hashcode,
+                                                               HASH_FIND,
+                                                               NULL);
+    if (ent)
+    {
+        s = &g_page_cache_slots[ent->slot];
+
+        /* 
+         * someone else read it in meanwhile, the images are the same unless
+         * it was decrypted by a backend with another view of the policy.
+         */
+        if (s->algo_id != reln->smgr_relcrypt.algo_id)
+        {
+            s->algo_id = reln->smgr_relcrypt.algo_id;
+            memcpy(page_cache_page(ent->slot), page, BLCKSZ);
+        }
+        LWLockRelease(partition_lock);
+        return;
+    }
+
+    /* clock sweep inside the partition for a free or cold slot */
+    for (;;)
+    {
+        slot = first + g_page_cache_ctl->clock_hand[partid];
+        g_page_cache_ctl->clock_hand[partid] = (g_page_cache_ctl->clock_hand[partid] + 1) % nslots;
+
+        s = &g_page_cache_slots[slot];
+        if (!s->valid)
+        {
+            break;
+        }
+
+        if (0 == s->usage)
+        {
+            rel_crypt_page_cache_remove_slot(slot);
+            pg_atomic_fetch_add_u64(&g_page_cache_ctl->evictions, 1);
+            break;
+        }
+
+        s->usage--;
+    }
+
+    ent = (RelCryptPageCacheEnt *) hash_search_with_hash_value(g_page_cache_hash,
+                                                               (void *) &tag,
+                                                               hashcode,
+                                                               HASH_ENTER_NULL,
+                                                               &found);
+    if (NULL == ent)
+    {
+        /* can not happen, there are never more entries than slots */
+        LWLockRelease(partition_lock);
+        elog(WARNING, "rel crypt page cache is out of hash entries");
+        return;
+    }
+
+    ent->slot   = slot;
+    s->tag      = tag;
+    s->algo_id  = reln->smgr_relcrypt.algo_id;
+    s->valid    = true;
+    s->usage  = 1;
+    memcpy(page_cache_page(slot), page, BLCKSZ);
+
+    LWLockRelease(partition_lock);
+
+    pg_atomic_fetch_add_u64(&g_page_cache_ctl->inserts, 1);
+}
+
+/*
+ * the block is about to be rewritten on disk, forget its cached image.
+ */
+void rel_crypt_page_cache_invalidate(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum)
+{
+    BufferTag              tag;
+    uint32                 hashcode;
+    int                    partid;
+    LWLock                *partition_lock;
+    RelCryptPageCacheEnt  *ent;
+
+    if (NULL == g_page_cache_ctl)
+    {
+        return;
+    }
+
+    rel_crypt_page_cache_set_tag(&tag, reln, forknum, blocknum);
+    hashcode       = get_hash_value(g_page_cache_hash, (void *) &tag);
+    partid         = page_cache_partition(hashcode);
+    partition_lock = page_cache_partition_lock(partid);
+
+    /* 
+     * every write of a cacheable fork comes here, crypted or not, so look
+     * under the shared lock first, most blocks are not cached.
+     */
+    LWLockAcquire(partition_lock, LW_SHARED);
+    ent = (RelCryptPageCacheEnt *) hash_search_with_hash_value(g_page_cache_hash,
+                                                               (void *) &tag,
+                                                               hashcode,
+                                                               HASH_FIND,
+                                                               NULL);
+    LWLockRelease(partition_lock);
+    if (NULL == ent)
+    {
+        return;
+    }
+
+    LWLockAcquire(partition_lock, LW_EXCLUSIVE);
+    ent = (RelCryptPageCacheEnt *) hash_search_with_hash_value(g_page_cache_hash,
+                                                               (void *) &tag,
+                                                               hashcode,
+                                                               HASH_FIND,
+                                                               NULL);
+    if (ent)
+    {
+        rel_crypt_page_cache_remove_slot(ent->slot);
+        pg_atomic_fetch_add_u64(&g_page_cache_ctl->invalidations, 1);
+    }
+    LWLockRelease(partition_lock);
+}
+
+/*
+ * walk the whole cache and drop the blocks of relation rnode, or of every
+ * relation of database dbid when rnode is NULL, which belong to forknum
+ * (any fork if InvalidForkNumber) and are at or beyond firstDelBlock.
+ */
+static void rel_crypt_page_cache_drop_matching(RelFileNode *rnode, Oid dbid, ForkNumber forknum, BlockNumber firstDelBlock)
+{
+    int partid;
+    int slot;
+    int last;
+
+    for (partid = 0; partid < REL_CRYPT_PAGE_CACHE_PARTITIONS; partid++)
+    {
+        LWLock *partition_lock = page_cache_partition_lock(partid);
+
+        last = page_cache_partition_first(partid + 1);
+
+        LWLockAcquire(partition_lock, LW_EXCLUSIVE);
+        for (slot = page_cache_partition_first(partid); slot < last; slot++)
+        {
+            RelCryptPageCacheSlot *s = &g_page_cache_slots[slot];
+
+            if (!s->valid)
+            {
+                continue;
+            }
+
+            if (rnode ? !RelFileNodeEquals(s->tag.rnode, *rnode) : s->tag.rnode.dbNode != dbid)
+            {
+                continue;
+            }
+
+            if ((InvalidForkNumber == forknum || s->tag.forkNum == forknum)
+                && s->tag.blockNum >= firstDelBlock)
+            {
+                rel_crypt_page_cache_remove_slot(slot);
+                pg_atomic_fetch_add_u64(&g_page_cache_ctl->invalidations, 1);
+            }
+        }
+        LWLockRelease(partition_lock);
+    }
+}
+
+/*
+ * drop the cached blocks of the relation at or beyond firstDelBlock, of the
+ * given fork or all forks if forknum is InvalidForkNumber.  used by truncate
+ * and unlink.
+ */
+void rel_crypt_page_cache_drop(SMgrRelation reln, ForkNumber forknum, BlockNumber firstDelBlock)
+{
+    if (NULL == g_page_cache_ctl)
+    {
+        return;
+    }
+
+    rel_crypt_page_cache_drop_matching(&(reln->smgr_rnode.node), InvalidOid, forknum, firstDelBlock);
+}
+
+/*
+ * the crypt policy of relfilenode rnode changed, images decrypted under the
+ * old one must not be handed out any more.
+ */
+void rel_crypt_page_cache_drop_rnode(RelFileNode *rnode)
+{
+    if (NULL == g_page_cache_ctl)
+    {
+        return;
+    }
+
+    rel_crypt_page_cache_drop_matching(rnode, InvalidOid, InvalidForkNumber, 0);
+}
+
+/*
+ * drop all cached blocks of a database which is being dropped.
+ */
+void rel_crypt_page_cache_drop_database(Oid dbid)
+{
+    if (NULL == g_page_cache_ctl)
+    {
+        return;
+    }
+
+    rel_crypt_page_cache_drop_matching(NULL, dbid, InvalidForkNumber, 0);
+}
+
+/*
+ * show size and counters of the decrypted page cache.
+ */
+Datum pg_rel_crypt_page_cache_stats(PG_FUNCTION_ARGS)
+{
+#define PG_REL_CRYPT_PAGE_CACHE_STATS_COLUMN_NUM    7
+    TupleDesc   tupdesc;
+    Datum       values[PG_REL_CRYPT_PAGE_CACHE_STATS_COLUMN_NUM];
+    bool        nulls[PG_REL_CRYPT_PAGE_CACHE_STATS_COLUMN_NUM];
+    int64       used = 0;
+    int         partid;
+    int         i;
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+        elog(ERROR, "return type must be a row type");
+
+    memset(nulls, false, sizeof(nulls));
+
+    if (NULL == g_page_cache_ctl)
+    {
+        values[0] = Int32GetDatum(0);
+        for (i = 1; i < PG_REL_CRYPT_PAGE_CACHE_STATS_COLUMN_NUM; i++)
+        {
+            values[i] = Int64GetDatum(0);
+        }
+        PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+    }
+
+    for (partid = 0; partid < REL_CRYPT_PAGE_CACHE_PARTITIONS; partid++)
+    {
+        LWLock *partition_lock = page_cache_partition_lock(partid);
+        int     last           = page_cache_partition_first(partid + 1);
+        int     slot;
+
+        LWLockAcquire(partition_lock, LW_SHARED);
+        for (slot = page_cache_partition_first(partid); slot < last; slot++)
+        {
+            if (g_page_cache_slots[slot].valid)
+            {
+                used++;
+            }
+        }
+        LWLockRelease(partition_lock);
+    }
+
+    values[0] = Int32GetDatum(g_page_cache_ctl->nslots);
+    values[1] = Int64GetDatum(used);
+    values[2] = Int64GetDatum((int64) pg_atomic_read_u64(&g_page_cache_ctl->hits));
+    values[3] = Int64GetDatum((int64) pg_atomic_read_u64(&g_page_cache_ctl->misses));
+    values[4] = Int64GetDatum((int64) pg_atomic_read_u64(&g_page_cache_ctl->inserts));
+    values[5] = Int64GetDatum((int64) pg_atomic_read_u64(&g_page_cache_ctl->evictions));
+    values[6] = Int64GetDatum((int64) pg_atomic_read_u64(&g_page_cache_ctl->invalidations));
+
+    PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
+
+#endif
@@ -597,20 +597,88 @@ eob_page_mark_extent(EOBPage eob_pg, int local_bms_offset, bool setfree)
     }
 }
 
+/*
+ * eob_page_find_free
+ *        Return the first free extent bit of an EOB page, or -1 if none.
+ *
+ * The page is only read, so a share lock is enough.  first_empty_extent is
+ * a lower bound that may lag behind the bitmap, so it is only used as the
+ * starting point of the search.
+ */
+static int
+eob_page_find_free(EOBPage pg)
+{
+    int        next_free;
+
+    if(pg->first_empty_extent >= 0)
+    {
+        if(EOB_FIRSTFREE_IS_FREE(pg))
+            return pg->first_empty_extent;
+        next_free = EOB_NEXT_FREE(pg, pg->first_empty_extent);
+    }
+    else
+        next_free = EOB_FIRST_FREE(pg);
+
+    return next_free >= 0 ? next_free : -1;
+}
+
+/*
+ * eob_search_start
+ *        EOB page a free extent search should start at.
+ *
+ * Each backend remembers in its smgr entry the EOB page where it last found
+ * a free extent.  Pages in front of it were full at that time, so starting
+ * there avoids probing every full page of a large relation on each
+ * allocation.  Extents can be freed behind the hint, which is why callers
+ * wrap around to the first EOB page before giving up.
+ */
+static BlockNumber
+eob_search_start(Relation rel)
+{
+    BlockNumber hint;
+
+    RelationOpenSmgr(rel);
+    hint = rel->rd_smgr->smgr_eob_hint;
+    if(!BlockNumberIsValid(hint) || hint < EOBPAGE_OFFSET || hint >= ESAPAGE_OFFSET)
+        hint = EOBPAGE_OFFSET;
+    return hint;
+}
+
+static void
+eob_set_search_start(Relation rel, BlockNumber blk)
+{
+    RelationOpenSmgr(rel);
+    rel->rd_smgr->smgr_eob_hint = blk;
+}
+
 ExtentID
 eob_get_free_extent(Relation rel)
 {// #lizard forgives
-    int     blk;
+    BlockNumber startblk;
+    BlockNumber blk;
+    bool    wrapped = false;
     Buffer     buf;
     EOBPage    pg;
-    int        next_free;
+    int        next_free = -1;
     EOBAddress addr;
-    
-    for(blk = EOBPAGE_OFFSET; blk < ESAPAGE_OFFSET; blk++)
+
+    startblk = eob_search_start(rel);
+    blk = startblk;
+    for(;;)
     {
-        bool    need_move_first_free = false;
-        next_free = -1;        
-        
+        bool    unused_page;
+
+        if(wrapped && blk >= startblk)
+            break;
+        if(blk >= ESAPAGE_OFFSET)
+        {
+            if(wrapped || startblk == EOBPAGE_OFFSET)
+                break;
+            blk = EOBPAGE_OFFSET;
+            wrapped = true;
+            continue;
+        }
+
         buf = extent_readbuffer(rel, blk, true);
         if(BufferIsInvalid(buf))
         {
@@ -620,40 +688,24 @@ eob_get_free_extent(Relation rel)
                          errdetail("reloid:%d, block number:%d",
                                    RelationGetRelid(rel), blk)));
         }
-        
-        LockBuffer(buf, BUFFER_LOCK_SHARE);
 
+        LockBuffer(buf, BUFFER_LOCK_SHARE);
         pg = (EOBPage)PageGetContents(BufferGetPage(buf));
-
-        if(pg->first_empty_extent >= 0)
-        {
-            if(!EOB_FIRSTFREE_IS_FREE(pg))
-            {
-                next_free = EOB_NEXT_FREE(pg, pg->first_empty_extent);
-                need_move_first_free = true;
-            }
-            else
-                next_free = pg->first_empty_extent;
-        }
-        else
-        {
-            next_free = EOB_FIRST_FREE(pg);
-            if(next_free > 0)
-                need_move_first_free = true;
-        }
-        
-        UnlockReleaseBuffer(buf);    
-
-        if(need_move_first_free)
-        {            
-            LockBuffer(buf, BUFFER_LOCK_EXCLUSIVE);
-            pg->first_empty_extent = next_free;
-            MarkBufferDirty(buf);
-            UnlockReleaseBuffer(buf);
-        }
+        unused_page = (pg->n_bits <= 0);
+        if(!unused_page)
+            next_free = eob_page_find_free(pg);
+        UnlockReleaseBuffer(buf);
 
         if(next_free >= 0)
             break;
+
+        if(unused_page)
+        {
+            /* pages after an unused one are unused too */
+            blk = ESAPAGE_OFFSET;
+            continue;
+        }
+        blk++;
     }
 
     if(next_free < 0)
@@ -666,19 +718,43 @@ eob_get_free_extent(Relation rel)
     return eob_address_to_eid(addr);
 }
 
+/*
+ * eob_get_free_extent_and_set_busy
+ *        Find a free extent and mark it busy in the EOB.
+ *
+ * Every inserting backend that runs out of room in its shard's extents comes
+ * through here, so the search is careful about lock traffic: pages are first
+ * probed under a share lock, and only a page that appears to have a free bit
+ * is locked exclusively and rechecked.  Full pages are therefore never
+ * exclusively locked, and the per-backend search hint keeps us from probing
+ * them at all in the common case.
+ */
 ExtentID
 eob_get_free_extent_and_set_busy(Relation rel)
 {// #lizard forgives
-    int     blk;
+    BlockNumber startblk;
+    BlockNumber blk;
+    bool    wrapped = false;
     Buffer     buf;
     EOBPage    pg;
-    int        next_free;
+    int        next_free = -1;
     EOBAddress addr;
-    
-    for(blk = EOBPAGE_OFFSET; blk < ESAPAGE_OFFSET; blk++)
+
+    startblk = eob_search_start(rel);
+    blk = startblk;
+    for(;;)
     {
-        next_free = -1;        
-        
+        if(wrapped && blk >= startblk)
+            break;
+        if(blk >= ESAPAGE_OFFSET)
+        {
+            if(wrapped || startblk == EOBPAGE_OFFSET)
+                break;
+            blk = EOBPAGE_OFFSET;
+            wrapped = true;
+            continue;
+        }
+
         buf = extent_readbuffer(rel, blk, true);
         if(BufferIsInvalid(buf))
         {
@@ -688,46 +764,45 @@ eob_get_free_extent_and_set_busy(Relation rel)
                          errdetail("reloid:%d, block number:%d",
                                    RelationGetRelid(rel), blk)));
         }
-        
-        LockBuffer(buf, BUFFER_LOCK_EXCLUSIVE);
 
+        LockBuffer(buf, BUFFER_LOCK_SHARE);
         pg = (EOBPage)PageGetContents(BufferGetPage(buf));
 
         if(pg->n_bits <= 0)
         {
-            /* this eob page has not be used.*/
+            /* this eob page has not be used, nor have the ones after it. */
             UnlockReleaseBuffer(buf);
-            break;
+            blk = ESAPAGE_OFFSET;
+            continue;
         }
 
-        if(pg->first_empty_extent >= 0)
+        if(eob_page_find_free(pg) < 0)
         {
-            if(!EOB_FIRSTFREE_IS_FREE(pg))
-            {
-                next_free = EOB_NEXT_FREE(pg, pg->first_empty_extent);
-                pg->first_empty_extent = next_free;
-                MarkBufferDirty(buf);
-            }
-            else
-                next_free = pg->first_empty_extent;
-        }
-        else
-        {
-            next_free = EOB_FIRST_FREE(pg);
-            pg->first_empty_extent = next_free;
-            MarkBufferDirty(buf);
+            UnlockReleaseBuffer(buf);
+            blk++;
+            continue;
         }
 
+        /*
+         * Looks like there is room on this page.  Upgrade to an exclusive lock
+         * and search again, someone may have taken the bit meanwhile.
+         */
+        LockBuffer(buf, BUFFER_LOCK_UNLOCK);
+        LockBuffer(buf, BUFFER_LOCK_EXCLUSIVE);
+
+        next_free = eob_page_find_free(pg);
         if(next_free >= 0)
         {
+            pg->first_empty_extent = next_free;
             eob_page_mark_extent(pg, next_free, false);
             MarkBufferDirty(buf);
         }
-        
-        UnlockReleaseBuffer(buf);    
+
+        UnlockReleaseBuffer(buf);
 
         if(next_free >= 0)
             break;
+        blk++;
     }
 
     if(next_free < 0)
@@ -736,6 +811,8 @@ eob_get_free_extent_and_set_busy(Relation rel)
         return InvalidExtentID;
     }
 
+    eob_set_search_start(rel, blk);
+
     addr.physical_page_number = blk;
     addr.local_bms_offset = next_free;
     return eob_address_to_eid(addr);
@@ -5046,7 +5123,18 @@ shard_remove_extent_from_scanlist(Relation rel, ExtentID eid, bool ignore_error,
 
 
 
-ExtentID 
+/*
+ * shard_apply_free_extent
+ *        Take one free extent from the EOB and attach it to a shard.
+ *
+ * Free extents are taken one at a time.  The busy bit set in the EOB is not
+ * WAL-logged, and nothing frees an extent that is busy in the EOB but
+ * attached to no shard, so extents reserved ahead of need could leak.  The
+ * batches are made when the relation is extended instead, where the new
+ * extents are attached to the shard in the same record, see
+ * ExtendExtentsForShard.
+ */
+ExtentID
 shard_apply_free_extent(Relation rel, ShardID sid)
 {
     ExtentID     eid;
@@ -5310,6 +5398,315 @@ extent_mapping_error:
     elog(ERROR, "extentmapping is error. ema_error:%d, eob_error:%d", ema_error, eob_error);
 }
 
+/*
+ * Extend up to nextents extents from eid on for one shard at once.
+ *
+ * Backends queued on the relation extension lock are likely to need a new
+ * extent as well, so the holder links a batch of them to the lists of its
+ * shard.  The batch is cut so that its EOB bits and EMEs lie on one EOB page
+ * and one EMA page, and the whole batch is logged by a single
+ * XLOG_EXTENT_APPEND_EXTENT record.  Returns the number of extents added.
+ */
+int
+ExtendExtentsForShard(Relation rel, ShardID sid, ExtentID eid, int nextents)
+{// #lizard forgives
+    EMAShardAnchor anchor;
+    EOBAddress    eob_addr;
+    EMAAddress    targ_addr;
+    EMAAddress    alloc_addr = {0, 0};
+    EMAAddress    scan_addr = {0, 0};
+    ESAAddress    esa_addr;
+    Buffer        eob_buf;
+    Buffer        esa_buf;
+    Buffer        ema_bufs[3];
+    BlockNumber    ema_blks[3];
+    int            n_ema = 0;
+    int            targ_idx = -1;
+    int            alloc_idx = -1;
+    int            scan_idx = -1;
+    ExtentID    last_eid;
+    int            i;
+    int            j;
+    XLogRecPtr    recptr;
+    xl_extent_extendeob xlrec_eob;
+    xl_extent_setesa esa_xlrec;
+    xl_extent_seteme alloc_xlrec;
+    xl_extent_seteme scan_xlrec;
+    xl_extent_seteme targ_xlrec[MAX_EXTENTS_PER_EXTEND];
+    xl_extent_extendeme xlrec_ex;
+
+    eob_addr = eob_eid_to_address(eid);
+    targ_addr = ema_eid_to_address(eid);
+
+    nextents = Min(nextents, MAX_EXTENTS_PER_EXTEND);
+    nextents = Min(nextents, EOBS_PER_PAGE - eob_addr.local_bms_offset);
+    nextents = Min(nextents, EMES_PER_PAGE - targ_addr.local_idx);
+    if(nextents <= 1)
+    {
+        ExtendExtentForShard(rel, sid, eid, MAX_FREESPACE, false);
+        return 1;
+    }
+
+    INIT_EXLOG_EXTENDEOB(&xlrec_eob);
+    INIT_EXLOG_SETESA(&esa_xlrec);
+    INIT_EXLOG_SETEME(&alloc_xlrec);
+    INIT_EXLOG_SETEME(&scan_xlrec);
+    INIT_EXLOG_EXTENDEME(&xlrec_ex);
+
+    XLogEnsureRecordSpace(4, nextents + 5);
+
+    LockShard(rel, sid, ExclusiveLock);
+    anchor = esa_get_anchor(rel, sid);
+
+    /*
+     * the EMA pages touched: the ones of the two list tails and the one of
+     * the new extents.  They are locked in block order.
+     */
+    ema_blks[n_ema++] = targ_addr.physical_page_number;
+    if(ExtentIdIsValid(anchor.alloc_tail))
+    {
+        alloc_addr = ema_eid_to_address(anchor.alloc_tail);
+        ema_blks[n_ema++] = alloc_addr.physical_page_number;
+    }
+    if(ExtentIdIsValid(anchor.scan_tail))
+    {
+        scan_addr = ema_eid_to_address(anchor.scan_tail);
+        ema_blks[n_ema++] = scan_addr.physical_page_number;
+    }
+    for(i = 1; i < n_ema; i++)
+    {
+        BlockNumber blk = ema_blks[i];
+
+        for(j = i; j > 0 && ema_blks[j - 1] > blk; j--)
+            ema_blks[j] = ema_blks[j - 1];
+        ema_blks[j] = blk;
+    }
+    for(i = 1, j = 1; i < n_ema; i++)
+    {
+        if(ema_blks[i] != ema_blks[j - 1])
+            ema_blks[j++] = ema_blks[i];
+    }
+    n_ema = j;
+    for(i = 0; i < n_ema; i++)
+    {
+        if(ema_blks[i] == targ_addr.physical_page_number)
+            targ_idx = i;
+        if(ExtentIdIsValid(anchor.alloc_tail) && ema_blks[i] == alloc_addr.physical_page_number)
+            alloc_idx = i;
+        if(ExtentIdIsValid(anchor.scan_tail) && ema_blks[i] == scan_addr.physical_page_number)
+            scan_idx = i;
+    }
+
+    /*
+     * registered block no: 0
+     */
+    eob_buf = extent_readbuffer(rel, eob_addr.physical_page_number, true);
+    if(BufferIsInvalid(eob_buf))
+    {
+        UnlockShard(rel, sid, ExclusiveLock);
+        elog(ERROR, "extentmapping is error. cannot read eob page %d of relation %d.",
+                eob_addr.physical_page_number, RelationGetRelid(rel));
+    }
+    LockBuffer(eob_buf, BUFFER_LOCK_EXCLUSIVE);
+    if(BufferGetEOBPage(eob_buf)->n_bits != eob_addr.local_bms_offset)
+    {
+        int n_bits = BufferGetEOBPage(eob_buf)->n_bits;
+
+        UnlockReleaseBuffer(eob_buf);
+        UnlockShard(rel, sid, ExclusiveLock);
+        elog(ERROR, "extend eob error, emes in eobpage:%d, extending eob local idx: %d",
+                    n_bits, eob_addr.local_bms_offset);
+    }
+    nextents = Min(nextents, BufferGetEOBPage(eob_buf)->max_bits - eob_addr.local_bms_offset);
+
+    /*
+     * registered block no: 1
+     */
+    esa_addr = esa_sid_to_address(sid);
+    esa_buf = extent_readbuffer(rel, esa_addr.physical_page_number, false);
+    ExtentAssert(BufferIsValid(esa_buf));
+    LockBuffer(esa_buf, BUFFER_LOCK_EXCLUSIVE);
+
+    /*
+     * registered block no: 2 ~ 4
+     */
+    for(i = 0; i < n_ema; i++)
+    {
+        ema_bufs[i] = extent_readbuffer(rel, ema_blks[i], i == targ_idx);
+        ExtentAssert(BufferIsValid(ema_bufs[i]));
+        LockBuffer(ema_bufs[i], BUFFER_LOCK_EXCLUSIVE);
+    }
+    if(BufferGetEMAPage(ema_bufs[targ_idx])->n_emes != targ_addr.local_idx)
+    {
+        int n_emes = BufferGetEMAPage(ema_bufs[targ_idx])->n_emes;
+
+        for(i = 0; i < n_ema; i++)
+            UnlockReleaseBuffer(ema_bufs[i]);
+        UnlockReleaseBuffer(esa_buf);
+        UnlockReleaseBuffer(eob_buf);
+        UnlockShard(rel, sid, ExclusiveLock);
+        elog(ERROR, "extend extent error, emes in esapage:%d, extending extent local idx: %d",
+                    n_emes, targ_addr.local_idx);
+    }
+    nextents = Min(nextents, BufferGetEMAPage(ema_bufs[targ_idx])->max_emes - targ_addr.local_idx);
+    last_eid = eid + nextents - 1;
+
+    START_CRIT_SECTION();
+    XLogBeginInsert();
+
+    /*
+     * update eob
+     */
+    BufferGetEOBPage(eob_buf)->n_bits += nextents;
+    MarkBufferDirty(eob_buf);
+    XLogRegisterBuffer(0, eob_buf, REGBUF_KEEP_DATA);
+    xlrec_eob.slot = eob_addr.local_bms_offset + nextents - 1;
+    xlrec_eob.n_eobs = BufferGetEOBPage(eob_buf)->n_bits;
+    xlrec_eob.flags = 0;
+    xlrec_eob.setfree_start = -1;
+    xlrec_eob.setfree_end = -1;
+    XLogRegisterBufData(0, (char *)&xlrec_eob, SizeOfExtendEOB);
+
+    /*
+     * update anchor: the new extents become the tails of both lists, and
+     * the heads of the lists that were empty.
+     */
+    esa_xlrec.slot = esa_addr.local_idx;
+    esa_xlrec.setflag = ESA_SETFLAG_SCANTAIL | ESA_SETFLAG_ALLOCTAIL;
+    INIT_ESA(&esa_xlrec.anchor);
+    esa_xlrec.anchor.scan_tail = last_eid;
+    esa_xlrec.anchor.alloc_tail = last_eid;
+    if(!ExtentIdIsValid(anchor.scan_head))
+    {
+        esa_xlrec.setflag |= ESA_SETFLAG_SCANHEAD;
+        esa_xlrec.anchor.scan_head = eid;
+    }
+    if(!ExtentIdIsValid(anchor.alloc_head))
+    {
+        esa_xlrec.setflag |= ESA_SETFLAG_ALLOCHEAD;
+        esa_xlrec.anchor.alloc_head = eid;
+    }
+    esa_page_set_anchor(BufferGetPage(esa_buf), esa_xlrec.slot, esa_xlrec.setflag,
+                        esa_xlrec.anchor.scan_head, esa_xlrec.anchor.scan_tail,
+                        esa_xlrec.anchor.alloc_head, esa_xlrec.anchor.alloc_tail);
+    MarkBufferDirty(esa_buf);
+    XLogRegisterBuffer(1, esa_buf, REGBUF_KEEP_DATA);
+    XLogRegisterBufData(1, (char *)&esa_xlrec, SizeOfSetESA);
+
+    for(i = 0; i < n_ema; i++)
+        XLogRegisterBuffer(2 + i, ema_bufs[i], REGBUF_KEEP_DATA);
+
+    /*
+     * link the old tails to the first new extent
+     */
+    if(alloc_idx >= 0 && scan_idx >= 0 && anchor.alloc_tail == anchor.scan_tail)
+    {
+        alloc_xlrec.slot = alloc_addr.local_idx;
+        alloc_xlrec.setflag = EMA_SETFLAG_SCANNEXT | EMA_SETFLAG_ALLOCNEXT;
+        INIT_EME(&alloc_xlrec.eme);
+        alloc_xlrec.eme.scan_next = eid;
+        alloc_xlrec.eme.alloc_next = eid;
+        ema_page_set_eme(BufferGetPage(ema_bufs[alloc_idx]), alloc_xlrec.slot,
+                            alloc_xlrec.setflag, &alloc_xlrec.eme);
+        XLogRegisterBufData(2 + alloc_idx, (char *)&alloc_xlrec, SizeOfSetEME);
+    }
+    else
+    {
+        if(alloc_idx >= 0)
+        {
+            alloc_xlrec.slot = alloc_addr.local_idx;
+            alloc_xlrec.setflag = EMA_SETFLAG_ALLOCNEXT;
+            INIT_EME(&alloc_xlrec.eme);
+            alloc_xlrec.eme.alloc_next = eid;
+            ema_page_set_eme(BufferGetPage(ema_bufs[alloc_idx]), alloc_xlrec.slot,
+                                alloc_xlrec.setflag, &alloc_xlrec.eme);
+            XLogRegisterBufData(2 + alloc_idx, (char *)&alloc_xlrec, SizeOfSetEME);
+        }
+        if(scan_idx >= 0)
+        {
+            scan_xlrec.slot = scan_addr.local_idx;
+            scan_xlrec.setflag = EMA_SETFLAG_SCANNEXT;
+            INIT_EME(&scan_xlrec.eme);
+            scan_xlrec.eme.scan_next = eid;
+            ema_page_set_eme(BufferGetPage(ema_bufs[scan_idx]), scan_xlrec.slot,
+                                scan_xlrec.setflag, &scan_xlrec.eme);
+            XLogRegisterBufData(2 + scan_idx, (char *)&scan_xlrec, SizeOfSetEME);
+        }
+    }
+
+    /*
+     * init the new EMEs, chained to each other in both lists.  Redo of each
+     * of them extends the heap by one extent, in order.
+     */
+    for(i = 0; i < nextents; i++)
+    {
+        ExtentID next_eid = (i < nextents - 1) ? eid + i + 1 : InvalidExtentID;
+
+        INIT_EXLOG_SETEME(&targ_xlrec[i]);
+        targ_xlrec[i].setflag = EMA_SETFLAG_ALL | EMA_SETFLAG_EXTENDHEAP;
+        targ_xlrec[i].extentid = eid + i;
+        memcpy(&(targ_xlrec[i].rnode), &(rel->rd_node), sizeof(RelFileNode));
+        targ_xlrec[i].slot = targ_addr.local_idx + i;
+        INIT_EME(&targ_xlrec[i].eme);
+        targ_xlrec[i].eme.is_occupied = 1;
+        targ_xlrec[i].eme.shardid = sid;
+        targ_xlrec[i].eme.max_freespace = MAX_FREESPACE;
+        targ_xlrec[i].eme.hwm = 1;
+        targ_xlrec[i].eme.scan_next = next_eid;
+        targ_xlrec[i].eme.alloc_next = next_eid;
+
+        ExtentAssertEMEIsFree(BufferGetEMAPage(ema_bufs[targ_idx])->ema[targ_xlrec[i].slot]);
+        ema_page_init_eme(BufferGetPage(ema_bufs[targ_idx]), targ_xlrec[i].slot,
+                            sid, MAX_FREESPACE);
+        ema_page_set_eme(BufferGetPage(ema_bufs[targ_idx]), targ_xlrec[i].slot,
+                            EMA_SETFLAG_ALLPOINTER, &targ_xlrec[i].eme);
+        XLogRegisterBufData(2 + targ_idx, (char *)&targ_xlrec[i], SizeOfSetEME);
+    }
+    BufferGetEMAPage(ema_bufs[targ_idx])->n_emes += nextents;
+
+    /* eme page: n_emes */
+    xlrec_ex.n_emes = BufferGetEMAPage(ema_bufs[targ_idx])->n_emes;
+    xlrec_ex.flags = 0;
+    xlrec_ex.setfree_start = -1;
+    xlrec_ex.setfree_end = -1;
+    XLogRegisterBufData(2 + targ_idx, (char *)&xlrec_ex, SizeOfExtendEME);
+
+    for(i = 0; i < n_ema; i++)
+        MarkBufferDirty(ema_bufs[i]);
+
+    recptr = XLogInsert(RM_EXTENT_ID, XLOG_EXTENT_APPEND_EXTENT);
+    PageSetLSN(BufferGetPage(eob_buf), recptr);
+    PageSetLSN(BufferGetPage(esa_buf), recptr);
+    for(i = 0; i < n_ema; i++)
+        PageSetLSN(BufferGetPage(ema_bufs[i]), recptr);
+
+    END_CRIT_SECTION();
+
+    UnlockReleaseBuffer(eob_buf);
+    UnlockReleaseBuffer(esa_buf);
+    for(i = 0; i < n_ema; i++)
+        UnlockReleaseBuffer(ema_bufs[i]);
+
+    if(trace_extent)
+    {
+        ereport(LOG,
+                (errmsg("[trace extent]AppendExtents:[rel:%d/%d/%d]"
+                        "[sid:%d, first eid:%d, last eid:%d]"
+                        "[seteob:blocknum=%d,n_bits=%d]"
+                        "[setesa:blocknum=%d,offset=%d,scantail=%d,alloctail=%d]"
+                        "[setemepage:blocknum=%d, n_emes=%d]",
+                        rel->rd_node.dbNode, rel->rd_node.spcNode, rel->rd_node.relNode,
+                        sid, eid, last_eid,
+                        eob_addr.physical_page_number, xlrec_eob.n_eobs,
+                        esa_addr.physical_page_number, esa_addr.local_idx, last_eid, last_eid,
+                        targ_addr.physical_page_number, xlrec_ex.n_emes)));
+    }
+
+    UnlockShard(rel, sid, ExclusiveLock);
+
+    return nextents;
+}
+
 /*
  * Only be called during rebuilding extent map.
  */
@@ -5686,6 +6083,121 @@ RelOidGetShardScanHead(Oid reloid, ShardID sid)
     return scanhead;
 }
 
+static int
+extentid_cmp(const void *a, const void *b)
+{
+    ExtentID    ea = *(const ExtentID *) a;
+    ExtentID    eb = *(const ExtentID *) b;
+
+    if (ea < eb)
+        return -1;
+    if (ea > eb)
+        return 1;
+    return 0;
+}
+
+/*
+ * GetShardScanExtents
+ *        Collect the extents on the scan lists of the given shards.
+ *
+ * Extents are returned sorted by extent id, so that a scan visiting them in
+ * order reads the main fork front to back and keeps the kernel's readahead
+ * useful.  Extents starting at or beyond nblocks are left out, since a scan
+ * bounded by nblocks would never read them.  The result is palloc'd in the
+ * current memory context and its length returned in *nextents.
+ *
+ * Each shard's list is walked under the shard lock, which is what every
+ * list modification takes exclusively, so we never see a half-linked list.
+ * If the map does not look sane (an extent on the list that is free or owned
+ * by another shard, or a list that never ends) we return NULL, and the
+ * caller is expected to fall back to scanning the whole relation.
+ */
+ExtentID *
+GetShardScanExtents(Relation rel, Bitmapset *shards, BlockNumber nblocks, int *nextents)
+{// #lizard forgives
+    ExtentID    *result;
+    int            maxextents = 64;
+    int            n = 0;
+    int            sid = -1;
+
+    result = (ExtentID *) palloc(maxextents * sizeof(ExtentID));
+
+    while ((sid = bms_next_member(shards, sid)) >= 0)
+    {
+        ESAAddress    addr;
+        Buffer        buf;
+        ExtentID    eid;
+        int            nvisited = 0;
+        bool        broken = false;
+
+        if (!ShardIDIsValid(sid))
+            continue;
+
+        LockShard(rel, sid, AccessShareLock);
+
+        /*
+         * Read the anchor without extending the fork: a reader must not
+         * create EMA pages.  A missing ESA page while the relation has data
+         * means the map cannot be used.
+         */
+        addr = esa_sid_to_address(sid);
+        buf = extent_readbuffer(rel, addr.physical_page_number, false);
+        if (BufferIsInvalid(buf))
+        {
+            UnlockShard(rel, sid, AccessShareLock);
+            pfree(result);
+            return NULL;
+        }
+        LockBuffer(buf, BUFFER_LOCK_SHARE);
+        eid = ((ESAPage) PageGetContents(BufferGetPage(buf)))->anchors[addr.local_idx].scan_head;
+        UnlockReleaseBuffer(buf);
+
+        while (ExtentIdIsValid(eid))
+        {
+            ExtentID    next;
+            bool        is_occupied = false;
+            ShardID        e_sid = InvalidShardID;
+
+            next = ema_next_scan(rel, eid, false, &is_occupied, &e_sid, NULL, NULL);
+
+            if (!is_occupied || e_sid != sid || ++nvisited > MAX_EXTENTS)
+            {
+                elog(WARNING, "scan list of shard %d of relation %s is inconsistent at extent %u, "
+                              "falling back to full scan.",
+                              sid, RelationGetRelationName(rel), eid);
+                broken = true;
+                break;
+            }
+
+            if ((BlockNumber) eid * PAGES_PER_EXTENTS < nblocks)
+            {
+                if (n >= maxextents)
+                {
+                    maxextents *= 2;
+                    result = (ExtentID *) repalloc(result, maxextents * sizeof(ExtentID));
+                }
+                result[n++] = eid;
+            }
+
+            eid = next;
+        }
+
+        UnlockShard(rel, sid, AccessShareLock);
+
+        if (broken)
+        {
+            pfree(result);
+            return NULL;
+        }
+    }
+
+    if (n > 1)
+        qsort(result, n, sizeof(ExtentID), extentid_cmp);
+
+    *nextents = n;
+    return result;
+}
+
 #if 0
 static int
 next_free_extent(EOBPage eob_pg, int search_from)
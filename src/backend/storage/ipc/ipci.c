@@ -25,6 +25,7 @@
 #include "access/subtrans.h"
 #include "access/twophase.h"
 #include "commands/async.h"
+#include "executor/runtimefilter.h"
 #include "miscadmin.h"
 #include "pgstat.h"
 #ifdef PGXC
@@ -242,6 +243,7 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
         size = add_size(size, NodeLockShmemSize());
         size = add_size(size, ShardStatisticShmemSize());
         size = add_size(size, QueryAnalyzeInfoShmemSize());
+        size = add_size(size, RuntimeFilterShmemSize());
 #endif
 #ifdef __AUDIT__
         size = add_size(size, AuditLoggerShmemSize());
@@ -414,6 +416,7 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
     NodeLockShmemInit();
     ShardStatisticShmemInit();
     QueryAnalyzeInfoInit();
+    RuntimeFilterShmemInit();
     UserAuthShmemInit();
 #endif
 
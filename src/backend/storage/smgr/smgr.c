@@ -27,6 +27,7 @@
 #include "utils/inval.h"
 #ifdef _MLS_
 #include "storage/relcryptstorage.h"
+#include "storage/relcryptpagecache.h"
 #endif
 
 /*
@@ -189,6 +190,7 @@ smgropen(RelFileNode rnode, BackendId backend)
         //MemSet(reln->smgr_shard_targblocks, 0, sizeof(reln->smgr_shard_targblocks));
         //reln->smgr_shard_tb_lasthit = -1;
         reln->smgr_ema_nblocks = InvalidBlockNumber;
+        reln->smgr_eob_hint = InvalidBlockNumber;
 #endif
         reln->smgr_fsm_nblocks = InvalidBlockNumber;
         reln->smgr_vm_nblocks = InvalidBlockNumber;
@@ -456,6 +458,10 @@ smgrdounlink(SMgrRelation reln, bool isRedo)
      * drop them without bothering to write the contents.
      */
     DropRelFileNodesAllBuffers(&rnode, 1);
+#ifdef _MLS_
+    if (REL_CRYPT_PAGE_CACHE_ENABLED())
+        rel_crypt_page_cache_drop(reln, InvalidForkNumber, 0);
+#endif
 
     /*
      * It'd be nice to tell the stats collector to forget it immediately, too.
@@ -529,6 +535,12 @@ smgrdounlinkall(SMgrRelation *rels, int nrels, bool isRedo)
      * drop them without bothering to write the contents.
      */
     DropRelFileNodesAllBuffers(rnodes, nrels);
+#ifdef _MLS_
+    for (i = 0; i < nrels && REL_CRYPT_PAGE_CACHE_ENABLED(); i++)
+    {
+        rel_crypt_page_cache_drop(rels[i], InvalidForkNumber, 0);
+    }
+#endif
 
     /*
      * It'd be nice to tell the stats collector to forget them immediately,
@@ -589,6 +601,10 @@ smgrdounlinkfork(SMgrRelation reln, ForkNumber forknum, bool isRedo)
      * them without bothering to write the contents.
      */
     DropRelFileNodeBuffers(rnode, forknum, 0);
+#ifdef _MLS_
+    if (REL_CRYPT_PAGE_CACHE_ENABLED())
+        rel_crypt_page_cache_drop(reln, forknum, 0);
+#endif
 
     /*
      * It'd be nice to tell the stats collector to forget it immediately, too.
@@ -630,6 +646,14 @@ void
 smgrextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
            char *buffer, bool skipFsync)
 {
+#ifdef _MLS_
+    /* 
+     * a cached decrypted image of the block would be stale now, the
+     * relcrypt of reln may be stale too, so do not look at it.
+     */
+    if (REL_CRYPT_PAGE_CACHE_ENABLED() && REL_CRYPT_PAGE_CACHE_FORK(forknum))
+        rel_crypt_page_cache_invalidate(reln, forknum, blocknum);
+#endif
     (*(smgrsw[reln->smgr_which].smgr_extend)) (reln, forknum, blocknum,
                                                buffer, skipFsync);
 }
@@ -677,6 +701,14 @@ void
 smgrwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
           char *buffer, bool skipFsync)
 {
+#ifdef _MLS_
+    /* 
+     * a cached decrypted image of the block would be stale now, the
+     * relcrypt of reln may be stale too, so do not look at it.
+     */
+    if (REL_CRYPT_PAGE_CACHE_ENABLED() && REL_CRYPT_PAGE_CACHE_FORK(forknum))
+        rel_crypt_page_cache_invalidate(reln, forknum, blocknum);
+#endif
     (*(smgrsw[reln->smgr_which].smgr_write)) (reln, forknum, blocknum,
                                               buffer, skipFsync);
 }
@@ -718,6 +750,10 @@ smgrtruncate(SMgrRelation reln, ForkNumber forknum, BlockNumber nblocks)
      * just drop them without bothering to write the contents.
      */
     DropRelFileNodeBuffers(reln->smgr_rnode, forknum, nblocks);
+#ifdef _MLS_
+    if (REL_CRYPT_PAGE_CACHE_ENABLED())
+        rel_crypt_page_cache_drop(reln, forknum, nblocks);
+#endif
 
     /*
      * Send a shared-inval message to force other backends to close any smgr
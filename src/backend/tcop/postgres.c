@@ -106,6 +106,7 @@
 #include "optimizer/planmain.h"
 #include "access/twophase.h"
 #include "executor/execParallel.h"
+#include "executor/runtimefilter.h"
 #include "pgxc/poolutils.h"
 #include "commands/vacuum.h"
 #include "commands/explain_dist.h"
@@ -2789,6 +2790,13 @@ exec_bind_message(StringInfo input_message)
 		shard_map = pq_getmsgstring(input_message);
 		if (shard_map[0] != '\0')
 			DeserializeShardmap(shard_map);
+
+		/* Get the bloom filter of the consumer's hash join, if any */
+		old_top = MemoryContextSwitchTo(PortalGetHeapMemory(portal));
+		portal->runtimeFilter = RuntimeFilterDeserialize(input_message);
+		MemoryContextSwitchTo(old_top);
+		if (portal->runtimeFilter)
+			RuntimeFilterCount(RUNTIME_FILTER_STAT_RECEIVED, 1);
 	}
 	
     pq_getmsgend(input_message);
@@ -6103,6 +6111,25 @@ PostgresMain(int argc, char *argv[],
                             pq_putmessage('4', NULL, 0);
                             pq_flush();
                         }
+                        else if (c == 'B')    /* pgxc_node_send_apply_batch */
+                        {
+                            MemoryContext oldcontext;
+
+                            /* apply the whole batch and answer once */
+                            start_xact_command();
+                            oldcontext = MemoryContextSwitchTo(MessageContext);
+
+                            logical_apply_dispatch_batch(&input_message);
+
+                            MemoryContextSwitchTo(oldcontext);
+                            finish_xact_command();
+
+                            pq_getmsgend(&input_message);
+
+                            /* Send ApplyDone message */
+                            pq_putmessage('4', NULL, 0);
+                            pq_flush();
+                        }
                         else
                         {
                             ereport(FATAL,
@@ -28,6 +28,7 @@
 #ifdef XCP
 #include "catalog/pgxc_node.h"
 #include "executor/producerReceiver.h"
+#include "executor/runtimefilter.h"
 #include "pgxc/nodemgr.h"
 #endif
 #ifdef PGXC
@@ -138,6 +139,7 @@ CreateQueryDesc(PlannedStmt *plannedstmt,
     qd->sender = NULL;
     qd->es_param_exec_vals = NULL;
 	qd->epqContext = NULL;
+	qd->runtimeFilter = NULL;
 #endif
 
     /* not yet executed */
@@ -866,6 +868,11 @@ PortalStart(Portal portal, ParamListInfo params,
                     {
                         SetProducerNodeMap(dest, nodeMap);
                     }
+
+                    /* skip rows the hash join of the consumer would discard */
+                    if (portal->runtimeFilter)
+                        SetProducerRuntimeFilter(dest, portal->runtimeFilter,
+                                                 queryDesc->tupDesc);
 #endif
                     queryDesc->dest = dest;
                 }
@@ -971,6 +978,17 @@ PortalStart(Portal portal, ParamListInfo params,
                             queryDesc->sender
 #endif
                                 );
+#ifdef __OPENTENBASE__
+                        /*
+                         * Skip rows the hash joins of the consumers would
+                         * discard.  Rows sent by parallel workers are not
+                         * filtered.
+                         */
+                        if (portal->runtimeFilter &&
+                            !needParallelSend(queryDesc->squeue))
+                            SetProducerRuntimeFilter(dest, portal->runtimeFilter,
+                                                     queryDesc->tupDesc);
+#endif
                         queryDesc->dest = dest;
 
                         addProducingPortal(portal);
@@ -984,6 +1002,22 @@ PortalStart(Portal portal, ParamListInfo params,
                         queryDesc->tupDesc = ExecCleanTypeFromTL(
                                 queryDesc->plannedstmt->planTree->targetlist,
                                 false);
+#ifdef __OPENTENBASE__
+                        /*
+                         * Hand the bloom filter of our hash join over to the
+                         * producer.  The segment lives as long as the portal.
+                         */
+                        if (portal->runtimeFilter)
+                        {
+                            dsm_segment *seg;
+
+                            seg = RuntimeFilterExport(portal->runtimeFilter);
+                            if (seg)
+                                SharedQueueSetRuntimeFilter(queryDesc->squeue,
+                                                            queryDesc->myindex,
+                                                            dsm_segment_handle(seg));
+                        }
+#endif
                     }
                     pfree(consMap);
                 }
@@ -1081,6 +1115,16 @@ PortalStart(Portal portal, ParamListInfo params,
                  */
                 ExecutorStart(queryDesc, myeflags);
 
+#ifdef __OPENTENBASE__
+                /*
+                 * Do not send rows the hash join of the consumer would
+                 * discard, unless its filter does not fit our result.
+                 */
+                if (portal->runtimeFilter &&
+                    RuntimeFilterPrepare(portal->runtimeFilter, queryDesc->tupDesc))
+                    queryDesc->runtimeFilter = portal->runtimeFilter;
+#endif
+
                 /*
                  * This tells PortalCleanup to shut down the executor
                  */
@@ -12894,6 +12894,7 @@ replace_target_relation(Node *node, Index targetrel, Relation partitionparent, i
              */
         case T_Material:
         case T_Sort:
+        case T_IncrementalSort:
         case T_Hash:
             {
                 Plan *mat = (Plan*)node;
@@ -89,10 +89,14 @@
 #include "postmaster/bgworker_internals.h"
 #include "postmaster/bgwriter.h"
 #include "postmaster/clean2pc.h"
+#include "postmaster/clustermon.h"
+#include "postmaster/partprecreate.h"
 #include "postmaster/postmaster.h"
 #include "postmaster/syslogger.h"
 #include "postmaster/walwriter.h"
 #include "replication/logicallauncher.h"
+#include "replication/logicalworker.h"
+#include "replication/reorderbuffer.h"
 #include "replication/slot.h"
 #include "replication/syncrep.h"
 #include "replication/walreceiver.h"
@@ -147,9 +151,13 @@
 #ifdef _MLS_
 #include "utils/relcrypt.h"
 #include "utils/datamask.h"
+#include "storage/relcryptpagecache.h"
 #endif
 #ifdef __COLD_HOT__
 #include "utils/ruleutils.h"
+#include "executor/execBatch.h"
+#include "executor/runtimefilter.h"
+#include "jit/jit.h"
 #include "executor/nodeAgg.h"
 #include "catalog/pg_partition_interval.h"
 #endif
@@ -1090,6 +1098,15 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_incrementalsort", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the planner's use of incremental sort steps."),
+			NULL
+		},
+		&enable_incrementalsort,
+		true,
+		NULL, NULL, NULL
+	},
 	{
 		{"enable_hashagg", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enables the planner's use of hashed aggregation plans."),
@@ -1217,6 +1234,17 @@ static struct config_bool ConfigureNamesBool[] =
 		false,
 		NULL, NULL, NULL
 	},
+#ifdef __OPENTENBASE__
+	{
+		{"enable_partition_wise_aggregate", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables partition-wise partial aggregation of interval partitioned tables."),
+			NULL
+		},
+		&enable_partition_wise_aggregate,
+		false,
+		NULL, NULL, NULL
+	},
+#endif
 
     {
         {"geqo", PGC_USERSET, QUERY_TUNING_GEQO,
@@ -1971,6 +1999,28 @@ static struct config_bool ConfigureNamesBool[] =
         NULL, NULL, NULL
     },
 
+#ifdef __SUBSCRIPTION__
+    {
+        {"logical_apply_fanout", PGC_POSTMASTER, REPLICATION_SUBSCRIBERS,
+            gettext_noop("Lets one worker of a parallel OpenTenBase subscription receive the changes and dispatch them to the others."),
+            NULL
+        },
+        &logical_apply_fanout,
+        false,
+        NULL, NULL, NULL
+    },
+#endif
+
+    {
+        {"logical_apply_streaming", PGC_SIGHUP, REPLICATION_SUBSCRIBERS,
+            gettext_noop("Asks publishers to stream large in-progress transactions to subscriptions."),
+            gettext_noop("Their changes are kept by the worker until they commit.")
+        },
+        &logical_apply_streaming,
+        false,
+        NULL, NULL, NULL
+    },
+
     {
         {"allow_system_table_mods", PGC_POSTMASTER, DEVELOPER_OPTIONS,
             gettext_noop("Allows modifications of the structure of system tables."),
@@ -2408,6 +2458,71 @@ static struct config_bool ConfigureNamesBool[] =
         false,
         NULL, NULL, NULL
     },
+    {
+        {"enable_shard_pruned_scan", PGC_USERSET, QUERY_TUNING_METHOD,
+            gettext_noop("Enables scans restricted to some shards to read only those shards' extents."),
+            NULL
+        },
+        &enable_shard_pruned_scan,
+        true,
+        NULL, NULL, NULL
+    },
+    {
+        {"enable_batch_qual", PGC_USERSET, QUERY_TUNING_METHOD,
+            gettext_noop("Enables evaluating simple scan quals over a page of tuples at once."),
+            NULL
+        },
+        &enable_batch_qual,
+        true,
+        NULL, NULL, NULL
+    },
+    {
+        {"enable_runtime_filter", PGC_USERSET, QUERY_TUNING_METHOD,
+            gettext_noop("Enables pushing bloom filters of hash join inner sides down to remote producers."),
+            NULL
+        },
+        &enable_runtime_filter,
+        true,
+        NULL, NULL, NULL
+    },
+    {
+        {"enable_runtime_partition_pruning", PGC_USERSET, QUERY_TUNING_METHOD,
+            gettext_noop("Enables pruning partitions when executing plans with parameters."),
+            NULL
+        },
+        &enable_runtime_partition_pruning,
+        true,
+        NULL, NULL, NULL
+    },
+    {
+        {"jit", PGC_USERSET, QUERY_TUNING_OTHER,
+            gettext_noop("Allow JIT compilation."),
+            NULL
+        },
+        &jit_enabled,
+        false,
+        NULL, NULL, NULL
+    },
+    {
+        {"jit_expressions", PGC_USERSET, DEVELOPER_OPTIONS,
+            gettext_noop("Allow JIT compilation of expressions."),
+            NULL,
+            GUC_NOT_IN_SAMPLE
+        },
+        &jit_expressions,
+        true,
+        NULL, NULL, NULL
+    },
+    {
+        {"jit_tuple_deforming", PGC_USERSET, DEVELOPER_OPTIONS,
+            gettext_noop("Allow JIT compilation of tuple deforming."),
+            NULL,
+            GUC_NOT_IN_SAMPLE
+        },
+        &jit_tuple_deforming,
+        true,
+        NULL, NULL, NULL
+    },
     {
         {"enable_shard_statistic", PGC_SIGHUP, STATS_COLLECTOR,
             gettext_noop("collect statistic information for shard."),
@@ -2618,6 +2733,16 @@ static struct config_bool ConfigureNamesBool[] =
         false,
         NULL, NULL, NULL
     },
+    {
+        {"enable_audit_policy_cache", PGC_SUSET, DEVELOPER_OPTIONS,
+            gettext_noop("Match audit policies in a compiled per-backend hash instead of scanning the audit catalogs."),
+            NULL,
+            GUC_NOT_IN_SAMPLE
+        },
+        &enable_audit_policy_cache,
+        true,
+        NULL, NULL, NULL
+    },
 #endif
 #ifdef _MLS_
     {
@@ -2961,6 +3086,25 @@ static struct config_int ConfigureNamesInt[] =
         8, 1, INT_MAX,
         NULL, NULL, NULL
     },
+    {
+        {"jit_cache_size", PGC_USERSET, QUERY_TUNING_OTHER,
+            gettext_noop("Sets the number of JIT compiled functions kept for reuse by later queries."),
+            gettext_noop("0 disables caching of JIT compiled functions.")
+        },
+        &jit_cache_size,
+        1024, 0, 65536,
+        NULL, NULL, NULL
+    },
+    {
+        {"runtime_filter_max_size", PGC_USERSET, QUERY_TUNING_OTHER,
+            gettext_noop("Sets the maximum size of a bloom filter pushed down from a hash join."),
+            gettext_noop("Hash joins whose inner side would saturate a filter of this size push none."),
+            GUC_UNIT_KB
+        },
+        &runtime_filter_max_size,
+        1024, 1, 262144,
+        NULL, NULL, NULL
+    },
     {
         {"geqo_threshold", PGC_USERSET, QUERY_TUNING_GEQO,
             gettext_noop("Sets the threshold of FROM items beyond which GEQO is used."),
@@ -3177,6 +3321,18 @@ static struct config_int ConfigureNamesInt[] =
         NULL, NULL, NULL
     },
 
+    {
+        {"logical_decoding_work_mem", PGC_USERSET, RESOURCES_MEM,
+            gettext_noop("Sets the maximum memory to be used for logical decoding."),
+            gettext_noop("This much memory can be used by each internal "
+                         "reorder buffer before spilling to disk or streaming."),
+            GUC_UNIT_KB
+        },
+        &logical_decoding_work_mem,
+        65536, 64, MAX_KILOBYTES,
+        NULL, NULL, NULL
+    },
+
     {
         {"replacement_sort_tuples", PGC_USERSET, RESOURCES_MEM,
             gettext_noop("Sets the maximum number of tuples to be sorted using replacement selection."),
@@ -3347,6 +3503,17 @@ static struct config_int ConfigureNamesInt[] =
     },
 #endif
 
+    {
+        {"commit_ts_cache_horizon", PGC_SUSET, DEVELOPER_OPTIONS,
+            gettext_noop("Sets how many xids the oldest entry of the backend commit timestamp cache may fall behind before the cache is reset."),
+            NULL,
+            GUC_NOT_IN_SAMPLE
+        },
+        &commit_ts_cache_horizon,
+        0x40000000, 1, 0x40000000,
+        NULL, NULL, NULL
+    },
+
     {
         {"statement_timeout", PGC_USERSET, CLIENT_CONN_STATEMENT,
             gettext_noop("Sets the maximum allowed duration of any statement."),
@@ -3450,6 +3617,16 @@ static struct config_int ConfigureNamesInt[] =
         100, 1, INT_MAX,
         NULL, NULL, NULL
     },
+
+    {
+        {"global_xmin_report_threshold", PGC_SIGHUP, REPLICATION_MASTER,
+            gettext_noop("Number of transactions the local xmin has to advance by before the cluster monitor reports it to GTM ahead of its naptime."),
+            gettext_noop("0 reports the local xmin on naptime only.")
+        },
+        &global_xmin_report_threshold,
+        1024, 0, INT_MAX,
+        NULL, NULL, NULL
+    },
         
     {
         {"delay_before_acquire_committs", PGC_USERSET, DEVELOPER_OPTIONS,
@@ -3851,6 +4028,19 @@ static struct config_int ConfigureNamesInt[] =
         4, 0, MAX_BACKENDS,
         NULL, NULL, NULL
     },
+#ifdef __SUBSCRIPTION__
+    {
+        {"logical_apply_batch_size",
+            PGC_SIGHUP,
+            REPLICATION_SUBSCRIBERS,
+            gettext_noop("Sets the number of changes a coordinator sends at once to a datanode for logical replication apply."),
+            gettext_noop("1 sends each change and waits for the datanode to apply it."),
+        },
+        &logical_apply_batch_size,
+        100, 1, 10000,
+        NULL, NULL, NULL
+    },
+#endif
 #ifdef __OPENTENBASE__
     {
         {"max_network_bandwidth_per_subscription",
@@ -3996,6 +4186,15 @@ static struct config_int ConfigureNamesInt[] =
         16, 8, MAX_BACKENDS,
         NULL, NULL, NULL
     },
+    {
+        {"alog_common_writer_number", PGC_POSTMASTER, LOGGING_WHERE,
+            gettext_noop("Number of writer thread to write common audit log, each writes its own log file."),
+            NULL,
+        },
+        &AuditLog_common_log_writer_number,
+        1, 1, AUDIT_MAX_COMMON_WRITER,
+        NULL, NULL, NULL
+    },
     {
         {"alog_common_queue_size", PGC_POSTMASTER, LOGGING_WHERE,
             gettext_noop("Size of share memory queue for each backend to store common audit log, kilobytes."),
@@ -4230,6 +4429,16 @@ static struct config_int ConfigureNamesInt[] =
         NULL, NULL, NULL
     },
 
+    {
+        {"max_parallel_maintenance_workers", PGC_USERSET, RESOURCES_ASYNCHRONOUS,
+            gettext_noop("Sets the maximum number of parallel processes per maintenance operation."),
+            NULL
+        },
+        &max_parallel_maintenance_workers,
+        2, 0, MAX_PARALLEL_WORKER_LIMIT,
+        NULL, NULL, NULL
+    },
+
     {
         {"max_parallel_workers", PGC_USERSET, RESOURCES_ASYNCHRONOUS,
             gettext_noop("Sets the maximum number of parallel workers than can be active at one time."),
@@ -4600,6 +4809,16 @@ static struct config_int ConfigureNamesInt[] =
 		2048, 2048, INT_MAX,
 		NULL, NULL, NULL
 	},
+    {
+        {"rel_crypt_page_cache_size", PGC_POSTMASTER, RESOURCES_MEM,
+            gettext_noop("Sets the number of pages in the shared cache of decrypted pages of crypted relations."),
+            gettext_noop("0 disables the cache."),
+            GUC_UNIT_BLOCKS
+        },
+        &g_rel_crypt_page_cache_size,
+        0, 0, INT_MAX / 2,
+        NULL, NULL, NULL
+    },
 #endif
     {
         {"pooler_port", PGC_POSTMASTER, DATA_NODES,
@@ -4932,6 +5151,27 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"interval_partition_precreate", PGC_SIGHUP, CUSTOM_OPTIONS,
+			gettext_noop("Sets the number of upcoming partitions of interval partitioned tables to create ahead of time."),
+			gettext_noop("Only tables partitioned by day or month are concerned. 0 turns this off. Turning it on from 0 requires a restart.")
+		},
+		&interval_partition_precreate,
+		0, 0, MAX_NUM_INTERVAL_PARTITIONS,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"interval_partition_precreate_naptime", PGC_SIGHUP, CUSTOM_OPTIONS,
+			gettext_noop("Time to sleep between checks for upcoming interval partitions to create."),
+			NULL,
+			GUC_UNIT_S
+		},
+		&interval_partition_precreate_naptime,
+		600, 1, INT_MAX / 1000,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"reconnect_gtm_retry_times", PGC_USERSET, CUSTOM_OPTIONS,
 			gettext_noop("reconnect gtm retry times"),
@@ -5051,6 +5291,26 @@ static struct config_real ConfigureNamesReal[] =
         NULL, NULL, NULL
     },
 
+    {
+        {"jit_above_cost", PGC_USERSET, QUERY_TUNING_COST,
+            gettext_noop("Perform JIT compilation if query is more expensive."),
+            gettext_noop("-1 disables JIT compilation.")
+        },
+        &jit_above_cost,
+        100000, -1, DBL_MAX,
+        NULL, NULL, NULL
+    },
+
+    {
+        {"jit_optimize_above_cost", PGC_USERSET, QUERY_TUNING_COST,
+            gettext_noop("Optimize JITed functions if query is more expensive."),
+            gettext_noop("-1 disables optimization.")
+        },
+        &jit_optimize_above_cost,
+        500000, -1, DBL_MAX,
+        NULL, NULL, NULL
+    },
+
     {
         {"cursor_tuple_fraction", PGC_USERSET, QUERY_TUNING_OTHER,
             gettext_noop("Sets the planner's estimate of the fraction of "
@@ -5237,6 +5497,17 @@ static struct config_string ConfigureNamesString[] =
         check_temp_tablespaces, assign_temp_tablespaces, NULL
     },
 
+    {
+        {"jit_provider", PGC_POSTMASTER, CLIENT_CONN_PRELOAD,
+            gettext_noop("JIT provider to use."),
+            NULL,
+            GUC_SUPERUSER_ONLY
+        },
+        &jit_provider,
+        "llvmjit",
+        NULL, NULL, NULL
+    },
+
     {
         {"dynamic_library_path", PGC_SUSET, CLIENT_CONN_OTHER,
             gettext_noop("Sets the path for dynamically loadable modules."),
@@ -6011,6 +6282,15 @@ static struct config_string ConfigureNamesString[] =
         NULL, assign_wal_stream_type, NULL
     },
 #endif    
+	{
+		{"interval_partition_precreate_role", PGC_SIGHUP, CUSTOM_OPTIONS,
+			gettext_noop("Sets the role upcoming interval partitions are created as."),
+			gettext_noop("It must own the tables. Its password, if one is needed, is read from the password file of the server.")
+		},
+		&interval_partition_precreate_role,
+		"",
+		NULL, NULL, NULL
+	},
     /* End-of-list marker */
     {
         {NULL, 0, 0, NULL, NULL}, NULL, NULL, NULL, NULL, NULL
@@ -65,6 +65,7 @@
 #include "utils/relcryptmisc.h"
 
 #include "utils/relcryptmap.h"
+#include "storage/relcryptpagecache.h"
 
 #include "utils/datamask.h"
 #include "utils/guc.h"
@@ -596,6 +597,8 @@ static bool QueueIsFull(Queue q)
 #define CRYPT_SLOT_QUEUE_CNT_MULTI_FACTOR    3
 /* every crypting slot has 2 blocks */
 #define CRYPT_ONE_BUF_NEED_TEMP_MULTI_FACTOR 2
+/* max number of buffers a crypt worker takes from its queue and crypts in one call */
+#define CRYPT_WORKER_BATCH_SIZE              16
 
 /* hold all infos of crypt workers */
 typedef struct tagArgsForEncryptWorker
@@ -636,18 +639,22 @@ static char * mls_get_crypt_block(char * pool, int idx)
  * crypt worker main
  */
 static void* mls_crypt_worker(void * input)
-{
+{// #lizard forgives
     ArgsForEncryptWorker* arg;       
-    char                * buf;
     char                * slot_pool;
     char                * buf_need_encrypt;
-    char                * page_new;
     BufferDesc          * bufdesc;
-    int                   ret;
     Queue                 encrypt_queue; 
     Queue                 crypted_queue; 
-    BufEncryptElement     encrypt_element;
+    BufEncryptElement     encrypt_elements[CRYPT_WORKER_BATCH_SIZE];
     BufCryptedElement     crypted_element;
+    char                * bufs[CRYPT_WORKER_BATCH_SIZE];
+    char                * page_news[CRYPT_WORKER_BATCH_SIZE];
+    int                   rets[CRYPT_WORKER_BATCH_SIZE];
+    int                   nelements;
+    int                   run_start;
+    int                   run_end;
+    int                   i;
     int                   localcnt;
     int                   workerid;
     
@@ -663,14 +670,12 @@ static void* mls_crypt_worker(void * input)
 
     for (;;)
     {
-        bool need_mprotect = false;
-
         if (false == g_crypt_parellel_main_running)
         {
             break;
         }
         
-        /* 1. get one buf for encrypt */
+        /* 1. get bufs for encrypt, take all queued ones up to a batch */
         if (0 == QueueGetLength(encrypt_queue))
         {
             /* if there is no job go to sleep */
@@ -678,47 +683,81 @@ static void* mls_crypt_worker(void * input)
             continue;
         }
 
-        QueueGetSingle(encrypt_queue, &encrypt_element);
+        nelements = 0;
+        while (nelements < CRYPT_WORKER_BATCH_SIZE 
+               && QueueGetSingle(encrypt_queue, &encrypt_elements[nelements]))
+        {
+            nelements++;
+        }
 
-        localcnt++;
-        if (0 == localcnt%1000)
+        localcnt += nelements;
+        if (localcnt >= 1000)
         {
             arg->crypted_cnt += localcnt;
+            localcnt = 0;
         }
         
-        /* 2. transform to buf and encrypt it */
-        bufdesc  = GetBufferDescriptor(encrypt_element.buf_id);
-        buf      = BufHdrGetBlockFunc(bufdesc);
+        /* 2. transform to bufs and encrypt them, one call per run sharing the same crypt key */
+        for (run_start = 0; run_start < nelements; run_start = run_end)
+        {
+            for (run_end = run_start + 1; run_end < nelements; run_end++)
+            {
+                if (encrypt_elements[run_end].cryptkey != encrypt_elements[run_start].cryptkey)
+                {
+                    break;
+                }
+            }
 
-        /* 2.1 offset pool for crypting buf */
-        page_new         = mls_get_crypt_block(slot_pool, encrypt_element.slot_id);
-        buf_need_encrypt = page_new + BLCKSZ;
+            for (i = run_start; i < run_end; i++)
+            {
+                bufdesc  = GetBufferDescriptor(encrypt_elements[i].buf_id);
+                bufs[i]  = BufHdrGetBlockFunc(bufdesc);
 
-        /* 2.2 do the encrypt */
-        need_mprotect = enable_buffer_mprotect && !BufferIsLocal(encrypt_element.buf_id);
-        if (need_mprotect)
-        {
-            BufDisableMemoryProtection(buf, false);
-        }
-        ret      = rel_crypt_page_encrypting_parellel(encrypt_element.algo_id, buf, buf_need_encrypt, page_new, encrypt_element.cryptkey, workerid);
-        if (need_mprotect)
-        {
-            BufEnableMemoryProtection(buf, false);
+                /* 2.1 offset pool for crypting buf */
+                page_news[i] = mls_get_crypt_block(slot_pool, encrypt_elements[i].slot_id);
+
+                if (enable_buffer_mprotect && !BufferIsLocal(encrypt_elements[i].buf_id))
+                {
+                    BufDisableMemoryProtection(bufs[i], false);
+                }
+            }
+
+            /* 2.2 do the encrypt, the second block of the first slot is enough to stage pages one by one */
+            buf_need_encrypt = page_news[run_start] + BLCKSZ;
+            rel_crypt_pages_encrypting_parellel(encrypt_elements[run_start].algo_id, 
+                                                &bufs[run_start], 
+                                                buf_need_encrypt, 
+                                                &page_news[run_start],
+                                                &rets[run_start],
+                                                run_end - run_start,
+                                                encrypt_elements[run_start].cryptkey, 
+                                                workerid);
+
+            for (i = run_start; i < run_end; i++)
+            {
+                if (enable_buffer_mprotect && !BufferIsLocal(encrypt_elements[i].buf_id))
+                {
+                    BufEnableMemoryProtection(bufs[i], false);
+                }
+            }
         }
 
-        /* 3. put it to crypted queue */
-        while (QueueIsFull(crypted_queue))
+        /* 3. put them to crypted queue */
+        for (i = 0; i < nelements; i++)
         {
-            //sleep
-            pg_usleep(10000L);
-        }
+            while (QueueIsFull(crypted_queue))
+            {
+                //sleep
+                pg_usleep(10000L);
+            }
 
-        crypted_element.buf_id     = encrypt_element.buf_id;
-        crypted_element.slot_id    = encrypt_element.slot_id;
-        crypted_element.status     = encrypt_element.status;
-        crypted_element.error_code = ret;        
-        
-        QueuePutSingle(crypted_queue, &crypted_element);
+            crypted_element.buf_id     = encrypt_elements[i].buf_id;
+            crypted_element.slot_id    = encrypt_elements[i].slot_id;
+            crypted_element.status     = encrypt_elements[i].status;
+            crypted_element.error_code = rets[i];        
+            
+            QueuePutSingle(crypted_queue, &crypted_element);
+        }
     }
     
     return NULL;
@@ -1555,6 +1594,7 @@ void MlsShmemInit(void)
 {   
     cyprt_key_info_hash_init();
     rel_cyprt_hash_init();
+    rel_crypt_page_cache_init();
 
     if (IsBootstrapProcessingMode())
     {
@@ -1577,7 +1617,7 @@ void MlsShmemInit(void)
 
 Size MlsShmemSize(void)
 {
-    return rel_crypt_hash_shmem_size() + crypt_key_info_hash_shmem_size();
+    return rel_crypt_hash_shmem_size() + crypt_key_info_hash_shmem_size() + rel_crypt_page_cache_shmem_size();
 }
 
 void init_extension_table_oids(void)
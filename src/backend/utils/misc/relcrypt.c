@@ -21,6 +21,7 @@
 
 #include "utils/relcache.h"
 #include "access/htup.h"
+#include "access/sysattr.h"
 #include "access/tupdesc.h"
 #include "fmgr.h"
 #include "catalog/pg_attribute.h"
@@ -552,6 +553,7 @@ static void rel_crypt_create_one_relation(Oid relid, int16 algo_id);
 static Oid rel_crypt_get_table_oid(Relation rel);
 static text * encrypt_procedure_inner(CryptKeyInfo cryptkey_local, text * text_src, char * page_new_output);
 static void crypt_check(int16 algo_id, text * text_src, text * text_crypted, int length, int workerid);
+static void rel_crypt_page_encrypt_sm4(CryptKeyInfo cryptkey, int16 algo_id, char * page, char * page_new);
 
 static void rel_crypt_create(RelFileNode * rnode, AlgoId algo_id, bool wal_write)
 {
@@ -899,6 +901,8 @@ Page rel_crypt_page_encrypt(RelCrypt relcrypt, Page page)
     text   *encryptpage;
     static text *need_encrypt_text = NULL;
     static Page  page_new          = NULL;
+    static int16        algo_id_keep  = TRANSP_CRYPT_INVALID_ALGORITHM_ID;
+    static CryptKeyInfo cryptkey_keep = NULL;
 
     algo_id = relcrypt->algo_id;
 
@@ -924,6 +928,22 @@ Page rel_crypt_page_encrypt(RelCrypt relcrypt, Page page)
         return page;
     }
 
+    /* sm4 encrypts the page context directly, no need to stage it in a text */
+    if (algo_id != algo_id_keep || NULL == cryptkey_keep)
+    {
+        if (false == crypt_key_info_hash_lookup(algo_id, &cryptkey_keep))
+        {
+            elog(ERROR, "algo_id:%d dose not exist", algo_id);
+        }
+        algo_id_keep = algo_id;
+    }
+
+    if (CRYPT_KEY_INFO_OPTION_SM4 == cryptkey_keep->option)
+    {
+        rel_crypt_page_encrypt_sm4(cryptkey_keep, algo_id, (char *) page, (char *) page_new);
+        return page_new;
+    }
+
     memset(page_new, 0, BLCKSZ);
 
     memset((char*)need_encrypt_text, 0, (VARHDRSZ + PAGE_ENCRYPT_LEN));
@@ -1052,6 +1072,48 @@ int rel_crypt_page_encrypting_parellel(int16 algo_id, char * page, char * buf_ne
 }
 
 
+/*
+ * sm4 page encrypt without staging the page context in a text first,
+ * sm4 is a plain ecb over the context so the result is the same as
+ * rel_crypt_page_encrypting_parellel.
+ */
+static void rel_crypt_page_encrypt_sm4(CryptKeyInfo cryptkey, int16 algo_id, char * page, char * page_new)
+{
+    memcpy(page_new, page, sizeof(PageHeaderData));
+    sm4_crypt_ecb(&(cryptkey->sm4_ctx_encrypt), 1, PAGE_ENCRYPT_LEN,
+                  (unsigned char *) page + sizeof(PageHeaderData),
+                  (unsigned char *) page_new + sizeof(PageHeaderData));
+    PageSetAlgorithmId(page, algo_id);
+    PageSetAlgorithmId(page_new, algo_id);
+}
+
+/*
+ * encrypt a run of pages sharing the same crypt key in one call, used by the
+ * parellel crypt workers which pick up several buffers from their queue at
+ * once.  rets[i] gets the result of pages[i], as rel_crypt_page_encrypting_parellel.
+ */
+void rel_crypt_pages_encrypting_parellel(int16 algo_id, char ** pages, char * buf_need_encrypt_input, char ** page_new_outputs, 
+                                         int * rets, int npages, CryptKeyInfo cryptkey, int workerid)
+{
+    int i;
+
+    for (i = 0; i < npages; i++)
+    {
+        /* crypt check needs the staged copy, keep it on the generic path */
+        if (CRYPT_KEY_INFO_OPTION_SM4 == cryptkey->option && !g_enable_crypt_check)
+        {
+            rel_crypt_page_encrypt_sm4(cryptkey, algo_id, pages[i], page_new_outputs[i]);
+            rets[i] = CRYPT_RET_SUCCESS;
+        }
+        else
+        {
+            rets[i] = rel_crypt_page_encrypting_parellel(algo_id, pages[i], buf_need_encrypt_input, page_new_outputs[i], cryptkey, workerid);
+        }
+    }
+
+    return;
+}
+
 void print_page_header(PageHeader header)
 {
     elog(LOG, "----print pagehead begin----\n"
@@ -1068,35 +1130,68 @@ void print_page_header(PageHeader header)
     return;
 }
 
-void rel_crypt_page_decrypt(RelCrypt relcrypt, Page page)
+/*
+ * decrypt a run of pages in place in one call.
+ *
+ * the crypt key is looked up once per algorithm rather than once per page,
+ * and sm4 pages are handed straight to the block kernel without going
+ * through decrypt_procedure.  pages without a valid algo_id are left alone.
+ */
+void rel_crypt_pages_decrypt(RelCrypt relcrypt, Page *pages, int npages)
 {
-    int16   algo_id;
-    text  *cryptedpage;
-    text  *decryptpage;
+    int          i;
+    int16        algo_id;
+    bool         found;
+    text        *decryptpage;
+    static int16        algo_id_keep  = TRANSP_CRYPT_INVALID_ALGORITHM_ID;
+    static CryptKeyInfo cryptkey_keep = NULL;
 
-    algo_id = PageGetAlgorithmId(page);
+    for (i = 0; i < npages; i++)
+    {
+        char *page = (char *) pages[i];
 
-    cryptedpage = (text*)((char*)page + sizeof(PageHeaderData));
+        algo_id = PageGetAlgorithmId(page);
+        if (!TRANSP_CRYPT_ALGO_ID_IS_VALID(algo_id))
+        {
+            continue;
+        }
 
-    /* run decrypt algorithm, context length for page decrypt is default:(BLCKSZ - sizeof(PageHeaderData)), this is used for guomi(sm4) */
-    decryptpage = decrypt_procedure(algo_id, cryptedpage, BLCKSZ - sizeof(PageHeaderData));
+        if (algo_id != algo_id_keep || NULL == cryptkey_keep)
+        {
+            found = crypt_key_info_hash_lookup(algo_id, &cryptkey_keep);
+            if (false == found)
+            {
+                elog(ERROR, "algo_id:%d dose not exist", algo_id);
+            }
+            algo_id_keep = algo_id;
+        }
 
-    if (decryptpage)
-    {
-        /* just exchange data region */
-        memcpy((char*)page + sizeof(PageHeaderData), VARDATA_ANY(decryptpage), VARSIZE_ANY_EXHDR(decryptpage));
+        if (CRYPT_KEY_INFO_OPTION_SM4 == cryptkey_keep->option)
+        {
+            /* same as decrypt_procedure with a valid context length */
+            sm4_crypt_ecb(&(cryptkey_keep->sm4_ctx_decrypt), 0, PAGE_ENCRYPT_LEN,
+                          (unsigned char *) page + sizeof(PageHeaderData),
+                          (unsigned char *) page + sizeof(PageHeaderData));
+            continue;
+        }
 
-        /* remember to free */
-        //crypt_free(decryptpage);
-    }
-    else
-    {
-        /* guomi(sm4) decrypts and rewrites orignal page, no return, so no need to copy */
+        /* run decrypt algorithm, context length for page decrypt is default:(BLCKSZ - sizeof(PageHeaderData)) */
+        decryptpage = decrypt_procedure(algo_id, (text *) (page + sizeof(PageHeaderData)), PAGE_ENCRYPT_LEN);
+        if (decryptpage)
+        {
+            /* just exchange data region */
+            memcpy(page + sizeof(PageHeaderData), VARDATA_ANY(decryptpage), VARSIZE_ANY_EXHDR(decryptpage));
+        }
     }
 
     return;
 }
 
+void rel_crypt_page_decrypt(RelCrypt relcrypt, Page page)
+{
+    rel_crypt_pages_decrypt(relcrypt, &page, 1);
+}
+
 /*
  * do the encrypt action
  * this function support several scenarios.
@@ -1723,8 +1818,54 @@ void trsprt_crypt_free_strut_in_tupdesc(TupleDesc tupledesc, int natts)
 
 
 
+/*
+ * get the attributes the scan plan reads, return false if every column should be decrypted.
+ */
+static bool trsprt_crypt_get_needed_attrs(ScanState *node, Bitmapset **needed_attrs)
+{
+    Scan *scan = (Scan *) node->ps.plan;
+
+    /* no plan, e.g. index build */
+    if (NULL == scan || !scan->crypt_attrs_pruned)
+    {
+        return false;
+    }
+
+    /* a whole-row reference needs every column */
+    if (bms_is_member(InvalidAttrNumber - FirstLowInvalidHeapAttributeNumber, scan->crypt_attrs))
+    {
+        return false;
+    }
+
+    *needed_attrs = scan->crypt_attrs;
+    return true;
+}
+
+/*
+ * check if col attnum(starts from 0) should be decrypted, 
+ * distribute keys are always decrypted, they are used to compute shardid when forming the new tuple.
+ */
+static inline bool trsprt_crypt_col_is_needed(Relation rel, Bitmapset *needed_attrs, int attnum)
+{
+    AttrNumber attno = attnum + 1;
+
+    if (bms_is_member(attno - FirstLowInvalidHeapAttributeNumber, needed_attrs))
+    {
+        return true;
+    }
+
+    if (RelationGetDisKey(rel) == attno || RelationGetSecDisKey(rel) == attno)
+    {
+        return true;
+    }
+
+    return false;
+}
+
 /* 
  * after tuple deform to slot, exchange the col values with decrypt result.
+ *
+ * crypted cols not read by the scan plan are not decrypted, they are set to null instead.
  */
 void trsprt_crypt_dcrpt_all_col_vale(ScanState *node, TupleTableSlot *slot, Oid relid)
 {// #lizard forgives
@@ -1740,9 +1881,13 @@ void trsprt_crypt_dcrpt_all_col_vale(ScanState *node, TupleTableSlot *slot, Oid
     int                 numberOfAttributes = slot->tts_tupleDescriptor->natts;
     HeapTuple           new_tuple;
     MemoryContext       old_memctx;
+    Bitmapset          *needed_attrs = NULL;
+    bool                prune_attrs  = false;
 
     if (transp_crypt)
     {
+        prune_attrs = trsprt_crypt_get_needed_attrs(node, &needed_attrs);
+
         old_memctx = MemoryContextSwitchTo(slot->tts_mls_mcxt);
         
         if (slot->tts_tuple)
@@ -1774,6 +1919,22 @@ void trsprt_crypt_dcrpt_all_col_vale(ScanState *node, TupleTableSlot *slot, Oid
             
             if (TRANSP_CRYPT_INVALID_ALGORITHM_ID != transp_crypt[attnum].algo_id)
             {
+                /* 
+                 * the col is not read above the scan, skip decrypting it,
+                 * the cipher text does not match the col type, so leave null here.
+                 */
+                if (prune_attrs 
+                    && !trsprt_crypt_col_is_needed(node->ss_currentRelation, needed_attrs, attnum))
+                {
+                    if (need_exchange_slot_tts_tuple)
+                    {
+                        tuple_isnull[attnum] = true;
+                    }
+                    slot_values[attnum] = (Datum) 0;
+                    slot_isnull[attnum] = true;
+                    continue;
+                }
+                
                 if (need_exchange_slot_tts_tuple)
                 {
                     slot_values[attnum]  = trsprt_crypt_decrypt_one_col_value(&transp_crypt[attnum],
@@ -26,6 +26,7 @@
 #ifdef PGXC
 #include "commands/prepare.h"
 #endif
+#include "jit/jit.h"
 #include "storage/predicate.h"
 #include "storage/proc.h"
 #include "utils/memutils.h"
@@ -129,6 +130,7 @@ typedef struct ResourceOwnerData
     ResourceArray snapshotarr;    /* snapshot references */
     ResourceArray filearr;        /* open temporary files */
     ResourceArray dsmarr;        /* dynamic shmem segments */
+    ResourceArray jitarr;        /* JIT contexts */
     ResourceArray prepstmts;    /* prepared statements */
 
     /* We can remember up to MAX_RESOWNER_LOCKS references to local locks. */
@@ -178,6 +180,7 @@ static void PrintFileLeakWarning(File file);
 static void PrintPreparedStmtLeakWarning(char *stmt);
 #endif
 static void PrintDSMLeakWarning(dsm_segment *seg);
+static void PrintJITLeakWarning(JitContext *context);
 
 
 /*****************************************************************************
@@ -517,6 +520,7 @@ ResourceOwnerCreate(ResourceOwner parent, const char *name)
     ResourceArrayInit(&(owner->snapshotarr), PointerGetDatum(NULL));
     ResourceArrayInit(&(owner->filearr), FileGetDatum(-1));
     ResourceArrayInit(&(owner->dsmarr), PointerGetDatum(NULL));
+    ResourceArrayInit(&(owner->jitarr), PointerGetDatum(NULL));
 
     return owner;
 }
@@ -636,6 +640,16 @@ ResourceOwnerReleaseInternal(ResourceOwner owner,
                 PrintDSMLeakWarning(res);
             dsm_detach(res);
         }
+
+        /* Ditto for JIT contexts */
+        while (ResourceArrayGetAny(&(owner->jitarr), &foundres))
+        {
+            JitContext *context = (JitContext *) DatumGetPointer(foundres);
+
+            if (isCommit)
+                PrintJITLeakWarning(context);
+            jit_release_context(context);
+        }
     }
     else if (phase == RESOURCE_RELEASE_LOCKS)
     {
@@ -794,6 +808,7 @@ ResourceOwnerDelete(ResourceOwner owner)
     Assert(owner->snapshotarr.nitems == 0);
     Assert(owner->filearr.nitems == 0);
     Assert(owner->dsmarr.nitems == 0);
+    Assert(owner->jitarr.nitems == 0);
     Assert(owner->nlocks == 0 || owner->nlocks == MAX_RESOWNER_LOCKS + 1);
 
     /*
@@ -820,6 +835,7 @@ ResourceOwnerDelete(ResourceOwner owner)
     ResourceArrayFree(&(owner->snapshotarr));
     ResourceArrayFree(&(owner->filearr));
     ResourceArrayFree(&(owner->dsmarr));
+    ResourceArrayFree(&(owner->jitarr));
     ResourceArrayFree(&(owner->prepstmts));
 
     pfree(owner);
@@ -1421,6 +1437,47 @@ PrintDSMLeakWarning(dsm_segment *seg)
          dsm_segment_handle(seg));
 }
 
+/*
+ * Make sure there is room for at least one more entry in a ResourceOwner's
+ * JIT context reference array.
+ */
+void
+ResourceOwnerEnlargeJIT(ResourceOwner owner)
+{
+    ResourceArrayEnlarge(&(owner->jitarr));
+}
+
+/*
+ * Remember that a JIT context is owned by a ResourceOwner
+ *
+ * Caller must have previously done ResourceOwnerEnlargeJIT()
+ */
+void
+ResourceOwnerRememberJIT(ResourceOwner owner, Datum handle)
+{
+    ResourceArrayAdd(&(owner->jitarr), handle);
+}
+
+/*
+ * Forget that a JIT context is owned by a ResourceOwner
+ */
+void
+ResourceOwnerForgetJIT(ResourceOwner owner, Datum handle)
+{
+    if (!ResourceArrayRemove(&(owner->jitarr), handle))
+        elog(ERROR, "JIT context %p is not owned by resource owner %s",
+             DatumGetPointer(handle), owner->name);
+}
+
+/*
+ * Debugging subroutine
+ */
+static void
+PrintJITLeakWarning(JitContext *context)
+{
+    elog(WARNING, "JIT context leak: context %p still referenced", context);
+}
+
 #ifdef _MLS_
 const char * ResourceOwnerGetName(void)
 {
@@ -299,6 +299,11 @@ struct Tuplesortstate
 #ifdef PGXC
     ResponseCombiner *combiner; /* tuple source, alternate to tapeset */
 #endif /* PGXC */
+#ifdef __OPENTENBASE__
+    TuplesortIndexStream indexstream;    /* tuple source of an index merge */
+    void       *indexstreamarg;    /* its private state */
+    IndexTuple    streamtuple;    /* tuple fetched by getlen_indexstream */
+#endif
 
     /*
      * These function pointers decouple the routines that must know what kind
@@ -643,6 +648,12 @@ static unsigned int getlen_datanode(Tuplesortstate *state, int tapenum,
 static void readtup_datanode(Tuplesortstate *state, SortTuple *stup,
                  int tapenum, unsigned int len);
 #endif
+#ifdef __OPENTENBASE__
+static unsigned int getlen_indexstream(Tuplesortstate *state, int tapenum,
+                   bool eofOK);
+static void readtup_indexstream(Tuplesortstate *state, SortTuple *stup,
+                    int tapenum, unsigned int len);
+#endif
 static int comparetup_cluster(const SortTuple *a, const SortTuple *b,
                    Tuplesortstate *state);
 static void copytup_cluster(Tuplesortstate *state, SortTuple *stup, void *tup);
@@ -1252,6 +1263,126 @@ tuplesort_begin_merge(TupleDesc tupDesc,
 }
 #endif
 
+#ifdef __OPENTENBASE__
+/*
+ * Merge IndexTuples coming from several streams that are each already sorted
+ * the way tuplesort_begin_index_btree would sort them, such as the output of
+ * the sorts done by the participants of a parallel btree build.  Like
+ * tuplesort_begin_merge, the sorter starts in final merge status, each stream
+ * playing the role of a tape holding one run; the tuples are returned by
+ * tuplesort_getindextuple, forward only.
+ *
+ * If enforceUnique is set, equal tuples coming from different streams are
+ * reported as duplicates by the merge comparisons, as they would have been by
+ * a single sort of all the tuples.
+ */
+Tuplesortstate *
+tuplesort_begin_index_merge(Relation heapRel,
+                            Relation indexRel,
+                            bool enforceUnique,
+                            int nstreams,
+                            TuplesortIndexStream stream,
+                            void *arg,
+                            int workMem)
+{
+    Tuplesortstate *state = tuplesort_begin_common(workMem, false);
+    ScanKey        indexScanKey;
+    MemoryContext oldcontext;
+    int            i;
+
+    oldcontext = MemoryContextSwitchTo(state->sortcontext);
+
+    AssertArg(nstreams > 0);
+    AssertArg(stream);
+
+#ifdef TRACE_SORT
+    if (trace_sort)
+        elog(LOG,
+             "begin index merge: unique = %c, streams = %d, workMem = %d",
+             enforceUnique ? 't' : 'f', nstreams, workMem);
+#endif
+
+    state->nKeys = RelationGetNumberOfAttributes(indexRel);
+
+    TRACE_POSTGRESQL_SORT_START(MERGE_SORT,
+                                enforceUnique,
+                                state->nKeys,
+                                workMem,
+                                false);
+
+    state->indexstream = stream;
+    state->indexstreamarg = arg;
+    state->comparetup = comparetup_index_btree;
+    state->copytup = NULL;
+    state->writetup = NULL;
+    state->readtup = readtup_indexstream;
+    state->getlen = getlen_indexstream;
+
+    state->heapRel = heapRel;
+    state->indexRel = indexRel;
+    state->enforceUnique = enforceUnique;
+
+    indexScanKey = _bt_mkscankey_nodata(indexRel);
+
+    /*
+     * Prepare SortSupport data for each column.  The first column is read
+     * back from the tuples, so there is no abbreviation.
+     */
+    state->sortKeys = (SortSupport) palloc0(state->nKeys *
+                                            sizeof(SortSupportData));
+
+    for (i = 0; i < state->nKeys; i++)
+    {
+        SortSupport sortKey = state->sortKeys + i;
+        ScanKey        scanKey = indexScanKey + i;
+        int16        strategy;
+
+        sortKey->ssup_cxt = CurrentMemoryContext;
+        sortKey->ssup_collation = scanKey->sk_collation;
+        sortKey->ssup_nulls_first =
+            (scanKey->sk_flags & SK_BT_NULLS_FIRST) != 0;
+        sortKey->ssup_attno = scanKey->sk_attno;
+        sortKey->abbreviate = false;
+
+        AssertState(sortKey->ssup_attno != 0);
+
+        strategy = (scanKey->sk_flags & SK_BT_DESC) != 0 ?
+            BTGreaterStrategyNumber : BTLessStrategyNumber;
+
+        PrepareSortSupportFromIndexRel(indexRel, strategy, sortKey);
+    }
+
+    _bt_freeskey(indexScanKey);
+
+    /*
+     * logical tape in this case is a sorted stream
+     */
+    state->maxTapes = nstreams;
+    state->tapeRange = nstreams;
+
+    state->mergeactive = (bool *) palloc0(nstreams * sizeof(bool));
+    state->tp_runs = (int *) palloc0(nstreams * sizeof(int));
+    state->tp_dummy = (int *) palloc0(nstreams * sizeof(int));
+    state->tp_tapenum = (int *) palloc0(nstreams * sizeof(int));
+    /* mark each stream (tape) has one run */
+    for (i = 0; i < nstreams; i++)
+    {
+        state->tp_runs[i] = 1;
+        state->tp_tapenum[i] = i;
+    }
+
+    /* one slot per stream in the heap, plus the last returned tuple */
+    init_slab_allocator(state, nstreams + 1);
+
+    beginmerge(state);
+    state->status = TSS_FINALMERGE;
+
+    MemoryContextSwitchTo(oldcontext);
+
+    return state;
+}
+#endif
+
 /*
  * tuplesort_set_bound
  *
@@ -4033,6 +4164,47 @@ readtup_datanode(Tuplesortstate *state, SortTuple *stup,
 }
 #endif /* PGXC */
 
+#ifdef __OPENTENBASE__
+static unsigned int
+getlen_indexstream(Tuplesortstate *state, int tapenum, bool eofOK)
+{
+    IndexTuple    tuple;
+
+    tuple = state->indexstream(state->indexstreamarg, tapenum);
+    if (tuple == NULL)
+    {
+        if (eofOK)
+            return 0;
+        else
+            elog(ERROR, "unexpected end of data");
+    }
+
+    state->streamtuple = tuple;
+
+    return IndexTupleSize(tuple);
+}
+
+static void
+readtup_indexstream(Tuplesortstate *state, SortTuple *stup,
+                    int tapenum, unsigned int len)
+{
+    IndexTuple    tuple = (IndexTuple) readtup_alloc(state, len);
+
+    Assert(state->streamtuple != NULL);
+
+    /* the stream's tuple is only valid until its next one is fetched */
+    memcpy(tuple, state->streamtuple, len);
+    state->streamtuple = NULL;
+
+    stup->tuple = (void *) tuple;
+    /* set up first-column key value */
+    stup->datum1 = index_getattr(tuple,
+                                 1,
+                                 RelationGetDescr(state->indexRel),
+                                 &stup->isnull1);
+}
+#endif
+
 /*
  * Routines specialized for the CLUSTER case (HeapTuple data, with
  * comparisons per a btree index definition)
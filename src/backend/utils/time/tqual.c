@@ -205,6 +205,15 @@ void HeapTupleHderSetXmaxTimestapAtomic(HeapTupleHeader tuple, GlobalTimestamp c
 }
 
 
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+/*
+ * Buffer whose hint bits and commit timestamps are being set in a batch,
+ * see HeapTupleHintBatchBegin.
+ */
+static Buffer HintBatchBuffer = InvalidBuffer;
+static bool HintBatchDirty = false;
+#endif
+
 /*
  * SetHintBits()
  *
@@ -336,6 +345,14 @@ SetHintBits(HeapTupleHeader tuple, Buffer buffer,
 #endif
 
     tuple->t_infomask |= infomask;
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+    /* the page is marked dirty once in HeapTupleHintBatchEnd */
+    if (buffer == HintBatchBuffer)
+    {
+        HintBatchDirty = true;
+    }
+    else
+#endif
     MarkBufferDirtyHint(buffer, true);
 
 	if (mprotect)
@@ -382,6 +399,65 @@ HeapTupleSetHintBits(HeapTupleHeader tuple, Buffer buffer,
 }
 
 
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+/*
+ * HeapTupleHintBatchBegin --- start checking the tuples of a page in a batch
+ *
+ * Until HeapTupleHintBatchEnd, setting hint bits and commit timestamps on
+ * tuples of the buffer only remembers that the page needs to be dirtied,
+ * so a scan marks each page dirty once rather than once per tuple.  The
+ * caller must hold a content lock on the buffer for the whole batch.
+ */
+void
+HeapTupleHintBatchBegin(Buffer buffer)
+{
+    HintBatchBuffer = buffer;
+    HintBatchDirty = false;
+}
+
+void
+HeapTupleHintBatchEnd(void)
+{
+    Buffer        buffer = HintBatchBuffer;
+    BufferDesc *buf;
+    bool        mprotect = false;
+
+    HintBatchBuffer = InvalidBuffer;
+    if (!HintBatchDirty)
+        return;
+    HintBatchDirty = false;
+
+    /* MarkBufferDirtyHint may set the page LSN */
+    if (!BufferIsLocal(buffer))
+    {
+        buf = GetBufferDescriptor(buffer - 1);
+        mprotect = enable_buffer_mprotect &&
+            LWLockHeldByMeInMode(BufferDescriptorGetContentLock(buf), LW_SHARED);
+    }
+    if (mprotect)
+    {
+        BufDisableMemoryProtection(BufferGetPage(buffer), false);
+    }
+
+    MarkBufferDirtyHint(buffer, true);
+
+    if (mprotect)
+    {
+        BufEnableMemoryProtection(BufferGetPage(buffer), false);
+    }
+}
+
+/*
+ * Forget a batch interrupted by an error.
+ */
+void
+AtAbort_HeapTupleHintBatch(void)
+{
+    HintBatchBuffer = InvalidBuffer;
+    HintBatchDirty = false;
+}
+#endif
+
 /*
  * HeapTupleSatisfiesSelf
  *        True iff heap tuple is valid "for itself".
@@ -21,6 +21,7 @@
 
 
 extern bool track_commit_timestamp;
+extern int    commit_ts_cache_horizon;
 extern PGDLLIMPORT bool track_commit_timestamp_guc;
 
 extern bool check_track_commit_timestamp(bool *newval, void **extra,
@@ -31,6 +32,7 @@ extern void TransactionTreeSetCommitTsData(TransactionId xid, int nsubxids,
                                RepOriginId nodeid, bool write_xlog, XLogRecPtr lsn);
 extern bool TransactionIdGetCommitTsData(TransactionId xid, TimestampTz *gts,  
                              RepOriginId *nodeid);
+extern void TransactionIdPrefetchCommitTsData(TransactionId *xids, int nxids);
 extern bool TransactionIdGetLocalCommitTsData(TransactionId xid, TimestampTz *gts,  
                              RepOriginId *nodeid);
 
@@ -55,6 +55,7 @@ extern Buffer RelationGetBufferForTuple_shard(Relation relation, ShardID sid, Si
                           Buffer *vmbuffer, Buffer *vmbuffer_other);
 #ifdef _SHARDING_
 extern void RelationExtendHeapForRedo(RelFileNode rnode, ExtentID eid, ShardID sid);
+extern bool RelationPreextendShard(Relation relation, ShardID sid);
 #endif
 
 #endif                            /* HIO_H */
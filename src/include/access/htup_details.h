@@ -873,6 +873,7 @@ extern Datum fastgetattr(HeapTuple tup, int attnum, TupleDesc tupleDesc,
 
 
 /* prototypes for functions in common/heaptuple.c */
+extern size_t varsize_any(void *p);
 extern Size heap_compute_data_size(TupleDesc tupleDesc,
                        Datum *values, bool *isnull);
 extern void heap_fill_tuple(TupleDesc tupleDesc,
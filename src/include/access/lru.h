@@ -93,6 +93,14 @@ typedef struct LruSharedData
     int           *page_lru_count;
     int            latest_page_number;
 
+    /*
+     * Per-slot sequence counters for LruReadPage_Optimistic().  A counter is
+     * odd while the slot changes identity or its content is modified, see
+     * LruPageChangeBegin/LruPageChangeEnd.  Only changed while holding the
+     * control lock exclusively.
+     */
+    pg_atomic_uint32 *page_seq;
+
     /*
      * Optional array of WAL flush LSNs associated with entries in the SLRU
      * pages.  If not zero/NULL, we must flush WAL before writing pages (true
@@ -157,6 +165,28 @@ typedef LruCtlData *LruCtl;
 
 #define PARTITION_LOCK_IDX(shared) ((shared)->num_slots)
 
+/*
+ * Bracket any change of a slot's page identity or page content, so that
+ * lockless readers in LruReadPage_Optimistic() notice it and retry under the
+ * control lock.  Tolerates an unfinished change left behind by an error.
+ */
+#define LruPageChangeBegin(shared, slotno) \
+    do { \
+        uint32    seq = pg_atomic_read_u32(&(shared)->page_seq[slotno]); \
+        if ((seq & 1) == 0) \
+            pg_atomic_write_u32(&(shared)->page_seq[slotno], seq + 1); \
+        pg_memory_barrier(); \
+    } while (0)
+
+#define LruPageChangeEnd(shared, slotno) \
+    do { \
+        uint32    seq; \
+        pg_memory_barrier(); \
+        seq = pg_atomic_read_u32(&(shared)->page_seq[slotno]); \
+        if ((seq & 1) != 0) \
+            pg_atomic_write_u32(&(shared)->page_seq[slotno], seq + 1); \
+    } while (0)
+
 extern Size LruShmemSize(int nslots, int nlsns);
 extern Size
 LruBufTableShmemSize(int size);
@@ -167,6 +197,8 @@ extern int LruReadPage(LruCtl ctl, int partitionno, int pageno, bool write_ok,
                   TransactionId xid);
 extern int LruReadPage_ReadOnly(LruCtl ctl, int partitionno, int pageno,
                            TransactionId xid);
+extern bool LruReadPage_Optimistic(LruCtl ctl, int partitionno, int pageno,
+                           int offset, char *dest, Size len);
 extern int PagenoMappingPartitionno(LruCtl ctl, int pageno);
 extern LWLock * GetPartitionLock(LruCtl ctl, int partitionno);
 extern void LruWritePage(LruCtl ctl, int partitionno, int slotno);
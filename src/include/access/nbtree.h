@@ -21,6 +21,8 @@
 #include "catalog/pg_index.h"
 #include "lib/stringinfo.h"
 #include "storage/bufmgr.h"
+#include "storage/dsm.h"
+#include "storage/shm_toc.h"
 
 /* There's room for a 16-bit vacuum cycle ID in BTPageOpaqueData */
 typedef uint16 BTCycleId;
@@ -555,5 +557,11 @@ extern void _bt_spooldestroy(BTSpool *btspool);
 extern void _bt_spool(BTSpool *btspool, ItemPointer self,
           Datum *values, bool *isnull);
 extern void _bt_leafbuild(BTSpool *btspool, BTSpool *spool2);
+extern int    _bt_parallel_build_workers(Relation heap, Relation index,
+                           struct IndexInfo *indexInfo);
+extern double _bt_parallel_build(Relation heap, Relation index,
+                   struct IndexInfo *indexInfo, int nworkers,
+                   double *indtuples);
+extern void _bt_parallel_build_main(dsm_segment *seg, shm_toc *toc);
 
 #endif                            /* NBTREE_H */
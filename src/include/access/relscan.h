@@ -77,6 +77,18 @@ typedef struct HeapScanDescData
     /* NB: if rs_cbuf is not InvalidBuffer, we hold a pin on that buffer */
     ParallelHeapScanDesc rs_parallel;    /* parallel scan information */
 
+#ifdef _SHARDING_
+    /*
+     * Shard-pruned scan state.  When rs_shards is not NULL, only the extents
+     * on the scan lists of those shards are visited, in rs_extents order,
+     * instead of every block of the relation.
+     */
+    Bitmapset  *rs_shards;        /* shards to scan, NULL means all */
+    ExtentID   *rs_extents;        /* extents to visit, collected in initscan */
+    int            rs_nextents;    /* number of entries in rs_extents */
+    int            rs_cextent;        /* index of current extent in rs_extents */
+#endif
+
 #ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
     /* statistic account */
     int64        rs_scan_number;            /* scanned number of tuples */
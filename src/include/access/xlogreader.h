@@ -138,6 +138,8 @@ struct XLogReaderState
 
     RepOriginId record_origin;
 
+    TransactionId toplevel_xid; /* XID of top-level transaction */
+
     /* information about blocks referenced by the record. */
     DecodedBkpBlock blocks[XLR_MAX_BLOCK_ID + 1];
 
@@ -225,6 +227,7 @@ extern bool DecodeXLogRecord(XLogReaderState *state, XLogRecord *record,
 #define XLogRecGetRmid(decoder) ((decoder)->decoded_record->xl_rmid)
 #define XLogRecGetXid(decoder) ((decoder)->decoded_record->xl_xid)
 #define XLogRecGetOrigin(decoder) ((decoder)->record_origin)
+#define XLogRecGetTopXid(decoder) ((decoder)->toplevel_xid)
 #define XLogRecGetData(decoder) ((decoder)->main_data)
 #define XLogRecGetDataLen(decoder) ((decoder)->main_data_len)
 #define XLogRecHasAnyBlockRefs(decoder) ((decoder)->max_block_id >= 0)
@@ -13,6 +13,7 @@
 extern bool enable_audit;
 extern bool enable_audit_warning;
 extern bool enable_audit_depend;
+extern bool enable_audit_policy_cache;
 
 typedef enum AuditSQL
 {
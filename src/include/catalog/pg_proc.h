@@ -3016,6 +3016,14 @@ DATA(insert OID = 2845 (  pg_stat_get_db_blk_write_time PGNSP PGUID 12 1 0 0 0 f
 DESCR("statistics: block write time, in milliseconds");
 DATA(insert OID = 3195 (  pg_stat_get_archiver        PGNSP PGUID 12 1 0 0 0 f f f f f f s r 0 0 2249 "" "{20,25,1184,20,25,1184,1184}" "{o,o,o,o,o,o,o}" "{archived_count,last_archived_wal,last_archived_time,failed_count,last_failed_wal,last_failed_time,stats_reset}" _null_ _null_ pg_stat_get_archiver _null_ _null_ _null_ ));
 DESCR("statistics: information about WAL archiver");
+DATA(insert OID = 4633 (  pg_stat_get_cluster_xmin    PGNSP PGUID 12 1 0 0 0 f f f f f f v r 0 0 2249 "" "{25,28,28,28,20,1184,1184,20,20}" "{o,o,o,o,o,o,o,o,o}" "{node_name,local_xmin,reported_xmin,global_xmin,xmin_lag,last_report_time,last_advance_time,report_count,advance_count}" _null_ _null_ pg_stat_get_cluster_xmin _null_ _null_ _null_ ));
+DESCR("statistics: lag of the global xmin behind the local xmin");
+DATA(insert OID = 4638 (  pg_stat_get_runtime_filter  PGNSP PGUID 12 1 0 0 0 f f f f t f v r 0 0 2249 "" "{20,20,20,20,20}" "{o,o,o,o,o}" "{built,sent,received,checked,removed}" _null_ _null_ pg_stat_get_runtime_filter _null_ _null_ _null_ ));
+DESCR("statistics: runtime filters built, sent and applied on this node");
+DATA(insert OID = 4639 (  pg_interval_partition_prepare  PGNSP PGUID 12 1 0 0 0 f f f f t f v u 2 0 23 "2205 23" _null_ _null_ _null_ _null_ _null_ pg_interval_partition_prepare _null_ _null_ _null_ ));
+DESCR("get the partitions of an interval partitioned table ready for their first rows");
+DATA(insert OID = 4640 (  pg_interval_partition_precreate_commands  PGNSP PGUID 12 1 100 0 0 f f f f t t s r 2 0 2249 "1114 23" "{1114,23,25,23,23,25}" "{i,i,o,o,o,o}" "{now,count,relname,partitions,wanted,command}" _null_ _null_ pg_interval_partition_precreate_commands _null_ _null_ _null_ ));
+DESCR("partitions to create ahead of time in interval partitioned tables");
 DATA(insert OID = 2769 ( pg_stat_get_bgwriter_timed_checkpoints PGNSP PGUID 12 1 0 0 0 f f f f t f s r 0 0 20 "" _null_ _null_ _null_ _null_ _null_ pg_stat_get_bgwriter_timed_checkpoints _null_ _null_ _null_ ));
 DESCR("statistics: number of timed checkpoints started by the bgwriter");
 DATA(insert OID = 2770 ( pg_stat_get_bgwriter_requested_checkpoints PGNSP PGUID 12 1 0 0 0 f f f f t f s r 0 0 20 "" _null_ _null_ _null_ _null_ _null_ pg_stat_get_bgwriter_requested_checkpoints _null_ _null_ _null_ ));
@@ -3286,6 +3294,8 @@ DESCR("get local commit timestamp of a transaction");
 
 DATA(insert OID = 3583 ( pg_last_committed_xact PGNSP PGUID 12 1 0 0 0 f f f f t f v s 0 0 2249 "" "{28,1184}" "{o,o}" "{xid,timestamp}" _null_ _null_ pg_last_committed_xact _null_ _null_ _null_ ));
 DESCR("get transaction Id and commit timestamp of latest transaction commit");
+DATA(insert OID = 4636 ( pg_commit_ts_cache_stats PGNSP PGUID 12 1 0 0 0 f f f f t f v r 0 0 2249 "" "{23,28,20}" "{o,o,o}" "{entries,oldest_xid,resets}" _null_ _null_ pg_commit_ts_cache_stats _null_ _null_ _null_ ));
+DESCR("commit timestamp cache of the current backend");
 
 DATA(insert OID = 3537 (  pg_describe_object        PGNSP PGUID 12 1 0 0 0 f f f f t f s s 3 0 25 "26 26 23" _null_ _null_ _null_ _null_ _null_ pg_describe_object _null_ _null_ _null_ ));
 DESCR("get identification of SQL object");
@@ -3395,6 +3405,8 @@ DESCR("current logging collector file location");
 #ifdef __AUDIT__
 DATA(insert OID = 5031 ( pg_rotate_audit_logfile        PGNSP PGUID 12 1 0 0 0 f f f f t f v s 0 0 16 "" _null_ _null_ _null_ _null_ _null_ pg_rotate_audit_logfile _null_ _null_ _null_ ));
 DESCR("rotate audit log file");
+DATA(insert OID = 4634 ( pg_stat_get_audit_logger        PGNSP PGUID 12 1 3 0 0 f f f f f t v r 0 0 2249 "" "{25,20,20,20,20,20,20}" "{o,o,o,o,o,o,o}" "{log_type,queued_records,queued_bytes,full_waits,write_calls,written_records,written_bytes}" _null_ _null_ pg_stat_get_audit_logger _null_ _null_ _null_ ));
+DESCR("statistics: audit log queues and writers");
 #endif
 
 DATA(insert OID = 2623 ( pg_stat_file        PGNSP PGUID 12 1 0 0 0 f f f f t f v s 1 0 2249 "25" "{25,20,1184,1184,1184,1184,16}" "{i,o,o,o,o,o,o}" "{filename,size,access,modification,change,creation,isdir}" _null_ _null_ pg_stat_file_1arg _null_ _null_ _null_ ));
@@ -6655,6 +6667,8 @@ DATA(insert OID = 5025 (  pg_get_audit_action_name       PGNSP PGUID 12 1 0 0 0
 DESCR("audit action name by OID (with fallback)");
 DATA(insert OID = 5026 (  pg_get_audit_action_mode       PGNSP PGUID 12 1 0 0 0 f f f f t f i s 1 0 25 "18" _null_ _null_ _null_ _null_ _null_ pg_get_audit_action_mode _null_ _null_ _null_ ));
 DESCR("audit action name by OID (with fallback)");
+DATA(insert OID = 4637 (  pg_audit_policy_cache_check       PGNSP PGUID 12 1 0 0 0 f f f f t f v r 0 0 2249 "" "{20,20}" "{o,o}" "{probes,mismatches}" _null_ _null_ pg_audit_policy_cache_check _null_ _null_ _null_ ));
+DESCR("compare the compiled audit policies of the current backend with the audit catalogs");
 DATA(insert OID = 5053 (  add_policy       PGNSP PGUID 12 1 0 0 0 f f f f f f i s 10 0 16 "25 25 25 25 25 25 25 16 25 16" _null_ _null_ "{object_schema,object_name,policy_name,audit_columns,audit_condition,handler_schema,handler_module,audit_enable,statement_types,audit_column_opts}" _null_ _null_ add_policy _null_ _null_ _null_ ));
 DESCR("create fga audit policy");
 DATA(insert OID = 5054 (  drop_policy       PGNSP PGUID 12 1 0 0 0 f f f f t f i s 3 0 16 "25 25 25" _null_ _null_ "{object_schema,object_name,policy_name}" _null_ _null_ drop_policy _null_ _null_ _null_ ));
@@ -6742,6 +6756,12 @@ DATA(insert OID = 4625 (  pg_rel_crypt_hash_dump PGNSP PGUID 12 1 0   0 0 f f f
 DESCR("dump rel crypt shmem hash context");                           
 DATA(insert OID = 4626 (  pg_crypt_key_hash_dump PGNSP PGUID 12 1 0   0 0 f f f f t f v s 0 0 2249 ""  "{23,21,21,25,25,26,26,25,25,25,25,16,16}" "{o,o,o,o,o,o,o,o,o,o,o,o,o}" "{seq,algo_id,option,passwd,option_args, encrypt_oid, decrypt_oid, encrypt_prosrc, encrypt_probin,decrypt_prosrc,encrypt_probin,haspubkey,hasprivatekey}" _null_ _null_ pg_crypt_key_hash_dump _null_ _null_ _null_ ));
 DESCR("dump crypt key shmem hash context");
+DATA(insert OID = 4631 (  pg_rel_crypt_page_bench PGNSP PGUID 12 1 10  0 0 f f f f t t v s 1 0 2249 "23"  "{23,21,21,20,20,701}" "{i,o,o,o,o,o}" "{npages,algo_id,option,encrypt_usec,decrypt_usec,mb_per_sec}" _null_ _null_ pg_rel_crypt_page_bench _null_ _null_ _null_ ));
+DESCR("microbenchmark page encrypt and decrypt of every crypt key");
+DATA(insert OID = 4635 (  pg_rel_crypt_sm4_selftest PGNSP PGUID 12 1 5  0 0 f f f f t t v s 0 0 2249 ""  "{25,25,16}" "{o,o,o}" "{path,md5,ok}" _null_ _null_ pg_rel_crypt_sm4_selftest _null_ _null_ _null_ ));
+DESCR("known answer test of the sm4 page crypt paths");
+DATA(insert OID = 4632 (  pg_rel_crypt_page_cache_stats PGNSP PGUID 12 1 0   0 0 f f f f t f v s 0 0 2249 ""  "{23,20,20,20,20,20,20}" "{o,o,o,o,o,o,o}" "{size,used,hits,misses,inserts,evictions,invalidations}" _null_ _null_ pg_rel_crypt_page_cache_stats _null_ _null_ _null_ ));
+DESCR("statistics of the decrypted page cache of crypted relations");
 
 #endif
 
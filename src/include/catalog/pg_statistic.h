@@ -291,4 +291,15 @@ typedef FormData_pg_statistic *Form_pg_statistic;
  */
 #define STATISTIC_KIND_BOUNDS_HISTOGRAM  7
 
+#ifdef __OPENTENBASE__
+/*
+ * An "NDV sketch" slot is kept with the statistics of the partitions of an
+ * interval partitioned table, see statistics/partstats.c.  staop is the "="
+ * operator of the type, whose hash function the values were hashed with.
+ * stavalues is not used and should be NULL.  stanumbers holds the registers
+ * of a HyperLogLog of the non-null sampled values.
+ */
+#define STATISTIC_KIND_NDV_SKETCH  11001
+#endif
+
 #endif                            /* PG_STATISTIC_H */
@@ -24,8 +24,10 @@
 #include "executor/executor.h"
 #include "nodes/parsenodes.h"
 #include "storage/buf.h"
+#include "storage/dsm.h"
 #include "storage/lock.h"
 #include "storage/relfilenode.h"
+#include "storage/shm_toc.h"
 #include "utils/relcache.h"
 #include "pgxc/planner.h"
 
@@ -321,6 +323,8 @@ extern char *GetAnalyzeInfo(int nodeid, char *key);
 
 extern void ExecSample(SampleStmt *stmt, DestReceiver *dest);
 
+extern void analyze_parallel_sample_main(dsm_segment *seg, shm_toc *toc);
+
 extern int     gts_maintain_option;
 typedef enum
 {
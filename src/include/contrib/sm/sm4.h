@@ -58,6 +58,18 @@ void sm4_crypt_ecb( sm4_context *ctx,
                      unsigned char *input,
                      unsigned char *output);
 
+/**
+ * \brief          SM4-ECB reference, one block per call of the round function
+ *
+ *                 Same arguments and output as sm4_crypt_ecb, only used to
+ *                 check it.
+ */
+void sm4_crypt_ecb_ref( sm4_context *ctx,
+                     int mode,
+                     int length,
+                     unsigned char *input,
+                     unsigned char *output);
+
 /**
  * \brief          SM4-CBC buffer encryption/decryption
  * \param ctx      SM4 context
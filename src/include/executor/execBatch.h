@@ -0,0 +1,35 @@
+/*-------------------------------------------------------------------------
+ *
+ * execBatch.h
+ *	  Batch evaluation of simple scan quals over many tuples at once.
+ *
+ * Copyright (c) 2023 THL A29 Limited, a Tencent company.
+ *
+ * This source code file is licensed under the BSD 3-Clause License,
+ * you may obtain a copy of the License at http://opensource.org/license/bsd-3-clause/
+ *
+ * src/include/executor/execBatch.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef EXECBATCH_H
+#define EXECBATCH_H
+
+#include "access/htup.h"
+#include "access/htup_details.h"
+#include "access/tupdesc.h"
+#include "nodes/pg_list.h"
+
+/* a batch never holds more than the visible tuples of one heap page */
+#define BATCH_QUAL_MAX_ROWS		MaxHeapTuplesPerPage
+
+typedef struct BatchQualState BatchQualState;
+
+extern bool enable_batch_qual;
+
+extern BatchQualState *ExecInitBatchQual(List *qual, Index scanrelid,
+				  TupleDesc tupdesc, List **residual);
+extern int ExecBatchQual(BatchQualState *state, HeapTupleData *tuples,
+			  int ntuples, int *sel, int *nfinal);
+
+#endif							/* EXECBATCH_H */
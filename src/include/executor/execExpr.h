@@ -243,6 +243,8 @@ typedef struct ExprEvalStep
         {
             /* attribute number up to which to fetch (inclusive) */
             int            last_var;
+            /* descriptor the JIT compiled deforming was built for, if any */
+            TupleDesc    known_desc;
         }            fetch;
 
         /* for EEOP_INNER/OUTER/SCAN_[SYS]VAR[_FIRST] */
@@ -604,11 +606,17 @@ extern void ExecReadyInterpretedExpr(ExprState *state);
 
 extern ExprEvalOp ExecEvalStepOp(ExprState *state, ExprEvalStep *op);
 
+extern void CheckVarSlotCompatibility(TupleTableSlot *slot, int attnum, Oid vartype);
+
 /*
  * Non fast-path execution functions. These are externs instead of statics in
  * execExprInterp.c, because that allows them to be used by other methods of
  * expression evaluation, reducing code duplication.
  */
+extern void ExecEvalFuncExprFusage(ExprState *state, ExprEvalStep *op,
+                       ExprContext *econtext);
+extern void ExecEvalFuncExprStrictFusage(ExprState *state, ExprEvalStep *op,
+                             ExprContext *econtext);
 extern void ExecEvalParamExec(ExprState *state, ExprEvalStep *op,
                   ExprContext *econtext);
 extern void ExecEvalParamExtern(ExprState *state, ExprEvalStep *op,
@@ -17,6 +17,9 @@
 #include "nodes/execnodes.h"
 #include "nodes/parsenodes.h"
 #include "nodes/plannodes.h"
+#ifdef __OPENTENBASE__
+#include "partitioning/partprune.h"
+#endif
 
 /* See execPartition.c for the definition. */
 typedef struct PartitionDispatchData *PartitionDispatch;
@@ -99,4 +102,37 @@ extern HeapTuple ConvertPartitionTupleSlot(Relation partrel, TupleConversionMap
 						  TupleTableSlot **p_my_slot);
 extern void ExecCleanupTupleRouting(PartitionTupleRouting *proute);
 
+#ifdef __OPENTENBASE__
+/*-----------------------
+ * PartitionPruneState - run-time state to prune the subplans of an Append or
+ * MergeAppend, built from its PartitionPruneInfo
+ *
+ * pinfo			The plan-time information
+ * planstate		The Append or MergeAppend, whose ExprContext is used to
+ *					evaluate the expressions compared to the partition key
+ * reloid			OID of the partitioned table
+ * context			Partition key and bounds of a declaratively partitioned
+ *					table, and the states of the expressions of its pruning
+ *					steps
+ * prune_context	Memory context reset after each pruning
+ * do_initial_prune	Can pruning happen once, when the executor starts?  Not
+ *					if it depends on PARAM_EXEC Params, which change between
+ *					rescans.
+ *-----------------------
+ */
+typedef struct PartitionPruneState
+{
+	PartitionPruneInfo *pinfo;
+	PlanState  *planstate;
+	Oid			reloid;
+	PartitionPruneContext context;
+	MemoryContext prune_context;
+	bool		do_initial_prune;
+} PartitionPruneState;
+
+extern PartitionPruneState *ExecSetupPartitionPruneState(PlanState *planstate,
+							 PartitionPruneInfo *pinfo);
+extern Bitmapset *ExecFindMatchingSubPlans(PartitionPruneState *prunestate);
+#endif
+
 #endif							/* EXECPARTITION_H */
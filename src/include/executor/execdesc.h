@@ -61,6 +61,7 @@ typedef struct QueryDesc
      DataPumpSender sender; /* used for locally data transfering */
     ParamExecData *es_param_exec_vals;    /* values of internal params */
 	RemoteEPQContext *epqContext; /* information about EvalPlanQual from remote */
+	struct RuntimeFilter *runtimeFilter; /* rows failing it are not sent */
 #endif
                                  
     int         myindex;        /* -1 if locally executed subplan is producing
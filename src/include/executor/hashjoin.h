@@ -68,9 +68,6 @@ typedef struct HashJoinTupleData
 {
     struct HashJoinTupleData *next; /* link to next tuple in same bucket */
     uint32        hashvalue;        /* tuple's hash code */
-#ifdef __OPENTENBASE__
-    int         workerNumber;   /* next tuple comes from which parallel worker */
-#endif
     /* Tuple data, in MinimalTuple format, follows on a MAXALIGN boundary */
 }            HashJoinTupleData;
 
@@ -129,6 +126,30 @@ typedef struct HashMemoryChunkData *HashMemoryChunk;
 #define HASH_CHUNK_SIZE            (32 * 1024L)
 #define HASH_CHUNK_THRESHOLD    (HASH_CHUNK_SIZE / 4)
 
+#ifdef __OPENTENBASE__
+/*
+ * The hash table of a parallel hash join is shared by all workers: its
+ * bucket array lives in the parallel DSM segment, and the tuples of the
+ * current batch in the dsa area of the first worker, packed in chunks the
+ * same way.  In such a table, the next links of the tuples and the bucket
+ * heads are dsa_pointers, and each worker pushes its tuples onto the
+ * buckets with a compare-and-swap.  A worker keeps track of the chunks it
+ * allocated, to free them when moving to the next batch.
+ */
+typedef struct HashShmChunkData
+{
+    dsa_pointer next;            /* next chunk of the same worker */
+    size_t        maxlen;            /* size of the buffer holding the tuples */
+    size_t        used;            /* number of buffer bytes already used */
+
+    char        data[FLEXIBLE_ARRAY_MEMBER];    /* buffer allocated at the end */
+}            HashShmChunkData;
+
+typedef struct HashShmChunkData *HashShmChunk;
+
+#define HASH_SHM_CHUNK_HEADER    MAXALIGN(offsetof(HashShmChunkData, data))
+#endif
+
 typedef struct HashJoinTableData
 {
     int            nbuckets;        /* # buckets in the in-memory hash table */
@@ -141,10 +162,11 @@ typedef struct HashJoinTableData
     /* buckets[i] is head of list of tuples in i'th in-memory bucket */
     struct HashJoinTupleData **buckets;
 #ifdef __OPENTENBASE__
-    int        *bucket_wNum; /* head of current bucket comes from which parallel worker */
-    /* buckets_tail[i] is tail of list of tuples in i'th in-memory bucket */
-    struct HashJoinTupleData **buckets_tail;
-    int        *bucket_tail_wNum; /* tail of current bucket comes from which parallel worker */
+    /* bucket heads of a table shared by parallel workers, instead of buckets */
+    dsa_pointer_atomic *shmBuckets;
+    dsa_pointer shmChunks;        /* chunks of our tuples in the shared table */
+    dsa_pointer shmOldChunks;    /* chunks left behind by a repartition */
+    ParallelHashJoinGrowth *shmGrowth;    /* shared number of batches */
 #endif
     /* buckets array is per-batch storage, as are all the tuples */
 
@@ -152,9 +174,6 @@ typedef struct HashJoinTableData
 
     bool        skewEnabled;    /* are we using skew optimization? */
     HashSkewBucket **skewBucket;    /* hashtable of skew buckets */
-#ifdef __OPENTENBASE__
-    HashSkewBucket **skewBucket_tail; /* tail of skew buckets */
-#endif
     int            skewBucketLen;    /* size of skewBucket array (a power of 2!) */
     int            nSkewBuckets;    /* number of active skew buckets */
     int           *skewBucketNums; /* array indexes of active skew buckets */
@@ -200,6 +219,11 @@ typedef struct HashJoinTableData
 
     /* used for dense allocation of tuples (into linked chunks) */
     HashMemoryChunk chunks;        /* one list for the whole batch */
+
+#ifdef __OPENTENBASE__
+    /* bloom filter over the hash values of all inner tuples, or NULL */
+    struct RuntimeFilter *runtimeFilter;
+#endif
 }            HashJoinTableData;
 
 #endif                            /* HASHJOIN_H */
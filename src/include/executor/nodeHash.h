@@ -28,9 +28,24 @@ extern void ExecReScanHash(HashState *node);
 extern HashJoinTable ExecHashTableCreate(Hash *node, List *hashOperators,
 					bool keepNulls);
 #ifdef __OPENTENBASE__
-extern HashJoinTable ExecShmHashTableCreate(Hash *node, List *hashOperators,
-					bool keepNulls);
+extern void ExecShmHashTableChooseSize(Hash *node, int nworkers,
+						   int *numbuckets, int *numbatches,
+						   int *maxbatches);
+extern HashJoinTable ExecShmHashTableCreate(List *hashOperators, bool keepNulls,
+					   int nbuckets, int nbatch,
+					   dsa_pointer_atomic *buckets,
+					   ParallelHashJoinGrowth *growth);
+extern void ExecShmHashTableInsert(HashJoinTable hashtable,
+					   TupleTableSlot *slot,
+					   uint32 hashvalue);
+extern void ExecShmHashTableSetNumBatches(HashJoinTable hashtable, int nbatch);
+extern void ExecShmHashTableRepartition(HashJoinTable hashtable,
+							pg_atomic_uint32 *nextBuckets);
+extern void ExecShmHashTableFreeOldChunks(HashJoinTable hashtable);
+extern void ExecShmHashTableReset(HashJoinTable hashtable);
 extern Node *MultiExecShmHash(HashState *node);
+extern void ExecHashTableInitRuntimeFilter(HashJoinTable hashtable, Hash *node,
+							   List *outerkeys);
 #endif
 
 extern void ExecHashTableDestroy(HashJoinTable hashtable);
@@ -15,6 +15,7 @@
 #define PRODUCER_RECEIVER_H
 
 #include "tcop/dest.h"
+#include "executor/runtimefilter.h"
 #include "pgxc/locator.h"
 #include "pgxc/squeue.h"
 
@@ -37,5 +38,7 @@ extern bool ProducerReceiverPushBuffers(DestReceiver *self);
 
 #ifdef __OPENTENBASE__
 extern void SetProducerNodeMap(DestReceiver *self, int16 *nodemap);
+extern void SetProducerRuntimeFilter(DestReceiver *self,
+                         RuntimeFilter *filter, TupleDesc tupdesc);
 #endif
 #endif   /* PRODUCER_RECEIVER_H */
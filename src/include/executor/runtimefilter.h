@@ -0,0 +1,118 @@
+/*-------------------------------------------------------------------------
+ *
+ * runtimefilter.h
+ *	  Bloom filters built over the inner side of a hash join and applied by
+ *	  the producers of its outer side.
+ *
+ * Copyright (c) 2023 THL A29 Limited, a Tencent company.
+ *
+ * This source code file is licensed under the BSD 3-Clause License,
+ * you may obtain a copy of the License at http://opensource.org/license/bsd-3-clause/
+ *
+ * src/include/executor/runtimefilter.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef RUNTIMEFILTER_H
+#define RUNTIMEFILTER_H
+
+#include "access/tupdesc.h"
+#include "executor/tuptable.h"
+#include "fmgr.h"
+#include "lib/stringinfo.h"
+#include "storage/dsm.h"
+
+/* a join key, as a column of the tuples produced for the join's outer side */
+typedef struct RuntimeFilterKey
+{
+	AttrNumber	attno;			/* column number in the producer's output */
+	Oid			typid;			/* type of the column */
+	Oid			hashfn;			/* outer hash function of the join operator */
+	bool		strict;			/* does a NULL key never match? */
+} RuntimeFilterKey;
+
+typedef struct RuntimeFilter
+{
+	int			nkeys;
+	RuntimeFilterKey *keys;
+	FmgrInfo   *hashfunctions;	/* looked up by RuntimeFilterPrepare */
+	int			nhashes;		/* number of bits set per value */
+	uint32		nbits;			/* size of the bitmap, a power of 2 */
+	uint64		nvalues;		/* number of values added */
+	uint64	   *bits;
+	/* local to the backend applying the filter, see RuntimeFilterReport */
+	uint64		nchecked;		/* rows checked against the filter */
+	uint64		nremoved;		/* rows the filter proved to have no match */
+} RuntimeFilter;
+
+/* cluster node wide counters, shown by pg_stat_get_runtime_filter() */
+typedef enum RuntimeFilterStat
+{
+	RUNTIME_FILTER_STAT_BUILT,		/* filters selective enough to push */
+	RUNTIME_FILTER_STAT_SENT,		/* Bind messages carrying a filter */
+	RUNTIME_FILTER_STAT_RECEIVED,	/* filters read from a Bind message */
+	RUNTIME_FILTER_STAT_CHECKED,	/* rows checked by the producers */
+	RUNTIME_FILTER_STAT_REMOVED,	/* rows not sent because of a filter */
+	RUNTIME_FILTER_NSTATS
+} RuntimeFilterStat;
+
+extern bool enable_runtime_filter;
+extern int	runtime_filter_max_size;
+
+extern RuntimeFilter *RuntimeFilterCreate(int nkeys, double nvalues);
+extern bool RuntimeFilterIsSelective(RuntimeFilter *filter);
+extern void RuntimeFilterSerialize(RuntimeFilter *filter, StringInfo buf);
+extern RuntimeFilter *RuntimeFilterDeserialize(StringInfo msg);
+extern bool RuntimeFilterPrepare(RuntimeFilter *filter, TupleDesc tupdesc);
+extern bool RuntimeFilterHashSlot(RuntimeFilter *filter, TupleTableSlot *slot,
+					  uint32 *hashvalue);
+extern bool RuntimeFilterCheckSlot(RuntimeFilter *filter, TupleTableSlot *slot);
+extern dsm_segment *RuntimeFilterExport(RuntimeFilter *filter);
+extern RuntimeFilter *RuntimeFilterImport(dsm_handle handle);
+extern void RuntimeFilterReport(RuntimeFilter *filter);
+extern void RuntimeFilterCount(RuntimeFilterStat stat, uint64 n);
+extern Size RuntimeFilterShmemSize(void);
+extern void RuntimeFilterShmemInit(void);
+
+/*
+ * The k bit positions of a value are derived from its 32-bit hash join hash
+ * value by double hashing, the second hash being a remix of the first one.
+ */
+#define RUNTIME_FILTER_HASH2(h) \
+	((((h) * UINT64CONST(0x9E3779B97F4A7C15)) >> 32) | 1)
+
+static inline void
+RuntimeFilterAdd(RuntimeFilter *filter, uint32 hashvalue)
+{
+	uint32		h2 = (uint32) RUNTIME_FILTER_HASH2((uint64) hashvalue);
+	uint32		mask = filter->nbits - 1;
+	uint32		pos = hashvalue;
+	int			i;
+
+	for (i = 0; i < filter->nhashes; i++)
+	{
+		filter->bits[(pos & mask) >> 6] |= UINT64CONST(1) << (pos & 63);
+		pos += h2;
+	}
+	filter->nvalues++;
+}
+
+/* false if no value with this hash value was added to the filter */
+static inline bool
+RuntimeFilterTest(RuntimeFilter *filter, uint32 hashvalue)
+{
+	uint32		h2 = (uint32) RUNTIME_FILTER_HASH2((uint64) hashvalue);
+	uint32		mask = filter->nbits - 1;
+	uint32		pos = hashvalue;
+	int			i;
+
+	for (i = 0; i < filter->nhashes; i++)
+	{
+		if ((filter->bits[(pos & mask) >> 6] & (UINT64CONST(1) << (pos & 63))) == 0)
+			return false;
+		pos += h2;
+	}
+	return true;
+}
+
+#endif							/* RUNTIMEFILTER_H */
@@ -0,0 +1,87 @@
+/*-------------------------------------------------------------------------
+ *
+ * jit.h
+ *      Provider independent JIT infrastructure.
+ *
+ * Copyright (c) 2023 THL A29 Limited, a Tencent company.
+ *
+ * This source code file is licensed under the BSD 3-Clause License,
+ * you may obtain a copy of the License at http://opensource.org/license/bsd-3-clause/
+ *
+ * src/include/jit/jit.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef JIT_H
+#define JIT_H
+
+#include "portability/instr_time.h"
+#include "utils/resowner.h"
+
+
+/* Flags determining what kind of JIT operations to perform for a query */
+#define PGJIT_NONE        0
+#define PGJIT_PERFORM    (1 << 0)
+#define PGJIT_OPT3        (1 << 1)
+#define PGJIT_EXPR        (1 << 2)
+#define PGJIT_DEFORM    (1 << 3)
+
+
+typedef struct JitInstrumentation
+{
+    /* number of functions generated for this query */
+    size_t        created_functions;
+
+    /* number of functions reused from the backend's code cache */
+    size_t        cached_functions;
+
+    /* accumulated time to generate code */
+    instr_time    generation_counter;
+
+    /* accumulated time for optimization */
+    instr_time    optimization_counter;
+
+    /* accumulated time for code emission */
+    instr_time    emission_counter;
+} JitInstrumentation;
+
+typedef struct JitContext
+{
+    /* see PGJIT_* above */
+    int            flags;
+
+    ResourceOwner resowner;
+
+    JitInstrumentation instr;
+} JitContext;
+
+struct ExprState;
+
+typedef struct JitProviderCallbacks JitProviderCallbacks;
+
+typedef void (*JitProviderInit) (JitProviderCallbacks *cb);
+typedef void (*JitProviderReleaseContextCB) (JitContext *context);
+typedef bool (*JitProviderCompileExprCB) (struct ExprState *state);
+
+struct JitProviderCallbacks
+{
+    JitProviderReleaseContextCB release_context;
+    JitProviderCompileExprCB compile_expr;
+};
+
+
+/* GUCs */
+extern bool jit_enabled;
+extern char *jit_provider;
+extern bool jit_expressions;
+extern bool jit_tuple_deforming;
+extern double jit_above_cost;
+extern double jit_optimize_above_cost;
+extern int    jit_cache_size;
+
+
+extern int    jit_plan_flags(double total_cost);
+extern void jit_release_context(JitContext *context);
+extern bool jit_compile_expr(struct ExprState *state);
+
+#endif                            /* JIT_H */
@@ -0,0 +1,195 @@
+/*-------------------------------------------------------------------------
+ *
+ * llvmjit.h
+ *      LLVM JIT provider.
+ *
+ * Copyright (c) 2023 THL A29 Limited, a Tencent company.
+ *
+ * This source code file is licensed under the BSD 3-Clause License,
+ * you may obtain a copy of the License at http://opensource.org/license/bsd-3-clause/
+ *
+ * src/include/jit/llvmjit.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef LLVMJIT_H
+#define LLVMJIT_H
+
+#ifndef USE_LLVM
+#error "llvmjit.h should only be included by code dealing with llvm"
+#endif
+
+#include <llvm-c/Core.h>
+#include <llvm-c/Types.h>
+
+#include "access/tupdesc.h"
+#include "jit/jit.h"
+#include "lib/stringinfo.h"
+
+
+/*
+ * A compiled function.  Functions are shared through the backend's code
+ * cache: a query pins every function it runs, and only unpinned functions
+ * are ever evicted from the cache and freed.
+ */
+typedef struct LLVMJitFunction LLVMJitFunction;
+
+typedef struct LLVMJitContext
+{
+    JitContext    base;
+
+    /* functions pinned by this query */
+    LLVMJitFunction **functions;
+    int            nfunctions;
+    int            maxfunctions;
+} LLVMJitContext;
+
+
+/* type and struct definitions, for use in generated code */
+extern LLVMTypeRef TypeSizeT;
+extern LLVMTypeRef TypeDatum;
+extern LLVMTypeRef TypeStorageBool;
+extern LLVMTypeRef TypeInt8Ptr;
+extern LLVMTypeRef TypeDatumPtr;
+extern LLVMTypeRef TypeVoid;
+
+
+extern void _PG_jit_provider_init(JitProviderCallbacks *cb);
+
+extern LLVMJitContext *llvm_create_context(int jitFlags);
+extern LLVMContextRef llvm_context(void);
+extern LLVMModuleRef llvm_create_module(LLVMJitContext *context);
+extern char *llvm_expand_funcname(LLVMJitContext *context, const char *basename);
+extern void *llvm_cache_lookup(LLVMJitContext *context, StringInfo key);
+extern void *llvm_emit_function(LLVMJitContext *context, LLVMModuleRef module,
+                   const char *funcname, StringInfo key);
+
+
+/*
+ * Code generation functions.
+ */
+extern bool llvm_compile_expr(struct ExprState *state);
+extern bool llvm_deform_supported(TupleDesc desc, int natts);
+extern void llvm_deform_cache_key(StringInfo key, TupleDesc desc, int natts);
+extern LLVMValueRef slot_compile_deform(LLVMJitContext *context,
+                    LLVMModuleRef mod, TupleDesc desc, int natts);
+
+
+/*
+ * Inline helpers for generating code.  Struct members are addressed by byte
+ * offset, so generated code needs no LLVM mirror of the C type definitions;
+ * pointers to structs are passed around as i8*.
+ */
+
+/* emit an integer constant of the given width */
+static inline LLVMValueRef
+l_int8_const(int8 i)
+{
+    return LLVMConstInt(LLVMInt8TypeInContext(llvm_context()), i, false);
+}
+
+static inline LLVMValueRef
+l_int16_const(int16 i)
+{
+    return LLVMConstInt(LLVMInt16TypeInContext(llvm_context()), i, false);
+}
+
+static inline LLVMValueRef
+l_int32_const(int32 i)
+{
+    return LLVMConstInt(LLVMInt32TypeInContext(llvm_context()), i, false);
+}
+
+static inline LLVMValueRef
+l_int64_const(int64 i)
+{
+    return LLVMConstInt(LLVMInt64TypeInContext(llvm_context()), i, false);
+}
+
+static inline LLVMValueRef
+l_sizet_const(size_t i)
+{
+    return LLVMConstInt(TypeSizeT, i, false);
+}
+
+static inline LLVMValueRef
+l_sbool_const(bool i)
+{
+    return LLVMConstInt(TypeStorageBool, (int) i, false);
+}
+
+/* emit a pointer constant, e.g. the address of a C function */
+static inline LLVMValueRef
+l_ptr_const(void *ptr, LLVMTypeRef type)
+{
+    LLVMValueRef c = LLVMConstInt(TypeSizeT, (uintptr_t) ptr, false);
+
+    return LLVMConstIntToPtr(c, type);
+}
+
+static inline LLVMTypeRef
+l_ptr(LLVMTypeRef t)
+{
+    return LLVMPointerType(t, 0);
+}
+
+/* pointer to the member at byte offset 'off' of the struct at 'base' */
+static inline LLVMValueRef
+l_field_ptr(LLVMBuilderRef b, LLVMValueRef base, size_t off, LLVMTypeRef type)
+{
+    LLVMValueRef v_off = l_sizet_const(off);
+    LLVMValueRef v_ptr;
+
+    v_ptr = LLVMBuildGEP2(b, LLVMInt8TypeInContext(llvm_context()),
+                          base, &v_off, 1, "");
+    return LLVMBuildBitCast(b, v_ptr, l_ptr(type), "");
+}
+
+static inline LLVMValueRef
+l_load_field(LLVMBuilderRef b, LLVMValueRef base, size_t off,
+             LLVMTypeRef type, const char *name)
+{
+    return LLVMBuildLoad2(b, type, l_field_ptr(b, base, off, type), name);
+}
+
+static inline void
+l_store_field(LLVMBuilderRef b, LLVMValueRef val, LLVMValueRef base,
+              size_t off)
+{
+    LLVMBuildStore(b, val, l_field_ptr(b, base, off, LLVMTypeOf(val)));
+}
+
+/* element 'idx' of an array of 'type' starting at 'base' */
+static inline LLVMValueRef
+l_elem_ptr(LLVMBuilderRef b, LLVMTypeRef type, LLVMValueRef base,
+           LLVMValueRef idx)
+{
+    return LLVMBuildGEP2(b, type, base, &idx, 1, "");
+}
+
+/* DatumGetBool() */
+static inline LLVMValueRef
+l_datum_is_true(LLVMBuilderRef b, LLVMValueRef v_datum)
+{
+    return LLVMBuildICmp(b, LLVMIntNE,
+                         LLVMBuildTrunc(b, v_datum, TypeStorageBool, ""),
+                         l_sbool_const(0), "");
+}
+
+/* test a stored bool */
+static inline LLVMValueRef
+l_sbool_is_true(LLVMBuilderRef b, LLVMValueRef v_bool)
+{
+    return LLVMBuildICmp(b, LLVMIntNE, v_bool, l_sbool_const(0), "");
+}
+
+/* call a C function by address */
+static inline LLVMValueRef
+l_call(LLVMBuilderRef b, LLVMTypeRef fntype, void *fnaddr,
+       LLVMValueRef *args, int nargs, const char *name)
+{
+    return LLVMBuildCall2(b, fntype, l_ptr_const(fnaddr, l_ptr(fntype)),
+                          args, nargs, name);
+}
+
+#endif                            /* LLVMJIT_H */
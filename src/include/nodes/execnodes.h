@@ -48,6 +48,7 @@
  */
 struct ExprState;                /* forward references in this file */
 struct ExprContext;
+struct PlanState;
 struct ExprEvalStep;            /* avoid including execExpr.h everywhere */
 
 typedef Datum (*ExprStateEvalFunc) (struct ExprState *expression,
@@ -90,6 +91,12 @@ typedef struct ExprState
     /* original expression tree, for debugging only */
     Expr       *expr;
 
+    /* private state for an evalfunc */
+    void       *evalfunc_private;
+
+    /* parent PlanState node, if any; decides whether it may be JIT compiled */
+    struct PlanState *parent;
+
     /*
      * XXX: following only needed during "compilation", could be thrown away.
      */
@@ -544,6 +551,14 @@ typedef struct EState
     /* The per-query shared memory area to use for parallel execution. */
     struct dsa_area *es_query_dsa;
 
+    /*
+     * JIT information.  es_jit_flags indicates whether JIT should be
+     * performed and with which options (see PGJIT_*), es_jit is created
+     * on-demand when JITing is performed.
+     */
+    int            es_jit_flags;
+    struct JitContext *es_jit;
+
 #ifdef __AUDIT__
     int32        es_remote_subplan_num;    /* number of RemoteSubplan in es_plannedstmt */
 #endif
@@ -1094,6 +1109,11 @@ typedef struct ModifyTableState
  *
  *        nplans            how many plans are in the array
  *        whichplan        which plan is being executed (0 .. n-1)
+ *        prune_state        to prune the subplans at run time, or NULL
+ *        plannos            index in the plan's list of each PlanState
+ *        valid_plans        PlanStates left after run-time pruning
+ *        nvalid            number of them
+ *        prune_pending    must valid_plans be computed again?
  * ----------------
  */
 typedef struct AppendState
@@ -1102,6 +1122,13 @@ typedef struct AppendState
     PlanState **appendplans;    /* array of PlanStates for my inputs */
     int            as_nplans;
     int            as_whichplan;
+#ifdef __OPENTENBASE__
+    struct PartitionPruneState *as_prune_state;
+    int           *as_plannos;        /* array of length as_nplans */
+    int           *as_valid_plans;    /* array of length as_nplans */
+    int            as_nvalid;
+    bool        as_prune_pending;
+#endif
 } AppendState;
 
 /* ----------------
@@ -1113,6 +1140,7 @@ typedef struct AppendState
  *        slots            current output tuple of each subplan
  *        heap            heap of active tuples
  *        initialized        true if we have fetched first tuple from each subplan
+ *        prune_state etc    as in AppendState
  * ----------------
  */
 typedef struct MergeAppendState
@@ -1125,6 +1153,13 @@ typedef struct MergeAppendState
     TupleTableSlot **ms_slots;    /* array of length ms_nplans */
     struct binaryheap *ms_heap; /* binary heap of slot indices */
     bool        ms_initialized; /* are subplans started? */
+#ifdef __OPENTENBASE__
+    struct PartitionPruneState *ms_prune_state;
+    int           *ms_plannos;        /* array of length ms_nplans */
+    int           *ms_valid_plans;    /* array of length ms_nplans */
+    int            ms_nvalid;
+    bool        ms_prune_pending;
+#endif
 } MergeAppendState;
 
 /* ----------------
@@ -1231,6 +1266,15 @@ typedef struct SeqScanState
 {
     ScanState    ss;                /* its first field is NodeTag */
     Size        pscan_len;        /* size of parallel heap scan descriptor */
+    /* quals evaluated over the visible tuples of a page, see execBatch.c */
+    struct BatchQualState *batchqual;    /* NULL if quals are all per tuple */
+    ExprState     *batchrowqual;    /* batchqual clauses evaluated per tuple */
+    HeapTupleData *batchtuples;    /* tuples of the current batch */
+    int            batchntuples;    /* number of entries in batchtuples */
+    int           *batchsel;        /* indexes of batchtuples passing batchqual */
+    int            batchnsel;        /* number of entries in batchsel */
+    int            batchpos;        /* next entry of batchsel to return */
+    int            batchnext;        /* next tuple to check with batchrowqual */
 } SeqScanState;
 
 /* ----------------
@@ -1839,22 +1883,49 @@ typedef struct HashTableBufFileName
     dsa_pointer name;
 } HashTableBufFileName;
 
+/* work distribution of one batch of a shared parallel hashjoin */
+typedef struct ParallelHashJoinBatch
+{
+    pg_atomic_uint32 nextBuckets;   /* next range of buckets to be cleared */
+    pg_atomic_uint32 nextWorker;    /* next worker whose inner batch file is to be loaded */
+    pg_atomic_uint64 ntuples;       /* number of inner tuples in the batch */
+} ParallelHashJoinBatch;
+
+/* growth of the number of batches of a shared parallel hashjoin */
+typedef struct ParallelHashJoinGrowth
+{
+    pg_atomic_uint32 nbatch;        /* number of batches, doubled during the build */
+    pg_atomic_uint64 spaceUsed;     /* estimated size of batch 0 in the shared hashtable */
+    Size             spaceAllowed;  /* work_mem of all the workers */
+    int              maxbatch;      /* size of the batches array */
+} ParallelHashJoinGrowth;
+
 /* hashjoin state for paralle workers */
 typedef struct ParallelHashJoinState
 {
     volatile int                    numExpectedParallelWorkers; /* number of expected parallel workers */
     volatile int                    numLaunchedParallelWorkers; /* number of launched parallel workers */
+    int                             nbuckets;                   /* number of buckets of the shared hashtable */
+    int                             nbatch;                     /* number of batches of the shared hashtable */
+    int                             maxbatch;                   /* number of batches it can grow to */
     volatile ParallelHashJoinStatus *statusParallelWorker;      /* status of parallel workers when execution hashjoin */
-    volatile dsa_pointer            *hashTableParallelWorker;   /* hashtable in shm of parallel workers */
+    volatile int                    *phaseParallelWorker;       /* last batch phase reached by parallel workers */
     volatile dsa_pointer            *bufFileNames;              /* hashtable bufFiles's filenames */
     volatile dsa_pointer            *outerBufFileNames;         /* outer bufFiles's filenames */
+    ParallelHashJoinBatch           *batches;                   /* work distribution of each batch */
+    ParallelHashJoinGrowth          *growth;                    /* number of batches, during the build */
+    dsa_pointer_atomic              *buckets;                   /* buckets of the shared hashtable */
 } ParallelHashJoinState;
 
-#define ParallelHashJoinState_Size(numWorkers) (sizeof(ParallelHashJoinState) \
-                                                + sizeof(ParallelHashJoinStatus) * numWorkers \
-                                                + sizeof(dsa_pointer) * numWorkers \
-                                                + sizeof(dsa_pointer) * numWorkers \
-                                                + sizeof(dsa_pointer) * numWorkers)
+#define ParallelHashJoinState_Size(numWorkers, nbuckets, maxbatch) \
+                                               (MAXALIGN(sizeof(ParallelHashJoinState) \
+                                                + sizeof(ParallelHashJoinStatus) * (numWorkers) \
+                                                + sizeof(int) * (numWorkers) \
+                                                + sizeof(dsa_pointer) * (numWorkers) \
+                                                + sizeof(dsa_pointer) * (numWorkers)) \
+                                                + MAXALIGN(sizeof(ParallelHashJoinBatch) * (maxbatch)) \
+                                                + MAXALIGN(sizeof(ParallelHashJoinGrowth)) \
+                                                + sizeof(dsa_pointer_atomic) * (nbuckets))
 #endif
 
 typedef struct HashJoinState
@@ -1884,6 +1955,10 @@ typedef struct HashJoinState
     size_t      matched_tuples;
     Size                  hj_parallelStateLen;
     ParallelHashJoinState *hj_parallelState;
+    BufFile   **hj_ShmInnerBatchFile;    /* inner batch files we wrote for the
+                                          * shared hashtable */
+    bool        hj_PushRuntimeFilter;    /* push a bloom filter of the inner
+                                          * side to the outer RemoteSubplan? */
 #endif
 } HashJoinState;
 
@@ -2006,6 +2081,34 @@ typedef struct SortState
 #endif
 } SortState;
 
+/* ----------------
+ *     IncrementalSortState information
+ *
+ *        The input is read in batches that end where the presorted columns
+ *        change, and each batch is sorted separately.
+ *
+ *        presortedKeys    comparators of the presorted columns
+ *        group_pivot        last tuple of the batch's minimum size; the batch
+ *                        goes on as long as the presorted columns match it
+ *        transfer_tuple    tuple that ended the batch, first of the next one
+ * ----------------
+ */
+typedef struct IncrementalSortState
+{
+    ScanState    ss;                /* its first field is NodeTag */
+    bool        bounded;        /* is the result set bounded? */
+    int64        bound;            /* if bounded, how many tuples are needed */
+    bool        outer_done;        /* has the outer plan been exhausted? */
+    int64        n_returned;        /* tuples returned since the last rescan */
+    SortSupport presortedKeys;    /* array of length nPresortedCols */
+    TupleTableSlot *group_pivot;
+    TupleTableSlot *transfer_tuple;
+    void       *tuplesortstate; /* private state of tuplesort.c */
+    /* instrumentation, for EXPLAIN ANALYZE */
+    int64        n_batches;        /* number of batches sorted */
+    TuplesortInstrumentation max_instrument;    /* largest batch sort */
+} IncrementalSortState;
+
 /* ---------------------
  *    GroupState information
  * ---------------------
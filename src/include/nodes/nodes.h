@@ -86,6 +86,7 @@ typedef enum NodeTag
     T_HashJoin,
     T_Material,
     T_Sort,
+    T_IncrementalSort,
     T_Group,
     T_Agg,
     T_WindowAgg,
@@ -139,6 +140,9 @@ typedef enum NodeTag
     T_NestLoopParam,
     T_PlanRowMark,
     T_PlanInvalItem,
+#ifdef __OPENTENBASE__
+    T_PartitionPruneInfo,
+#endif
 
     /*
      * TAGS FOR PLAN STATE NODES (execnodes.h)
@@ -177,6 +181,7 @@ typedef enum NodeTag
     T_HashJoinState,
     T_MaterialState,
     T_SortState,
+    T_IncrementalSortState,
     T_GroupState,
     T_AggState,
     T_WindowAggState,
@@ -315,6 +320,7 @@ typedef enum NodeTag
     T_ProjectionPath,
     T_ProjectSetPath,
     T_SortPath,
+    T_IncrementalSortPath,
     T_GroupPath,
     T_UpperUniquePath,
     T_AggPath,
@@ -302,6 +302,8 @@ typedef struct Append
     List       *appendplans;
 #ifdef __OPENTENBASE__
     bool       interval;
+    /* info for run-time pruning of subplans, or NULL */
+    struct PartitionPruneInfo *part_prune_info;
 #endif
 } Append;
 
@@ -324,6 +326,8 @@ typedef struct MergeAppend
     bool       *nullsFirst;        /* NULLS FIRST/LAST directions */
 #ifdef __OPENTENBASE__
     bool       interval;
+    /* info for run-time pruning of subplans, or NULL */
+    struct PartitionPruneInfo *part_prune_info;
 #endif
 } MergeAppend;
 
@@ -389,6 +393,15 @@ typedef struct Scan
     bool        ispartchild;
     int         childidx;
 #endif
+#ifdef _MLS_
+    /*
+     * Attributes read above the scan (targetlist and quals), as offsets from
+     * FirstLowInvalidHeapAttributeNumber.  Crypted columns not in the set are
+     * not decrypted.  Only valid when crypt_attrs_pruned is true.
+     */
+    bool        crypt_attrs_pruned;
+    Bitmapset  *crypt_attrs;
+#endif
 } Scan;
 
 /* ----------------
@@ -814,6 +827,20 @@ typedef struct Sort
     bool       *nullsFirst;        /* NULLS FIRST/LAST directions */
 } Sort;
 
+/* ----------------
+ *        incremental sort node
+ *
+ * The input is already sorted by the first nPresortedCols sort columns, so
+ * only the tuples of each run of equal values of these columns need to be
+ * sorted together.
+ * ----------------
+ */
+typedef struct IncrementalSort
+{
+    Sort        sort;
+    int            nPresortedCols;    /* number of presorted sort columns */
+} IncrementalSort;
+
 /* ---------------
  *     group node -
  *        Used for queries with GROUP BY (but no aggregates) specified.
@@ -1108,6 +1135,35 @@ typedef struct PlanInvalItem
     uint32        hashValue;        /* hash value of object's cache lookup key */
 } PlanInvalItem;
 
+#ifdef __OPENTENBASE__
+/*
+ * PartitionPruneInfo - how to prune the subplans of an Append or MergeAppend
+ * over a partitioned table once the values of the Params compared to its
+ * partition key are known, see execPartition.c.
+ *
+ * An interval partitioned table is pruned by evaluating prune_quals, its
+ * quals on the partition key, the way the planner does with constants.  Any
+ * other partitioned table is pruned with pruning_steps, as generated by
+ * gen_partprune_steps.  Either way we get the indexes of the partitions
+ * which may hold matching rows, and subplan_parts gives the partition index
+ * scanned by each subplan, or -1 if the subplan can not be pruned.
+ *
+ * Pruning depends on PARAM_EXEC Params if execparamids is not empty, and is
+ * then redone whenever they change; otherwise it is done once, at executor
+ * startup, and the pruned subplans are not even initialized.
+ */
+typedef struct PartitionPruneInfo
+{
+    NodeTag        type;
+    Index        rtindex;        /* RT index of the partitioned table */
+    bool        interval;        /* is it interval partitioned? */
+    List       *prune_quals;    /* quals on the interval partition key */
+    List       *pruning_steps;    /* List of PartitionPruneStep */
+    List       *subplan_parts;    /* partition index of each subplan */
+    Bitmapset  *execparamids;    /* PARAM_EXEC Params used in pruning */
+} PartitionPruneInfo;
+#endif
+
 extern bool plantree_walker(Plan *plan,
                             List *top_subplans,
                             bool (*walker) (),
@@ -1615,6 +1615,16 @@ typedef struct SortPath
     Path       *subpath;        /* path representing input source */
 } SortPath;
 
+/*
+ * IncrementalSortPath represents a sort step over an input that is already
+ * sorted by a leading part of the pathkeys
+ */
+typedef struct IncrementalSortPath
+{
+    SortPath    spath;
+    int            nPresortedCols;    /* number of presorted pathkeys */
+} IncrementalSortPath;
+
 /*
  * GroupPath represents grouping (of presorted input)
  *
@@ -73,6 +73,7 @@ extern bool enable_indexonlyscan;
 extern bool enable_bitmapscan;
 extern bool enable_tidscan;
 extern bool enable_sort;
+extern bool enable_incrementalsort;
 extern bool enable_hashagg;
 extern bool enable_nestloop;
 extern bool enable_material;
@@ -81,6 +82,10 @@ extern bool enable_hashjoin;
 extern bool enable_fast_query_shipping;
 extern bool enable_gathermerge;
 extern bool enable_partition_wise_join;
+#ifdef __OPENTENBASE__
+extern bool enable_partition_wise_aggregate;
+extern bool enable_runtime_partition_pruning;
+#endif
 extern bool enable_nestloop_suppression;
 extern int	constraint_exclusion;
 
@@ -123,6 +128,11 @@ extern void cost_sort(Path *path, PlannerInfo *root,
 		  List *pathkeys, Cost input_cost, double tuples, int width,
 		  Cost comparison_cost, int sort_mem,
 		  double limit_tuples);
+extern void cost_incremental_sort(Path *path, PlannerInfo *root,
+					  List *pathkeys, int presorted_keys,
+					  Cost input_startup_cost, Cost input_total_cost,
+					  double input_tuples, int width, Cost comparison_cost,
+					  int sort_mem, double limit_tuples);
 extern void cost_merge_append(Path *path, PlannerInfo *root,
 				  List *pathkeys, int n_streams,
 				  Cost input_startup_cost, Cost input_total_cost,
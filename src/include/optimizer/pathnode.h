@@ -176,6 +176,12 @@ extern SortPath *create_sort_path(PlannerInfo *root,
                   Path *subpath,
                   List *pathkeys,
                   double limit_tuples);
+extern IncrementalSortPath *create_incremental_sort_path(PlannerInfo *root,
+                             RelOptInfo *rel,
+                             Path *subpath,
+                             List *pathkeys,
+                             int presorted_keys,
+                             double limit_tuples);
 extern GroupPath *create_group_path(PlannerInfo *root,
                   RelOptInfo *rel,
                   Path *subpath,
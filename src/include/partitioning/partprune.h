@@ -15,6 +15,7 @@
 #define PARTPRUNE_H
 
 #include "catalog/partition.h"
+#include "nodes/plannodes.h"
 #include "nodes/relation.h"
 
 /*
@@ -37,13 +38,34 @@ typedef struct PartitionPruneContext
 
 	/* Partition boundary info */
 	PartitionBoundInfo boundinfo;
+
+#ifdef __OPENTENBASE__
+	/*
+	 * When pruning at run time, the states to evaluate the expressions of the
+	 * steps that are not Consts, indexed by PruneCxtStateIdx; NULL when
+	 * pruning at plan time.
+	 */
+	struct ExprState **exprstates;
+	struct ExprContext *exprcontext;
+#endif
 } PartitionPruneContext;
 
+#ifdef __OPENTENBASE__
+#define PruneCxtStateIdx(partnatts, step_id, keyno) \
+	((partnatts) * (step_id) + (keyno))
+#endif
+
 
 extern Relids prune_append_rel_partitions(RelOptInfo *rel);
 extern Bitmapset *get_matching_partitions(PartitionPruneContext *context,
 						List *pruning_steps);
 extern List *gen_partprune_steps(RelOptInfo *rel, List *clauses,
 					bool *contradictory);
+#ifdef __OPENTENBASE__
+extern PartitionPruneInfo *make_partition_pruneinfo(PlannerInfo *root,
+						 RelOptInfo *rel, List *subpaths, List *prunequal);
+extern PartitionPruneInfo *make_interval_pruneinfo(RelOptInfo *rel,
+						AttrNumber partkey, List *subplans, List *prunequal);
+#endif
 
 #endif							/* PARTPRUNE_H */
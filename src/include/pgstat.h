@@ -788,7 +788,8 @@ typedef enum
 #ifdef __AUDIT_FGA__
     WAIT_EVENT_AUDIT_FGA_MAIN,
 #endif
-	WAIT_EVENT_CLUSTER_MONITOR_MAIN
+	WAIT_EVENT_CLUSTER_MONITOR_MAIN,
+	WAIT_EVENT_INTERVAL_PARTITION_MAIN
 } WaitEventActivity;
 
 /* ----------
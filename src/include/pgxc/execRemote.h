@@ -134,6 +134,7 @@ typedef struct ResponseCombiner
     char       *errorMessage;            /* error message to send back to client */
     char       *errorDetail;            /* error detail to send back to client */
     char       *errorHint;                /* error hint to send back to client */
+    char       *errorContext;            /* error context reported by the node */
     Oid            returning_node;            /* returning replicated node */
     RemoteDataRow currentRow;            /* next data ro to be wrapped into a tuple */
     /* TODO use a tuplestore as a rowbuffer */
@@ -266,6 +267,8 @@ typedef struct RemoteSubplanState
     bool        finish_init;
     int32       eflags;                       /* estate flag. */
     ParallelWorkerStatus *parallel_status; /* Shared storage for parallel worker. */
+    StringInfo  runtime_filter;         /* serialized bloom filter of the parent
+                                         * hash join, sent with Bind */
 #endif
 } RemoteSubplanState;
 
@@ -447,6 +450,8 @@ extern TupleDesc create_tuple_desc(char *msg_body, size_t len);
 
 extern void ExecFinishRemoteSubplan(RemoteSubplanState *node);
 extern void ExecShutdownRemoteSubplan(RemoteSubplanState *node);
+extern void ExecRemoteSubplanSetRuntimeFilter(RemoteSubplanState *node,
+                                  struct RuntimeFilter *filter);
 extern bool SetSnapshot(EState *state);
 
 extern void ExecRemoteUtility_ParallelDDLMode(RemoteQuery *node,
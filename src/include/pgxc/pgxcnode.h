@@ -219,13 +219,16 @@ extern int	pgxc_node_send_my_sync(PGXCNodeHandle * handle);
 
 #ifdef __SUBSCRIPTION__
 extern int pgxc_node_send_apply(PGXCNodeHandle * handle, char * buf, int len, bool ignore_pk_conflict);
+extern int pgxc_node_send_apply_batch(PGXCNodeHandle * handle, char * buf, int len,
+                                      int nchanges, bool ignore_pk_conflict);
 #endif
 #ifdef __OPENTENBASE__
 extern int pgxc_node_send_disconnect(PGXCNodeHandle * handle, char *cursor, int cons);
 #endif
 extern int	pgxc_node_send_bind(PGXCNodeHandle * handle, const char *portal,
 								const char *statement, int paramlen, const char *params,
-								int eqpctxlen, const char *epqctx, StringInfo shardmap);
+								int eqpctxlen, const char *epqctx, StringInfo shardmap,
+								StringInfo rfilter);
 extern int	pgxc_node_send_parse(PGXCNodeHandle * handle, const char* statement,
 								 const char *query, short num_params, Oid *param_types);
 extern int	pgxc_node_send_flush(PGXCNodeHandle * handle);
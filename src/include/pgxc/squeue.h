@@ -182,6 +182,10 @@ extern void WaitForParallelWorkerDone(int numParallelWorkers, bool launch_failed
 
 extern int GetConsumerIdx(SharedQueue sq, int nodeid);
 
+extern void SharedQueueSetRuntimeFilter(SharedQueue sq, int consumerIdx, dsm_handle handle);
+
+extern dsm_handle SharedQueueGetRuntimeFilter(SharedQueue sq, int consumerIdx);
+
 extern void ParallelSendEreport(void);
 
 extern void ParallelDsmDetach(void);
@@ -22,6 +22,9 @@
 /* size_rotation_for = AUDIT_COMMON_LOG | AUDIT_FGA_LOG | MAINTAIN_TRACE_LOG */
 #define 					MAINTAIN_TRACE_LOG      (1 << 2)
 
+/* max number of writers, each owns a shard of the common audit log file */
+#define 					AUDIT_MAX_COMMON_WRITER	8
+
 extern int                    AuditLog_RotationAge;
 extern int                    AuditLog_RotationSize;
 extern PGDLLIMPORT char *    AuditLog_filename;
@@ -29,6 +32,7 @@ extern bool                 AuditLog_truncate_on_rotation;
 extern int                    AuditLog_file_mode;
 
 extern int					AuditLog_max_worker_number;
+extern int					AuditLog_common_log_writer_number;
 extern int					AuditLog_common_log_queue_size_kb;
 extern int					AuditLog_fga_log_queue_size_kb;
 extern int					Maintain_trace_log_queue_size_kb;
@@ -16,6 +16,8 @@
 #ifndef CLUSTERMON_H
 #define CLUSTERMON_H
 
+#include "datatype/timestamp.h"
+#include "port/atomics.h"
 #include "storage/s_lock.h"
 #include "gtm/gtm_c.h"
 
@@ -24,9 +26,28 @@ typedef struct
     slock_t                mutex;
     GlobalTransactionId    reported_recent_global_xmin;
     GlobalTransactionId    reporting_recent_global_xmin;
-    GlobalTransactionId    gtm_recent_global_xmin;
+
+    /*
+     * Global xmin received from GTM.  Read without the mutex by every
+     * snapshot, so it is kept in an atomic and written after the consistency
+     * checks in ClusterMonitorSetGlobalXmin.
+     */
+    pg_atomic_uint32    gtm_recent_global_xmin;
+
+    /* xmin lag accounting, protected by mutex */
+    GlobalTransactionId    local_xmin;            /* last computed local xmin */
+    TimestampTz            last_report_time;    /* last successful report */
+    TimestampTz            last_advance_time;    /* last advance of global xmin */
+    int64                report_count;
+    int64                advance_count;
 } ClusterMonitorCtlData;
 
+/*
+ * Report the local xmin as soon as it advanced by this many xids, instead of
+ * waiting for the next naptime.  0 means report on naptime only.
+ */
+extern int    global_xmin_report_threshold;
+
 extern void ClusterMonitorShmemInit(void);
 extern Size ClusterMonitorShmemSize(void);
 
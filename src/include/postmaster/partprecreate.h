@@ -0,0 +1,28 @@
+/*--------------------------------------------------------------------
+ * partprecreate.h
+ * Background creation of the upcoming partitions of interval
+ * partitioned tables.
+ *
+ *
+ * Copyright (c) 2023 THL A29 Limited, a Tencent company.
+ *
+ * This source code file is licensed under the BSD 3-Clause License,
+ * you may obtain a copy of the License at http://opensource.org/license/bsd-3-clause/
+ *
+ * IDENTIFICATION
+ *		src/include/postmaster/partprecreate.h
+ *--------------------------------------------------------------------
+ */
+#ifndef PARTPRECREATE_H
+#define PARTPRECREATE_H
+
+extern int interval_partition_precreate;
+extern int interval_partition_precreate_naptime;
+extern char *interval_partition_precreate_role;
+
+extern void IntervalPartitionLauncherRegister(void);
+
+extern void IntervalPartitionLauncherMain(Datum main_arg) pg_attribute_noreturn();
+extern void IntervalPartitionWorkerMain(Datum main_arg) pg_attribute_noreturn();
+
+#endif /* PARTPRECREATE_H */
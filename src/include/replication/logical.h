@@ -48,6 +48,12 @@ typedef struct LogicalDecodingContext
     OutputPluginCallbacks callbacks;
     OutputPluginOptions options;
 
+    /*
+     * Does the output plugin support streaming of in-progress transactions,
+     * and is it enabled? The plugin may disable it in its startup callback.
+     */
+    bool        streaming;
+
     /*
      * User specified options
      */
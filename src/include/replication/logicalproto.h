@@ -28,7 +28,8 @@
  * connect time.
  */
 #define LOGICALREP_PROTO_MIN_VERSION_NUM 1
-#define LOGICALREP_PROTO_VERSION_NUM 1
+#define LOGICALREP_PROTO_STREAM_VERSION_NUM 2
+#define LOGICALREP_PROTO_VERSION_NUM 2
 
 /* Tuple coming via logical replication. */
 typedef struct LogicalRepTupleData
@@ -93,6 +94,22 @@ extern void logicalrep_read_commit(StringInfo in,
 extern void logicalrep_write_origin(StringInfo out, const char *origin,
                         XLogRecPtr origin_lsn);
 extern char *logicalrep_read_origin(StringInfo in, XLogRecPtr *origin_lsn);
+extern void logicalrep_write_stream_start(StringInfo out, TransactionId xid,
+                              bool first_segment);
+extern TransactionId logicalrep_read_stream_start(StringInfo in,
+                             bool *first_segment);
+extern void logicalrep_write_stream_stop(StringInfo out);
+extern void logicalrep_write_stream_subxact(StringInfo out,
+                                TransactionId subxid);
+extern TransactionId logicalrep_read_stream_subxact(StringInfo in);
+extern void logicalrep_write_stream_abort(StringInfo out, TransactionId xid,
+                              TransactionId subxid);
+extern void logicalrep_read_stream_abort(StringInfo in, TransactionId *xid,
+                             TransactionId *subxid);
+extern void logicalrep_write_stream_commit(StringInfo out,
+                               ReorderBufferTXN *txn, XLogRecPtr commit_lsn);
+extern TransactionId logicalrep_read_stream_commit(StringInfo in,
+                              LogicalRepCommitData *commit_data);
 extern void logicalrep_write_insert(StringInfo out, Relation rel,
 #ifdef __SUBSCRIPTION__
                         int32 tuple_hash,
@@ -139,6 +156,7 @@ extern int32 logicalrep_dml_get_hashmod(void);
 extern int32 logicalrep_dml_get_hashvalue(void);
 extern bool  logicalrep_dml_get_send_all(void);
 extern int32 logicalrep_dml_calc_hash(Relation rel, HeapTuple tuple);
+extern int32 logicalrep_read_dml_hash(StringInfo in);
 extern void	logicalrep_relation_free(LogicalRepRelation * rel);
 #endif
 
@@ -12,6 +12,12 @@
 #ifndef LOGICALWORKER_H
 #define LOGICALWORKER_H
 
+#ifdef __SUBSCRIPTION__
+extern bool logical_apply_fanout;
+extern int    logical_apply_batch_size;
+#endif
+extern bool logical_apply_streaming;
+
 extern void ApplyWorkerMain(Datum main_arg);
 
 extern bool IsLogicalWorker(void);
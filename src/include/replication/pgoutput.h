@@ -22,6 +22,7 @@ typedef struct PGOutputData
 
     /* client info */
     uint32        protocol_version;
+    bool        streaming;        /* stream in-progress transactions? */
 
     List       *publication_names;
     List       *publications;
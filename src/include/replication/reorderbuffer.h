@@ -20,6 +20,8 @@
 #include "utils/snapshot.h"
 #include "utils/timestamp.h"
 
+extern PGDLLIMPORT int logical_decoding_work_mem;
+
 /* an individual tuple, stored in one chunk of memory */
 typedef struct ReorderBufferTupleBuf
 {
@@ -79,6 +81,9 @@ typedef struct ReorderBufferChange
     /* The type of change. */
     enum ReorderBufferChangeType action;
 
+    /* Transaction this change belongs to. */
+    struct ReorderBufferTXN *txn;
+
     RepOriginId origin_id;
 
     /*
@@ -155,6 +160,17 @@ typedef struct ReorderBufferTXN
      */
     bool        is_known_as_subxact;
 
+    /*
+     * Toplevel transaction of a known subxact, NULL otherwise.
+     */
+    struct ReorderBufferTXN *toptxn;
+
+    /*
+     * Have changes of this transaction already been streamed to the output
+     * plugin, before its commit?
+     */
+    bool        streamed;
+
     /*
      * LSN of the first data carrying, WAL record with knowledge about this
      * xid. This is allowed to *not* be first record adorned with this xid, if
@@ -230,6 +246,11 @@ typedef struct ReorderBufferTXN
      */
     dlist_head    changes;
 
+    /*
+     * Size of the changes above held in memory, in bytes.
+     */
+    Size        size;
+
     /*
      * List of (relation, ctid) => (cmin, cmax) mappings for catalog tuples.
      * Those are always assigned to the toplevel transaction. (Keep track of
@@ -249,6 +270,15 @@ typedef struct ReorderBufferTXN
      */
     HTAB       *toast_hash;
 
+    /*
+     * State a streamed transaction resumes from at its next run: the snapshot
+     * and command id the last run ended with, and a speculative insertion
+     * whose confirmation has not been streamed yet.
+     */
+    Snapshot    snapshot_now;
+    CommandId    command_id;
+    struct ReorderBufferChange *specinsert;
+
     /*
      * non-hierarchical list of subtransactions that are *not* aborted. Only
      * used in toplevel transactions.
@@ -304,6 +334,30 @@ typedef void (*ReorderBufferMessageCB) (
                                         const char *prefix, Size sz,
                                         const char *message);
 
+/* start streaming transaction callback signature */
+typedef void (*ReorderBufferStreamStartCB) (
+                                            ReorderBuffer *rb,
+                                            ReorderBufferTXN *txn,
+                                            XLogRecPtr first_lsn);
+
+/* stop streaming transaction callback signature */
+typedef void (*ReorderBufferStreamStopCB) (
+                                           ReorderBuffer *rb,
+                                           ReorderBufferTXN *txn,
+                                           XLogRecPtr last_lsn);
+
+/* discard streamed transaction callback signature */
+typedef void (*ReorderBufferStreamAbortCB) (
+                                            ReorderBuffer *rb,
+                                            ReorderBufferTXN *txn,
+                                            XLogRecPtr abort_lsn);
+
+/* commit streamed transaction callback signature */
+typedef void (*ReorderBufferStreamCommitCB) (
+                                             ReorderBuffer *rb,
+                                             ReorderBufferTXN *txn,
+                                             XLogRecPtr commit_lsn);
+
 struct ReorderBuffer
 {
     /*
@@ -332,6 +386,17 @@ struct ReorderBuffer
     ReorderBufferCommitCB commit;
     ReorderBufferMessageCB message;
 
+    /*
+     * Callbacks to be called when streaming a transaction before its commit,
+     * and at its end.
+     */
+    ReorderBufferStreamStartCB stream_start;
+    ReorderBufferStreamStopCB stream_stop;
+    ReorderBufferApplyChangeCB stream_change;
+    ReorderBufferMessageCB stream_message;
+    ReorderBufferStreamAbortCB stream_abort;
+    ReorderBufferStreamCommitCB stream_commit;
+
     /*
      * Pointer that will be passed untouched to the callbacks.
      */
@@ -367,6 +432,9 @@ struct ReorderBuffer
     /* buffer for disk<->memory conversions */
     char       *outbuf;
     Size        outbufsize;
+
+    /* total size of the changes held in memory, in bytes */
+    Size        size;
 };
 
 
@@ -376,7 +444,7 @@ void        ReorderBufferFree(ReorderBuffer *);
 ReorderBufferTupleBuf *ReorderBufferGetTupleBuf(ReorderBuffer *, Size tuple_len);
 void        ReorderBufferReturnTupleBuf(ReorderBuffer *, ReorderBufferTupleBuf *tuple);
 ReorderBufferChange *ReorderBufferGetChange(ReorderBuffer *);
-void        ReorderBufferReturnChange(ReorderBuffer *, ReorderBufferChange *);
+void        ReorderBufferReturnChange(ReorderBuffer *, ReorderBufferChange *, bool upd_mem);
 
 void        ReorderBufferQueueChange(ReorderBuffer *, TransactionId, XLogRecPtr lsn, ReorderBufferChange *);
 void ReorderBufferQueueMessage(ReorderBuffer *, TransactionId, Snapshot snapshot, XLogRecPtr lsn,
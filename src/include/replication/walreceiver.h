@@ -157,6 +157,7 @@ typedef struct
         {
             uint32        proto_version;    /* Logical protocol version */
             List       *publication_names;    /* String list of publications */
+            bool        streaming;    /* Stream in-progress transactions */
         }            logical;
     }            proto;
 } WalRcvStreamOptions;
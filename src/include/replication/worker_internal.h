@@ -21,6 +21,9 @@
 #include "catalog/pg_subscription.h"
 #include "datatype/timestamp.h"
 #include "storage/lock.h"
+#ifdef __SUBSCRIPTION__
+#include "storage/dsm.h"
+#endif
 
 typedef struct LogicalRepWorker
 {
@@ -57,6 +60,15 @@ typedef struct LogicalRepWorker
     TimestampTz last_recv_time;
     XLogRecPtr    reply_lsn;
     TimestampTz reply_time;
+
+#ifdef __SUBSCRIPTION__
+    /*
+     * Segment of the queues to the other workers of a parallel OpenTenBase
+     * subscription, when this worker receives for them, protected by
+     * relmutex.
+     */
+    dsm_handle    fanout_handle;
+#endif
 } LogicalRepWorker;
 
 /* Main memory context for apply worker. Permanent during worker lifetime. */
@@ -100,6 +112,7 @@ extern bool am_opentenbase_subscript_dispatch_worker(void);
 extern bool IsColdMoveOpenTenBaseSubscription(void);
 extern bool IsClusterSyncOpenTenBaseSubscription(void);
 extern void logical_apply_dispatch(StringInfo s);
+extern void logical_apply_dispatch_batch(StringInfo s);
 #endif
 
 #endif                            /* WORKER_INTERNAL_H */
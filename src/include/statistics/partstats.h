@@ -0,0 +1,30 @@
+/*-------------------------------------------------------------------------
+ *
+ * partstats.h
+ *      Statistics of interval partitioned tables merged from those of their
+ *      partitions.
+ *
+ * This source code file contains modifications made by THL A29 Limited ("Tencent Modifications").
+ * All Tencent Modifications are Copyright (C) 2023 THL A29 Limited.
+ *
+ * src/include/statistics/partstats.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef PARTSTATS_H
+#define PARTSTATS_H
+
+#include "commands/vacuum.h"
+#include "utils/relcache.h"
+
+/* register width of the NDV sketch of a partition's column, 2^10 registers */
+#define PART_NDV_SKETCH_WIDTH    10
+
+extern void build_part_ndv_sketch(VacAttrStats *stats,
+                      AnalyzeAttrFetchFunc fetchfunc, int samplerows);
+extern bool merge_part_stats(Relation onerel, int attr_cnt,
+                 VacAttrStats **vacattrstats,
+                 double *totalrows, double *totaldeadrows);
+extern bool part_stats_stale(Oid partoid);
+
+#endif                            /* PARTSTATS_H */
@@ -24,6 +24,8 @@
 
 #define EXTENT_SAVED_MINCAT 5
 #define MAX_FREESPACE 254
+/* most extents added to a shard by one relation extension */
+#define MAX_EXTENTS_PER_EXTEND 4
 
 typedef enum EmaPageType
 {
@@ -485,12 +487,15 @@ extern ExtentID extent_extend_for_rebuild(Relation rel, ExtentID eid);
  */
 extern ExtentID GetExtentWithFreeSpace(Relation rel, ShardID sid, uint8 min_cat);
 extern void        ExtendExtentForShard(Relation rel, ShardID sid, ExtentID eid, uint8 freespace, bool for_rebuild);
+extern int        ExtendExtentsForShard(Relation rel, ShardID sid, ExtentID eid, int nextents);
 extern void        ExtendExtentForRebuild(Relation rel, ExtentID eid);
 extern void        FreeExtent(Relation rel, ExtentID eid);
 extern void     MarkExtentFull(Relation rel, ExtentID eid);
 extern void     MarkExtentAvailable(Relation rel, ExtentID eid);
 extern ExtentID    GetShardScanHead(Relation re, ShardID sid);
 extern ExtentID RelOidGetShardScanHead(Oid reloid, ShardID sid);
+extern ExtentID *GetShardScanExtents(Relation rel, Bitmapset *shards,
+                                    BlockNumber nblocks, int *nextents);
 extern void     TruncateExtentMap(Relation rel, BlockNumber nblocks);
 extern void       RebuildExtentMap(Relation rel);
 
@@ -219,6 +219,7 @@ typedef enum BuiltinTrancheIds
     LWTRANCHE_BUFFER_IO_IN_PROGRESS,
 #ifdef _MLS_
     LWTRANCHE_REL_CRYPT_LOCK,
+    LWTRANCHE_REL_CRYPT_PAGE_CACHE,
 #endif
     LWTRANCHE_REPLICATION_ORIGIN,
     LWTRANCHE_REPLICATION_SLOT_IO_IN_PROGRESS,
@@ -0,0 +1,42 @@
+/*-------------------------------------------------------------------------
+ *
+ * relcryptpagecache.h
+ *    shared cache of decrypted pages of crypted relations
+ *
+ * Copyright (c) 2023 THL A29 Limited, a Tencent company.
+ *
+ * This source code file is licensed under the BSD 3-Clause License,
+ * you may obtain a copy of the License at http://opensource.org/license/bsd-3-clause/
+ *
+ * src/include/storage/relcryptpagecache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef RELCRYPT_PAGE_CACHE_H
+#define RELCRYPT_PAGE_CACHE_H
+
+#include "storage/block.h"
+#include "storage/relfilenode.h"
+#include "storage/smgr.h"
+#include "utils/relcrypt.h"
+
+/* number of pages in the cache, 0 disables it */
+extern int g_rel_crypt_page_cache_size;
+
+extern Size rel_crypt_page_cache_shmem_size(void);
+extern void rel_crypt_page_cache_init(void);
+
+extern bool rel_crypt_page_cache_read(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char *buffer);
+extern void rel_crypt_page_cache_insert(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char *page);
+extern void rel_crypt_page_cache_invalidate(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum);
+extern void rel_crypt_page_cache_drop(SMgrRelation reln, ForkNumber forknum, BlockNumber firstDelBlock);
+extern void rel_crypt_page_cache_drop_rnode(RelFileNode *rnode);
+extern void rel_crypt_page_cache_drop_database(Oid dbid);
+
+#define REL_CRYPT_PAGE_CACHE_ENABLED() (g_rel_crypt_page_cache_size > 0)
+
+/* only the forks which are crypted on disk go through the cache */
+#define REL_CRYPT_PAGE_CACHE_FORK(_forknum) \
+    (MAIN_FORKNUM == (_forknum) || EXTENT_FORKNUM == (_forknum))
+
+#endif                            /* RELCRYPT_PAGE_CACHE_H */
@@ -16,6 +16,7 @@
 
 extern void rel_crypt_struct_init(RelCrypt relcrypt);
 extern void rel_crypt_page_decrypt(RelCrypt relcrypt, Page page);
+extern void rel_crypt_pages_decrypt(RelCrypt relcrypt, Page *pages, int npages);
 extern Page rel_crypt_page_encrypt(RelCrypt relcrypt, Page page);
 extern bool rel_crypt_hash_lookup(RelFileNode * rnode, RelCrypt relcrypt_ret);
 
@@ -78,6 +78,7 @@ typedef struct SMgrRelationData
     //int            smgr_shard_tb_lasthit;
     BlockNumber smgr_shard_targblocks[SMGR_TARGBLOCK_MAX_SHARDS];    
     BlockNumber smgr_ema_nblocks;
+    BlockNumber smgr_eob_hint;    /* EOB page to start free extent search at */
     bool        smgr_hasextent;
 #endif
     BlockNumber smgr_vm_nblocks;    /* last known size of vm fork */
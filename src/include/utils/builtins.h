@@ -191,6 +191,9 @@ extern Datum pg_get_current_database_oid(PG_FUNCTION_ARGS);
 extern Datum pg_trsprt_crypt_support_datatype(PG_FUNCTION_ARGS);
 extern Datum pg_rel_crypt_hash_dump(PG_FUNCTION_ARGS);
 extern Datum pg_crypt_key_hash_dump(PG_FUNCTION_ARGS);
+extern Datum pg_rel_crypt_page_bench(PG_FUNCTION_ARGS);
+extern Datum pg_rel_crypt_sm4_selftest(PG_FUNCTION_ARGS);
+extern Datum pg_rel_crypt_page_cache_stats(PG_FUNCTION_ARGS);
 
 
 #endif                            /* BUILTINS_H */
@@ -317,6 +317,7 @@ extern bool g_allow_dml_on_datanode;
 extern bool g_allow_force_ddl;
 extern bool g_snapshot_for_analyze;
 extern bool trace_extent;
+extern bool enable_shard_pruned_scan;
 #endif
 
 #ifdef __OPENTENBASE__
@@ -209,6 +209,8 @@ typedef struct PortalData
 	
 	/* information about EvalPlanQual, pass it to queryDesc */
 	RemoteEPQContext *epqContext;
+	/* bloom filter of the consumer's hash join, applied to the result */
+	struct RuntimeFilter *runtimeFilter;
 	int			up_instrument;	/* explain analyze option from cn */
 #endif
 }            PortalData;
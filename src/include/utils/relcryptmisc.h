@@ -13,6 +13,8 @@ extern bool trsprt_crypt_chk_tbl_col_has_crypt(Oid relid, int attnum);
 extern text * encrypt_procedure(AlgoId algo_id, text * text_src, char * page_new_output);
 extern text * decrypt_procedure(AlgoId algo_id, text * text_src, int context_length);
 extern int rel_crypt_page_encrypting_parellel(int16 algo_id, char * page, char * buf_need_encrypt, char * page_new, CryptKeyInfo cryptkey, int workerid);
+extern void rel_crypt_pages_encrypting_parellel(int16 algo_id, char ** pages, char * buf_need_encrypt, char ** page_news, 
+                                                int * rets, int npages, CryptKeyInfo cryptkey, int workerid);
 extern void rel_crypt_init(void);
 extern Datum trsprt_crypt_decrypt_one_col_value(TranspCrypt*transp_crypt, Form_pg_attribute attr, Datum inputval);
 extern bool trsprt_crypt_chk_tbl_has_col_crypt(Oid relid);
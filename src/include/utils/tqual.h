@@ -101,6 +101,11 @@ extern bool HeapTupleIsSurelyDead(HeapTuple htup,
 extern void HeapTupleSetHintBits(HeapTupleHeader tuple, Buffer buffer,
                      uint16 infomask, TransactionId xid);
 extern bool HeapTupleHeaderIsOnlyLocked(HeapTupleHeader tuple);
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+extern void HeapTupleHintBatchBegin(Buffer buffer);
+extern void HeapTupleHintBatchEnd(void);
+extern void AtAbort_HeapTupleHintBatch(void);
+#endif
 /*
 #ifdef _MIGRATE_
 extern bool HeapTupleSatisfiesNow(HeapTupleHeader tuple,
@@ -65,6 +65,15 @@ typedef struct TuplesortInstrumentation
 	long		spaceUsed;		/* space consumption, in kB */
 } TuplesortInstrumentation;
 
+#ifdef __OPENTENBASE__
+/*
+ * Source of the sorted streams merged by tuplesort_begin_index_merge: returns
+ * the next tuple of the given stream, or NULL once it is exhausted.  The
+ * tuple only has to stay valid until the next call.
+ */
+typedef IndexTuple (*TuplesortIndexStream) (void *arg, int stream);
+#endif
+
 
 /*
  * We provide multiple interfaces to what is essentially the same code,
@@ -91,6 +100,10 @@ typedef struct TuplesortInstrumentation
  *
  * The "index_hash" API is similar to index_btree, but the tuples are
  * actually sorted by their hash codes not the raw data.
+ *
+ * The "index_merge" API returns, in index_btree order, the merge of streams
+ * of IndexTuples that are each already in that order, typically the output
+ * of index_btree sorts run by several processes.
  */
 
 extern Tuplesortstate *tuplesort_begin_heap(TupleDesc tupDesc,
@@ -122,6 +135,15 @@ extern Tuplesortstate *tuplesort_begin_merge(TupleDesc tupDesc,
 					 struct ResponseCombiner *combiner,
 					 int workMem);
 #endif
+#ifdef __OPENTENBASE__
+extern Tuplesortstate *tuplesort_begin_index_merge(Relation heapRel,
+							Relation indexRel,
+							bool enforceUnique,
+							int nstreams,
+							TuplesortIndexStream stream,
+							void *arg,
+							int workMem);
+#endif
 
 extern void tuplesort_set_bound(Tuplesortstate *state, int64 bound);
 
@@ -0,0 +1,2 @@
+-- Run as audit_admin.
+clean all audit;
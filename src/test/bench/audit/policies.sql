@@ -0,0 +1,10 @@
+--
+-- Run as audit_admin.  Policies of every kind, none of which hits a read
+-- of bench_audit_t1 by the benchmark user, so the workload pays for
+-- matching only, not for writing audit logs.
+--
+clean all audit;
+select format('audit all on bench_audit_t%s', g) from generate_series(2, 100) g \gexec
+audit all by bench_audit_user;
+audit all on default whenever not successful;
+audit all whenever not successful;
@@ -0,0 +1,35 @@
+#!/bin/sh
+#
+# Matching of statements against audit policies.
+#
+# usage: run.sh [seconds [clients]]
+#
+# Needs a superuser in PGUSER, the audit_admin user, and enable_audit = on
+# in the configuration of every node.  Each configuration runs once with
+# the compiled per-backend policy hash and once with
+# enable_audit_policy_cache = off, which scans the audit catalogs for every
+# statement as before.  Without any policy the compiled hash also skips
+# walking the query tree.
+
+set -e
+
+DURATION=${1:-30}
+CLIENTS=${2:-4}
+DIR=`dirname $0`
+
+psql -X -q -v ON_ERROR_STOP=1 -f $DIR/setup.sql
+
+for policies in clean policies
+do
+    psql -X -q -v ON_ERROR_STOP=1 -U audit_admin -f $DIR/$policies.sql > /dev/null
+
+    for cache in on off
+    do
+        echo "== $policies, enable_audit_policy_cache = $cache"
+        PGOPTIONS="-c enable_audit_policy_cache=$cache" \
+        pgbench -n -T $DURATION -c $CLIENTS -j $CLIENTS -f $DIR/select.sql \
+            | grep -E "^(latency average|tps)"
+    done
+done
+
+psql -X -q -v ON_ERROR_STOP=1 -U audit_admin -f $DIR/clean.sql > /dev/null
@@ -0,0 +1,3 @@
+-- a point read of a table without audit policies
+\set id random(1, 1000)
+select v from bench_audit_t1 where id = :id;
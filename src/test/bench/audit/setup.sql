@@ -0,0 +1,19 @@
+--
+-- 100 small tables, run.sh audits all but the first one, which the
+-- workload reads.
+--
+do $$
+declare
+    n    int;
+begin
+    for n in 1 .. 100 loop
+        execute format('drop table if exists bench_audit_t%s', n);
+        execute format('create table bench_audit_t%s (id int, v text) distribute by shard(id)', n);
+    end loop;
+
+    insert into bench_audit_t1 select g, md5(g::text) from generate_series(1, 1000) g;
+end;
+$$;
+
+drop user if exists bench_audit_user;
+create user bench_audit_user;
@@ -0,0 +1,7 @@
+--
+-- Run as an mls user, the crypt policy can only be bound to an empty table.
+--
+select MLS_TRANSPARENT_CRYPT_CREATE_ALGORITHM('SM4', '0123456789abcdef') as bench_algo \gset
+
+select MLS_TRANSPARENT_CRYPT_ALGORITHM_BIND_TABLE('public', 'bench_crypt_scan_crypt', 't' || n, :bench_algo)
+    from generate_series(1, 36) n;
@@ -0,0 +1,3 @@
+-- no crypted column at all
+\set lo random(0, 990)
+select count(*) from :table where i1 between :lo and :lo + 9;
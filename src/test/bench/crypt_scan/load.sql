@@ -0,0 +1,3 @@
+insert into bench_crypt_scan_crypt select * from bench_crypt_scan_plain;
+vacuum analyze bench_crypt_scan_plain;
+vacuum analyze bench_crypt_scan_crypt;
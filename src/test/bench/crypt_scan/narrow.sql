@@ -0,0 +1,3 @@
+-- one plain and one crypted column of a slice of the table
+\set lo random(0, 990)
+select count(*), max(t1) from :table where i1 between :lo and :lo + 9;
@@ -0,0 +1,32 @@
+#!/bin/sh
+#
+# Scans of a wide table with transparent column crypt.
+#
+# usage: run.sh [seconds [clients]]
+#
+# Needs a superuser in PGUSER, the opentenbase_mls extension, and the
+# mls_admin user for binding the crypt policy.  With column crypt only the
+# crypted columns a scan reads are decrypted, so narrow.sql and count.sql
+# on the crypted table should come close to the plain table, while
+# wide.sql pays for all 36 columns.
+
+set -e
+
+DURATION=${1:-30}
+CLIENTS=${2:-4}
+DIR=`dirname $0`
+
+psql -X -q -v ON_ERROR_STOP=1 -c "create extension if not exists opentenbase_mls"
+psql -X -q -v ON_ERROR_STOP=1 -f $DIR/setup.sql
+psql -X -q -v ON_ERROR_STOP=1 -U mls_admin -f $DIR/bind.sql > /dev/null
+psql -X -q -v ON_ERROR_STOP=1 -f $DIR/load.sql
+
+for script in count narrow wide
+do
+    for table in bench_crypt_scan_plain bench_crypt_scan_crypt
+    do
+        echo "== $script on $table"
+        pgbench -n -T $DURATION -c $CLIENTS -j $CLIENTS -D table=$table -f $DIR/$script.sql \
+            | grep -E "^(latency average|tps)"
+    done
+done
@@ -0,0 +1,25 @@
+--
+-- Two wide tables of the same contents, bench_crypt_scan_crypt gets the
+-- crypt policy bound to its text columns by run.sh.
+--
+-- 4 int columns, 36 text columns, 200000 rows.
+--
+drop table if exists bench_crypt_scan_plain;
+drop table if exists bench_crypt_scan_crypt;
+
+do $$
+declare
+    cols text := 'id int, i1 int, i2 int, i3 int';
+    vals text := 'g, g % 1000, g % 100, g % 10';
+    n    int;
+begin
+    for n in 1 .. 36 loop
+        cols := cols || format(', t%s text', n);
+        vals := vals || format(', md5((g + %s)::text)', n);
+    end loop;
+
+    execute format('create table bench_crypt_scan_plain (%s) distribute by shard(id)', cols);
+    execute format('create table bench_crypt_scan_crypt (%s) distribute by shard(id)', cols);
+    execute format('insert into bench_crypt_scan_plain select %s from generate_series(1, 200000) g', vals);
+end;
+$$;
@@ -0,0 +1,9 @@
+-- every crypted column, nothing can be skipped
+\set lo random(0, 990)
+select count(*), max(t1), max(t2), max(t3), max(t4), max(t5), max(t6),
+       max(t7), max(t8), max(t9), max(t10), max(t11), max(t12),
+       max(t13), max(t14), max(t15), max(t16), max(t17), max(t18),
+       max(t19), max(t20), max(t21), max(t22), max(t23), max(t24),
+       max(t25), max(t26), max(t27), max(t28), max(t29), max(t30),
+       max(t31), max(t32), max(t33), max(t34), max(t35), max(t36)
+    from :table where i1 between :lo and :lo + 9;
@@ -0,0 +1,22 @@
+--
+-- ANALYZE with the sample blocks read by parallel workers on the datanodes:
+-- every block of a small table is read once, so the statistics are exact.
+--
+set min_parallel_table_scan_size = 0;
+set max_parallel_maintenance_workers = 2;
+create table anp_t (a int, b int, c int) with (parallel_workers = 2) distribute by shard(a);
+insert into anp_t select i, i % 10, case when i % 2 = 0 then i end
+    from generate_series(1, 20000) i;
+analyze anp_t;
+select reltuples from pg_class where relname = 'anp_t';
+select attname, null_frac, n_distinct from pg_stats
+    where tablename = 'anp_t' order by attname;
+-- same statistics sampled without workers
+set max_parallel_maintenance_workers = 0;
+analyze anp_t;
+select reltuples from pg_class where relname = 'anp_t';
+select attname, null_frac, n_distinct from pg_stats
+    where tablename = 'anp_t' order by attname;
+reset min_parallel_table_scan_size;
+reset max_parallel_maintenance_workers;
+drop table anp_t;
@@ -0,0 +1,54 @@
+--
+-- Audit policies are compiled into a per-backend hash, see audit.c.
+-- Matching through it must give the same answer as scanning the audit
+-- catalogs, for audit on success and on failure, and must follow every
+-- change of the configuration made in the same session.
+--
+select current_user as regress_user \gset
+set client_min_messages = warning;
+drop database if exists acache_database;
+drop user if exists acache_user;
+create user acache_user login;
+create database acache_database;
+
+\c acache_database
+set client_min_messages = warning;
+create table acache_t(a int, b int);
+create view acache_v as select * from acache_t;
+
+\c acache_database audit_admin
+set client_min_messages = warning;
+-- nothing configured
+select probes > 0 as probed, mismatches from pg_audit_policy_cache_check();
+
+-- one policy of each kind and mode
+audit all on acache_t whenever successful;
+audit all on acache_v whenever not successful;
+audit all by acache_user whenever not successful;
+audit all on default;
+audit all whenever successful;
+select probes > 0 as probed, mismatches from pg_audit_policy_cache_check();
+
+-- narrowing and widening policies invalidates the compiled ones
+noaudit all on default whenever successful;
+noaudit all on acache_t;
+audit all on acache_v whenever successful;
+audit all by acache_user;
+select probes > 0 as probed, mismatches from pg_audit_policy_cache_check();
+
+noaudit all whenever successful;
+noaudit all by acache_user whenever not successful;
+select probes > 0 as probed, mismatches from pg_audit_policy_cache_check();
+
+clean object audit on default;
+clean object audit;
+select probes > 0 as probed, mismatches from pg_audit_policy_cache_check();
+
+clean all audit;
+select probes > 0 as probed, mismatches from pg_audit_policy_cache_check();
+
+\c regression :regress_user
+set client_min_messages = warning;
+drop database acache_database;
+drop user acache_user;
+reset client_min_messages;
@@ -0,0 +1,62 @@
+--
+-- Batch evaluation of simple scan quals: NULL, NaN and overflow must come
+-- out exactly as with per-tuple evaluation.
+--
+create table bq_t(id int, a int4, b int8, c float8, d date, e timestamp, f text)
+    distribute by replication;
+insert into bq_t values
+    (1, 1, 10, 1.5, '2020-01-01', '2020-01-01 10:00', 'x'),
+    (2, 2, null, 'NaN', '2020-06-01', null, 'x'),
+    (3, null, 30, null, null, '2021-01-01 00:00', 'x'),
+    (4, 2147483647, 9223372036854775807, 'Infinity', '2019-01-01', '2019-01-01 00:00', 'secret'),
+    (5, -5, -50, -0.5, '2020-03-01', '2020-03-01 12:00', 'x');
+
+create function bq_queries() returns table(qual text, ids text)
+language plpgsql as $$
+begin
+    foreach qual in array array[
+        'a > 0',
+        'b <> 10',
+        'c > 1',
+        'c = ''NaN''',
+        'c < ''NaN''',
+        'c <> c',
+        'a - 1 < 0 and d > ''2019-12-31''',
+        'e >= ''2020-01-01''',
+        'c - 1 >= 0.5 and a < 100',
+        'f = ''x'' and b > 0']
+    loop
+        execute 'select coalesce(string_agg(id::text, '','' order by id), '''')' ||
+            ' from bq_t where ' || qual into ids;
+        return next;
+    end loop;
+end;
+$$;
+
+set enable_batch_qual to on;
+select * from bq_queries();
+select id from bq_t where a + 1 > 0;
+select id from bq_t where b * 2 > 0;
+select id from bq_t where c * 1.5e308 > 0;
+-- the row that overflows comes after the one the LIMIT stops at
+select id from bq_t where a + 1 > 0 limit 1;
+
+-- a clause is never evaluated ahead of a security barrier qual
+create view bq_v with (security_barrier) as
+    select id, a from bq_t where f <> 'secret';
+select id from bq_v where a + 1 > 0 order by id;
+
+-- same answers per tuple
+set enable_batch_qual to off;
+select * from bq_queries();
+select id from bq_t where a + 1 > 0;
+select id from bq_t where b * 2 > 0;
+select id from bq_t where c * 1.5e308 > 0;
+-- the row that overflows comes after the one the LIMIT stops at
+select id from bq_t where a + 1 > 0 limit 1;
+select id from bq_v where a + 1 > 0 order by id;
+reset enable_batch_qual;
+
+drop view bq_v;
+drop function bq_queries();
+drop table bq_t;
@@ -0,0 +1,47 @@
+--
+-- Parallel builds of btree indexes: the participants sort chunks of the
+-- heap each, and the leader loads the index from the merge of their runs.
+--
+set min_parallel_table_scan_size = 0;
+set maintenance_work_mem = '128MB';
+set max_parallel_maintenance_workers = 2;
+create table btpar_t (a int, b text) with (parallel_workers = 2) distribute by shard(a);
+insert into btpar_t values (1, 'first');
+insert into btpar_t select i, 'row ' || i from generate_series(2, 30000) i;
+insert into btpar_t values (1, 'last');
+-- the copies of 1 are at both ends of the heap, in runs of different
+-- participants, and only the merge of the runs finds them equal
+create unique index btpar_t_a_key on btpar_t (a);
+-- deleted and HOT updated tuples are indexed, or not, without taking part in
+-- the uniqueness check
+begin;
+delete from btpar_t where b = 'last';
+update btpar_t set b = b || ' updated' where a % 1000 = 0;
+create unique index btpar_t_a_key on btpar_t (a);
+commit;
+create index btpar_t_b_idx on btpar_t (b);
+-- every live tuple can be found through the indexes
+set enable_seqscan to off;
+set enable_bitmapscan to off;
+select count(*), sum(a) from btpar_t where a > 0;
+select a, b from btpar_t where a in (1, 999, 1000, 15000, 30000) order by a;
+select count(*) from btpar_t where b > 'row';
+select count(*) from btpar_t where b = 'last';
+select a from btpar_t where b = 'row 30000 updated';
+-- same answers from the heap
+set enable_seqscan to on;
+set enable_indexscan to off;
+set enable_indexonlyscan to off;
+select count(*), sum(a) from btpar_t where a > 0;
+select a, b from btpar_t where a in (1, 999, 1000, 15000, 30000) order by a;
+select count(*) from btpar_t where b > 'row';
+select count(*) from btpar_t where b = 'last';
+select a from btpar_t where b = 'row 30000 updated';
+reset enable_seqscan;
+reset enable_bitmapscan;
+reset enable_indexscan;
+reset enable_indexonlyscan;
+reset min_parallel_table_scan_size;
+reset maintenance_work_mem;
+reset max_parallel_maintenance_workers;
+drop table btpar_t;
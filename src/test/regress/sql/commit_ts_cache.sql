@@ -0,0 +1,47 @@
+--
+-- Commit timestamps resolved by a backend are cached, see commit_ts.c.
+-- Visibility and timestamps must come out the same through the cache,
+-- across two-phase commit and after the timestamps were written back into
+-- the tuple headers, and the cache must be emptied before its xids could
+-- be reused.
+--
+create table cts_t(id int, v int) distribute by shard(id);
+insert into cts_t select i, 0 from generate_series(1, 100) i;
+-- the first scan resolves and writes back the timestamps, the second reads them back
+select count(*), count(pg_xact_commit_timestamp(xmin)) from cts_t;
+select count(*), count(pg_xact_commit_timestamp(xmin)) from cts_t;
+execute direct on (datanode_1) 'select entries > 0 as cached from pg_commit_ts_cache_stats()';
+
+-- a prepared transaction has no timestamp yet, nothing may be cached for it
+begin;
+update cts_t set v = 1 where id <= 10;
+prepare transaction 'cts_commit';
+select count(*) filter (where v = 0), count(*) filter (where v = 1) from cts_t;
+select count(pg_xact_commit_timestamp(xmax)) from cts_t where id <= 10;
+commit prepared 'cts_commit';
+select count(*) filter (where v = 0), count(*) filter (where v = 1) from cts_t;
+select count(pg_xact_commit_timestamp(xmin)) from cts_t where id <= 10;
+select count(*) filter (where v = 0), count(*) filter (where v = 1) from cts_t;
+
+begin;
+update cts_t set v = 2 where id <= 20;
+prepare transaction 'cts_rollback';
+select count(*) filter (where v = 2) from cts_t;
+rollback prepared 'cts_rollback';
+select count(*) filter (where v = 1), count(*) filter (where v = 2) from cts_t;
+select count(*) filter (where v = 1), count(*) filter (where v = 2) from cts_t;
+
+-- the timestamp of an xid stays the same once cached
+select min(pg_xact_commit_timestamp(xmin)) as cts_commit_ts from cts_t where v = 1 \gset
+select min(pg_xact_commit_timestamp(xmin)) = :'cts_commit_ts' as same_ts from cts_t where v = 1;
+
+-- a horizon of one xid resets the cache as soon as RecentXmin moves on,
+-- as the default horizon does long before a wraparound
+set commit_ts_cache_horizon to 1;
+insert into cts_t values (101, 0);
+select count(*), count(pg_xact_commit_timestamp(xmin)) from cts_t;
+execute direct on (datanode_1) 'select resets > 0 as reset from pg_commit_ts_cache_stats()';
+reset commit_ts_cache_horizon;
+select count(*), count(pg_xact_commit_timestamp(xmin)) from cts_t;
+
+drop table cts_t;
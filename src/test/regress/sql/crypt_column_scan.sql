@@ -0,0 +1,78 @@
+--
+-- With column crypt, a scan only decrypts the crypted columns read above
+-- it.  Whatever a query reads must still come out decrypted, and rows
+-- written back through such a scan must keep their crypted columns.
+--
+select current_user as regress_user \gset
+create extension if not exists opentenbase_mls;
+
+create table ccs_t(id int, a int, b text, c int, d numeric) distribute by shard(id);
+create function ccs_plan_has(query text, node text) returns bool
+language plpgsql as $$
+declare
+    line text;
+begin
+    for line in execute 'explain (costs off) ' || query
+    loop
+        if line like '%' || node || '%' then
+            return true;
+        end if;
+    end loop;
+    return false;
+end;
+$$;
+
+\c regression mls_admin
+select MLS_TRANSPARENT_CRYPT_CREATE_ALGORITHM('SM4', '0123456789abcdef') as ccs_sm4 \gset
+select MLS_TRANSPARENT_CRYPT_CREATE_ALGORITHM('AES128', '1949') as ccs_aes \gset
+select MLS_TRANSPARENT_CRYPT_ALGORITHM_BIND_TABLE('public', 'ccs_t', 'b', :ccs_sm4);
+select MLS_TRANSPARENT_CRYPT_ALGORITHM_BIND_TABLE('public', 'ccs_t', 'd', :ccs_aes);
+
+\c regression :regress_user
+insert into ccs_t select i, i * 2, 'b' || i, i % 100, i * 1.5 from generate_series(1, 1000) i;
+create index ccs_t_c on ccs_t(c);
+vacuum analyze ccs_t;
+
+-- plain columns only
+select id, a, c from ccs_t where id <= 3 order by id;
+select count(*) from ccs_t;
+-- whole-row references decrypt every column
+select t from ccs_t t where id <= 2 order by id;
+select count(t) from ccs_t t where (t).b like 'b99%';
+-- quals on crypted columns
+select count(*) from ccs_t where b like 'b1%';
+select id, b, d from ccs_t where d > 1497 order by id;
+select id from ccs_t where b = 'b42' and d = 63;
+
+-- updates through a scan reading few columns keep the crypted ones
+update ccs_t set a = -a where b = 'b5';
+update ccs_t set c = c + 1000 where id between 10 and 12;
+select id, a, b, c, d from ccs_t where id in (5, 10, 11, 12) order by id;
+delete from ccs_t where d < 3;
+select count(*), min(id), min(b), max(d) from ccs_t;
+
+-- index only scans read no heap column, index and bitmap heap scans recheck
+set enable_seqscan to off;
+set enable_bitmapscan to off;
+select ccs_plan_has('select c from ccs_t where c = 7', 'Index Only Scan');
+select count(*), sum(c) from ccs_t where c = 7;
+select ccs_plan_has('select b from ccs_t where c = 7', 'Index Scan');
+select string_agg(b, ',' order by id) from ccs_t where c = 7;
+set enable_indexscan to off;
+set enable_indexonlyscan to off;
+set enable_bitmapscan to on;
+select ccs_plan_has('select id, b, d from ccs_t where c = 7 and d > 1000', 'Bitmap Heap Scan');
+select id, b, d from ccs_t where c = 7 and d > 1000 order by id;
+select count(*) from ccs_t where c = 7 and b like 'b%07';
+reset enable_seqscan;
+reset enable_indexscan;
+reset enable_indexonlyscan;
+reset enable_bitmapscan;
+
+delete from ccs_t;
+\c regression mls_admin
+select MLS_TRANSPARENT_CRYPT_ALGORITHM_UNBIND_TABLE('public', 'ccs_t', 'b');
+select MLS_TRANSPARENT_CRYPT_ALGORITHM_UNBIND_TABLE('public', 'ccs_t', 'd');
+\c regression :regress_user
+drop function ccs_plan_has(text, text);
+drop table ccs_t;
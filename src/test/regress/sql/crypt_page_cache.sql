@@ -0,0 +1,65 @@
+--
+-- The rel crypt page cache keeps decrypted images of pages of crypted
+-- relations.  The images must follow the crypt policy of the relfilenode,
+-- a page read back after the policy changed must never be an image
+-- decrypted under the old one.
+--
+-- The reads only go through the cache when the datanodes run with
+-- rel_crypt_page_cache_size set and shared_buffers small enough for
+-- crypt_pc_evict to push crypt_pc out, see mls_schedule.
+--
+select current_user as regress_user \gset
+create extension if not exists opentenbase_mls;
+
+create table crypt_pc(id int, v text) distribute by shard(id);
+create table crypt_pc_evict(id int, v text) distribute by shard(id);
+insert into crypt_pc_evict select i, repeat('x', 500) from generate_series(1, 20000) i;
+
+\c regression mls_admin
+select MLS_TRANSPARENT_CRYPT_CREATE_ALGORITHM('SM4', '0123456789abcdef') as crypt_pc_algo \gset
+select MLS_TRANSPARENT_CRYPT_ALGORITHM_BIND_TABLE('public', 'crypt_pc', :crypt_pc_algo);
+
+-- crypted, read back through the cache
+\c regression :regress_user
+insert into crypt_pc select i, repeat('a', 100) || i from generate_series(1, 2000) i;
+checkpoint;
+select count(*), sum(length(v)) from crypt_pc_evict;
+select count(*), md5(string_agg(v, ',' order by id)) from crypt_pc;
+select count(*), sum(length(v)) from crypt_pc_evict;
+select count(*), md5(string_agg(v, ',' order by id)) from crypt_pc;
+
+-- empty the table in place, same relfilenode, and drop the policy
+delete from crypt_pc;
+vacuum crypt_pc;
+\c regression mls_admin
+select MLS_TRANSPARENT_CRYPT_ALGORITHM_UNBIND_TABLE('public', 'crypt_pc');
+
+-- plain pages now, the images of the crypted ones must be gone
+\c regression :regress_user
+insert into crypt_pc select i, repeat('b', 100) || i from generate_series(1, 2000) i;
+checkpoint;
+select count(*), sum(length(v)) from crypt_pc_evict;
+select count(*), md5(string_agg(v, ',' order by id)) from crypt_pc;
+
+-- and crypted again under the same algorithm
+delete from crypt_pc;
+vacuum crypt_pc;
+\c regression mls_admin
+select MLS_TRANSPARENT_CRYPT_ALGORITHM_BIND_TABLE('public', 'crypt_pc', :crypt_pc_algo);
+
+\c regression :regress_user
+insert into crypt_pc select i, repeat('c', 100) || i from generate_series(1, 2000) i;
+checkpoint;
+select count(*), sum(length(v)) from crypt_pc_evict;
+select count(*), md5(string_agg(v, ',' order by id)) from crypt_pc;
+
+-- with the cache on, the policy changes and rewrites invalidated images
+EXECUTE DIRECT ON (datanode_1) 'select size = 0 or invalidations > 0 as invalidated from pg_rel_crypt_page_cache_stats()';
+
+delete from crypt_pc;
+vacuum crypt_pc;
+\c regression mls_admin
+select MLS_TRANSPARENT_CRYPT_ALGORITHM_UNBIND_TABLE('public', 'crypt_pc');
+\c regression :regress_user
+drop table crypt_pc;
+drop table crypt_pc_evict;
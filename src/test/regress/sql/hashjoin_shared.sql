@@ -0,0 +1,67 @@
+--
+-- Parallel hash joins whose workers share one hash table.  work_mem is far
+-- too small for the inner side, so the join runs in several batches; when
+-- the inner side is underestimated, the workers add batches while they
+-- build the table.  Every join type must give the same answer as the serial
+-- plan.
+--
+create table phj_outer(id int, v int) distribute by shard(id);
+create table phj_inner(id int, w int) distribute by shard(id);
+insert into phj_outer select i, i % 7 from generate_series(1, 40000) i;
+insert into phj_inner select i, i % 5 from generate_series(3, 60000, 3) i;
+analyze phj_outer;
+analyze phj_inner;
+
+create function phj_queries() returns table(query text, result text)
+language plpgsql as $$
+declare
+    q text;
+begin
+    foreach q in array array[
+        'select count(*), sum(o.id) from phj_outer o join phj_inner i on o.id = i.id',
+        'select count(*), count(i.id) from phj_outer o left join phj_inner i on o.id = i.id',
+        'select count(*) from phj_outer o where exists (select 1 from phj_inner i where i.id = o.id)',
+        'select count(*) from phj_outer o where not exists (select 1 from phj_inner i where i.id = o.id)',
+        'select count(*), count(o.id) from phj_outer o right join phj_inner i on o.id = i.id',
+        'select count(*), count(o.id), count(i.id) from phj_outer o full join phj_inner i on o.id = i.id',
+        -- the planner expects 0.5% of the inner rows to pass w + 0 = w
+        'select count(*), sum(o.id) from phj_outer o join (select * from phj_inner where w + 0 = w) i on o.id = i.id',
+        'select count(*), count(i.id) from phj_outer o left join (select * from phj_inner where w + 0 = w) i on o.id = i.id',
+        'select count(*) from phj_outer o where not exists (select 1 from phj_inner i where i.id = o.id and i.w + 0 = i.w)',
+        'select count(*), count(o.id), count(i.id) from phj_outer o full join (select * from phj_inner where w + 0 = w) i on o.id = i.id']
+    loop
+        query := q;
+        execute 'select (' || q || ')::text' into result;
+        return next;
+    end loop;
+end;
+$$;
+
+set enable_mergejoin to off;
+set enable_nestloop to off;
+set work_mem to '64kB';
+
+-- parallel
+set olap_optimizer to on;
+set parallel_setup_cost to 0;
+set parallel_tuple_cost to 0;
+set min_parallel_table_scan_size to 0;
+set max_parallel_workers_per_gather to 2;
+select result from phj_queries();
+
+-- serial
+set max_parallel_workers_per_gather to 0;
+select result from phj_queries();
+
+reset max_parallel_workers_per_gather;
+reset min_parallel_table_scan_size;
+reset parallel_tuple_cost;
+reset parallel_setup_cost;
+reset olap_optimizer;
+reset work_mem;
+reset enable_nestloop;
+reset enable_mergejoin;
+
+drop function phj_queries();
+drop table phj_outer;
+drop table phj_inner;
@@ -0,0 +1,68 @@
+--
+-- Incremental sort: an input already sorted by a prefix of the sort keys is
+-- sorted one group of that prefix at a time.
+--
+create table incsort_t(a int, b int) distribute by replication;
+insert into incsort_t select i / 10, 9 - i % 10 from generate_series(1, 10000) i;
+create index incsort_t_a_idx on incsort_t(a);
+analyze incsort_t;
+
+-- the index scan gives the presorted prefix
+execute direct on (datanode_1) 'explain (costs off) select a, b from incsort_t where a < 10 order by a, b';
+execute direct on (datanode_1) 'explain (costs off) select a, b from incsort_t order by a, b limit 5';
+
+select a, b from incsort_t order by a, b limit 5;
+select a, b from incsort_t order by a, b limit 3 offset 40;
+select a, b from incsort_t order by a desc, b limit 3;
+select count(*), sum(a), sum(b) from (select a, b from incsort_t where a < 10 order by a, b) s;
+
+-- rescanned for every outer row
+execute direct on (datanode_1) 'select x, s.a, s.b from generate_series(1, 3) x, lateral (select a, b from incsort_t where a >= x * 100 order by a, b limit 2) s';
+
+-- same answers with a full sort
+set enable_incrementalsort to off;
+select a, b from incsort_t order by a, b limit 5;
+select a, b from incsort_t order by a, b limit 3 offset 40;
+select a, b from incsort_t order by a desc, b limit 3;
+select count(*), sum(a), sum(b) from (select a, b from incsort_t where a < 10 order by a, b) s;
+execute direct on (datanode_1) 'select x, s.a, s.b from generate_series(1, 3) x, lateral (select a, b from incsort_t where a >= x * 100 order by a, b limit 2) s';
+reset enable_incrementalsort;
+
+drop table incsort_t;
+
+-- On the coordinator, above the merge receive of a RemoteSubplan: the
+-- inner limit must be applied to the rows of all the datanodes, which are
+-- merged by a
+create table incsort_s(a int, b int) distribute by shard(b);
+insert into incsort_s select i / 10, 9 - i % 10 from generate_series(1, 10000) i;
+create index incsort_s_a_idx on incsort_s(a);
+analyze incsort_s;
+
+-- the sorts of the plan of a query and its remote subplans, from the top
+create function incsort_plan(q text) returns setof text language plpgsql as
+$$
+declare
+    ln text;
+begin
+    for ln in execute 'explain (costs off) ' || q loop
+        if ln ~ '^\s*(->\s+)?(Incremental Sort|Sort|Remote Subquery Scan)(\s+on\s.*)?$' then
+            return next substring(ln from '(Incremental Sort|Sort|Remote Subquery Scan)');
+        end if;
+    end loop;
+end;
+$$;
+
+select incsort_plan('select a, b from (select a, b from incsort_s order by a limit 999) s order by a, b limit 5');
+select a, b from (select a, b from incsort_s order by a limit 999) s order by a, b limit 5;
+select a, b from (select a, b from incsort_s order by a limit 999) s order by a, b limit 3 offset 40;
+select count(*), sum(a), sum(b) from (select a, b from (select a, b from incsort_s order by a limit 999) s order by a, b) t;
+
+set enable_incrementalsort to off;
+select incsort_plan('select a, b from (select a, b from incsort_s order by a limit 999) s order by a, b limit 5');
+select a, b from (select a, b from incsort_s order by a limit 999) s order by a, b limit 5;
+select a, b from (select a, b from incsort_s order by a limit 999) s order by a, b limit 3 offset 40;
+select count(*), sum(a), sum(b) from (select a, b from (select a, b from incsort_s order by a limit 999) s order by a, b) t;
+reset enable_incrementalsort;
+
+drop function incsort_plan(text);
+drop table incsort_s;
@@ -0,0 +1,116 @@
+--
+-- Joins of interval partitioned tables on their partition keys.  Partitions
+-- pruned on one side by quals are pruned on the other side too, and with
+-- enable_partition_wise_join the join is done partition by partition.  With
+-- enable_partition_wise_aggregate, so is an aggregation over them.  Every
+-- query must give the same answer either way.
+--
+create table ipj_a (a int, b int, c timestamp) partition by range (c) begin (timestamp without time zone '2022-01-01') step (interval '1 day') partitions (4) distribute by shard (a) to group default_group;
+create table ipj_b (a int, b int, c timestamp) partition by range (c) begin (timestamp without time zone '2022-01-01') step (interval '1 day') partitions (4) distribute by shard (a) to group default_group;
+create table ipj_c (a int, b int, c timestamp) partition by range (c) begin (timestamp without time zone '2022-01-01') step (interval '1 day') partitions (4) distribute by shard (a) to group default_group;
+-- another start, another step
+create table ipj_d (a int, b int, c timestamp) partition by range (c) begin (timestamp without time zone '2022-01-02') step (interval '1 day') partitions (4) distribute by shard (a) to group default_group;
+create table ipj_e (a int, b int, c timestamp) partition by range (c) begin (timestamp without time zone '2022-01-01') step (interval '1 month') partitions (2) distribute by shard (a) to group default_group;
+
+-- a row every hour, every 2 hours or every 3 hours
+insert into ipj_a select i % 8, i, timestamp '2022-01-01' + i * interval '1 hour' from generate_series(0, 95) i;
+insert into ipj_b select i % 8, i, timestamp '2022-01-01' + i * interval '1 hour' from generate_series(0, 95, 2) i;
+insert into ipj_c select i % 8, i, timestamp '2022-01-01' + i * interval '1 hour' from generate_series(0, 95, 3) i;
+insert into ipj_d select i % 8, i, timestamp '2022-01-01' + i * interval '1 hour' from generate_series(24, 118, 2) i;
+insert into ipj_e select i % 8, i, timestamp '2022-01-01' + i * interval '1 hour' from generate_series(0, 94, 2) i;
+analyze ipj_a;
+analyze ipj_b;
+analyze ipj_c;
+analyze ipj_d;
+analyze ipj_e;
+
+-- the joins and aggregates of the plan of a query, and the partitions it
+-- scans
+create function ipj_plan(q text) returns text
+language plpgsql as $$
+declare
+    ln text;
+    joins int := 0;
+    aggs int := 0;
+    scans text[] := '{}';
+begin
+    for ln in execute 'explain (costs off) ' || q loop
+        if ln ~ 'Join$' then
+            joins := joins + 1;
+        end if;
+        if ln ~ 'Aggregate$' then
+            aggs := aggs + 1;
+        end if;
+        if ln ~ 'name: \w+\)' then
+            scans := scans || substring(ln from 'name: (\w+)\)');
+        end if;
+    end loop;
+    return format('%s joins, %s aggregates: %s', joins, aggs,
+                  (select string_agg(s, ' ' order by s) from unnest(scans) s));
+end;
+$$;
+-- the rows of a query, of a nullable column x, and their sum
+create function ipj_run(queries text[]) returns table(plan text, result text)
+language plpgsql as $$
+declare
+    q text;
+begin
+    foreach q in array queries loop
+        plan := ipj_plan(q);
+        execute 'select count(*) || ''|'' || count(x) || ''|'' || coalesce(sum(x), 0) from (' || q || ') s' into result;
+        return next;
+    end loop;
+end;
+$$;
+create function ipj_joins() returns text[]
+language sql as $$
+select array[
+    -- inner join, restricted on one side
+    'select b.b as x from ipj_a a join ipj_b b on a.a = b.a and a.c = b.c where a.c >= ''2022-01-03''',
+    -- left join, the nullable side keeps its partitions when pruning
+    'select b.b as x from ipj_a a left join ipj_b b on a.a = b.a and a.c = b.c where a.c < ''2022-01-02''',
+    -- other bounds, nothing in common
+    'select d.b as x from ipj_a a join ipj_d d on a.a = d.a and a.c = d.c where a.c >= ''2022-01-04''',
+    'select e.b as x from ipj_a a join ipj_e e on a.a = e.a and a.c = e.c where a.c >= ''2022-01-04''',
+    -- a chain of three tables, restricted on the last one
+    'select c.b as x from ipj_a a join ipj_b b on a.a = b.a and a.c = b.c join ipj_c c on b.a = c.a and b.c = c.c where c.c < ''2022-01-03''']
+$$;
+create function ipj_aggs() returns text[]
+language sql as $$
+select array[
+    -- partial aggregates, combined on the coordinator
+    'select count(*) as x from ipj_a a join ipj_b b on a.a = b.a and a.c = b.c where a.c >= ''2022-01-03''',
+    'select count(*) as x from ipj_a a join ipj_b b on a.a = b.a and a.c = b.c group by a.c',
+    'select count(*) as x from ipj_a where c < ''2022-01-03''',
+    -- complete aggregates, grouped by the partition key
+    'select count(*) as x from ipj_a a join ipj_b b on a.a = b.a and a.c = b.c group by a.a, a.c']
+$$;
+
+set enable_fast_query_shipping to off;
+set enable_nestloop to off;
+set enable_mergejoin to off;
+set enable_partition_wise_join to off;
+select plan as pruned_plan, result from ipj_run(ipj_joins());
+set enable_partition_wise_join to on;
+select plan as partition_wise_plan, result from ipj_run(ipj_joins());
+set enable_partition_wise_join to off;
+set enable_sort to off;
+select plan as aggregate_plan, result from ipj_run(ipj_aggs());
+set enable_partition_wise_aggregate to on;
+select plan as partition_wise_aggregate_plan, result from ipj_run(ipj_aggs());
+
+reset enable_partition_wise_aggregate;
+reset enable_partition_wise_join;
+reset enable_sort;
+reset enable_mergejoin;
+reset enable_nestloop;
+reset enable_fast_query_shipping;
+drop function ipj_aggs();
+drop function ipj_joins();
+drop function ipj_run(text[]);
+drop function ipj_plan(text);
+drop table ipj_a;
+drop table ipj_b;
+drop table ipj_c;
+drop table ipj_d;
+drop table ipj_e;
@@ -0,0 +1,32 @@
+--
+-- The partitions the background workers of interval_partition_precreate
+-- add ahead of time: those covering the current period and the given
+-- number of next ones, in tables partitioned by day or month.
+--
+create table ipc_day (a int, c timestamp) partition by range (c) begin (timestamp without time zone '2022-01-01') step (interval '1 day') partitions (3) distribute by shard (a) to group default_group;
+create table ipc_month (a int, c timestamp) partition by range (c) begin (timestamp without time zone '2021-12-01') step (interval '1 month') partitions (2) distribute by shard (a) to group default_group;
+create table "ipc Quoted" (a int, c timestamp) partition by range (c) begin (timestamp without time zone '2022-01-02') step (interval '1 day') partitions (1) distribute by shard (a) to group default_group;
+-- already far enough ahead
+create table ipc_ahead (a int, c timestamp) partition by range (c) begin (timestamp without time zone '2022-01-01') step (interval '1 day') partitions (10) distribute by shard (a) to group default_group;
+-- not started yet
+create table ipc_future (a int, c timestamp) partition by range (c) begin (timestamp without time zone '2022-02-01') step (interval '1 day') partitions (1) distribute by shard (a) to group default_group;
+-- not partitioned by time
+create table ipc_int (a int, b int) partition by range (b) begin (1) step (10) partitions (1) distribute by shard (a) to group default_group;
+create table ipc_plain (a int, c timestamp) distribute by shard (a) to group default_group;
+select * from pg_interval_partition_precreate_commands('2022-01-03 10:00', 2) where relname like '%ipc%' order by partitions;
+-- the current period only
+select * from pg_interval_partition_precreate_commands('2022-01-03 10:00', 0) where relname like '%ipc%' order by partitions;
+select * from pg_interval_partition_precreate_commands('2022-01-03 10:00', -1);
+-- once added, the partitions are no longer asked for
+alter table ipc_day add partitions 2;
+select * from pg_interval_partition_precreate_commands('2022-01-03 10:00', 2) where relname like '%ipc%' order by partitions;
+-- only datanodes add extents to the new partitions
+select pg_interval_partition_prepare('ipc_day', 3);
+select pg_interval_partition_prepare('ipc_plain', 0);
+drop table ipc_day;
+drop table ipc_month;
+drop table "ipc Quoted";
+drop table ipc_ahead;
+drop table ipc_future;
+drop table ipc_int;
+drop table ipc_plain;
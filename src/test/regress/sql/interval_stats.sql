@@ -0,0 +1,100 @@
+--
+-- Rows of an interval partitioned table are modified in its partitions, and
+-- the changes count for the table too on the datanodes, to trigger its
+-- auto-analyze.  Analyzing a partition must not count them again.
+--
+create table ivs_t (a int, b int) partition by range (b) begin (1) step (100) partitions (3) distribute by shard(a) to group default_group;
+insert into ivs_t select i, i from generate_series(1, 300) i;
+-- changes counted on a datanode for the table and for its partitions, once
+-- they reached the stats collector
+create function ivs_mods(analyzed bool, out table_mods bigint, out part_mods bigint,
+                         out nrows bigint, out part0_rows bigint)
+language plpgsql as $$
+begin
+    select count(*) into nrows from ivs_t;
+    select count(*) into part0_rows from ivs_t_part_0;
+    for i in 1 .. 300 loop
+        select n_mod_since_analyze into table_mods
+            from pg_stat_user_tables where relname = 'ivs_t';
+        select sum(n_mod_since_analyze) into part_mods
+            from pg_stat_user_tables where relname like 'ivs\_t\_part\_%';
+        exit when table_mods >= nrows and
+            part_mods = nrows - case when analyzed then part0_rows else 0 end;
+        perform pg_sleep(0.1);
+        perform pg_stat_clear_snapshot();
+    end loop;
+end;
+$$;
+-- let the datanode sessions send their counters
+select pg_sleep(0.6);
+execute direct on (datanode_1) 'select 1';
+execute direct on (datanode_2) 'select 1';
+execute direct on (datanode_1) 'select table_mods = nrows, part_mods = nrows from ivs_mods(false)';
+execute direct on (datanode_2) 'select table_mods = nrows, part_mods = nrows from ivs_mods(false)';
+analyze ivs_t_part_0;
+execute direct on (datanode_1) 'select table_mods = nrows, part_mods = nrows - part0_rows from ivs_mods(true)';
+execute direct on (datanode_2) 'select table_mods = nrows, part_mods = nrows - part0_rows from ivs_mods(true)';
+drop function ivs_mods(bool);
+drop table ivs_t;
+
+--
+-- On a datanode, the statistics of an interval partitioned table are merged
+-- from those of its partitions, and only the partitions that changed are
+-- sampled again.
+--
+create table ivs_m (a int, b int, c int) partition by range (b) begin (1) step (1000) partitions (3) distribute by shard(a) to group default_group;
+insert into ivs_m select i, i, i % 5 from generate_series(1, 3000) i;
+analyze ivs_m;
+-- the merged statistics of the table, checked against the rows of the
+-- datanode: the partition key is unique, c has a few values in every
+-- partition
+create function ivs_merged(out b_distinct real, out b_bounds bool,
+                           out c_distinct real, out c_mcv int[], out c_freqs bool)
+language plpgsql as $$
+declare
+    bounds int[];
+begin
+    select n_distinct, histogram_bounds::text::int[] into b_distinct, bounds
+        from pg_stats where tablename = 'ivs_m' and attname = 'b';
+    b_bounds := bounds[1] = (select min(b) from ivs_m) and
+        bounds[array_length(bounds, 1)] = (select max(b) from ivs_m);
+    select n_distinct,
+           (select array_agg(v order by v) from unnest(most_common_vals::text::int[]) v),
+           abs((select sum(f) from unnest(most_common_freqs) f) - 1) < 0.001
+        into c_distinct, c_mcv, c_freqs
+        from pg_stats where tablename = 'ivs_m' and attname = 'c';
+end;
+$$;
+-- how many times each partition was analyzed, once the last one was
+-- analyzed twice
+create function ivs_analyzed(out part0 bigint, out part1 bigint, out part2 bigint)
+language plpgsql as $$
+begin
+    for i in 1 .. 300 loop
+        select analyze_count + autoanalyze_count into part0
+            from pg_stat_user_tables where relname = 'ivs_m_part_0';
+        select analyze_count + autoanalyze_count into part1
+            from pg_stat_user_tables where relname = 'ivs_m_part_1';
+        select analyze_count + autoanalyze_count into part2
+            from pg_stat_user_tables where relname = 'ivs_m_part_2';
+        exit when part2 >= 2;
+        perform pg_sleep(0.1);
+        perform pg_stat_clear_snapshot();
+    end loop;
+end;
+$$;
+execute direct on (datanode_1) 'select * from ivs_merged()';
+execute direct on (datanode_2) 'select * from ivs_merged()';
+-- new rows in the last partition only, with a new value of c
+insert into ivs_m select i, 2001 + i % 1000, 5 from generate_series(3001, 4000) i;
+select pg_sleep(0.6);
+execute direct on (datanode_1) 'select 1';
+execute direct on (datanode_2) 'select 1';
+analyze ivs_m;
+execute direct on (datanode_1) 'select part0 = 1, part1 = 1, part2 >= 2 from ivs_analyzed()';
+execute direct on (datanode_2) 'select part0 = 1, part1 = 1, part2 >= 2 from ivs_analyzed()';
+execute direct on (datanode_1) 'select * from ivs_merged()';
+execute direct on (datanode_2) 'select * from ivs_merged()';
+drop function ivs_analyzed();
+drop function ivs_merged();
+drop table ivs_m;
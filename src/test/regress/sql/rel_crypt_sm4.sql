@@ -0,0 +1,5 @@
+--
+-- The sm4 page crypt paths must give the same ciphertext as the one block
+-- at a time reference kernel, and decrypt back to the plaintext.
+--
+select path, md5, ok from pg_rel_crypt_sm4_selftest();
@@ -0,0 +1,102 @@
+--
+-- Bloom filters pushed from hash join inner sides down to the producers of
+-- the outer side.  The filter only keeps rows from being sent, so every
+-- query must give the same answer with and without it.
+--
+create table rf_outer(a int, b int, c text) distribute by shard(a);
+create table rf_inner(a int, b int, c text) distribute by shard(a);
+insert into rf_outer select i, i % 100, 'v' || (i % 100) from generate_series(1, 2000) i;
+insert into rf_outer values(2001, null, null);
+insert into rf_inner select i + 100, i, 'v' || i from generate_series(0, 9) i;
+insert into rf_inner values(200, null, null);
+analyze rf_outer;
+analyze rf_inner;
+
+create function rf_queries() returns table(query text, result text)
+language plpgsql as $$
+declare
+    q text;
+begin
+    foreach q in array array[
+        'select count(*), sum(o.a) from rf_outer o join rf_inner i on o.b = i.b',
+        'select count(*) from rf_outer o join rf_inner i on o.b = i.b and o.c = i.c',
+        'select count(*) from rf_outer o join rf_inner i on o.c = i.c',
+        'select count(*) from rf_outer o where o.b in (select b from rf_inner)',
+        'select count(*), count(o.a) from rf_outer o right join rf_inner i on o.b = i.b',
+        'select count(*) from rf_outer o join rf_inner i on o.b = i.b + 1000',
+        'select count(*) from rf_outer o join rf_outer i on o.b = i.b',
+        -- producers whose target list carries resjunk sort columns
+        'select count(*), sum(i.a) from (select distinct on (b) b from rf_outer order by b, a desc) o join rf_inner i on o.b = i.b',
+        'select count(*), sum(i.a) from (select distinct on (b) b, c from rf_outer order by b, a % 7, a) o join rf_inner i on o.b = i.b and o.c = i.c']
+    loop
+        query := q;
+        execute 'select (' || q || ')::text' into result;
+        return next;
+    end loop;
+end;
+$$;
+
+-- the filters are built and sent by the joins on the datanodes, and received
+-- and applied by the producers there: sum the counters of all datanodes
+create function rf_stats(out built int8, out sent int8, out received int8,
+                         out checked int8, out removed int8)
+language plpgsql as $$
+declare
+    n text;
+    r record;
+begin
+    built := 0;
+    sent := 0;
+    received := 0;
+    checked := 0;
+    removed := 0;
+    for n in select node_name from pgxc_node where node_type = 'D' loop
+        for r in execute 'execute direct on (' || n || ') ''select * from pg_stat_get_runtime_filter()''' loop
+            built := built + r.built;
+            sent := sent + r.sent;
+            received := received + r.received;
+            checked := checked + r.checked;
+            removed := removed + r.removed;
+        end loop;
+    end loop;
+end;
+$$;
+select * from rf_stats() \gset rf_
+
+-- with the filter
+set enable_runtime_filter to on;
+select result from rf_queries();
+
+-- each counter went up
+select built > :rf_built as built, sent > :rf_sent as sent,
+       received > :rf_received as received, checked > :rf_checked as checked,
+       removed > :rf_removed as removed
+    from rf_stats();
+
+-- a filter too small for the inner side is not pushed
+set runtime_filter_max_size to 1;
+select result from rf_queries();
+reset runtime_filter_max_size;
+
+-- the filter is sent in each Bind of a reused plan; after five custom plans
+-- the generic one is chosen
+prepare rf_prep(int) as
+    select count(*) from rf_outer o join rf_inner i on o.b = i.b where i.b < $1;
+execute rf_prep(5);
+execute rf_prep(10);
+execute rf_prep(0);
+execute rf_prep(5);
+execute rf_prep(10);
+execute rf_prep(0);
+execute rf_prep(3);
+deallocate rf_prep;
+
+-- same answers without the filter
+set enable_runtime_filter to off;
+select result from rf_queries();
+reset enable_runtime_filter;
+
+drop function rf_queries();
+drop function rf_stats();
+drop table rf_outer;
+drop table rf_inner;
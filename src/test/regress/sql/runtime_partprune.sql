@@ -0,0 +1,172 @@
+--
+-- Pruning of Append and MergeAppend subplans at executor startup and at
+-- rescan, from quals comparing the partition key to values only known then.
+--
+create table rpp (a int, b int) partition by range (a);
+create table rpp_1 partition of rpp for values from (1) to (100);
+create table rpp_2 partition of rpp for values from (100) to (200);
+create table rpp_3 partition of rpp for values from (200) to (300);
+create index rpp_1_a_idx on rpp_1(a);
+create index rpp_2_a_idx on rpp_2(a);
+create index rpp_3_a_idx on rpp_3(a);
+insert into rpp select i, i from generate_series(1, 299) i;
+analyze rpp;
+
+-- the plan nodes and the partitions that are left, on a datanode
+create function rpp_explain(query text) returns setof text
+language plpgsql as $$
+declare
+    ln text;
+begin
+    for ln in execute 'explain (costs off) ' || query loop
+        if ln ~ 'Append|Subplans Removed' then
+            return next regexp_replace(ln, '^\s*(->\s+)?', '');
+        elsif ln ~ 'Scan.* on rpp_[0-9]+(\s|$)' then
+            return next substring(ln from 'on (rpp_[0-9]+)');
+        end if;
+    end loop;
+end;
+$$;
+
+-- the number of times the partitions are scanned by the inner side of a
+-- nested loop, on a datanode
+create function rpp_inner_loops(query text) returns bigint
+language plpgsql as $$
+declare
+    plan json;
+    child json;
+    loops bigint := 0;
+begin
+    execute 'explain (analyze, costs off, timing off, summary off, format json) ' ||
+        query into plan;
+    for child in select json_array_elements(plan->0->'Plan'->'Plans'->1->'Plans') loop
+        loops := loops + (child->>'Actual Loops')::bigint;
+    end loop;
+    return loops;
+end;
+$$;
+
+-- stable expressions prune at executor startup
+set rpp.val = '150';
+execute direct on (datanode_1) $$select rpp_explain('select * from rpp where a = current_setting(''rpp.val'')::int')$$;
+execute direct on (datanode_1) $$select rpp_explain('select a from rpp where a > current_setting(''rpp.val'')::int order by a limit 3')$$;
+select * from rpp where a = current_setting('rpp.val')::int;
+select a from rpp where a > current_setting('rpp.val')::int order by a limit 3;
+
+-- a parameterized nested loop only rescans the partition of each outer row
+set enable_hashjoin to off;
+set enable_mergejoin to off;
+set enable_material to off;
+execute direct on (datanode_1) $$select rpp_inner_loops('select * from (values (5), (150), (250)) o(x) join rpp on rpp.a = o.x')$$;
+set enable_runtime_partition_pruning to off;
+execute direct on (datanode_1) $$select rpp_inner_loops('select * from (values (5), (150), (250)) o(x) join rpp on rpp.a = o.x')$$;
+reset enable_runtime_partition_pruning;
+select o.x, rpp.b from (values (5), (150), (250)) o(x) join rpp on rpp.a = o.x order by 1;
+reset enable_hashjoin;
+reset enable_mergejoin;
+reset enable_material;
+
+-- a generic plan prunes with the parameters of each execution
+prepare rpp_q(int) as
+    select count(*), min(b), max(b) from rpp where a >= $1 and a < $1 + 10;
+execute rpp_q(1);
+execute rpp_q(95);
+execute rpp_q(150);
+execute rpp_q(195);
+execute rpp_q(290);
+execute rpp_q(300);
+execute rpp_q(95);
+deallocate rpp_q;
+prepare rpp_m(int) as
+    select a from rpp where a > $1 order by a limit 2;
+execute rpp_m(98);
+execute rpp_m(198);
+execute rpp_m(0);
+execute rpp_m(150);
+execute rpp_m(297);
+execute rpp_m(298);
+execute rpp_m(98);
+deallocate rpp_m;
+reset rpp.val;
+
+-- the same for the partitions of an interval partitioned table
+create table rpi (a int, b int, c timestamp) partition by range (c)
+    begin (timestamp without time zone '2022-02-26 0:0:0') step (interval '1 day')
+    partitions (4) distribute by shard (a) to group default_group;
+create index rpi_c_idx on rpi(c);
+insert into rpi select i, i, timestamp '2022-02-26' + i * interval '1 hour'
+    from generate_series(0, 95) i;
+analyze rpi;
+
+-- the plan a prepared query ends up with after its first five executions,
+-- run on a datanode: the partitions that are left and how often they are
+-- scanned
+create function rpi_generic_explain(query text, arg text) returns setof text
+language plpgsql as $$
+declare
+    ln text;
+    i int;
+begin
+    execute 'prepare rpi_g(timestamp) as ' || query;
+    for i in 1..5 loop
+        execute format('execute rpi_g(%L)', arg);
+    end loop;
+    for ln in execute format('explain (analyze, costs off, timing off, summary off) execute rpi_g(%L)', arg) loop
+        if ln ~ 'Subplans Removed' then
+            return next regexp_replace(ln, '^\s*', '');
+        elsif ln ~ 'Append' then
+            return next 'Append';
+        elsif ln ~ 'name: rpi_part_[0-9]+\).*loops=' then
+            return next substring(ln from 'name: (rpi_part_[0-9]+)') ||
+                ' loops=' || substring(ln from 'loops=([0-9]+)');
+        end if;
+    end loop;
+    execute 'deallocate rpi_g';
+end;
+$$;
+
+execute direct on (datanode_1) $$select rpi_generic_explain('select count(*) from rpi where c >= $1 and c < $1 + interval ''1 day''', '2022-02-27')$$;
+prepare rpi_q(timestamp) as
+    select count(*), min(b), max(b) from rpi where c >= $1 and c < $1 + interval '1 day';
+execute rpi_q('2022-02-26');
+execute rpi_q('2022-02-26 12:00');
+execute rpi_q('2022-02-27');
+execute rpi_q('2022-02-28 12:00');
+execute rpi_q('2022-03-01 12:00');
+execute rpi_q('2022-03-02');
+execute rpi_q('2022-02-25 12:00');
+execute rpi_q('2022-02-27');
+deallocate rpi_q;
+
+-- the inner side of a parameterized nested loop prunes with both the
+-- parameter of the statement and the outer row
+set enable_hashjoin to off;
+set enable_mergejoin to off;
+set enable_material to off;
+set enable_seqscan to off;
+set enable_bitmapscan to off;
+execute direct on (datanode_1) $$select rpi_generic_explain('select o.x, rpi.b from (values (timestamp ''2022-02-26 05:00''), (''2022-02-27 05:00''), (''2022-03-01 05:00'')) o(x) join rpi on rpi.c = o.x and rpi.c >= $1', '2022-02-27')$$;
+prepare rpi_n(timestamp) as
+    select o.x, rpi.b
+    from (values (timestamp '2022-02-26 05:00'), ('2022-02-27 05:00'), ('2022-03-01 05:00')) o(x)
+        join rpi on rpi.c = o.x and rpi.c >= $1
+    order by 1;
+execute rpi_n('2022-02-26');
+execute rpi_n('2022-02-27');
+execute rpi_n('2022-03-01');
+execute rpi_n('2022-03-02');
+execute rpi_n('2022-02-26');
+execute rpi_n('2022-02-27');
+execute rpi_n('2022-03-01');
+deallocate rpi_n;
+reset enable_hashjoin;
+reset enable_mergejoin;
+reset enable_material;
+reset enable_seqscan;
+reset enable_bitmapscan;
+
+drop function rpi_generic_explain(text, text);
+drop function rpp_inner_loops(text);
+drop function rpp_explain(text);
+drop table rpp;
+drop table rpi;
@@ -0,0 +1,45 @@
+--
+-- Shard-pruned heap scans: quals on the shardid system column restrict the
+-- scan to the extents of those shards.
+--
+create table shard_scan_t(a int, b int) with (extent = true) distribute by shard(a);
+insert into shard_scan_t values(1,1), (2,2), (3,3);
+select shardid, a, b from shard_scan_t order by 1;
+
+select a, b from shard_scan_t where shardid = 2234;
+select a, b from shard_scan_t where 3318 = shardid;
+select a, b from shard_scan_t where shardid in (105, 3318) order by a;
+select a, b from shard_scan_t where shardid = any(array[105, 7, 2234]) order by a;
+select a, b from shard_scan_t where shardid = 105 and shardid = 2234;
+select count(*) from shard_scan_t where shardid = 7;
+select count(*) from shard_scan_t where shardid = 5000;
+
+-- same answers without pruning
+set enable_shard_pruned_scan to off;
+select a, b from shard_scan_t where shardid = 2234;
+select a, b from shard_scan_t where shardid in (105, 3318) order by a;
+reset enable_shard_pruned_scan;
+
+-- the pruned scan reads fewer blocks on each datanode than a full scan:
+-- every shard has its own extents, and a datanode without the shard reads
+-- none at all
+create function shard_scan_blocks(query text, pruned bool) returns bigint
+language plpgsql as $$
+declare
+    plan json;
+begin
+    perform set_config('enable_shard_pruned_scan', pruned::text, true);
+    perform set_config('max_parallel_workers_per_gather', '0', true);
+    execute 'explain (analyze, buffers, costs off, timing off, format json) ' ||
+        query into plan;
+    return (plan->0->'Plan'->>'Shared Hit Blocks')::bigint +
+        (plan->0->'Plan'->>'Shared Read Blocks')::bigint;
+end;
+$$;
+execute direct on (datanode_1) 'select shard_scan_blocks(''select count(*) from shard_scan_t where shardid = 2234'', true) < shard_scan_blocks(''select count(*) from shard_scan_t where shardid = 2234'', false) as pruned';
+execute direct on (datanode_2) 'select shard_scan_blocks(''select count(*) from shard_scan_t where shardid = 2234'', true) < shard_scan_blocks(''select count(*) from shard_scan_t where shardid = 2234'', false) as pruned';
+execute direct on (datanode_1) 'select shard_scan_blocks(''select count(*) from shard_scan_t where shardid = 7'', true) as blocks';
+execute direct on (datanode_2) 'select shard_scan_blocks(''select count(*) from shard_scan_t where shardid = 7'', true) as blocks';
+drop function shard_scan_blocks(text, bool);
+
+drop table shard_scan_t;
@@ -0,0 +1,98 @@
+# Tests for the fan-out of a parallel OpenTenBase subscription: a worker
+# whose own slot is behind the slot of the receiver catches up on its slot
+# before it reads the changes the receiver passes on
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More;
+
+# Initialize publisher node
+my $node_publisher = get_new_node('publisher');
+$node_publisher->init(allows_streaming => 'logical');
+$node_publisher->start;
+
+# Create subscriber node
+my $node_subscriber = get_new_node('subscriber');
+$node_subscriber->init(allows_streaming => 'logical');
+$node_subscriber->append_conf('postgresql.conf',
+	"wal_retrieve_retry_interval = 1ms");
+$node_subscriber->start;
+
+# Parallel subscriptions are only dispatched by a coordinator
+my $is_coordinator = $node_subscriber->safe_psql('postgres',
+"SELECT count(*) FROM pgxc_node WHERE node_name = pgxc_node_str() AND node_type = 'C'"
+);
+if ($is_coordinator ne '1')
+{
+	plan skip_all => 'parallel subscriptions need a coordinator subscriber';
+}
+else
+{
+	plan tests => 4;
+}
+
+$node_publisher->safe_psql('postgres',
+	"CREATE TABLE tab_fan (a int primary key, b text)");
+$node_subscriber->safe_psql('postgres',
+	"CREATE TABLE tab_fan (a int primary key, b text)");
+
+# Setup a parallel subscription of two workers, each streaming from its slot
+my $publisher_connstr = $node_publisher->connstr . ' dbname=postgres';
+$node_publisher->safe_psql('postgres',
+	"CREATE PUBLICATION tap_pub FOR TABLE tab_fan");
+$node_subscriber->safe_psql('postgres',
+	"CREATE EXTENSION opentenbase_subscription");
+$node_subscriber->safe_psql('postgres',
+"CREATE OPENTENBASE SUBSCRIPTION tap_sub CONNECTION '$publisher_connstr' PUBLICATION tap_pub WITH (parallel_number = 2, copy_data = false)"
+);
+
+$node_publisher->safe_psql('postgres',
+	"INSERT INTO tab_fan SELECT i, 'first' FROM generate_series(1, 100) i");
+$node_subscriber->poll_query_until('postgres',
+	"SELECT count(*) = 100 FROM tab_fan")
+  or die "Timed out while waiting for subscriber to catch up";
+
+# Hold the second worker back while the first one moves its slot on
+$node_subscriber->safe_psql('postgres',
+	"ALTER SUBSCRIPTION tap_sub_2_1 DISABLE");
+$node_publisher->safe_psql('postgres',
+	"INSERT INTO tab_fan SELECT i, 'held back' FROM generate_series(101, 200) i");
+my $lsn = $node_publisher->safe_psql('postgres',
+	"SELECT pg_current_wal_lsn()");
+$node_publisher->poll_query_until('postgres',
+"SELECT confirmed_flush_lsn >= '$lsn' FROM pg_replication_slots WHERE slot_name = 'tap_sub_2_0'"
+) or die "Timed out while waiting for the first worker to catch up";
+
+my $result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*) < 200 FROM tab_fan");
+is($result, qq(t), 'second worker held back');
+
+# Switch to the fan-out, the receiver starts past what the second worker
+# has applied
+$node_subscriber->append_conf('postgresql.conf',
+	"logical_apply_fanout = on");
+$node_subscriber->restart;
+$node_subscriber->safe_psql('postgres',
+	"ALTER SUBSCRIPTION tap_sub_2_1 ENABLE");
+
+$node_publisher->safe_psql('postgres',
+	"INSERT INTO tab_fan SELECT i, 'fanned out' FROM generate_series(201, 300) i");
+$node_subscriber->poll_query_until('postgres',
+	"SELECT count(*) = 300 FROM tab_fan")
+  or die "Timed out while waiting for subscriber to catch up";
+
+$result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*), count(DISTINCT b) FROM tab_fan");
+is($result, qq(300|3), 'no change lost across the switch to the fan-out');
+
+my $log = TestLib::slurp_file($node_subscriber->logfile);
+like($log, qr/catches up to [0-9A-F]+\/[0-9A-F]+ before it is fed by the receiver/,
+	'lagging worker catches up on its own slot');
+like($log, qr/is fed by the receiver of its parallel subscription/,
+	'lagging worker switches to the receiver');
+
+$node_subscriber->safe_psql('postgres', "DROP OPENTENBASE SUBSCRIPTION tap_sub");
+
+$node_subscriber->stop('fast');
+$node_publisher->stop('fast');
@@ -0,0 +1,241 @@
+# Tests for the streaming of large in-progress transactions: a publisher
+# with a small logical_decoding_work_mem sends their changes before they
+# commit, and the subscriber applies them at commit, or drops them
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More;
+use Config;
+if ($Config{osname} eq 'MSWin32')
+{
+
+   # some Windows Perls at least don't like IPC::Run's start/kill_kill regime.
+	plan skip_all => "Test fails on Windows perl";
+}
+else
+{
+	plan tests => 10;
+}
+
+# Initialize publisher node, anything but the smallest transactions goes
+# over its budget
+my $node_publisher = get_new_node('publisher');
+$node_publisher->init(allows_streaming => 'logical');
+$node_publisher->append_conf('postgresql.conf',
+	"logical_decoding_work_mem = 64kB");
+$node_publisher->start;
+
+# Create subscriber node, asking for streamed transactions and logging
+# them as they are applied
+my $node_subscriber = get_new_node('subscriber');
+$node_subscriber->init(allows_streaming => 'logical');
+$node_subscriber->append_conf('postgresql.conf',
+	qq(logical_apply_streaming = on
+log_min_messages = debug1));
+$node_subscriber->start;
+
+$node_publisher->safe_psql('postgres',
+	"CREATE TABLE test_tab (a int primary key, b text)");
+$node_publisher->safe_psql('postgres',
+	"INSERT INTO test_tab SELECT i, md5(i::text) FROM generate_series(1, 2) i");
+$node_subscriber->safe_psql('postgres',
+	"CREATE TABLE test_tab (a int primary key, b text)");
+
+# Setup logical replication
+my $publisher_connstr = $node_publisher->connstr . ' dbname=postgres';
+$node_publisher->safe_psql('postgres',
+	"CREATE PUBLICATION tap_pub FOR TABLE test_tab");
+
+my $appname = 'tap_sub';
+$node_subscriber->safe_psql('postgres',
+"CREATE SUBSCRIPTION tap_sub CONNECTION '$publisher_connstr application_name=$appname' PUBLICATION tap_pub"
+);
+
+# Wait for subscriber to finish initialization
+my $caughtup_query =
+"SELECT pg_current_wal_lsn() <= replay_lsn FROM pg_stat_replication WHERE application_name = '$appname';";
+$node_publisher->poll_query_until('postgres', $caughtup_query)
+  or die "Timed out while waiting for subscriber to catch up";
+
+# Also wait for initial table sync to finish
+my $synced_query =
+"SELECT count(1) = 0 FROM pg_subscription_rel WHERE srsubstate NOT IN ('r', 's');";
+$node_subscriber->poll_query_until('postgres', $synced_query)
+  or die "Timed out while waiting for subscriber to synchronize data";
+
+my $result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*), min(a), max(a) FROM test_tab");
+is($result, qq(2|1|2), 'check initial data was copied to subscriber');
+
+# Start a transaction in a session of its own, which is left open while
+# the test goes on
+sub start_background_xact
+{
+	my ($node, $sql) = @_;
+	my ($stdin, $stdout, $stderr) = ('', '', '');
+	my $h = IPC::Run::start(
+		[   'psql', '-X', '-qAt', '-v', 'ON_ERROR_STOP=1', '-f', '-', '-d',
+			$node->connstr('postgres') ],
+		'<',
+		\$stdin,
+		'>',
+		\$stdout,
+		'2>',
+		\$stderr);
+	$stdin .= "BEGIN;\n$sql\nSELECT pg_current_wal_lsn();\n";
+	$h->pump until $stdout =~ /[[:xdigit:]]+\/[[:xdigit:]]+[\r\n]$/;
+
+	my $lsn = $stdout;
+	chomp($lsn);
+	return ($h, \$stdin, $lsn);
+}
+
+# Wait for the walsender to have sent the changes up to $lsn, which are
+# over the budget of the publisher and so streamed
+sub wait_for_sent
+{
+	my ($lsn) = @_;
+	$node_publisher->poll_query_until('postgres',
+"SELECT sent_lsn >= '$lsn' FROM pg_stat_replication WHERE application_name = '$appname';"
+	) or die "Timed out while waiting for the changes to be sent";
+}
+
+# A streamed transaction is applied at its commit
+my $nstreamed = () = slurp_file($node_subscriber->logfile) =~
+  /applied \d+ messages of streamed transaction/g;
+
+$node_publisher->safe_psql('postgres', q{
+BEGIN;
+INSERT INTO test_tab SELECT i, md5(i::text) FROM generate_series(3, 5000) s(i);
+UPDATE test_tab SET b = md5(b) WHERE mod(a, 2) = 0;
+DELETE FROM test_tab WHERE mod(a, 3) = 0;
+COMMIT;
+});
+
+$node_publisher->poll_query_until('postgres', $caughtup_query)
+  or die "Timed out while waiting for subscriber to catch up";
+
+$result = $node_subscriber->safe_psql('postgres',
+"SELECT count(*), min(a), max(a), count(*) FILTER (WHERE b = md5(md5(a::text))) FROM test_tab"
+);
+is($result, qq(3334|1|5000|1667),
+	'check streamed transaction was applied on subscriber');
+
+my $nstreamed_now = () = slurp_file($node_subscriber->logfile) =~
+  /applied \d+ messages of streamed transaction/g;
+cmp_ok($nstreamed_now, '>', $nstreamed,
+	'check transaction was streamed to subscriber');
+
+# A streamed transaction that aborts leaves nothing behind
+$node_publisher->safe_psql('postgres', q{
+BEGIN;
+INSERT INTO test_tab SELECT i, md5(i::text) FROM generate_series(5001, 10000) s(i);
+DELETE FROM test_tab WHERE a <= 100;
+ROLLBACK;
+});
+
+$node_publisher->poll_query_until('postgres', $caughtup_query)
+  or die "Timed out while waiting for subscriber to catch up";
+
+$result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*), min(a), max(a) FROM test_tab");
+is($result, qq(3334|1|5000),
+	'check streamed transaction was aborted on subscriber');
+
+# The changes of a subtransaction rolled back after they were streamed are
+# dropped, those of the rest of the transaction are kept
+$node_publisher->safe_psql('postgres', q{
+BEGIN;
+INSERT INTO test_tab SELECT i, md5(i::text) FROM generate_series(5001, 7000) s(i);
+SAVEPOINT s1;
+INSERT INTO test_tab SELECT i, md5(i::text) FROM generate_series(7001, 9000) s(i);
+DELETE FROM test_tab WHERE a <= 5000;
+ROLLBACK TO SAVEPOINT s1;
+SAVEPOINT s2;
+INSERT INTO test_tab SELECT i, md5(i::text) FROM generate_series(7001, 8000) s(i);
+RELEASE SAVEPOINT s2;
+COMMIT;
+});
+
+$node_publisher->poll_query_until('postgres', $caughtup_query)
+  or die "Timed out while waiting for subscriber to catch up";
+
+$result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*), min(a), max(a) FROM test_tab");
+is($result, qq(6334|1|8000),
+	'check rolled back subtransaction was dropped on subscriber');
+
+# A subscriber restarted in the middle of a streamed transaction gets its
+# changes again from the start
+my ($xact, $xact_stdin, $lsn) = start_background_xact($node_publisher,
+"INSERT INTO test_tab SELECT i, md5(i::text) FROM generate_series(8001, 13000) s(i);"
+);
+wait_for_sent($lsn);
+
+$result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*) FROM test_tab WHERE a > 8000");
+is($result, qq(0), 'check in-progress transaction is not applied');
+
+$node_subscriber->restart;
+
+$$xact_stdin .= q{
+INSERT INTO test_tab SELECT i, md5(i::text) FROM generate_series(13001, 14000) s(i);
+COMMIT;
+};
+$xact->finish;
+
+$node_publisher->poll_query_until('postgres', $caughtup_query)
+  or die "Timed out while waiting for subscriber to catch up";
+
+$result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*), min(a), max(a) FROM test_tab");
+is($result, qq(12334|1|14000),
+	'check transaction streamed across a restart was applied on subscriber');
+
+# Transactions that commit while a streamed one is in progress are applied
+# before it, the streamed one when it commits
+($xact, $xact_stdin, $lsn) = start_background_xact($node_publisher,
+"INSERT INTO test_tab SELECT i, md5(i::text) FROM generate_series(14001, 19000) s(i);"
+);
+wait_for_sent($lsn);
+
+$node_publisher->safe_psql('postgres',
+"INSERT INTO test_tab SELECT i, md5(i::text) FROM generate_series(20001, 20010) s(i)"
+);
+$node_publisher->safe_psql('postgres', q{
+BEGIN;
+INSERT INTO test_tab SELECT i, md5(i::text) FROM generate_series(21001, 26000) s(i);
+DELETE FROM test_tab WHERE a > 25000;
+COMMIT;
+});
+
+$node_subscriber->poll_query_until('postgres',
+	"SELECT count(*) = 4010 FROM test_tab WHERE a > 20000")
+  or die "Timed out while waiting for subscriber to catch up";
+
+$result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*) FROM test_tab WHERE a BETWEEN 14001 AND 19000");
+is($result, qq(0),
+	'check streamed transaction is applied after those committed first');
+
+$$xact_stdin .= "COMMIT;\n";
+$xact->finish;
+
+$node_publisher->poll_query_until('postgres', $caughtup_query)
+  or die "Timed out while waiting for subscriber to catch up";
+
+$result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*), min(a), max(a) FROM test_tab");
+is($result, qq(21344|1|25000),
+	'check interleaved transactions were applied on subscriber');
+
+# The subscriber ends up with what the publisher has
+my $expected = $node_publisher->safe_psql('postgres',
+	"SELECT count(*), sum(a), count(DISTINCT b) FROM test_tab");
+$result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*), sum(a), count(DISTINCT b) FROM test_tab");
+is($result, $expected, 'check subscriber has the content of the publisher');
+
+$node_subscriber->stop('fast');
+$node_publisher->stop('fast');